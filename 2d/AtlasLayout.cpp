@@ -0,0 +1,46 @@
+﻿#include "AtlasLayout.h"
+#include <algorithm>
+
+const uint32_t AtlasLayout::kInvalidPage;
+
+bool AtlasLayout::Build(const std::vector<Size>& sizes, uint32_t pageSize, uint32_t padding) {
+	pages_.clear();
+	placements_.assign(sizes.size(), {kInvalidPage, 0, 0});
+
+	// 高さの大きい順に詰めると隙間が減る
+	order_.resize(sizes.size());
+	for (uint32_t i = 0; i < order_.size(); i++) {
+		order_[i] = i;
+	}
+	std::stable_sort(order_.begin(), order_.end(), [&sizes](uint32_t lhs, uint32_t rhs) {
+		const Size& l = sizes[lhs];
+		const Size& r = sizes[rhs];
+		return l.height != r.height ? l.height > r.height : l.width > r.width;
+	});
+
+	bool allPlaced = true;
+	for (uint32_t index : order_) {
+		uint32_t width = sizes[index].width + padding * 2;
+		uint32_t height = sizes[index].height + padding * 2;
+		if (pageSize < width || pageSize < height) {
+			allPlaced = false;
+			continue;
+		}
+
+		Placement& placement = placements_[index];
+		uint32_t page = 0;
+		for (; page < pages_.size(); page++) {
+			if (pages_[page].Insert(width, height, placement.x, placement.y)) {
+				break;
+			}
+		}
+		// どのページにも入らなければページを追加（空のページには必ず入る）
+		if (page == pages_.size()) {
+			pages_.emplace_back();
+			pages_.back().Initialize(pageSize, pageSize);
+			pages_.back().Insert(width, height, placement.x, placement.y);
+		}
+		placement.page = page;
+	}
+	return allPlaced;
+}
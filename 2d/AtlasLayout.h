@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include "SkylinePacker.h"
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// テクスチャアトラスの配置（画像の大きさだけからページと位置を決める）
+/// （高さの大きい順に並べ、先頭のページから空きを探し、どこにも入らなければページを足す）
+/// </summary>
+class AtlasLayout {
+  public:
+	// 配置できなかったときのページ番号
+	static const uint32_t kInvalidPage = UINT32_MAX;
+
+	/// <summary>
+	/// 画像の大きさ
+	/// </summary>
+	struct Size {
+		uint32_t width;
+		uint32_t height;
+	};
+
+	/// <summary>
+	/// 配置結果（余白を含む矩形の左上。画像はpadding分内側に置く）
+	/// </summary>
+	struct Placement {
+		uint32_t page;
+		uint32_t x;
+		uint32_t y;
+	};
+
+	/// <summary>
+	/// 配置（以前の結果は捨てる。余白込みでページより大きいものはkInvalidPageになる）
+	/// </summary>
+	/// <param name="sizes">画像の大きさ</param>
+	/// <param name="pageSize">ページの一辺のサイズ</param>
+	/// <param name="padding">矩形の周りの余白</param>
+	/// <returns>全て配置できればtrue</returns>
+	bool Build(const std::vector<Size>& sizes, uint32_t pageSize, uint32_t padding);
+
+	/// <summary>
+	/// 配置結果の取得（sizesと同じ順）
+	/// </summary>
+	const std::vector<Placement>& GetPlacements() const { return placements_; }
+
+	/// <summary>
+	/// ページ数の取得
+	/// </summary>
+	uint32_t GetPageCount() const { return static_cast<uint32_t>(pages_.size()); }
+
+	/// <summary>
+	/// ページの充填率の取得
+	/// </summary>
+	/// <param name="page">ページ番号</param>
+	/// <returns>充填率(0～1)</returns>
+	float GetPageOccupancy(uint32_t page) const { return pages_[page].GetOccupancy(); }
+
+  private:
+	// ページごとの詰め込み
+	std::vector<SkylinePacker> pages_;
+	// 配置結果
+	std::vector<Placement> placements_;
+	// 詰める順番（作業領域）
+	std::vector<uint32_t> order_;
+};
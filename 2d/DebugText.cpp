@@ -0,0 +1,246 @@
+﻿#include "DebugText.h"
+#include "D3D12RenderCommandList.h"
+#include "SpriteBatch.h"
+#include "TextureManager.h"
+#include <DirectXTex.h>
+#include <cassert>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+DebugText::DebugText() {}
+
+DebugText::~DebugText() {}
+
+DebugText* DebugText::GetInstance() {
+	static DebugText instance;
+	return &instance;
+}
+
+void DebugText::Initialize() {
+	textureHandle_ = TextureManager::Load("debugfont.png");
+
+	// 文字の切り出しに使うフォント画像の大きさ
+	D3D12_RESOURCE_DESC resDesc = TextureManager::GetInstance()->GetResoureDesc(textureHandle_);
+	textureWidth_ = static_cast<float>(resDesc.Width);
+	textureHeight_ = static_cast<float>(resDesc.Height);
+
+	glyphs_.clear();
+	layoutCache_.Clear();
+	hasDistanceField_ = false;
+	isDistanceFieldEnabled_ = false;
+}
+
+void DebugText::SetDistanceFieldEnabled(bool enabled) {
+	if (enabled && !hasDistanceField_) {
+		hasDistanceField_ = BuildDistanceField();
+		if (!hasDistanceField_) {
+			return;
+		}
+	}
+	if (isDistanceFieldEnabled_ != enabled) {
+		// 並べ方が変わるのでキャッシュは使えない
+		layoutCache_.Clear();
+		isDistanceFieldEnabled_ = enabled;
+	}
+}
+
+void DebugText::Print(const std::string& text, float x, float y, float scale) {
+	SetPos(x, y);
+	SetScale(scale);
+
+	CachedPrint(static_cast<int>(text.size()), text.c_str());
+}
+
+void DebugText::Print(const char* text, float x, float y, float scale) {
+	SetPos(x, y);
+	SetScale(scale);
+
+	CachedPrint(static_cast<int>(strlen(text)), text);
+}
+
+void DebugText::Printf(const char* fmt, ...) {
+	// 固定長のバッファに展開するのでヒープ確保は起きない
+	va_list args;
+	va_start(args, fmt);
+	int w = vsnprintf(buffer, kBufferSize - 1, fmt, args);
+	va_end(args);
+
+	if (w < 0) {
+		return;
+	}
+	NPrint((w < kBufferSize - 1) ? w : kBufferSize - 1, buffer);
+}
+
+void DebugText::ConsolePrintf(const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	vsnprintf(buffer, kBufferSize - 1, fmt, args);
+	va_end(args);
+
+	OutputDebugStringA(buffer);
+}
+
+void DebugText::DrawAll(ID3D12GraphicsCommandList* cmdList) {
+	D3D12RenderCommandList commandList(cmdList);
+	DrawAll(&commandList);
+}
+
+void DebugText::DrawAll(RenderCommandList* commandList) {
+	layoutCache_.NextFrame();
+	if (glyphs_.empty()) {
+		return;
+	}
+
+	// 全文字が同じテクスチャなので1回の描画になる
+	SpriteBatch* spriteBatch = SpriteBatch::GetInstance();
+	spriteBatch->Begin(commandList, SpriteBatch::SortMode::kDeferred);
+	if (isDistanceFieldEnabled_) {
+		spriteBatch->Draw(
+		  sdfTextureHandle_, glyphs_.data(), glyphs_.size(), SpriteBatch::BlendMode::kNormal,
+		  SpriteBatch::ShaderMode::kDistanceField);
+	} else {
+		spriteBatch->Draw(textureHandle_, glyphs_.data(), glyphs_.size());
+	}
+	spriteBatch->End();
+
+	glyphs_.clear();
+}
+
+void DebugText::CachedPrint(int len, const char* text) {
+	if (!isLayoutCacheEnabled_) {
+		NPrint(len, text);
+		return;
+	}
+
+	// 前回と同じ文字列・倍率なら並べた結果を座標の差だけずらして写すだけ
+	if (layoutCache_.Append(text, len, posX_, posY_, scale_, glyphs_)) {
+		return;
+	}
+
+	size_t first = glyphs_.size();
+	NPrint(len, text);
+	layoutCache_.Insert(text, len, posX_, posY_, scale_, glyphs_.data() + first, len);
+}
+
+void DebugText::NPrint(int len, const char* text) {
+	if (isDistanceFieldEnabled_) {
+		NPrintDistanceField(len, text);
+		return;
+	}
+
+	const float width = kFontWidth * scale_;
+	const float height = kFontHeight * scale_;
+	const uint32_t white = SpriteQuad::PackColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+	size_t first = glyphs_.size();
+	glyphs_.resize(first + len);
+
+	// 全ての文字について
+	for (int i = 0; i < len; i++) {
+		const unsigned char& character = text[i];
+
+		// ASCIIコードの2段分飛ばした番号を計算
+		int fontIndex = character - 32;
+		if (character < 32 || character >= 0x7f) {
+			fontIndex = 0;
+		}
+
+		int fontIndexY = fontIndex / kFontLineCount;
+		int fontIndexX = fontIndex % kFontLineCount;
+
+		// 座標とテクスチャ範囲を設定
+		SpriteQuad::Desc& glyph = glyphs_[first + i];
+		glyph.position[0] = posX_ + width * i;
+		glyph.position[1] = posY_;
+		glyph.rotation = 0.0f;
+		glyph.size[0] = width;
+		glyph.size[1] = height;
+		glyph.anchorPoint[0] = 0.0f;
+		glyph.anchorPoint[1] = 0.0f;
+		glyph.uvRect[0] = fontIndexX * kFontWidth / textureWidth_;
+		glyph.uvRect[1] = fontIndexY * kFontHeight / textureHeight_;
+		glyph.uvRect[2] = (fontIndexX + 1) * kFontWidth / textureWidth_;
+		glyph.uvRect[3] = (fontIndexY + 1) * kFontHeight / textureHeight_;
+		glyph.color = white;
+		glyph.isFlipX = false;
+		glyph.isFlipY = false;
+	}
+}
+
+void DebugText::NPrintDistanceField(int len, const char* text) {
+	// 等幅の送りはそのまま、字形だけを距離場アトラスから取る
+	const float width = kFontWidth * scale_;
+	const float glyphScale = kFontHeight * scale_ / sdfAtlas_.GetLineHeight();
+	const uint32_t white = SpriteQuad::PackColor(1.0f, 1.0f, 1.0f, 1.0f);
+	const SdfFontAtlas::Glyph* fallback = sdfAtlas_.Find(' ');
+
+	size_t first = glyphs_.size();
+	glyphs_.resize(first + len);
+
+	for (int i = 0; i < len; i++) {
+		const SdfFontAtlas::Glyph* atlasGlyph = sdfAtlas_.Find(static_cast<unsigned char>(text[i]));
+		if (!atlasGlyph) {
+			atlasGlyph = fallback;
+		}
+
+		// 空白は大きさ0の矩形にして文字数と矩形数を揃えておく
+		SpriteQuad::Desc& glyph = glyphs_[first + i];
+		glyph.position[0] = posX_ + width * i + atlasGlyph->offset[0] * glyphScale;
+		glyph.position[1] = posY_ + atlasGlyph->offset[1] * glyphScale;
+		glyph.rotation = 0.0f;
+		glyph.size[0] = atlasGlyph->size[0] * glyphScale;
+		glyph.size[1] = atlasGlyph->size[1] * glyphScale;
+		glyph.anchorPoint[0] = 0.0f;
+		glyph.anchorPoint[1] = 0.0f;
+		for (int j = 0; j < 4; j++) {
+			glyph.uvRect[j] = atlasGlyph->uvRect[j];
+		}
+		glyph.color = white;
+		glyph.isFlipX = false;
+		glyph.isFlipY = false;
+	}
+}
+
+bool DebugText::BuildDistanceField() {
+	// フォント画像をCPU側に読み直す
+	DirectX::ScratchImage fontImage;
+	if (!TextureManager::GetInstance()->LoadImageFile("debugfont.png", fontImage)) {
+		return false;
+	}
+	const DirectX::Image* image = fontImage.GetImage(0, 0, 0);
+	assert(DirectX::BitsPerPixel(image->format) == 32);
+
+	// 拡大してから距離場を作り、縮小して格納する
+	SdfFontAtlas::Settings settings;
+	settings.firstCode = 32;
+	settings.lastCode = 126;
+	settings.downscale = kSdfDownscale;
+	settings.spread = kSdfSpread;
+	settings.lineHeight = static_cast<float>(kFontHeight * kSdfUpscale);
+	bool built = sdfAtlas_.Build(
+	  SdfFontAtlas::CreateBitmapFontSource(
+	    image->pixels, static_cast<uint32_t>(image->width), static_cast<uint32_t>(image->height),
+	    image->rowPitch, kFontWidth, kFontHeight, kFontLineCount, kSdfUpscale),
+	  settings);
+	if (!built) {
+		return false;
+	}
+
+	// 1チャンネルのテクスチャとして登録
+	DirectX::ScratchImage atlasImage;
+	HRESULT result = atlasImage.Initialize2D(
+	  DXGI_FORMAT_R8_UNORM, sdfAtlas_.GetWidth(), sdfAtlas_.GetHeight(), 1, 1);
+	assert(SUCCEEDED(result));
+	(void)result;
+	const DirectX::Image* atlas = atlasImage.GetImage(0, 0, 0);
+	for (uint32_t y = 0; y < sdfAtlas_.GetHeight(); y++) {
+		memcpy(
+		  atlas->pixels + y * atlas->rowPitch,
+		  sdfAtlas_.GetPixels().data() + static_cast<size_t>(y) * sdfAtlas_.GetWidth(),
+		  sdfAtlas_.GetWidth());
+	}
+	sdfTextureHandle_ = TextureManager::LoadFromImage("debugfont_sdf", atlasImage);
+
+	return true;
+}
@@ -1,20 +1,28 @@
 ﻿#pragma once
 
-#include "Sprite.h"
+#include "RenderCommandList.h"
+#include "SdfFontAtlas.h"
+#include "SpriteQuad.h"
+#include "TextLayoutCache.h"
 #include <Windows.h>
+#include <d3d12.h>
 #include <string>
+#include <vector>
 
 /// <summary>
 /// デバッグ用文字表示
+/// （文字ごとの矩形を1本の配列に溜め、SpriteBatchで1回の描画にまとめる）
 /// </summary>
 class DebugText {
   public:
 	// デバッグテキスト用のテクスチャ番号を指定
-	static const int kMaxCharCount = 512; // 最大文字数
 	static const int kFontWidth = 9;      // フォント画像内1文字分の横幅
 	static const int kFontHeight = 18;    // フォント画像内1文字分の縦幅
 	static const int kFontLineCount = 14; // フォント画像内1行分の文字数
 	static const int kBufferSize = 512;   // 書式付き文字列展開用バッファサイズ
+	static const int kSdfUpscale = 8;     // 距離場生成前にフォント画像を拡大する倍率
+	static const int kSdfDownscale = 2;   // 距離場の縮小率
+	static const int kSdfSpread = 4;      // 距離場の広がり（ピクセル）
 
 	/// <summary>
 	/// シングルトンインスタンスの取得
@@ -27,6 +35,23 @@ class DebugText {
 	/// </summary>
 	void Initialize();
 
+	/// <summary>
+	/// 距離場フォントの有効・無効（初回の有効化時にフォント画像から距離場アトラスを作る）
+	/// 大きな倍率で表示しても縁がぼやけない
+	/// </summary>
+	/// <param name="enabled">有効ならtrue</param>
+	void SetDistanceFieldEnabled(bool enabled);
+
+	/// <summary>
+	/// 距離場フォントが有効か
+	/// </summary>
+	bool IsDistanceFieldEnabled() const { return isDistanceFieldEnabled_; }
+
+	/// <summary>
+	/// 距離場アトラス生成時の統計
+	/// </summary>
+	const SdfFontAtlas::Stats& GetDistanceFieldStats() const { return sdfAtlas_.GetStats(); }
+
 	/// <summary>
 	/// 文字列追加
 	/// </summary>
@@ -36,6 +61,15 @@ class DebugText {
 	/// <param name="scale">倍率</param>
 	void Print(const std::string& text, float x, float y, float scale = 1.0f);
 
+	/// <summary>
+	/// 文字列追加（文字列リテラルからstd::stringを作らない）
+	/// </summary>
+	/// <param name="text">文字列</param>
+	/// <param name="x">表示座標X</param>
+	/// <param name="y">表示座標Y</param>
+	/// <param name="scale">倍率</param>
+	void Print(const char* text, float x, float y, float scale = 1.0f);
+
 	/// <summary>
 	/// 書式付き文字列追加
 	/// </summary>
@@ -50,10 +84,17 @@ class DebugText {
 
 	/// <summary>
 	/// 描画フラッシュ
+	/// （SpriteBatchで描くので、後にSprite::Drawを続けるならSpriteBatch::Endの注意に従う）
 	/// </summary>
 	/// <param name="cmdList">描画コマンドリスト</param>
 	void DrawAll(ID3D12GraphicsCommandList* cmdList);
 
+	/// <summary>
+	/// 描画フラッシュ（描画コマンドの発行先版）
+	/// </summary>
+	/// <param name="commandList">描画コマンドの発行先</param>
+	void DrawAll(RenderCommandList* commandList);
+
 	/// <summary>
 	/// 描画座標の指定
 	/// </summary>
@@ -70,13 +111,38 @@ class DebugText {
 	/// <param name="scale">倍率</param>
 	void SetScale(float scale) { scale_ = scale; }
 
+	/// <summary>
+	/// レイアウトキャッシュの有効・無効（Printfは内容が毎フレーム変わりやすいので対象外）
+	/// </summary>
+	/// <param name="enabled">有効ならtrue</param>
+	void SetLayoutCacheEnabled(bool enabled) { isLayoutCacheEnabled_ = enabled; }
+
+	/// <summary>
+	/// レイアウトキャッシュの取得（ヒット率などの確認用）
+	/// </summary>
+	const TextLayoutCache& GetLayoutCache() const { return layoutCache_; }
+
+	/// <summary>
+	/// 溜まっている文字数
+	/// </summary>
+	size_t GetGlyphCount() const { return glyphs_.size(); }
+
   private:
 	// テクスチャハンドル
 	uint32_t textureHandle_ = 0;
-	// スプライトデータの配列
-	Sprite* spriteDatas_[kMaxCharCount] = {};
-	// スプライトデータ配列の添え字番号
-	int spriteIndex_ = 0;
+	// フォント画像の大きさ
+	float textureWidth_ = 1.0f;
+	float textureHeight_ = 1.0f;
+	// 距離場フォント
+	SdfFontAtlas sdfAtlas_;
+	uint32_t sdfTextureHandle_ = 0;
+	bool hasDistanceField_ = false;
+	bool isDistanceFieldEnabled_ = false;
+	// 文字ごとの矩形（描画後も容量は残して使い回す）
+	std::vector<SpriteQuad::Desc> glyphs_;
+	// Printで追加した文字列のレイアウトキャッシュ
+	TextLayoutCache layoutCache_;
+	bool isLayoutCacheEnabled_ = true;
 
 	float posX_ = 0.0f;
 	float posY_ = 0.0f;
@@ -89,4 +155,19 @@ class DebugText {
 	DebugText(const DebugText&) = delete;
 	DebugText& operator=(const DebugText&) = delete;
 	void NPrint(int len, const char* text);
+
+	/// <summary>
+	/// 距離場アトラスで文字を並べる
+	/// </summary>
+	void NPrintDistanceField(int len, const char* text);
+
+	/// <summary>
+	/// 距離場アトラスの生成
+	/// </summary>
+	bool BuildDistanceField();
+
+	/// <summary>
+	/// キャッシュを引いてから文字を並べる
+	/// </summary>
+	void CachedPrint(int len, const char* text);
 };
@@ -0,0 +1,276 @@
+﻿#include "SdfFontAtlas.h"
+#include "SkylinePacker.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace {
+// アトラスの最大の高さ
+const uint32_t kMaxAtlasHeight = 8192;
+// グリフ同士の隙間（バイリニアで隣のグリフを拾わないように）
+const uint32_t kGlyphGap = 1;
+
+// 経過時間（ミリ秒）
+double ElapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+	  .count();
+}
+
+// 収集したグリフの作業データ
+struct GlyphWork {
+	uint32_t code;
+	SdfFontAtlas::GlyphBitmap bitmap;
+	SdfGenerator::Result sdf;
+	float error;
+	uint32_t x;
+	uint32_t y;
+};
+} // namespace
+
+bool SdfFontAtlas::Build(const GlyphSource& source, const Settings& settings) {
+	assert(source);
+	assert(0 < settings.downscale);
+
+	glyphs_.clear();
+	stats_ = Stats();
+	spread_ = settings.spread;
+
+	// 被覆率画像の収集（供給元はスレッドセーフとは限らないので順番に）
+	auto start = std::chrono::steady_clock::now();
+	std::vector<GlyphWork> works;
+	float maxHeight = 0.0f;
+	for (uint32_t code = settings.firstCode; code <= settings.lastCode; code++) {
+		GlyphWork work{};
+		work.code = code;
+		if (!source(code, work.bitmap)) {
+			continue;
+		}
+		// 中身の無いグリフ（空白など）は送り幅だけを持つ
+		const std::vector<uint8_t>& coverage = work.bitmap.coverage;
+		if (std::all_of(coverage.begin(), coverage.end(), [](uint8_t value) { return value < 128; })) {
+			work.bitmap.width = 0;
+			work.bitmap.height = 0;
+		}
+		maxHeight = (std::max)(maxHeight, static_cast<float>(work.bitmap.height));
+		works.push_back(std::move(work));
+	}
+	stats_.rasterizeMilliseconds = ElapsedMilliseconds(start);
+	lineHeight_ = (0.0f < settings.lineHeight ? settings.lineHeight : maxHeight) / settings.downscale;
+
+	// グリフ単位で並列に距離場を作る
+	start = std::chrono::steady_clock::now();
+	ThreadPool::GetInstance()->ParallelFor(
+	  static_cast<uint32_t>(works.size()), 1, [&](uint32_t begin, uint32_t end) {
+		  for (uint32_t i = begin; i < end; i++) {
+			  GlyphWork& work = works[i];
+			  if (work.bitmap.width == 0) {
+				  work.error = 0.0f;
+				  continue;
+			  }
+			  SdfGenerator::Generate(
+			    work.bitmap.coverage.data(), work.bitmap.width, work.bitmap.height,
+			    settings.downscale, settings.spread, work.sdf);
+			  work.error = SdfGenerator::MeasureError(
+			    work.bitmap.coverage.data(), work.bitmap.width, work.bitmap.height,
+			    settings.downscale, work.sdf);
+		  }
+	  });
+	stats_.generateMilliseconds = ElapsedMilliseconds(start);
+
+	// 高いものから詰める（入らなければ高さを倍にしてやり直す）
+	start = std::chrono::steady_clock::now();
+	std::vector<GlyphWork*> order;
+	for (GlyphWork& work : works) {
+		if (0 < work.sdf.width) {
+			order.push_back(&work);
+		}
+	}
+	std::sort(order.begin(), order.end(), [](const GlyphWork* lhs, const GlyphWork* rhs) {
+		return lhs->sdf.height != rhs->sdf.height ? lhs->sdf.height > rhs->sdf.height
+		                                          : lhs->code < rhs->code;
+	});
+
+	SkylinePacker packer;
+	bool packed = false;
+	for (uint32_t height = 64; !packed && height <= kMaxAtlasHeight; height *= 2) {
+		packer.Initialize(settings.atlasWidth, height);
+		packed = true;
+		for (GlyphWork* work : order) {
+			if (!packer.Insert(
+			      work->sdf.width + kGlyphGap, work->sdf.height + kGlyphGap, work->x, work->y)) {
+				packed = false;
+				break;
+			}
+		}
+	}
+	if (!packed) {
+		return false;
+	}
+
+	width_ = packer.GetWidth();
+	height_ = packer.GetHeight();
+	pixels_.assign(static_cast<size_t>(width_) * height_, 0);
+	for (const GlyphWork* work : order) {
+		for (uint32_t y = 0; y < work->sdf.height; y++) {
+			memcpy(
+			  &pixels_[static_cast<size_t>(work->y + y) * width_ + work->x],
+			  &work->sdf.pixels[static_cast<size_t>(y) * work->sdf.width], work->sdf.width);
+		}
+	}
+	stats_.packMilliseconds = ElapsedMilliseconds(start);
+	stats_.occupancy = packer.GetOccupancy();
+
+	// グリフ情報
+	const float downscale = static_cast<float>(settings.downscale);
+	float errorSum = 0.0f;
+	for (const GlyphWork& work : works) {
+		Glyph glyph{};
+		glyph.advance = work.bitmap.advance / downscale;
+		if (0 < work.sdf.width) {
+			glyph.uvRect[0] = static_cast<float>(work.x) / width_;
+			glyph.uvRect[1] = static_cast<float>(work.y) / height_;
+			glyph.uvRect[2] = static_cast<float>(work.x + work.sdf.width) / width_;
+			glyph.uvRect[3] = static_cast<float>(work.y + work.sdf.height) / height_;
+			glyph.offset[0] = work.bitmap.offsetX / downscale - work.sdf.padding;
+			glyph.offset[1] = work.bitmap.offsetY / downscale - work.sdf.padding;
+			glyph.size[0] = static_cast<float>(work.sdf.width);
+			glyph.size[1] = static_cast<float>(work.sdf.height);
+		}
+		glyphs_[work.code] = glyph;
+
+		errorSum += work.error;
+		stats_.maxError = (std::max)(stats_.maxError, work.error);
+	}
+	stats_.glyphCount = static_cast<uint32_t>(works.size());
+	stats_.averageError = works.empty() ? 0.0f : errorSum / works.size();
+
+	return true;
+}
+
+const SdfFontAtlas::Glyph* SdfFontAtlas::Find(uint32_t code) const {
+	auto it = glyphs_.find(code);
+	return it == glyphs_.end() ? nullptr : &it->second;
+}
+
+SdfFontAtlas::GlyphSource SdfFontAtlas::CreateBitmapFontSource(
+  const uint8_t* rgba, uint32_t width, uint32_t height, size_t rowPitch, uint32_t cellWidth,
+  uint32_t cellHeight, uint32_t cellsPerRow, uint32_t upscale, uint32_t firstCode) {
+	// 透過していればアルファ、不透明な画像なら輝度を被覆率とする
+	auto image = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(width) * height);
+	bool hasAlpha = false;
+	for (uint32_t y = 0; y < height && !hasAlpha; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			if (rgba[y * rowPitch + x * 4 + 3] < 255) {
+				hasAlpha = true;
+				break;
+			}
+		}
+	}
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			const uint8_t* pixel = &rgba[y * rowPitch + x * 4];
+			(*image)[static_cast<size_t>(y) * width + x] =
+			  hasAlpha ? pixel[3] : static_cast<uint8_t>((pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29) >> 8);
+		}
+	}
+
+	return [=](uint32_t code, GlyphBitmap& bitmap) {
+		if (code < firstCode) {
+			return false;
+		}
+		uint32_t index = code - firstCode;
+		uint32_t cellX = (index % cellsPerRow) * cellWidth;
+		uint32_t cellY = (index / cellsPerRow) * cellHeight;
+		if (width < cellX + cellWidth || height < cellY + cellHeight) {
+			return false;
+		}
+
+		// 最近傍で拡大
+		bitmap.width = cellWidth * upscale;
+		bitmap.height = cellHeight * upscale;
+		bitmap.coverage.resize(static_cast<size_t>(bitmap.width) * bitmap.height);
+		for (uint32_t y = 0; y < bitmap.height; y++) {
+			for (uint32_t x = 0; x < bitmap.width; x++) {
+				bitmap.coverage[static_cast<size_t>(y) * bitmap.width + x] =
+				  (*image)[static_cast<size_t>(cellY + y / upscale) * width + (cellX + x / upscale)];
+			}
+		}
+		bitmap.offsetX = 0.0f;
+		bitmap.offsetY = 0.0f;
+		bitmap.advance = static_cast<float>(bitmap.width);
+		return true;
+	};
+}
+
+#ifdef _WIN32
+SdfFontAtlas::GlyphSource SdfFontAtlas::CreateSystemFontSource(const char* faceName, int pixelHeight) {
+	// デバイスコンテキストとフォントは供給元が破棄されるまで保持する
+	struct GdiFont {
+		HDC dc = nullptr;
+		HFONT font = nullptr;
+		HGDIOBJ oldFont = nullptr;
+		TEXTMETRICA metric = {};
+		~GdiFont() {
+			if (dc) {
+				SelectObject(dc, oldFont);
+				DeleteDC(dc);
+			}
+			if (font) {
+				DeleteObject(font);
+			}
+		}
+	};
+	auto gdi = std::make_shared<GdiFont>();
+	gdi->dc = CreateCompatibleDC(nullptr);
+	gdi->font = CreateFontA(
+	  -pixelHeight, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_TT_PRECIS,
+	  CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH, faceName);
+	assert(gdi->dc && gdi->font);
+	gdi->oldFont = SelectObject(gdi->dc, gdi->font);
+	GetTextMetricsA(gdi->dc, &gdi->metric);
+
+	return [gdi](uint32_t code, GlyphBitmap& bitmap) {
+		const MAT2 identity = {{0, 1}, {0, 0}, {0, 0}, {0, 1}};
+		GLYPHMETRICS metrics{};
+		DWORD size = GetGlyphOutlineA(gdi->dc, code, GGO_GRAY8_BITMAP, &metrics, 0, nullptr, &identity);
+		if (size == GDI_ERROR) {
+			return false;
+		}
+
+		bitmap.advance = static_cast<float>(metrics.gmCellIncX);
+		bitmap.offsetX = static_cast<float>(metrics.gmptGlyphOrigin.x);
+		bitmap.offsetY = static_cast<float>(gdi->metric.tmAscent - metrics.gmptGlyphOrigin.y);
+		if (size == 0) {
+			// 空白
+			bitmap.width = 0;
+			bitmap.height = 0;
+			bitmap.coverage.clear();
+			return true;
+		}
+
+		std::vector<uint8_t> buffer(size);
+		GetGlyphOutlineA(gdi->dc, code, GGO_GRAY8_BITMAP, &metrics, size, buffer.data(), &identity);
+
+		// 65階調で行は4バイト境界
+		bitmap.width = metrics.gmBlackBoxX;
+		bitmap.height = metrics.gmBlackBoxY;
+		uint32_t pitch = (bitmap.width + 3) & ~3u;
+		bitmap.coverage.resize(static_cast<size_t>(bitmap.width) * bitmap.height);
+		for (uint32_t y = 0; y < bitmap.height; y++) {
+			for (uint32_t x = 0; x < bitmap.width; x++) {
+				uint32_t value = buffer[static_cast<size_t>(y) * pitch + x];
+				bitmap.coverage[static_cast<size_t>(y) * bitmap.width + x] =
+				  static_cast<uint8_t>((std::min)(value * 255 / 64, 255u));
+			}
+		}
+		return true;
+	};
+}
+#endif
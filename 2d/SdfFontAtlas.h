@@ -0,0 +1,128 @@
+﻿#pragma once
+
+#include "SdfGenerator.h"
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// 距離場フォントアトラス
+/// （グリフの被覆率画像を集め、グリフ単位で並列に距離場を作って1枚に詰める）
+/// </summary>
+class SdfFontAtlas {
+  public:
+	/// <summary>
+	/// グリフの被覆率画像（ピクセル単位は入力解像度）
+	/// </summary>
+	struct GlyphBitmap {
+		std::vector<uint8_t> coverage;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		// ペン位置（行の左上）から画像左上までのずれ
+		float offsetX = 0.0f;
+		float offsetY = 0.0f;
+		// 送り幅
+		float advance = 0.0f;
+	};
+
+	// グリフの供給元（文字コードを受け取って被覆率画像を返す。無い文字はfalse）
+	using GlyphSource = std::function<bool(uint32_t code, GlyphBitmap& bitmap)>;
+
+	/// <summary>
+	/// 生成設定
+	/// </summary>
+	struct Settings {
+		uint32_t firstCode = 32;   // 最初の文字コード
+		uint32_t lastCode = 126;   // 最後の文字コード
+		uint32_t downscale = 4;    // 入力 / アトラスの解像度比
+		uint32_t spread = 4;       // 距離の範囲（アトラスのピクセル）
+		uint32_t atlasWidth = 512; // アトラスの幅（高さは収まるまで広げる）
+		float lineHeight = 0.0f;   // 行の高さ（入力解像度。0なら最も高いグリフ）
+	};
+
+	/// <summary>
+	/// アトラス内のグリフ（単位はアトラスのピクセル）
+	/// </summary>
+	struct Glyph {
+		float uvRect[4]; // uv範囲（左, 上, 右, 下）
+		float offset[2]; // ペン位置から矩形左上までのずれ（距離の範囲の余白込み）
+		float size[2];   // 矩形の大きさ（距離の範囲の余白込み）
+		float advance;   // 送り幅
+	};
+
+	/// <summary>
+	/// 生成の統計
+	/// </summary>
+	struct Stats {
+		uint32_t glyphCount = 0;        // グリフ数
+		double rasterizeMilliseconds = 0.0; // 被覆率画像の収集時間
+		double generateMilliseconds = 0.0;  // 距離場生成時間（並列）
+		double packMilliseconds = 0.0;      // 詰め込み時間
+		float averageError = 0.0f;      // 形の不一致率の平均
+		float maxError = 0.0f;          // 形の不一致率の最大
+		float occupancy = 0.0f;         // アトラスの充填率
+	};
+
+	/// <summary>
+	/// 生成
+	/// </summary>
+	/// <param name="source">グリフの供給元（呼び出しスレッドからのみ呼ぶ）</param>
+	/// <param name="settings">生成設定</param>
+	/// <returns>成否</returns>
+	bool Build(const GlyphSource& source, const Settings& settings);
+
+	/// <summary>
+	/// グリフの検索
+	/// </summary>
+	/// <returns>無ければnullptr</returns>
+	const Glyph* Find(uint32_t code) const;
+
+	/// <summary>
+	/// 等幅ビットマップフォント画像を供給元にする
+	/// （文字コード順に升目に並んだ画像を、アルファか輝度で拡大して被覆率とする）
+	/// </summary>
+	/// <param name="rgba">RGBA8の画素</param>
+	/// <param name="width">画像の幅</param>
+	/// <param name="height">画像の高さ</param>
+	/// <param name="rowPitch">1行のバイト数</param>
+	/// <param name="cellWidth">1文字の幅</param>
+	/// <param name="cellHeight">1文字の高さ</param>
+	/// <param name="cellsPerRow">1行の文字数</param>
+	/// <param name="upscale">拡大率</param>
+	/// <param name="firstCode">升目の先頭の文字コード</param>
+	/// <returns>供給元（画像は複製して保持する）</returns>
+	static GlyphSource CreateBitmapFontSource(
+	  const uint8_t* rgba, uint32_t width, uint32_t height, size_t rowPitch, uint32_t cellWidth,
+	  uint32_t cellHeight, uint32_t cellsPerRow, uint32_t upscale, uint32_t firstCode = 32);
+
+#ifdef _WIN32
+	/// <summary>
+	/// インストール済みのフォントをGDIで描いて供給元にする
+	/// </summary>
+	/// <param name="faceName">フォント名</param>
+	/// <param name="pixelHeight">描画する文字の高さ（入力解像度）</param>
+	/// <returns>供給元</returns>
+	static GlyphSource CreateSystemFontSource(const char* faceName, int pixelHeight);
+#endif
+
+	const std::vector<uint8_t>& GetPixels() const { return pixels_; }
+	uint32_t GetWidth() const { return width_; }
+	uint32_t GetHeight() const { return height_; }
+	float GetLineHeight() const { return lineHeight_; }
+	uint32_t GetSpread() const { return spread_; }
+	const Stats& GetStats() const { return stats_; }
+
+  private:
+	// グリフ
+	std::unordered_map<uint32_t, Glyph> glyphs_;
+	// アトラス（R8）
+	std::vector<uint8_t> pixels_;
+	uint32_t width_ = 0;
+	uint32_t height_ = 0;
+	// 行の高さ（アトラスのピクセル）
+	float lineHeight_ = 0.0f;
+	// 距離の範囲（アトラスのピクセル）
+	uint32_t spread_ = 0;
+	// 統計
+	Stats stats_;
+};
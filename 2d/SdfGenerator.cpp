@@ -0,0 +1,195 @@
+﻿#include "SdfGenerator.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+// 特徴点以外の初期値
+const float kInfinity = 1e20f;
+// 内側とみなす被覆率
+const uint8_t kInsideThreshold = 128;
+} // namespace
+
+void SdfGenerator::Generate(
+  const uint8_t* coverage, uint32_t width, uint32_t height, uint32_t downscale, uint32_t spread,
+  Result& result) {
+	assert(0 < downscale);
+
+	// 周囲に距離の範囲分の余白を足した高解像度グリッド
+	const uint32_t pad = spread * downscale;
+	const uint32_t gridWidth = width + pad * 2;
+	const uint32_t gridHeight = height + pad * 2;
+	const size_t gridSize = static_cast<size_t>(gridWidth) * gridHeight;
+
+	// 外側の点から内側までの距離と、内側の点から外側までの距離を別々に求める
+	std::vector<float> toInside(gridSize, kInfinity);
+	std::vector<float> toOutside(gridSize, 0.0f);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			if (kInsideThreshold <= coverage[static_cast<size_t>(y) * width + x]) {
+				size_t index = static_cast<size_t>(y + pad) * gridWidth + (x + pad);
+				toInside[index] = 0.0f;
+				toOutside[index] = kInfinity;
+			}
+		}
+	}
+	DistanceTransform(toInside, gridWidth, gridHeight);
+	DistanceTransform(toOutside, gridWidth, gridHeight);
+
+	// 出力ピクセルの中心に当たる位置の符号付き距離を書き出す
+	result.padding = spread;
+	result.width = gridWidth / downscale;
+	result.height = gridHeight / downscale;
+	result.pixels.resize(static_cast<size_t>(result.width) * result.height);
+
+	// 高解像度の画素ごとの符号付き距離（外側が正。画素中心同士の距離なので境界は半画素ずらす）
+	std::vector<float>& distance = toInside;
+	for (size_t i = 0; i < gridSize; i++) {
+		float d = std::sqrt(toInside[i]) - std::sqrt(toOutside[i]);
+		distance[i] = d + ((0.0f < d) ? -0.5f : 0.5f);
+	}
+
+	// 出力ピクセルの中心に当たる位置をバイリニアで引く
+	const float range = static_cast<float>((std::max)(pad, 1u));
+	for (uint32_t y = 0; y < result.height; y++) {
+		float gy = (std::max)((y + 0.5f) * downscale - 0.5f, 0.0f);
+		uint32_t y0 = (std::min)(static_cast<uint32_t>(gy), gridHeight - 1);
+		uint32_t y1 = (std::min)(y0 + 1, gridHeight - 1);
+		float fy = gy - y0;
+		for (uint32_t x = 0; x < result.width; x++) {
+			float gx = (std::max)((x + 0.5f) * downscale - 0.5f, 0.0f);
+			uint32_t x0 = (std::min)(static_cast<uint32_t>(gx), gridWidth - 1);
+			uint32_t x1 = (std::min)(x0 + 1, gridWidth - 1);
+			float fx = gx - x0;
+
+			const float* row0 = &distance[static_cast<size_t>(y0) * gridWidth];
+			const float* row1 = &distance[static_cast<size_t>(y1) * gridWidth];
+			float top = row0[x0] + (row0[x1] - row0[x0]) * fx;
+			float bottom = row1[x0] + (row1[x1] - row1[x0]) * fx;
+			float d = top + (bottom - top) * fy;
+
+			float value = 0.5f - d / (range * 2.0f);
+			value = (std::min)((std::max)(value, 0.0f), 1.0f);
+			result.pixels[static_cast<size_t>(y) * result.width + x] =
+			  static_cast<uint8_t>(value * 255.0f + 0.5f);
+		}
+	}
+}
+
+float SdfGenerator::MeasureError(
+  const uint8_t* coverage, uint32_t width, uint32_t height, uint32_t downscale,
+  const Result& result) {
+	if (result.width == 0 || result.height == 0) {
+		return 1.0f;
+	}
+
+	// 距離場をバイリニアで引く
+	auto sample = [&](float u, float v) {
+		u = (std::min)((std::max)(u, 0.0f), static_cast<float>(result.width - 1));
+		v = (std::min)((std::max)(v, 0.0f), static_cast<float>(result.height - 1));
+		uint32_t x0 = static_cast<uint32_t>(u);
+		uint32_t y0 = static_cast<uint32_t>(v);
+		uint32_t x1 = (std::min)(x0 + 1, result.width - 1);
+		uint32_t y1 = (std::min)(y0 + 1, result.height - 1);
+		float fx = u - x0;
+		float fy = v - y0;
+		auto at = [&](uint32_t x, uint32_t y) {
+			return result.pixels[static_cast<size_t>(y) * result.width + x] / 255.0f;
+		};
+		float top = at(x0, y0) + (at(x1, y0) - at(x0, y0)) * fx;
+		float bottom = at(x0, y1) + (at(x1, y1) - at(x0, y1)) * fx;
+		return top + (bottom - top) * fy;
+	};
+
+	auto inside = [&](uint32_t x, uint32_t y) {
+		return kInsideThreshold <= coverage[static_cast<size_t>(y) * width + x];
+	};
+
+	// 輪郭から縮小率の範囲内にある画素だけを数える（平坦な部分で割合が薄まらないように）
+	const uint32_t pad = result.padding * downscale;
+	size_t edgeCount = 0;
+	size_t errorCount = 0;
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			bool isInside = inside(x, y);
+			bool nearEdge = false;
+			for (uint32_t ny = (y < downscale ? 0 : y - downscale);
+			     ny <= (std::min)(y + downscale, height - 1) && !nearEdge; ny++) {
+				for (uint32_t nx = (x < downscale ? 0 : x - downscale);
+				     nx <= (std::min)(x + downscale, width - 1); nx++) {
+					if (inside(nx, ny) != isInside) {
+						nearEdge = true;
+						break;
+					}
+				}
+			}
+			if (!nearEdge) {
+				continue;
+			}
+			edgeCount++;
+
+			// 入力画素の中心を出力座標に写す
+			float u = (x + pad + 0.5f) / downscale - 0.5f;
+			float v = (y + pad + 0.5f) / downscale - 0.5f;
+			if ((0.5f <= sample(u, v)) != isInside) {
+				errorCount++;
+			}
+		}
+	}
+	return edgeCount == 0 ? 0.0f : static_cast<float>(errorCount) / edgeCount;
+}
+
+void SdfGenerator::DistanceTransform(std::vector<float>& grid, uint32_t width, uint32_t height) {
+	const uint32_t length = (std::max)(width, height);
+	std::vector<float> f(length);
+	std::vector<float> d(length);
+	std::vector<int32_t> v(length);
+	std::vector<float> z(length + 1);
+
+	// 列方向
+	for (uint32_t x = 0; x < width; x++) {
+		for (uint32_t y = 0; y < height; y++) {
+			f[y] = grid[static_cast<size_t>(y) * width + x];
+		}
+		DistanceTransform1D(f.data(), height, d.data(), v.data(), z.data());
+		for (uint32_t y = 0; y < height; y++) {
+			grid[static_cast<size_t>(y) * width + x] = d[y];
+		}
+	}
+
+	// 行方向
+	for (uint32_t y = 0; y < height; y++) {
+		float* row = &grid[static_cast<size_t>(y) * width];
+		std::copy(row, row + width, f.begin());
+		DistanceTransform1D(f.data(), width, d.data(), v.data(), z.data());
+		std::copy(d.begin(), d.begin() + width, row);
+	}
+}
+
+void SdfGenerator::DistanceTransform1D(const float* f, uint32_t n, float* d, int32_t* v, float* z) {
+	// 下側包絡線を作る放物線の頂点と、その担当区間の境界
+	int32_t k = 0;
+	v[0] = 0;
+	z[0] = -kInfinity;
+	z[1] = kInfinity;
+	for (int32_t q = 1; q < static_cast<int32_t>(n); q++) {
+		float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * (q - v[k]));
+		while (s <= z[k]) {
+			k--;
+			s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * (q - v[k]));
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = kInfinity;
+	}
+
+	k = 0;
+	for (int32_t q = 0; q < static_cast<int32_t>(n); q++) {
+		while (z[k + 1] < q) {
+			k++;
+		}
+		float diff = static_cast<float>(q - v[k]);
+		d[q] = diff * diff + f[v[k]];
+	}
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 符号付き距離場の生成（高解像度の被覆率画像から、縮小した距離場画像を作る）
+/// </summary>
+class SdfGenerator {
+  public:
+	/// <summary>
+	/// 生成結果
+	/// </summary>
+	struct Result {
+		// 距離場（0.5が輪郭、内側ほど大きい）
+		std::vector<uint8_t> pixels;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		// 出力画像の左上に足した余白（出力ピクセル）
+		uint32_t padding = 0;
+	};
+
+	/// <summary>
+	/// 生成
+	/// </summary>
+	/// <param name="coverage">被覆率（128以上を内側とみなす）</param>
+	/// <param name="width">入力の幅</param>
+	/// <param name="height">入力の高さ</param>
+	/// <param name="downscale">縮小率（入力ピクセル / 出力ピクセル）</param>
+	/// <param name="spread">距離を表現する範囲（出力ピクセル）。周囲の余白にもなる</param>
+	/// <param name="result">格納先</param>
+	static void Generate(
+	  const uint8_t* coverage, uint32_t width, uint32_t height, uint32_t downscale, uint32_t spread,
+	  Result& result);
+
+	/// <summary>
+	/// 距離場から復元した形と元の形の不一致率（不一致画素数 / 輪郭付近の画素数）
+	/// </summary>
+	/// <param name="coverage">元の被覆率</param>
+	/// <param name="width">元の幅</param>
+	/// <param name="height">元の高さ</param>
+	/// <param name="downscale">生成時の縮小率</param>
+	/// <param name="result">生成結果</param>
+	/// <returns>不一致率（0が完全一致）</returns>
+	static float MeasureError(
+	  const uint8_t* coverage, uint32_t width, uint32_t height, uint32_t downscale,
+	  const Result& result);
+
+  private:
+	/// <summary>
+	/// 2乗ユークリッド距離変換（Felzenszwalb-Huttenlocher）
+	/// </summary>
+	/// <param name="grid">0なら特徴点、それ以外は大きな値。距離の2乗で上書きされる</param>
+	static void DistanceTransform(std::vector<float>& grid, uint32_t width, uint32_t height);
+
+	/// <summary>
+	/// 1次元の2乗距離変換
+	/// </summary>
+	static void DistanceTransform1D(
+	  const float* f, uint32_t n, float* d, int32_t* v, float* z);
+};
@@ -0,0 +1,103 @@
+﻿#include "SkylinePacker.h"
+#include <algorithm>
+
+void SkylinePacker::Initialize(uint32_t width, uint32_t height) {
+	width_ = width;
+	height_ = height;
+	usedArea_ = 0;
+	skyline_.clear();
+	skyline_.push_back({0, 0, width});
+}
+
+bool SkylinePacker::Insert(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y) {
+	// 上端が最も低くなる位置を選ぶ（同じなら区間幅の狭い方）
+	size_t bestIndex = skyline_.size();
+	uint32_t bestTop = UINT32_MAX;
+	uint32_t bestWidth = UINT32_MAX;
+	uint32_t bestY = 0;
+
+	for (size_t i = 0; i < skyline_.size(); i++) {
+		uint32_t fitY = 0;
+		if (!Fit(i, width, height, fitY)) {
+			continue;
+		}
+		uint32_t top = fitY + height;
+		if (top < bestTop || (top == bestTop && skyline_[i].width < bestWidth)) {
+			bestIndex = i;
+			bestTop = top;
+			bestWidth = skyline_[i].width;
+			bestY = fitY;
+		}
+	}
+
+	if (bestIndex == skyline_.size()) {
+		return false;
+	}
+
+	x = skyline_[bestIndex].x;
+	y = bestY;
+	AddLevel(bestIndex, x, y, width, height);
+	usedArea_ += static_cast<uint64_t>(width) * height;
+	return true;
+}
+
+float SkylinePacker::GetOccupancy() const {
+	if (width_ == 0 || height_ == 0) {
+		return 0.0f;
+	}
+	return static_cast<float>(static_cast<double>(usedArea_) / (static_cast<double>(width_) * height_));
+}
+
+bool SkylinePacker::Fit(size_t index, uint32_t width, uint32_t height, uint32_t& y) const {
+	uint32_t x = skyline_[index].x;
+	if (width_ < x + width) {
+		return false;
+	}
+
+	// 矩形の幅が覆う区間の最も高い位置に乗せる
+	uint32_t widthLeft = width;
+	y = skyline_[index].y;
+	for (size_t i = index; 0 < widthLeft; i++) {
+		if (skyline_.size() <= i) {
+			return false;
+		}
+		y = (std::max)(y, skyline_[i].y);
+		if (height_ < y + height) {
+			return false;
+		}
+		widthLeft -= (std::min)(widthLeft, skyline_[i].width);
+	}
+	return true;
+}
+
+void SkylinePacker::AddLevel(size_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+	skyline_.insert(skyline_.begin() + index, {x, y + height, width});
+
+	// 新しい区間に覆われた後続区間を削る
+	for (size_t i = index + 1; i < skyline_.size();) {
+		Node& prev = skyline_[i - 1];
+		Node& node = skyline_[i];
+		uint32_t prevRight = prev.x + prev.width;
+		if (prevRight <= node.x) {
+			break;
+		}
+		uint32_t shrink = prevRight - node.x;
+		if (node.width <= shrink) {
+			skyline_.erase(skyline_.begin() + i);
+			continue;
+		}
+		node.x += shrink;
+		node.width -= shrink;
+		break;
+	}
+
+	// 同じ高さで隣接する区間を結合する
+	for (size_t i = 0; i + 1 < skyline_.size();) {
+		if (skyline_[i].y == skyline_[i + 1].y) {
+			skyline_[i].width += skyline_[i + 1].width;
+			skyline_.erase(skyline_.begin() + i + 1);
+		} else {
+			i++;
+		}
+	}
+}
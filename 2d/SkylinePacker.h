@@ -0,0 +1,65 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// スカイライン法による矩形詰め込み
+/// </summary>
+class SkylinePacker {
+  public:
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="width">領域の幅</param>
+	/// <param name="height">領域の高さ</param>
+	void Initialize(uint32_t width, uint32_t height);
+
+	/// <summary>
+	/// 矩形の配置
+	/// </summary>
+	/// <param name="width">矩形の幅</param>
+	/// <param name="height">矩形の高さ</param>
+	/// <param name="x">配置先の左上X</param>
+	/// <param name="y">配置先の左上Y</param>
+	/// <returns>配置できればtrue</returns>
+	bool Insert(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y);
+
+	/// <summary>
+	/// 配置済み面積の割合の取得
+	/// </summary>
+	/// <returns>充填率(0～1)</returns>
+	float GetOccupancy() const;
+
+	uint32_t GetWidth() const { return width_; }
+	uint32_t GetHeight() const { return height_; }
+
+  private:
+	// スカイラインの一区間
+	struct Node {
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+	};
+
+	/// <summary>
+	/// 指定区間から始まる位置に置いた時の高さを求める
+	/// </summary>
+	/// <returns>置けなければfalse</returns>
+	bool Fit(size_t index, uint32_t width, uint32_t height, uint32_t& y) const;
+
+	/// <summary>
+	/// 配置した矩形でスカイラインを更新する
+	/// </summary>
+	void AddLevel(size_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+	// スカイライン
+	std::vector<Node> skyline_;
+	// 領域の幅
+	uint32_t width_ = 0;
+	// 領域の高さ
+	uint32_t height_ = 0;
+	// 配置済み面積
+	uint64_t usedArea_ = 0;
+};
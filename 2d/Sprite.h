@@ -186,6 +186,10 @@ class Sprite {
 	/// <param name="texSize">テクスチャサイズ</param>
 	void SetTextureRect(const Vector2& texBase, const Vector2& texSize);
 
+	const Vector2& GetTextureBase() { return texBase_; }
+
+	const Vector2& GetTextureSize() { return texSize_; }
+
 	/// <summary>
 	/// 描画
 	/// </summary>
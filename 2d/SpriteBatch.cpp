@@ -0,0 +1,345 @@
+﻿#include "SpriteBatch.h"
+#include "FrameUploadAllocator.h"
+#include "MathUtility.h"
+#include "PipelineCache.h"
+#include "ShaderLibrary.h"
+#include "TextureManager.h"
+#include <algorithm>
+#include <cassert>
+#include <d3dx12.h>
+
+using namespace Microsoft::WRL;
+
+namespace {
+// 頂点レイアウト（パイプラインは使うときに作るので、設定から指したままにする）
+const D3D12_INPUT_ELEMENT_DESC kInputLayout[] = {
+  {// xy座標
+   "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+  {// uv座標
+   "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+  {// 色
+   "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+};
+
+// ブレンド設定
+D3D12_RENDER_TARGET_BLEND_DESC CreateBlendDesc(Sprite::BlendMode blendMode) {
+	D3D12_RENDER_TARGET_BLEND_DESC blenddesc{};
+	blenddesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL; // RBGA全てのチャンネルを描画
+	blenddesc.BlendEnable = true;
+	blenddesc.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	blenddesc.SrcBlendAlpha = D3D12_BLEND_ONE;
+	blenddesc.DestBlendAlpha = D3D12_BLEND_ZERO;
+
+	switch (blendMode) {
+	case Sprite::BlendMode::kNone:
+		blenddesc.BlendEnable = false;
+		break;
+	case Sprite::BlendMode::kNormal:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+		break;
+	case Sprite::BlendMode::kAdd:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	case Sprite::BlendMode::kSubtract:
+		blenddesc.BlendOp = D3D12_BLEND_OP_REV_SUBTRACT;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	case Sprite::BlendMode::kMultily:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_ZERO;
+		blenddesc.DestBlend = D3D12_BLEND_SRC_COLOR;
+		break;
+	case Sprite::BlendMode::kScreen:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_INV_DEST_COLOR;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	default:
+		break;
+	}
+	return blenddesc;
+}
+} // namespace
+
+SpriteBatch* SpriteBatch::GetInstance() {
+	static SpriteBatch instance;
+	return &instance;
+}
+
+void SpriteBatch::Initialize(
+  ID3D12Device* device, int window_width, int window_height, const std::wstring& directoryPath) {
+	assert(device);
+
+	device_ = device;
+
+	// スプライトと同じ並行投影
+	matProjection_ = MathUtility::Matrix4Orthographic(
+	  0.0f, (float)window_width, (float)window_height, 0.0f, 0.0f, 1.0f);
+
+	CreateGraphicsPipelines(directoryPath);
+
+	HRESULT result;
+
+	// インデックスバッファ（全矩形で共通なので最大数分を作っておく）
+	UINT sizeIB = static_cast<UINT>(sizeof(uint16_t) * kMaxQuadsPerDraw * SpriteQuad::kIndexCount);
+	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeIB);
+	result = device_->CreateCommittedResource(
+	  &heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+	  IID_PPV_ARGS(&indexBuff_));
+	assert(SUCCEEDED(result));
+
+	uint16_t* indexMap = nullptr;
+	result = indexBuff_->Map(0, nullptr, (void**)&indexMap);
+	assert(SUCCEEDED(result));
+	SpriteQuad::BuildIndices(kMaxQuadsPerDraw, indexMap);
+	indexBuff_->Unmap(0, nullptr);
+
+	ibView_.address = indexBuff_->GetGPUVirtualAddress();
+	ibView_.format = RenderIndexFormat::kUint16;
+	ibView_.size = sizeIB;
+}
+
+void SpriteBatch::Begin(ID3D12GraphicsCommandList* cmdList, SortMode sortMode) {
+	assert(cmdList);
+	d3d12CommandList_.SetCommandList(cmdList);
+	Begin(&d3d12CommandList_, sortMode);
+}
+
+void SpriteBatch::Begin(RenderCommandList* commandList, SortMode sortMode) {
+	assert(commandList);
+	assert(!commandList_);
+
+	commandList_ = commandList;
+	sortMode_ = sortMode;
+	quads_.clear();
+	items_.clear();
+}
+
+void SpriteBatch::Draw(const Quad& quad) {
+	assert(commandList_);
+
+	// テクスチャの大きさからuv範囲を求める
+	D3D12_RESOURCE_DESC resDesc = TextureManager::GetInstance()->GetResoureDesc(quad.textureHandle);
+
+	SpriteQuad::Desc desc;
+	desc.position[0] = quad.position.x;
+	desc.position[1] = quad.position.y;
+	desc.rotation = quad.rotation;
+	desc.size[0] = quad.size.x;
+	desc.size[1] = quad.size.y;
+	desc.anchorPoint[0] = quad.anchorPoint.x;
+	desc.anchorPoint[1] = quad.anchorPoint.y;
+	const float texBase[2] = {quad.texBase.x, quad.texBase.y};
+	const float texSize[2] = {quad.texSize.x, quad.texSize.y};
+	SpriteQuad::SetTextureRect(
+	  desc, texBase, texSize, static_cast<float>(resDesc.Width),
+	  static_cast<float>(resDesc.Height));
+	desc.color = SpriteQuad::PackColor(quad.color.x, quad.color.y, quad.color.z, quad.color.w);
+	desc.isFlipX = quad.isFlipX;
+	desc.isFlipY = quad.isFlipY;
+
+	uint32_t index = static_cast<uint32_t>(quads_.size());
+	quads_.push_back(desc);
+	items_.push_back({MakeKey(quad.textureHandle, quad.blendMode, quad.shaderMode), index});
+}
+
+void SpriteBatch::Draw(Sprite* sprite, BlendMode blendMode) {
+	assert(sprite);
+
+	Quad quad;
+	quad.textureHandle = sprite->GetTextureHandle();
+	quad.position = sprite->GetPosition();
+	quad.rotation = sprite->GetRotation();
+	quad.size = sprite->GetSize();
+	quad.anchorPoint = sprite->GetAnchorPoint();
+	quad.color = sprite->GetColor();
+	quad.isFlipX = sprite->GetIsFlipX();
+	quad.isFlipY = sprite->GetIsFlipY();
+	// アトラスのページなどを指すスプライトはテクスチャ範囲で切り出す
+	quad.texBase = sprite->GetTextureBase();
+	quad.texSize = sprite->GetTextureSize();
+	quad.blendMode = blendMode;
+	Draw(quad);
+}
+
+void SpriteBatch::Draw(
+  uint32_t textureHandle, const SpriteQuad::Desc* quads, size_t count, BlendMode blendMode,
+  ShaderMode shaderMode) {
+	assert(commandList_);
+
+	uint64_t key = MakeKey(textureHandle, blendMode, shaderMode);
+	uint32_t index = static_cast<uint32_t>(quads_.size());
+	quads_.insert(quads_.end(), quads, quads + count);
+	for (size_t i = 0; i < count; i++) {
+		items_.push_back({key, index + static_cast<uint32_t>(i)});
+	}
+}
+
+void SpriteBatch::End() {
+	assert(commandList_);
+
+	drawCallCount_ = 0;
+	quadCount_ = static_cast<uint32_t>(quads_.size());
+	if (quads_.empty()) {
+		commandList_ = nullptr;
+		return;
+	}
+
+	// シェーダ、ブレンドモード、テクスチャで並べ替え（同じ組の中は追加順を保つ）
+	if (sortMode_ == SortMode::kTexture) {
+		std::sort(items_.begin(), items_.end(), [](const Item& lhs, const Item& rhs) {
+			return lhs.key != rhs.key ? lhs.key < rhs.key : lhs.index < rhs.index;
+		});
+	}
+	sortedQuads_.resize(quads_.size());
+	for (size_t i = 0; i < items_.size(); i++) {
+		sortedQuads_[i] = quads_[items_[i].index];
+	}
+
+	// このフレームの一時領域に頂点を展開
+	UINT sizeVB = static_cast<UINT>(sizeof(SpriteQuad::Vertex) * SpriteQuad::kVertexCount * quadCount_);
+	FrameUploadAllocator::Allocation allocation =
+	  FrameUploadAllocator::GetInstance()->Allocate(sizeVB);
+	SpriteQuad::Expand(
+	  sortedQuads_.data(), sortedQuads_.size(),
+	  static_cast<SpriteQuad::Vertex*>(allocation.cpuAddress));
+
+	// 頂点バッファビュー
+	RenderVertexBufferView vbView;
+	vbView.address = allocation.gpuAddress;
+	vbView.size = sizeVB;
+	vbView.stride = sizeof(SpriteQuad::Vertex);
+
+	commandList_->SetGraphicsRootSignature(D3D12RenderCommandList::Wrap(rootSignature_.Get()));
+	commandList_->SetGraphicsRoot32BitConstants(0, 16, &matProjection_, 0);
+	commandList_->SetPrimitiveTopology(RenderTopology::kTriangleList);
+	commandList_->SetVertexBuffers(0, 1, &vbView);
+	commandList_->SetIndexBuffer(ibView_);
+
+	// 同じシェーダ、ブレンドモード、テクスチャが続く範囲ごとに描画
+	TextureManager* textureManager = TextureManager::GetInstance();
+	uint64_t currentPipeline = UINT64_MAX;
+	for (uint32_t begin = 0; begin < quadCount_;) {
+		uint64_t key = items_[begin].key;
+		uint32_t end = begin + 1;
+		while (end < quadCount_ && items_[end].key == key && end - begin < kMaxQuadsPerDraw) {
+			end++;
+		}
+
+		uint64_t pipeline = key >> 32;
+		if (pipeline != currentPipeline) {
+			uint64_t shader = pipeline >> 8;
+			uint64_t blend = pipeline & 0xff;
+			commandList_->SetPipelineState(
+			  D3D12RenderCommandList::Wrap(GetPipelineState(shader, blend)));
+			currentPipeline = pipeline;
+		}
+		textureManager->SetGraphicsRootDescriptorTable(
+		  commandList_, 1, static_cast<uint32_t>(key & 0xffffffff));
+		commandList_->DrawIndexedInstanced(
+		  (end - begin) * SpriteQuad::kIndexCount, 1, 0,
+		  static_cast<int32_t>(begin * SpriteQuad::kVertexCount), 0);
+		drawCallCount_++;
+
+		begin = end;
+	}
+
+	commandList_ = nullptr;
+}
+
+void SpriteBatch::CreateGraphicsPipelines(const std::wstring& directoryPath) {
+	HRESULT result;
+
+	// シェーダの読み込みとコンパイル
+	ShaderLibrary* shaderLibrary = ShaderLibrary::GetInstance();
+	vs_ = shaderLibrary->Load(directoryPath + L"shaders/SpriteBatchVS.hlsl", "vs_5_0");
+	ps_[size_t(ShaderMode::kTexture)] =
+	  shaderLibrary->Load(directoryPath + L"shaders/SpriteBatchPS.hlsl", "ps_5_0");
+	ps_[size_t(ShaderMode::kDistanceField)] =
+	  shaderLibrary->Load(directoryPath + L"shaders/SpriteBatchSdfPS.hlsl", "ps_5_0");
+
+	// デスクリプタレンジ
+	CD3DX12_DESCRIPTOR_RANGE descRangeSRV;
+	descRangeSRV.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0); // t0 レジスタ
+
+	// ルートパラメータ
+	CD3DX12_ROOT_PARAMETER rootparams[2];
+	rootparams[0].InitAsConstants(16, 0, 0, D3D12_SHADER_VISIBILITY_VERTEX); // 射影行列
+	rootparams[1].InitAsDescriptorTable(1, &descRangeSRV, D3D12_SHADER_VISIBILITY_ALL);
+
+	// スタティックサンプラー（距離場は補間して読むので線形も用意する）
+	CD3DX12_STATIC_SAMPLER_DESC samplerDescs[] = {
+	  CD3DX12_STATIC_SAMPLER_DESC(0, D3D12_FILTER_MIN_MAG_MIP_POINT),
+	  CD3DX12_STATIC_SAMPLER_DESC(
+	    1, D3D12_FILTER_MIN_MAG_MIP_LINEAR, D3D12_TEXTURE_ADDRESS_MODE_CLAMP,
+	    D3D12_TEXTURE_ADDRESS_MODE_CLAMP, D3D12_TEXTURE_ADDRESS_MODE_CLAMP),
+	};
+
+	// ルートシグネチャの設定
+	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	rootSignatureDesc.Init_1_0(
+	  _countof(rootparams), rootparams, _countof(samplerDescs), samplerDescs,
+	  D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+	ComPtr<ID3DBlob> rootSigBlob;
+	ComPtr<ID3DBlob> errorBlob;
+	// バージョン自動判定のシリアライズ
+	result = D3DX12SerializeVersionedRootSignature(
+	  &rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &rootSigBlob, &errorBlob);
+	assert(SUCCEEDED(result));
+	// ルートシグネチャの生成
+	rootSignature_ = PipelineCache::GetInstance()->CreateRootSignature(rootSigBlob.Get());
+
+	// グラフィックスパイプラインの流れを設定
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC& gpipeline = pipelineDesc_;
+	gpipeline = D3D12_GRAPHICS_PIPELINE_STATE_DESC{};
+	gpipeline.VS = vs_;
+
+	// サンプルマスク
+	gpipeline.SampleMask = D3D12_DEFAULT_SAMPLE_MASK; // 標準設定
+	// ラスタライザステート
+	gpipeline.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	gpipeline.RasterizerState.CullMode = D3D12_CULL_MODE_NONE; // 背面カリングをしない
+	// デプスステンシルステート
+	gpipeline.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+	gpipeline.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_ALWAYS; // 常に上書きルール
+	gpipeline.DSVFormat = DXGI_FORMAT_D32_FLOAT; // 深度値フォーマット
+
+	gpipeline.InputLayout.pInputElementDescs = kInputLayout;
+	gpipeline.InputLayout.NumElements = _countof(kInputLayout);
+
+	gpipeline.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+
+	gpipeline.NumRenderTargets = 1;                            // 描画対象は1つ
+	gpipeline.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; // 0～255指定のRGBA
+	gpipeline.SampleDesc.Count = 1; // 1ピクセルにつき1回サンプリング
+
+	gpipeline.pRootSignature = rootSignature_.Get();
+
+	// シェーダの種類とブレンドモードごとのパイプラインは使うときに作る
+	for (auto& pipelineStates : pipelineStates_) {
+		for (ComPtr<ID3D12PipelineState>& pipelineState : pipelineStates) {
+			pipelineState.Reset();
+		}
+	}
+}
+
+ID3D12PipelineState* SpriteBatch::GetPipelineState(size_t shader, size_t blend) {
+	ComPtr<ID3D12PipelineState>& pipelineState = pipelineStates_[shader][blend];
+	if (!pipelineState) {
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC gpipeline = pipelineDesc_;
+		gpipeline.PS = ps_[shader];
+		gpipeline.BlendState.RenderTarget[0] = CreateBlendDesc(static_cast<BlendMode>(blend));
+		pipelineState = PipelineCache::GetInstance()->CreateGraphicsPipeline(gpipeline);
+	}
+	return pipelineState.Get();
+}
@@ -0,0 +1,204 @@
+﻿#pragma once
+
+#include "D3D12RenderCommandList.h"
+#include "Sprite.h"
+#include "SpriteQuad.h"
+#include <array>
+#include <d3d12.h>
+#include <string>
+#include <vector>
+#include <wrl.h>
+
+/// <summary>
+/// スプライトの一括描画
+/// （矩形を1つの頂点バッファにまとめ、テクスチャとブレンドモードが同じ範囲を1回で描画する）
+/// </summary>
+class SpriteBatch {
+  public:
+	using BlendMode = Sprite::BlendMode;
+
+	// 並べ替え方法
+	enum class SortMode {
+		kDeferred, //!< 追加順のまま、連続する同じテクスチャだけをまとめる
+		kTexture,  //!< ブレンドモードとテクスチャで並べ替えてまとめる（同じ組の中は追加順）
+	};
+
+	// ピクセルシェーダの種類
+	enum class ShaderMode {
+		kTexture,       //!< テクスチャの色をそのまま使う
+		kDistanceField, //!< 符号付き距離場の0.5を輪郭として描く（拡大しても縁がぼやけない）
+
+		kCountOfShaderMode, //!< シェーダの種類数
+	};
+
+	// 1回の描画の最大矩形数（16bitインデックスで引ける範囲）
+	static const uint32_t kMaxQuadsPerDraw = 65536 / SpriteQuad::kVertexCount;
+
+	/// <summary>
+	/// 矩形の設定
+	/// </summary>
+	struct Quad {
+		// テクスチャハンドル
+		uint32_t textureHandle = 0;
+		// 座標
+		Vector2 position = {0.0f, 0.0f};
+		// Z軸回りの回転角
+		float rotation = 0.0f;
+		// 幅、高さ
+		Vector2 size = {100.0f, 100.0f};
+		// アンカーポイント
+		Vector2 anchorPoint = {0.0f, 0.0f};
+		// テクスチャ始点（ピクセル）
+		Vector2 texBase = {0.0f, 0.0f};
+		// テクスチャ幅、高さ（ピクセル。0ならテクスチャ全体）
+		Vector2 texSize = {0.0f, 0.0f};
+		// 色
+		Vector4 color = {1.0f, 1.0f, 1.0f, 1.0f};
+		// 左右反転
+		bool isFlipX = false;
+		// 上下反転
+		bool isFlipY = false;
+		// ブレンドモード
+		BlendMode blendMode = BlendMode::kNormal;
+		// シェーダの種類
+		ShaderMode shaderMode = ShaderMode::kTexture;
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static SpriteBatch* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="device">デバイス</param>
+	/// <param name="window_width">画面幅</param>
+	/// <param name="window_height">画面高さ</param>
+	void Initialize(
+	  ID3D12Device* device, int window_width, int window_height,
+	  const std::wstring& directoryPath = L"Resources/");
+
+	/// <summary>
+	/// 描画開始（Sprite::PreDrawとPostDrawの間で呼ぶ）
+	/// </summary>
+	/// <param name="cmdList">描画コマンドリスト</param>
+	/// <param name="sortMode">並べ替え方法</param>
+	void Begin(ID3D12GraphicsCommandList* cmdList, SortMode sortMode = SortMode::kTexture);
+
+	/// <summary>
+	/// 描画開始（描画コマンドの発行先版。記録用のバックエンドにも描ける）
+	/// </summary>
+	/// <param name="commandList">描画コマンドの発行先</param>
+	/// <param name="sortMode">並べ替え方法</param>
+	void Begin(RenderCommandList* commandList, SortMode sortMode = SortMode::kTexture);
+
+	/// <summary>
+	/// 矩形の追加
+	/// </summary>
+	/// <param name="quad">矩形の設定</param>
+	void Draw(const Quad& quad);
+
+	/// <summary>
+	/// スプライトの内容で矩形を追加（テクスチャ範囲もスプライトのものを使う）
+	/// </summary>
+	/// <param name="sprite">スプライト</param>
+	/// <param name="blendMode">ブレンドモード</param>
+	void Draw(Sprite* sprite, BlendMode blendMode = BlendMode::kNormal);
+
+	/// <summary>
+	/// 展開前の矩形をまとめて追加（uv範囲と色は設定済みのものをそのまま使う）
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	/// <param name="quads">矩形の配列</param>
+	/// <param name="count">矩形数</param>
+	/// <param name="blendMode">ブレンドモード</param>
+	/// <param name="shaderMode">シェーダの種類</param>
+	void Draw(
+	  uint32_t textureHandle, const SpriteQuad::Desc* quads, size_t count,
+	  BlendMode blendMode = BlendMode::kNormal, ShaderMode shaderMode = ShaderMode::kTexture);
+
+	/// <summary>
+	/// 描画終了（溜めた矩形をフレームアップロードアロケータに展開してまとめて描画する）
+	/// （一括描画用のルートシグネチャ、パイプライン、トポロジが設定されたまま戻る。
+	/// 　Spriteの設定はライブラリの外から復元できないので、同じPreDraw～PostDrawの中では
+	/// 　Sprite::DrawをBeginより前に済ませるか、PostDrawとPreDrawで設定し直してから描く）
+	/// </summary>
+	void End();
+
+	/// <summary>
+	/// 直前のEndでの描画回数
+	/// </summary>
+	uint32_t GetDrawCallCount() const { return drawCallCount_; }
+
+	/// <summary>
+	/// 直前のEndでの矩形数
+	/// </summary>
+	uint32_t GetQuadCount() const { return quadCount_; }
+
+  private:
+	// 並べ替え用の要素
+	struct Item {
+		uint64_t key;
+		uint32_t index;
+	};
+
+	/// <summary>
+	/// 並べ替えキーの生成（シェーダ &lt;&lt; 40 | ブレンドモード &lt;&lt; 32 | テクスチャ）
+	/// </summary>
+	static uint64_t MakeKey(uint32_t textureHandle, BlendMode blendMode, ShaderMode shaderMode) {
+		return (static_cast<uint64_t>(shaderMode) << 40) | (static_cast<uint64_t>(blendMode) << 32) |
+		       textureHandle;
+	}
+
+	SpriteBatch() = default;
+	~SpriteBatch() = default;
+	SpriteBatch(const SpriteBatch&) = delete;
+	SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+	/// <summary>
+	/// グラフィックパイプライン生成
+	/// </summary>
+	void CreateGraphicsPipelines(const std::wstring& directoryPath);
+
+	/// <summary>
+	/// パイプラインステートの取得（初めて使う組み合わせはここで作る）
+	/// </summary>
+	ID3D12PipelineState* GetPipelineState(size_t shader, size_t blend);
+
+	// デバイス
+	ID3D12Device* device_ = nullptr;
+	// 描画コマンドの発行先
+	RenderCommandList* commandList_ = nullptr;
+	// D3D12のコマンドリストで始めたときの発行先
+	D3D12RenderCommandList d3d12CommandList_;
+	// ルートシグネチャ
+	Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature_;
+	// シェーダ（ShaderLibraryが持つバイトコードを指す）
+	D3D12_SHADER_BYTECODE vs_{};
+	std::array<D3D12_SHADER_BYTECODE, size_t(ShaderMode::kCountOfShaderMode)> ps_{};
+	// パイプラインの共通設定（ピクセルシェーダとブレンド以外）
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineDesc_{};
+	// パイプラインステートオブジェクト（シェーダの種類 × ブレンドモード。使うときに作る）
+	std::array<
+	  std::array<Microsoft::WRL::ComPtr<ID3D12PipelineState>, size_t(BlendMode::kCountOfBlendMode)>,
+	  size_t(ShaderMode::kCountOfShaderMode)>
+	  pipelineStates_;
+	// 射影行列
+	Matrix4 matProjection_;
+	// インデックスバッファ
+	Microsoft::WRL::ComPtr<ID3D12Resource> indexBuff_;
+	// インデックスバッファビュー
+	RenderIndexBufferView ibView_;
+	// 並べ替え方法
+	SortMode sortMode_ = SortMode::kTexture;
+	// 追加された矩形
+	std::vector<SpriteQuad::Desc> quads_;
+	std::vector<Item> items_;
+	// 並べ替え後の矩形
+	std::vector<SpriteQuad::Desc> sortedQuads_;
+	// 統計
+	uint32_t drawCallCount_ = 0;
+	uint32_t quadCount_ = 0;
+};
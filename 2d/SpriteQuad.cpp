@@ -0,0 +1,131 @@
+﻿#include "SpriteQuad.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define SPRITE_QUAD_USE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace {
+// 回転前の矩形の辺（Spriteと同じく反転は座標の符号で表す）
+void LocalEdges(
+  const SpriteQuad::Desc& quad, float& left, float& top, float& right, float& bottom) {
+	left = (0.0f - quad.anchorPoint[0]) * quad.size[0];
+	right = (1.0f - quad.anchorPoint[0]) * quad.size[0];
+	top = (0.0f - quad.anchorPoint[1]) * quad.size[1];
+	bottom = (1.0f - quad.anchorPoint[1]) * quad.size[1];
+	if (quad.isFlipX) {
+		left = -left;
+		right = -right;
+	}
+	if (quad.isFlipY) {
+		top = -top;
+		bottom = -bottom;
+	}
+}
+} // namespace
+
+uint32_t SpriteQuad::PackColor(float r, float g, float b, float a) {
+	auto toByte = [](float value) {
+		value = (std::min)((std::max)(value, 0.0f), 1.0f);
+		return static_cast<uint32_t>(value * 255.0f + 0.5f);
+	};
+	return toByte(r) | (toByte(g) << 8) | (toByte(b) << 16) | (toByte(a) << 24);
+}
+
+void SpriteQuad::SetTextureRect(
+  Desc& quad, const float texBase[2], const float texSize[2], float textureWidth,
+  float textureHeight) {
+	float width = texSize[0];
+	float height = texSize[1];
+	if (width == 0.0f && height == 0.0f) {
+		width = textureWidth;
+		height = textureHeight;
+	}
+	quad.uvRect[0] = texBase[0] / textureWidth;
+	quad.uvRect[1] = texBase[1] / textureHeight;
+	quad.uvRect[2] = (texBase[0] + width) / textureWidth;
+	quad.uvRect[3] = (texBase[1] + height) / textureHeight;
+}
+
+void SpriteQuad::Expand(const Desc* quads, size_t count, Vertex* vertices) {
+#ifdef SPRITE_QUAD_USE_SSE
+	for (size_t i = 0; i < count; i++) {
+		const Desc& quad = quads[i];
+		float left, top, right, bottom;
+		LocalEdges(quad, left, top, right, bottom);
+
+		float s = 0.0f;
+		float c = 1.0f;
+		if (quad.rotation != 0.0f) {
+			s = std::sin(quad.rotation);
+			c = std::cos(quad.rotation);
+		}
+
+		// 4頂点（左下, 左上, 右下, 右上）を1レジスタずつに並べて回転・平行移動
+		__m128 xs = _mm_set_ps(right, right, left, left);
+		__m128 ys = _mm_set_ps(top, bottom, top, bottom);
+		__m128 sinV = _mm_set1_ps(s);
+		__m128 cosV = _mm_set1_ps(c);
+		__m128 px = _mm_add_ps(
+		  _mm_sub_ps(_mm_mul_ps(xs, cosV), _mm_mul_ps(ys, sinV)), _mm_set1_ps(quad.position[0]));
+		__m128 py = _mm_add_ps(
+		  _mm_add_ps(_mm_mul_ps(xs, sinV), _mm_mul_ps(ys, cosV)), _mm_set1_ps(quad.position[1]));
+		__m128 u = _mm_set_ps(quad.uvRect[2], quad.uvRect[2], quad.uvRect[0], quad.uvRect[0]);
+		__m128 v = _mm_set_ps(quad.uvRect[1], quad.uvRect[3], quad.uvRect[1], quad.uvRect[3]);
+
+		// 頂点ごとの (x, y, u, v) に並べ替えて書き込む
+		_MM_TRANSPOSE4_PS(px, py, u, v);
+		Vertex* out = &vertices[i * kVertexCount];
+		_mm_storeu_ps(out[0].pos, px);
+		_mm_storeu_ps(out[1].pos, py);
+		_mm_storeu_ps(out[2].pos, u);
+		_mm_storeu_ps(out[3].pos, v);
+		out[0].color = quad.color;
+		out[1].color = quad.color;
+		out[2].color = quad.color;
+		out[3].color = quad.color;
+	}
+#else
+	ExpandScalar(quads, count, vertices);
+#endif
+}
+
+void SpriteQuad::ExpandScalar(const Desc* quads, size_t count, Vertex* vertices) {
+	for (size_t i = 0; i < count; i++) {
+		const Desc& quad = quads[i];
+		float left, top, right, bottom;
+		LocalEdges(quad, left, top, right, bottom);
+
+		float s = 0.0f;
+		float c = 1.0f;
+		if (quad.rotation != 0.0f) {
+			s = std::sin(quad.rotation);
+			c = std::cos(quad.rotation);
+		}
+
+		const float xs[kVertexCount] = {left, left, right, right};
+		const float ys[kVertexCount] = {bottom, top, bottom, top};
+		const float us[kVertexCount] = {quad.uvRect[0], quad.uvRect[0], quad.uvRect[2], quad.uvRect[2]};
+		const float vs[kVertexCount] = {quad.uvRect[3], quad.uvRect[1], quad.uvRect[3], quad.uvRect[1]};
+		Vertex* out = &vertices[i * kVertexCount];
+		for (uint32_t j = 0; j < kVertexCount; j++) {
+			out[j].pos[0] = xs[j] * c - ys[j] * s + quad.position[0];
+			out[j].pos[1] = xs[j] * s + ys[j] * c + quad.position[1];
+			out[j].uv[0] = us[j];
+			out[j].uv[1] = vs[j];
+			out[j].color = quad.color;
+		}
+	}
+}
+
+void SpriteQuad::BuildIndices(size_t count, uint16_t* indices) {
+	static const uint16_t kPattern[kIndexCount] = {0, 1, 2, 2, 1, 3};
+	for (size_t i = 0; i < count; i++) {
+		for (uint32_t j = 0; j < kIndexCount; j++) {
+			indices[i * kIndexCount + j] = static_cast<uint16_t>(i * kVertexCount + kPattern[j]);
+		}
+	}
+}
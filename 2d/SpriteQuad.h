@@ -0,0 +1,76 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// スプライト矩形の頂点展開
+/// （D3Dやエンジンの型に依存しないので単体で検証できる）
+/// </summary>
+class SpriteQuad {
+  public:
+	// 1矩形あたりの頂点数
+	static const uint32_t kVertexCount = 4;
+	// 1矩形あたりのインデックス数
+	static const uint32_t kIndexCount = 6;
+
+	/// <summary>
+	/// 頂点データ（SpriteBatchVS.hlslの入力と同じ並び）
+	/// </summary>
+	struct Vertex {
+		float pos[2];   // スクリーン座標
+		float uv[2];    // uv座標
+		uint32_t color; // RGBA8
+	};
+
+	/// <summary>
+	/// 矩形の設定
+	/// </summary>
+	struct Desc {
+		float position[2];    // 座標
+		float rotation;       // Z軸回りの回転角
+		float size[2];        // 幅、高さ
+		float anchorPoint[2]; // アンカーポイント
+		float uvRect[4];      // uv範囲（左, 上, 右, 下）
+		uint32_t color;       // RGBA8
+		bool isFlipX;         // 左右反転
+		bool isFlipY;         // 上下反転
+	};
+
+	/// <summary>
+	/// 色をRGBA8に詰める
+	/// </summary>
+	static uint32_t PackColor(float r, float g, float b, float a);
+
+	/// <summary>
+	/// テクスチャ範囲（ピクセル）からuv範囲を設定する（範囲の幅と高さが0ならテクスチャ全体）
+	/// </summary>
+	/// <param name="quad">設定先</param>
+	/// <param name="texBase">テクスチャ左上座標</param>
+	/// <param name="texSize">テクスチャ範囲の幅、高さ</param>
+	/// <param name="textureWidth">テクスチャの幅</param>
+	/// <param name="textureHeight">テクスチャの高さ</param>
+	static void SetTextureRect(
+	  Desc& quad, const float texBase[2], const float texSize[2], float textureWidth,
+	  float textureHeight);
+
+	/// <summary>
+	/// 頂点展開（左下, 左上, 右下, 右上の順。SIMDが使えれば4頂点をまとめて計算する）
+	/// </summary>
+	/// <param name="quads">矩形の配列</param>
+	/// <param name="count">矩形数</param>
+	/// <param name="vertices">格納先（count * kVertexCount要素）</param>
+	static void Expand(const Desc* quads, size_t count, Vertex* vertices);
+
+	/// <summary>
+	/// 頂点展開（スカラー版。SIMD版の検証用）
+	/// </summary>
+	static void ExpandScalar(const Desc* quads, size_t count, Vertex* vertices);
+
+	/// <summary>
+	/// インデックス生成（0, 1, 2, 2, 1, 3 を矩形ごとにずらして並べる）
+	/// </summary>
+	/// <param name="count">矩形数</param>
+	/// <param name="indices">格納先（count * kIndexCount要素）</param>
+	static void BuildIndices(size_t count, uint16_t* indices);
+};
@@ -0,0 +1,91 @@
+﻿#include "TextLayoutCache.h"
+#include <cstring>
+
+uint64_t TextLayoutCache::Hash(const char* text, size_t length) {
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= static_cast<unsigned char>(text[i]);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool TextLayoutCache::Append(
+  const char* text, size_t length, float x, float y, float scale,
+  std::vector<SpriteQuad::Desc>& glyphs) {
+	auto it = entries_.find({Hash(text, length), scale});
+	if (it == entries_.end() || it->second.text.size() != length ||
+	    memcmp(it->second.text.data(), text, length) != 0) {
+		missCount_++;
+		return false;
+	}
+
+	hitCount_++;
+	Entry& entry = it->second;
+	entry.lastUsedFrame = frame_;
+
+	// 並べたときからの移動量だけずらして写す
+	const float dx = x - entry.x;
+	const float dy = y - entry.y;
+	size_t first = glyphs.size();
+	glyphs.resize(first + entry.glyphs.size());
+	for (size_t i = 0; i < entry.glyphs.size(); i++) {
+		SpriteQuad::Desc& glyph = glyphs[first + i];
+		glyph = entry.glyphs[i];
+		glyph.position[0] += dx;
+		glyph.position[1] += dy;
+	}
+	return true;
+}
+
+void TextLayoutCache::Insert(
+  const char* text, size_t length, float x, float y, float scale, const SpriteQuad::Desc* glyphs,
+  size_t count) {
+	auto result = entries_.emplace(Key{Hash(text, length), scale}, Entry());
+	Entry& entry = result.first->second;
+	if (result.second && !spareEntries_.empty()) {
+		// 破棄した登録内容の領域を使い直す
+		entry.text.swap(spareEntries_.back().text);
+		entry.glyphs.swap(spareEntries_.back().glyphs);
+		spareEntries_.pop_back();
+	}
+	entry.text.assign(text, length);
+	entry.glyphs.assign(glyphs, glyphs + count);
+	entry.x = x;
+	entry.y = y;
+	entry.lastUsedFrame = frame_;
+}
+
+void TextLayoutCache::NextFrame() {
+	frame_++;
+	for (auto it = entries_.begin(); it != entries_.end();) {
+		if (maxUnusedFrames_ < frame_ - it->second.lastUsedFrame) {
+			Recycle(it->second);
+			it = entries_.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void TextLayoutCache::Clear() {
+	for (auto& pair : entries_) {
+		Recycle(pair.second);
+	}
+	entries_.clear();
+}
+
+void TextLayoutCache::Recycle(Entry& entry) {
+	spareEntries_.emplace_back();
+	spareEntries_.back().text.swap(entry.text);
+	spareEntries_.back().glyphs.swap(entry.glyphs);
+}
+
+size_t TextLayoutCache::KeyHasher::operator()(const Key& key) const {
+	uint32_t bits;
+	memcpy(&bits, &key.scale, sizeof(float));
+
+	uint64_t hash = key.hash;
+	hash ^= bits + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+	return static_cast<size_t>(hash);
+}
@@ -0,0 +1,122 @@
+﻿#pragma once
+
+#include "SpriteQuad.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// 文字列のレイアウトキャッシュ
+/// （文字列と倍率が同じなら前回並べた文字の矩形を、表示座標の差だけずらして使い回す）
+/// </summary>
+class TextLayoutCache {
+  public:
+	// 使われなくなってから破棄するまでのフレーム数
+	static const uint32_t kDefaultMaxUnusedFrames = 120;
+
+	/// <summary>
+	/// 文字列のハッシュ値（FNV-1a）
+	/// </summary>
+	static uint64_t Hash(const char* text, size_t length);
+
+	/// <summary>
+	/// 検索して見つかった矩形を表示座標に合わせてずらしながら末尾に追加する
+	/// </summary>
+	/// <param name="text">文字列</param>
+	/// <param name="length">文字数</param>
+	/// <param name="x">表示座標X</param>
+	/// <param name="y">表示座標Y</param>
+	/// <param name="scale">倍率</param>
+	/// <param name="glyphs">追加先</param>
+	/// <returns>見つかったか（見つからなければ何も追加しない）</returns>
+	bool Append(
+	  const char* text, size_t length, float x, float y, float scale,
+	  std::vector<SpriteQuad::Desc>& glyphs);
+
+	/// <summary>
+	/// 登録
+	/// </summary>
+	/// <param name="text">文字列</param>
+	/// <param name="length">文字数</param>
+	/// <param name="x">表示座標X</param>
+	/// <param name="y">表示座標Y</param>
+	/// <param name="scale">倍率</param>
+	/// <param name="glyphs">並べた矩形の配列</param>
+	/// <param name="count">矩形数</param>
+	void Insert(
+	  const char* text, size_t length, float x, float y, float scale,
+	  const SpriteQuad::Desc* glyphs, size_t count);
+
+	/// <summary>
+	/// フレームを進める（一定フレーム使われなかったものを破棄する）
+	/// </summary>
+	void NextFrame();
+
+	/// <summary>
+	/// 全破棄（統計はそのまま）
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// 破棄するまでの未使用フレーム数の設定
+	/// </summary>
+	void SetMaxUnusedFrames(uint32_t frames) { maxUnusedFrames_ = frames; }
+
+	uint64_t GetHitCount() const { return hitCount_; }
+	uint64_t GetMissCount() const { return missCount_; }
+	size_t GetEntryCount() const { return entries_.size(); }
+
+	/// <summary>
+	/// ヒット率（0～1）
+	/// </summary>
+	float GetHitRate() const {
+		uint64_t total = hitCount_ + missCount_;
+		return total == 0 ? 0.0f : static_cast<float>(hitCount_) / static_cast<float>(total);
+	}
+
+  private:
+	// キー（表示座標は含めない。動く文字列も同じ登録内容を使う）
+	struct Key {
+		uint64_t hash;
+		float scale;
+
+		bool operator==(const Key& other) const {
+			return hash == other.hash && scale == other.scale;
+		}
+	};
+
+	// キーのハッシュ関数
+	struct KeyHasher {
+		size_t operator()(const Key& key) const;
+	};
+
+	// 登録内容
+	struct Entry {
+		// ハッシュの衝突を見分けるための元の文字列
+		std::string text;
+		// 並べた矩形
+		std::vector<SpriteQuad::Desc> glyphs;
+		// 並べたときの表示座標
+		float x;
+		float y;
+		// 最後に使ったフレーム
+		uint32_t lastUsedFrame;
+	};
+
+	/// <summary>
+	/// 破棄する登録内容の文字列と矩形の領域を次の登録用に取っておく
+	/// </summary>
+	void Recycle(Entry& entry);
+
+	// 登録内容
+	std::unordered_map<Key, Entry, KeyHasher> entries_;
+	// 破棄した登録内容の領域（次の登録で使い直し、毎フレームの確保を避ける）
+	std::vector<Entry> spareEntries_;
+	// フレーム番号
+	uint32_t frame_ = 0;
+	// 破棄するまでの未使用フレーム数
+	uint32_t maxUnusedFrames_ = kDefaultMaxUnusedFrames;
+	// 統計
+	uint64_t hitCount_ = 0;
+	uint64_t missCount_ = 0;
+};
@@ -0,0 +1,199 @@
+﻿#include "TextureAtlas.h"
+#include "AtlasLayout.h"
+#include "TextureManager.h"
+#include <DirectXTex.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+
+using namespace DirectX;
+
+namespace {
+// 読み込んだ画像
+struct SourceImage {
+	std::string fileName;
+	ScratchImage image;
+};
+
+// 画像をRGBA8として読み込む
+// （ページはTextureManagerでsRGBとして扱われるので、sRGBの画像は線形に変換せずにそのまま詰める）
+bool LoadRGBA(const std::string& fullPath, ScratchImage& image) {
+	wchar_t wfilePath[256];
+	MultiByteToWideChar(CP_ACP, 0, fullPath.c_str(), -1, wfilePath, _countof(wfilePath));
+
+	ScratchImage loaded;
+	HRESULT result = LoadFromWICFile(wfilePath, WIC_FLAGS_NONE, nullptr, loaded);
+	if (FAILED(result)) {
+		return false;
+	}
+
+	DXGI_FORMAT format = IsSRGB(loaded.GetMetadata().format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+	                                                         : DXGI_FORMAT_R8G8B8A8_UNORM;
+	if (loaded.GetMetadata().format == format) {
+		image = std::move(loaded);
+		return true;
+	}
+	result = Convert(
+	  loaded.GetImages(), loaded.GetImageCount(), loaded.GetMetadata(), format, TEX_FILTER_DEFAULT,
+	  TEX_THRESHOLD_DEFAULT, image);
+	return SUCCEEDED(result);
+}
+
+// 余白部分に端のピクセルを複製しながら転送
+void Blit(const Image& src, const Image& dst, uint32_t x, uint32_t y, uint32_t padding) {
+	const int width = static_cast<int>(src.width);
+	const int height = static_cast<int>(src.height);
+	const int pad = static_cast<int>(padding);
+
+	for (int dy = -pad; dy < height + pad; dy++) {
+		int sy = (std::max)(0, (std::min)(dy, height - 1));
+		const uint32_t* srcRow = reinterpret_cast<const uint32_t*>(src.pixels + src.rowPitch * sy);
+		uint32_t* dstRow =
+		  reinterpret_cast<uint32_t*>(dst.pixels + dst.rowPitch * (y + pad + dy)) + x + pad;
+		for (int dx = -pad; dx < width + pad; dx++) {
+			dstRow[dx] = srcRow[(std::max)(0, (std::min)(dx, width - 1))];
+		}
+	}
+}
+} // namespace
+
+TextureAtlas* TextureAtlas::GetInstance() {
+	static TextureAtlas instance;
+	return &instance;
+}
+
+void TextureAtlas::Reserve(const std::string& fileName) {
+	if (std::find(reservedFiles_.begin(), reservedFiles_.end(), fileName) == reservedFiles_.end()) {
+		reservedFiles_.push_back(fileName);
+	}
+}
+
+void TextureAtlas::Build(uint32_t pageSize) {
+	TextureManager* textureManager = TextureManager::GetInstance();
+
+	// 作り直す時は全て詰め直す
+	regions_.clear();
+	pageOccupancies_.clear();
+
+	// 読み込み（大きすぎるものは単独テクスチャのまま使う）
+	std::vector<std::unique_ptr<SourceImage>> sources;
+	for (const std::string& fileName : reservedFiles_) {
+		auto source = std::make_unique<SourceImage>();
+		source->fileName = fileName;
+		bool loaded = LoadRGBA(textureManager->GetDirectoryPath() + fileName, source->image);
+		assert(loaded);
+		if (!loaded) {
+			continue;
+		}
+
+		const TexMetadata& metadata = source->image.GetMetadata();
+		if (kMaxEntrySize < metadata.width || kMaxEntrySize < metadata.height) {
+			Region& region = regions_[fileName];
+			region.textureHandle = TextureManager::Load(fileName);
+			region.texBase = {0.0f, 0.0f};
+			region.texSize = {float(metadata.width), float(metadata.height)};
+			continue;
+		}
+		sources.push_back(std::move(source));
+	}
+
+	// 配置は大きさだけで決める（並べ替えとページの追加はAtlasLayoutが行う）
+	std::vector<AtlasLayout::Size> sizes(sources.size());
+	for (size_t i = 0; i < sources.size(); i++) {
+		const TexMetadata& metadata = sources[i]->image.GetMetadata();
+		sizes[i] = {static_cast<uint32_t>(metadata.width), static_cast<uint32_t>(metadata.height)};
+	}
+	AtlasLayout layout;
+	bool placed = layout.Build(sizes, pageSize, kPadding);
+	assert(placed);
+	(void)placed;
+
+	// ページの画像に転送
+	std::vector<ScratchImage> pages(layout.GetPageCount());
+	for (ScratchImage& page : pages) {
+		HRESULT result = page.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, pageSize, pageSize, 1, 1);
+		assert(SUCCEEDED(result));
+		(void)result;
+		std::memset(page.GetPixels(), 0, page.GetPixelsSize());
+	}
+	const std::vector<AtlasLayout::Placement>& placements = layout.GetPlacements();
+	for (size_t i = 0; i < sources.size(); i++) {
+		const AtlasLayout::Placement& placement = placements[i];
+		if (placement.page == AtlasLayout::kInvalidPage) {
+			continue;
+		}
+		const Image& image = *sources[i]->image.GetImage(0, 0, 0);
+		Blit(image, *pages[placement.page].GetImage(0, 0, 0), placement.x, placement.y, kPadding);
+
+		Region& region = regions_[sources[i]->fileName];
+		region.texBase = {float(placement.x + kPadding), float(placement.y + kPadding)};
+		region.texSize = {float(image.width), float(image.height)};
+	}
+
+	// ページをテクスチャとして登録
+	std::vector<uint32_t> pageHandles(pages.size());
+	for (uint32_t i = 0; i < layout.GetPageCount(); i++) {
+		pageHandles[i] = TextureManager::LoadFromImage("atlas/page" + std::to_string(i), pages[i]);
+		pageOccupancies_.push_back(layout.GetPageOccupancy(i));
+	}
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (placements[i].page != AtlasLayout::kInvalidPage) {
+			regions_[sources[i]->fileName].textureHandle = pageHandles[placements[i].page];
+		}
+	}
+}
+
+bool TextureAtlas::Find(const std::string& fileName, Region& region) const {
+	auto it = regions_.find(fileName);
+	if (it == regions_.end()) {
+		return false;
+	}
+	region = it->second;
+	return true;
+}
+
+void TextureAtlas::Apply(Sprite* sprite, const std::string& fileName) const {
+	assert(sprite);
+
+	Region region;
+	bool found = Find(fileName, region);
+	assert(found);
+	if (!found) {
+		return;
+	}
+
+	sprite->SetTextureHandle(region.textureHandle);
+	sprite->SetSize(region.texSize);
+	sprite->SetTextureRect(region.texBase, region.texSize);
+}
+
+Sprite* TextureAtlas::CreateSprite(
+  const std::string& fileName, Vector2 position, Vector4 color, Vector2 anchorpoint, bool isFlipX,
+  bool isFlipY) const {
+	Region region;
+	bool found = Find(fileName, region);
+	assert(found);
+	if (!found) {
+		return nullptr;
+	}
+
+	Sprite* sprite =
+	  Sprite::Create(region.textureHandle, position, color, anchorpoint, isFlipX, isFlipY);
+	if (sprite) {
+		sprite->SetSize(region.texSize);
+		sprite->SetTextureRect(region.texBase, region.texSize);
+	}
+	return sprite;
+}
+
+float TextureAtlas::GetPackingEfficiency() const {
+	if (pageOccupancies_.empty()) {
+		return 0.0f;
+	}
+	float total = 0.0f;
+	for (float occupancy : pageOccupancies_) {
+		total += occupancy;
+	}
+	return total / pageOccupancies_.size();
+}
@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include "Sprite.h"
+#include "Vector2.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// 小さなテクスチャをまとめるテクスチャアトラス
+/// </summary>
+class TextureAtlas {
+  public:
+	// ページの既定サイズ
+	static const uint32_t kDefaultPageSize = 2048;
+	// アトラスに入れるテクスチャの最大辺
+	static const uint32_t kMaxEntrySize = 512;
+	// 矩形間の余白（端のピクセルを複製してにじみを防ぐ）
+	static const uint32_t kPadding = 2;
+
+	/// <summary>
+	/// アトラス内の領域
+	/// </summary>
+	struct Region {
+		// テクスチャハンドル（ページ、またはアトラス外の単独テクスチャ）
+		uint32_t textureHandle = 0;
+		// テクスチャ左上座標（ピクセル）
+		Vector2 texBase;
+		// テクスチャサイズ（ピクセル）
+		Vector2 texSize;
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static TextureAtlas* GetInstance();
+
+	/// <summary>
+	/// アトラスに入れるテクスチャの登録（Buildまでは読み込まない）
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	void Reserve(const std::string& fileName);
+
+	/// <summary>
+	/// 登録済みテクスチャを読み込んでページに詰め込む
+	/// </summary>
+	/// <param name="pageSize">ページの一辺のサイズ</param>
+	void Build(uint32_t pageSize = kDefaultPageSize);
+
+	/// <summary>
+	/// 領域の検索
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	/// <param name="region">見つかった領域</param>
+	/// <returns>見つかればtrue</returns>
+	bool Find(const std::string& fileName, Region& region) const;
+
+	/// <summary>
+	/// スプライトにアトラス内の領域を割り当てる（テクスチャ範囲とサイズを差し替える）
+	/// </summary>
+	/// <param name="sprite">スプライト</param>
+	/// <param name="fileName">ファイル名</param>
+	void Apply(Sprite* sprite, const std::string& fileName) const;
+
+	/// <summary>
+	/// アトラス内の領域を使うスプライト生成
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	/// <param name="position">座標</param>
+	/// <param name="color">色</param>
+	/// <param name="anchorpoint">アンカーポイント</param>
+	/// <param name="isFlipX">左右反転</param>
+	/// <param name="isFlipY">上下反転</param>
+	/// <returns>生成されたスプライト</returns>
+	Sprite* CreateSprite(
+	  const std::string& fileName, Vector2 position, Vector4 color = {1, 1, 1, 1},
+	  Vector2 anchorpoint = {0.0f, 0.0f}, bool isFlipX = false, bool isFlipY = false) const;
+
+	/// <summary>
+	/// ページ数の取得
+	/// </summary>
+	/// <returns>ページ数</returns>
+	uint32_t GetPageCount() const { return static_cast<uint32_t>(pageOccupancies_.size()); }
+
+	/// <summary>
+	/// ページの充填率の平均の取得
+	/// </summary>
+	/// <returns>充填率(0～1)</returns>
+	float GetPackingEfficiency() const;
+
+  private:
+	TextureAtlas() = default;
+	~TextureAtlas() = default;
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	// 登録済みファイル名
+	std::vector<std::string> reservedFiles_;
+	// ファイル名から領域への対応
+	std::unordered_map<std::string, Region> regions_;
+	// ページごとの充填率
+	std::vector<float> pageOccupancies_;
+};
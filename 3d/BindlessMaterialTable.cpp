@@ -0,0 +1,83 @@
+﻿#include "BindlessMaterialTable.h"
+#include <cassert>
+
+const uint32_t BindlessMaterialTable::kInvalidIndex;
+
+void BindlessMaterialTable::Initialize(uint32_t textureCapacity) {
+	textureCapacity_ = textureCapacity;
+	Clear();
+}
+
+void BindlessMaterialTable::Clear() {
+	materials_.clear();
+	keys_.clear();
+	freeIndices_.clear();
+	indices_.clear();
+}
+
+uint32_t BindlessMaterialTable::Register(const void* key, const Material& material) {
+	assert(key);
+
+	uint32_t index;
+	if (Find(key, index)) {
+		return Update(index, material) ? index : kInvalidIndex;
+	}
+
+	// 範囲外のテクスチャ番号はヒープの外を読ませることになるので登録しない
+	if (!IsValidTexture(material.textureIndex)) {
+		return kInvalidIndex;
+	}
+	if (freeIndices_.empty()) {
+		index = GetCount();
+		materials_.push_back(material);
+		keys_.push_back(key);
+	} else {
+		index = freeIndices_.back();
+		freeIndices_.pop_back();
+		materials_[index] = material;
+		keys_[index] = key;
+	}
+	indices_[key] = index;
+	return index;
+}
+
+uint32_t BindlessMaterialTable::Remove(const void* key) {
+	auto it = indices_.find(key);
+	if (it == indices_.end()) {
+		return kInvalidIndex;
+	}
+	uint32_t index = it->second;
+	indices_.erase(it);
+	keys_[index] = nullptr;
+	freeIndices_.push_back(index);
+	return index;
+}
+
+bool BindlessMaterialTable::Find(const void* key, uint32_t& index) const {
+	auto it = indices_.find(key);
+	if (it == indices_.end()) {
+		return false;
+	}
+	index = it->second;
+	return true;
+}
+
+bool BindlessMaterialTable::Update(uint32_t index, const Material& material) {
+	assert(index < GetCount());
+	if (!IsValidTexture(material.textureIndex)) {
+		return false;
+	}
+	materials_[index] = material;
+	return true;
+}
+
+ObjLayout::BindlessDraw
+  BindlessMaterialTable::MakeDrawConstants(uint32_t materialIndex, uint32_t textureOverride) const {
+	assert(materialIndex < GetCount());
+	assert(textureOverride == BINDLESS_NO_TEXTURE || IsValidTexture(textureOverride));
+
+	ObjLayout::BindlessDraw constants;
+	constants.materialIndex = materialIndex;
+	constants.textureOverride = textureOverride;
+	return constants;
+}
@@ -0,0 +1,102 @@
+﻿#pragma once
+
+#include "ObjLayout.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// バインドレス描画のマテリアル表
+/// （マテリアルごとに配列の番号を割り当て、テクスチャはデスクリプタヒープ上の番号で持たせる）
+/// （配列はそのままStructuredBufferに転送し、描画ごとにはルート定数で番号だけを渡す）
+/// （外した番号は空きにして次の登録で使い回すので、他のマテリアルの番号は変わらない）
+/// </summary>
+class BindlessMaterialTable {
+  public:
+	using Material = ObjLayout::BindlessMaterial;
+
+	// 無効な番号
+	static const uint32_t kInvalidIndex = UINT32_MAX;
+
+	/// <summary>
+	/// 初期化（登録を全て消す）
+	/// </summary>
+	/// <param name="textureCapacity">デスクリプタヒープの大きさ（テクスチャ番号の上限）</param>
+	void Initialize(uint32_t textureCapacity);
+
+	/// <summary>
+	/// 登録を全て消す
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// マテリアルの登録（登録済みなら内容を書き換えて同じ番号を返す）
+	/// </summary>
+	/// <param name="key">マテリアルを識別するキー</param>
+	/// <param name="material">内容</param>
+	/// <returns>番号（テクスチャ番号が範囲外ならkInvalidIndex）</returns>
+	uint32_t Register(const void* key, const Material& material);
+
+	/// <summary>
+	/// マテリアルを外す（キーの指す先を解放する前に呼ぶ。内容は次の登録まで残す）
+	/// </summary>
+	/// <param name="key">キー</param>
+	/// <returns>外した番号（未登録ならkInvalidIndex）</returns>
+	uint32_t Remove(const void* key);
+
+	/// <summary>
+	/// 登録済みのマテリアルの検索（登録と同時に呼ばなければどのスレッドからも呼べる）
+	/// </summary>
+	/// <param name="key">キー</param>
+	/// <param name="index">見つかった番号</param>
+	/// <returns>見つかったか</returns>
+	bool Find(const void* key, uint32_t& index) const;
+
+	/// <summary>
+	/// 内容の書き換え
+	/// </summary>
+	/// <param name="index">番号</param>
+	/// <param name="material">内容</param>
+	/// <returns>成否（テクスチャ番号が範囲外なら書き換えない）</returns>
+	bool Update(uint32_t index, const Material& material);
+
+	/// <summary>
+	/// テクスチャ番号がヒープの範囲内か
+	/// </summary>
+	bool IsValidTexture(uint32_t textureIndex) const { return textureIndex < textureCapacity_; }
+
+	/// <summary>
+	/// 描画ごとの定数を作る
+	/// </summary>
+	/// <param name="materialIndex">マテリアルの番号</param>
+	/// <param name="textureOverride">差し替えるテクスチャ番号（BINDLESS_NO_TEXTUREで無し）</param>
+	/// <returns>ルート定数</returns>
+	ObjLayout::BindlessDraw MakeDrawConstants(
+	  uint32_t materialIndex, uint32_t textureOverride = BINDLESS_NO_TEXTURE) const;
+
+	/// <summary>
+	/// 番号のキーの取得（空きの番号ならnullptr）
+	/// </summary>
+	const void* GetKey(uint32_t index) const { return keys_[index]; }
+
+	/// <summary>
+	/// 番号の数の取得（空きの番号も含む）
+	/// </summary>
+	uint32_t GetCount() const { return static_cast<uint32_t>(materials_.size()); }
+
+	/// <summary>
+	/// 配列の取得（番号の順）
+	/// </summary>
+	const std::vector<Material>& GetMaterials() const { return materials_; }
+
+  private:
+	// デスクリプタヒープの大きさ
+	uint32_t textureCapacity_ = 0;
+	// 番号ごとの内容とキー
+	std::vector<Material> materials_;
+	std::vector<const void*> keys_;
+	// 空きの番号
+	std::vector<uint32_t> freeIndices_;
+	// キーから番号
+	std::unordered_map<const void*, uint32_t> indices_;
+};
@@ -0,0 +1,303 @@
+﻿#include "CascadedShadowMap.h"
+#include "FrameUploadAllocator.h"
+#include "Model.h"
+#include "PipelineCache.h"
+#include "ShaderLibrary.h"
+#include "TextureManager.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <d3dx12.h>
+
+using namespace Microsoft::WRL;
+
+namespace {
+// 深度バイアス（シャドウマップの深度に対する値）
+const float kDepthBias = 0.0005f;
+// 法線方向のずらし量（テクセル単位）
+const float kNormalOffset = 1.5f;
+} // namespace
+
+CascadedShadowMap* CascadedShadowMap::GetInstance() {
+	static CascadedShadowMap instance;
+	return &instance;
+}
+
+void CascadedShadowMap::Initialize(ID3D12Device* device, const std::wstring& directoryPath) {
+	assert(device);
+	device_ = device;
+
+	InitializeGraphicsPipeline(directoryPath);
+
+	// ホットリロードで呼び直されたときはシャドウマップと設定を引き継ぐ
+	if (!shadowMap_) {
+		cascades_.Initialize(ShadowCascades::Settings());
+		CreateShadowMap();
+		for (auto& frameViewProjections : cascadeViewProjections_) {
+			for (ViewProjection& viewProjection : frameViewProjections) {
+				viewProjection.Initialize();
+			}
+		}
+	}
+}
+
+void CascadedShadowMap::SetSettings(const ShadowCascades::Settings& settings) {
+	cascades_.Initialize(settings);
+	if (settings.resolution != shadowMapResolution_) {
+		CreateShadowMap();
+	}
+}
+
+void CascadedShadowMap::AddCaster(
+  Model* model, const WorldTransform& worldTransform, float radius) {
+	assert(model);
+
+	// ワールド行列の拡大率のうち最大のものを半径に掛ける
+	const Matrix4& matWorld = worldTransform.matWorld_;
+	float scale = 0.0f;
+	for (int i = 0; i < 3; i++) {
+		float length = std::sqrt(
+		  matWorld.m[i][0] * matWorld.m[i][0] + matWorld.m[i][1] * matWorld.m[i][1] +
+		  matWorld.m[i][2] * matWorld.m[i][2]);
+		scale = (std::max)(scale, length);
+	}
+
+	casters_.push_back({model, &worldTransform});
+	casterSpheres_.push_back(
+	  {Vector3(matWorld.m[3][0], matWorld.m[3][1], matWorld.m[3][2]), radius * scale});
+}
+
+void CascadedShadowMap::Draw(ID3D12GraphicsCommandList* commandList) {
+	assert(commandList);
+
+	ConstBufferData constBufferData{};
+	constBufferData.depthBias = kDepthBias;
+	constBufferData.normalOffset = kNormalOffset;
+	constBufferData.mapTexelSize = 1.0f / shadowMapResolution_;
+	std::fill(std::begin(drawCounts_), std::end(drawCounts_), 0);
+
+	// カメラが無ければ影なしとして定数だけを用意する
+	if (viewProjection_) {
+		// 分割ごとの正射影を求めて投影物を振り分ける
+		ShadowCascades::Camera camera;
+		camera.matView = viewProjection_->matView;
+		camera.fovAngleY = viewProjection_->fovAngleY;
+		camera.aspectRatio = viewProjection_->aspectRatio;
+		camera.nearZ = viewProjection_->nearZ;
+		camera.farZ = viewProjection_->farZ;
+		cascades_.Update(camera, lightDir_, sceneMin_, sceneMax_);
+		cascades_.CullCasters(casterSpheres_.data(), static_cast<uint32_t>(casterSpheres_.size()));
+
+		Transition(commandList, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+		CD3DX12_VIEWPORT viewport(
+		  0.0f, 0.0f, static_cast<float>(shadowMapResolution_),
+		  static_cast<float>(shadowMapResolution_));
+		CD3DX12_RECT rect(0, 0, shadowMapResolution_, shadowMapResolution_);
+		commandList->RSSetViewports(1, &viewport);
+		commandList->RSSetScissorRects(1, &rect);
+
+		UINT dsvIncrementSize = device_->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+		uint32_t frameIndex = DirectXCommon::GetInstance()->GetFrameIndex();
+		uint32_t cascadeCount = cascades_.GetCascadeCount();
+		for (uint32_t c = 0; c < cascadeCount; c++) {
+			const ShadowCascades::Cascade& cascade = cascades_.GetCascade(c);
+
+			// 分割のビュープロジェクションを転送する（ビュー行列は回転のみなので視点は原点）
+			// （定数バッファは常駐なので、GPUが前のフレームで読んでいるものとは別の複製に書く）
+			ViewProjection& viewProjection = cascadeViewProjections_[frameIndex][c];
+			viewProjection.matView = cascade.matView;
+			viewProjection.matProjection = cascade.matProjection;
+			viewProjection.TransferMatrix();
+
+			constBufferData.viewProjections[c] = cascade.matViewProjection;
+			constBufferData.cascadeSplits[c] = cascade.splitFar;
+			constBufferData.cascadeTexelSizes[c] = cascade.texelSize;
+
+			// 深度だけを描く
+			CD3DX12_CPU_DESCRIPTOR_HANDLE dsvH(
+			  dsvHeap_->GetCPUDescriptorHandleForHeapStart(), c, dsvIncrementSize);
+			commandList->OMSetRenderTargets(0, nullptr, false, &dsvH);
+			commandList->ClearDepthStencilView(dsvH, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
+
+			const std::vector<uint32_t>& visible = cascades_.GetCasters(c);
+			if (visible.empty()) {
+				continue;
+			}
+			Model::PreDraw(commandList);
+			commandList->SetPipelineState(pipelineState_.Get());
+			commandList->SetGraphicsRootSignature(rootSignature_.Get());
+			for (uint32_t index : visible) {
+				casters_[index].model->Draw(*casters_[index].worldTransform, viewProjection);
+			}
+			Model::PostDraw();
+			drawCounts_[c] = static_cast<uint32_t>(visible.size());
+		}
+		constBufferData.cascadeCount = cascadeCount;
+	}
+
+	// 影を受ける側から読めるようにする
+	Transition(commandList, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	constBufferAddress_ =
+	  FrameUploadAllocator::GetInstance()->PushConstants(&constBufferData, sizeof(constBufferData));
+
+	casters_.clear();
+	casterSpheres_.clear();
+}
+
+void CascadedShadowMap::SetGraphicsRootConstantBufferView(
+  ID3D12GraphicsCommandList* commandList, UINT rootParamIndex) {
+	// Drawを呼んでいないフレームでは使えない
+	assert(constBufferAddress_ != 0);
+	commandList->SetGraphicsRootConstantBufferView(rootParamIndex, constBufferAddress_);
+}
+
+void CascadedShadowMap::SetGraphicsRootDescriptorTable(
+  ID3D12GraphicsCommandList* commandList, UINT rootParamIndex) {
+	TextureManager::GetInstance()->SetGraphicsRootDescriptorTable(
+	  commandList, rootParamIndex, textureHandle_);
+}
+
+void CascadedShadowMap::Transition(
+  ID3D12GraphicsCommandList* commandList, D3D12_RESOURCE_STATES state) {
+	if (shadowMapState_ == state) {
+		return;
+	}
+	CD3DX12_RESOURCE_BARRIER barrier =
+	  CD3DX12_RESOURCE_BARRIER::Transition(shadowMap_.Get(), shadowMapState_, state);
+	commandList->ResourceBarrier(1, &barrier);
+	shadowMapState_ = state;
+}
+
+void CascadedShadowMap::CreateShadowMap() {
+	HRESULT result;
+	const ShadowCascades::Settings& settings = cascades_.GetSettings();
+	shadowMapResolution_ = settings.resolution;
+
+	// 分割の最大数ぶんの深度テクスチャ配列
+	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+	  DXGI_FORMAT_R32_TYPELESS, shadowMapResolution_, shadowMapResolution_,
+	  ShadowCascades::kMaxCascadeCount, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL);
+	CD3DX12_CLEAR_VALUE clearValue(DXGI_FORMAT_D32_FLOAT, 1.0f, 0);
+	shadowMapState_ = D3D12_RESOURCE_STATE_DEPTH_WRITE;
+	DirectXCommon::GetInstance()->DeferRelease(shadowMap_);
+	result = device_->CreateCommittedResource(
+	  &heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, shadowMapState_, &clearValue,
+	  IID_PPV_ARGS(&shadowMap_));
+	assert(SUCCEEDED(result));
+
+	// 分割ごとの深度ステンシルビュー
+	D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc{};
+	dsvHeapDesc.NumDescriptors = ShadowCascades::kMaxCascadeCount;
+	dsvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
+	result = device_->CreateDescriptorHeap(&dsvHeapDesc, IID_PPV_ARGS(&dsvHeap_));
+	assert(SUCCEEDED(result));
+	(void)result;
+
+	UINT dsvIncrementSize = device_->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+	for (uint32_t c = 0; c < ShadowCascades::kMaxCascadeCount; c++) {
+		D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc{};
+		dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+		dsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2DARRAY;
+		dsvDesc.Texture2DArray.FirstArraySlice = c;
+		dsvDesc.Texture2DArray.ArraySize = 1;
+		device_->CreateDepthStencilView(
+		  shadowMap_.Get(), &dsvDesc,
+		  CD3DX12_CPU_DESCRIPTOR_HANDLE(dsvHeap_->GetCPUDescriptorHandleForHeapStart(), c, dsvIncrementSize));
+	}
+
+	// シェーダからはテクスチャ配列として読む
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+	srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Texture2DArray.MipLevels = 1;
+	srvDesc.Texture2DArray.ArraySize = ShadowCascades::kMaxCascadeCount;
+	textureHandle_ =
+	  TextureManager::GetInstance()->RegisterResource("CascadedShadowMap", shadowMap_.Get(), srvDesc);
+}
+
+void CascadedShadowMap::InitializeGraphicsPipeline(const std::wstring& directoryPath) {
+	HRESULT result;
+
+	// シェーダの読み込みとコンパイル（深度だけを書くのでピクセルシェーダは無し）
+	D3D12_SHADER_BYTECODE vs =
+	  ShaderLibrary::GetInstance()->Load(directoryPath + L"shaders/ShadowVS.hlsl", "vs_5_0");
+
+	// 頂点レイアウト（Modelの頂点バッファと同じ並び）
+	D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
+	  {// xyz座標
+	   "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	  {// 法線ベクトル
+	   "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	  {// uv座標
+	   "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	};
+
+	// デスクリプタレンジ
+	CD3DX12_DESCRIPTOR_RANGE descRangeSRV;
+	descRangeSRV.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0); // t0 レジスタ
+
+	// ルートパラメータ（Model::Drawがそのまま設定できるようにModelと同じ並びにする）
+	CD3DX12_ROOT_PARAMETER rootparams[5];
+	rootparams[static_cast<size_t>(Model::RoomParameter::kWorldTransform)].InitAsConstantBufferView(
+	  0, 0, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[static_cast<size_t>(Model::RoomParameter::kViewProjection)].InitAsConstantBufferView(
+	  1, 0, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[static_cast<size_t>(Model::RoomParameter::kMaterial)].InitAsConstantBufferView(
+	  2, 0, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[static_cast<size_t>(Model::RoomParameter::kTexture)].InitAsDescriptorTable(
+	  1, &descRangeSRV, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[static_cast<size_t>(Model::RoomParameter::kLight)].InitAsConstantBufferView(
+	  3, 0, D3D12_SHADER_VISIBILITY_ALL);
+
+	// ルートシグネチャの設定
+	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	rootSignatureDesc.Init_1_0(
+	  _countof(rootparams), rootparams, 0, nullptr,
+	  D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+	ComPtr<ID3DBlob> rootSigBlob;
+	ComPtr<ID3DBlob> errorBlob;
+	// バージョン自動判定のシリアライズ
+	result = D3DX12SerializeVersionedRootSignature(
+	  &rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &rootSigBlob, &errorBlob);
+	assert(SUCCEEDED(result));
+	// ルートシグネチャの生成
+	rootSignature_ = PipelineCache::GetInstance()->CreateRootSignature(rootSigBlob.Get());
+
+	// グラフィックスパイプラインの流れを設定
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC gpipeline{};
+	gpipeline.VS = vs;
+
+	// サンプルマスク
+	gpipeline.SampleMask = D3D12_DEFAULT_SAMPLE_MASK; // 標準設定
+	// ラスタライザステート（面の向きに依らず描き、傾きに応じて奥にずらす）
+	gpipeline.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	gpipeline.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+	gpipeline.RasterizerState.SlopeScaledDepthBias = 1.5f;
+	gpipeline.RasterizerState.DepthClipEnable = false; // 分割より光源側の投影物も潰して描く
+	// デプスステンシルステート
+	gpipeline.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+	gpipeline.DSVFormat = DXGI_FORMAT_D32_FLOAT; // 深度値フォーマット
+
+	// 頂点レイアウトの設定
+	gpipeline.InputLayout.pInputElementDescs = inputLayout;
+	gpipeline.InputLayout.NumElements = _countof(inputLayout);
+
+	// 図形の形状設定（三角形）
+	gpipeline.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+
+	gpipeline.NumRenderTargets = 0; // 描画対象は深度のみ
+	gpipeline.SampleDesc.Count = 1; // 1ピクセルにつき1回サンプリング
+
+	gpipeline.pRootSignature = rootSignature_.Get();
+
+	// グラフィックスパイプラインの生成
+	pipelineState_ = PipelineCache::GetInstance()->CreateGraphicsPipeline(gpipeline);
+}
@@ -0,0 +1,165 @@
+﻿#pragma once
+
+#include "DirectXCommon.h"
+#include "ShadowCascades.h"
+#include "ViewProjection.h"
+#include "WorldTransform.h"
+#include <d3d12.h>
+#include <string>
+#include <vector>
+#include <wrl.h>
+
+class Model;
+
+/// <summary>
+/// カスケードシャドウマップ
+/// （平行光源から見た深度を分割ごとにテクスチャ配列へ描き、ObjClusteredPSで影を付ける）
+/// （DirectXCommon::PreDrawの前にDrawを呼ぶ。影が付くのはLightGroupの0番の平行光源）
+/// </summary>
+class CascadedShadowMap {
+  public:
+	/// <summary>
+	/// シェーダに渡す定数（ObjShadow.hlsliのShadowParamsと同じ並び）
+	/// </summary>
+	struct ConstBufferData {
+		Matrix4 viewProjections[ShadowCascades::kMaxCascadeCount]; // 分割ごとの光源のビュープロジェクション
+		float cascadeSplits[ShadowCascades::kMaxCascadeCount];     // 分割ごとの奥側の奥行き
+		float cascadeTexelSizes[ShadowCascades::kMaxCascadeCount]; // 分割ごとの1テクセルの大きさ
+		uint32_t cascadeCount;                                     // 分割数（0なら影なし）
+		float depthBias;                                           // 深度バイアス
+		float normalOffset;                                        // 法線方向のずらし量（テクセル単位）
+		float mapTexelSize;                                        // シャドウマップの1テクセル（UV）
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static CascadedShadowMap* GetInstance();
+
+	/// <summary>
+	/// 初期化（呼び直したときはパイプラインだけ作り直す）
+	/// </summary>
+	/// <param name="device">デバイス</param>
+	/// <param name="directoryPath">シェーダファイルのディレクトリ</param>
+	void Initialize(ID3D12Device* device, const std::wstring& directoryPath = L"Resources/");
+
+	/// <summary>
+	/// 分割設定の変更（解像度が変わればシャドウマップを作り直す）
+	/// </summary>
+	void SetSettings(const ShadowCascades::Settings& settings);
+
+	/// <summary>
+	/// 参照するビュープロジェクションをセット（影を受けるカメラ）
+	/// </summary>
+	void SetViewProjection(const ViewProjection* viewProjection) { viewProjection_ = viewProjection; }
+
+	/// <summary>
+	/// 光線方向をセット
+	/// </summary>
+	void SetLightDirection(const Vector3& lightDir) { lightDir_ = lightDir; }
+
+	/// <summary>
+	/// 投影物を含むシーンの範囲をセット（分割の光源側をここまで延ばす）
+	/// </summary>
+	void SetSceneBounds(const Vector3& sceneMin, const Vector3& sceneMax) {
+		sceneMin_ = sceneMin;
+		sceneMax_ = sceneMax;
+	}
+
+	/// <summary>
+	/// 投影物の追加（このフレームのDrawまで有効）
+	/// </summary>
+	/// <param name="model">モデル</param>
+	/// <param name="worldTransform">ワールドトランスフォーム</param>
+	/// <param name="radius">モデルの原点を中心とする境界球の半径（モデル座標）</param>
+	void AddCaster(Model* model, const WorldTransform& worldTransform, float radius);
+
+	/// <summary>
+	/// 分割ごとにシャドウマップを描画する（分割に入った投影物だけを描く）
+	/// </summary>
+	/// <param name="commandList">描画コマンドリスト</param>
+	void Draw(ID3D12GraphicsCommandList* commandList);
+
+	/// <summary>
+	/// 影を受ける側の定数バッファビューをセット
+	/// </summary>
+	void SetGraphicsRootConstantBufferView(
+	  ID3D12GraphicsCommandList* commandList, UINT rootParamIndex);
+
+	/// <summary>
+	/// 影を受ける側のシャドウマップのデスクリプタテーブルをセット
+	/// </summary>
+	void SetGraphicsRootDescriptorTable(ID3D12GraphicsCommandList* commandList, UINT rootParamIndex);
+
+	/// <summary>
+	/// 分割の計算結果の取得
+	/// </summary>
+	const ShadowCascades& GetCascades() const { return cascades_; }
+
+	/// <summary>
+	/// 直前のDrawで分割ごとに描いた投影物の数
+	/// </summary>
+	uint32_t GetDrawCount(uint32_t cascade) const { return drawCounts_[cascade]; }
+
+  private:
+	// 投影物
+	struct Caster {
+		Model* model;
+		const WorldTransform* worldTransform;
+	};
+
+	CascadedShadowMap() = default;
+	~CascadedShadowMap() = default;
+	CascadedShadowMap(const CascadedShadowMap&) = delete;
+	CascadedShadowMap& operator=(const CascadedShadowMap&) = delete;
+
+	/// <summary>
+	/// シャドウマップ生成
+	/// </summary>
+	void CreateShadowMap();
+
+	/// <summary>
+	/// グラフィックパイプライン生成
+	/// </summary>
+	void InitializeGraphicsPipeline(const std::wstring& directoryPath);
+
+	/// <summary>
+	/// シャドウマップの状態を変える
+	/// </summary>
+	void Transition(ID3D12GraphicsCommandList* commandList, D3D12_RESOURCE_STATES state);
+
+	// デバイス
+	ID3D12Device* device_ = nullptr;
+	// ルートシグネチャ
+	Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature_;
+	// パイプラインステートオブジェクト
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState_;
+	// シャドウマップ（分割ごとの深度のテクスチャ配列）
+	Microsoft::WRL::ComPtr<ID3D12Resource> shadowMap_;
+	D3D12_RESOURCE_STATES shadowMapState_ = D3D12_RESOURCE_STATE_DEPTH_WRITE;
+	uint32_t shadowMapResolution_ = 0;
+	// 分割ごとの深度ステンシルビュー
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> dsvHeap_;
+	// シャドウマップのテクスチャハンドル
+	uint32_t textureHandle_ = 0;
+	// フレームと分割ごとのビュープロジェクション（Model::Drawに渡す）
+	ViewProjection cascadeViewProjections_[DirectXCommon::kMaxFrameCount]
+	                                      [ShadowCascades::kMaxCascadeCount];
+	// 分割の計算
+	ShadowCascades cascades_;
+	// 影を受けるカメラ
+	const ViewProjection* viewProjection_ = nullptr;
+	// 光線方向
+	Vector3 lightDir_ = {0.0f, -1.0f, 0.0f};
+	// シーンの範囲
+	Vector3 sceneMin_ = {-100.0f, -100.0f, -100.0f};
+	Vector3 sceneMax_ = {100.0f, 100.0f, 100.0f};
+	// このフレームの投影物と境界球
+	std::vector<Caster> casters_;
+	std::vector<ShadowCascades::Sphere> casterSpheres_;
+	// このフレームの定数
+	D3D12_GPU_VIRTUAL_ADDRESS constBufferAddress_ = 0;
+	// 統計
+	uint32_t drawCounts_[ShadowCascades::kMaxCascadeCount] = {};
+};
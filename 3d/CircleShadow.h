@@ -2,6 +2,7 @@
 
 #include "Vector3.h"
 #include "MathUtility.h"
+#include "ObjLayout.h"
 
 /// <summary>
 /// 丸影
@@ -10,19 +11,8 @@ class CircleShadow
 {
 public: // サブクラス
 
-	// 定数バッファ用データ構造体
-	struct ConstBufferData
-	{
-		Vector3 dir;
-		float pad1;
-		Vector3 casterPos;
-		float distanceCasterLight;
-		Vector3 atten;
-		float pad2;
-		Vector2 factorAngleCos;
-		unsigned int active;
-		float pad3;
-	};
+	// 定数バッファ用データ構造体（並びはObjLayout.hlsli）
+	using ConstBufferData = ObjLayout::CircleShadow;
 
 public: // メンバ関数
 	/// <summary>
@@ -0,0 +1,781 @@
+﻿#include "ClusteredLighting.h"
+#include "CascadedShadowMap.h"
+#include "D3D12RenderCommandList.h"
+#include "DirectXCommon.h"
+#include "FrameUploadAllocator.h"
+#include "ObjLayout.h"
+#include "PipelineCache.h"
+#include "ShaderLibrary.h"
+#include "TextureManager.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <d3dx12.h>
+
+using namespace Microsoft::WRL;
+
+// 間接描画の引数はD3D12の構造体と同じ並びで書き込む
+static_assert(
+  sizeof(RenderVertexBufferView) == sizeof(D3D12_VERTEX_BUFFER_VIEW) &&
+    sizeof(IndirectDrawList::IndexBufferView) == sizeof(D3D12_INDEX_BUFFER_VIEW) &&
+    sizeof(IndirectDrawList::DrawIndexedArguments) == sizeof(D3D12_DRAW_INDEXED_ARGUMENTS),
+  "IndirectDrawList::Command must match the indirect argument layout");
+static_assert(
+  IndirectDrawList::kIndexFormatUint16 == DXGI_FORMAT_R16_UINT &&
+    IndirectDrawList::kIndexFormatUint32 == DXGI_FORMAT_R32_UINT,
+  "IndirectDrawList index formats must match DXGI_FORMAT");
+
+namespace {
+// Vector3を配列に書き込む
+void CopyVector3(float dest[3], const Vector3& src) {
+	dest[0] = src.x;
+	dest[1] = src.y;
+	dest[2] = src.z;
+}
+
+// バインドレス描画のマテリアル（テクスチャはビューのヒープ上の番号で持つ）
+BindlessMaterialTable::Material MakeBindlessMaterial(Material* material) {
+	BindlessMaterialTable::Material data;
+	data.ambient = material->ambient_;
+	data.textureIndex =
+	  TextureManager::GetInstance()->GetDescriptorIndex(material->GetTextureHadle());
+	data.diffuse = material->diffuse_;
+	data.pad1 = 0.0f;
+	data.specular = material->specular_;
+	data.alpha = material->alpha_;
+	return data;
+}
+
+#ifdef _DEBUG
+// シェーダの定数バッファの大きさがC++の構造体と合っているか（シェーダで使っていなければ調べない）
+bool MatchesConstantBuffer(const ShaderReflection& reflection, const char* name, size_t size) {
+	const ShaderReflection::ConstantBuffer* constantBuffer = reflection.FindConstantBuffer(name);
+	return !constantBuffer ||
+	       constantBuffer->size == (size + ShaderLayout::kRegisterSize - 1) /
+	                                 ShaderLayout::kRegisterSize * ShaderLayout::kRegisterSize;
+}
+#endif
+} // namespace
+
+const uint32_t ClusteredLighting::kMinLightCapacity;
+const uint32_t ClusteredLighting::kLightMergeGap;
+
+ClusteredLighting* ClusteredLighting::GetInstance() {
+	static ClusteredLighting instance;
+	return &instance;
+}
+
+void ClusteredLighting::Initialize(
+  ID3D12Device* device, int window_width, int window_height, const std::wstring& directoryPath) {
+	assert(device);
+
+	windowWidth_ = window_width;
+	windowHeight_ = window_height;
+
+	// バインドレス描画はヒープ全体を1つのテーブルで参照するので、リソースバインディングTier2が要る
+	D3D12_FEATURE_DATA_D3D12_OPTIONS options{};
+	bindlessSupported_ =
+	  SUCCEEDED(
+	    device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))) &&
+	  D3D12_RESOURCE_BINDING_TIER_2 <= options.ResourceBindingTier;
+	bindless_ = bindless_ && bindlessSupported_;
+
+	InitializeGraphicsPipeline(directoryPath);
+	if (bindlessSupported_) {
+		CreateCommandSignature(device);
+	}
+
+	// ホットリロードで呼び直されたときは分割設定とライトを引き継ぐ
+	if (grid_.GetClusters().empty()) {
+		grid_.Initialize(LightClusterGrid::Settings());
+	}
+	if (!lightGroup_) {
+		lightGroup_.reset(LightGroup::Create());
+		materialTable_.Initialize(TextureManager::kDescriptorHeapSize);
+	}
+}
+
+void ClusteredLighting::SetBindless(bool enable) { bindless_ = enable && bindlessSupported_; }
+
+void ClusteredLighting::RegisterModel(Model* model) {
+	assert(model);
+
+	for (Mesh* mesh : model->GetMeshes()) {
+		Material* material = mesh->GetMaterial();
+		assert(material);
+		uint32_t index = materialTable_.Register(material, MakeBindlessMaterial(material));
+		assert(index != BindlessMaterialTable::kInvalidIndex);
+		if (index == BindlessMaterialTable::kInvalidIndex) {
+			continue;
+		}
+		// 外したマテリアルの空きの番号は使い回される
+		if (registeredMaterials_.size() <= index) {
+			registeredMaterials_.resize(index + 1, nullptr);
+		}
+		registeredMaterials_[index] = material;
+	}
+}
+
+void ClusteredLighting::OnModelReplaced(Model* oldModel, Model* newModel) {
+	assert(oldModel);
+
+	// 古いモデルのマテリアルを外す（他のマテリアルの番号は変わらない）
+	bool registered = false;
+	for (Mesh* mesh : oldModel->GetMeshes()) {
+		uint32_t index = materialTable_.Remove(mesh->GetMaterial());
+		if (index != BindlessMaterialTable::kInvalidIndex) {
+			registeredMaterials_[index] = nullptr;
+			registered = true;
+		}
+	}
+	if (registered && newModel) {
+		RegisterModel(newModel);
+	}
+
+	// 間接描画の引数は古いメッシュのビューとマテリアルの番号を持っているので、
+	// モデルを差し替えて登録順に作り直す（見えるかどうかは次のSetVisibleで渡し直す）
+	bool indirectRegistered = false;
+	for (IndirectModel& indirectModel : indirectModels_) {
+		if (indirectModel.model == oldModel) {
+			indirectModel.model = newModel;
+			indirectRegistered = true;
+		}
+	}
+	if (!indirectRegistered) {
+		return;
+	}
+	indirectModels_.erase(
+	  std::remove_if(
+	    indirectModels_.begin(), indirectModels_.end(),
+	    [](const IndirectModel& indirectModel) { return !indirectModel.model; }),
+	  indirectModels_.end());
+	indirectDrawList_.Clear();
+	indirectCommandCount_ = 0;
+	for (const IndirectModel& indirectModel : indirectModels_) {
+		AddIndirectMeshes(indirectModel);
+	}
+}
+
+void ClusteredLighting::ClearModels() {
+	materialTable_.Clear();
+	registeredMaterials_.clear();
+	// 間接描画の引数はマテリアルの番号を持っているので一緒に消す
+	ClearIndirect();
+}
+
+uint32_t ClusteredLighting::AddIndirectModel(
+  Model* model, const WorldTransform& worldTransform, uint32_t textureHadle) {
+	assert(model);
+
+	// モデルが差し替えられたときに作り直せるように、登録したモデルを覚えておく
+	IndirectModel indirectModel{model, &worldTransform, textureHadle};
+	indirectModels_.push_back(indirectModel);
+	return AddIndirectMeshes(indirectModel);
+}
+
+uint32_t ClusteredLighting::AddIndirectMeshes(const IndirectModel& indirectModel) {
+	const WorldTransform& worldTransform = *indirectModel.worldTransform;
+	uint32_t textureHadle = indirectModel.textureHadle;
+	uint32_t first = indirectDrawList_.GetCount();
+	for (Mesh* mesh : indirectModel.model->GetMeshes()) {
+		// 未登録のマテリアルは無効な番号のまま登録し、Updateの検証で外す
+		uint32_t materialIndex = BindlessMaterialTable::kInvalidIndex;
+		bool registered = materialTable_.Find(mesh->GetMaterial(), materialIndex);
+		assert(registered);
+		(void)registered;
+		indirectDrawList_.Add(
+		  worldTransform.constBuff_->GetGPUVirtualAddress(),
+		  D3D12RenderCommandList::Wrap(mesh->GetVBView()),
+		  D3D12RenderCommandList::Wrap(mesh->GetIBView()),
+		  static_cast<uint32_t>(mesh->GetIndices().size()),
+		  materialTable_.MakeDrawConstants(materialIndex, textureHadle));
+	}
+	return first;
+}
+
+void ClusteredLighting::ClearIndirect() {
+	indirectModels_.clear();
+	indirectDrawList_.Clear();
+	indirectCommandCount_ = 0;
+}
+
+void ClusteredLighting::SetSettings(const LightClusterGrid::Settings& settings) {
+	grid_.Initialize(settings);
+}
+
+void ClusteredLighting::ClearLights() {
+	lights_.clear();
+	for (DirtyRangeTracker& lightDirty : lightDirty_) {
+		lightDirty.Resize(0);
+	}
+	lightBvh_.Clear();
+}
+
+uint32_t ClusteredLighting::AddPointLight(
+  const Vector3& position, const Vector3& color, const Vector3& atten, float range) {
+	assert(0.0f < range);
+
+	LightClusterGrid::Light light{};
+	CopyVector3(light.position, position);
+	light.range = range;
+	CopyVector3(light.color, color);
+	light.type = LightClusterGrid::kTypePoint;
+	CopyVector3(light.atten, atten);
+	return PushLight(light);
+}
+
+uint32_t ClusteredLighting::AddSpotLight(
+  const Vector3& position, const Vector3& direction, const Vector3& color, const Vector3& atten,
+  float range, const Vector2& factorAngleCos) {
+	assert(0.0f < range);
+
+	Vector3 lightdir = direction;
+	LightClusterGrid::Light light{};
+	CopyVector3(light.position, position);
+	light.range = range;
+	CopyVector3(light.color, color);
+	light.type = LightClusterGrid::kTypeSpot;
+	CopyVector3(light.direction, MathUtility::Vector3Normalize(lightdir));
+	light.cosOuter = factorAngleCos.y;
+	CopyVector3(light.atten, atten);
+	light.cosInner = factorAngleCos.x;
+	return PushLight(light);
+}
+
+void ClusteredLighting::SetLightPosition(uint32_t index, const Vector3& position) {
+	assert(index < lights_.size());
+	CopyVector3(lights_[index].position, position);
+	MarkLightDirty(index);
+}
+
+void ClusteredLighting::SetLightColor(uint32_t index, const Vector3& color) {
+	assert(index < lights_.size());
+	CopyVector3(lights_[index].color, color);
+	MarkLightDirty(index);
+}
+
+void ClusteredLighting::SetSpotLightDirection(uint32_t index, const Vector3& direction) {
+	assert(index < lights_.size());
+	assert(lights_[index].type == LightClusterGrid::kTypeSpot);
+	Vector3 lightdir = direction;
+	CopyVector3(lights_[index].direction, MathUtility::Vector3Normalize(lightdir));
+	MarkLightDirty(index);
+}
+
+uint32_t ClusteredLighting::QueryLights(
+  const Vector3& center, float radius, uint32_t count, LightBvh::Contribution* results) const {
+	const float position[3] = {center.x, center.y, center.z};
+	return lightBvh_.QueryTopK(position, radius, count, results);
+}
+
+uint32_t ClusteredLighting::PushLight(const LightClusterGrid::Light& light) {
+	uint32_t index = static_cast<uint32_t>(lights_.size());
+	lights_.push_back(light);
+	for (DirtyRangeTracker& lightDirty : lightDirty_) {
+		lightDirty.Resize(index + 1);
+	}
+	lightBvh_.Insert(index, light);
+	return index;
+}
+
+void ClusteredLighting::MarkLightDirty(uint32_t index) {
+	for (DirtyRangeTracker& lightDirty : lightDirty_) {
+		lightDirty.Mark(index);
+	}
+	lightBvh_.Update(index, lights_[index]);
+}
+
+void ClusteredLighting::Update(const ViewProjection& viewProjection) {
+	// 光源をクラスタに振り分ける
+	LightClusterGrid::Camera camera;
+	memcpy(camera.view, viewProjection.matView.m, sizeof(camera.view));
+	camera.fovAngleY = viewProjection.fovAngleY;
+	camera.aspectRatio = viewProjection.aspectRatio;
+	camera.nearZ = viewProjection.nearZ;
+	camera.farZ = viewProjection.farZ;
+	grid_.Build(camera, lights_.data(), static_cast<uint32_t>(lights_.size()));
+
+	// 分割情報
+	const LightClusterGrid::Settings& settings = grid_.GetSettings();
+	ConstBufferDataClusterParams params;
+	params.tileSize[0] = static_cast<float>(windowWidth_) / settings.tilesX;
+	params.tileSize[1] = static_cast<float>(windowHeight_) / settings.tilesY;
+	params.tilesX = settings.tilesX;
+	params.tilesY = settings.tilesY;
+	params.slices = settings.slices;
+	params.sliceScale = grid_.GetSliceScale();
+	params.sliceBias = grid_.GetSliceBias();
+	params.lightCount = static_cast<uint32_t>(lights_.size());
+	clusterParamsAddress_ =
+	  FrameUploadAllocator::GetInstance()->PushConstants(&params, sizeof(params));
+
+	// ライトはここで書き込んでおき、ワーカースレッドのPreDrawでは読むだけにする
+	lightGroup_->PrepareDraw();
+
+	// 光源は変更された範囲だけを常駐バッファのこのフレームの複製に書き込む
+	// （GPUが前のフレームの複製を読んでいる間も書き換えられる）
+	ReserveLightBuffer(static_cast<uint32_t>(lights_.size()));
+	uint32_t frameIndex = DirectXCommon::GetInstance()->GetFrameIndex();
+	LightClusterGrid::Light* lightMap = lightMap_ + lightCapacity_ * frameIndex;
+	lightDirty_[frameIndex].TakeRanges(lightRanges_, kLightMergeGap);
+	uploadedLightBytes_ = DirtyRangeTracker::CopyRanges(
+	  lightRanges_, sizeof(LightClusterGrid::Light), lights_.data(), lightMap);
+	lightsAddress_ = lightBuff_->GetGPUVirtualAddress() +
+	                 sizeof(LightClusterGrid::Light) * lightCapacity_ * frameIndex;
+
+	// クラスタと光源番号リストはカメラで変わるので毎フレーム一時領域に書き込む
+	const std::vector<LightClusterGrid::Cluster>& clusters = grid_.GetClusters();
+	const std::vector<uint32_t>& indices = grid_.GetIndices();
+	clustersAddress_ = Upload(
+	  clusters.data(), sizeof(LightClusterGrid::Cluster) * clusters.size(),
+	  sizeof(LightClusterGrid::Cluster));
+	indicesAddress_ = Upload(indices.data(), sizeof(uint32_t) * indices.size(), sizeof(uint32_t));
+
+	// バインドレス描画のマテリアルは数が少ないので、書き換えを拾い直して毎フレーム全て書き込む
+	// （テクスチャのビューのヒープ上の番号も差し替えで変わるので、ここで取り直す）
+	if (bindless_) {
+		for (uint32_t i = 0; i < materialTable_.GetCount(); i++) {
+			if (registeredMaterials_[i]) {
+				materialTable_.Update(i, MakeBindlessMaterial(registeredMaterials_[i]));
+			}
+		}
+		const std::vector<BindlessMaterialTable::Material>& materials =
+		  materialTable_.GetMaterials();
+		materialsAddress_ = Upload(
+		  materials.data(), sizeof(BindlessMaterialTable::Material) * materials.size(),
+		  sizeof(BindlessMaterialTable::Material));
+	}
+	UpdateIndirect();
+}
+
+void ClusteredLighting::UpdateIndirect() {
+	indirectCommandCount_ = 0;
+	if (!bindless_ || !commandSignature_) {
+		return;
+	}
+
+	// 見えて引数の正しいコマンドだけを詰める（不正な引数はGPUに範囲外を読ませるので渡さない）
+	uint32_t commandCount =
+	  indirectDrawList_.Build(materialTable_.GetCount(), TextureManager::kDescriptorHeapSize);
+	if (commandCount == 0) {
+		return;
+	}
+
+	// 引数はこのフレームの一時領域に書き込む（アップロードヒープのまま引数バッファとして読める）
+	const std::vector<IndirectDrawList::Command>& commands = indirectDrawList_.GetCommands();
+	size_t size = sizeof(IndirectDrawList::Command) * commands.size();
+	FrameUploadAllocator::Allocation allocation =
+	  FrameUploadAllocator::GetInstance()->Allocate(size);
+	IndirectDrawList::Command* dest =
+	  static_cast<IndirectDrawList::Command*>(allocation.cpuAddress);
+
+	// デスクリプタテーブルを通さないので、常駐管理への使用の印はここで付ける
+	// （差し替えるテクスチャはハンドルで登録してあるので、ビューのヒープ上の番号に直して書き込む）
+	TextureManager* textureManager = TextureManager::GetInstance();
+	for (size_t i = 0; i < commands.size(); i++) {
+		IndirectDrawList::Command command = commands[i];
+		uint32_t& textureOverride = command.drawConstants.textureOverride;
+		if (textureOverride != BINDLESS_NO_TEXTURE) {
+			textureManager->MakeResident(textureOverride);
+			textureOverride = textureManager->GetDescriptorIndex(textureOverride);
+		} else {
+			textureManager->MakeResident(
+			  registeredMaterials_[command.drawConstants.materialIndex]->GetTextureHadle());
+		}
+		memcpy(&dest[i], &command, sizeof(command));
+	}
+	indirectBuffer_ = allocation.resource;
+	indirectOffset_ = allocation.offset;
+	indirectCommandCount_ = commandCount;
+}
+
+void ClusteredLighting::PreDraw(ID3D12GraphicsCommandList* commandList) {
+	assert(commandList);
+	// Updateを呼んでいないフレームでは使えない
+	assert(clusterParamsAddress_ != 0);
+
+	// パイプラインステートとルートシグネチャを差し替える
+	const PipelineSet& pipelineSet = bindless_ ? pipelineSetBindless_ : pipelineSet_;
+	commandList->SetPipelineState(pipelineSet.pipelineState.Get());
+	commandList->SetGraphicsRootSignature(pipelineSet.rootSignature.Get());
+	// 白紙のコマンドリストでも描けるようにトポロジも設定する
+	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	// クラスタ関連はこのフレームの間変わらないので先に設定しておく
+	commandList->SetGraphicsRootConstantBufferView(
+	  static_cast<UINT>(RoomParameter::kClusterParams), clusterParamsAddress_);
+	commandList->SetGraphicsRootShaderResourceView(
+	  static_cast<UINT>(RoomParameter::kClusterLights), lightsAddress_);
+	commandList->SetGraphicsRootShaderResourceView(
+	  static_cast<UINT>(RoomParameter::kClusters), clustersAddress_);
+	commandList->SetGraphicsRootShaderResourceView(
+	  static_cast<UINT>(RoomParameter::kClusterIndices), indicesAddress_);
+
+	// 0番の平行光源の影
+	CascadedShadowMap* shadowMap = CascadedShadowMap::GetInstance();
+	shadowMap->SetGraphicsRootConstantBufferView(
+	  commandList, static_cast<UINT>(RoomParameter::kShadowParams));
+	shadowMap->SetGraphicsRootDescriptorTable(
+	  commandList, static_cast<UINT>(RoomParameter::kShadowMap));
+
+	// DrawModel用のライト（Model::Drawはライブラリ内のライトで上書きする）
+	lightGroup_->Draw(commandList, static_cast<UINT>(RoomParameter::kLight));
+
+	// バインドレス描画ではヒープ全体のテーブルと全マテリアルもここで1回だけ設定する
+	if (bindless_) {
+		assert(materialsAddress_ != 0);
+		ID3D12DescriptorHeap* descriptorHeap = TextureManager::GetInstance()->GetDescriptorHeap();
+		commandList->SetDescriptorHeaps(1, &descriptorHeap);
+		commandList->SetGraphicsRootDescriptorTable(
+		  static_cast<UINT>(RoomParameter::kTexture),
+		  descriptorHeap->GetGPUDescriptorHandleForHeapStart());
+		commandList->SetGraphicsRootShaderResourceView(
+		  static_cast<UINT>(RoomParameter::kMaterial), materialsAddress_);
+	}
+}
+
+void ClusteredLighting::DrawModel(
+  ID3D12GraphicsCommandList* commandList, Model* model, const WorldTransform& worldTransform,
+  const ViewProjection& viewProjection) {
+	DrawMeshes(commandList, model, worldTransform, viewProjection, nullptr);
+}
+
+void ClusteredLighting::DrawModel(
+  ID3D12GraphicsCommandList* commandList, Model* model, const WorldTransform& worldTransform,
+  const ViewProjection& viewProjection, uint32_t textureHadle) {
+	DrawMeshes(commandList, model, worldTransform, viewProjection, &textureHadle);
+}
+
+void ClusteredLighting::DrawIndirect(
+  ID3D12GraphicsCommandList* commandList, const ViewProjection& viewProjection) {
+	assert(commandList);
+	// 描画ごとのテクスチャとマテリアルを番号で引くので、バインドレス描画でしか使えない
+	assert(bindless_);
+	if (indirectCommandCount_ == 0) {
+		return;
+	}
+
+	// ワールド変換行列・頂点とインデックスのバッファ・ルート定数はコマンドごとに引数から設定される
+	commandList->SetGraphicsRootConstantBufferView(
+	  static_cast<UINT>(RoomParameter::kViewProjection),
+	  viewProjection.constBuff_->GetGPUVirtualAddress());
+	D3D12RenderCommandList renderCommandList(commandList);
+	renderCommandList.ExecuteIndirect(
+	  D3D12RenderCommandList::Wrap(commandSignature_.Get()), indirectCommandCount_,
+	  D3D12RenderCommandList::Wrap(indirectBuffer_), indirectOffset_, nullptr, 0);
+}
+
+void ClusteredLighting::DrawMeshes(
+  ID3D12GraphicsCommandList* commandList, Model* model, const WorldTransform& worldTransform,
+  const ViewProjection& viewProjection, const uint32_t* textureHadle) {
+	assert(commandList);
+	assert(model);
+
+	// 定数バッファビューをセット
+	commandList->SetGraphicsRootConstantBufferView(
+	  static_cast<UINT>(RoomParameter::kWorldTransform),
+	  worldTransform.constBuff_->GetGPUVirtualAddress());
+	commandList->SetGraphicsRootConstantBufferView(
+	  static_cast<UINT>(RoomParameter::kViewProjection),
+	  viewProjection.constBuff_->GetGPUVirtualAddress());
+
+	// 全メッシュを描画
+	UINT material = static_cast<UINT>(RoomParameter::kMaterial);
+	UINT texture = static_cast<UINT>(RoomParameter::kTexture);
+	for (Mesh* mesh : model->GetMeshes()) {
+		if (bindless_) {
+			DrawMeshBindless(commandList, mesh, textureHadle);
+		} else if (textureHadle) {
+			mesh->Draw(commandList, material, texture, *textureHadle);
+		} else {
+			mesh->Draw(commandList, material, texture);
+		}
+	}
+}
+
+void ClusteredLighting::DrawMeshBindless(
+  ID3D12GraphicsCommandList* commandList, Mesh* mesh, const uint32_t* textureHadle) {
+	// マテリアルはRegisterModelで登録しておく（描画中は表を読むだけなので並列に記録できる）
+	Material* material = mesh->GetMaterial();
+	uint32_t materialIndex = 0;
+	bool registered = materialTable_.Find(material, materialIndex);
+	assert(registered);
+	if (!registered) {
+		return;
+	}
+
+	// デスクリプタテーブルを通さないので、常駐管理への使用の印はここで付ける
+	TextureManager::GetInstance()->MakeResident(
+	  textureHadle ? *textureHadle : material->GetTextureHadle());
+
+	// 描画ごとに変わるのはルート定数の番号だけ（差し替えるテクスチャはヒープ上の番号で渡す）
+	ObjLayout::BindlessDraw constants = materialTable_.MakeDrawConstants(
+	  materialIndex, textureHadle ? TextureManager::GetInstance()->GetDescriptorIndex(*textureHadle)
+	                              : BINDLESS_NO_TEXTURE);
+	commandList->SetGraphicsRoot32BitConstants(
+	  static_cast<UINT>(RoomParameter::kBindlessDraw), sizeof(constants) / sizeof(uint32_t),
+	  &constants, 0);
+
+	commandList->IASetVertexBuffers(0, 1, &mesh->GetVBView());
+	commandList->IASetIndexBuffer(&mesh->GetIBView());
+	commandList->DrawIndexedInstanced(static_cast<UINT>(mesh->GetIndices().size()), 1, 0, 0, 0);
+}
+
+void ClusteredLighting::ReserveLightBuffer(uint32_t lightCount) {
+	if (lightBuff_ && lightCount <= lightCapacity_) {
+		return;
+	}
+
+	// 容量は倍々に増やす
+	uint32_t capacity = (std::max)(lightCapacity_ * 2, kMinLightCapacity);
+	while (capacity < lightCount) {
+		capacity *= 2;
+	}
+
+	// 前のバッファはGPUが読み終えてから解放する
+	DirectXCommon* dxCommon = DirectXCommon::GetInstance();
+	dxCommon->DeferRelease(lightBuff_);
+
+	// 同時処理フレーム数ぶんの複製を並べる
+	ID3D12Device* device = dxCommon->GetDevice();
+	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(
+	  sizeof(LightClusterGrid::Light) * capacity * dxCommon->GetFrameCount());
+	HRESULT result = device->CreateCommittedResource(
+	  &heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+	  IID_PPV_ARGS(&lightBuff_));
+	assert(SUCCEEDED(result));
+	result = lightBuff_->Map(0, nullptr, reinterpret_cast<void**>(&lightMap_));
+	assert(SUCCEEDED(result));
+	(void)result;
+
+	// 新しいバッファには全フレームの複製に全光源を書き込む
+	lightCapacity_ = capacity;
+	for (DirtyRangeTracker& lightDirty : lightDirty_) {
+		lightDirty.MarkAll();
+	}
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS ClusteredLighting::Upload(const void* data, size_t size, size_t stride) {
+	FrameUploadAllocator::Allocation allocation =
+	  FrameUploadAllocator::GetInstance()->Allocate((std::max)(size, stride));
+	if (0 < size) {
+		memcpy(allocation.cpuAddress, data, size);
+	} else {
+		memset(allocation.cpuAddress, 0, stride);
+	}
+	return allocation.gpuAddress;
+}
+
+void ClusteredLighting::InitializeGraphicsPipeline(const std::wstring& directoryPath) {
+	PipelineSet pipelineSet = CreateGraphicsPipeline(directoryPath, false);
+	PipelineSet pipelineSetBindless;
+	if (bindlessSupported_) {
+		pipelineSetBindless = CreateGraphicsPipeline(directoryPath, true);
+	}
+
+	// シェーダのコンパイルに失敗したら、ホットリロードでの作り直しなら前のパイプラインを使い続ける
+	// （最初の初期化では描画できないのでShaderLibrary::Loadと同じく終了する）
+	if (!pipelineSet.pipelineState || (bindlessSupported_ && !pipelineSetBindless.pipelineState)) {
+		if (!pipelineSet_.pipelineState) {
+			exit(1);
+		}
+		return;
+	}
+	pipelineSet_ = pipelineSet;
+	pipelineSetBindless_ = pipelineSetBindless;
+}
+
+void ClusteredLighting::CreateCommandSignature(ID3D12Device* device) {
+	// 並びはIndirectDrawList::Commandと同じにする
+	D3D12_INDIRECT_ARGUMENT_DESC arguments[5] = {};
+	arguments[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW;
+	arguments[0].ConstantBufferView.RootParameterIndex =
+	  static_cast<UINT>(RoomParameter::kWorldTransform);
+	arguments[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_VERTEX_BUFFER_VIEW;
+	arguments[1].VertexBuffer.Slot = 0;
+	arguments[2].Type = D3D12_INDIRECT_ARGUMENT_TYPE_INDEX_BUFFER_VIEW;
+	arguments[3].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+	arguments[3].Constant.RootParameterIndex = static_cast<UINT>(RoomParameter::kBindlessDraw);
+	arguments[3].Constant.DestOffsetIn32BitValues = 0;
+	arguments[3].Constant.Num32BitValuesToSet = sizeof(ObjLayout::BindlessDraw) / sizeof(uint32_t);
+	arguments[4].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+	D3D12_COMMAND_SIGNATURE_DESC desc{};
+	desc.ByteStride = sizeof(IndirectDrawList::Command);
+	desc.NumArgumentDescs = _countof(arguments);
+	desc.pArgumentDescs = arguments;
+
+	// ルートパラメータを書き換えるので、ルートシグネチャも指定する
+	HRESULT result = device->CreateCommandSignature(
+	  &desc, pipelineSetBindless_.rootSignature.Get(), IID_PPV_ARGS(&commandSignature_));
+	assert(SUCCEEDED(result));
+	(void)result;
+}
+
+ClusteredLighting::PipelineSet
+  ClusteredLighting::CreateGraphicsPipeline(const std::wstring& directoryPath, bool bindless) {
+	HRESULT result;
+
+	// シェーダの読み込みとコンパイル（頂点シェーダはModelと共用）
+	// （バインドレス描画はシェーダモデル5.1のリソース配列を使うバリエーション）
+	ShaderLibrary* shaderLibrary = ShaderLibrary::GetInstance();
+	std::wstring psPath = directoryPath + L"shaders/ObjClusteredPS.hlsl";
+	std::string psTarget = bindless ? "ps_5_1" : "ps_5_0";
+	std::vector<ShaderDefine> psDefines;
+	if (bindless) {
+		psDefines.push_back({"BINDLESS", "1"});
+	}
+	// （コンパイルエラーはここで出力し、空のセットを返して呼び出し元に任せる）
+	D3D12_SHADER_BYTECODE vs;
+	D3D12_SHADER_BYTECODE ps;
+	std::string errors;
+	if (!shaderLibrary->TryLoad(
+	      directoryPath + L"shaders/ObjVS.hlsl", "vs_5_0", "main", {}, vs, &errors) ||
+	    !shaderLibrary->TryLoad(psPath, psTarget, "main", psDefines, ps, &errors)) {
+		errors += "\n";
+		OutputDebugStringA(errors.c_str());
+		return PipelineSet();
+	}
+
+#ifdef _DEBUG
+	// 並びはObjLayout.hで検査済みなので、実際にコンパイルしたものと大きさだけ突き合わせる
+	ShaderReflection reflection;
+	if (shaderLibrary->GetReflection(psPath, psTarget, "main", psDefines, reflection)) {
+		assert(MatchesConstantBuffer(reflection, "Material", sizeof(ObjLayout::Material)));
+		assert(MatchesConstantBuffer(reflection, "LightGroup", sizeof(ObjLayout::LightGroup)));
+		assert(MatchesConstantBuffer(reflection, "BindlessDraw", sizeof(ObjLayout::BindlessDraw)));
+	}
+#endif
+
+	// 頂点レイアウト
+	D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
+	  {// xy座標(1行で書いたほうが見やすい)
+	   "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	  {// 法線ベクトル(1行で書いたほうが見やすい)
+	   "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	  {// uv座標(1行で書いたほうが見やすい)
+	   "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	};
+
+	// デスクリプタレンジ（バインドレス描画ではテクスチャのヒープ全体をspace1の配列にする）
+	CD3DX12_DESCRIPTOR_RANGE descRangeSRV;
+	if (bindless) {
+		descRangeSRV.Init(
+		  D3D12_DESCRIPTOR_RANGE_TYPE_SRV, TextureManager::kDescriptorHeapSize, 0, 1); // t0, space1
+	} else {
+		descRangeSRV.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0); // t0 レジスタ
+	}
+	CD3DX12_DESCRIPTOR_RANGE descRangeShadowMap;
+	descRangeShadowMap.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 4); // t4 レジスタ
+
+	// ルートパラメータ（0～4はModel::Drawがそのまま設定できるように同じ並びにする）
+	// （バインドレス描画ではマテリアルを全マテリアルの配列にして、描画ごとのルート定数を足す）
+	CD3DX12_ROOT_PARAMETER rootparams[12];
+	UINT rootparamCount = bindless ? 12 : 11;
+	rootparams[static_cast<size_t>(RoomParameter::kWorldTransform)].InitAsConstantBufferView(
+	  0, 0, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[static_cast<size_t>(RoomParameter::kViewProjection)].InitAsConstantBufferView(
+	  1, 0, D3D12_SHADER_VISIBILITY_ALL);
+	if (bindless) {
+		rootparams[static_cast<size_t>(RoomParameter::kMaterial)].InitAsShaderResourceView(
+		  5, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+	} else {
+		rootparams[static_cast<size_t>(RoomParameter::kMaterial)].InitAsConstantBufferView(
+		  2, 0, D3D12_SHADER_VISIBILITY_ALL);
+	}
+	rootparams[static_cast<size_t>(RoomParameter::kTexture)].InitAsDescriptorTable(
+	  1, &descRangeSRV, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[static_cast<size_t>(RoomParameter::kLight)].InitAsConstantBufferView(
+	  3, 0, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[static_cast<size_t>(RoomParameter::kClusterParams)].InitAsConstantBufferView(
+	  4, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+	rootparams[static_cast<size_t>(RoomParameter::kClusterLights)].InitAsShaderResourceView(
+	  1, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+	rootparams[static_cast<size_t>(RoomParameter::kClusters)].InitAsShaderResourceView(
+	  2, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+	rootparams[static_cast<size_t>(RoomParameter::kClusterIndices)].InitAsShaderResourceView(
+	  3, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+	rootparams[static_cast<size_t>(RoomParameter::kShadowParams)].InitAsConstantBufferView(
+	  5, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+	rootparams[static_cast<size_t>(RoomParameter::kShadowMap)].InitAsDescriptorTable(
+	  1, &descRangeShadowMap, D3D12_SHADER_VISIBILITY_PIXEL);
+	rootparams[static_cast<size_t>(RoomParameter::kBindlessDraw)].InitAsConstants(
+	  sizeof(ObjLayout::BindlessDraw) / sizeof(uint32_t), 6, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+
+	// スタティックサンプラー（s1はシャドウマップの比較用。範囲外は日向）
+	CD3DX12_STATIC_SAMPLER_DESC samplerDescs[2] = {
+	  CD3DX12_STATIC_SAMPLER_DESC(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR),
+	  CD3DX12_STATIC_SAMPLER_DESC(
+	    1, D3D12_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT, D3D12_TEXTURE_ADDRESS_MODE_BORDER,
+	    D3D12_TEXTURE_ADDRESS_MODE_BORDER, D3D12_TEXTURE_ADDRESS_MODE_BORDER, 0.0f, 16,
+	    D3D12_COMPARISON_FUNC_LESS_EQUAL, D3D12_STATIC_BORDER_COLOR_OPAQUE_WHITE),
+	};
+
+	// ルートシグネチャの設定
+	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	rootSignatureDesc.Init_1_0(
+	  rootparamCount, rootparams, _countof(samplerDescs), samplerDescs,
+	  D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+	ComPtr<ID3DBlob> rootSigBlob;
+	ComPtr<ID3DBlob> errorBlob;
+	// バージョン自動判定のシリアライズ
+	result = D3DX12SerializeVersionedRootSignature(
+	  &rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &rootSigBlob, &errorBlob);
+	assert(SUCCEEDED(result));
+	// ルートシグネチャの生成
+	PipelineSet pipelineSet;
+	pipelineSet.rootSignature =
+	  PipelineCache::GetInstance()->CreateRootSignature(rootSigBlob.Get());
+
+	// グラフィックスパイプラインの流れを設定
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC gpipeline{};
+	gpipeline.VS = vs;
+	gpipeline.PS = ps;
+
+	// サンプルマスク
+	gpipeline.SampleMask = D3D12_DEFAULT_SAMPLE_MASK; // 標準設定
+	// ラスタライザステート
+	gpipeline.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	// デプスステンシルステート
+	gpipeline.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+
+	// レンダーターゲットのブレンド設定
+	D3D12_RENDER_TARGET_BLEND_DESC blenddesc{};
+	blenddesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL; // RBGA全てのチャンネルを描画
+	blenddesc.BlendEnable = true;
+	blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+	blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+	blenddesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+	blenddesc.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	blenddesc.SrcBlendAlpha = D3D12_BLEND_ONE;
+	blenddesc.DestBlendAlpha = D3D12_BLEND_ZERO;
+
+	// ブレンドステートの設定
+	gpipeline.BlendState.RenderTarget[0] = blenddesc;
+
+	// 深度バッファのフォーマット
+	gpipeline.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+
+	// 頂点レイアウトの設定
+	gpipeline.InputLayout.pInputElementDescs = inputLayout;
+	gpipeline.InputLayout.NumElements = _countof(inputLayout);
+
+	// 図形の形状設定（三角形）
+	gpipeline.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+
+	gpipeline.NumRenderTargets = 1;                            // 描画対象は1つ
+	gpipeline.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; // 0～255指定のRGBA
+	gpipeline.SampleDesc.Count = 1; // 1ピクセルにつき1回サンプリング
+
+	gpipeline.pRootSignature = pipelineSet.rootSignature.Get();
+
+	// グラフィックスパイプラインの生成
+	pipelineSet.pipelineState = PipelineCache::GetInstance()->CreateGraphicsPipeline(gpipeline);
+	return pipelineSet;
+}
@@ -0,0 +1,406 @@
+﻿#pragma once
+
+#include "BindlessMaterialTable.h"
+#include "DirectXCommon.h"
+#include "DirtyRangeTracker.h"
+#include "IndirectDrawList.h"
+#include "LightBvh.h"
+#include "LightClusterGrid.h"
+#include "LightGroup.h"
+#include "Model.h"
+#include "ViewProjection.h"
+#include "WorldTransform.h"
+#include <d3d12.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <wrl.h>
+
+/// <summary>
+/// クラスタードライティング
+/// （多数の点光源・スポットライトをクラスタに振り分け、ピクセルごとに近くの光源だけを計算する）
+/// （Model::PreDrawの後にPreDrawを呼ぶと、以降のModel::Drawがこのパイプラインで描画される）
+/// （光源の配列は常駐バッファにフレームごとの複製を置き、変更された光源の範囲だけを書き込む）
+/// （DrawModelはModelの静的なコマンドリストを使わないので、ワーカースレッドで並列に記録できる）
+/// （バインドレス描画ではテクスチャとマテリアルを番号で引き、描画ごとにテーブルを切り替えない。
+///   Model::Drawは使えないので、RegisterModelで登録したモデルをDrawModelで描画する）
+/// （間接描画ではバインドレス描画の引数を見えるメッシュの分だけ詰めて書き込み、
+///   ExecuteIndirectの1回で描画する）
+/// </summary>
+class ClusteredLighting {
+  public:
+	/// <summary>
+	/// ルートパラメータ番号（0～4はModelと同じ）
+	/// </summary>
+	enum class RoomParameter {
+		kWorldTransform,  // ワールド変換行列
+		kViewProjection,  // ビュープロジェクション変換行列
+		kMaterial,        // マテリアル
+		kTexture,         // テクスチャ
+		kLight,           // ライト（平行光源と丸影に使う）
+		kClusterParams,   // クラスタの分割情報
+		kClusterLights,   // 光源の配列
+		kClusters,        // クラスタごとの光源番号の範囲
+		kClusterIndices,  // 光源番号リスト
+		kShadowParams,    // カスケードシャドウマップの定数
+		kShadowMap,       // カスケードシャドウマップ
+		kBindlessDraw,    // バインドレス描画の描画ごとの定数（バインドレス描画のみ）
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static ClusteredLighting* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="device">デバイス</param>
+	/// <param name="window_width">画面幅</param>
+	/// <param name="window_height">画面高さ</param>
+	/// <param name="directoryPath">シェーダファイルのディレクトリ</param>
+	void Initialize(
+	  ID3D12Device* device, int window_width, int window_height,
+	  const std::wstring& directoryPath = L"Resources/");
+
+	/// <summary>
+	/// バインドレス描画の切り替え（対応していなければ無視する。PreDrawの前に呼ぶ）
+	/// </summary>
+	/// <param name="enable">バインドレス描画にするか</param>
+	void SetBindless(bool enable);
+
+	/// <summary>
+	/// バインドレス描画か
+	/// </summary>
+	bool IsBindless() const { return bindless_; }
+
+	/// <summary>
+	/// バインドレス描画に対応しているか（リソースバインディングTier2以上）
+	/// </summary>
+	bool IsBindlessSupported() const { return bindlessSupported_; }
+
+	/// <summary>
+	/// バインドレス描画で使うモデルのマテリアルを登録する（描画の記録中には呼ばない）
+	/// （マテリアルの書き換えはUpdateで拾い直すので、モデルを解放するまで登録したままにする）
+	/// </summary>
+	/// <param name="model">モデル</param>
+	void RegisterModel(Model* model);
+
+	/// <summary>
+	/// 登録したモデルを全て外す（モデルを解放する前に呼ぶ。間接描画の登録も消す）
+	/// </summary>
+	void ClearModels();
+
+	/// <summary>
+	/// モデルの差し替えの通知（古いモデルを解放する前に呼ぶ。ホットリロードが呼ぶ）
+	/// （古いモデルが登録されていればマテリアルを外して新しいモデルを登録し、間接描画の登録を
+	///   新しいモデルで作り直す。メッシュの数が変わると後ろのモデルの登録番号もずれる）
+	/// </summary>
+	/// <param name="oldModel">解放するモデル</param>
+	/// <param name="newModel">新しいモデル（nullptrなら外すだけ。間接描画の登録も消す）</param>
+	void OnModelReplaced(Model* oldModel, Model* newModel);
+
+	/// <summary>
+	/// 間接描画の登録（メッシュごとに1コマンド。マテリアルはRegisterModelで登録しておく）
+	/// （ワールドトランスフォームは登録を消すまで解放しない。モデルの差し替えはOnModelReplacedで）
+	/// </summary>
+	/// <param name="model">モデル</param>
+	/// <param name="worldTransform">ワールドトランスフォーム</param>
+	/// <param name="textureHadle">差し替えるテクスチャハンドル（BINDLESS_NO_TEXTUREで無し）</param>
+	/// <returns>最初の登録番号（メッシュの数だけ続く）</returns>
+	uint32_t AddIndirectModel(
+	  Model* model, const WorldTransform& worldTransform,
+	  uint32_t textureHadle = BINDLESS_NO_TEXTURE);
+
+	/// <summary>
+	/// 間接描画の登録を全て消す
+	/// </summary>
+	void ClearIndirect();
+
+	/// <summary>
+	/// 間接描画のコマンド表の取得（カリングの結果はUpdateの前にSetVisibleで渡す）
+	/// </summary>
+	IndirectDrawList& GetIndirectDrawList() { return indirectDrawList_; }
+
+	/// <summary>
+	/// バインドレス描画のマテリアル表の取得
+	/// </summary>
+	const BindlessMaterialTable& GetMaterialTable() const { return materialTable_; }
+
+	/// <summary>
+	/// 分割設定の変更
+	/// </summary>
+	void SetSettings(const LightClusterGrid::Settings& settings);
+
+	/// <summary>
+	/// 光源を全て消す
+	/// </summary>
+	void ClearLights();
+
+	/// <summary>
+	/// 点光源の追加
+	/// </summary>
+	/// <param name="position">ライト座標</param>
+	/// <param name="color">ライトの色</param>
+	/// <param name="atten">ライト距離減衰係数</param>
+	/// <param name="range">影響範囲（この距離で0になる）</param>
+	/// <returns>光源番号</returns>
+	uint32_t AddPointLight(
+	  const Vector3& position, const Vector3& color, const Vector3& atten, float range);
+
+	/// <summary>
+	/// スポットライトの追加
+	/// </summary>
+	/// <param name="position">ライト座標</param>
+	/// <param name="direction">光線方向</param>
+	/// <param name="color">ライトの色</param>
+	/// <param name="atten">ライト距離減衰係数</param>
+	/// <param name="range">影響範囲（この距離で0になる）</param>
+	/// <param name="factorAngleCos">減衰開始角度と減衰終了角度のコサイン</param>
+	/// <returns>光源番号</returns>
+	uint32_t AddSpotLight(
+	  const Vector3& position, const Vector3& direction, const Vector3& color, const Vector3& atten,
+	  float range, const Vector2& factorAngleCos);
+
+	/// <summary>
+	/// 光源の座標を変更
+	/// </summary>
+	/// <param name="index">光源番号</param>
+	/// <param name="position">ライト座標</param>
+	void SetLightPosition(uint32_t index, const Vector3& position);
+
+	/// <summary>
+	/// 光源の色を変更
+	/// </summary>
+	/// <param name="index">光源番号</param>
+	/// <param name="color">ライトの色</param>
+	void SetLightColor(uint32_t index, const Vector3& color);
+
+	/// <summary>
+	/// スポットライトの光線方向を変更
+	/// </summary>
+	/// <param name="index">光源番号</param>
+	/// <param name="direction">光線方向</param>
+	void SetSpotLightDirection(uint32_t index, const Vector3& direction);
+
+	/// <summary>
+	/// 光源数の取得
+	/// </summary>
+	size_t GetLightCount() const { return lights_.size(); }
+
+	/// <summary>
+	/// 物体に届く光源を、推定した明るさの大きい順に取り出す（光源の空間索引を引く）
+	/// </summary>
+	/// <param name="center">物体の境界球の中心（ワールド座標）</param>
+	/// <param name="radius">物体の境界球の半径</param>
+	/// <param name="count">取り出す最大数</param>
+	/// <param name="results">明るい順の結果（count個分の領域）</param>
+	/// <returns>取り出した数</returns>
+	uint32_t QueryLights(
+	  const Vector3& center, float radius, uint32_t count, LightBvh::Contribution* results) const;
+
+	/// <summary>
+	/// 光源の空間索引の取得
+	/// </summary>
+	const LightBvh& GetLightBvh() const { return lightBvh_; }
+
+	/// <summary>
+	/// 光源をクラスタに振り分けて、このフレームの一時領域に転送する（PreDrawを使うフレームごとに呼ぶ）
+	/// </summary>
+	/// <param name="viewProjection">描画に使うビュープロジェクション</param>
+	void Update(const ViewProjection& viewProjection);
+
+	/// <summary>
+	/// 描画前処理（Model::PreDrawの後か、DrawModelの前に呼ぶ。ワーカースレッドからも呼べる）
+	/// </summary>
+	/// <param name="commandList">描画コマンドリスト</param>
+	void PreDraw(ID3D12GraphicsCommandList* commandList);
+
+	/// <summary>
+	/// モデルの描画（Model::Drawと同じ内容を指定のコマンドリストに記録する。ワーカースレッドからも呼べる）
+	/// </summary>
+	/// <param name="commandList">PreDraw済みのコマンドリスト</param>
+	/// <param name="model">モデル</param>
+	/// <param name="worldTransform">ワールドトランスフォーム</param>
+	/// <param name="viewProjection">ビュープロジェクション</param>
+	void DrawModel(
+	  ID3D12GraphicsCommandList* commandList, Model* model, const WorldTransform& worldTransform,
+	  const ViewProjection& viewProjection);
+
+	/// <summary>
+	/// モデルの描画（テクスチャ差し替え）
+	/// </summary>
+	/// <param name="commandList">PreDraw済みのコマンドリスト</param>
+	/// <param name="model">モデル</param>
+	/// <param name="worldTransform">ワールドトランスフォーム</param>
+	/// <param name="viewProjection">ビュープロジェクション</param>
+	/// <param name="textureHadle">テクスチャハンドル</param>
+	void DrawModel(
+	  ID3D12GraphicsCommandList* commandList, Model* model, const WorldTransform& worldTransform,
+	  const ViewProjection& viewProjection, uint32_t textureHadle);
+
+	/// <summary>
+	/// 間接描画（Updateで詰めた引数でまとめて描画する。バインドレス描画のみ）
+	/// （記録するだけなのでワーカースレッドからも呼べる）
+	/// </summary>
+	/// <param name="commandList">PreDraw済みのコマンドリスト</param>
+	/// <param name="viewProjection">ビュープロジェクション</param>
+	void DrawIndirect(ID3D12GraphicsCommandList* commandList, const ViewProjection& viewProjection);
+
+	/// <summary>
+	/// DrawModelが使うライトの取得（Modelのライトはライブラリ内にあるので別に持つ）
+	/// </summary>
+	LightGroup* GetLightGroup() { return lightGroup_.get(); }
+
+	/// <summary>
+	/// 振り分け結果の取得（統計用）
+	/// </summary>
+	const LightClusterGrid& GetGrid() const { return grid_; }
+
+	/// <summary>
+	/// 直前のUpdateで光源の配列に書き込んだバイト数
+	/// </summary>
+	size_t GetUploadedLightBytes() const { return uploadedLightBytes_; }
+
+  private:
+	// クラスタの分割情報（ObjClustered.hlsliのClusterParamsと同じ並び）
+	struct ConstBufferDataClusterParams {
+		float tileSize[2];
+		uint32_t tilesX;
+		uint32_t tilesY;
+		uint32_t slices;
+		float sliceScale;
+		float sliceBias;
+		uint32_t lightCount;
+	};
+
+	// 間接描画に登録したモデル
+	struct IndirectModel {
+		Model* model;
+		const WorldTransform* worldTransform;
+		uint32_t textureHadle;
+	};
+
+	// パイプラインのセット
+	struct PipelineSet {
+		// ルートシグネチャ
+		Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature;
+		// パイプラインステートオブジェクト
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState;
+	};
+
+	ClusteredLighting() = default;
+	~ClusteredLighting() = default;
+	ClusteredLighting(const ClusteredLighting&) = delete;
+	ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+	/// <summary>
+	/// グラフィックパイプライン生成
+	/// </summary>
+	void InitializeGraphicsPipeline(const std::wstring& directoryPath);
+
+	/// <summary>
+	/// グラフィックパイプラインの作成
+	/// </summary>
+	/// <param name="directoryPath">シェーダファイルのディレクトリ</param>
+	/// <param name="bindless">バインドレス描画用か</param>
+	PipelineSet CreateGraphicsPipeline(const std::wstring& directoryPath, bool bindless);
+
+	/// <summary>
+	/// 間接描画のコマンドシグネチャの作成（バインドレス描画のルートシグネチャを使う）
+	/// </summary>
+	void CreateCommandSignature(ID3D12Device* device);
+
+	// 常駐バッファの最小容量（光源数）
+	static const uint32_t kMinLightCapacity = 64;
+	// この数以下の未変更の光源を挟む変更範囲は1回で書き込む
+	static const uint32_t kLightMergeGap = 4;
+
+	/// <summary>
+	/// 光源を末尾に加える
+	/// </summary>
+	uint32_t PushLight(const LightClusterGrid::Light& light);
+
+	/// <summary>
+	/// 光源の変更を記録する
+	/// </summary>
+	void MarkLightDirty(uint32_t index);
+
+	/// <summary>
+	/// 光源の常駐バッファを必要な容量にする（作り直したときは全光源を書き直す）
+	/// </summary>
+	void ReserveLightBuffer(uint32_t lightCount);
+
+	/// <summary>
+	/// 間接描画のコマンド表にモデルのメッシュを加える
+	/// </summary>
+	/// <returns>最初の登録番号</returns>
+	uint32_t AddIndirectMeshes(const IndirectModel& indirectModel);
+
+	/// <summary>
+	/// 間接描画の引数を詰めて、このフレームの一時領域に書き込む
+	/// </summary>
+	void UpdateIndirect();
+
+	/// <summary>
+	/// 配列をこのフレームの一時領域に書き込む（空でも1要素分は確保する）
+	/// </summary>
+	D3D12_GPU_VIRTUAL_ADDRESS Upload(const void* data, size_t size, size_t stride);
+
+	/// <summary>
+	/// 変換行列を設定してメッシュを描画する
+	/// </summary>
+	void DrawMeshes(
+	  ID3D12GraphicsCommandList* commandList, Model* model, const WorldTransform& worldTransform,
+	  const ViewProjection& viewProjection, const uint32_t* textureHadle);
+
+	/// <summary>
+	/// バインドレス描画でメッシュを描画する
+	/// </summary>
+	void DrawMeshBindless(
+	  ID3D12GraphicsCommandList* commandList, Mesh* mesh, const uint32_t* textureHadle);
+
+	// パイプライン
+	PipelineSet pipelineSet_;
+	PipelineSet pipelineSetBindless_;
+	// バインドレス描画
+	bool bindlessSupported_ = false;
+	bool bindless_ = false;
+	// バインドレス描画のマテリアル表（番号ごとのマテリアル。外した番号はnullptr）
+	BindlessMaterialTable materialTable_;
+	std::vector<Material*> registeredMaterials_;
+	// 間接描画
+	Microsoft::WRL::ComPtr<ID3D12CommandSignature> commandSignature_;
+	IndirectDrawList indirectDrawList_;
+	std::vector<IndirectModel> indirectModels_;
+	// 画面サイズ
+	int windowWidth_ = 0;
+	int windowHeight_ = 0;
+	// 光源の振り分け
+	LightClusterGrid grid_;
+	// 光源
+	std::vector<LightClusterGrid::Light> lights_;
+	// 光源の空間索引
+	LightBvh lightBvh_;
+	// DrawModelで使うライト
+	std::unique_ptr<LightGroup> lightGroup_;
+	// フレームの複製ごとの変更された光源
+	DirtyRangeTracker lightDirty_[DirectXCommon::kMaxFrameCount];
+	// 変更範囲の作業領域
+	std::vector<DirtyRangeTracker::Range> lightRanges_;
+	// 光源の常駐バッファ（lightCapacity_個ずつのフレームごとの複製）
+	Microsoft::WRL::ComPtr<ID3D12Resource> lightBuff_;
+	LightClusterGrid::Light* lightMap_ = nullptr;
+	uint32_t lightCapacity_ = 0;
+	size_t uploadedLightBytes_ = 0;
+	// このフレームの転送先
+	D3D12_GPU_VIRTUAL_ADDRESS clusterParamsAddress_ = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS lightsAddress_ = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS clustersAddress_ = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS indicesAddress_ = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS materialsAddress_ = 0;
+	ID3D12Resource* indirectBuffer_ = nullptr;
+	uint64_t indirectOffset_ = 0;
+	uint32_t indirectCommandCount_ = 0;
+};
@@ -0,0 +1,257 @@
+﻿#include "DebugShapes.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+const uint32_t DebugShapes::kBoxLineCount;
+const uint32_t DebugShapes::kFrustumLineCount;
+const uint32_t DebugShapes::kAxisLineCount;
+const uint32_t DebugShapes::kArrowLineCount;
+const uint32_t DebugShapes::kMinSegments;
+const uint32_t DebugShapes::kMaxSegments;
+
+namespace {
+const float kPi = 3.14159265358979f;
+
+// 箱の8頂点（ビット0がX、1がY、2がZ）を結ぶ辺
+const uint8_t kBoxEdges[DebugShapes::kBoxLineCount][2] = {
+  {0, 1}, {2, 3}, {4, 5}, {6, 7}, // X方向
+  {0, 2}, {1, 3}, {4, 6}, {5, 7}, // Y方向
+  {0, 4}, {1, 5}, {2, 6}, {3, 7}, // Z方向
+};
+
+Vector3 Add(const Vector3& a, const Vector3& b) { return Vector3(a.x + b.x, a.y + b.y, a.z + b.z); }
+Vector3 Sub(const Vector3& a, const Vector3& b) { return Vector3(a.x - b.x, a.y - b.y, a.z - b.z); }
+Vector3 Scale(const Vector3& v, float s) { return Vector3(v.x * s, v.y * s, v.z * s); }
+// a + b * s
+Vector3 MulAdd(const Vector3& a, const Vector3& b, float s) {
+	return Vector3(a.x + b.x * s, a.y + b.y * s, a.z + b.z * s);
+}
+Vector3 Cross(const Vector3& a, const Vector3& b) {
+	return Vector3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+float Length(const Vector3& v) { return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z); }
+Vector3 Normalize(const Vector3& v) {
+	float length = Length(v);
+	return 0.0f < length ? Scale(v, 1.0f / length) : Vector3(0.0f, 0.0f, 1.0f);
+}
+
+// 単位ベクトルに直交する2軸
+void Perpendicular(const Vector3& n, Vector3& u, Vector3& v) {
+	u = Normalize(std::fabs(n.x) < 0.9f ? Cross(n, Vector3(1.0f, 0.0f, 0.0f))
+	                                    : Cross(n, Vector3(0.0f, 1.0f, 0.0f)));
+	v = Cross(n, u);
+}
+
+// 単位円の表（回転の漸化式で作り、誤差が溜まらないように4分の1周ごとに正確な値で始め直す）
+struct UnitCircle {
+	float cos[DebugShapes::kMaxSegments + 1];
+	float sin[DebugShapes::kMaxSegments + 1];
+
+	UnitCircle(uint32_t segments, float arc) {
+		assert(0 < segments && segments <= DebugShapes::kMaxSegments);
+		const float step = arc / segments;
+		const float stepCos = std::cos(step);
+		const float stepSin = std::sin(step);
+		const uint32_t restart = (std::max)(1u, segments / 4);
+		for (uint32_t i = 0; i <= segments; i++) {
+			if (i % restart == 0) {
+				cos[i] = std::cos(step * i);
+				sin[i] = std::sin(step * i);
+			} else {
+				cos[i] = cos[i - 1] * stepCos - sin[i - 1] * stepSin;
+				sin[i] = sin[i - 1] * stepCos + cos[i - 1] * stepSin;
+			}
+		}
+	}
+};
+
+// center + u * cos + v * sin の円弧を線分として書き出す
+uint32_t Arc(
+  const UnitCircle& circle, uint32_t segments, const Vector3& center, const Vector3& u,
+  const Vector3& v, Vector3* out) {
+	Vector3 previous = MulAdd(center, u, circle.cos[0]);
+	previous = MulAdd(previous, v, circle.sin[0]);
+	for (uint32_t i = 1; i <= segments; i++) {
+		Vector3 current = MulAdd(MulAdd(center, u, circle.cos[i]), v, circle.sin[i]);
+		*out++ = previous;
+		*out++ = current;
+		previous = current;
+	}
+	return segments;
+}
+
+// 8頂点を箱の辺として書き出す
+uint32_t BoxEdges(const Vector3 corners[8], Vector3* out) {
+	for (const auto& edge : kBoxEdges) {
+		*out++ = corners[edge[0]];
+		*out++ = corners[edge[1]];
+	}
+	return DebugShapes::kBoxLineCount;
+}
+} // namespace
+
+uint32_t DebugShapes::Box(const Vector3& min, const Vector3& max, Vector3* out) {
+	Vector3 corners[8];
+	for (uint32_t i = 0; i < 8; i++) {
+		corners[i] = Vector3((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+	}
+	return BoxEdges(corners, out);
+}
+
+uint32_t DebugShapes::OrientedBox(
+  const Vector3& center, const Vector3 axes[3], const Vector3& halfExtents, Vector3* out) {
+	Vector3 x = Scale(axes[0], halfExtents.x);
+	Vector3 y = Scale(axes[1], halfExtents.y);
+	Vector3 z = Scale(axes[2], halfExtents.z);
+	Vector3 corners[8];
+	for (uint32_t i = 0; i < 8; i++) {
+		Vector3 corner = MulAdd(center, x, (i & 1) ? 1.0f : -1.0f);
+		corner = MulAdd(corner, y, (i & 2) ? 1.0f : -1.0f);
+		corners[i] = MulAdd(corner, z, (i & 4) ? 1.0f : -1.0f);
+	}
+	return BoxEdges(corners, out);
+}
+
+uint32_t DebugShapes::Sphere(const Vector3& center, float radius, uint32_t segments, Vector3* out) {
+	segments = ClampSegments(segments);
+	const UnitCircle circle(segments, kPi * 2.0f);
+	const Vector3 x(radius, 0.0f, 0.0f);
+	const Vector3 y(0.0f, radius, 0.0f);
+	const Vector3 z(0.0f, 0.0f, radius);
+
+	uint32_t count = 0;
+	count += Arc(circle, segments, center, x, y, out + count * 2);
+	count += Arc(circle, segments, center, y, z, out + count * 2);
+	count += Arc(circle, segments, center, z, x, out + count * 2);
+	return count;
+}
+
+uint32_t DebugShapes::Capsule(
+  const Vector3& p0, const Vector3& p1, float radius, uint32_t segments, Vector3* out) {
+	segments = ClampSegments(segments);
+	const UnitCircle circle(segments, kPi * 2.0f);
+	const UnitCircle halfCircle(segments / 2, kPi);
+
+	Vector3 axis = Normalize(Sub(p1, p0));
+	Vector3 u, v;
+	Perpendicular(axis, u, v);
+	u = Scale(u, radius);
+	v = Scale(v, radius);
+	Vector3 w = Scale(axis, radius);
+
+	uint32_t count = 0;
+	// 両端の円
+	count += Arc(circle, segments, p0, u, v, out + count * 2);
+	count += Arc(circle, segments, p1, u, v, out + count * 2);
+
+	// 側面
+	const Vector3 sides[] = {u, v, Scale(u, -1.0f), Scale(v, -1.0f)};
+	for (const Vector3& side : sides) {
+		out[count * 2] = Add(p0, side);
+		out[count * 2 + 1] = Add(p1, side);
+		count++;
+	}
+
+	// 両端の半球（直交する2平面の半円）
+	count += Arc(halfCircle, segments / 2, p1, u, w, out + count * 2);
+	count += Arc(halfCircle, segments / 2, p1, v, w, out + count * 2);
+	count += Arc(halfCircle, segments / 2, p0, u, Scale(w, -1.0f), out + count * 2);
+	count += Arc(halfCircle, segments / 2, p0, v, Scale(w, -1.0f), out + count * 2);
+	return count;
+}
+
+uint32_t DebugShapes::Cone(
+  const Vector3& apex, const Vector3& direction, float height, float angle, uint32_t segments,
+  Vector3* out) {
+	segments = ClampSegments(segments);
+	const UnitCircle circle(segments, kPi * 2.0f);
+
+	Vector3 axis = Normalize(direction);
+	Vector3 u, v;
+	Perpendicular(axis, u, v);
+	float radius = height * std::tan(angle);
+	u = Scale(u, radius);
+	v = Scale(v, radius);
+	Vector3 baseCenter = MulAdd(apex, axis, height);
+
+	uint32_t count = Arc(circle, segments, baseCenter, u, v, out);
+
+	// 側面
+	const Vector3 sides[] = {u, v, Scale(u, -1.0f), Scale(v, -1.0f)};
+	for (const Vector3& side : sides) {
+		out[count * 2] = apex;
+		out[count * 2 + 1] = Add(baseCenter, side);
+		count++;
+	}
+	return count;
+}
+
+uint32_t DebugShapes::Grid(const Vector3& center, float size, uint32_t divisions, Vector3* out) {
+	assert(0 < divisions);
+	const float half = size * 0.5f;
+	const float step = size / divisions;
+
+	uint32_t count = 0;
+	for (uint32_t i = 0; i <= divisions; i++) {
+		float offset = -half + step * i;
+		// X方向の線
+		out[count * 2] = Vector3(center.x - half, center.y, center.z + offset);
+		out[count * 2 + 1] = Vector3(center.x + half, center.y, center.z + offset);
+		count++;
+		// Z方向の線
+		out[count * 2] = Vector3(center.x + offset, center.y, center.z - half);
+		out[count * 2 + 1] = Vector3(center.x + offset, center.y, center.z + half);
+		count++;
+	}
+	return count;
+}
+
+uint32_t DebugShapes::Frustum(
+  const Vector3& eye, const Vector3& target, const Vector3& up, float fovAngleY,
+  float aspectRatio, float nearZ, float farZ, Vector3* out) {
+	// 左手系のカメラ基底
+	Vector3 forward = Normalize(Sub(target, eye));
+	Vector3 right = Normalize(Cross(up, forward));
+	Vector3 cameraUp = Cross(forward, right);
+
+	const float tanHalfFov = std::tan(fovAngleY * 0.5f);
+	const float distances[] = {nearZ, farZ};
+
+	// 箱と同じ頂点の並び（ビット0が右、1が上、2が奥）
+	Vector3 corners[8];
+	for (uint32_t i = 0; i < 8; i++) {
+		float distance = distances[(i >> 2) & 1];
+		float halfHeight = distance * tanHalfFov;
+		float halfWidth = halfHeight * aspectRatio;
+		Vector3 corner = MulAdd(eye, forward, distance);
+		corner = MulAdd(corner, right, (i & 1) ? halfWidth : -halfWidth);
+		corners[i] = MulAdd(corner, cameraUp, (i & 2) ? halfHeight : -halfHeight);
+	}
+	return BoxEdges(corners, out);
+}
+
+uint32_t
+  DebugShapes::Axis(const Vector3& origin, const Vector3 axes[3], float length, Vector3* out) {
+	for (uint32_t i = 0; i < kAxisLineCount; i++) {
+		out[i * 2] = origin;
+		out[i * 2 + 1] = MulAdd(origin, axes[i], length);
+	}
+	return kAxisLineCount;
+}
+
+uint32_t DebugShapes::Arrow(const Vector3& from, const Vector3& to, float headSize, Vector3* out) {
+	Vector3 axis = Normalize(Sub(to, from));
+	Vector3 u, v;
+	Perpendicular(axis, u, v);
+	Vector3 headBase = MulAdd(to, axis, -headSize);
+
+	out[0] = from;
+	out[1] = to;
+	const Vector3 sides[] = {u, v, Scale(u, -1.0f), Scale(v, -1.0f)};
+	for (uint32_t i = 0; i < 4; i++) {
+		out[(i + 1) * 2] = to;
+		out[(i + 1) * 2 + 1] = MulAdd(headBase, sides[i], headSize * 0.5f);
+	}
+	return kArrowLineCount;
+}
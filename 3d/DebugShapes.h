@@ -0,0 +1,158 @@
+﻿#pragma once
+
+#include "Vector3.h"
+#include <cstdint>
+
+/// <summary>
+/// デバッグ表示用の図形の線分生成
+/// （始点、終点の順に座標を書き出す。円周は単位円の表を作ってから展開するので頂点ごとの三角関数は無い）
+/// </summary>
+class DebugShapes {
+  public:
+	// 箱の線分数
+	static const uint32_t kBoxLineCount = 12;
+	// 視錐台の線分数
+	static const uint32_t kFrustumLineCount = 12;
+	// 座標軸の線分数
+	static const uint32_t kAxisLineCount = 3;
+	// 矢印の線分数
+	static const uint32_t kArrowLineCount = 5;
+	// 円の最小分割数
+	static const uint32_t kMinSegments = 4;
+	// 円の最大分割数
+	static const uint32_t kMaxSegments = 256;
+
+	/// <summary>
+	/// 円の分割数を使える範囲に収める（円を描く関数と線分数はこの値で数える）
+	/// </summary>
+	static uint32_t ClampSegments(uint32_t segments) {
+		return segments < kMinSegments   ? kMinSegments
+		       : kMaxSegments < segments ? kMaxSegments
+		                                 : segments;
+	}
+
+	/// <summary>
+	/// 球の線分数（3方向の大円）
+	/// </summary>
+	static uint32_t SphereLineCount(uint32_t segments) { return ClampSegments(segments) * 3; }
+
+	/// <summary>
+	/// カプセルの線分数（両端の円、側面4本、両端の半円2つずつ）
+	/// </summary>
+	static uint32_t CapsuleLineCount(uint32_t segments) {
+		segments = ClampSegments(segments);
+		return segments * 2 + 4 + segments / 2 * 4;
+	}
+
+	/// <summary>
+	/// 円錐の線分数（底面の円、側面4本）
+	/// </summary>
+	static uint32_t ConeLineCount(uint32_t segments) { return ClampSegments(segments) + 4; }
+
+	/// <summary>
+	/// グリッドの線分数
+	/// </summary>
+	static uint32_t GridLineCount(uint32_t divisions) { return (divisions + 1) * 2; }
+
+	/// <summary>
+	/// 軸に平行な箱
+	/// </summary>
+	/// <param name="min">最小座標</param>
+	/// <param name="max">最大座標</param>
+	/// <param name="out">書き出し先（kBoxLineCount * 2 個）</param>
+	/// <returns>線分数</returns>
+	static uint32_t Box(const Vector3& min, const Vector3& max, Vector3* out);
+
+	/// <summary>
+	/// 向きのある箱
+	/// </summary>
+	/// <param name="center">中心</param>
+	/// <param name="axes">各辺の向き（単位ベクトル3つ）</param>
+	/// <param name="halfExtents">各辺の長さの半分</param>
+	/// <param name="out">書き出し先（kBoxLineCount * 2 個）</param>
+	/// <returns>線分数</returns>
+	static uint32_t
+	  OrientedBox(const Vector3& center, const Vector3 axes[3], const Vector3& halfExtents, Vector3* out);
+
+	/// <summary>
+	/// 球（XY、YZ、ZX平面の大円）
+	/// </summary>
+	/// <param name="center">中心</param>
+	/// <param name="radius">半径</param>
+	/// <param name="segments">円の分割数（ClampSegmentsで収める）</param>
+	/// <param name="out">書き出し先（SphereLineCount * 2 個）</param>
+	/// <returns>線分数</returns>
+	static uint32_t Sphere(const Vector3& center, float radius, uint32_t segments, Vector3* out);
+
+	/// <summary>
+	/// カプセル
+	/// </summary>
+	/// <param name="p0">軸の始点</param>
+	/// <param name="p1">軸の終点</param>
+	/// <param name="radius">半径</param>
+	/// <param name="segments">円の分割数（ClampSegmentsで収める。半円はその半分）</param>
+	/// <param name="out">書き出し先（CapsuleLineCount * 2 個）</param>
+	/// <returns>線分数</returns>
+	static uint32_t
+	  Capsule(const Vector3& p0, const Vector3& p1, float radius, uint32_t segments, Vector3* out);
+
+	/// <summary>
+	/// 円錐
+	/// </summary>
+	/// <param name="apex">頂点</param>
+	/// <param name="direction">頂点から底面への向き（単位ベクトル）</param>
+	/// <param name="height">高さ</param>
+	/// <param name="angle">半頂角（ラジアン）</param>
+	/// <param name="segments">底面の円の分割数（ClampSegmentsで収める）</param>
+	/// <param name="out">書き出し先（ConeLineCount * 2 個）</param>
+	/// <returns>線分数</returns>
+	static uint32_t Cone(
+	  const Vector3& apex, const Vector3& direction, float height, float angle, uint32_t segments,
+	  Vector3* out);
+
+	/// <summary>
+	/// XZ平面のグリッド
+	/// </summary>
+	/// <param name="center">中心</param>
+	/// <param name="size">一辺の長さ</param>
+	/// <param name="divisions">分割数</param>
+	/// <param name="out">書き出し先（GridLineCount * 2 個）</param>
+	/// <returns>線分数</returns>
+	static uint32_t Grid(const Vector3& center, float size, uint32_t divisions, Vector3* out);
+
+	/// <summary>
+	/// 視錐台
+	/// </summary>
+	/// <param name="eye">視点</param>
+	/// <param name="target">注視点</param>
+	/// <param name="up">上方向</param>
+	/// <param name="fovAngleY">垂直方向視野角</param>
+	/// <param name="aspectRatio">アスペクト比</param>
+	/// <param name="nearZ">手前の距離</param>
+	/// <param name="farZ">奥の距離</param>
+	/// <param name="out">書き出し先（kFrustumLineCount * 2 個）</param>
+	/// <returns>線分数</returns>
+	static uint32_t Frustum(
+	  const Vector3& eye, const Vector3& target, const Vector3& up, float fovAngleY,
+	  float aspectRatio, float nearZ, float farZ, Vector3* out);
+
+	/// <summary>
+	/// 座標軸（X、Y、Zの順）
+	/// </summary>
+	/// <param name="origin">原点</param>
+	/// <param name="axes">各軸の向き</param>
+	/// <param name="length">長さ</param>
+	/// <param name="out">書き出し先（kAxisLineCount * 2 個）</param>
+	/// <returns>線分数</returns>
+	static uint32_t Axis(const Vector3& origin, const Vector3 axes[3], float length, Vector3* out);
+
+	/// <summary>
+	/// 矢印
+	/// </summary>
+	/// <param name="from">始点</param>
+	/// <param name="to">終点（矢じりの先）</param>
+	/// <param name="headSize">矢じりの大きさ</param>
+	/// <param name="out">書き出し先（kArrowLineCount * 2 個）</param>
+	/// <returns>線分数</returns>
+	static uint32_t Arrow(const Vector3& from, const Vector3& to, float headSize, Vector3* out);
+};
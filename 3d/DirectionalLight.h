@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include "Vector3.h"
 #include "MathUtility.h"
+#include "ObjLayout.h"
 
 /// <summary>
 /// 平行光源
@@ -9,14 +10,8 @@ class DirectionalLight
 {
 public: // サブクラス
 
-	// 定数バッファ用データ構造体
-	struct ConstBufferData
-	{
-		Vector3 lightv;
-		float pad1;
-		Vector3 lightcolor;
-		unsigned int active;
-	};
+	// 定数バッファ用データ構造体（並びはObjLayout.hlsli）
+	using ConstBufferData = ObjLayout::DirLight;
 
 public: // メンバ関数
 	/// <summary>
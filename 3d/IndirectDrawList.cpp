@@ -0,0 +1,133 @@
+﻿#include "IndirectDrawList.h"
+#include <cassert>
+
+namespace {
+// インデックス1つのバイト数（不明な形式は0）
+uint32_t GetIndexSize(uint32_t format) {
+	switch (format) {
+	case IndirectDrawList::kIndexFormatUint16:
+		return sizeof(uint16_t);
+	case IndirectDrawList::kIndexFormatUint32:
+		return sizeof(uint32_t);
+	default:
+		return 0;
+	}
+}
+} // namespace
+
+const uint32_t IndirectDrawList::kIndexFormatUint16;
+const uint32_t IndirectDrawList::kIndexFormatUint32;
+const uint64_t IndirectDrawList::kConstantBufferAlignment;
+
+void IndirectDrawList::Clear() {
+	candidates_.clear();
+	visible_.clear();
+	commands_.clear();
+	stats_ = Stats();
+}
+
+uint32_t IndirectDrawList::Add(
+  uint64_t worldTransform, const RenderVertexBufferView& vertexBuffer,
+  const RenderIndexBufferView& indexBuffer, uint32_t indexCount,
+  const ObjLayout::BindlessDraw& drawConstants) {
+	Command command;
+	command.worldTransform = worldTransform;
+	command.vertexBuffer = vertexBuffer;
+	command.indexBuffer.address = indexBuffer.address;
+	command.indexBuffer.size = indexBuffer.size;
+	command.indexBuffer.format = indexBuffer.format == RenderIndexFormat::kUint16
+	                               ? kIndexFormatUint16
+	                               : kIndexFormatUint32;
+	command.drawConstants = drawConstants;
+	command.draw.indexCount = indexCount;
+	command.draw.instanceCount = 1;
+	command.draw.startIndex = 0;
+	command.draw.baseVertex = 0;
+	command.draw.startInstance = 0;
+	command.pad = 0;
+
+	uint32_t index = GetCount();
+	candidates_.push_back(command);
+	visible_.push_back(true);
+	return index;
+}
+
+void IndirectDrawList::SetVisible(uint32_t first, uint32_t count, bool visible) {
+	assert(first <= GetCount() && count <= GetCount() - first);
+	for (uint32_t i = first; i < first + count; i++) {
+		visible_[i] = visible;
+	}
+}
+
+uint32_t IndirectDrawList::Build(uint32_t materialCount, uint32_t textureCapacity) {
+	commands_.clear();
+	stats_ = Stats();
+	stats_.candidateCount = GetCount();
+
+	// 外したものの後ろを前に寄せて、引数バッファに隙間を作らない
+	for (uint32_t i = 0; i < GetCount(); i++) {
+		if (!visible_[i]) {
+			stats_.culledCount++;
+		} else if (!Validate(candidates_[i], materialCount, textureCapacity)) {
+			stats_.rejectedCount++;
+		} else {
+			commands_.push_back(candidates_[i]);
+		}
+	}
+	stats_.commandCount = static_cast<uint32_t>(commands_.size());
+	return stats_.commandCount;
+}
+
+bool IndirectDrawList::Validate(
+  const Command& command, uint32_t materialCount, uint32_t textureCapacity) {
+	if (command.worldTransform == 0 || command.worldTransform % kConstantBufferAlignment != 0) {
+		return false;
+	}
+
+	// 頂点バッファと基準頂点
+	const RenderVertexBufferView& vertexBuffer = command.vertexBuffer;
+	const DrawIndexedArguments& draw = command.draw;
+	if (vertexBuffer.address == 0 || vertexBuffer.stride == 0 ||
+	    vertexBuffer.size < vertexBuffer.stride || draw.baseVertex < 0 ||
+	    vertexBuffer.size / vertexBuffer.stride <= static_cast<uint32_t>(draw.baseVertex)) {
+		return false;
+	}
+
+	// インデックスがバッファに収まるか（桁あふれしないように64ビットで比べる）
+	const IndexBufferView& indexBuffer = command.indexBuffer;
+	uint32_t indexSize = GetIndexSize(indexBuffer.format);
+	if (indexBuffer.address == 0 || indexSize == 0 || indexBuffer.address % indexSize != 0 ||
+	    draw.indexCount == 0 || draw.instanceCount == 0 ||
+	    indexBuffer.size < (static_cast<uint64_t>(draw.startIndex) + draw.indexCount) * indexSize) {
+		return false;
+	}
+
+	// マテリアルと差し替えるテクスチャの番号が表の中か
+	const ObjLayout::BindlessDraw& constants = command.drawConstants;
+	return constants.materialIndex < materialCount &&
+	       (constants.textureOverride == BINDLESS_NO_TEXTURE ||
+	        constants.textureOverride < textureCapacity);
+}
+
+void IndirectDrawList::Replay(
+  RenderCommandList& target, uint32_t worldTransformParam, uint32_t drawConstantsParam) const {
+	for (const Command& command : commands_) {
+		target.SetGraphicsRootConstantBufferView(worldTransformParam, command.worldTransform);
+		target.SetVertexBuffers(0, 1, &command.vertexBuffer);
+
+		RenderIndexBufferView indexBuffer;
+		indexBuffer.address = command.indexBuffer.address;
+		indexBuffer.size = command.indexBuffer.size;
+		indexBuffer.format = command.indexBuffer.format == kIndexFormatUint16
+		                       ? RenderIndexFormat::kUint16
+		                       : RenderIndexFormat::kUint32;
+		target.SetIndexBuffer(indexBuffer);
+
+		target.SetGraphicsRoot32BitConstants(
+		  drawConstantsParam, sizeof(command.drawConstants) / sizeof(uint32_t),
+		  &command.drawConstants, 0);
+		target.DrawIndexedInstanced(
+		  command.draw.indexCount, command.draw.instanceCount, command.draw.startIndex,
+		  command.draw.baseVertex, command.draw.startInstance);
+	}
+}
@@ -0,0 +1,154 @@
+﻿#pragma once
+
+#include "ObjLayout.h"
+#include "RenderCommandList.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 間接描画のコマンド表
+/// （描画するメッシュを登録しておき、フレームごとに見えるものだけを詰めて引数バッファの中身を作る）
+/// （引数はExecuteIndirectのコマンドシグネチャと同じ並びなので、そのまま転送して1回で発行できる）
+/// </summary>
+class IndirectDrawList {
+  public:
+	// インデックスの形式（値はDXGI_FORMATと同じ）
+	static const uint32_t kIndexFormatUint16 = 57; // DXGI_FORMAT_R16_UINT
+	static const uint32_t kIndexFormatUint32 = 42; // DXGI_FORMAT_R32_UINT
+	// ルートの定数バッファビューのアライメント
+	static const uint64_t kConstantBufferAlignment = 256;
+
+	/// <summary>
+	/// インデックスバッファビュー（D3D12_INDEX_BUFFER_VIEWと同じ並び）
+	/// </summary>
+	struct IndexBufferView {
+		uint64_t address;
+		uint32_t size;
+		uint32_t format;
+	};
+
+	/// <summary>
+	/// インデックス付き描画の引数（D3D12_DRAW_INDEXED_ARGUMENTSと同じ並び）
+	/// </summary>
+	struct DrawIndexedArguments {
+		uint32_t indexCount;
+		uint32_t instanceCount;
+		uint32_t startIndex;
+		int32_t baseVertex;
+		uint32_t startInstance;
+	};
+
+	/// <summary>
+	/// 1コマンドの引数（コマンドシグネチャの引数の順に詰めて並べる）
+	/// </summary>
+	struct Command {
+		uint64_t worldTransform;               // ワールド変換行列の定数バッファのGPUアドレス
+		RenderVertexBufferView vertexBuffer;   // D3D12_VERTEX_BUFFER_VIEWと同じ並び
+		IndexBufferView indexBuffer;           // インデックスバッファ
+		ObjLayout::BindlessDraw drawConstants; // バインドレス描画のルート定数
+		DrawIndexedArguments draw;             // 描画
+		uint32_t pad;                          // 1コマンドの大きさを8バイト境界にそろえる
+	};
+
+	/// <summary>
+	/// 直前のBuildの統計
+	/// </summary>
+	struct Stats {
+		uint32_t candidateCount = 0; // 登録数
+		uint32_t culledCount = 0;    // 見えないので外した数
+		uint32_t rejectedCount = 0;  // 引数が不正なので外した数
+		uint32_t commandCount = 0;   // 引数バッファに詰めた数
+	};
+
+	/// <summary>
+	/// 登録を全て消す
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// 描画の登録（最初は見える状態）
+	/// </summary>
+	/// <param name="worldTransform">ワールド変換行列の定数バッファのGPUアドレス</param>
+	/// <param name="vertexBuffer">頂点バッファビュー</param>
+	/// <param name="indexBuffer">インデックスバッファビュー</param>
+	/// <param name="indexCount">インデックス数</param>
+	/// <param name="drawConstants">バインドレス描画のルート定数</param>
+	/// <returns>登録番号</returns>
+	uint32_t Add(
+	  uint64_t worldTransform, const RenderVertexBufferView& vertexBuffer,
+	  const RenderIndexBufferView& indexBuffer, uint32_t indexCount,
+	  const ObjLayout::BindlessDraw& drawConstants);
+
+	/// <summary>
+	/// 見えるかどうかの設定（カリングの結果を渡す）
+	/// </summary>
+	/// <param name="first">最初の登録番号</param>
+	/// <param name="count">数</param>
+	/// <param name="visible">見えるか</param>
+	void SetVisible(uint32_t first, uint32_t count, bool visible);
+
+	/// <summary>
+	/// 見えて引数が正しいものを登録順に詰めて、引数バッファの中身を作る
+	/// </summary>
+	/// <param name="materialCount">マテリアル表の登録数</param>
+	/// <param name="textureCapacity">デスクリプタヒープの大きさ</param>
+	/// <returns>コマンド数</returns>
+	uint32_t Build(uint32_t materialCount, uint32_t textureCapacity);
+
+	/// <summary>
+	/// 引数の検証（GPUが範囲外を読まないか）
+	/// </summary>
+	/// <param name="command">コマンド</param>
+	/// <param name="materialCount">マテリアル表の登録数</param>
+	/// <param name="textureCapacity">デスクリプタヒープの大きさ</param>
+	/// <returns>正しいか</returns>
+	static bool
+	  Validate(const Command& command, uint32_t materialCount, uint32_t textureCapacity);
+
+	/// <summary>
+	/// 詰めたコマンドを1つずつの描画として発行する（ExecuteIndirectと同じ結果になる）
+	/// （記録用のバックエンドに流せば、GPUを使わずに発行される描画を確かめられる）
+	/// </summary>
+	/// <param name="target">発行先</param>
+	/// <param name="worldTransformParam">ワールド変換行列のルートパラメータ番号</param>
+	/// <param name="drawConstantsParam">ルート定数のルートパラメータ番号</param>
+	void Replay(
+	  RenderCommandList& target, uint32_t worldTransformParam, uint32_t drawConstantsParam) const;
+
+	/// <summary>
+	/// 登録数の取得
+	/// </summary>
+	uint32_t GetCount() const { return static_cast<uint32_t>(candidates_.size()); }
+
+	/// <summary>
+	/// 登録したコマンドの取得
+	/// </summary>
+	const Command& GetCandidate(uint32_t index) const { return candidates_[index]; }
+
+	/// <summary>
+	/// 詰めたコマンドの取得
+	/// </summary>
+	const std::vector<Command>& GetCommands() const { return commands_; }
+
+	/// <summary>
+	/// 統計の取得
+	/// </summary>
+	const Stats& GetStats() const { return stats_; }
+
+  private:
+	// 登録したコマンドと見えるか
+	std::vector<Command> candidates_;
+	std::vector<uint8_t> visible_;
+	// 詰めたコマンド
+	std::vector<Command> commands_;
+	// 統計
+	Stats stats_;
+};
+
+// 引数バッファの並び（コマンドシグネチャの引数は隙間なく詰めて読まれる）
+static_assert(offsetof(IndirectDrawList::Command, vertexBuffer) == 8, "unexpected layout");
+static_assert(offsetof(IndirectDrawList::Command, indexBuffer) == 24, "unexpected layout");
+static_assert(offsetof(IndirectDrawList::Command, drawConstants) == 40, "unexpected layout");
+static_assert(offsetof(IndirectDrawList::Command, draw) == 56, "unexpected layout");
+static_assert(sizeof(IndirectDrawList::Command) == 80, "unexpected layout");
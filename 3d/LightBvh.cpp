@@ -0,0 +1,449 @@
+﻿#include "LightBvh.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+const uint32_t LightBvh::kNullNode;
+const int32_t LightBvh::kMaxHeight;
+
+namespace {
+// 箱に持たせる余裕（影響範囲の半径に対する割合と最小値）
+const float kFatRatio = 0.1f;
+const float kFatMin = 0.1f;
+
+// 輝度（Rec.709）
+float Luminance(const float color[3]) {
+	return color[0] * 0.2126f + color[1] * 0.7152f + color[2] * 0.0722f;
+}
+
+// 距離減衰（ObjClusteredPSのsaturate(1 / (x + y * d + z * d * d))。係数は0以上とする）
+float DistanceAttenuation(const float atten[3], float d) {
+	float denominator = atten[0] + atten[1] * d + atten[2] * d * d;
+	return 1.0f < denominator ? 1.0f / denominator : 1.0f;
+}
+
+// 影響範囲の端で0になるように滑らかに落とす（ObjClustered.hlsliのRangeWindow）
+float RangeWindow(float d, float range) {
+	float ratio = d / range;
+	float window = (std::min)((std::max)(1.0f - ratio * ratio * ratio * ratio, 0.0f), 1.0f);
+	return window * window;
+}
+
+float SmoothStep(float edge0, float edge1, float x) {
+	if (edge0 == edge1) {
+		return edge1 <= x ? 1.0f : 0.0f;
+	}
+	float t = (std::min)((std::max)((x - edge0) / (edge1 - edge0), 0.0f), 1.0f);
+	return t * t * (3.0f - 2.0f * t);
+}
+
+// 点と箱の距離の2乗
+float DistanceSquared(const float point[3], const float min[3], const float max[3]) {
+	float distanceSq = 0.0f;
+	for (int i = 0; i < 3; i++) {
+		float d = (std::max)((std::max)(min[i] - point[i], point[i] - max[i]), 0.0f);
+		distanceSq += d * d;
+	}
+	return distanceSq;
+}
+} // namespace
+
+void LightBvh::Clear() {
+	nodes_.clear();
+	root_ = kNullNode;
+	freeList_ = kNullNode;
+	leafOfId_.clear();
+	lights_.clear();
+	lightCount_ = 0;
+}
+
+void LightBvh::Insert(uint32_t id, const Light& light) {
+	if (leafOfId_.size() <= id) {
+		leafOfId_.resize(id + 1, kNullNode);
+		lights_.resize(id + 1);
+	}
+	assert(leafOfId_[id] == kNullNode);
+
+	uint32_t leaf = AllocateNode();
+	nodes_[leaf].id = id;
+	SetLeafData(leaf, light, true);
+	InsertLeaf(leaf);
+	leafOfId_[id] = leaf;
+	lights_[id] = light;
+	lightCount_++;
+}
+
+void LightBvh::Update(uint32_t id, const Light& light) {
+	assert(Contains(id));
+	uint32_t leaf = leafOfId_[id];
+	lights_[id] = light;
+
+	// 余裕を持たせた箱に収まる間は、葉と親の値を直すだけにする
+	float center[3];
+	float radius;
+	LightClusterGrid::ComputeBoundingSphere(light, center, radius);
+	const Aabb& aabb = nodes_[leaf].aabb;
+	bool contained = true;
+	for (int i = 0; i < 3; i++) {
+		contained &= aabb.min[i] <= center[i] - radius && center[i] + radius <= aabb.max[i];
+	}
+	if (contained) {
+		SetLeafData(leaf, light, false);
+		Refit(nodes_[leaf].parent);
+		return;
+	}
+
+	RemoveLeaf(leaf);
+	SetLeafData(leaf, light, true);
+	InsertLeaf(leaf);
+}
+
+void LightBvh::Remove(uint32_t id) {
+	assert(Contains(id));
+	uint32_t leaf = leafOfId_[id];
+	RemoveLeaf(leaf);
+	FreeNode(leaf);
+	leafOfId_[id] = kNullNode;
+	lightCount_--;
+}
+
+void LightBvh::QueryOverlaps(const float center[3], float radius, std::vector<uint32_t>& ids) const {
+	ids.clear();
+	if (root_ == kNullNode) {
+		return;
+	}
+
+	uint32_t stack[kMaxHeight + 1];
+	int32_t stackSize = 0;
+	stack[stackSize++] = root_;
+	while (0 < stackSize) {
+		const Node& node = nodes_[stack[--stackSize]];
+		if (radius * radius < DistanceSquared(center, node.aabb.min, node.aabb.max)) {
+			continue;
+		}
+		if (node.IsLeaf()) {
+			// 影響範囲を包む球で確かめる
+			float lightCenter[3];
+			float lightRadius;
+			LightClusterGrid::ComputeBoundingSphere(lights_[node.id], lightCenter, lightRadius);
+			float distanceSq = 0.0f;
+			for (int i = 0; i < 3; i++) {
+				distanceSq += (lightCenter[i] - center[i]) * (lightCenter[i] - center[i]);
+			}
+			if (distanceSq <= (radius + lightRadius) * (radius + lightRadius)) {
+				ids.push_back(node.id);
+			}
+			continue;
+		}
+		assert(stackSize + 2 <= kMaxHeight + 1);
+		stack[stackSize++] = node.child[0];
+		stack[stackSize++] = node.child[1];
+	}
+}
+
+uint32_t LightBvh::QueryTopK(
+  const float center[3], float radius, uint32_t count, Contribution* results) const {
+	if (root_ == kNullNode || count == 0) {
+		return 0;
+	}
+
+	// 明るさの上限が大きい子から深さ優先でたどり、上位count個の最小値を下回る部分木は捨てる
+	struct Entry {
+		uint32_t node;
+		float bound;
+	};
+	Entry stack[kMaxHeight + 1];
+	int32_t stackSize = 0;
+	uint32_t found = 0;
+
+	float rootBound = IntensityBound(nodes_[root_], center, radius);
+	if (0.0f < rootBound) {
+		stack[stackSize++] = {root_, rootBound};
+	}
+	while (0 < stackSize) {
+		Entry entry = stack[--stackSize];
+		float threshold = found == count ? results[count - 1].intensity : 0.0f;
+		if (entry.bound <= threshold) {
+			continue;
+		}
+
+		const Node& node = nodes_[entry.node];
+		if (node.IsLeaf()) {
+			float intensity = EstimateIntensity(lights_[node.id], center, radius);
+			if (intensity <= threshold) {
+				continue;
+			}
+			// 明るい順に挿入する
+			uint32_t i = found < count ? found++ : count - 1;
+			for (; 0 < i && results[i - 1].intensity < intensity; i--) {
+				results[i] = results[i - 1];
+			}
+			results[i] = {node.id, intensity};
+			continue;
+		}
+
+		float bound0 = IntensityBound(nodes_[node.child[0]], center, radius);
+		float bound1 = IntensityBound(nodes_[node.child[1]], center, radius);
+		Entry near = {node.child[0], bound0};
+		Entry far = {node.child[1], bound1};
+		if (bound0 < bound1) {
+			std::swap(near, far);
+		}
+		assert(stackSize + 2 <= kMaxHeight + 1);
+		if (threshold < far.bound) {
+			stack[stackSize++] = far;
+		}
+		if (threshold < near.bound) {
+			stack[stackSize++] = near;
+		}
+	}
+	return found;
+}
+
+float LightBvh::EstimateIntensity(const Light& light, const float center[3], float radius) {
+	float toObject[3];
+	float distanceSq = 0.0f;
+	for (int i = 0; i < 3; i++) {
+		toObject[i] = center[i] - light.position[i];
+		distanceSq += toObject[i] * toObject[i];
+	}
+	float distance = std::sqrt(distanceSq);
+
+	// 球の最も光源に近い点での距離減衰
+	float d = (std::max)(distance - radius, 0.0f);
+	if (light.range <= d) {
+		return 0.0f;
+	}
+	float intensity =
+	  Luminance(light.color) * DistanceAttenuation(light.atten, d) * RangeWindow(d, light.range);
+
+	// スポットライトは球の見かけの大きさだけ円錐を広げて角度減衰を見積もる
+	if (light.type == LightClusterGrid::kTypeSpot && radius < distance) {
+		float cosAngle = (toObject[0] * light.direction[0] + toObject[1] * light.direction[1] +
+		                  toObject[2] * light.direction[2]) /
+		                 distance;
+		float angle = std::acos((std::min)((std::max)(cosAngle, -1.0f), 1.0f)) -
+		              std::asin(radius / distance);
+		cosAngle = angle <= 0.0f ? 1.0f : std::cos(angle);
+		intensity *= SmoothStep(light.cosOuter, light.cosInner, cosAngle);
+	}
+	return intensity;
+}
+
+uint32_t LightBvh::AllocateNode() {
+	uint32_t node;
+	if (freeList_ != kNullNode) {
+		node = freeList_;
+		freeList_ = nodes_[node].parent;
+	} else {
+		node = static_cast<uint32_t>(nodes_.size());
+		nodes_.emplace_back();
+	}
+	Node& result = nodes_[node];
+	result.parent = kNullNode;
+	result.child[0] = kNullNode;
+	result.child[1] = kNullNode;
+	result.height = 0;
+	result.id = kNullNode;
+	return node;
+}
+
+void LightBvh::FreeNode(uint32_t node) {
+	nodes_[node].parent = freeList_;
+	nodes_[node].height = -1;
+	freeList_ = node;
+}
+
+void LightBvh::InsertLeaf(uint32_t leaf) {
+	if (root_ == kNullNode) {
+		root_ = leaf;
+		nodes_[leaf].parent = kNullNode;
+		return;
+	}
+
+	// 箱の表面積の増え方が最も小さい位置を探す
+	auto area = [](const Aabb& aabb) {
+		float x = aabb.max[0] - aabb.min[0];
+		float y = aabb.max[1] - aabb.min[1];
+		float z = aabb.max[2] - aabb.min[2];
+		return 2.0f * (x * y + y * z + z * x);
+	};
+	auto merge = [](const Aabb& a, const Aabb& b) {
+		Aabb result;
+		for (int i = 0; i < 3; i++) {
+			result.min[i] = (std::min)(a.min[i], b.min[i]);
+			result.max[i] = (std::max)(a.max[i], b.max[i]);
+		}
+		return result;
+	};
+
+	const Aabb leafAabb = nodes_[leaf].aabb;
+	uint32_t index = root_;
+	while (!nodes_[index].IsLeaf()) {
+		const Node& node = nodes_[index];
+		float combinedArea = area(merge(node.aabb, leafAabb));
+
+		// ここで兄弟にする費用と、子へ下りるときに祖先が広がる費用
+		float cost = 2.0f * combinedArea;
+		float inheritanceCost = 2.0f * (combinedArea - area(node.aabb));
+
+		float childCosts[2];
+		for (int i = 0; i < 2; i++) {
+			const Node& child = nodes_[node.child[i]];
+			float childArea = area(merge(child.aabb, leafAabb));
+			if (!child.IsLeaf()) {
+				childArea -= area(child.aabb);
+			}
+			childCosts[i] = childArea + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1]) {
+			break;
+		}
+		index = childCosts[0] < childCosts[1] ? node.child[0] : node.child[1];
+	}
+
+	// 兄弟と新しい親でつなぎ直す
+	uint32_t sibling = index;
+	uint32_t oldParent = nodes_[sibling].parent;
+	uint32_t newParent = AllocateNode();
+	nodes_[newParent].parent = oldParent;
+	nodes_[newParent].child[0] = sibling;
+	nodes_[newParent].child[1] = leaf;
+	nodes_[sibling].parent = newParent;
+	nodes_[leaf].parent = newParent;
+	if (oldParent != kNullNode) {
+		Node& parent = nodes_[oldParent];
+		parent.child[parent.child[0] == sibling ? 0 : 1] = newParent;
+	} else {
+		root_ = newParent;
+	}
+
+	Refit(newParent);
+}
+
+void LightBvh::RemoveLeaf(uint32_t leaf) {
+	if (leaf == root_) {
+		root_ = kNullNode;
+		return;
+	}
+
+	// 親を外して兄弟を祖父につなぐ
+	uint32_t parent = nodes_[leaf].parent;
+	uint32_t grandParent = nodes_[parent].parent;
+	uint32_t sibling = nodes_[parent].child[nodes_[parent].child[0] == leaf ? 1 : 0];
+	FreeNode(parent);
+	nodes_[sibling].parent = grandParent;
+	if (grandParent == kNullNode) {
+		root_ = sibling;
+		return;
+	}
+	Node& node = nodes_[grandParent];
+	node.child[node.child[0] == parent ? 0 : 1] = sibling;
+
+	Refit(grandParent);
+}
+
+void LightBvh::Refit(uint32_t node) {
+	while (node != kNullNode) {
+		node = Balance(node);
+		UpdateFromChildren(node);
+		node = nodes_[node].parent;
+	}
+}
+
+uint32_t LightBvh::Balance(uint32_t iA) {
+	if (nodes_[iA].IsLeaf() || nodes_[iA].height < 2) {
+		return iA;
+	}
+
+	// 高い方の子を持ち上げ、その子の低い方の孫をAに渡す
+	uint32_t iB = nodes_[iA].child[0];
+	uint32_t iC = nodes_[iA].child[1];
+	int32_t balance = nodes_[iC].height - nodes_[iB].height;
+	if (-1 <= balance && balance <= 1) {
+		return iA;
+	}
+	int up = 1 < balance ? 1 : 0;
+	uint32_t iUp = nodes_[iA].child[up];
+	Node& nodeUp = nodes_[iUp];
+	uint32_t iF = nodeUp.child[0];
+	uint32_t iG = nodeUp.child[1];
+
+	// 持ち上げた子をAの位置に置く
+	nodeUp.child[0] = iA;
+	nodeUp.parent = nodes_[iA].parent;
+	nodes_[iA].parent = iUp;
+	if (nodeUp.parent != kNullNode) {
+		Node& parent = nodes_[nodeUp.parent];
+		parent.child[parent.child[0] == iA ? 0 : 1] = iUp;
+	} else {
+		root_ = iUp;
+	}
+
+	// 高い方の孫を残し、低い方をAの子にする
+	uint32_t iKeep = iF;
+	uint32_t iGive = iG;
+	if (nodes_[iF].height <= nodes_[iG].height) {
+		std::swap(iKeep, iGive);
+	}
+	nodeUp.child[1] = iKeep;
+	nodes_[iA].child[up] = iGive;
+	nodes_[iGive].parent = iA;
+
+	UpdateFromChildren(iA);
+	UpdateFromChildren(iUp);
+	return iUp;
+}
+
+void LightBvh::UpdateFromChildren(uint32_t index) {
+	Node& node = nodes_[index];
+	const Node& a = nodes_[node.child[0]];
+	const Node& b = nodes_[node.child[1]];
+	for (int i = 0; i < 3; i++) {
+		node.aabb.min[i] = (std::min)(a.aabb.min[i], b.aabb.min[i]);
+		node.aabb.max[i] = (std::max)(a.aabb.max[i], b.aabb.max[i]);
+		node.positions.min[i] = (std::min)(a.positions.min[i], b.positions.min[i]);
+		node.positions.max[i] = (std::max)(a.positions.max[i], b.positions.max[i]);
+		node.minAtten[i] = (std::min)(a.minAtten[i], b.minAtten[i]);
+	}
+	node.height = 1 + (std::max)(a.height, b.height);
+	node.maxLuminance = (std::max)(a.maxLuminance, b.maxLuminance);
+	node.maxRange = (std::max)(a.maxRange, b.maxRange);
+	assert(node.height < kMaxHeight);
+}
+
+void LightBvh::SetLeafData(uint32_t leaf, const Light& light, bool fatten) {
+	Node& node = nodes_[leaf];
+	if (fatten) {
+		float center[3];
+		float radius;
+		LightClusterGrid::ComputeBoundingSphere(light, center, radius);
+		float extent = radius + (std::max)(radius * kFatRatio, kFatMin);
+		for (int i = 0; i < 3; i++) {
+			node.aabb.min[i] = center[i] - extent;
+			node.aabb.max[i] = center[i] + extent;
+		}
+	}
+	for (int i = 0; i < 3; i++) {
+		node.positions.min[i] = light.position[i];
+		node.positions.max[i] = light.position[i];
+		node.minAtten[i] = light.atten[i];
+	}
+	node.maxLuminance = Luminance(light.color);
+	node.maxRange = light.range;
+}
+
+float LightBvh::IntensityBound(const Node& node, const float center[3], float radius) const {
+	// 影響範囲が届かない
+	if (radius * radius < DistanceSquared(center, node.aabb.min, node.aabb.max)) {
+		return 0.0f;
+	}
+	// 光源の座標の箱までの距離で、最も弱い減衰を見積もる
+	float d = std::sqrt(DistanceSquared(center, node.positions.min, node.positions.max)) - radius;
+	d = (std::max)(d, 0.0f);
+	if (node.maxRange <= d) {
+		return 0.0f;
+	}
+	return node.maxLuminance * DistanceAttenuation(node.minAtten, d) * RangeWindow(d, node.maxRange);
+}
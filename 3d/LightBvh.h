@@ -0,0 +1,156 @@
+﻿#pragma once
+
+#include "LightClusterGrid.h"
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 光源の空間索引（点光源・スポットライトの影響範囲を箱の木で管理する）
+/// （物体に届く光源を、推定した明るさの大きい順に必要な数だけ取り出せる）
+/// （光源の移動は余裕を持たせた箱に収まる間は葉の書き換えだけで済ませる）
+/// </summary>
+class LightBvh {
+  public:
+	using Light = LightClusterGrid::Light;
+
+	// 無効な番号
+	static const uint32_t kNullNode = UINT32_MAX;
+	// 木の高さの上限（探索のスタックの大きさ）
+	static const int32_t kMaxHeight = 64;
+
+	/// <summary>
+	/// 光源の寄与
+	/// </summary>
+	struct Contribution {
+		uint32_t id;     // 光源番号
+		float intensity; // 推定した明るさ
+	};
+
+	/// <summary>
+	/// 全消去
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// 光源の追加
+	/// </summary>
+	/// <param name="id">光源番号（呼び出し側で管理する。大きな値は避ける）</param>
+	/// <param name="light">光源</param>
+	void Insert(uint32_t id, const Light& light);
+
+	/// <summary>
+	/// 光源の変更（余裕を持たせた箱からはみ出したときだけ木を組み替える）
+	/// </summary>
+	/// <param name="id">光源番号</param>
+	/// <param name="light">光源</param>
+	void Update(uint32_t id, const Light& light);
+
+	/// <summary>
+	/// 光源の削除
+	/// </summary>
+	/// <param name="id">光源番号</param>
+	void Remove(uint32_t id);
+
+	/// <summary>
+	/// 登録済みか
+	/// </summary>
+	bool Contains(uint32_t id) const { return id < leafOfId_.size() && leafOfId_[id] != kNullNode; }
+
+	/// <summary>
+	/// 球に届く光源を列挙する
+	/// </summary>
+	/// <param name="center">球の中心</param>
+	/// <param name="radius">球の半径</param>
+	/// <param name="ids">光源番号</param>
+	void QueryOverlaps(const float center[3], float radius, std::vector<uint32_t>& ids) const;
+
+	/// <summary>
+	/// 球に届く光源のうち、推定した明るさの大きいものを取り出す
+	/// </summary>
+	/// <param name="center">物体の境界球の中心</param>
+	/// <param name="radius">物体の境界球の半径</param>
+	/// <param name="count">取り出す最大数</param>
+	/// <param name="results">明るい順の結果（count個分の領域）</param>
+	/// <returns>取り出した数</returns>
+	uint32_t QueryTopK(
+	  const float center[3], float radius, uint32_t count, Contribution* results) const;
+
+	/// <summary>
+	/// 球の位置での光源の推定した明るさ（ObjClusteredPSの減衰と同じ式を、球の最も近い点で見積もる）
+	/// </summary>
+	static float EstimateIntensity(const Light& light, const float center[3], float radius);
+
+	uint32_t GetLightCount() const { return lightCount_; }
+	uint32_t GetHeight() const { return root_ == kNullNode ? 0 : nodes_[root_].height; }
+
+  private:
+	// 軸平行な箱
+	struct Aabb {
+		float min[3];
+		float max[3];
+	};
+
+	// 節
+	struct Node {
+		Aabb aabb;          // 影響範囲を包む箱（葉は余裕を持たせる）
+		Aabb positions;     // 光源の座標を包む箱
+		uint32_t parent;    // 親（空き節では次の空き節）
+		uint32_t child[2];  // 子（葉ではkNullNode）
+		int32_t height;     // 葉が0（空き節は-1）
+		uint32_t id;        // 葉の光源番号
+		float maxLuminance; // 部分木の光源の最大輝度
+		float maxRange;     // 部分木の光源の最大の影響範囲
+		float minAtten[3];  // 部分木の光源の最小の減衰係数
+
+		bool IsLeaf() const { return child[0] == kNullNode; }
+	};
+
+	/// <summary>
+	/// 節の確保と解放
+	/// </summary>
+	uint32_t AllocateNode();
+	void FreeNode(uint32_t node);
+
+	/// <summary>
+	/// 葉を木に入れる、木から外す
+	/// </summary>
+	void InsertLeaf(uint32_t leaf);
+	void RemoveLeaf(uint32_t leaf);
+
+	/// <summary>
+	/// 箱と明るさの上限を親へ向かって直す（偏りがあれば回転する）
+	/// </summary>
+	void Refit(uint32_t node);
+
+	/// <summary>
+	/// 偏りを直す（AVL木の回転）
+	/// </summary>
+	uint32_t Balance(uint32_t node);
+
+	/// <summary>
+	/// 子から節の値を作り直す
+	/// </summary>
+	void UpdateFromChildren(uint32_t node);
+
+	/// <summary>
+	/// 葉の値を光源から作る（影響範囲の箱はfattenのときだけ作り直す）
+	/// </summary>
+	void SetLeafData(uint32_t leaf, const Light& light, bool fatten);
+
+	/// <summary>
+	/// 部分木の光源が球に与えうる明るさの上限
+	/// </summary>
+	float IntensityBound(const Node& node, const float center[3], float radius) const;
+
+	// 節
+	std::vector<Node> nodes_;
+	// 根
+	uint32_t root_ = kNullNode;
+	// 空き節の先頭
+	uint32_t freeList_ = kNullNode;
+	// 光源番号ごとの葉と光源
+	std::vector<uint32_t> leafOfId_;
+	std::vector<Light> lights_;
+	// 光源数
+	uint32_t lightCount_ = 0;
+};
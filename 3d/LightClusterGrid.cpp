@@ -0,0 +1,219 @@
+﻿#include "LightClusterGrid.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+const uint32_t LightClusterGrid::kTypePoint;
+const uint32_t LightClusterGrid::kTypeSpot;
+
+namespace {
+// 並列処理の粒度（光源数）
+const uint32_t kLightGrainSize = 256;
+
+// タンジェントをタイル番号に（範囲外は端に寄せる）
+uint16_t TileFromTangent(float tangent, float tanHalf, uint32_t tiles) {
+	float t = (tangent / tanHalf * 0.5f + 0.5f) * tiles;
+	t = (std::min)((std::max)(t, 0.0f), static_cast<float>(tiles - 1));
+	return static_cast<uint16_t>(t);
+}
+} // namespace
+
+void LightClusterGrid::ComputeBoundingSphere(const Light& light, float center[3], float& radius) {
+	center[0] = light.position[0];
+	center[1] = light.position[1];
+	center[2] = light.position[2];
+	radius = light.range;
+	if (light.type != kTypeSpot) {
+		return;
+	}
+
+	float cosAngle = (std::max)(light.cosOuter, 1e-4f);
+	float offset;
+	if (cosAngle < 0.70710678f) {
+		// 45度より広い円錐は底面の円を包む
+		offset = light.range * cosAngle;
+		radius = light.range * std::sqrt(1.0f - cosAngle * cosAngle);
+	} else {
+		offset = light.range / (2.0f * cosAngle);
+		radius = offset;
+	}
+	for (int i = 0; i < 3; i++) {
+		center[i] += light.direction[i] * offset;
+	}
+}
+
+void LightClusterGrid::Initialize(const Settings& settings) {
+	assert(0 < settings.tilesX && 0 < settings.tilesY && 0 < settings.slices);
+	settings_ = settings;
+	clusters_.assign(GetClusterCount(), Cluster{0, 0});
+	indices_.clear();
+	sliceLights_.assign(settings_.slices, std::vector<uint32_t>());
+	sliceIndices_.assign(settings_.slices, std::vector<uint32_t>());
+}
+
+void LightClusterGrid::Build(const Camera& camera, const Light* lights, uint32_t lightCount) {
+	assert(0.0f < camera.nearZ && camera.nearZ < camera.farZ);
+	auto start = std::chrono::steady_clock::now();
+
+	// 奥行きは指数的に分割する
+	float logRatio = std::log(camera.farZ / camera.nearZ);
+	sliceScale_ = settings_.slices / logRatio;
+	sliceBias_ = -settings_.slices * std::log(camera.nearZ) / logRatio;
+
+	ThreadPool* threadPool = ThreadPool::GetInstance();
+
+	// 光源ごとに届くクラスタの範囲を求める
+	bounds_.resize(lightCount);
+	threadPool->ParallelFor(lightCount, kLightGrainSize, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			ComputeBounds(camera, lights[i], bounds_[i]);
+		}
+	});
+
+	// 奥行きの分割ごとに光源を仕分ける（番号順を保つ）
+	for (std::vector<uint32_t>& slice : sliceLights_) {
+		slice.clear();
+	}
+	for (uint32_t i = 0; i < lightCount; i++) {
+		const Bounds& bounds = bounds_[i];
+		if (!bounds.visible) {
+			continue;
+		}
+		for (uint32_t z = bounds.z0; z <= bounds.z1; z++) {
+			sliceLights_[z].push_back(i);
+		}
+	}
+
+	// 分割ごとに並列でクラスタの光源番号リストを作る
+	const uint32_t tilesPerSlice = settings_.tilesX * settings_.tilesY;
+	threadPool->ParallelFor(settings_.slices, 1, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t z = begin; z < end; z++) {
+			Cluster* clusters = &clusters_[GetClusterIndex(0, 0, z)];
+			for (uint32_t i = 0; i < tilesPerSlice; i++) {
+				clusters[i] = {0, 0};
+			}
+
+			// 数える
+			for (uint32_t light : sliceLights_[z]) {
+				const Bounds& bounds = bounds_[light];
+				for (uint32_t y = bounds.y0; y <= bounds.y1; y++) {
+					for (uint32_t x = bounds.x0; x <= bounds.x1; x++) {
+						clusters[y * settings_.tilesX + x].count++;
+					}
+				}
+			}
+
+			// 分割内での開始位置
+			uint32_t offset = 0;
+			for (uint32_t i = 0; i < tilesPerSlice; i++) {
+				clusters[i].offset = offset;
+				offset += clusters[i].count;
+				clusters[i].count = 0;
+			}
+
+			// 詰める
+			std::vector<uint32_t>& sliceIndices = sliceIndices_[z];
+			sliceIndices.resize(offset);
+			for (uint32_t light : sliceLights_[z]) {
+				const Bounds& bounds = bounds_[light];
+				for (uint32_t y = bounds.y0; y <= bounds.y1; y++) {
+					for (uint32_t x = bounds.x0; x <= bounds.x1; x++) {
+						Cluster& cluster = clusters[y * settings_.tilesX + x];
+						sliceIndices[cluster.offset + cluster.count++] = light;
+					}
+				}
+			}
+		}
+	});
+
+	// 分割ごとのリストを1本につなぐ（入りきらない分は捨てる）
+	std::vector<uint32_t> sliceBases(settings_.slices);
+	uint32_t total = 0;
+	for (uint32_t z = 0; z < settings_.slices; z++) {
+		sliceBases[z] = total;
+		total += static_cast<uint32_t>(sliceIndices_[z].size());
+	}
+	const uint32_t indexCount = (std::min)(total, settings_.maxIndexCount);
+	droppedCount_ = total - indexCount;
+	indices_.resize(indexCount);
+
+	threadPool->ParallelFor(settings_.slices, 1, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t z = begin; z < end; z++) {
+			const uint32_t base = sliceBases[z];
+			Cluster* clusters = &clusters_[GetClusterIndex(0, 0, z)];
+			for (uint32_t i = 0; i < tilesPerSlice; i++) {
+				Cluster& cluster = clusters[i];
+				cluster.offset += base;
+				if (indexCount <= cluster.offset) {
+					cluster.offset = indexCount;
+					cluster.count = 0;
+				} else {
+					cluster.count = (std::min)(cluster.count, indexCount - cluster.offset);
+				}
+			}
+
+			const std::vector<uint32_t>& sliceIndices = sliceIndices_[z];
+			if (base < indexCount && !sliceIndices.empty()) {
+				size_t copyCount = (std::min)(sliceIndices.size(), static_cast<size_t>(indexCount - base));
+				memcpy(&indices_[base], sliceIndices.data(), copyCount * sizeof(uint32_t));
+			}
+		}
+	});
+
+	buildMilliseconds_ =
+	  std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void LightClusterGrid::ComputeBounds(const Camera& camera, const Light& light, Bounds& bounds) const {
+	bounds.visible = false;
+
+	// 影響範囲を包む球
+	float center[3];
+	float radius;
+	ComputeBoundingSphere(light, center, radius);
+
+	// ビュー空間へ
+	float p[3];
+	for (int i = 0; i < 3; i++) {
+		p[i] = center[0] * camera.view[0][i] + center[1] * camera.view[1][i] +
+		       center[2] * camera.view[2][i] + camera.view[3][i];
+	}
+
+	// 奥行き
+	float zMin = p[2] - radius;
+	float zMax = p[2] + radius;
+	if (zMax < camera.nearZ || camera.farZ < zMin) {
+		return;
+	}
+	zMin = (std::max)(zMin, camera.nearZ);
+	zMax = (std::min)(zMax, camera.farZ);
+
+	// 球を包む箱の横・縦の広がりを、奥行きの両端で見たタンジェントの範囲で押さえる
+	const float tanHalfY = std::tan(camera.fovAngleY * 0.5f);
+	const float tanHalfX = tanHalfY * camera.aspectRatio;
+	float left = (p[0] - radius) / (p[0] - radius < 0.0f ? zMin : zMax);
+	float right = (p[0] + radius) / (0.0f < p[0] + radius ? zMin : zMax);
+	float bottom = (p[1] - radius) / (p[1] - radius < 0.0f ? zMin : zMax);
+	float top = (p[1] + radius) / (0.0f < p[1] + radius ? zMin : zMax);
+	if (right < -tanHalfX || tanHalfX < left || top < -tanHalfY || tanHalfY < bottom) {
+		return;
+	}
+
+	bounds.x0 = TileFromTangent(left, tanHalfX, settings_.tilesX);
+	bounds.x1 = TileFromTangent(right, tanHalfX, settings_.tilesX);
+	// 画面の上が0番
+	bounds.y0 = TileFromTangent(-top, tanHalfY, settings_.tilesY);
+	bounds.y1 = TileFromTangent(-bottom, tanHalfY, settings_.tilesY);
+	bounds.z0 = static_cast<uint16_t>(SliceFromDepth(zMin));
+	bounds.z1 = static_cast<uint16_t>(SliceFromDepth(zMax));
+	bounds.visible = true;
+}
+
+uint32_t LightClusterGrid::SliceFromDepth(float z) const {
+	float slice = std::log(z) * sliceScale_ + sliceBias_;
+	slice = (std::min)((std::max)(slice, 0.0f), static_cast<float>(settings_.slices - 1));
+	return static_cast<uint32_t>(slice);
+}
@@ -0,0 +1,144 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// クラスタードライティングの光源振り分け
+/// （視錐台をタイル×指数分割の奥行きで区切り、各クラスタに届く光源の番号を詰めて並べる）
+/// （D3Dやエンジンの型に依存しないので単体で検証できる）
+/// </summary>
+class LightClusterGrid {
+  public:
+	// 光源の種類
+	static const uint32_t kTypePoint = 0;
+	static const uint32_t kTypeSpot = 1;
+
+	/// <summary>
+	/// 光源（ObjClustered.hlsliのClusterLightと同じ並び）
+	/// </summary>
+	struct Light {
+		float position[3];  // ライト座標
+		float range;        // 影響範囲
+		float color[3];     // ライトの色(RGB)
+		uint32_t type;      // 光源の種類
+		float direction[3]; // スポットライトの光線方向（単位ベクトル）
+		float cosOuter;     // スポットライトの減衰終了角度のコサイン
+		float atten[3];     // ライト距離減衰係数
+		float cosInner;     // スポットライトの減衰開始角度のコサイン
+	};
+
+	/// <summary>
+	/// クラスタごとの光源番号の範囲
+	/// </summary>
+	struct Cluster {
+		uint32_t offset; // 光源番号リストの開始位置
+		uint32_t count;  // 光源数
+	};
+
+	/// <summary>
+	/// 分割設定
+	/// </summary>
+	struct Settings {
+		uint32_t tilesX = 16;            // 横のタイル数
+		uint32_t tilesY = 9;             // 縦のタイル数
+		uint32_t slices = 24;            // 奥行きの分割数
+		uint32_t maxIndexCount = 1 << 20; // 光源番号リストの最大長
+	};
+
+	/// <summary>
+	/// カメラ（左手系、行ベクトル形式のビュー行列）
+	/// </summary>
+	struct Camera {
+		float view[4][4];
+		float fovAngleY;
+		float aspectRatio;
+		float nearZ;
+		float farZ;
+	};
+
+	/// <summary>
+	/// 光源の影響範囲を包む球（スポットライトは円錐を包む球）
+	/// </summary>
+	/// <param name="light">光源</param>
+	/// <param name="center">中心</param>
+	/// <param name="radius">半径</param>
+	static void ComputeBoundingSphere(const Light& light, float center[3], float& radius);
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	void Initialize(const Settings& settings);
+
+	/// <summary>
+	/// 光源をクラスタに振り分ける（スレッドプールで並列に行う）
+	/// </summary>
+	/// <param name="camera">カメラ</param>
+	/// <param name="lights">光源の配列</param>
+	/// <param name="lightCount">光源数</param>
+	void Build(const Camera& camera, const Light* lights, uint32_t lightCount);
+
+	const Settings& GetSettings() const { return settings_; }
+	uint32_t GetClusterCount() const { return settings_.tilesX * settings_.tilesY * settings_.slices; }
+
+	/// <summary>
+	/// クラスタ番号（奥行き、縦、横の順に並ぶ）
+	/// </summary>
+	uint32_t GetClusterIndex(uint32_t x, uint32_t y, uint32_t z) const {
+		return (z * settings_.tilesY + y) * settings_.tilesX + x;
+	}
+
+	const std::vector<Cluster>& GetClusters() const { return clusters_; }
+	const std::vector<uint32_t>& GetIndices() const { return indices_; }
+
+	/// <summary>
+	/// 奥行き分割の係数（slice = log(z) * scale + bias）
+	/// </summary>
+	float GetSliceScale() const { return sliceScale_; }
+	float GetSliceBias() const { return sliceBias_; }
+
+	/// <summary>
+	/// 光源番号リストに入りきらず捨てた数
+	/// </summary>
+	uint32_t GetDroppedCount() const { return droppedCount_; }
+
+	/// <summary>
+	/// 直前の振り分けにかかった時間（ミリ秒）
+	/// </summary>
+	double GetBuildMilliseconds() const { return buildMilliseconds_; }
+
+  private:
+	// 光源が届くクラスタの範囲（両端を含む）
+	struct Bounds {
+		uint16_t x0, x1, y0, y1, z0, z1;
+		bool visible;
+	};
+
+	/// <summary>
+	/// 光源の範囲を求める
+	/// </summary>
+	void ComputeBounds(const Camera& camera, const Light& light, Bounds& bounds) const;
+
+	/// <summary>
+	/// ビュー空間の奥行きから分割番号を求める
+	/// </summary>
+	uint32_t SliceFromDepth(float z) const;
+
+	// 分割設定
+	Settings settings_;
+	// クラスタごとの範囲
+	std::vector<Cluster> clusters_;
+	// 光源番号リスト
+	std::vector<uint32_t> indices_;
+	// 光源ごとの範囲
+	std::vector<Bounds> bounds_;
+	// 奥行きの分割ごとの光源と、その中で作った光源番号リスト
+	std::vector<std::vector<uint32_t>> sliceLights_;
+	std::vector<std::vector<uint32_t>> sliceIndices_;
+	// 奥行き分割の係数
+	float sliceScale_ = 0.0f;
+	float sliceBias_ = 0.0f;
+	// 統計
+	uint32_t droppedCount_ = 0;
+	double buildMilliseconds_ = 0.0;
+};
@@ -0,0 +1,363 @@
+﻿#include "LightGroup.h"
+#include "DirectXCommon.h"
+#include "DirtyRangeTracker.h"
+#include <cassert>
+#include <cstring>
+
+namespace {
+// 全ライト分のビット
+uint32_t AllBits(int count) { return count < 32 ? (1u << count) - 1 : UINT32_MAX; }
+} // namespace
+
+LightGroup* LightGroup::Create() {
+	// 3Dオブジェクトのインスタンスを生成
+	LightGroup* instance = new LightGroup();
+	// 初期化
+	instance->Initialize();
+	return instance;
+}
+
+void LightGroup::Initialize() {
+	// 標準のライトの設定
+	DefaultLightSetting();
+
+	HRESULT result;
+	ID3D12Device* device = DirectXCommon::GetInstance()->GetDevice();
+
+	// ヒーププロパティ
+	CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	// リソース設定（フレームごとの複製を並べる）
+	constBufferStride_ = (sizeof(ConstBufferData) + 0xff) & ~0xff;
+	CD3DX12_RESOURCE_DESC resourceDesc =
+	  CD3DX12_RESOURCE_DESC::Buffer(constBufferStride_ * DirectXCommon::kMaxFrameCount);
+
+	// 定数バッファの生成
+	result = device->CreateCommittedResource(
+	  &heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+	  IID_PPV_ARGS(&constBuff_));
+	assert(SUCCEEDED(result));
+
+	// 定数バッファとのデータリンク
+	result = constBuff_->Map(0, nullptr, (void**)&constMap_);
+	assert(SUCCEEDED(result));
+
+	// 初回は全て転送
+	ambientDirty_ = true;
+	dirLightDirtyBits_ = AllBits(kDirLightNum);
+	pointLightDirtyBits_ = AllBits(kPointLightNum);
+	spotLightDirtyBits_ = AllBits(kSpotLightNum);
+	circleShadowDirtyBits_ = AllBits(kCircleShadowNum);
+	TransferConstBuffer();
+}
+
+void LightGroup::Update() {
+	// 値の更新があった時だけ定数バッファに転送する
+	if (dirty_) {
+		TransferConstBuffer();
+	}
+}
+
+void LightGroup::Draw(ID3D12GraphicsCommandList* cmdList, UINT rootParameterIndex) {
+	// このフレームの複製が古ければ先に書き込む
+	uint32_t frameIndex = DirectXCommon::GetInstance()->GetFrameIndex();
+	TransferFrameCopy(frameIndex);
+
+	// 定数バッファビューをセット
+	cmdList->SetGraphicsRootConstantBufferView(
+	  rootParameterIndex, constBuff_->GetGPUVirtualAddress() + constBufferStride_ * frameIndex);
+}
+
+void LightGroup::PrepareDraw() {
+	Update();
+	TransferFrameCopy(DirectXCommon::GetInstance()->GetFrameIndex());
+}
+
+void LightGroup::TransferConstBuffer() {
+	// 変更を全フレームの複製に配る
+	const uint32_t bits[kDirtyKindNum] = {
+	  ambientDirty_ ? 1u : 0u, dirLightDirtyBits_, pointLightDirtyBits_, spotLightDirtyBits_,
+	  circleShadowDirtyBits_};
+	for (uint32_t frame = 0; frame < DirectXCommon::kMaxFrameCount; frame++) {
+		for (int kind = 0; kind < kDirtyKindNum; kind++) {
+			frameDirtyBits_[frame][kind] |= bits[kind];
+		}
+	}
+
+	dirty_ = false;
+	ambientDirty_ = false;
+	dirLightDirtyBits_ = 0;
+	pointLightDirtyBits_ = 0;
+	spotLightDirtyBits_ = 0;
+	circleShadowDirtyBits_ = 0;
+
+	TransferFrameCopy(DirectXCommon::GetInstance()->GetFrameIndex());
+}
+
+void LightGroup::TransferFrameCopy(uint32_t frameIndex) {
+	assert(constMap_);
+	assert(frameIndex < DirectXCommon::kMaxFrameCount);
+	uint32_t* frameBits = frameDirtyBits_[frameIndex];
+	if ((frameBits[kDirtyAmbient] | frameBits[kDirtyDirLight] | frameBits[kDirtyPointLight] |
+	     frameBits[kDirtySpotLight] | frameBits[kDirtyCircleShadow]) == 0) {
+		return;
+	}
+	ConstBufferData* constMap = reinterpret_cast<ConstBufferData*>(
+	  reinterpret_cast<uint8_t*>(constMap_) + constBufferStride_ * frameIndex);
+	transferredBytes_ = 0;
+
+	// 書き込み先はアップロードヒープなので、読み戻さずに変更範囲を先頭から順に書き込む
+	if (frameBits[kDirtyAmbient]) {
+		constMap->ambientColor = ambientColor_;
+		transferredBytes_ += sizeof(Vector3);
+	}
+
+	// 平行光源
+	DirtyRangeTracker::ForEachBitRange(
+	  frameBits[kDirtyDirLight], [&](uint32_t begin, uint32_t end) {
+		  DirectionalLight::ConstBufferData data[kDirLightNum] = {};
+		  for (uint32_t i = begin; i < end; i++) {
+			  if (dirLights_[i].IsActive()) {
+				  data[i].lightv = -dirLights_[i].GetLightDir();
+				  data[i].lightcolor = dirLights_[i].GetLightColor();
+				  data[i].active = 1;
+			  }
+		  }
+		  size_t size = sizeof(DirectionalLight::ConstBufferData) * (end - begin);
+		  memcpy(&constMap->dirLights[begin], &data[begin], size);
+		  transferredBytes_ += size;
+	  });
+
+	// 点光源
+	DirtyRangeTracker::ForEachBitRange(
+	  frameBits[kDirtyPointLight], [&](uint32_t begin, uint32_t end) {
+		  PointLight::ConstBufferData data[kPointLightNum] = {};
+		  for (uint32_t i = begin; i < end; i++) {
+			  if (pointLights_[i].IsActive()) {
+				  data[i].lightpos = pointLights_[i].GetLightPos();
+				  data[i].lightcolor = pointLights_[i].GetLightColor();
+				  data[i].lightatten = pointLights_[i].GetLightAtten();
+				  data[i].active = 1;
+			  }
+		  }
+		  size_t size = sizeof(PointLight::ConstBufferData) * (end - begin);
+		  memcpy(&constMap->pointLights[begin], &data[begin], size);
+		  transferredBytes_ += size;
+	  });
+
+	// スポットライト
+	DirtyRangeTracker::ForEachBitRange(
+	  frameBits[kDirtySpotLight], [&](uint32_t begin, uint32_t end) {
+		  SpotLight::ConstBufferData data[kSpotLightNum] = {};
+		  for (uint32_t i = begin; i < end; i++) {
+			  if (spotLights_[i].IsActive()) {
+				  data[i].lightv = -spotLights_[i].GetLightDir();
+				  data[i].lightpos = spotLights_[i].GetLightPos();
+				  data[i].lightcolor = spotLights_[i].GetLightColor();
+				  data[i].lightatten = spotLights_[i].GetLightAtten();
+				  data[i].lightfactoranglecos = spotLights_[i].GetLightFactorAngleCos();
+				  data[i].active = 1;
+			  }
+		  }
+		  size_t size = sizeof(SpotLight::ConstBufferData) * (end - begin);
+		  memcpy(&constMap->spotLights[begin], &data[begin], size);
+		  transferredBytes_ += size;
+	  });
+
+	// 丸影
+	DirtyRangeTracker::ForEachBitRange(
+	  frameBits[kDirtyCircleShadow], [&](uint32_t begin, uint32_t end) {
+		  CircleShadow::ConstBufferData data[kCircleShadowNum] = {};
+		  for (uint32_t i = begin; i < end; i++) {
+			  if (circleShadows_[i].IsActive()) {
+				  data[i].dir = -circleShadows_[i].GetDir();
+				  data[i].casterPos = circleShadows_[i].GetCasterPos();
+				  data[i].distanceCasterLight = circleShadows_[i].GetDistanceCasterLight();
+				  data[i].atten = circleShadows_[i].GetAtten();
+				  data[i].factorAngleCos = circleShadows_[i].GetFactorAngleCos();
+				  data[i].active = 1;
+			  }
+		  }
+		  size_t size = sizeof(CircleShadow::ConstBufferData) * (end - begin);
+		  memcpy(&constMap->circleShadows[begin], &data[begin], size);
+		  transferredBytes_ += size;
+	  });
+
+	for (int kind = 0; kind < kDirtyKindNum; kind++) {
+		frameBits[kind] = 0;
+	}
+}
+
+void LightGroup::DefaultLightSetting() {
+	dirLights_[0].SetActive(true);
+	dirLights_[0].SetLightColor({1.0f, 1.0f, 1.0f});
+	dirLights_[0].SetLightDir({0.0f, -1.0f, 0.0f});
+
+	dirLights_[1].SetActive(true);
+	dirLights_[1].SetLightColor({1.0f, 1.0f, 1.0f});
+	dirLights_[1].SetLightDir({+0.5f, +0.1f, +0.2f});
+
+	dirLights_[2].SetActive(true);
+	dirLights_[2].SetLightColor({1.0f, 1.0f, 1.0f});
+	dirLights_[2].SetLightDir({-0.5f, +0.1f, -0.2f});
+
+	dirLightDirtyBits_ |= 0x7;
+	dirty_ = true;
+}
+
+void LightGroup::SetAmbientColor(const Vector3& color) {
+	ambientColor_ = color;
+	ambientDirty_ = true;
+	dirty_ = true;
+}
+
+void LightGroup::SetDirLightActive(int index, bool active) {
+	assert(0 <= index && index < kDirLightNum);
+
+	dirLights_[index].SetActive(active);
+	dirLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetDirLightDir(int index, const Vector3& lightdir) {
+	assert(0 <= index && index < kDirLightNum);
+
+	dirLights_[index].SetLightDir(lightdir);
+	dirLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetDirLightColor(int index, const Vector3& lightcolor) {
+	assert(0 <= index && index < kDirLightNum);
+
+	dirLights_[index].SetLightColor(lightcolor);
+	dirLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetPointLightActive(int index, bool active) {
+	assert(0 <= index && index < kPointLightNum);
+
+	pointLights_[index].SetActive(active);
+	pointLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetPointLightPos(int index, const Vector3& lightpos) {
+	assert(0 <= index && index < kPointLightNum);
+
+	pointLights_[index].SetLightPos(lightpos);
+	pointLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetPointLightColor(int index, const Vector3& lightcolor) {
+	assert(0 <= index && index < kPointLightNum);
+
+	pointLights_[index].SetLightColor(lightcolor);
+	pointLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetPointLightAtten(int index, const Vector3& lightAtten) {
+	assert(0 <= index && index < kPointLightNum);
+
+	pointLights_[index].SetLightAtten(lightAtten);
+	pointLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetSpotLightActive(int index, bool active) {
+	assert(0 <= index && index < kSpotLightNum);
+
+	spotLights_[index].SetActive(active);
+	spotLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetSpotLightDir(int index, const Vector3& lightdir) {
+	assert(0 <= index && index < kSpotLightNum);
+
+	spotLights_[index].SetLightDir(lightdir);
+	spotLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetSpotLightPos(int index, const Vector3& lightpos) {
+	assert(0 <= index && index < kSpotLightNum);
+
+	spotLights_[index].SetLightPos(lightpos);
+	spotLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetSpotLightColor(int index, const Vector3& lightcolor) {
+	assert(0 <= index && index < kSpotLightNum);
+
+	spotLights_[index].SetLightColor(lightcolor);
+	spotLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetSpotLightAtten(int index, const Vector3& lightAtten) {
+	assert(0 <= index && index < kSpotLightNum);
+
+	spotLights_[index].SetLightAtten(lightAtten);
+	spotLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetSpotLightFactorAngle(int index, const Vector2& lightFactorAngle) {
+	assert(0 <= index && index < kSpotLightNum);
+
+	spotLights_[index].SetLightFactorAngle(lightFactorAngle);
+	spotLightDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetCircleShadowActive(int index, bool active) {
+	assert(0 <= index && index < kCircleShadowNum);
+
+	circleShadows_[index].SetActive(active);
+	circleShadowDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetCircleShadowCasterPos(int index, const Vector3& casterPos) {
+	assert(0 <= index && index < kCircleShadowNum);
+
+	circleShadows_[index].SetCasterPos(casterPos);
+	circleShadowDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetCircleShadowDir(int index, const Vector3& lightdir) {
+	assert(0 <= index && index < kCircleShadowNum);
+
+	circleShadows_[index].SetDir(lightdir);
+	circleShadowDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetCircleShadowDistanceCasterLight(int index, float distanceCasterLight) {
+	assert(0 <= index && index < kCircleShadowNum);
+
+	circleShadows_[index].SetDistanceCasterLight(distanceCasterLight);
+	circleShadowDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetCircleShadowAtten(int index, const Vector3& lightAtten) {
+	assert(0 <= index && index < kCircleShadowNum);
+
+	circleShadows_[index].SetAtten(lightAtten);
+	circleShadowDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
+
+void LightGroup::SetCircleShadowFactorAngle(int index, const Vector2& lightFactorAngle) {
+	assert(0 <= index && index < kCircleShadowNum);
+
+	circleShadows_[index].SetFactorAngle(lightFactorAngle);
+	circleShadowDirtyBits_ |= 1u << index;
+	dirty_ = true;
+}
@@ -11,6 +11,8 @@
 #include "PointLight.h"
 #include "SpotLight.h"
 #include "CircleShadow.h"
+#include "ObjLayout.h"
+#include "DirectXCommon.h"
 
 /// <summary>
 /// ライト
@@ -21,33 +23,20 @@ private: // エイリアス
 	// Microsoft::WRL::を省略
 	template <class T> using ComPtr = Microsoft::WRL::ComPtr<T>;
 
-public: // 定数
+public: // 定数（数はシェーダと共有するObjLayout.hlsliで決める）
 	// 平行光源の数
-	static const int kDirLightNum = 3;
+	static const int kDirLightNum = DIRLIGHT_NUM;
 	// 点光源の数
-	static const int kPointLightNum = 3;
+	static const int kPointLightNum = POINTLIGHT_NUM;
 	// スポットライトの数
-	static const int kSpotLightNum = 3;
+	static const int kSpotLightNum = SPOTLIGHT_NUM;
 	// 丸影の数
-	static const int kCircleShadowNum = 1;
+	static const int kCircleShadowNum = CIRCLESHADOW_NUM;
 
 public: // サブクラス
 
-	// 定数バッファ用データ構造体
-	struct ConstBufferData
-	{
-		// 環境光の色
-		Vector3 ambientColor;
-		float pad1;
-		// 平行光源用
-		DirectionalLight::ConstBufferData dirLights[kDirLightNum];
-		// 点光源用
-		PointLight::ConstBufferData pointLights[kPointLightNum];
-		// スポットライト用
-		SpotLight::ConstBufferData spotLights[kSpotLightNum];
-		// 丸影用
-		CircleShadow::ConstBufferData circleShadows[kCircleShadowNum];
-	};
+	// 定数バッファ用データ構造体（並びはObjLayout.hlsli）
+	using ConstBufferData = ObjLayout::LightGroup;
 
 public: // 静的メンバ関数
 	/// <summary>
@@ -73,10 +62,22 @@ public: // メンバ関数
 	void Draw(ID3D12GraphicsCommandList* cmdList, UINT rootParameterIndex);
 
 	/// <summary>
-	/// 定数バッファ転送
+	/// 記録中のフレームの複製を書き込んでおく
+	/// （Drawは書き込みが無ければ読むだけになるので、ワーカースレッドからDrawする前にメインスレッドで呼ぶ）
+	/// </summary>
+	void PrepareDraw();
+
+	/// <summary>
+	/// 定数バッファ転送（変更されたライトの範囲を記録中のフレームの複製に書き込む）
+	/// （他のフレームの複製には、そのフレームで描画するときに書き込む）
 	/// </summary>
 	void TransferConstBuffer();
 
+	/// <summary>
+	/// 直前の転送で書き込んだバイト数
+	/// </summary>
+	size_t GetTransferredBytes() const { return transferredBytes_; }
+
 	/// <summary>
 	/// 標準のライト設定
 	/// </summary>
@@ -221,8 +222,25 @@ public: // メンバ関数
 	/// <param name="lightFactorAngle">x:減衰開始角度 y:減衰終了角度</param>
 	void SetCircleShadowFactorAngle(int index, const Vector2& lightFactorAngle);
 
+private: // メンバ関数
+	// 変更の種類
+	enum DirtyKind {
+		kDirtyAmbient,
+		kDirtyDirLight,
+		kDirtyPointLight,
+		kDirtySpotLight,
+		kDirtyCircleShadow,
+		kDirtyKindNum,
+	};
+
+	/// <summary>
+	/// フレームの複製に未反映の変更を書き込む
+	/// </summary>
+	/// <param name="frameIndex">フレーム番号</param>
+	void TransferFrameCopy(uint32_t frameIndex);
+
 private: // メンバ変数
-	// 定数バッファ
+	// 定数バッファ（同時処理フレーム数の上限ぶんの複製を並べる）
 	ComPtr<ID3D12Resource> constBuff_;
 	// 定数バッファのマップ
 	ConstBufferData* constMap_ = nullptr;
@@ -242,7 +260,26 @@ private: // メンバ変数
 	// 丸影の配列
 	CircleShadow circleShadows_[kCircleShadowNum];
 
-	// ダーティフラグ
+	// ダーティフラグ（いずれかが変更された）
 	bool dirty_ = false;
+
+	// 種類ごとの変更されたライトのビット（ライト番号のビットが立つ）
+	// （Modelのライブラリ側で破棄されるので、後ろに足すメンバは自明に破棄できるものに限る）
+	bool ambientDirty_ = false;
+	uint32_t dirLightDirtyBits_ = 0;
+	uint32_t pointLightDirtyBits_ = 0;
+	uint32_t spotLightDirtyBits_ = 0;
+	uint32_t circleShadowDirtyBits_ = 0;
+	// 直前の転送で書き込んだバイト数
+	size_t transferredBytes_ = 0;
+	// フレームごとの複製に未反映の変更（DirtyKindの順。平行光源などはライト番号のビット）
+	// （GPUが前のフレームの複製を読んでいる間に、記録中のフレームの複製だけを書き換える）
+	uint32_t frameDirtyBits_[DirectXCommon::kMaxFrameCount][kDirtyKindNum] = {};
+	// 複製1つ分のバイト数
+	UINT64 constBufferStride_ = 0;
+
+	static_assert(
+	  kDirLightNum <= 32 && kPointLightNum <= 32 && kSpotLightNum <= 32 && kCircleShadowNum <= 32,
+	  "dirty bits hold up to 32 lights per type");
 };
 
@@ -0,0 +1,59 @@
+﻿#include "LinePageList.h"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+void LinePageList::Initialize(uint32_t linesPerPage, uint32_t lineSize, PageAllocator allocator) {
+	assert(0 < linesPerPage);
+	assert(0 < lineSize);
+	assert(allocator);
+
+	linesPerPage_ = linesPerPage;
+	lineSize_ = lineSize;
+	allocator_ = std::move(allocator);
+	pages_.clear();
+}
+
+void* LinePageList::Allocate(size_t lineCount, size_t& allocatedCount) {
+	assert(0 < lineCount);
+
+	// 書き込み中のページが埋まっていれば次のページを確保
+	if (pages_.empty() || pages_.back().lineCount == linesPerPage_) {
+		Page page;
+		page.vertices =
+		  allocator_(static_cast<uint64_t>(lineSize_) * linesPerPage_, page.gpuAddress);
+		pages_.push_back(page);
+	}
+
+	Page& page = pages_.back();
+	allocatedCount = (std::min)(lineCount, static_cast<size_t>(linesPerPage_ - page.lineCount));
+	void* vertices =
+	  static_cast<uint8_t*>(page.vertices) + static_cast<size_t>(lineSize_) * page.lineCount;
+	page.lineCount += static_cast<uint32_t>(allocatedCount);
+	return vertices;
+}
+
+bool LinePageList::HasUndrawn() const {
+	for (const Page& page : pages_) {
+		if (page.drawnCount < page.lineCount) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void LinePageList::TakeUndrawn(std::vector<Page>& pages) {
+	pages.clear();
+	for (Page& page : pages_) {
+		if (page.lineCount == page.drawnCount) {
+			continue;
+		}
+		pages.push_back(page);
+		page.drawnCount = page.lineCount;
+	}
+
+	// 書き込み中のページの残りは続けて使う
+	if (1 < pages_.size()) {
+		pages_.erase(pages_.begin(), pages_.end() - 1);
+	}
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/// <summary>
+/// 線分のページの列
+/// （PrimitiveDrawerの線分バッファ部分。ページの領域は確保関数から受け取るだけなので、
+/// 　ページの切り替えや描画済みの範囲の管理をGPU無しで検証できる）
+/// </summary>
+class LinePageList {
+  public:
+	/// <summary>
+	/// ページの領域の確保（書き込み先を返し、GPUアドレスを格納する）
+	/// </summary>
+	using PageAllocator = std::function<void*(uint64_t size, uint64_t& gpuAddress)>;
+
+	/// <summary>
+	/// ページ
+	/// </summary>
+	struct Page {
+		// 書き込み先
+		void* vertices = nullptr;
+		// GPUアドレス
+		uint64_t gpuAddress = 0;
+		// 書き込んだ線分数
+		uint32_t lineCount = 0;
+		// 描画済みの線分数
+		uint32_t drawnCount = 0;
+	};
+
+	/// <summary>
+	/// 初期化（ページを全て捨てる）
+	/// </summary>
+	/// <param name="linesPerPage">1ページの線分数</param>
+	/// <param name="lineSize">1線分のバイト数</param>
+	/// <param name="allocator">ページの領域の確保</param>
+	void Initialize(uint32_t linesPerPage, uint32_t lineSize, PageAllocator allocator);
+
+	/// <summary>
+	/// 線分の書き込み先を確保（ページをまたがないので要求より少ないことがある）
+	/// </summary>
+	/// <param name="lineCount">欲しい線分数</param>
+	/// <param name="allocatedCount">確保できた線分数</param>
+	/// <returns>書き込み先</returns>
+	void* Allocate(size_t lineCount, size_t& allocatedCount);
+
+	/// <summary>
+	/// まだ描いていない線分があるか
+	/// </summary>
+	bool HasUndrawn() const;
+
+	/// <summary>
+	/// まだ描いていない範囲のあるページを取り出して描画済みにする
+	/// （取り出したページはdrawnCount～lineCountが描く範囲。書き込み中の末尾のページだけを残す）
+	/// </summary>
+	/// <param name="pages">格納先（前の内容は消す）</param>
+	void TakeUndrawn(std::vector<Page>& pages);
+
+	/// <summary>
+	/// ページを全て捨てる（フレームの終わりに呼ぶ。描いていない線分も捨てる）
+	/// </summary>
+	void Reset() { pages_.clear(); }
+
+	/// <summary>
+	/// 残っているページの数
+	/// </summary>
+	size_t GetPageCount() const { return pages_.size(); }
+
+	/// <summary>
+	/// 残っているページの取得（末尾が書き込み中）
+	/// </summary>
+	const Page& GetPage(size_t index) const { return pages_[index]; }
+
+  private:
+	// 1ページの線分数
+	uint32_t linesPerPage_ = 0;
+	// 1線分のバイト数
+	uint32_t lineSize_ = 0;
+	// ページの領域の確保
+	PageAllocator allocator_;
+	// ページ（末尾が書き込み中）
+	std::vector<Page> pages_;
+};
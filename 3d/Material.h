@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include "ObjLayout.h"
 #include "Vector3.h"
 #include <d3d12.h>
 #include <d3dx12.h>
@@ -11,15 +12,8 @@
 /// </summary>
 class Material {
   public: // サブクラス
-	// 定数バッファ用データ構造体
-	struct ConstBufferData {
-		Vector3 ambient;  // アンビエント係数
-		float pad1;        // パディング
-		Vector3 diffuse;  // ディフューズ係数
-		float pad2;        // パディング
-		Vector3 specular; // スペキュラー係数
-		float alpha;       // アルファ
-	};
+	// 定数バッファ用データ構造体（並びはObjLayout.hlsli）
+	using ConstBufferData = ObjLayout::Material;
 
   public: // 静的メンバ関数
 	/// <summary>
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include "Matrix4.h"
+#include "ShaderLayout.h"
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include <cstdint>
+
+// 並びの定義（Obj.hlsliと共有する）
+#include "Resources/shaders/ObjLayout.hlsli"
+
+/// <summary>
+/// Obj系シェーダの定数バッファの構造体（ObjLayout.hlsliから作り、HLSLと同じ並びかを検査する）
+/// </summary>
+namespace ObjLayout {
+
+// HLSLの型名
+using float2 = Vector2;
+using float3 = Vector3;
+using float4 = Vector4;
+using uint = uint32_t;
+using matrix = Matrix4;
+
+SHADER_LAYOUT_STRUCT(Material, MATERIAL_LAYOUT)
+SHADER_LAYOUT_ELEMENT_STRUCT(DirLight, DIRLIGHT_LAYOUT)
+SHADER_LAYOUT_ELEMENT_STRUCT(PointLight, POINTLIGHT_LAYOUT)
+SHADER_LAYOUT_ELEMENT_STRUCT(SpotLight, SPOTLIGHT_LAYOUT)
+SHADER_LAYOUT_ELEMENT_STRUCT(CircleShadow, CIRCLESHADOW_LAYOUT)
+SHADER_LAYOUT_STRUCT(LightGroup, LIGHTGROUP_LAYOUT)
+SHADER_LAYOUT_ELEMENT_STRUCT(BindlessMaterial, BINDLESSMATERIAL_LAYOUT)
+SHADER_LAYOUT_STRUCT(BindlessDraw, BINDLESSDRAW_LAYOUT)
+
+} // namespace ObjLayout
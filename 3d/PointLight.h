@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "Vector3.h"
+#include "ObjLayout.h"
 
 /// <summary>
 /// 点光源
@@ -9,16 +10,8 @@ class PointLight
 {
 public: // サブクラス
 
-	// 定数バッファ用データ構造体
-	struct ConstBufferData
-	{
-		Vector3 lightpos;
-		float pad1;
-		Vector3 lightcolor;
-		float pad2;
-		Vector3 lightatten;
-		unsigned int active;
-	};
+	// 定数バッファ用データ構造体（並びはObjLayout.hlsli）
+	using ConstBufferData = ObjLayout::PointLight;
 
 public: // メンバ関数
 	/// <summary>
@@ -0,0 +1,669 @@
+﻿#include "PrimitiveDrawer.h"
+#include "D3D12RenderCommandList.h"
+#include "DebugShapes.h"
+#include "DirectXCommon.h"
+#include "FrameUploadAllocator.h"
+#include "PipelineCache.h"
+#include "ShaderLibrary.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <d3dx12.h>
+
+using namespace Microsoft::WRL;
+using namespace MathUtility;
+
+namespace {
+// ブレンド設定
+D3D12_RENDER_TARGET_BLEND_DESC CreateBlendDesc(PrimitiveDrawer::BlendMode blendMode) {
+	D3D12_RENDER_TARGET_BLEND_DESC blenddesc{};
+	blenddesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL; // RBGA全てのチャンネルを描画
+	blenddesc.BlendEnable = true;
+	blenddesc.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	blenddesc.SrcBlendAlpha = D3D12_BLEND_ONE;
+	blenddesc.DestBlendAlpha = D3D12_BLEND_ZERO;
+
+	switch (blendMode) {
+	case PrimitiveDrawer::BlendMode::kBlendModeNone:
+		blenddesc.BlendEnable = false;
+		break;
+	case PrimitiveDrawer::BlendMode::kBlendModeNormal:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+		break;
+	case PrimitiveDrawer::BlendMode::kBlendModeAdd:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	case PrimitiveDrawer::BlendMode::kBlendModeSubtract:
+		blenddesc.BlendOp = D3D12_BLEND_OP_REV_SUBTRACT;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	case PrimitiveDrawer::BlendMode::kBlendModeMultily:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_ZERO;
+		blenddesc.DestBlend = D3D12_BLEND_SRC_COLOR;
+		break;
+	case PrimitiveDrawer::BlendMode::kBlendModeScreen:
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_INV_DEST_COLOR;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	default:
+		break;
+	}
+	return blenddesc;
+}
+} // namespace
+
+PrimitiveDrawer* PrimitiveDrawer::GetInstance() {
+	static PrimitiveDrawer instance;
+	return &instance;
+}
+
+ComPtr<ID3D12Resource> PrimitiveDrawer::CreateCommittedResource(UINT64 size) {
+	ID3D12Device* device = DirectXCommon::GetInstance()->GetDevice();
+
+	ComPtr<ID3D12Resource> resource;
+	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+	HRESULT result = device->CreateCommittedResource(
+	  &heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+	  IID_PPV_ARGS(&resource));
+	assert(SUCCEEDED(result));
+	(void)result;
+
+	return resource;
+}
+
+std::unique_ptr<PrimitiveDrawer::Mesh>
+  PrimitiveDrawer::CreateMesh(UINT vertexCount, UINT indexCount) {
+	HRESULT result;
+	std::unique_ptr<Mesh> mesh = std::make_unique<Mesh>();
+
+	if (0 < vertexCount) {
+		// 頂点バッファ
+		UINT sizeVB = static_cast<UINT>(sizeof(VertexPosColor) * vertexCount);
+		mesh->vertBuff = CreateCommittedResource(sizeVB);
+
+		mesh->vbView.BufferLocation = mesh->vertBuff->GetGPUVirtualAddress();
+		mesh->vbView.SizeInBytes = sizeVB;
+		mesh->vbView.StrideInBytes = sizeof(VertexPosColor);
+
+		result = mesh->vertBuff->Map(0, nullptr, reinterpret_cast<void**>(&mesh->vertMap));
+		assert(SUCCEEDED(result));
+	}
+
+	if (0 < indexCount) {
+		// インデックスバッファ
+		UINT sizeIB = static_cast<UINT>(sizeof(uint16_t) * indexCount);
+		mesh->indexBuff = CreateCommittedResource(sizeIB);
+
+		mesh->ibView.BufferLocation = mesh->indexBuff->GetGPUVirtualAddress();
+		mesh->ibView.Format = DXGI_FORMAT_R16_UINT;
+		mesh->ibView.SizeInBytes = sizeIB;
+
+		result = mesh->indexBuff->Map(0, nullptr, reinterpret_cast<void**>(&mesh->indexMap));
+		assert(SUCCEEDED(result));
+	}
+
+	return mesh;
+}
+
+void PrimitiveDrawer::Initialize() {
+	CreateGraphicsPipelines();
+	CreateSolidMeshes();
+
+	// 線分のページはこのフレームの一時領域から切り出す
+	for (LinePageList& linePages : linePages_) {
+		linePages.Initialize(
+		  kLinesPerPage, sizeof(VertexPosColor) * kVertexCountLine,
+		  [](uint64_t size, uint64_t& gpuAddress) {
+			  FrameUploadAllocator::Allocation allocation =
+			    FrameUploadAllocator::GetInstance()->Allocate(size);
+			  gpuAddress = allocation.gpuAddress;
+			  return allocation.cpuAddress;
+		  });
+	}
+	Reset();
+}
+
+void PrimitiveDrawer::DrawLine3d(const Vector3& p1, const Vector3& p2, const Vector4& color) {
+	size_t allocatedCount = 0;
+	VertexPosColor* vertices = AllocateLines(1, allocatedCount);
+	vertices[0] = {p1, color};
+	vertices[1] = {p2, color};
+}
+
+void PrimitiveDrawer::DrawLines(
+  const VertexPosColor* vertices, size_t lineCount, DepthMode depthMode) {
+	while (0 < lineCount) {
+		size_t allocatedCount = 0;
+		VertexPosColor* dest = AllocateLines(lineCount, allocatedCount, depthMode);
+		std::copy_n(vertices, allocatedCount * kVertexCountLine, dest);
+		vertices += allocatedCount * kVertexCountLine;
+		lineCount -= allocatedCount;
+	}
+}
+
+void PrimitiveDrawer::DrawLines(
+  const Vector3* points, size_t lineCount, const Vector4& color, DepthMode depthMode,
+  uint32_t lifetime) {
+	// 次のフレーム以降も描くものは控えておく
+	if (1 < lifetime && 0 < lineCount) {
+		PersistentLines& persistent = persistentLines_[static_cast<size_t>(depthMode)];
+		for (size_t i = 0; i < lineCount * kVertexCountLine; i++) {
+			persistent.vertices.push_back({points[i], color});
+		}
+		persistent.shapes.emplace_back(static_cast<uint32_t>(lineCount), lifetime - 1);
+	}
+
+	while (0 < lineCount) {
+		size_t allocatedCount = 0;
+		VertexPosColor* dest = AllocateLines(lineCount, allocatedCount, depthMode);
+		for (size_t i = 0; i < allocatedCount * kVertexCountLine; i++) {
+			dest[i].pos = points[i];
+			dest[i].color = color;
+		}
+		points += allocatedCount * kVertexCountLine;
+		lineCount -= allocatedCount;
+	}
+}
+
+void PrimitiveDrawer::DrawBox(
+  const Vector3& min, const Vector3& max, const Vector4& color, DepthMode depthMode,
+  uint32_t lifetime) {
+	shapePoints_.resize(DebugShapes::kBoxLineCount * kVertexCountLine);
+	SubmitShape(DebugShapes::Box(min, max, shapePoints_.data()), color, depthMode, lifetime);
+}
+
+void PrimitiveDrawer::DrawOrientedBox(
+  const Vector3& center, const Vector3 axes[3], const Vector3& halfExtents, const Vector4& color,
+  DepthMode depthMode, uint32_t lifetime) {
+	shapePoints_.resize(DebugShapes::kBoxLineCount * kVertexCountLine);
+	SubmitShape(
+	  DebugShapes::OrientedBox(center, axes, halfExtents, shapePoints_.data()), color, depthMode,
+	  lifetime);
+}
+
+void PrimitiveDrawer::DrawSphere(
+  const Vector3& center, float radius, const Vector4& color, DepthMode depthMode,
+  uint32_t lifetime, uint32_t segments) {
+	shapePoints_.resize(DebugShapes::SphereLineCount(segments) * kVertexCountLine);
+	SubmitShape(
+	  DebugShapes::Sphere(center, radius, segments, shapePoints_.data()), color, depthMode,
+	  lifetime);
+}
+
+void PrimitiveDrawer::DrawCapsule(
+  const Vector3& p0, const Vector3& p1, float radius, const Vector4& color, DepthMode depthMode,
+  uint32_t lifetime, uint32_t segments) {
+	shapePoints_.resize(DebugShapes::CapsuleLineCount(segments) * kVertexCountLine);
+	SubmitShape(
+	  DebugShapes::Capsule(p0, p1, radius, segments, shapePoints_.data()), color, depthMode,
+	  lifetime);
+}
+
+void PrimitiveDrawer::DrawCone(
+  const Vector3& apex, const Vector3& direction, float height, float angle, const Vector4& color,
+  DepthMode depthMode, uint32_t lifetime, uint32_t segments) {
+	shapePoints_.resize(DebugShapes::ConeLineCount(segments) * kVertexCountLine);
+	SubmitShape(
+	  DebugShapes::Cone(apex, direction, height, angle, segments, shapePoints_.data()), color,
+	  depthMode, lifetime);
+}
+
+void PrimitiveDrawer::DrawGrid(
+  const Vector3& center, float size, uint32_t divisions, const Vector4& color,
+  DepthMode depthMode, uint32_t lifetime) {
+	shapePoints_.resize(DebugShapes::GridLineCount(divisions) * kVertexCountLine);
+	SubmitShape(
+	  DebugShapes::Grid(center, size, divisions, shapePoints_.data()), color, depthMode, lifetime);
+}
+
+void PrimitiveDrawer::DrawFrustum(
+  const ViewProjection& viewProjection, const Vector4& color, DepthMode depthMode,
+  uint32_t lifetime) {
+	shapePoints_.resize(DebugShapes::kFrustumLineCount * kVertexCountLine);
+	SubmitShape(
+	  DebugShapes::Frustum(
+	    viewProjection.eye, viewProjection.target, viewProjection.up, viewProjection.fovAngleY,
+	    viewProjection.aspectRatio, viewProjection.nearZ, viewProjection.farZ,
+	    shapePoints_.data()),
+	  color, depthMode, lifetime);
+}
+
+void PrimitiveDrawer::DrawAxis(
+  const Matrix4& matWorld, float length, DepthMode depthMode, uint32_t lifetime) {
+	// 行ベクトル形式なので1～3行目が各軸、4行目が平行移動
+	const Vector3 axes[3] = {
+	  {matWorld.m[0][0], matWorld.m[0][1], matWorld.m[0][2]},
+	  {matWorld.m[1][0], matWorld.m[1][1], matWorld.m[1][2]},
+	  {matWorld.m[2][0], matWorld.m[2][1], matWorld.m[2][2]},
+	};
+	const Vector3 origin = {matWorld.m[3][0], matWorld.m[3][1], matWorld.m[3][2]};
+	const Vector4 colors[3] = {{1, 0, 0, 1}, {0, 1, 0, 1}, {0, 0, 1, 1}};
+
+	Vector3 points[DebugShapes::kAxisLineCount * kVertexCountLine];
+	DebugShapes::Axis(origin, axes, length, points);
+	for (uint32_t i = 0; i < DebugShapes::kAxisLineCount; i++) {
+		DrawLines(&points[i * kVertexCountLine], 1, colors[i], depthMode, lifetime);
+	}
+}
+
+void PrimitiveDrawer::DrawArrow(
+  const Vector3& from, const Vector3& to, float headSize, const Vector4& color,
+  DepthMode depthMode, uint32_t lifetime) {
+	shapePoints_.resize(DebugShapes::kArrowLineCount * kVertexCountLine);
+	SubmitShape(
+	  DebugShapes::Arrow(from, to, headSize, shapePoints_.data()), color, depthMode, lifetime);
+}
+
+void PrimitiveDrawer::DrawSolid(SolidShape shape, const Matrix4& matWorld, const Vector4& color) {
+	SolidShapes::Instance instance;
+	SolidShapes::PackMatrix(
+	  matWorld.m, SolidShapes::PackColor(color.x, color.y, color.z, color.w), instance);
+	solidInstances_[static_cast<size_t>(shape)].push_back(instance);
+}
+
+void PrimitiveDrawer::DrawSolidBox(
+  const Vector3& center, const Vector3& halfExtents, const Vector4& color) {
+	const float c[3] = {center.x, center.y, center.z};
+	const float h[3] = {halfExtents.x, halfExtents.y, halfExtents.z};
+	SolidShapes::Instance instance;
+	SolidShapes::PackBox(c, h, SolidShapes::PackColor(color.x, color.y, color.z, color.w), instance);
+	solidInstances_[static_cast<size_t>(SolidShape::kCube)].push_back(instance);
+}
+
+void PrimitiveDrawer::DrawSolidSphere(const Vector3& center, float radius, const Vector4& color) {
+	const float c[3] = {center.x, center.y, center.z};
+	SolidShapes::Instance instance;
+	SolidShapes::PackSphere(
+	  c, radius, SolidShapes::PackColor(color.x, color.y, color.z, color.w), instance);
+	solidInstances_[static_cast<size_t>(SolidShape::kSphere)].push_back(instance);
+}
+
+void PrimitiveDrawer::DrawSolidCylinder(
+  const Vector3& p0, const Vector3& p1, float radius, const Vector4& color) {
+	const float a[3] = {p0.x, p0.y, p0.z};
+	const float b[3] = {p1.x, p1.y, p1.z};
+	SolidShapes::Instance instance;
+	SolidShapes::PackCylinder(
+	  a, b, radius, SolidShapes::PackColor(color.x, color.y, color.z, color.w), instance);
+	solidInstances_[static_cast<size_t>(SolidShape::kCylinder)].push_back(instance);
+}
+
+void PrimitiveDrawer::ClearPersistent() {
+	for (PersistentLines& persistent : persistentLines_) {
+		persistent.vertices.clear();
+		persistent.shapes.clear();
+		persistent.replayCount = 0;
+	}
+}
+
+void PrimitiveDrawer::SubmitShape(
+  uint32_t lineCount, const Vector4& color, DepthMode depthMode, uint32_t lifetime) {
+	DrawLines(shapePoints_.data(), lineCount, color, depthMode, lifetime);
+}
+
+PrimitiveDrawer::VertexPosColor* PrimitiveDrawer::AllocateLines(
+  size_t lineCount, size_t& allocatedCount, DepthMode depthMode) {
+	VertexPosColor* vertices = static_cast<VertexPosColor*>(
+	  linePages_[static_cast<size_t>(depthMode)].Allocate(lineCount, allocatedCount));
+	lineCount_ += static_cast<uint32_t>(allocatedCount);
+	return vertices;
+}
+
+void PrimitiveDrawer::Flush(ID3D12GraphicsCommandList* commandList) {
+	assert(commandList);
+	D3D12RenderCommandList renderCommandList(commandList);
+	Flush(&renderCommandList);
+}
+
+void PrimitiveDrawer::Flush(RenderCommandList* commandList) {
+	assert(commandList);
+
+	// 塗りつぶし図形を先に描いて、線分が手前に乗るようにする
+	FlushSolids(commandList);
+
+	// 前のフレームから続けて表示する図形を流し込む
+	for (size_t mode = 0; mode < persistentLines_.size(); mode++) {
+		PersistentLines& persistent = persistentLines_[mode];
+		if (0 < persistent.replayCount) {
+			DrawLines(
+			  persistent.vertices.data(), persistent.replayCount / kVertexCountLine,
+			  static_cast<DepthMode>(mode));
+			persistent.replayCount = 0;
+		}
+	}
+
+	for (size_t mode = 0; mode < linePages_.size(); mode++) {
+		LinePageList& linePages = linePages_[mode];
+		if (!linePages.HasUndrawn()) {
+			continue;
+		}
+		assert(viewProjection_);
+
+		const PipelineSet& pipelineSet =
+		  *pipelineSetLines_[mode][static_cast<size_t>(blendMode_)];
+		commandList->SetPipelineState(
+		  D3D12RenderCommandList::Wrap(pipelineSet.pipelineState.Get()));
+		commandList->SetGraphicsRootSignature(
+		  D3D12RenderCommandList::Wrap(pipelineSet.rootSignature.Get()));
+		commandList->SetPrimitiveTopology(RenderTopology::kLineList);
+		commandList->SetGraphicsRootConstantBufferView(
+		  0, viewProjection_->constBuff_->GetGPUVirtualAddress());
+
+		// ページごとにまだ描いていない範囲を描画
+		linePages.TakeUndrawn(undrawnPages_);
+		for (const LinePageList::Page& page : undrawnPages_) {
+			RenderVertexBufferView vbView;
+			vbView.address = page.gpuAddress;
+			vbView.size = sizeof(VertexPosColor) * kVertexCountLine * page.lineCount;
+			vbView.stride = sizeof(VertexPosColor);
+			commandList->SetVertexBuffers(0, 1, &vbView);
+			commandList->DrawInstanced(
+			  (page.lineCount - page.drawnCount) * kVertexCountLine, 1,
+			  page.drawnCount * kVertexCountLine, 0);
+			drawCallCount_++;
+		}
+	}
+}
+
+void PrimitiveDrawer::FlushSolids(RenderCommandList* commandList) {
+	size_t instanceCount = 0;
+	for (const std::vector<SolidShapes::Instance>& instances : solidInstances_) {
+		instanceCount += instances.size();
+	}
+	if (instanceCount == 0) {
+		return;
+	}
+	assert(viewProjection_);
+
+	// 全種類のインスタンスをこのフレームの一時領域にまとめて書き込む
+	FrameUploadAllocator::Allocation allocation = FrameUploadAllocator::GetInstance()->Allocate(
+	  sizeof(SolidShapes::Instance) * instanceCount);
+	Matrix4 matViewProjection = viewProjection_->matView * viewProjection_->matProjection;
+
+	commandList->SetPipelineState(
+	  D3D12RenderCommandList::Wrap(pipelineSetSolid_->pipelineState.Get()));
+	commandList->SetGraphicsRootSignature(
+	  D3D12RenderCommandList::Wrap(pipelineSetSolid_->rootSignature.Get()));
+	commandList->SetPrimitiveTopology(RenderTopology::kTriangleList);
+	commandList->SetGraphicsRoot32BitConstants(0, 16, &matViewProjection, 0);
+
+	// 図形の種類ごとに1回で描画
+	size_t offset = 0;
+	for (size_t shape = 0; shape < solidInstances_.size(); shape++) {
+		std::vector<SolidShapes::Instance>& instances = solidInstances_[shape];
+		if (instances.empty()) {
+			continue;
+		}
+		uint32_t size = static_cast<uint32_t>(sizeof(SolidShapes::Instance) * instances.size());
+		memcpy(static_cast<uint8_t*>(allocation.cpuAddress) + offset, instances.data(), size);
+
+		RenderVertexBufferView vbViews[2] = {
+		  D3D12RenderCommandList::Wrap(solidMeshes_[shape].vbView), {}};
+		vbViews[1].address = allocation.gpuAddress + offset;
+		vbViews[1].size = size;
+		vbViews[1].stride = sizeof(SolidShapes::Instance);
+		commandList->SetVertexBuffers(0, _countof(vbViews), vbViews);
+		commandList->SetIndexBuffer(D3D12RenderCommandList::Wrap(solidMeshes_[shape].ibView));
+		commandList->DrawIndexedInstanced(
+		  solidMeshes_[shape].indexCount, static_cast<uint32_t>(instances.size()), 0, 0, 0);
+		drawCallCount_++;
+
+		solidCount_ += static_cast<uint32_t>(instances.size());
+		offset += size;
+		instances.clear();
+	}
+}
+
+void PrimitiveDrawer::Reset() {
+	lastLineCount_ = lineCount_;
+	lastSolidCount_ = solidCount_;
+	lastDrawCallCount_ = drawCallCount_;
+	lineCount_ = 0;
+	solidCount_ = 0;
+	drawCallCount_ = 0;
+	for (std::vector<SolidShapes::Instance>& instances : solidInstances_) {
+		instances.clear();
+	}
+	for (LinePageList& linePages : linePages_) {
+		linePages.Reset();
+	}
+
+	// 表示し終えた図形を詰めて、残りを次のフレームで描き直す
+	for (PersistentLines& persistent : persistentLines_) {
+		size_t readOffset = 0;
+		size_t writeOffset = 0;
+		size_t shapeCount = 0;
+		for (const auto& shape : persistent.shapes) {
+			size_t vertexCount = shape.first * kVertexCountLine;
+			if (0 < shape.second) {
+				std::copy_n(
+				  persistent.vertices.begin() + readOffset, vertexCount,
+				  persistent.vertices.begin() + writeOffset);
+				persistent.shapes[shapeCount++] = {shape.first, shape.second - 1};
+				writeOffset += vertexCount;
+			}
+			readOffset += vertexCount;
+		}
+		persistent.vertices.resize(writeOffset);
+		persistent.shapes.resize(shapeCount);
+		persistent.replayCount = writeOffset;
+	}
+}
+
+std::unique_ptr<PrimitiveDrawer::PipelineSet> PrimitiveDrawer::CreateGraphicsPipeline(
+  D3D12_PRIMITIVE_TOPOLOGY_TYPE topologyType, BlendMode blendMode, DepthMode depthMode) {
+	std::unique_ptr<PipelineSet> pipelineSet = std::make_unique<PipelineSet>();
+
+	HRESULT result;
+
+	// シェーダの読み込みとコンパイル
+	ShaderLibrary* shaderLibrary = ShaderLibrary::GetInstance();
+	D3D12_SHADER_BYTECODE vs = shaderLibrary->Load(L"Resources/shaders/PrimitiveVS.hlsl", "vs_5_0");
+	D3D12_SHADER_BYTECODE ps = shaderLibrary->Load(L"Resources/shaders/PrimitivePS.hlsl", "ps_5_0");
+
+	// 頂点レイアウト
+	D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
+	  {// xyz座標
+	   "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	  {// RGBA
+	   "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	};
+
+	// ルートパラメータ
+	CD3DX12_ROOT_PARAMETER rootparams[1];
+	rootparams[0].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_ALL); // ビュープロジェクション
+
+	// ルートシグネチャの設定
+	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	rootSignatureDesc.Init_1_0(
+	  _countof(rootparams), rootparams, 0, nullptr,
+	  D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+	ComPtr<ID3DBlob> rootSigBlob;
+	ComPtr<ID3DBlob> errorBlob;
+	// バージョン自動判定のシリアライズ
+	result = D3DX12SerializeVersionedRootSignature(
+	  &rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &rootSigBlob, &errorBlob);
+	assert(SUCCEEDED(result));
+	// ルートシグネチャの生成
+	pipelineSet->rootSignature =
+	  PipelineCache::GetInstance()->CreateRootSignature(rootSigBlob.Get());
+
+	// グラフィックスパイプラインの流れを設定
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC gpipeline{};
+	gpipeline.VS = vs;
+	gpipeline.PS = ps;
+
+	// サンプルマスク
+	gpipeline.SampleMask = D3D12_DEFAULT_SAMPLE_MASK; // 標準設定
+	// ラスタライザステート
+	gpipeline.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	gpipeline.RasterizerState.CullMode = D3D12_CULL_MODE_NONE; // 背面カリングをしない
+	// デプスステンシルステート
+	gpipeline.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+	if (depthMode == DepthMode::kOverlay) {
+		// 常に上書きし、深度は書き込まない
+		gpipeline.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_ALWAYS;
+		gpipeline.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+	}
+	gpipeline.DSVFormat = DXGI_FORMAT_D32_FLOAT; // 深度値フォーマット
+	// ブレンドステート
+	gpipeline.BlendState.RenderTarget[0] = CreateBlendDesc(blendMode);
+
+	gpipeline.InputLayout.pInputElementDescs = inputLayout;
+	gpipeline.InputLayout.NumElements = _countof(inputLayout);
+
+	gpipeline.PrimitiveTopologyType = topologyType;
+
+	gpipeline.NumRenderTargets = 1;                            // 描画対象は1つ
+	gpipeline.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; // 0～255指定のRGBA
+	gpipeline.SampleDesc.Count = 1; // 1ピクセルにつき1回サンプリング
+
+	gpipeline.pRootSignature = pipelineSet->rootSignature.Get();
+
+	pipelineSet->pipelineState = PipelineCache::GetInstance()->CreateGraphicsPipeline(gpipeline);
+
+	return pipelineSet;
+}
+
+void PrimitiveDrawer::CreateGraphicsPipelines() {
+	pipelineSetSolid_ = CreateSolidGraphicsPipeline();
+
+	// 深度の扱いとブレンドモードごとの線分用パイプライン
+	for (size_t depth = 0; depth < pipelineSetLines_.size(); depth++) {
+		for (size_t blend = 0; blend < pipelineSetLines_[depth].size(); blend++) {
+			pipelineSetLines_[depth][blend] = CreateGraphicsPipeline(
+			  D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE, static_cast<BlendMode>(blend),
+			  static_cast<DepthMode>(depth));
+		}
+	}
+}
+
+std::unique_ptr<PrimitiveDrawer::PipelineSet> PrimitiveDrawer::CreateSolidGraphicsPipeline() {
+	std::unique_ptr<PipelineSet> pipelineSet = std::make_unique<PipelineSet>();
+
+	HRESULT result;
+
+	// シェーダの読み込みとコンパイル
+	ShaderLibrary* shaderLibrary = ShaderLibrary::GetInstance();
+	D3D12_SHADER_BYTECODE vs = shaderLibrary->Load(L"Resources/shaders/ShapeVS.hlsl", "vs_5_0");
+	D3D12_SHADER_BYTECODE ps = shaderLibrary->Load(L"Resources/shaders/ShapePS.hlsl", "ps_5_0");
+
+	// 頂点レイアウト（スロット0が頂点ごと、スロット1がインスタンスごと）
+	D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
+	  {// xyz座標
+	   "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	  {// 法線
+	   "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	  {// ワールド行列の転置の上3行
+	   "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+	  {"WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+	  {"WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+	  {// 色
+	   "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 1, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+	};
+
+	// ルートパラメータ
+	CD3DX12_ROOT_PARAMETER rootparams[1];
+	rootparams[0].InitAsConstants(16, 0, 0, D3D12_SHADER_VISIBILITY_VERTEX); // ビュープロジェクション
+
+	// ルートシグネチャの設定
+	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	rootSignatureDesc.Init_1_0(
+	  _countof(rootparams), rootparams, 0, nullptr,
+	  D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+	ComPtr<ID3DBlob> rootSigBlob;
+	ComPtr<ID3DBlob> errorBlob;
+	// バージョン自動判定のシリアライズ
+	result = D3DX12SerializeVersionedRootSignature(
+	  &rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &rootSigBlob, &errorBlob);
+	assert(SUCCEEDED(result));
+	// ルートシグネチャの生成
+	pipelineSet->rootSignature =
+	  PipelineCache::GetInstance()->CreateRootSignature(rootSigBlob.Get());
+
+	// グラフィックスパイプラインの流れを設定
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC gpipeline{};
+	gpipeline.VS = vs;
+	gpipeline.PS = ps;
+
+	// サンプルマスク
+	gpipeline.SampleMask = D3D12_DEFAULT_SAMPLE_MASK; // 標準設定
+	// ラスタライザステート
+	gpipeline.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT); // 背面カリング
+	// デプスステンシルステート
+	gpipeline.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+	gpipeline.DSVFormat = DXGI_FORMAT_D32_FLOAT; // 深度値フォーマット
+	// ブレンドステート
+	gpipeline.BlendState.RenderTarget[0] = CreateBlendDesc(BlendMode::kBlendModeNormal);
+
+	gpipeline.InputLayout.pInputElementDescs = inputLayout;
+	gpipeline.InputLayout.NumElements = _countof(inputLayout);
+
+	gpipeline.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+
+	gpipeline.NumRenderTargets = 1;                            // 描画対象は1つ
+	gpipeline.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; // 0～255指定のRGBA
+	gpipeline.SampleDesc.Count = 1; // 1ピクセルにつき1回サンプリング
+
+	gpipeline.pRootSignature = pipelineSet->rootSignature.Get();
+
+	pipelineSet->pipelineState = PipelineCache::GetInstance()->CreateGraphicsPipeline(gpipeline);
+
+	return pipelineSet;
+}
+
+void PrimitiveDrawer::CreateSolidMeshes() {
+	HRESULT result;
+	std::vector<SolidShapes::Vertex> vertices;
+	std::vector<uint16_t> indices;
+
+	for (size_t shape = 0; shape < solidMeshes_.size(); shape++) {
+		SolidShapes::BuildMesh(static_cast<SolidShape>(shape), kSolidSegments, vertices, indices);
+		SolidMesh& mesh = solidMeshes_[shape];
+
+		// 頂点バッファ
+		UINT sizeVB = static_cast<UINT>(sizeof(SolidShapes::Vertex) * vertices.size());
+		mesh.vertBuff = CreateCommittedResource(sizeVB);
+		void* vertMap = nullptr;
+		result = mesh.vertBuff->Map(0, nullptr, &vertMap);
+		assert(SUCCEEDED(result));
+		memcpy(vertMap, vertices.data(), sizeVB);
+		mesh.vertBuff->Unmap(0, nullptr);
+
+		mesh.vbView.BufferLocation = mesh.vertBuff->GetGPUVirtualAddress();
+		mesh.vbView.SizeInBytes = sizeVB;
+		mesh.vbView.StrideInBytes = sizeof(SolidShapes::Vertex);
+
+		// インデックスバッファ
+		UINT sizeIB = static_cast<UINT>(sizeof(uint16_t) * indices.size());
+		mesh.indexBuff = CreateCommittedResource(sizeIB);
+		void* indexMap = nullptr;
+		result = mesh.indexBuff->Map(0, nullptr, &indexMap);
+		assert(SUCCEEDED(result));
+		memcpy(indexMap, indices.data(), sizeIB);
+		mesh.indexBuff->Unmap(0, nullptr);
+
+		mesh.ibView.BufferLocation = mesh.indexBuff->GetGPUVirtualAddress();
+		mesh.ibView.Format = DXGI_FORMAT_R16_UINT;
+		mesh.ibView.SizeInBytes = sizeIB;
+		mesh.indexCount = static_cast<UINT>(indices.size());
+	}
+}
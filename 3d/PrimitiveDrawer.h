@@ -1,4 +1,8 @@
 ﻿#pragma once
+#include "LinePageList.h"
+#include "Matrix4.h"
+#include "RenderCommandList.h"
+#include "SolidShapes.h"
 #include "Vector3.h"
 #include "Vector4.h"
 #include "ViewProjection.h"
@@ -8,12 +12,15 @@
 #include <wrl.h>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 // 基本プリミティブ描画
+// （線分はフレームごとの一時領域にページ単位で溜め、Flushでページごとに1回で描画する）
 class PrimitiveDrawer {
   public:
-	// 線分の最大数
-	static const UINT kMaxLineCount = 4096;
+	// 1ページの線分数（1回の描画で引く線分数）
+	static const UINT kLinesPerPage = 16384;
 	// 線分の頂点数
 	static const UINT kVertexCountLine = 2;
 	// 線分のインデックス数
@@ -32,6 +39,23 @@ class PrimitiveDrawer {
 		kCountOfBlendMode,
 	};
 
+	// 深度の扱い
+	enum class DepthMode {
+		kTested,  //!< 深度テストする（3Dオブジェクトに隠れる）
+		kOverlay, //!< 深度を無視して常に手前に描く
+
+		// 利用してはいけない
+		kCountOfDepthMode,
+	};
+
+	// 図形の既定の円分割数
+	static const uint32_t kDefaultSegments = 32;
+	// 塗りつぶし図形の円分割数
+	static const uint32_t kSolidSegments = 24;
+
+	// 塗りつぶし図形の種類
+	using SolidShape = SolidShapes::Shape;
+
 	// 頂点データ構造体
 	struct VertexPosColor {
 		Vector3 pos;   // xyz座標
@@ -97,10 +121,172 @@ class PrimitiveDrawer {
 	void DrawLine3d(const Vector3& p1, const Vector3& p2, const Vector4& color);
 
 	/// <summary>
-	/// リセット
+	/// 3D線分をまとめて追加
+	/// </summary>
+	/// <param name="vertices">始点、終点の順に並んだ頂点の配列</param>
+	/// <param name="lineCount">線分数</param>
+	/// <param name="depthMode">深度の扱い</param>
+	void DrawLines(
+	  const VertexPosColor* vertices, size_t lineCount, DepthMode depthMode = DepthMode::kTested);
+
+	/// <summary>
+	/// 同じ色の3D線分をまとめて追加
+	/// </summary>
+	/// <param name="points">始点、終点の順に並んだ座標の配列</param>
+	/// <param name="lineCount">線分数</param>
+	/// <param name="color">色(RGBA)</param>
+	/// <param name="depthMode">深度の扱い</param>
+	/// <param name="lifetime">表示し続けるフレーム数</param>
+	void DrawLines(
+	  const Vector3* points, size_t lineCount, const Vector4& color,
+	  DepthMode depthMode = DepthMode::kTested, uint32_t lifetime = 1);
+
+	/// <summary>
+	/// 軸に平行な箱の描画
+	/// </summary>
+	void DrawBox(
+	  const Vector3& min, const Vector3& max, const Vector4& color,
+	  DepthMode depthMode = DepthMode::kTested, uint32_t lifetime = 1);
+
+	/// <summary>
+	/// 向きのある箱の描画
+	/// </summary>
+	/// <param name="center">中心</param>
+	/// <param name="axes">各辺の向き（単位ベクトル3つ）</param>
+	/// <param name="halfExtents">各辺の長さの半分</param>
+	void DrawOrientedBox(
+	  const Vector3& center, const Vector3 axes[3], const Vector3& halfExtents,
+	  const Vector4& color, DepthMode depthMode = DepthMode::kTested, uint32_t lifetime = 1);
+
+	/// <summary>
+	/// 球の描画
+	/// </summary>
+	void DrawSphere(
+	  const Vector3& center, float radius, const Vector4& color,
+	  DepthMode depthMode = DepthMode::kTested, uint32_t lifetime = 1,
+	  uint32_t segments = kDefaultSegments);
+
+	/// <summary>
+	/// カプセルの描画
+	/// </summary>
+	void DrawCapsule(
+	  const Vector3& p0, const Vector3& p1, float radius, const Vector4& color,
+	  DepthMode depthMode = DepthMode::kTested, uint32_t lifetime = 1,
+	  uint32_t segments = kDefaultSegments);
+
+	/// <summary>
+	/// 円錐の描画
+	/// </summary>
+	/// <param name="apex">頂点</param>
+	/// <param name="direction">頂点から底面への向き</param>
+	/// <param name="height">高さ</param>
+	/// <param name="angle">半頂角（ラジアン）</param>
+	void DrawCone(
+	  const Vector3& apex, const Vector3& direction, float height, float angle,
+	  const Vector4& color, DepthMode depthMode = DepthMode::kTested, uint32_t lifetime = 1,
+	  uint32_t segments = kDefaultSegments);
+
+	/// <summary>
+	/// XZ平面のグリッドの描画
+	/// </summary>
+	void DrawGrid(
+	  const Vector3& center, float size, uint32_t divisions, const Vector4& color,
+	  DepthMode depthMode = DepthMode::kTested, uint32_t lifetime = 1);
+
+	/// <summary>
+	/// ビュープロジェクションの視錐台の描画
+	/// </summary>
+	void DrawFrustum(
+	  const ViewProjection& viewProjection, const Vector4& color,
+	  DepthMode depthMode = DepthMode::kTested, uint32_t lifetime = 1);
+
+	/// <summary>
+	/// 座標軸の描画（X赤、Y緑、Z青）
+	/// </summary>
+	/// <param name="matWorld">ワールド行列</param>
+	/// <param name="length">長さ</param>
+	void DrawAxis(
+	  const Matrix4& matWorld, float length, DepthMode depthMode = DepthMode::kOverlay,
+	  uint32_t lifetime = 1);
+
+	/// <summary>
+	/// 矢印の描画
+	/// </summary>
+	void DrawArrow(
+	  const Vector3& from, const Vector3& to, float headSize, const Vector4& color,
+	  DepthMode depthMode = DepthMode::kTested, uint32_t lifetime = 1);
+
+	/// <summary>
+	/// 塗りつぶした単位図形の描画（インスタンスを1つ追加するだけで、図形の種類ごとに1回で描画する）
+	/// </summary>
+	/// <param name="shape">図形の種類</param>
+	/// <param name="matWorld">ワールド行列</param>
+	/// <param name="color">色(RGBA)</param>
+	void DrawSolid(SolidShape shape, const Matrix4& matWorld, const Vector4& color);
+
+	/// <summary>
+	/// 塗りつぶした軸に平行な箱の描画
+	/// </summary>
+	void DrawSolidBox(const Vector3& center, const Vector3& halfExtents, const Vector4& color);
+
+	/// <summary>
+	/// 塗りつぶした球の描画
+	/// </summary>
+	void DrawSolidSphere(const Vector3& center, float radius, const Vector4& color);
+
+	/// <summary>
+	/// 塗りつぶした2点を結ぶ円柱の描画
+	/// </summary>
+	void DrawSolidCylinder(
+	  const Vector3& p0, const Vector3& p1, float radius, const Vector4& color);
+
+	/// <summary>
+	/// 表示し続けている図形の消去
+	/// </summary>
+	void ClearPersistent();
+
+	/// <summary>
+	/// 線分の書き込み先を確保（ページをまたがないので要求より少ないことがある）
+	/// </summary>
+	/// <param name="lineCount">欲しい線分数</param>
+	/// <param name="allocatedCount">確保できた線分数</param>
+	/// <param name="depthMode">深度の扱い</param>
+	/// <returns>始点、終点の順に書き込む頂点の配列</returns>
+	VertexPosColor* AllocateLines(
+	  size_t lineCount, size_t& allocatedCount, DepthMode depthMode = DepthMode::kTested);
+
+	/// <summary>
+	/// 溜まった線分の描画
+	/// </summary>
+	/// <param name="commandList">描画コマンドリスト</param>
+	void Flush(ID3D12GraphicsCommandList* commandList);
+
+	/// <summary>
+	/// 溜まった線分の描画（描画コマンドの発行先版。記録用のバックエンドにも描ける）
+	/// </summary>
+	/// <param name="commandList">描画コマンドの発行先</param>
+	void Flush(RenderCommandList* commandList);
+
+	/// <summary>
+	/// リセット（描画されていない線分は捨てる）
 	/// </summary>
 	void Reset();
 
+	/// <summary>
+	/// 直前のリセットまでに描画した線分数
+	/// </summary>
+	uint32_t GetLineCount() const { return lastLineCount_; }
+
+	/// <summary>
+	/// 直前のリセットまでに描画した塗りつぶし図形の数
+	/// </summary>
+	uint32_t GetSolidCount() const { return lastSolidCount_; }
+
+	/// <summary>
+	/// 直前のリセットまでの描画回数
+	/// </summary>
+	uint32_t GetDrawCallCount() const { return lastDrawCallCount_; }
+
 	/// <summary>
 	/// ビュープロジェクションのセット
 	/// </summary>
@@ -108,6 +294,30 @@ class PrimitiveDrawer {
 	void SetViewProjection(const ViewProjection* viewProjection) { viewProjection_ = viewProjection; }
 
   private:
+	// 塗りつぶし図形のメッシュ
+	struct SolidMesh {
+		// 頂点バッファ
+		Microsoft::WRL::ComPtr<ID3D12Resource> vertBuff;
+		// インデックスバッファ
+		Microsoft::WRL::ComPtr<ID3D12Resource> indexBuff;
+		// 頂点バッファビュー
+		D3D12_VERTEX_BUFFER_VIEW vbView{};
+		// インデックスバッファビュー
+		D3D12_INDEX_BUFFER_VIEW ibView{};
+		// インデックス数
+		UINT indexCount = 0;
+	};
+
+	// 複数フレーム表示し続ける線分
+	struct PersistentLines {
+		// 頂点
+		std::vector<VertexPosColor> vertices;
+		// 図形ごとの線分数と残りフレーム数
+		std::vector<std::pair<uint32_t, uint32_t>> shapes;
+		// 次のFlushで描き直す頂点数
+		size_t replayCount = 0;
+	};
+
 	PrimitiveDrawer() = default;
 	~PrimitiveDrawer() = default;
 	PrimitiveDrawer(const PrimitiveDrawer&) = delete;
@@ -116,27 +326,62 @@ class PrimitiveDrawer {
 	/// <summary>
 	/// グラフィックパイプライン生成
 	/// </summary>
-	std::unique_ptr<PipelineSet>
-	  CreateGraphicsPipeline(D3D12_PRIMITIVE_TOPOLOGY_TYPE topologyType, BlendMode blendMode);
+	std::unique_ptr<PipelineSet> CreateGraphicsPipeline(
+	  D3D12_PRIMITIVE_TOPOLOGY_TYPE topologyType, BlendMode blendMode, DepthMode depthMode);
 
 	/// <summary>
-	/// グラフィックパイプライン生成
+	/// 塗りつぶし図形用のグラフィックパイプライン生成
 	/// </summary>
-	void CreateGraphicsPipelines();
+	std::unique_ptr<PipelineSet> CreateSolidGraphicsPipeline();
 
 	/// <summary>
-	/// 各種メッシュ生成
+	/// 塗りつぶし図形のメッシュ生成
 	/// </summary>
-	void CreateMeshes();
+	void CreateSolidMeshes();
 
-	// 線分
-	std::unique_ptr<Mesh> line_;
-	// 線分の使用インデックス
-	uint32_t indexLine_ = 0;
+	/// <summary>
+	/// 溜まった塗りつぶし図形の描画
+	/// </summary>
+	void FlushSolids(RenderCommandList* commandList);
+
+	/// <summary>
+	/// 生成した図形の線分を追加
+	/// </summary>
+	void SubmitShape(uint32_t lineCount, const Vector4& color, DepthMode depthMode, uint32_t lifetime);
+
+	/// <summary>
+	/// グラフィックパイプライン生成
+	/// </summary>
+	void CreateGraphicsPipelines();
+
+	// 深度の扱いごとの線分のページ（フレームアップロードアロケータから確保）
+	std::array<LinePageList, size_t(DepthMode::kCountOfDepthMode)> linePages_;
+	// Flushで描くページの作業領域
+	std::vector<LinePageList::Page> undrawnPages_;
+	// 深度の扱いごとの表示し続ける線分
+	std::array<PersistentLines, size_t(DepthMode::kCountOfDepthMode)> persistentLines_;
+	// 図形生成の作業領域
+	std::vector<Vector3> shapePoints_;
+	// 塗りつぶし図形の種類ごとのメッシュとインスタンス
+	std::array<SolidMesh, size_t(SolidShape::kCountOfShape)> solidMeshes_;
+	std::array<std::vector<SolidShapes::Instance>, size_t(SolidShape::kCountOfShape)>
+	  solidInstances_;
+	// 統計
+	uint32_t lineCount_ = 0;
+	uint32_t drawCallCount_ = 0;
+	uint32_t solidCount_ = 0;
+	uint32_t lastLineCount_ = 0;
+	uint32_t lastSolidCount_ = 0;
+	uint32_t lastDrawCallCount_ = 0;
 	// 参照するビュープロジェクション
 	const ViewProjection* viewProjection_ = nullptr;
 	// ブレンドモード
 	BlendMode blendMode_ = BlendMode::kBlendModeNormal;
-	// パイプラインセット
-	std::array<std::unique_ptr<PipelineSet>, (uint16_t)BlendMode::kCountOfBlendMode> pipelineSetLines_;
+	// パイプラインセット（深度の扱い × ブレンドモード）
+	std::array<
+	  std::array<std::unique_ptr<PipelineSet>, (uint16_t)BlendMode::kCountOfBlendMode>,
+	  (uint16_t)DepthMode::kCountOfDepthMode>
+	  pipelineSetLines_;
+	// 塗りつぶし図形のパイプラインセット
+	std::unique_ptr<PipelineSet> pipelineSetSolid_;
 };
@@ -0,0 +1,168 @@
+﻿#include "ShadowCascades.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+using namespace MathUtility;
+
+const uint32_t ShadowCascades::kMaxCascadeCount;
+
+namespace {
+// ビュー空間の点をワールド座標に（ビュー行列は回転と平行移動のみ）
+Vector3 ViewToWorld(const Matrix4& matView, float x, float y, float z) {
+	const float(*m)[4] = matView.m;
+	// ビュー行列の各列がカメラの軸、4行目が視点を軸に投影した値の符号反転
+	Vector3 axisX(m[0][0], m[1][0], m[2][0]);
+	Vector3 axisY(m[0][1], m[1][1], m[2][1]);
+	Vector3 axisZ(m[0][2], m[1][2], m[2][2]);
+	Vector3 eye = -(axisX * m[3][0] + axisY * m[3][1] + axisZ * m[3][2]);
+	return eye + axisX * x + axisY * y + axisZ * z;
+}
+
+// 値をグリッドに合わせる
+float SnapDown(float value, float grid) { return std::floor(value / grid) * grid; }
+float SnapUp(float value, float grid) { return std::ceil(value / grid) * grid; }
+} // namespace
+
+void ShadowCascades::ComputeSplits(
+  float nearZ, float farZ, uint32_t count, float lambda, float* splits) {
+	assert(0.0f < nearZ && nearZ < farZ && 0 < count);
+	splits[0] = nearZ;
+	for (uint32_t i = 1; i < count; i++) {
+		float ratio = static_cast<float>(i) / count;
+		float logSplit = nearZ * std::pow(farZ / nearZ, ratio);
+		float uniformSplit = nearZ + (farZ - nearZ) * ratio;
+		splits[i] = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+	}
+	splits[count] = farZ;
+}
+
+void ShadowCascades::Initialize(const Settings& settings) {
+	assert(0 < settings.cascadeCount && settings.cascadeCount <= kMaxCascadeCount);
+	assert(0 < settings.resolution);
+	settings_ = settings;
+	for (std::vector<uint32_t>& casters : casters_) {
+		casters.clear();
+	}
+}
+
+void ShadowCascades::Update(
+  const Camera& camera, const Vector3& lightDir, const Vector3& sceneMin, const Vector3& sceneMax) {
+	// 光源のビュー行列（原点から光線方向を見る。平行移動は正射影の範囲で表す）
+	Vector3 dir = lightDir;
+	Vector3Normalize(dir);
+	Vector3 up = std::fabs(dir.y) < 0.99f ? Vector3(0.0f, 1.0f, 0.0f) : Vector3(1.0f, 0.0f, 0.0f);
+	Matrix4 matLightView = Matrix4LookAtLH(Vector3Zero(), dir, up);
+
+	// シーンの範囲のうち最も光源寄りの奥行き（これより手前の投影物はない）
+	float sceneNearZ = FLT_MAX;
+	for (int i = 0; i < 8; i++) {
+		Vector3 corner(
+		  (i & 1) ? sceneMax.x : sceneMin.x, (i & 2) ? sceneMax.y : sceneMin.y,
+		  (i & 4) ? sceneMax.z : sceneMin.z);
+		sceneNearZ = (std::min)(sceneNearZ, Vector3Transform(corner, matLightView).z);
+	}
+
+	float splits[kMaxCascadeCount + 1];
+	float farZ = (std::min)(camera.farZ, settings_.maxDistance);
+	ComputeSplits(camera.nearZ, farZ, settings_.cascadeCount, settings_.splitLambda, splits);
+
+	float tanHalfY = std::tan(camera.fovAngleY * 0.5f);
+	float tanHalfX = tanHalfY * camera.aspectRatio;
+	for (uint32_t c = 0; c < settings_.cascadeCount; c++) {
+		Cascade& cascade = cascades_[c];
+		cascade.matView = matLightView;
+		cascade.splitNear = splits[c];
+		cascade.splitFar = splits[c + 1];
+
+		// 分割した視錐台の8頂点（ワールド座標）
+		Vector3 corners[8];
+		for (int i = 0; i < 8; i++) {
+			float z = (i & 4) ? cascade.splitFar : cascade.splitNear;
+			float x = ((i & 1) ? tanHalfX : -tanHalfX) * z;
+			float y = ((i & 2) ? tanHalfY : -tanHalfY) * z;
+			corners[i] = ViewToWorld(camera.matView, x, y, z);
+		}
+		FitCascade(camera, corners, sceneNearZ, cascade);
+	}
+}
+
+void ShadowCascades::FitCascade(
+  const Camera& camera, const Vector3 corners[8], float sceneNearZ, Cascade& cascade) const {
+	const float resolution = static_cast<float>(settings_.resolution);
+
+	// 奥行きは分割の頂点の範囲を、光源側だけシーンの端まで延ばす
+	float minZ = FLT_MAX;
+	float maxZ = -FLT_MAX;
+	for (int i = 0; i < 8; i++) {
+		float z = Vector3Transform(corners[i], cascade.matView).z;
+		minZ = (std::min)(minZ, z);
+		maxZ = (std::max)(maxZ, z);
+	}
+	cascade.nearZ = (std::min)(minZ, sceneNearZ);
+	cascade.farZ = maxZ;
+
+	if (settings_.stabilize) {
+		// 分割の境界球（カメラの向きに依らない大きさ）
+		float n = cascade.splitNear;
+		float f = cascade.splitFar;
+		float tanHalfY = std::tan(camera.fovAngleY * 0.5f);
+		float k2 = tanHalfY * tanHalfY * (1.0f + camera.aspectRatio * camera.aspectRatio);
+		float centerZ = (std::min)((n + f) * 0.5f * (1.0f + k2), f);
+		float radius = std::sqrt((f - centerZ) * (f - centerZ) + f * f * k2);
+		Vector3 center = Vector3Transform(ViewToWorld(camera.matView, 0.0f, 0.0f, centerZ), cascade.matView);
+
+		// 中心をテクセル単位に揃えて、カメラの移動で影の縁がちらつかないようにする
+		cascade.texelSize = radius * 2.0f / resolution;
+		float x = SnapDown(center.x, cascade.texelSize);
+		float y = SnapDown(center.y, cascade.texelSize);
+		cascade.left = x - radius;
+		cascade.right = x + radius;
+		cascade.bottom = y - radius;
+		cascade.top = y + radius;
+	} else {
+		// 分割の頂点を囲む箱（小さいが、カメラの回転で大きさが変わる）
+		float minX = FLT_MAX, maxX = -FLT_MAX;
+		float minY = FLT_MAX, maxY = -FLT_MAX;
+		for (int i = 0; i < 8; i++) {
+			Vector3 p = Vector3Transform(corners[i], cascade.matView);
+			minX = (std::min)(minX, p.x);
+			maxX = (std::max)(maxX, p.x);
+			minY = (std::min)(minY, p.y);
+			maxY = (std::max)(maxY, p.y);
+		}
+		// 縦横で同じテクセルの大きさにしてから端をテクセル単位に揃える
+		cascade.texelSize = (std::max)(maxX - minX, maxY - minY) / resolution;
+		cascade.left = SnapDown(minX, cascade.texelSize);
+		cascade.right = SnapUp(maxX, cascade.texelSize);
+		cascade.bottom = SnapDown(minY, cascade.texelSize);
+		cascade.top = SnapUp(maxY, cascade.texelSize);
+	}
+
+	cascade.matProjection = Matrix4Orthographic(
+	  cascade.left, cascade.right, cascade.bottom, cascade.top, cascade.nearZ, cascade.farZ);
+	cascade.matViewProjection = cascade.matView * cascade.matProjection;
+}
+
+void ShadowCascades::CullCasters(const Sphere* casters, uint32_t count) {
+	for (uint32_t c = 0; c < settings_.cascadeCount; c++) {
+		casters_[c].clear();
+	}
+
+	// 光源のビュー行列は全分割共通なので、変換は投影物ごとに1回で済む
+	const Matrix4& matLightView = cascades_[0].matView;
+	for (uint32_t i = 0; i < count; i++) {
+		Vector3 center = Vector3Transform(casters[i].center, matLightView);
+		float radius = casters[i].radius;
+		for (uint32_t c = 0; c < settings_.cascadeCount; c++) {
+			const Cascade& cascade = cascades_[c];
+			if (center.x + radius < cascade.left || cascade.right < center.x - radius ||
+			    center.y + radius < cascade.bottom || cascade.top < center.y - radius ||
+			    center.z + radius < cascade.nearZ || cascade.farZ < center.z - radius) {
+				continue;
+			}
+			casters_[c].push_back(i);
+		}
+	}
+}
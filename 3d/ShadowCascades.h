@@ -0,0 +1,120 @@
+﻿#pragma once
+
+#include "MathUtility.h"
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// カスケードシャドウマップの計算
+/// （カメラの視錐台を奥行きで分割し、分割ごとに平行光源から見た正射影を当てはめ、投影物を振り分ける）
+/// （D3Dに依存しないので単体で検証できる）
+/// </summary>
+class ShadowCascades {
+  public:
+	// 最大分割数
+	static const uint32_t kMaxCascadeCount = 4;
+
+	/// <summary>
+	/// 分割設定
+	/// </summary>
+	struct Settings {
+		uint32_t cascadeCount = 4;   // 分割数
+		uint32_t resolution = 2048;  // シャドウマップの解像度
+		float splitLambda = 0.75f;   // 分割の対数寄りの度合い（0で等間隔、1で対数）
+		float maxDistance = 200.0f;  // 影を落とす最大距離（カメラの奥側の限界と小さい方を使う）
+		bool stabilize = true;       // 境界球で当てはめて回転によるちらつきを抑える（falseなら箱でぴったり当てはめる）
+	};
+
+	/// <summary>
+	/// カメラ（左手系、行ベクトル形式で拡大縮小を含まないビュー行列）
+	/// </summary>
+	struct Camera {
+		Matrix4 matView;
+		float fovAngleY;
+		float aspectRatio;
+		float nearZ;
+		float farZ;
+	};
+
+	/// <summary>
+	/// 分割ごとの結果
+	/// </summary>
+	struct Cascade {
+		// 光源のビュー行列（回転のみで全分割共通）
+		Matrix4 matView;
+		// 正射影行列
+		Matrix4 matProjection;
+		// ビュー行列と正射影行列の積
+		Matrix4 matViewProjection;
+		// カメラから見た奥行きの範囲
+		float splitNear;
+		float splitFar;
+		// 光源空間での範囲
+		float left, right, bottom, top, nearZ, farZ;
+		// 1テクセルの大きさ（ワールド単位）
+		float texelSize;
+	};
+
+	/// <summary>
+	/// 境界球
+	/// </summary>
+	struct Sphere {
+		Vector3 center;
+		float radius;
+	};
+
+	/// <summary>
+	/// 分割位置を求める（対数分割と等間隔分割の混合）
+	/// </summary>
+	/// <param name="nearZ">手前</param>
+	/// <param name="farZ">奥</param>
+	/// <param name="count">分割数</param>
+	/// <param name="lambda">対数寄りの度合い</param>
+	/// <param name="splits">分割位置（count + 1個。先頭がnearZ、末尾がfarZ）</param>
+	static void ComputeSplits(float nearZ, float farZ, uint32_t count, float lambda, float* splits);
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	void Initialize(const Settings& settings);
+
+	/// <summary>
+	/// 分割ごとの正射影を求める
+	/// </summary>
+	/// <param name="camera">カメラ</param>
+	/// <param name="lightDir">光線方向</param>
+	/// <param name="sceneMin">投影物を含むシーンの範囲（光源側に延ばす奥行きに使う）</param>
+	/// <param name="sceneMax">投影物を含むシーンの範囲</param>
+	void Update(
+	  const Camera& camera, const Vector3& lightDir, const Vector3& sceneMin, const Vector3& sceneMax);
+
+	/// <summary>
+	/// 投影物を分割ごとに振り分ける
+	/// </summary>
+	/// <param name="casters">投影物の境界球（ワールド座標）</param>
+	/// <param name="count">投影物の数</param>
+	void CullCasters(const Sphere* casters, uint32_t count);
+
+	const Settings& GetSettings() const { return settings_; }
+	uint32_t GetCascadeCount() const { return settings_.cascadeCount; }
+	const Cascade& GetCascade(uint32_t index) const { return cascades_[index]; }
+
+	/// <summary>
+	/// 分割に入った投影物の番号（CullCastersに渡した配列の添え字）
+	/// </summary>
+	const std::vector<uint32_t>& GetCasters(uint32_t index) const { return casters_[index]; }
+
+  private:
+	/// <summary>
+	/// 分割の範囲を当てはめる
+	/// </summary>
+	void FitCascade(
+	  const Camera& camera, const Vector3 corners[8], float sceneNearZ, Cascade& cascade) const;
+
+	// 分割設定
+	Settings settings_;
+	// 分割ごとの結果
+	Cascade cascades_[kMaxCascadeCount] = {};
+	// 分割ごとの投影物の番号
+	std::vector<uint32_t> casters_[kMaxCascadeCount];
+};
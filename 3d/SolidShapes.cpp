@@ -0,0 +1,240 @@
+﻿#include "SolidShapes.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+const float kPi = 3.14159265358979f;
+
+// 0～1を0～255に
+uint32_t ToByte(float value) {
+	return static_cast<uint32_t>((std::min)((std::max)(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+// 頂点の追加
+void PushVertex(
+  std::vector<SolidShapes::Vertex>& vertices, float x, float y, float z, float nx, float ny,
+  float nz) {
+	vertices.push_back({{x, y, z}, {nx, ny, nz}});
+}
+
+// 四角形（時計回りが表）のインデックスの追加
+void PushQuad(std::vector<uint16_t>& indices, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+	const uint16_t quad[] = {
+	  static_cast<uint16_t>(a), static_cast<uint16_t>(b), static_cast<uint16_t>(c),
+	  static_cast<uint16_t>(c), static_cast<uint16_t>(b), static_cast<uint16_t>(d)};
+	indices.insert(indices.end(), quad, quad + 6);
+}
+
+// 立方体（面ごとに法線を分けるので24頂点）
+void BuildCube(std::vector<SolidShapes::Vertex>& vertices, std::vector<uint16_t>& indices) {
+	// 各面の法線と、面内の2軸（u × v = 法線の向きから見て時計回りになる並び）
+	const float faces[6][3][3] = {
+	  {{1, 0, 0}, {0, 0, 1}, {0, 1, 0}},   {{-1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+	  {{0, 1, 0}, {1, 0, 0}, {0, 0, 1}},   {{0, -1, 0}, {1, 0, 0}, {0, 0, -1}},
+	  {{0, 0, 1}, {-1, 0, 0}, {0, 1, 0}},  {{0, 0, -1}, {1, 0, 0}, {0, 1, 0}},
+	};
+	for (const auto& face : faces) {
+		const float* n = face[0];
+		const float* u = face[1];
+		const float* v = face[2];
+		uint32_t base = static_cast<uint32_t>(vertices.size());
+		for (int corner = 0; corner < 4; corner++) {
+			// 左下、左上、右下、右上
+			float su = (corner & 2) ? 1.0f : -1.0f;
+			float sv = (corner & 1) ? 1.0f : -1.0f;
+			PushVertex(
+			  vertices, n[0] + u[0] * su + v[0] * sv, n[1] + u[1] * su + v[1] * sv,
+			  n[2] + u[2] * su + v[2] * sv, n[0], n[1], n[2]);
+		}
+		PushQuad(indices, base, base + 1, base + 2, base + 3);
+	}
+}
+
+// 球（緯度経度分割）
+void BuildSphere(
+  uint32_t segments, std::vector<SolidShapes::Vertex>& vertices, std::vector<uint16_t>& indices) {
+	const uint32_t rings = segments / 2;
+	for (uint32_t ring = 0; ring <= rings; ring++) {
+		float theta = kPi * ring / rings;
+		float y = std::cos(theta);
+		float r = std::sin(theta);
+		for (uint32_t segment = 0; segment <= segments; segment++) {
+			float phi = 2.0f * kPi * segment / segments;
+			float x = r * std::cos(phi);
+			float z = r * std::sin(phi);
+			PushVertex(vertices, x, y, z, x, y, z);
+		}
+	}
+	const uint32_t stride = segments + 1;
+	for (uint32_t ring = 0; ring < rings; ring++) {
+		for (uint32_t segment = 0; segment < segments; segment++) {
+			uint32_t top = ring * stride + segment;
+			uint32_t bottom = top + stride;
+			PushQuad(indices, bottom, top, bottom + 1, top + 1);
+		}
+	}
+}
+
+// 円柱（側面と上下の蓋で法線を分ける）
+void BuildCylinder(
+  uint32_t segments, std::vector<SolidShapes::Vertex>& vertices, std::vector<uint16_t>& indices) {
+	// 側面
+	uint32_t sideBase = static_cast<uint32_t>(vertices.size());
+	for (uint32_t segment = 0; segment <= segments; segment++) {
+		float phi = 2.0f * kPi * segment / segments;
+		float x = std::cos(phi);
+		float z = std::sin(phi);
+		PushVertex(vertices, x, -1.0f, z, x, 0.0f, z);
+		PushVertex(vertices, x, 1.0f, z, x, 0.0f, z);
+	}
+	for (uint32_t segment = 0; segment < segments; segment++) {
+		uint32_t i = sideBase + segment * 2;
+		PushQuad(indices, i, i + 1, i + 2, i + 3);
+	}
+
+	// 上下の蓋（中心から扇状に）
+	for (int cap = 0; cap < 2; cap++) {
+		float y = cap == 0 ? 1.0f : -1.0f;
+		uint32_t center = static_cast<uint32_t>(vertices.size());
+		PushVertex(vertices, 0.0f, y, 0.0f, 0.0f, y, 0.0f);
+		for (uint32_t segment = 0; segment <= segments; segment++) {
+			float phi = 2.0f * kPi * segment / segments;
+			PushVertex(vertices, std::cos(phi), y, std::sin(phi), 0.0f, y, 0.0f);
+		}
+		for (uint32_t segment = 0; segment < segments; segment++) {
+			uint32_t a = center + 1 + segment;
+			uint32_t b = a + 1;
+			// 上は上から、下は下から見て時計回り
+			const uint16_t triangle[] = {
+			  static_cast<uint16_t>(center), static_cast<uint16_t>(cap == 0 ? b : a),
+			  static_cast<uint16_t>(cap == 0 ? a : b)};
+			indices.insert(indices.end(), triangle, triangle + 3);
+		}
+	}
+}
+
+// 外積
+void Cross(const float a[3], const float b[3], float out[3]) {
+	out[0] = a[1] * b[2] - a[2] * b[1];
+	out[1] = a[2] * b[0] - a[0] * b[2];
+	out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// 内積
+float Dot(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+// 列ベクトル（各軸と平行移動）から詰める
+void PackAxes(
+  const float x[3], const float y[3], const float z[3], const float t[3], uint32_t color,
+  SolidShapes::Instance& instance) {
+	for (int i = 0; i < 3; i++) {
+		instance.rows[i][0] = x[i];
+		instance.rows[i][1] = y[i];
+		instance.rows[i][2] = z[i];
+		instance.rows[i][3] = t[i];
+	}
+	instance.color = color;
+}
+} // namespace
+
+void SolidShapes::BuildMesh(
+  Shape shape, uint32_t segments, std::vector<Vertex>& vertices, std::vector<uint16_t>& indices) {
+	assert(3 <= segments && segments % 2 == 0);
+	vertices.clear();
+	indices.clear();
+
+	switch (shape) {
+	case Shape::kCube:
+		BuildCube(vertices, indices);
+		break;
+	case Shape::kSphere:
+		BuildSphere(segments, vertices, indices);
+		break;
+	case Shape::kCylinder:
+		BuildCylinder(segments, vertices, indices);
+		break;
+	default:
+		assert(false);
+		break;
+	}
+	assert(vertices.size() <= 65536);
+}
+
+uint32_t SolidShapes::PackColor(float r, float g, float b, float a) {
+	return ToByte(r) | (ToByte(g) << 8) | (ToByte(b) << 16) | (ToByte(a) << 24);
+}
+
+void SolidShapes::PackMatrix(const float matWorld[4][4], uint32_t color, Instance& instance) {
+	PackAxes(matWorld[0], matWorld[1], matWorld[2], matWorld[3], color, instance);
+}
+
+void SolidShapes::PackBox(
+  const float center[3], const float halfExtents[3], uint32_t color, Instance& instance) {
+	const float x[3] = {halfExtents[0], 0.0f, 0.0f};
+	const float y[3] = {0.0f, halfExtents[1], 0.0f};
+	const float z[3] = {0.0f, 0.0f, halfExtents[2]};
+	PackAxes(x, y, z, center, color, instance);
+}
+
+void SolidShapes::PackSphere(const float center[3], float radius, uint32_t color, Instance& instance) {
+	const float x[3] = {radius, 0.0f, 0.0f};
+	const float y[3] = {0.0f, radius, 0.0f};
+	const float z[3] = {0.0f, 0.0f, radius};
+	PackAxes(x, y, z, center, color, instance);
+}
+
+void SolidShapes::PackCylinder(
+  const float p0[3], const float p1[3], float radius, uint32_t color, Instance& instance) {
+	// 円柱のYを2点を結ぶ軸の半分に合わせる
+	const float center[3] = {
+	  (p0[0] + p1[0]) * 0.5f, (p0[1] + p1[1]) * 0.5f, (p0[2] + p1[2]) * 0.5f};
+	const float y[3] = {(p1[0] - p0[0]) * 0.5f, (p1[1] - p0[1]) * 0.5f, (p1[2] - p0[2]) * 0.5f};
+	float length = std::sqrt(y[0] * y[0] + y[1] * y[1] + y[2] * y[2]);
+	float n[3] = {0.0f, 1.0f, 0.0f};
+	if (0.0f < length) {
+		n[0] = y[0] / length;
+		n[1] = y[1] / length;
+		n[2] = y[2] / length;
+	}
+
+	// 軸に直交する2軸
+	const float reference[3] = {
+	  std::fabs(n[0]) < 0.9f ? 1.0f : 0.0f, std::fabs(n[0]) < 0.9f ? 0.0f : 1.0f, 0.0f};
+	float x[3] = {
+	  n[1] * reference[2] - n[2] * reference[1], n[2] * reference[0] - n[0] * reference[2],
+	  n[0] * reference[1] - n[1] * reference[0]};
+	float xLength = std::sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+	float z[3] = {
+	  n[1] * x[2] - n[2] * x[1], n[2] * x[0] - n[0] * x[2], n[0] * x[1] - n[1] * x[0]};
+	for (int i = 0; i < 3; i++) {
+		x[i] *= radius / xLength;
+		z[i] *= radius / xLength;
+	}
+	PackAxes(x, y, z, center, color, instance);
+}
+
+void SolidShapes::TransformPosition(const Instance& instance, const float pos[3], float out[3]) {
+	for (int i = 0; i < 3; i++) {
+		out[i] = Dot(instance.rows[i], pos) + instance.rows[i][3];
+	}
+}
+
+void SolidShapes::TransformNormal(const Instance& instance, const float normal[3], float out[3]) {
+	// 上3x3の余因子行列（逆転置行列の行列式倍）
+	float cofactors[3][3];
+	Cross(instance.rows[1], instance.rows[2], cofactors[0]);
+	Cross(instance.rows[2], instance.rows[0], cofactors[1]);
+	Cross(instance.rows[0], instance.rows[1], cofactors[2]);
+	float determinant = Dot(instance.rows[0], cofactors[0]);
+
+	float transformed[3];
+	for (int i = 0; i < 3; i++) {
+		transformed[i] = Dot(cofactors[i], normal);
+	}
+	float length = std::sqrt(Dot(transformed, transformed));
+	float scale = (determinant < 0.0f ? -1.0f : 1.0f) / length;
+	for (int i = 0; i < 3; i++) {
+		out[i] = transformed[i] * scale;
+	}
+}
@@ -0,0 +1,97 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// インスタンス描画する塗りつぶし図形のメッシュ生成とインスタンスデータの詰め込み
+/// （D3Dやエンジンの型に依存しないので単体で検証できる）
+/// </summary>
+class SolidShapes {
+  public:
+	// 単位図形の種類（立方体は[-1, 1]、球は半径1、円柱は半径1でYが[-1, 1]）
+	enum class Shape {
+		kCube,
+		kSphere,
+		kCylinder,
+
+		kCountOfShape, //!< 図形の種類数
+	};
+
+	/// <summary>
+	/// 頂点データ（ShapeVS.hlslの頂点ごとの入力と同じ並び）
+	/// </summary>
+	struct Vertex {
+		float pos[3];    // xyz座標
+		float normal[3]; // 法線
+	};
+
+	/// <summary>
+	/// インスタンスデータ（ShapeVS.hlslのインスタンスごとの入力と同じ並び）
+	/// </summary>
+	struct Instance {
+		float rows[3][4]; // ワールド行列の転置の上3行（dot(rows[i], float4(pos, 1))で各成分）
+		uint32_t color;   // RGBA8
+	};
+
+	/// <summary>
+	/// 単位図形のメッシュ生成
+	/// </summary>
+	/// <param name="shape">図形の種類</param>
+	/// <param name="segments">球と円柱の円周の分割数</param>
+	/// <param name="vertices">頂点の格納先</param>
+	/// <param name="indices">インデックスの格納先</param>
+	static void BuildMesh(
+	  Shape shape, uint32_t segments, std::vector<Vertex>& vertices, std::vector<uint16_t>& indices);
+
+	/// <summary>
+	/// 色をRGBA8に詰める
+	/// </summary>
+	static uint32_t PackColor(float r, float g, float b, float a);
+
+	/// <summary>
+	/// 行ベクトル形式のワールド行列から詰める
+	/// </summary>
+	/// <param name="matWorld">ワールド行列（4行4列、4行目が平行移動）</param>
+	/// <param name="color">RGBA8</param>
+	/// <param name="instance">格納先</param>
+	static void PackMatrix(const float matWorld[4][4], uint32_t color, Instance& instance);
+
+	/// <summary>
+	/// 軸に平行な箱（立方体用）
+	/// </summary>
+	/// <param name="center">中心</param>
+	/// <param name="halfExtents">各辺の長さの半分</param>
+	static void
+	  PackBox(const float center[3], const float halfExtents[3], uint32_t color, Instance& instance);
+
+	/// <summary>
+	/// 球（球用）
+	/// </summary>
+	static void PackSphere(const float center[3], float radius, uint32_t color, Instance& instance);
+
+	/// <summary>
+	/// 2点を結ぶ円柱（円柱用）
+	/// </summary>
+	/// <param name="p0">軸の始点</param>
+	/// <param name="p1">軸の終点</param>
+	/// <param name="radius">半径</param>
+	static void PackCylinder(
+	  const float p0[3], const float p1[3], float radius, uint32_t color, Instance& instance);
+
+	/// <summary>
+	/// 頂点座標の変換（ShapeVS.hlslと同じ計算）
+	/// </summary>
+	/// <param name="instance">インスタンスデータ</param>
+	/// <param name="pos">単位図形の座標</param>
+	/// <param name="out">ワールド座標の格納先</param>
+	static void TransformPosition(const Instance& instance, const float pos[3], float out[3]);
+
+	/// <summary>
+	/// 法線の変換（ShapeVS.hlslと同じく逆転置行列で変換して正規化する）
+	/// </summary>
+	/// <param name="instance">インスタンスデータ</param>
+	/// <param name="normal">単位図形の法線</param>
+	/// <param name="out">ワールド法線の格納先</param>
+	static void TransformNormal(const Instance& instance, const float normal[3], float out[3]);
+};
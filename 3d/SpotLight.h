@@ -3,6 +3,7 @@
 #include "Vector2.h"
 #include "Vector3.h"
 #include "MathUtility.h"
+#include "ObjLayout.h"
 
 /// <summary>
 /// スポットライト
@@ -11,21 +12,8 @@ class SpotLight
 {
 public: // サブクラス
 
-	// 定数バッファ用データ構造体
-	struct ConstBufferData
-	{
-		Vector3 lightv;
-		float pad1;
-		Vector3 lightpos;
-		float pad2;
-		Vector3 lightcolor;
-		float pad3;
-		Vector3 lightatten;
-		float pad4;
-		Vector2 lightfactoranglecos;
-		unsigned int active;
-		float pad5;
-	};
+	// 定数バッファ用データ構造体（並びはObjLayout.hlsli）
+	using ConstBufferData = ObjLayout::SpotLight;
 
 public: // メンバ関数
 	/// <summary>
@@ -1,3 +1,5 @@
+#include "ObjLayout.hlsli"
+
 cbuffer WorldTransform : register(b0) {
 	matrix world; // ワールド行列
 };
@@ -8,67 +10,38 @@ cbuffer ViewProjection : register(b1) {
 	float3 cameraPos; // カメラ座標（ワールド座標）
 };
 
-cbuffer Material : register(b2) {
-	float3 m_ambient  : packoffset(c0); // アンビエント係数
-	float3 m_diffuse  : packoffset(c1); // ディフューズ係数
-	float3 m_specular : packoffset(c2); // スペキュラー係数
-	float m_alpha : packoffset(c2.w);	// アルファ
-}
+// ObjLayout.hlsliの並びから宣言を作る（C++側はObjLayout.h）
+#define OBJ_LAYOUT_FIELD(S, type, name) type name;
+#define OBJ_LAYOUT_ARRAY(S, type, name, count) type name[count];
 
-// 平行光源の数
-static const int DIRLIGHT_NUM = 3;
+cbuffer Material : register(b2)
+{
+	MATERIAL_LAYOUT(OBJ_LAYOUT_FIELD, OBJ_LAYOUT_ARRAY, Material)
+}
 
 struct DirLight
 {
-	float3 lightv;    // ライトへの方向の単位ベクトル
-	float3 lightcolor;    // ライトの色(RGB)
-	uint active;
+	DIRLIGHT_LAYOUT(OBJ_LAYOUT_FIELD, OBJ_LAYOUT_ARRAY, DirLight)
 };
 
-// 点光源の数
-static const int POINTLIGHT_NUM = 3;
-
 struct PointLight
 {
-	float3 lightpos;    // ライト座標
-	float3 lightcolor;  // ライトの色(RGB)
-	float3 lightatten;	// ライト距離減衰係数
-	uint active;
+	POINTLIGHT_LAYOUT(OBJ_LAYOUT_FIELD, OBJ_LAYOUT_ARRAY, PointLight)
 };
 
-// スポットライトの数
-static const int SPOTLIGHT_NUM = 3;
-
 struct SpotLight
 {
-	float3 lightv;		// ライトの光線方向の逆ベクトル（単位ベクトル）
-	float3 lightpos;    // ライト座標
-	float3 lightcolor;  // ライトの色(RGB)
-	float3 lightatten;	// ライト距離減衰係数
-	float2 lightfactoranglecos; // ライト減衰角度のコサイン
-	uint active;
+	SPOTLIGHT_LAYOUT(OBJ_LAYOUT_FIELD, OBJ_LAYOUT_ARRAY, SpotLight)
 };
 
-// 丸影の数
-static const int CIRCLESHADOW_NUM = 3;
-
 struct CircleShadow
 {
-	float3 dir;		// 投影方向の逆ベクトル（単位ベクトル）
-	float3 casterPos;    // キャスター座標
-	float  distanceCasterLight;	// キャスターとライトの距離
-	float3 atten;	// 距離減衰係数
-	float2 factorAngleCos; // 減衰角度のコサイン
-	uint active;
+	CIRCLESHADOW_LAYOUT(OBJ_LAYOUT_FIELD, OBJ_LAYOUT_ARRAY, CircleShadow)
 };
 
 cbuffer LightGroup : register(b3)
 {
-	float3 ambientColor;
-	DirLight dirLights[DIRLIGHT_NUM];
-	PointLight pointLights[POINTLIGHT_NUM];
-	SpotLight spotLights[SPOTLIGHT_NUM];
-	CircleShadow circleShadows[CIRCLESHADOW_NUM];
+	LIGHTGROUP_LAYOUT(OBJ_LAYOUT_FIELD, OBJ_LAYOUT_ARRAY, LightGroup)
 }
 
 // 頂点シェーダーからピクセルシェーダーへのやり取りに使用する構造体
@@ -0,0 +1,30 @@
+// バインドレス描画（ClusteredLightingのバインドレス用ルートシグネチャと同じ割り当て。ps_5_1以降）
+
+struct BindlessMaterial
+{
+	BINDLESSMATERIAL_LAYOUT(OBJ_LAYOUT_FIELD, OBJ_LAYOUT_ARRAY, BindlessMaterial)
+};
+
+cbuffer BindlessDraw : register(b6)
+{
+	BINDLESSDRAW_LAYOUT(OBJ_LAYOUT_FIELD, OBJ_LAYOUT_ARRAY, BindlessDraw)
+}
+
+// 全マテリアル
+StructuredBuffer<BindlessMaterial> bindlessMaterials : register(t5);
+// テクスチャのデスクリプタヒープ全体
+Texture2D<float4> bindlessTextures[] : register(t0, space1);
+
+// 描画中のマテリアル
+BindlessMaterial LoadBindlessMaterial()
+{
+	return bindlessMaterials[materialIndex];
+}
+
+// 描画中のテクスチャのサンプリング（番号は描画ごとに一定なのでNonUniformResourceIndexは要らない）
+float4 SampleBindlessTexture(BindlessMaterial material, SamplerState smp, float2 uv)
+{
+	uint textureIndex =
+		textureOverride != BINDLESS_NO_TEXTURE ? textureOverride : material.textureIndex;
+	return bindlessTextures[textureIndex].Sample(smp, uv);
+}
@@ -0,0 +1,56 @@
+// クラスタードライティング（LightClusterGrid.hと同じ並び）
+
+// 光源の種類
+static const uint CLUSTERLIGHT_POINT = 0;
+static const uint CLUSTERLIGHT_SPOT = 1;
+
+struct ClusterLight
+{
+	float3 lightpos;    // ライト座標
+	float range;        // 影響範囲
+	float3 lightcolor;  // ライトの色(RGB)
+	uint type;          // 光源の種類
+	float3 lightdir;    // スポットライトの光線方向（単位ベクトル）
+	float cosOuter;     // 減衰終了角度のコサイン
+	float3 lightatten;  // ライト距離減衰係数
+	float cosInner;     // 減衰開始角度のコサイン
+};
+
+// クラスタごとの光源番号の範囲
+struct Cluster
+{
+	uint offset; // 光源番号リストの開始位置
+	uint count;  // 光源数
+};
+
+cbuffer ClusterParams : register(b4)
+{
+	float2 tileSize;   // タイルの大きさ（ピクセル）
+	uint tilesX;       // 横のタイル数
+	uint tilesY;       // 縦のタイル数
+	uint slices;       // 奥行きの分割数
+	float sliceScale;  // 奥行き分割の係数
+	float sliceBias;
+	uint lightCount;   // 光源数
+}
+
+StructuredBuffer<ClusterLight> clusterLights : register(t1);
+StructuredBuffer<Cluster> clusters : register(t2);
+StructuredBuffer<uint> clusterLightIndices : register(t3);
+
+// スクリーン座標とビュー空間の奥行きからクラスタを引く
+Cluster FindCluster(float2 screenPos, float viewZ)
+{
+	uint3 index;
+	index.xy = min(uint2(screenPos / tileSize), uint2(tilesX - 1, tilesY - 1));
+	index.z = (uint)clamp(log(viewZ) * sliceScale + sliceBias, 0, slices - 1);
+	return clusters[(index.z * tilesY + index.y) * tilesX + index.x];
+}
+
+// 影響範囲の端で0になるように滑らかに落とす
+float RangeWindow(float d, float range)
+{
+	float ratio = d / range;
+	float window = saturate(1.0f - ratio * ratio * ratio * ratio);
+	return window * window;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "Obj.hlsli"
+#include "ObjClustered.hlsli"
+#include "ObjShadow.hlsli"
+
+#ifdef BINDLESS
+#include "ObjBindless.hlsli"
+#else
+Texture2D<float4> tex : register(t0);  // 0番スロットに設定されたテクスチャ
+#endif
+SamplerState smp : register(s0);      // 0番スロットに設定されたサンプラー
+
+float4 main(VSOutput input) : SV_TARGET
+{
+#ifdef BINDLESS
+	// マテリアルとテクスチャは描画ごとの番号で引く
+	BindlessMaterial material = LoadBindlessMaterial();
+	float4 texcolor = SampleBindlessTexture(material, smp, input.uv);
+	float3 materialAmbient = material.ambient;
+	float3 materialDiffuse = material.diffuse;
+	float3 materialSpecular = material.specular;
+	float materialAlpha = material.alpha;
+#else
+	// テクスチャマッピング
+	float4 texcolor = tex.Sample(smp, input.uv);
+	float3 materialAmbient = m_ambient;
+	float3 materialDiffuse = m_diffuse;
+	float3 materialSpecular = m_specular;
+	float materialAlpha = m_alpha;
+#endif
+
+	// 光沢度
+	const float shininess = 4.0f;
+	// 頂点から視点への方向ベクトル
+	float3 eyedir = normalize(cameraPos - input.worldpos.xyz);
+
+	// 環境反射光
+	float3 ambient = materialAmbient;
+
+	// シェーディングによる色
+	float4 shadecolor = float4(ambientColor * ambient, materialAlpha);
+
+	// ビュー空間の奥行き（クラスタと影の分割の選択に使う）
+	float viewZ = mul(view, input.worldpos).z;
+	// 0番の平行光源の影
+	float shadow = ShadowFactor(input.worldpos.xyz, input.normal, viewZ);
+
+	// 平行光源
+	for (int i = 0; i < DIRLIGHT_NUM; i++) {
+		if (dirLights[i].active) {
+			// ライトに向かうベクトルと法線の内積
+			float3 dotlightnormal = dot(dirLights[i].lightv, input.normal);
+			// 反射光ベクトル
+			float3 reflect = normalize(-dirLights[i].lightv + 2 * dotlightnormal * input.normal);
+			// 拡散反射光
+			float3 diffuse = dotlightnormal * materialDiffuse;
+			// 鏡面反射光
+			float3 specular = pow(saturate(dot(reflect, eyedir)), shininess) * materialSpecular;
+
+			// 全て加算する
+			float lit = (i == 0) ? shadow : 1.0f;
+			shadecolor.rgb += lit * (diffuse + specular) * dirLights[i].lightcolor;
+		}
+	}
+
+	// このピクセルのクラスタに振り分けられた点光源とスポットライトだけを計算する
+	Cluster cluster = FindCluster(input.svpos.xy, viewZ);
+	for (uint n = 0; n < cluster.count; n++) {
+		ClusterLight light = clusterLights[clusterLightIndices[cluster.offset + n]];
+
+		// ライトへの方向ベクトル
+		float3 lightv = light.lightpos - input.worldpos.xyz;
+		float d = length(lightv);
+		lightv = normalize(lightv);
+
+		// 距離減衰係数（影響範囲の外は0）
+		float atten = saturate(1.0f / (light.lightatten.x + light.lightatten.y * d + light.lightatten.z * d * d));
+		atten *= RangeWindow(d, light.range);
+
+		if (light.type == CLUSTERLIGHT_SPOT) {
+			// 減衰開始角度から、減衰終了角度にかけて減衰
+			float cos = dot(-lightv, light.lightdir);
+			atten *= smoothstep(light.cosOuter, light.cosInner, cos);
+		}
+
+		// ライトに向かうベクトルと法線の内積
+		float3 dotlightnormal = dot(lightv, input.normal);
+		// 反射光ベクトル
+		float3 reflect = normalize(-lightv + 2 * dotlightnormal * input.normal);
+		// 拡散反射光
+		float3 diffuse = dotlightnormal * materialDiffuse;
+		// 鏡面反射光
+		float3 specular = pow(saturate(dot(reflect, eyedir)), shininess) * materialSpecular;
+
+		// 全て加算する
+		shadecolor.rgb += atten * (diffuse + specular) * light.lightcolor;
+	}
+
+	// 丸影
+	for (i = 0; i < CIRCLESHADOW_NUM; i++) {
+		if (circleShadows[i].active) {
+			// オブジェクト表面からキャスターへのベクトル
+			float3 casterv = circleShadows[i].casterPos - input.worldpos.xyz;
+			// 光線方向での距離
+			float d = dot(casterv, circleShadows[i].dir);
+
+			// 距離減衰係数
+			float atten = saturate(1.0f / (circleShadows[i].atten.x + circleShadows[i].atten.y * d + circleShadows[i].atten.z *d*d));
+			// 距離がマイナスなら0にする
+			atten *= step(0, d);
+
+			// ライトの座標
+			float3 lightpos = circleShadows[i].casterPos + circleShadows[i].dir * circleShadows[i].distanceCasterLight;
+			//  オブジェクト表面からライトへのベクトル（単位ベクトル）
+			float3 lightv = normalize(lightpos - input.worldpos.xyz);
+			// 角度減衰
+			float cos = dot(lightv, circleShadows[i].dir);
+			// 減衰開始角度から、減衰終了角度にかけて減衰
+			// 減衰開始角度の内側は1倍 減衰終了角度の外側は0倍の輝度
+			float angleatten = smoothstep(circleShadows[i].factorAngleCos.y, circleShadows[i].factorAngleCos.x, cos);
+			// 角度減衰を乗算
+			atten *= angleatten;
+
+			// 全て減算する
+			shadecolor.rgb -= atten;
+		}
+	}
+
+	// シェーディングによる色で描画
+	return shadecolor * texcolor;
+}
\ No newline at end of file
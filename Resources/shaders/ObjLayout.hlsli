@@ -0,0 +1,92 @@
+// Obj系シェーダの定数バッファの並び（C++からもObjLayout.hで読み込む、唯一の定義）
+// FIELD(S, 型, 名前) と ARRAY(S, 型, 名前, 要素数) をメンバの順に並べる。
+// パディングも明示的に書く（cbufferのメンバは名前が全体で共有されるので重複しない名前にする）。
+
+// 平行光源の数
+#define DIRLIGHT_NUM 3
+// 点光源の数
+#define POINTLIGHT_NUM 3
+// スポットライトの数
+#define SPOTLIGHT_NUM 3
+// 丸影の数
+#define CIRCLESHADOW_NUM 1
+
+// マテリアル
+#define MATERIAL_LAYOUT(FIELD, ARRAY, S)                                                           \
+	FIELD(S, float3, m_ambient)  /* アンビエント係数 */                                            \
+	FIELD(S, float, m_pad1)                                                                        \
+	FIELD(S, float3, m_diffuse)  /* ディフューズ係数 */                                            \
+	FIELD(S, float, m_pad2)                                                                        \
+	FIELD(S, float3, m_specular) /* スペキュラー係数 */                                            \
+	FIELD(S, float, m_alpha)     /* アルファ */
+
+// 平行光源
+#define DIRLIGHT_LAYOUT(FIELD, ARRAY, S)                                                           \
+	FIELD(S, float3, lightv)     /* ライトへの方向の単位ベクトル */                                \
+	FIELD(S, float, pad1)                                                                          \
+	FIELD(S, float3, lightcolor) /* ライトの色(RGB) */                                             \
+	FIELD(S, uint, active)
+
+// 点光源
+#define POINTLIGHT_LAYOUT(FIELD, ARRAY, S)                                                         \
+	FIELD(S, float3, lightpos)   /* ライト座標 */                                                  \
+	FIELD(S, float, pad1)                                                                          \
+	FIELD(S, float3, lightcolor) /* ライトの色(RGB) */                                             \
+	FIELD(S, float, pad2)                                                                          \
+	FIELD(S, float3, lightatten) /* ライト距離減衰係数 */                                          \
+	FIELD(S, uint, active)
+
+// スポットライト
+#define SPOTLIGHT_LAYOUT(FIELD, ARRAY, S)                                                          \
+	FIELD(S, float3, lightv)              /* ライトの光線方向の逆ベクトル（単位ベクトル） */       \
+	FIELD(S, float, pad1)                                                                          \
+	FIELD(S, float3, lightpos)            /* ライト座標 */                                         \
+	FIELD(S, float, pad2)                                                                          \
+	FIELD(S, float3, lightcolor)          /* ライトの色(RGB) */                                    \
+	FIELD(S, float, pad3)                                                                          \
+	FIELD(S, float3, lightatten)          /* ライト距離減衰係数 */                                 \
+	FIELD(S, float, pad4)                                                                          \
+	FIELD(S, float2, lightfactoranglecos) /* ライト減衰角度のコサイン */                           \
+	FIELD(S, uint, active)                                                                         \
+	FIELD(S, float, pad5)
+
+// 丸影
+#define CIRCLESHADOW_LAYOUT(FIELD, ARRAY, S)                                                       \
+	FIELD(S, float3, dir)                 /* 投影方向の逆ベクトル（単位ベクトル） */               \
+	FIELD(S, float, pad1)                                                                          \
+	FIELD(S, float3, casterPos)           /* キャスター座標 */                                     \
+	FIELD(S, float, distanceCasterLight)  /* キャスターとライトの距離 */                           \
+	FIELD(S, float3, atten)               /* 距離減衰係数 */                                       \
+	FIELD(S, float, pad2)                                                                          \
+	FIELD(S, float2, factorAngleCos)      /* 減衰角度のコサイン */                                 \
+	FIELD(S, uint, active)                                                                         \
+	FIELD(S, float, pad3)
+
+// ライト
+#define LIGHTGROUP_LAYOUT(FIELD, ARRAY, S)                                                         \
+	FIELD(S, float3, ambientColor)                          /* 環境光の色 */                       \
+	FIELD(S, float, ambientPad)                                                                    \
+	ARRAY(S, DirLight, dirLights, DIRLIGHT_NUM)             /* 平行光源 */                         \
+	ARRAY(S, PointLight, pointLights, POINTLIGHT_NUM)       /* 点光源 */                           \
+	ARRAY(S, SpotLight, spotLights, SPOTLIGHT_NUM)          /* スポットライト */                   \
+	ARRAY(S, CircleShadow, circleShadows, CIRCLESHADOW_NUM) /* 丸影 */
+
+// バインドレス描画でテクスチャを差し替えないときのtextureOverride
+#define BINDLESS_NO_TEXTURE 0xffffffff
+
+// バインドレス描画のマテリアル（StructuredBufferの要素。テクスチャはヒープ上の番号で持つ）
+#define BINDLESSMATERIAL_LAYOUT(FIELD, ARRAY, S)                                                   \
+	FIELD(S, float3, ambient)    /* アンビエント係数 */                                            \
+	FIELD(S, uint, textureIndex) /* テクスチャのデスクリプタ番号 */                                \
+	FIELD(S, float3, diffuse)    /* ディフューズ係数 */                                            \
+	FIELD(S, float, pad1)                                                                          \
+	FIELD(S, float3, specular)   /* スペキュラー係数 */                                            \
+	FIELD(S, float, alpha)       /* アルファ */
+
+// バインドレス描画の描画ごとの定数（ルート定数。差し替えないときはBINDLESS_NO_TEXTURE）
+// （ルート定数の数がcbufferの大きさに足りるように1レジスタ分にする）
+#define BINDLESSDRAW_LAYOUT(FIELD, ARRAY, S)                                                       \
+	FIELD(S, uint, materialIndex)   /* マテリアルの番号 */                                         \
+	FIELD(S, uint, textureOverride) /* 差し替えるテクスチャの番号 */                               \
+	FIELD(S, uint, drawPad1)                                                                       \
+	FIELD(S, uint, drawPad2)
@@ -0,0 +1,48 @@
+// カスケードシャドウマップ（CascadedShadowMap.hのConstBufferDataと同じ並び）
+
+// 最大分割数
+static const uint SHADOW_CASCADE_MAX = 4;
+
+cbuffer ShadowParams : register(b5)
+{
+	matrix shadowViewProjections[SHADOW_CASCADE_MAX]; // 分割ごとの光源のビュープロジェクション
+	float4 cascadeSplits;      // 分割ごとの奥側の奥行き
+	float4 cascadeTexelSizes;  // 分割ごとの1テクセルの大きさ
+	uint cascadeCount;         // 分割数（0なら影なし）
+	float shadowDepthBias;     // 深度バイアス
+	float shadowNormalOffset;  // 法線方向のずらし量（テクセル単位）
+	float shadowMapTexelSize;  // シャドウマップの1テクセル（UV）
+}
+
+Texture2DArray<float> shadowMap : register(t4);
+SamplerComparisonState shadowSmp : register(s1);
+
+// 光が届く割合（1で日向、0で影）
+float ShadowFactor(float3 worldpos, float3 normal, float viewZ)
+{
+	if (cascadeCount == 0 || cascadeSplits[cascadeCount - 1] < viewZ) {
+		return 1.0f;
+	}
+
+	// 奥行きから分割を選ぶ
+	uint cascade = 0;
+	for (uint i = 0; i < cascadeCount - 1; i++) {
+		cascade += (cascadeSplits[i] < viewZ) ? 1 : 0;
+	}
+
+	// 法線方向に少しずらして自己遮蔽を防ぐ
+	float3 pos = worldpos + normal * cascadeTexelSizes[cascade] * shadowNormalOffset;
+	float4 shadowPos = mul(shadowViewProjections[cascade], float4(pos, 1));
+	float2 uv = shadowPos.xy * float2(0.5f, -0.5f) + 0.5f;
+	float depth = shadowPos.z - shadowDepthBias;
+
+	// 3x3のPCF
+	float lit = 0.0f;
+	for (int y = -1; y <= 1; y++) {
+		for (int x = -1; x <= 1; x++) {
+			float2 offset = float2(x, y) * shadowMapTexelSize;
+			lit += shadowMap.SampleCmpLevelZero(shadowSmp, float3(uv + offset, cascade), depth);
+		}
+	}
+	return lit / 9.0f;
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+#include "Obj.hlsli"
+
+// 光源から見た深度だけを描く（ビュープロジェクションには分割ごとの光源の行列が入る）
+float4 main(float4 pos : POSITION) : SV_POSITION
+{
+	return mul(mul(mul(projection, view), world), pos);
+}
\ No newline at end of file
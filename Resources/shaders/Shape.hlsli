@@ -1,5 +1,5 @@
 cbuffer cbuff0 : register(b0) {
-	matrix mat; // ３Ｄ変換行列
+	matrix mat; // ビュープロジェクション行列
 };
 
 // 頂点シェーダーからピクセルシェーダーへのやり取りに使用する構造体
@@ -1,8 +1,26 @@
 #include "Shape.hlsli"
 
-VSOutput main(float4 pos : POSITION, float4 color : COLOR) {
+// 平行光源の向き（陰影付け用）
+static const float3 kLightDirection = normalize(float3(0.3f, -1.0f, 0.5f));
+
+VSOutput main(
+  float3 pos : POSITION, float3 normal : NORMAL, float4 world0 : WORLD0, float4 world1 : WORLD1,
+  float4 world2 : WORLD2, float4 color : COLOR) {
+	// インスタンスのワールド変換（転置の上3行との内積）
+	float4 localPos = float4(pos, 1);
+	float4 worldPos =
+	  float4(dot(world0, localPos), dot(world1, localPos), dot(world2, localPos), 1);
+	// 法線は逆転置行列で変換する（軸ごとに拡大率が違っても面に垂直なまま）。
+	// 上3x3の余因子行列は逆転置行列の行列式倍なので、行列式の符号で向きを揃えて正規化する
+	float3 cofactor0 = cross(world1.xyz, world2.xyz);
+	float3 cofactor1 = cross(world2.xyz, world0.xyz);
+	float3 cofactor2 = cross(world0.xyz, world1.xyz);
+	float3 worldNormal =
+	  normalize(float3(dot(cofactor0, normal), dot(cofactor1, normal), dot(cofactor2, normal)));
+	worldNormal *= sign(dot(world0.xyz, cofactor0));
+
 	VSOutput output; // ピクセルシェーダーに渡す値
-	output.svpos = mul(mat, pos);
-	output.color = color;
+	output.svpos = mul(mat, worldPos);
+	output.color = float4(color.rgb * (0.5f + 0.5f * saturate(dot(worldNormal, -kLightDirection))), color.a);
 	return output;
 }
\ No newline at end of file
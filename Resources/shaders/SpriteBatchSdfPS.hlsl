@@ -0,0 +1,12 @@
+#include "SpriteBatch.hlsli"
+
+Texture2D<float> tex : register(t0);    // 0番スロットに設定された距離場テクスチャ
+SamplerState smpLinear : register(s1); // 1番スロットに設定された線形サンプラー
+
+float4 main(VSOutput input) : SV_TARGET {
+	// 0.5が輪郭。1ピクセル分の変化量で縁をなめらかにする
+	float distance = tex.Sample(smpLinear, input.uv);
+	float width = fwidth(distance);
+	float alpha = smoothstep(0.5f - width, 0.5f + width, distance);
+	return float4(input.color.rgb, input.color.a * alpha);
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+// 仮想テクスチャ（VirtualTexture::ConstBufferDataと同じ並び）
+struct VTParams {
+	float2 virtualSize;  // ミップ0の大きさ
+	float pageSize;      // ページの一辺
+	float border;        // ボーダー
+	float2 physicalSize; // 物理テクスチャの大きさ
+	uint mipCount;       // ミップレベル数
+	uint pad;
+};
+
+// 画面上の微分から仮想テクスチャのミップレベルを求める
+float VT_MipLevel(float2 uv, VTParams params) {
+	float2 dx = ddx(uv * params.virtualSize);
+	float2 dy = ddy(uv * params.virtualSize);
+	float d = max(dot(dx, dx), dot(dy, dy));
+	return 0.5f * log2(max(d, 1.0f));
+}
+
+// ミップレベルでのページ数
+uint2 VT_PageCount(uint mip, VTParams params) {
+	uint2 pages = (uint2)(params.virtualSize / params.pageSize);
+	return max(pages >> mip, uint2(1, 1));
+}
+
+// フィードバック用のページID（VirtualTexturePageTable::PackPageIdと同じ形式）
+uint VT_FeedbackPageId(float2 uv, VTParams params) {
+	uint mip = min((uint)VT_MipLevel(uv, params), params.mipCount - 1);
+	uint2 pages = VT_PageCount(mip, params);
+	uint2 page = min((uint2)(saturate(uv) * pages), pages - 1);
+	return (mip << 28) | (page.y << 14) | page.x;
+}
+
+// 仮想テクスチャのサンプリング（未常駐なら常駐している粗いミップで代用する）
+float4 VT_Sample(
+  Texture2D<float4> physical, Texture2D<uint> pageTable, SamplerState smp, float2 uv,
+  VTParams params) {
+	uint mip = min((uint)VT_MipLevel(uv, params), params.mipCount - 1);
+	uint2 pages = VT_PageCount(mip, params);
+	uint2 page = min((uint2)(saturate(uv) * pages), pages - 1);
+
+	// 物理スロットX | 物理スロットY << 8 | 常駐ミップ << 16 | 有効 << 24
+	uint entry = pageTable.Load(int3(page, mip));
+	if ((entry >> 24) == 0) {
+		return float4(0, 0, 0, 1);
+	}
+	uint2 slot = uint2(entry & 0xff, (entry >> 8) & 0xff);
+	uint residentMip = (entry >> 16) & 0xff;
+
+	// 常駐ミップのページ内座標から物理テクスチャ座標へ
+	float2 pageUV = frac(saturate(uv) * VT_PageCount(residentMip, params));
+	float slotSize = params.pageSize + params.border * 2.0f;
+	float2 texel = slot * slotSize + params.border + pageUV * params.pageSize;
+	return physical.SampleLevel(smp, texel / params.physicalSize, 0);
+}
@@ -0,0 +1,352 @@
+﻿#include "AssetHotReloader.h"
+#include "CascadedShadowMap.h"
+#include "ClusteredLighting.h"
+#include "DirectXCommon.h"
+#include "Model.h"
+#include "PrimitiveDrawer.h"
+#include "ShaderCompiler.h"
+#include "ShaderLibrary.h"
+#include "Sprite.h"
+#include "SpriteBatch.h"
+#include "TextureManager.h"
+#include "ThreadPool.h"
+#include <DirectXTex.h>
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+using namespace DirectX;
+
+namespace {
+// 拡張子の判定
+bool HasExtension(const std::string& path, const char* extension) {
+	size_t length = std::char_traits<char>::length(extension);
+	if (path.size() < length) {
+		return false;
+	}
+	return std::equal(
+	  extension, extension + length, path.end() - length,
+	  [](char lhs, char rhs) { return tolower(lhs) == tolower(rhs); });
+}
+
+// 前方一致の判定
+bool StartsWith(const std::string& str, const std::string& prefix) {
+	return prefix.size() <= str.size() && std::equal(prefix.begin(), prefix.end(), str.begin());
+}
+
+// 完了済みか
+bool IsReady(const std::future<void>& future) {
+	return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// ファイル名の末尾からシェーダプロファイルを決める
+const char* ShaderProfile(const std::string& fileName) {
+	std::string name = fileName.substr(0, fileName.size() - 5);
+	if (2 <= name.size()) {
+		std::string suffix = name.substr(name.size() - 2);
+		if (suffix == "VS") {
+			return "vs_5_0";
+		}
+		if (suffix == "PS") {
+			return "ps_5_0";
+		}
+		if (suffix == "GS") {
+			return "gs_5_0";
+		}
+		if (suffix == "CS") {
+			return "cs_5_0";
+		}
+	}
+	return nullptr;
+}
+
+// シェーダのバリエーション
+struct ShaderVariant {
+	std::string target;
+	std::string entryPoint;
+	std::vector<ShaderDefine> defines;
+};
+
+// 一覧ファイル（ShaderManifest.txt）からファイルのバリエーションを集める
+// （書式はShaderBuildと同じ。一覧に無いファイルや一覧が読めないときは空）
+std::vector<ShaderVariant>
+  ReadManifestVariants(const std::string& manifestPath, const std::string& fileName) {
+	std::vector<ShaderVariant> variants;
+	std::ifstream file(manifestPath);
+	std::string line;
+	while (std::getline(file, line)) {
+		std::istringstream stream(line);
+		std::string name;
+		if (!(stream >> name) || name[0] == '#' || name != fileName) {
+			continue;
+		}
+		ShaderVariant variant;
+		if (!(stream >> variant.target >> variant.entryPoint)) {
+			continue;
+		}
+		std::string define;
+		while (stream >> define) {
+			size_t equal = define.find('=');
+			if (equal == std::string::npos) {
+				variant.defines.push_back({define, "1"});
+			} else {
+				variant.defines.push_back({define.substr(0, equal), define.substr(equal + 1)});
+			}
+		}
+		variants.push_back(std::move(variant));
+	}
+	return variants;
+}
+} // namespace
+
+AssetHotReloader* AssetHotReloader::GetInstance() {
+	static AssetHotReloader instance;
+	return &instance;
+}
+
+void AssetHotReloader::Initialize(const std::string& directoryPath) {
+	directoryPath_ = directoryPath;
+
+	// 標準のシェーダグループ
+	RegisterShaderGroup({"ObjVS.hlsl", "ObjPS.hlsl", "ObjClusteredPS.hlsl"}, []() {
+		Model::InitializeGraphicsPipeline();
+		DirectXCommon* dxCommon = DirectXCommon::GetInstance();
+		ClusteredLighting::GetInstance()->Initialize(
+		  dxCommon->GetDevice(), dxCommon->GetBackBufferWidth(), dxCommon->GetBackBufferHeight());
+	});
+	RegisterShaderGroup({"SpriteVS.hlsl", "SpritePS.hlsl"}, []() {
+		DirectXCommon* dxCommon = DirectXCommon::GetInstance();
+		Sprite::StaticInitialize(
+		  dxCommon->GetDevice(), dxCommon->GetBackBufferWidth(), dxCommon->GetBackBufferHeight());
+	});
+	RegisterShaderGroup(
+	  {"SpriteBatchVS.hlsl", "SpriteBatchPS.hlsl", "SpriteBatchSdfPS.hlsl"}, []() {
+		  DirectXCommon* dxCommon = DirectXCommon::GetInstance();
+		  SpriteBatch::GetInstance()->Initialize(
+		    dxCommon->GetDevice(), dxCommon->GetBackBufferWidth(), dxCommon->GetBackBufferHeight());
+	  });
+	RegisterShaderGroup(
+	  {"PrimitiveVS.hlsl", "PrimitivePS.hlsl", "ShapeVS.hlsl", "ShapePS.hlsl"},
+	  []() { PrimitiveDrawer::GetInstance()->Initialize(); });
+	RegisterShaderGroup({"ShadowVS.hlsl"}, []() {
+		CascadedShadowMap::GetInstance()->Initialize(DirectXCommon::GetInstance()->GetDevice());
+	});
+
+	watcher_.Start(directoryPath_);
+}
+
+void AssetHotReloader::Finalize() {
+	watcher_.Stop();
+
+	// 読み込み中のものは完了を待って捨てる
+	for (PendingTexture& pending : pendingTextures_) {
+		pending.future.wait();
+	}
+	for (PendingShader& pending : pendingShaders_) {
+		pending.future.wait();
+	}
+	pendingTextures_.clear();
+	pendingShaders_.clear();
+	dirtyModels_.clear();
+}
+
+void AssetHotReloader::Update() {
+	// 変更されたファイルごとに読み直しを開始
+	for (const std::string& path : watcher_.PopChanges()) {
+		Dispatch(path);
+	}
+
+	// 読み込みが済んだテクスチャを差し替える
+	TextureManager* textureManager = TextureManager::GetInstance();
+	for (auto it = pendingTextures_.begin(); it != pendingTextures_.end();) {
+		if (!IsReady(it->future)) {
+			++it;
+			continue;
+		}
+		if (*it->succeeded) {
+			textureManager->Replace(it->handle, *it->image);
+		}
+		it = pendingTextures_.erase(it);
+	}
+
+	// パイプラインやモデルはライブラリ側で持つものもあり解放を遅らせられないので、
+	// 差し替える前に処理中のフレームの完了を待つ（テクスチャは解放を遅らせるので待たない）
+	bool waitedForGpu = false;
+	auto waitForGpu = [&waitedForGpu]() {
+		if (!waitedForGpu) {
+			DirectXCommon::GetInstance()->WaitForGpu();
+			waitedForGpu = true;
+		}
+	};
+
+	// コンパイルが通ったシェーダグループのパイプラインを作り直す
+	for (auto it = pendingShaders_.begin(); it != pendingShaders_.end();) {
+		if (!IsReady(it->future)) {
+			++it;
+			continue;
+		}
+		if (*it->succeeded) {
+			waitForGpu();
+			shaderGroups_[it->groupIndex].rebuild();
+		}
+		it = pendingShaders_.erase(it);
+	}
+
+	// モデルを作り直して差し替える
+	// （Model::CreateFromOBJはライブラリ内でファイルの解析とGPUリソースの作成を分けられず、
+	// 　デバイスとコマンドリストを使うので、別スレッドに出さずにメインスレッドで行う）
+	if (!dirtyModels_.empty()) {
+		waitForGpu();
+	}
+	for (Model** dirtyModel : dirtyModels_) {
+		auto it = std::find_if(
+		  models_.begin(), models_.end(),
+		  [dirtyModel](const ModelEntry& entry) { return entry.model == dirtyModel; });
+		if (it == models_.end()) {
+			continue;
+		}
+		ModelEntry& entry = *it;
+		Model* model = Model::CreateFromOBJ(entry.name, entry.smoothing);
+		if (model) {
+			// マテリアルやメッシュを指している登録を解放する前に差し替える
+			ClusteredLighting::GetInstance()->OnModelReplaced(*entry.model, model);
+			delete *entry.model;
+			*entry.model = model;
+		}
+	}
+	dirtyModels_.clear();
+}
+
+void AssetHotReloader::RegisterModel(Model** model, const std::string& modelName, bool smoothing) {
+	assert(model);
+	models_.push_back({model, modelName, smoothing});
+}
+
+void AssetHotReloader::UnregisterModel(Model** model) {
+	// 他のモデルの作り直し予約は残す
+	dirtyModels_.erase(
+	  std::remove(dirtyModels_.begin(), dirtyModels_.end(), model), dirtyModels_.end());
+	models_.erase(
+	  std::remove_if(
+	    models_.begin(), models_.end(), [model](const ModelEntry& entry) { return entry.model == model; }),
+	  models_.end());
+}
+
+void AssetHotReloader::RegisterShaderGroup(
+  const std::vector<std::string>& fileNames, std::function<void()> rebuild) {
+	shaderGroups_.push_back({fileNames, std::move(rebuild)});
+}
+
+void AssetHotReloader::Dispatch(const std::string& path) {
+	// シェーダ（メンバーのインクルードはその都度辿るので、#includeの追加や削除にも追従する）
+	if (StartsWith(path, "shaders/")) {
+		std::wstring changedPath =
+		  ShaderCompiler::NormalizePath(std::wstring(directoryPath_.begin(), directoryPath_.end()) +
+		                                std::wstring(path.begin(), path.end()));
+		for (size_t i = 0; i < shaderGroups_.size(); i++) {
+			if (DependsOn(shaderGroups_[i], changedPath)) {
+				CompileShaderGroup(i);
+			}
+		}
+		return;
+	}
+
+	// OBJモデル
+	if (HasExtension(path, ".obj") || HasExtension(path, ".mtl")) {
+		for (const ModelEntry& entry : models_) {
+			if (StartsWith(path, entry.name + "/") &&
+			    std::find(dirtyModels_.begin(), dirtyModels_.end(), entry.model) ==
+			      dirtyModels_.end()) {
+				dirtyModels_.push_back(entry.model);
+			}
+		}
+		return;
+	}
+
+	// 読み込み済みのテクスチャだけを別スレッドで読み直す
+	TextureManager* textureManager = TextureManager::GetInstance();
+	uint32_t handle = 0;
+	std::string fileName = path;
+	if (!textureManager->Find(fileName, handle)) {
+		// ディレクトリ込みの名前で読み込まれている場合
+		fileName = directoryPath_ + path;
+		if (!textureManager->Find(fileName, handle)) {
+			return;
+		}
+	}
+	auto image = std::make_shared<ScratchImage>();
+	auto succeeded = std::make_shared<bool>(false);
+	std::future<void> future =
+	  ThreadPool::GetInstance()->Enqueue([textureManager, fileName, image, succeeded]() {
+		  // WICを使うのでワーカースレッドでもCOMを初期化する
+		  HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+		  *succeeded = textureManager->LoadImageFile(fileName, *image);
+		  if (SUCCEEDED(comResult)) {
+			  CoUninitialize();
+		  }
+	  });
+	pendingTextures_.push_back({handle, image, succeeded, std::move(future)});
+}
+
+bool AssetHotReloader::DependsOn(const ShaderGroup& group, const std::wstring& changedPath) const {
+	std::wstring directory(directoryPath_.begin(), directoryPath_.end());
+	std::vector<std::wstring> sources;
+	for (const std::string& fileName : group.fileNames) {
+		// 読めないインクルードがあっても、辿れたところまでで判定する
+		ShaderCompiler::CollectSources(
+		  directory + L"shaders/" + std::wstring(fileName.begin(), fileName.end()), sources);
+		if (std::find(sources.begin(), sources.end(), changedPath) != sources.end()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void AssetHotReloader::CompileShaderGroup(size_t groupIndex) {
+	// 同じグループを検証中なら重ねない
+	for (const PendingShader& pending : pendingShaders_) {
+		if (pending.groupIndex == groupIndex) {
+			return;
+		}
+	}
+
+	std::string directory = directoryPath_ + "shaders/";
+	std::vector<std::string> files = shaderGroups_[groupIndex].fileNames;
+	auto succeeded = std::make_shared<bool>(false);
+	std::future<void> future = ThreadPool::GetInstance()->Enqueue([directory, files, succeeded]() {
+		bool allSucceeded = true;
+		for (const std::string& fileName : files) {
+			// 作り直しで使うバリエーションを全て検証する（一覧に無いものは名前から決める）
+			std::vector<ShaderVariant> variants =
+			  ReadManifestVariants(directory + "ShaderManifest.txt", fileName);
+			const char* profile = ShaderProfile(fileName);
+			if (variants.empty() && profile) {
+				variants.push_back({profile, "main", {}});
+			}
+
+			// ユニコード文字列に変換
+			wchar_t wfilePath[256];
+			MultiByteToWideChar(
+			  CP_ACP, 0, (directory + fileName).c_str(), -1, wfilePath, _countof(wfilePath));
+
+			// 成功したものはライブラリに残るので、差し替え時の取得ではコンパイルし直さない
+			for (const ShaderVariant& variant : variants) {
+				D3D12_SHADER_BYTECODE bytecode;
+				std::string errors;
+				if (!ShaderLibrary::GetInstance()->TryLoad(
+				      wfilePath, variant.target, variant.entryPoint, variant.defines, bytecode,
+				      &errors)) {
+					// エラー内容を出力して差し替えを見送る
+					allSucceeded = false;
+					OutputDebugStringA(errors.c_str());
+				}
+			}
+		}
+
+		*succeeded = allSucceeded;
+	});
+	pendingShaders_.push_back({groupIndex, succeeded, std::move(future)});
+}
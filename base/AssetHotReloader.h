@@ -0,0 +1,135 @@
+﻿#pragma once
+
+#include "FileWatcher.h"
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Model;
+
+namespace DirectX {
+class ScratchImage;
+}
+
+/// <summary>
+/// アセットのホットリロード
+/// （変更されたテクスチャ・OBJモデル・シェーダだけを読み直し、フレーム境界で差し替える）
+/// </summary>
+class AssetHotReloader {
+  public:
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static AssetHotReloader* GetInstance();
+
+	/// <summary>
+	/// 初期化（監視を開始し、標準のシェーダグループを登録する）
+	/// </summary>
+	/// <param name="directoryPath">監視するディレクトリ</param>
+	void Initialize(const std::string& directoryPath = "Resources/");
+
+	/// <summary>
+	/// 終了処理
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// 毎フレーム処理（フレーム境界で呼ぶ。読み込みが済んだものを差し替える）
+	/// </summary>
+	void Update();
+
+	/// <summary>
+	/// 差し替え対象のモデルの登録
+	/// </summary>
+	/// <param name="model">モデルを保持するポインタ変数のアドレス（差し替え時に書き換える）</param>
+	/// <param name="modelName">モデル名</param>
+	/// <param name="smoothing">エッジ平滑化フラグ</param>
+	void RegisterModel(Model** model, const std::string& modelName, bool smoothing = false);
+
+	/// <summary>
+	/// 差し替え対象のモデルの登録解除
+	/// </summary>
+	/// <param name="model">登録したポインタ変数のアドレス</param>
+	void UnregisterModel(Model** model);
+
+	/// <summary>
+	/// シェーダグループの登録
+	/// （メンバーかそのインクルード（.hlsli）が変更されたら全メンバーを検証して作り直す）
+	/// </summary>
+	/// <param name="fileNames">shaders/以下のシェーダファイル名</param>
+	/// <param name="rebuild">パイプライン再生成処理</param>
+	void RegisterShaderGroup(
+	  const std::vector<std::string>& fileNames, std::function<void()> rebuild);
+
+  private:
+	// 差し替え対象のモデル
+	struct ModelEntry {
+		Model** model;
+		std::string name;
+		bool smoothing;
+	};
+
+	// シェーダグループ
+	struct ShaderGroup {
+		std::vector<std::string> fileNames;
+		std::function<void()> rebuild;
+	};
+
+	// 読み込み中のテクスチャ
+	struct PendingTexture {
+		uint32_t handle;
+		std::shared_ptr<DirectX::ScratchImage> image;
+		std::shared_ptr<bool> succeeded;
+		std::future<void> future;
+	};
+
+	// 検証コンパイル中のシェーダグループ
+	struct PendingShader {
+		size_t groupIndex;
+		std::shared_ptr<bool> succeeded;
+		std::future<void> future;
+	};
+
+	AssetHotReloader() = default;
+	~AssetHotReloader() = default;
+	AssetHotReloader(const AssetHotReloader&) = delete;
+	AssetHotReloader& operator=(const AssetHotReloader&) = delete;
+
+	/// <summary>
+	/// 変更されたファイルに応じた読み直しの開始
+	/// </summary>
+	/// <param name="path">監視ディレクトリからの相対パス</param>
+	void Dispatch(const std::string& path);
+
+	/// <summary>
+	/// シェーダグループのメンバーかそのインクルードか
+	/// </summary>
+	/// <param name="group">シェーダグループ</param>
+	/// <param name="changedPath">変更されたファイルの正規化したパス</param>
+	/// <returns>該当すればtrue</returns>
+	bool DependsOn(const ShaderGroup& group, const std::wstring& changedPath) const;
+
+	/// <summary>
+	/// シェーダグループ内の全シェーダを別スレッドで検証コンパイルする
+	/// </summary>
+	/// <param name="groupIndex">グループ番号</param>
+	void CompileShaderGroup(size_t groupIndex);
+
+	// ファイル監視
+	FileWatcher watcher_;
+	// 監視ディレクトリ
+	std::string directoryPath_;
+	// 差し替え対象のモデル
+	std::vector<ModelEntry> models_;
+	// シェーダグループ
+	std::vector<ShaderGroup> shaderGroups_;
+	// 読み込み中のテクスチャ
+	std::vector<PendingTexture> pendingTextures_;
+	// 検証コンパイル中のシェーダ
+	std::vector<PendingShader> pendingShaders_;
+	// 次のフレーム境界で作り直すモデル（登録したポインタ変数のアドレス）
+	std::vector<Model**> dirtyModels_;
+};
@@ -0,0 +1,118 @@
+﻿#include "CommandContextPool.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace {
+// 経過時間（ミリ秒）
+double ElapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+	  .count();
+}
+} // namespace
+
+CommandContextPool* CommandContextPool::GetInstance() {
+	static CommandContextPool instance;
+	return &instance;
+}
+
+void CommandContextPool::Initialize(ID3D12Device* device, uint32_t frameCount) {
+	assert(device);
+	assert(1 <= frameCount && frameCount <= DirectXCommon::kMaxFrameCount);
+
+	device_ = device;
+	frameCount_ = frameCount;
+	contexts_.clear();
+	slots_.Initialize(frameCount);
+}
+
+ID3D12GraphicsCommandList* CommandContextPool::Acquire() {
+	assert(device_);
+	DirectXCommon* dxCommon = DirectXCommon::GetInstance();
+
+	Context* context = nullptr;
+	CommandContextSlots::Lease lease;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		// PostDrawを挟んだら前のフレームの貸し出しは戻っている
+		lease = slots_.Acquire(dxCommon->GetFrameNumber(), dxCommon->GetFrameIndex());
+		if (lease.isNewContext) {
+			contexts_.push_back(CreateContext());
+		}
+		context = contexts_[lease.context].get();
+	}
+
+	// このフレーム番号のアロケータは、前回使ったフレームの完了をDirectXCommonが待ち済み
+	ID3D12CommandAllocator* allocator = context->allocators[lease.allocator].Get();
+	HRESULT result = allocator->Reset();
+	assert(SUCCEEDED(result));
+	result = context->commandList->Reset(allocator, nullptr);
+	assert(SUCCEEDED(result));
+	(void)result;
+
+	return context->commandList.Get();
+}
+
+void CommandContextPool::RecordParallel(
+  uint32_t count, uint32_t grainSize, const RecordFunction& record) {
+	recordStats_ = RecordStats();
+	if (count == 0) {
+		return;
+	}
+
+	// 区間は並列数までにする（コマンドリストが増えるほど提出とGPU側の切り替えが増える）
+	ThreadPool* threadPool = ThreadPool::GetInstance();
+	uint32_t chunkSize = 0;
+	uint32_t contextCount =
+	  CommandContextSlots::Split(count, grainSize, threadPool->GetConcurrency(), chunkSize);
+
+	// 貸し出しはメインスレッドで先に済ませて、区間とコマンドリストの対応を固定する
+	recordLists_.resize(contextCount);
+	recordTimes_.assign(contextCount, 0.0);
+	for (uint32_t i = 0; i < contextCount; i++) {
+		recordLists_[i] = Acquire();
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	threadPool->ParallelFor(contextCount, 1, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			std::chrono::steady_clock::time_point recordStart = std::chrono::steady_clock::now();
+			uint32_t first = i * chunkSize;
+			record(recordLists_[i], first, (std::min)(first + chunkSize, count));
+			recordLists_[i]->Close();
+			recordTimes_[i] = ElapsedMilliseconds(recordStart);
+		}
+	});
+
+	// 区間の順に挟む
+	DirectXCommon::GetInstance()->InsertCommandLists(recordLists_.data(), contextCount);
+
+	recordStats_.contextCount = contextCount;
+	recordStats_.itemCount = count;
+	recordStats_.wallTime = ElapsedMilliseconds(start);
+	for (double time : recordTimes_) {
+		recordStats_.busyTime += time;
+	}
+}
+
+std::unique_ptr<CommandContextPool::Context> CommandContextPool::CreateContext() {
+	HRESULT result = S_FALSE;
+	std::unique_ptr<Context> context = std::make_unique<Context>();
+
+	for (uint32_t i = 0; i < frameCount_; i++) {
+		result = device_->CreateCommandAllocator(
+		  D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&context->allocators[i]));
+		assert(SUCCEEDED(result));
+	}
+
+	// 生成直後は記録中なので閉じておき、貸し出すときに記録し直す
+	result = device_->CreateCommandList(
+	  0, D3D12_COMMAND_LIST_TYPE_DIRECT, context->allocators[0].Get(), nullptr,
+	  IID_PPV_ARGS(&context->commandList));
+	assert(SUCCEEDED(result));
+	context->commandList->Close();
+
+	return context;
+}
@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include "CommandContextSlots.h"
+#include "DirectXCommon.h"
+#include <d3d12.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <wrl.h>
+
+/// <summary>
+/// コマンドコンテキストプール
+/// （フレームごとのアロケータを持つコマンドリストを貸し出し、描画の記録をワーカースレッドに分ける。
+///   記録したものは描画コマンドリストの続きに順番どおり挟み、PostDrawでまとめて提出される）
+/// </summary>
+class CommandContextPool {
+  public:
+	/// <summary>
+	/// 記録関数（コマンドリスト、要素の開始番号、終了番号）
+	/// </summary>
+	using RecordFunction = std::function<void(ID3D12GraphicsCommandList*, uint32_t, uint32_t)>;
+
+	/// <summary>
+	/// 直前の並列記録の統計（ミリ秒）
+	/// </summary>
+	struct RecordStats {
+		uint32_t contextCount = 0; // 使ったコマンドリスト数
+		uint32_t itemCount = 0;    // 記録した要素数
+		double wallTime = 0.0;     // 記録全体にかかった時間
+		double busyTime = 0.0;     // コマンドリストごとの記録時間の合計（wallTimeとの比が並列度）
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static CommandContextPool* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="device">デバイス</param>
+	/// <param name="frameCount">同時処理フレーム数</param>
+	void Initialize(ID3D12Device* device, uint32_t frameCount);
+
+	/// <summary>
+	/// コマンドリストを借りて、このフレームの記録を始める（どのスレッドからも呼べる）
+	/// （閉じてからDirectXCommon::InsertCommandListsで挟む。貸し出しはフレームが変わると戻る）
+	/// </summary>
+	/// <returns>記録中のコマンドリスト</returns>
+	ID3D12GraphicsCommandList* Acquire();
+
+	/// <summary>
+	/// 要素を連続した区間に分けて区間ごとのコマンドリストにワーカースレッドで記録し、
+	/// 区間の順に描画コマンドリストの続きへ挟む
+	/// （コマンドリストは白紙で渡るので、記録関数は最初に描画先やパイプラインを設定する）
+	/// </summary>
+	/// <param name="count">要素数</param>
+	/// <param name="grainSize">1つのコマンドリストに記録する最小の要素数</param>
+	/// <param name="record">記録関数</param>
+	void RecordParallel(uint32_t count, uint32_t grainSize, const RecordFunction& record);
+
+	/// <summary>
+	/// 直前の並列記録の統計の取得
+	/// </summary>
+	const RecordStats& GetRecordStats() const { return recordStats_; }
+
+	/// <summary>
+	/// 生成済みのコマンドリスト数
+	/// </summary>
+	size_t GetContextCount() const { return contexts_.size(); }
+
+  private:
+	// コマンドリストとフレームごとのアロケータ
+	struct Context {
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocators[DirectXCommon::kMaxFrameCount];
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList;
+	};
+
+	CommandContextPool() = default;
+	~CommandContextPool() = default;
+	CommandContextPool(const CommandContextPool&) = delete;
+	CommandContextPool& operator=(const CommandContextPool&) = delete;
+
+	/// <summary>
+	/// コンテキスト生成
+	/// </summary>
+	std::unique_ptr<Context> CreateContext();
+
+	// デバイス
+	ID3D12Device* device_ = nullptr;
+	// 同時処理フレーム数
+	uint32_t frameCount_ = 0;
+	// コンテキスト（貸し出し管理の番号で添え字アクセス）
+	std::vector<std::unique_ptr<Context>> contexts_;
+	CommandContextSlots slots_;
+	// 貸し出しの排他
+	std::mutex mutex_;
+	// 並列記録の作業領域
+	std::vector<ID3D12GraphicsCommandList*> recordLists_;
+	std::vector<double> recordTimes_;
+	// 統計
+	RecordStats recordStats_;
+};
@@ -0,0 +1,49 @@
+﻿#include "CommandContextSlots.h"
+#include <algorithm>
+#include <cassert>
+
+void CommandContextSlots::Initialize(uint32_t frameCount) {
+	assert(0 < frameCount);
+
+	frameCount_ = frameCount;
+	contextCount_ = 0;
+	usedCount_ = 0;
+	frameNumber_ = 0;
+}
+
+CommandContextSlots::Lease CommandContextSlots::Acquire(uint64_t frameNumber, uint32_t frameIndex) {
+	assert(frameIndex < frameCount_);
+
+	// フレームが変わったら前のフレームの貸し出しは戻っている
+	if (frameNumber != frameNumber_) {
+		frameNumber_ = frameNumber;
+		usedCount_ = 0;
+	}
+
+	Lease lease;
+	lease.context = usedCount_++;
+	// アロケータはフレーム番号ごとに持つので、前回同じフレーム番号で使ったフレームの完了だけを待つ
+	lease.allocator = frameIndex;
+	lease.isNewContext = lease.context == contextCount_;
+	if (lease.isNewContext) {
+		contextCount_++;
+	}
+	return lease;
+}
+
+uint32_t CommandContextSlots::Split(
+  uint32_t count, uint32_t grainSize, uint32_t concurrency, uint32_t& chunkSize) {
+	chunkSize = 0;
+	if (count == 0) {
+		return 0;
+	}
+	grainSize = (std::max)(grainSize, 1u);
+	concurrency = (std::max)(concurrency, 1u);
+
+	// 区間は並列数までにする（コマンドリストが増えるほど提出とGPU側の切り替えが増える）
+	// （切り捨てで数えて、どの区間も最小の要素数を下回らないようにする）
+	uint32_t chunkCount = (std::max)((std::min)(count / grainSize, concurrency), 1u);
+	chunkSize = (count + chunkCount - 1) / chunkCount;
+	// 切り上げで最後の区間が空にならないように数え直す
+	return (count + chunkSize - 1) / chunkSize;
+}
@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include <cstdint>
+
+/// <summary>
+/// コマンドコンテキストの貸し出し管理
+/// （CommandContextPoolの貸し出し部分。コマンドリストは持たず番号だけを扱うので、
+/// 　フレームをまたいだ使い回しと区間の分け方をGPU無しで検証できる）
+/// </summary>
+class CommandContextSlots {
+  public:
+	/// <summary>
+	/// 貸し出し結果
+	/// </summary>
+	struct Lease {
+		// コンテキスト番号
+		uint32_t context = 0;
+		// 使うアロケータ（フレーム番号。同じ番号の前回のフレームは完了している）
+		uint32_t allocator = 0;
+		// 新しく作るコンテキストか。呼び出し側でコマンドリストを作る
+		bool isNewContext = false;
+	};
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="frameCount">同時処理フレーム数</param>
+	void Initialize(uint32_t frameCount);
+
+	/// <summary>
+	/// 貸し出し（フレームが変わると前のフレームの貸し出しは戻る）
+	/// </summary>
+	/// <param name="frameNumber">記録中のフレームの通し番号</param>
+	/// <param name="frameIndex">記録中のフレーム番号（0～同時処理フレーム数-1）</param>
+	/// <returns>貸し出し結果</returns>
+	Lease Acquire(uint64_t frameNumber, uint32_t frameIndex);
+
+	/// <summary>
+	/// 要素を連続した区間に分ける（区間は並列数まで、1区間は最小の要素数以上にする）
+	/// </summary>
+	/// <param name="count">要素数</param>
+	/// <param name="grainSize">1区間の最小の要素数</param>
+	/// <param name="concurrency">並列数</param>
+	/// <param name="chunkSize">1区間の要素数（最後の区間だけ少ないことがある）</param>
+	/// <returns>区間数</returns>
+	static uint32_t
+	  Split(uint32_t count, uint32_t grainSize, uint32_t concurrency, uint32_t& chunkSize);
+
+	/// <summary>
+	/// 作ったコンテキスト数
+	/// </summary>
+	uint32_t GetContextCount() const { return contextCount_; }
+
+	/// <summary>
+	/// このフレームで貸し出したコンテキスト数
+	/// </summary>
+	uint32_t GetUsedCount() const { return usedCount_; }
+
+  private:
+	// 同時処理フレーム数
+	uint32_t frameCount_ = 0;
+	// 作ったコンテキスト数（フレームごとに先頭から貸し出す）
+	uint32_t contextCount_ = 0;
+	uint32_t usedCount_ = 0;
+	// 貸し出しを数えているフレーム
+	uint64_t frameNumber_ = 0;
+};
@@ -0,0 +1,111 @@
+﻿#include "D3D12RenderCommandList.h"
+#include <cassert>
+
+// トポロジはD3D_PRIMITIVE_TOPOLOGYの値をそのまま使う
+static_assert(
+  static_cast<uint32_t>(RenderTopology::kLineList) == D3D_PRIMITIVE_TOPOLOGY_LINELIST,
+  "RenderTopology must match D3D_PRIMITIVE_TOPOLOGY");
+static_assert(
+  static_cast<uint32_t>(RenderTopology::kTriangleStrip) == D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP,
+  "RenderTopology must match D3D_PRIMITIVE_TOPOLOGY");
+
+const uint32_t D3D12RenderCommandList::kMaxVertexBuffers;
+
+RenderVertexBufferView D3D12RenderCommandList::Wrap(const D3D12_VERTEX_BUFFER_VIEW& view) {
+	RenderVertexBufferView result;
+	result.address = view.BufferLocation;
+	result.size = view.SizeInBytes;
+	result.stride = view.StrideInBytes;
+	return result;
+}
+
+RenderIndexBufferView D3D12RenderCommandList::Wrap(const D3D12_INDEX_BUFFER_VIEW& view) {
+	assert(view.Format == DXGI_FORMAT_R16_UINT || view.Format == DXGI_FORMAT_R32_UINT);
+	RenderIndexBufferView result;
+	result.address = view.BufferLocation;
+	result.size = view.SizeInBytes;
+	result.format = view.Format == DXGI_FORMAT_R16_UINT ? RenderIndexFormat::kUint16
+	                                                    : RenderIndexFormat::kUint32;
+	return result;
+}
+
+void D3D12RenderCommandList::SetPipelineState(RenderPipeline* pipeline) {
+	commandList_->SetPipelineState(reinterpret_cast<ID3D12PipelineState*>(pipeline));
+}
+
+void D3D12RenderCommandList::SetGraphicsRootSignature(RenderRootSignature* rootSignature) {
+	commandList_->SetGraphicsRootSignature(reinterpret_cast<ID3D12RootSignature*>(rootSignature));
+}
+
+void D3D12RenderCommandList::SetPrimitiveTopology(RenderTopology topology) {
+	commandList_->IASetPrimitiveTopology(static_cast<D3D_PRIMITIVE_TOPOLOGY>(topology));
+}
+
+void D3D12RenderCommandList::SetVertexBuffers(
+  uint32_t startSlot, uint32_t count, const RenderVertexBufferView* views) {
+	assert(count <= kMaxVertexBuffers);
+	D3D12_VERTEX_BUFFER_VIEW vbViews[kMaxVertexBuffers];
+	for (uint32_t i = 0; i < count; i++) {
+		vbViews[i].BufferLocation = views[i].address;
+		vbViews[i].SizeInBytes = views[i].size;
+		vbViews[i].StrideInBytes = views[i].stride;
+	}
+	commandList_->IASetVertexBuffers(startSlot, count, vbViews);
+}
+
+void D3D12RenderCommandList::SetIndexBuffer(const RenderIndexBufferView& view) {
+	D3D12_INDEX_BUFFER_VIEW ibView;
+	ibView.BufferLocation = view.address;
+	ibView.SizeInBytes = view.size;
+	ibView.Format =
+	  view.format == RenderIndexFormat::kUint16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	commandList_->IASetIndexBuffer(&ibView);
+}
+
+void D3D12RenderCommandList::SetDescriptorHeap(RenderDescriptorHeap* descriptorHeap) {
+	ID3D12DescriptorHeap* ppHeaps[] = {reinterpret_cast<ID3D12DescriptorHeap*>(descriptorHeap)};
+	commandList_->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+}
+
+void D3D12RenderCommandList::SetGraphicsRootConstantBufferView(
+  uint32_t rootParamIndex, uint64_t address) {
+	commandList_->SetGraphicsRootConstantBufferView(rootParamIndex, address);
+}
+
+void D3D12RenderCommandList::SetGraphicsRootShaderResourceView(
+  uint32_t rootParamIndex, uint64_t address) {
+	commandList_->SetGraphicsRootShaderResourceView(rootParamIndex, address);
+}
+
+void D3D12RenderCommandList::SetGraphicsRootDescriptorTable(
+  uint32_t rootParamIndex, uint64_t gpuDescriptor) {
+	D3D12_GPU_DESCRIPTOR_HANDLE handle;
+	handle.ptr = gpuDescriptor;
+	commandList_->SetGraphicsRootDescriptorTable(rootParamIndex, handle);
+}
+
+void D3D12RenderCommandList::SetGraphicsRoot32BitConstants(
+  uint32_t rootParamIndex, uint32_t count, const void* data, uint32_t offset) {
+	commandList_->SetGraphicsRoot32BitConstants(rootParamIndex, count, data, offset);
+}
+
+void D3D12RenderCommandList::DrawInstanced(
+  uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) {
+	commandList_->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void D3D12RenderCommandList::DrawIndexedInstanced(
+  uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+  uint32_t startInstance) {
+	commandList_->DrawIndexedInstanced(
+	  indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void D3D12RenderCommandList::ExecuteIndirect(
+  RenderCommandSignature* signature, uint32_t maxCommandCount, RenderBuffer* argumentBuffer,
+  uint64_t argumentOffset, RenderBuffer* countBuffer, uint64_t countOffset) {
+	commandList_->ExecuteIndirect(
+	  reinterpret_cast<ID3D12CommandSignature*>(signature), maxCommandCount,
+	  reinterpret_cast<ID3D12Resource*>(argumentBuffer), argumentOffset,
+	  reinterpret_cast<ID3D12Resource*>(countBuffer), countOffset);
+}
@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include "RenderCommandList.h"
+#include <d3d12.h>
+
+/// <summary>
+/// 描画コマンドのD3D12バックエンド（ID3D12GraphicsCommandListにそのまま流す）
+/// </summary>
+class D3D12RenderCommandList : public RenderCommandList {
+  public:
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="commandList">発行先のコマンドリスト</param>
+	explicit D3D12RenderCommandList(ID3D12GraphicsCommandList* commandList = nullptr)
+	    : commandList_(commandList) {}
+
+	/// <summary>
+	/// 発行先の切り替え
+	/// </summary>
+	void SetCommandList(ID3D12GraphicsCommandList* commandList) { commandList_ = commandList; }
+
+	/// <summary>
+	/// 発行先の取得
+	/// </summary>
+	ID3D12GraphicsCommandList* GetCommandList() const { return commandList_; }
+
+	/// <summary>
+	/// D3D12のオブジェクトを描画コマンド用のハンドルにする
+	/// </summary>
+	static RenderPipeline* Wrap(ID3D12PipelineState* pipelineState) {
+		return reinterpret_cast<RenderPipeline*>(pipelineState);
+	}
+	static RenderRootSignature* Wrap(ID3D12RootSignature* rootSignature) {
+		return reinterpret_cast<RenderRootSignature*>(rootSignature);
+	}
+	static RenderDescriptorHeap* Wrap(ID3D12DescriptorHeap* descriptorHeap) {
+		return reinterpret_cast<RenderDescriptorHeap*>(descriptorHeap);
+	}
+	static RenderCommandSignature* Wrap(ID3D12CommandSignature* commandSignature) {
+		return reinterpret_cast<RenderCommandSignature*>(commandSignature);
+	}
+	static RenderBuffer* Wrap(ID3D12Resource* resource) {
+		return reinterpret_cast<RenderBuffer*>(resource);
+	}
+
+	/// <summary>
+	/// D3D12のビューを描画コマンド用のビューにする
+	/// </summary>
+	static RenderVertexBufferView Wrap(const D3D12_VERTEX_BUFFER_VIEW& view);
+	static RenderIndexBufferView Wrap(const D3D12_INDEX_BUFFER_VIEW& view);
+
+	void SetPipelineState(RenderPipeline* pipeline) override;
+	void SetGraphicsRootSignature(RenderRootSignature* rootSignature) override;
+	void SetPrimitiveTopology(RenderTopology topology) override;
+	void SetVertexBuffers(
+	  uint32_t startSlot, uint32_t count, const RenderVertexBufferView* views) override;
+	void SetIndexBuffer(const RenderIndexBufferView& view) override;
+	void SetDescriptorHeap(RenderDescriptorHeap* descriptorHeap) override;
+	void SetGraphicsRootConstantBufferView(uint32_t rootParamIndex, uint64_t address) override;
+	void SetGraphicsRootShaderResourceView(uint32_t rootParamIndex, uint64_t address) override;
+	void SetGraphicsRootDescriptorTable(uint32_t rootParamIndex, uint64_t gpuDescriptor) override;
+	void SetGraphicsRoot32BitConstants(
+	  uint32_t rootParamIndex, uint32_t count, const void* data, uint32_t offset) override;
+	void DrawInstanced(
+	  uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex,
+	  uint32_t startInstance) override;
+	void DrawIndexedInstanced(
+	  uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+	  uint32_t startInstance) override;
+	void ExecuteIndirect(
+	  RenderCommandSignature* signature, uint32_t maxCommandCount, RenderBuffer* argumentBuffer,
+	  uint64_t argumentOffset, RenderBuffer* countBuffer, uint64_t countOffset) override;
+
+  private:
+	// 1回に設定できる頂点バッファの数
+	static const uint32_t kMaxVertexBuffers = D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT;
+
+	// 発行先のコマンドリスト
+	ID3D12GraphicsCommandList* commandList_ = nullptr;
+};
@@ -10,20 +10,44 @@
 
 using namespace Microsoft::WRL;
 
+const uint32_t DirectXCommon::kMaxFrameCount;
+const uint32_t DirectXCommon::kDefaultFrameCount;
+
+namespace {
+// フレーム間隔の移動平均の重み
+const double kFrameIntervalSmoothing = 0.1;
+
+// 経過時間（ミリ秒）
+double ElapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+	  .count();
+}
+} // namespace
+
 DirectXCommon* DirectXCommon::GetInstance() {
 	static DirectXCommon instance;
 	return &instance;
 }
 
-void DirectXCommon::Initialize(WinApp* winApp, int32_t backBufferWidth, int32_t backBufferHeight) {
+DirectXCommon::~DirectXCommon() {
+	if (fenceEvent_) {
+		CloseHandle(fenceEvent_);
+	}
+}
+
+void DirectXCommon::Initialize(
+  WinApp* winApp, int32_t backBufferWidth, int32_t backBufferHeight, uint32_t frameCount) {
 	// nullptrチェック
 	assert(winApp);
 	assert(4 <= backBufferWidth && backBufferWidth <= 4096);
 	assert(4 <= backBufferHeight && backBufferHeight <= 4096);
+	assert(1 <= frameCount && frameCount <= kMaxFrameCount);
 
 	winApp_ = winApp;
 	backBufferWidth_ = backBufferWidth;
 	backBufferHeight_ = backBufferHeight;
+	frameCount_ = frameCount;
+	frameIndex_ = 0;
 
 	// DXGIデバイス初期化
 	InitializeDXGIDevice();
@@ -54,28 +78,14 @@ void DirectXCommon::PreDraw() {
 	  D3D12_RESOURCE_STATE_RENDER_TARGET);
 	commandList_->ResourceBarrier(1, &barrier);
 
-	// レンダーターゲットビュー用ディスクリプタヒープのハンドルを取得
-	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvH = CD3DX12_CPU_DESCRIPTOR_HANDLE(
-	  rtvHeap_->GetCPUDescriptorHandleForHeapStart(), bbIndex,
-	  device_->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV));
-	// 深度ステンシルビュー用デスクリプタヒープのハンドルを取得
-	CD3DX12_CPU_DESCRIPTOR_HANDLE dsvH =
-	  CD3DX12_CPU_DESCRIPTOR_HANDLE(dsvHeap_->GetCPUDescriptorHandleForHeapStart());
-	// レンダーターゲットをセット
-	commandList_->OMSetRenderTargets(1, &rtvH, false, &dsvH);
+	// レンダーターゲットとビューポートをセット
+	SetRenderTarget(commandList_.Get());
+	renderTargetBound_ = true;
 
 	// 全画面クリア
 	ClearRenderTarget();
 	// 深度バッファクリア
 	ClearDepthBuffer();
-
-	// ビューポートの設定
-	CD3DX12_VIEWPORT viewport =
-	  CD3DX12_VIEWPORT(0.0f, 0.0f, float(backBufferWidth_), float(backBufferHeight_));
-	commandList_->RSSetViewports(1, &viewport);
-	// シザリング矩形の設定
-	CD3DX12_RECT rect = CD3DX12_RECT(0, 0, backBufferWidth_, backBufferHeight_);
-	commandList_->RSSetScissorRects(1, &rect);
 }
 
 void DirectXCommon::PostDraw() {
@@ -91,12 +101,16 @@ void DirectXCommon::PostDraw() {
 	// 命令のクローズ
 	commandList_->Close();
 
-	// コマンドリストの実行
-	ID3D12CommandList* cmdLists[] = {commandList_.Get()}; // コマンドリストの配列
-	commandQueue_->ExecuteCommandLists(1, cmdLists);
+	// 挟み込んだものも含めて記録順にまとめて実行
+	submitLists_.push_back(commandList_.Get());
+	commandQueue_->ExecuteCommandLists(
+	  static_cast<UINT>(submitLists_.size()), submitLists_.data());
+	submitLists_.clear();
 
 	// バッファをフリップ
+	std::chrono::steady_clock::time_point presentStart = std::chrono::steady_clock::now();
 	result = swapChain_->Present(1, 0);
+	frameStats_.presentTime = ElapsedMilliseconds(presentStart);
 #ifdef _DEBUG
 	if (FAILED(result)) {
 		ComPtr<ID3D12DeviceRemovedExtendedData> dred;
@@ -111,20 +125,114 @@ void DirectXCommon::PostDraw() {
 	}
 #endif
 
-	// コマンドリストの実行完了を待つ
+	// このフレームのコマンドの完了を示す値をシグナル
 	commandQueue_->Signal(fence_.Get(), ++fenceVal_);
-	if (fence_->GetCompletedValue() != fenceVal_) {
-		HANDLE event = CreateEvent(nullptr, false, false, nullptr);
-		fence_->SetEventOnCompletion(fenceVal_, event);
-		WaitForSingleObject(event, INFINITE);
-		CloseHandle(event);
+	frames_[frameIndex_].fenceValue = fenceVal_;
+
+	// 統計
+	frameStats_.framesInFlight = fenceVal_ - fence_->GetCompletedValue();
+	frameStats_.frameNumber++;
+	frames_[frameIndex_].frameNumber = frameStats_.frameNumber;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (1 < frameStats_.frameNumber) {
+		frameStats_.frameInterval =
+		  std::chrono::duration<double, std::milli>(now - lastPostDrawTime_).count();
+		double weight = frameStats_.frameNumber == 2 ? 1.0 : kFrameIntervalSmoothing;
+		frameStats_.averageFrameInterval +=
+		  (frameStats_.frameInterval - frameStats_.averageFrameInterval) * weight;
 	}
-
-	commandAllocator_->Reset(); // キューをクリア
-	commandList_->Reset(commandAllocator_.Get(),
+	lastPostDrawTime_ = now;
+
+	// 次のフレームの領域を前回使ったコマンドの完了だけを待つ（直前のフレームはGPUで実行させたまま）
+	frameIndex_ = (frameIndex_ + 1) % frameCount_;
+	FrameContext& frame = frames_[frameIndex_];
+	std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+	WaitForFenceValue(frame.fenceValue);
+	frameStats_.gpuWaitTime = ElapsedMilliseconds(waitStart);
+	completedFrameNumber_ = (std::max)(completedFrameNumber_, frame.frameNumber);
+
+	// 前回このフレームで解放を頼まれたものは、もうGPUから参照されない
+	frame.pendingReleases.clear();
+
+	frame.commandAllocator->Reset(); // キューをクリア
+	segmentIndex_ = 0;
+	renderTargetBound_ = false;
+	commandList_ = segmentLists_[0];
+	commandList_->Reset(frame.commandAllocator.Get(),
 	                    nullptr); // 再びコマンドリストを貯める準備
 }
 
+void DirectXCommon::WaitForGpu() {
+	commandQueue_->Signal(fence_.Get(), ++fenceVal_);
+	WaitForFenceValue(fenceVal_);
+	completedFrameNumber_ = frameStats_.frameNumber;
+
+	// 記録中のフレーム以外の解放待ちは全て解放できる
+	for (uint32_t i = 0; i < frameCount_; i++) {
+		if (i != frameIndex_) {
+			frames_[i].pendingReleases.clear();
+		}
+	}
+}
+
+void DirectXCommon::DeferRelease(ComPtr<ID3D12Pageable> object) {
+	if (object) {
+		frames_[frameIndex_].pendingReleases.push_back(std::move(object));
+	}
+}
+
+void DirectXCommon::InsertCommandLists(
+  ID3D12GraphicsCommandList* const* commandLists, uint32_t count) {
+	assert(commandLists || count == 0);
+
+	// ここまでの記録を区切って、挟むものと一緒に提出待ちにする
+	commandList_->Close();
+	submitLists_.push_back(commandList_.Get());
+	submitLists_.insert(submitLists_.end(), commandLists, commandLists + count);
+
+	// 続きは同じアロケータで別のコマンドリストに記録する（閉じたものはGPUの完了前でも記録し直せる）
+	ID3D12CommandAllocator* allocator = frames_[frameIndex_].commandAllocator.Get();
+	segmentIndex_++;
+	if (segmentIndex_ == segmentLists_.size()) {
+		ComPtr<ID3D12GraphicsCommandList> segmentList;
+		HRESULT result = device_->CreateCommandList(
+		  0, D3D12_COMMAND_LIST_TYPE_DIRECT, allocator, nullptr, IID_PPV_ARGS(&segmentList));
+		assert(SUCCEEDED(result));
+		segmentLists_.push_back(segmentList);
+	} else {
+		segmentLists_[segmentIndex_]->Reset(allocator, nullptr);
+	}
+	commandList_ = segmentLists_[segmentIndex_];
+
+	// 描画先は引き継ぐ
+	if (renderTargetBound_) {
+		SetRenderTarget(commandList_.Get());
+	}
+}
+
+void DirectXCommon::SetRenderTarget(ID3D12GraphicsCommandList* commandList) {
+	assert(commandList);
+	UINT bbIndex = swapChain_->GetCurrentBackBufferIndex();
+
+	// レンダーターゲットビュー用ディスクリプタヒープのハンドルを取得
+	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvH = CD3DX12_CPU_DESCRIPTOR_HANDLE(
+	  rtvHeap_->GetCPUDescriptorHandleForHeapStart(), bbIndex,
+	  device_->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV));
+	// 深度ステンシルビュー用デスクリプタヒープのハンドルを取得
+	CD3DX12_CPU_DESCRIPTOR_HANDLE dsvH =
+	  CD3DX12_CPU_DESCRIPTOR_HANDLE(dsvHeap_->GetCPUDescriptorHandleForHeapStart());
+	// レンダーターゲットをセット
+	commandList->OMSetRenderTargets(1, &rtvH, false, &dsvH);
+
+	// ビューポートの設定
+	CD3DX12_VIEWPORT viewport =
+	  CD3DX12_VIEWPORT(0.0f, 0.0f, float(backBufferWidth_), float(backBufferHeight_));
+	commandList->RSSetViewports(1, &viewport);
+	// シザリング矩形の設定
+	CD3DX12_RECT rect = CD3DX12_RECT(0, 0, backBufferWidth_, backBufferHeight_);
+	commandList->RSSetScissorRects(1, &rect);
+}
+
 void DirectXCommon::ClearRenderTarget() {
 	UINT bbIndex = swapChain_->GetCurrentBackBufferIndex();
 
@@ -262,7 +370,7 @@ void DirectXCommon::CreateSwapChain() {
 	swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM; // 色情報の書式を一般的なものに
 	swapChainDesc.SampleDesc.Count = 1;                // マルチサンプルしない
 	swapChainDesc.BufferUsage = DXGI_USAGE_BACK_BUFFER; // バックバッファとして使えるように
-	swapChainDesc.BufferCount = 2;                      // バッファ数を２つに設定
+	swapChainDesc.BufferCount = (std::max)(frameCount_, 2u); // 同時処理フレーム数ぶん（最低２つ）
 	swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD; // フリップ後は速やかに破棄
 	swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING; // ティアリングサポート
 	ComPtr<IDXGISwapChain1> swapChain1;
@@ -283,16 +391,20 @@ void DirectXCommon::CreateSwapChain() {
 void DirectXCommon::InitializeCommand() {
 	HRESULT result = S_FALSE;
 
-	// コマンドアロケータを生成
-	result = device_->CreateCommandAllocator(
-	  D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator_));
-	assert(SUCCEEDED(result));
+	// フレームごとにコマンドアロケータを生成
+	for (uint32_t i = 0; i < frameCount_; i++) {
+		result = device_->CreateCommandAllocator(
+		  D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&frames_[i].commandAllocator));
+		assert(SUCCEEDED(result));
+	}
+	commandAllocator_ = frames_[0].commandAllocator;
 
 	// コマンドリストを生成
 	result = device_->CreateCommandList(
-	  0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator_.Get(), nullptr,
+	  0, D3D12_COMMAND_LIST_TYPE_DIRECT, frames_[frameIndex_].commandAllocator.Get(), nullptr,
 	  IID_PPV_ARGS(&commandList_));
 	assert(SUCCEEDED(result));
+	segmentLists_.assign(1, commandList_);
 
 	// 標準設定でコマンドキューを生成
 	D3D12_COMMAND_QUEUE_DESC cmdQueueDesc{};
@@ -373,4 +485,15 @@ void DirectXCommon::CreateFence() {
 	// フェンスの生成
 	result = device_->CreateFence(fenceVal_, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence_));
 	assert(SUCCEEDED(result));
+
+	// 待ち合わせ用のイベント
+	fenceEvent_ = CreateEvent(nullptr, false, false, nullptr);
+	assert(fenceEvent_);
+}
+
+void DirectXCommon::WaitForFenceValue(UINT64 fenceValue) {
+	if (fence_->GetCompletedValue() < fenceValue) {
+		fence_->SetEventOnCompletion(fenceValue, fenceEvent_);
+		WaitForSingleObject(fenceEvent_, INFINITE);
+	}
 }
@@ -1,18 +1,41 @@
 ﻿#pragma once
 
 #include <Windows.h>
+#include <chrono>
 #include <cstdlib>
 #include <d3d12.h>
 #include <d3dx12.h>
 #include <dxgi1_6.h>
+#include <vector>
 #include <wrl.h>
 
 #include "WinApp.h"
 
 /// <summary>
 /// DirectX汎用
+/// （既定では提出したフレームの完了を待つ。同時処理フレーム数を2以上にすると、GPUが前のフレームを
+///   実行している間に次のフレームを記録するが、ライブラリの定数バッファは1つずつしかないので、
+///   毎フレーム書き換えるものをフレームごとに複製した場合だけ指定する）
 /// </summary>
 class DirectXCommon {
+  public: // 定数
+	// 同時処理フレーム数の上限
+	static const uint32_t kMaxFrameCount = 3;
+	// 既定の同時処理フレーム数（重ねて処理するのは明示的に指定したときだけ）
+	static const uint32_t kDefaultFrameCount = 1;
+
+	/// <summary>
+	/// フレームの統計（ミリ秒）
+	/// </summary>
+	struct FrameStats {
+		double frameInterval = 0.0;        // 前のフレームのPostDrawからの間隔
+		double averageFrameInterval = 0.0; // 間隔の移動平均
+		double presentTime = 0.0;          // Presentにかかった時間
+		double gpuWaitTime = 0.0;          // フレームの空きをGPUの完了まで待った時間
+		uint64_t framesInFlight = 0;       // 提出直後にGPUが未完了のフレーム数
+		uint64_t frameNumber = 0;          // 提出したフレーム数
+	};
+
   public: // メンバ関数
 
 	/// <summary>
@@ -26,7 +49,7 @@ class DirectXCommon {
 	/// </summary>
 	void Initialize(
 	  WinApp* win, int32_t backBufferWidth = WinApp::kWindowWidth,
-	  int32_t backBufferHeight = WinApp::kWindowHeight);
+	  int32_t backBufferHeight = WinApp::kWindowHeight, uint32_t frameCount = kDefaultFrameCount);
 
 	/// <summary>
 	/// 描画前処理
@@ -34,10 +57,36 @@ class DirectXCommon {
 	void PreDraw();
 
 	/// <summary>
-	/// 描画後処理
+	/// 描画後処理（提出して次のフレームの空きを待つ。同時処理フレーム数が1ならGPUの完了まで待つ）
 	/// </summary>
 	void PostDraw();
 
+	/// <summary>
+	/// GPUの処理が全て終わるまで待つ（パイプラインの作り直しなど、参照中のオブジェクトを差し替える前に使う）
+	/// </summary>
+	void WaitForGpu();
+
+	/// <summary>
+	/// 記録中のフレームのGPU処理が終わってから解放する
+	/// </summary>
+	/// <param name="object">解放するオブジェクト</param>
+	void DeferRelease(Microsoft::WRL::ComPtr<ID3D12Pageable> object);
+
+	/// <summary>
+	/// 記録済みのコマンドリストを、ここまで描画コマンドリストに記録した内容の後に実行されるように挟む
+	/// （描画コマンドリストは続きを記録する別のものに切り替わるので、GetCommandListで取り直す。
+	///   PreDraw後ならバックバッファの設定は引き継ぐが、パイプラインなどは設定し直す）
+	/// </summary>
+	/// <param name="commandLists">閉じたコマンドリストの配列（実行順）</param>
+	/// <param name="count">コマンドリスト数</param>
+	void InsertCommandLists(ID3D12GraphicsCommandList* const* commandLists, uint32_t count);
+
+	/// <summary>
+	/// バックバッファを描画先に設定する（クリアはしない。別スレッドで記録するコマンドリスト用）
+	/// </summary>
+	/// <param name="commandList">コマンドリスト</param>
+	void SetRenderTarget(ID3D12GraphicsCommandList* commandList);
+
 	/// <summary>
 	/// レンダーターゲットのクリア
 	/// </summary>
@@ -60,6 +109,49 @@ class DirectXCommon {
 	/// <returns>描画コマンドリスト</returns>
 	ID3D12GraphicsCommandList* GetCommandList() { return commandList_.Get(); }
 
+	/// <summary>
+	/// 最後にシグナルしたフェンス値の取得
+	/// </summary>
+	/// <returns>フェンス値</returns>
+	UINT64 GetFenceValue() const { return fenceVal_; }
+
+	/// <summary>
+	/// GPUが完了したフェンス値の取得
+	/// </summary>
+	/// <returns>フェンス値</returns>
+	UINT64 GetCompletedFenceValue() const { return fence_->GetCompletedValue(); }
+
+	/// <summary>
+	/// 同時処理フレーム数の取得
+	/// </summary>
+	/// <returns>同時処理フレーム数</returns>
+	uint32_t GetFrameCount() const { return frameCount_; }
+
+	/// <summary>
+	/// 記録中のフレーム番号の取得（0～GetFrameCount()-1。フレームごとの複製を選ぶのに使う）
+	/// </summary>
+	/// <returns>フレーム番号</returns>
+	uint32_t GetFrameIndex() const { return frameIndex_; }
+
+	/// <summary>
+	/// 記録中のフレームの通し番号の取得（1から数える）
+	/// </summary>
+	/// <returns>通し番号</returns>
+	uint64_t GetFrameNumber() const { return frameStats_.frameNumber + 1; }
+
+	/// <summary>
+	/// GPUの処理が終わったフレームの通し番号の取得
+	/// （この番号以前のフレームで参照したデスクリプタやテクスチャは書き換えてよい）
+	/// </summary>
+	/// <returns>通し番号</returns>
+	uint64_t GetCompletedFrameNumber() const { return completedFrameNumber_; }
+
+	/// <summary>
+	/// フレームの統計の取得
+	/// </summary>
+	/// <returns>フレームの統計</returns>
+	const FrameStats& GetFrameStats() const { return frameStats_; }
+
 	/// <summary>
 	/// バックバッファの幅取得
 	/// </summary>
@@ -92,9 +184,36 @@ class DirectXCommon {
 	int32_t backBufferWidth_ = 0;
 	int32_t backBufferHeight_ = 0;
 
+	// フレームごとのコマンドアロケータと解放待ちのオブジェクト
+	// （ライブラリ側がインラインの取得関数で上のメンバを参照するので、メンバは後ろに足す）
+	struct FrameContext {
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> commandAllocator;
+		// このフレームのコマンドの完了を示すフェンス値と、フレームの通し番号
+		UINT64 fenceValue = 0;
+		uint64_t frameNumber = 0;
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Pageable>> pendingReleases;
+	};
+	FrameContext frames_[kMaxFrameCount];
+	uint32_t frameCount_ = kDefaultFrameCount;
+	uint32_t frameIndex_ = 0;
+	// GPUの処理が終わったフレームの通し番号
+	uint64_t completedFrameNumber_ = 0;
+	// フェンス待ち用のイベント
+	HANDLE fenceEvent_ = nullptr;
+	// 統計
+	FrameStats frameStats_;
+	std::chrono::steady_clock::time_point lastPostDrawTime_;
+	// 挟み込みで区切った描画コマンドリスト（0番が最初のもの。同じアロケータで順に記録する）
+	std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> segmentLists_;
+	uint32_t segmentIndex_ = 0;
+	// このフレームで提出するコマンドリスト（実行順）
+	std::vector<ID3D12CommandList*> submitLists_;
+	// PreDrawでバックバッファを設定済みか
+	bool renderTargetBound_ = false;
+
   private: // メンバ関数
 	DirectXCommon() = default;
-	~DirectXCommon() = default;
+	~DirectXCommon();
 	DirectXCommon(const DirectXCommon&) = delete;
 	const DirectXCommon& operator=(const DirectXCommon&) = delete;
 		   
@@ -127,4 +246,9 @@ class DirectXCommon {
 	/// フェンス生成
 	/// </summary>
 	void CreateFence();
+
+	/// <summary>
+	/// フェンス値に達するまで待つ
+	/// </summary>
+	void WaitForFenceValue(UINT64 fenceValue);
 };
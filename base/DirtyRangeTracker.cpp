@@ -0,0 +1,74 @@
+﻿#include "DirtyRangeTracker.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+void DirtyRangeTracker::Resize(uint32_t count) {
+	uint32_t oldCount = GetCount();
+	if (count < oldCount) {
+		// 範囲外になった記録を捨てる
+		dirtyIndices_.erase(
+		  std::remove_if(
+		    dirtyIndices_.begin(), dirtyIndices_.end(),
+		    [count](uint32_t index) { return count <= index; }),
+		  dirtyIndices_.end());
+		flags_.resize(count);
+		return;
+	}
+	flags_.resize(count, 0);
+	for (uint32_t i = oldCount; i < count; i++) {
+		Mark(i);
+	}
+}
+
+void DirtyRangeTracker::Mark(uint32_t index) {
+	assert(index < GetCount());
+	if (allDirty_ || flags_[index]) {
+		return;
+	}
+	flags_[index] = 1;
+	dirtyIndices_.push_back(index);
+}
+
+void DirtyRangeTracker::MarkAll() {
+	allDirty_ = true;
+	std::fill(flags_.begin(), flags_.end(), static_cast<uint8_t>(0));
+	dirtyIndices_.clear();
+}
+
+void DirtyRangeTracker::TakeRanges(std::vector<Range>& ranges, uint32_t mergeGap) {
+	ranges.clear();
+
+	if (allDirty_) {
+		allDirty_ = false;
+		if (!flags_.empty()) {
+			ranges.push_back({0, GetCount()});
+		}
+		return;
+	}
+
+	// 番号順に並べて、連続する（または間が狭い）ものを1つの範囲にまとめる
+	std::sort(dirtyIndices_.begin(), dirtyIndices_.end());
+	for (uint32_t index : dirtyIndices_) {
+		flags_[index] = 0;
+		if (!ranges.empty() && index - ranges.back().end <= mergeGap) {
+			ranges.back().end = index + 1;
+		} else {
+			ranges.push_back({index, index + 1});
+		}
+	}
+	dirtyIndices_.clear();
+}
+
+size_t DirtyRangeTracker::CopyRanges(
+  const std::vector<Range>& ranges, size_t stride, const void* source, void* dest) {
+	const uint8_t* src = static_cast<const uint8_t*>(source);
+	uint8_t* dst = static_cast<uint8_t*>(dest);
+	size_t copiedBytes = 0;
+	for (const Range& range : ranges) {
+		size_t size = stride * (range.end - range.begin);
+		memcpy(dst + stride * range.begin, src + stride * range.begin, size);
+		copiedBytes += size;
+	}
+	return copiedBytes;
+}
@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 変更された要素の記録（連続する変更をまとめた範囲で取り出し、その範囲だけを転送できるようにする）
+/// （取り出しの手間は変更された要素数に比例し、全体の要素数には依存しない）
+/// </summary>
+class DirtyRangeTracker {
+  public:
+	/// <summary>
+	/// 変更範囲（[begin, end)）
+	/// </summary>
+	struct Range {
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	/// <summary>
+	/// 要素数の変更（増えた要素は変更済みとして扱う）
+	/// </summary>
+	/// <param name="count">要素数</param>
+	void Resize(uint32_t count);
+
+	/// <summary>
+	/// 変更を記録
+	/// </summary>
+	/// <param name="index">要素番号</param>
+	void Mark(uint32_t index);
+
+	/// <summary>
+	/// 全要素の変更を記録
+	/// </summary>
+	void MarkAll();
+
+	/// <summary>
+	/// 変更範囲を取り出して記録を消す
+	/// </summary>
+	/// <param name="ranges">変更範囲（要素番号の昇順）</param>
+	/// <param name="mergeGap">この数以下の未変更要素を挟む範囲は1つにまとめる</param>
+	void TakeRanges(std::vector<Range>& ranges, uint32_t mergeGap = 0);
+
+	/// <summary>
+	/// 変更範囲の要素を転送先へ複写する
+	/// </summary>
+	/// <param name="ranges">変更範囲</param>
+	/// <param name="stride">要素の大きさ</param>
+	/// <param name="source">転送元の先頭</param>
+	/// <param name="dest">転送先の先頭（転送元と同じ並び）</param>
+	/// <returns>複写したバイト数</returns>
+	static size_t CopyRanges(
+	  const std::vector<Range>& ranges, size_t stride, const void* source, void* dest);
+
+	/// <summary>
+	/// 立っているビットの連続する範囲ごとに呼ぶ（要素数が32以下の記録用）
+	/// </summary>
+	/// <param name="bits">要素ごとの変更ビット</param>
+	/// <param name="func">func(begin, end)で[begin, end)を受け取る</param>
+	template<class Func> static void ForEachBitRange(uint32_t bits, Func func) {
+		uint32_t index = 0;
+		while (bits != 0) {
+			while ((bits & 1) == 0) {
+				bits >>= 1;
+				index++;
+			}
+			uint32_t begin = index;
+			while ((bits & 1) != 0) {
+				bits >>= 1;
+				index++;
+			}
+			func(begin, index);
+		}
+	}
+
+	bool IsDirty() const { return allDirty_ || !dirtyIndices_.empty(); }
+	uint32_t GetCount() const { return static_cast<uint32_t>(flags_.size()); }
+
+  private:
+	// 要素ごとの変更フラグ
+	std::vector<uint8_t> flags_;
+	// 変更された要素番号（記録順）
+	std::vector<uint32_t> dirtyIndices_;
+	// 全要素が変更済み
+	bool allDirty_ = false;
+};
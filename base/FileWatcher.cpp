@@ -0,0 +1,119 @@
+﻿#include "FileWatcher.h"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+// 書き込み途中のファイルを拾わないように、変更通知から走査までに待つ時間（ミリ秒）
+const DWORD kSettleTime = 50;
+} // namespace
+
+FileWatcher::~FileWatcher() { Stop(); }
+
+void FileWatcher::Start(const std::string& directoryPath, uint32_t pollInterval) {
+	assert(!thread_.joinable());
+
+	directoryPath_ = directoryPath;
+	pollInterval_ = pollInterval;
+	stopEvent_ = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+	assert(stopEvent_);
+
+	thread_ = std::thread([this]() { ThreadMain(); });
+}
+
+void FileWatcher::Stop() {
+	if (!thread_.joinable()) {
+		return;
+	}
+
+	SetEvent(stopEvent_);
+	thread_.join();
+	CloseHandle(stopEvent_);
+	stopEvent_ = nullptr;
+}
+
+std::vector<std::string> FileWatcher::PopChanges() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::vector<std::string> changes;
+	changes.swap(changes_);
+	return changes;
+}
+
+void FileWatcher::ThreadMain() {
+	// 開始時点の状態を基準にする
+	std::unordered_map<std::string, uint64_t> snapshot;
+	Scan("", snapshot);
+
+	// サブディレクトリも含めた変更通知（使えなければポーリングのみ）
+	HANDLE notification = FindFirstChangeNotificationA(
+	  directoryPath_.c_str(), TRUE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+	bool hasNotification = notification != INVALID_HANDLE_VALUE;
+
+	for (;;) {
+		DWORD waitResult;
+		if (hasNotification) {
+			HANDLE handles[] = {stopEvent_, notification};
+			waitResult = WaitForMultipleObjects(_countof(handles), handles, FALSE, pollInterval_);
+		} else {
+			waitResult = WaitForSingleObject(stopEvent_, pollInterval_);
+		}
+		if (waitResult == WAIT_OBJECT_0) {
+			break;
+		}
+		if (hasNotification && waitResult == WAIT_OBJECT_0 + 1) {
+			Sleep(kSettleTime);
+			FindNextChangeNotification(notification);
+		}
+
+		// 前回の状態と比べて更新日時が変わったファイルを集める
+		std::unordered_map<std::string, uint64_t> current;
+		Scan("", current);
+
+		std::vector<std::string> changed;
+		for (const auto& file : current) {
+			auto it = snapshot.find(file.first);
+			if (it == snapshot.end() || it->second != file.second) {
+				changed.push_back(file.first);
+			}
+		}
+		snapshot.swap(current);
+
+		if (!changed.empty()) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (std::string& path : changed) {
+				if (std::find(changes_.begin(), changes_.end(), path) == changes_.end()) {
+					changes_.push_back(std::move(path));
+				}
+			}
+		}
+	}
+
+	if (hasNotification) {
+		FindCloseChangeNotification(notification);
+	}
+}
+
+void FileWatcher::Scan(
+  const std::string& relativePath, std::unordered_map<std::string, uint64_t>& snapshot) {
+	WIN32_FIND_DATAA findData;
+	std::string pattern = directoryPath_ + relativePath + "*";
+	HANDLE find = FindFirstFileA(pattern.c_str(), &findData);
+	if (find == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	do {
+		std::string name = findData.cFileName;
+		if (name == "." || name == "..") {
+			continue;
+		}
+		if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			Scan(relativePath + name + "/", snapshot);
+		} else {
+			uint64_t writeTime = (static_cast<uint64_t>(findData.ftLastWriteTime.dwHighDateTime) << 32) |
+			                     findData.ftLastWriteTime.dwLowDateTime;
+			snapshot[relativePath + name] = writeTime;
+		}
+	} while (FindNextFileA(find, &findData));
+
+	FindClose(find);
+}
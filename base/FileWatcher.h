@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include <Windows.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// ディレクトリ以下のファイル変更監視
+/// （変更通知が使えない環境では一定間隔のポーリングで代用する）
+/// </summary>
+class FileWatcher {
+  public:
+	// ポーリング間隔の既定値（ミリ秒）
+	static const uint32_t kDefaultPollInterval = 500;
+
+	/// <summary>
+	/// デストラクタ
+	/// </summary>
+	~FileWatcher();
+
+	/// <summary>
+	/// 監視開始
+	/// </summary>
+	/// <param name="directoryPath">監視するディレクトリ（末尾は'/'）</param>
+	/// <param name="pollInterval">ポーリング間隔（ミリ秒）</param>
+	void Start(const std::string& directoryPath, uint32_t pollInterval = kDefaultPollInterval);
+
+	/// <summary>
+	/// 監視終了
+	/// </summary>
+	void Stop();
+
+	/// <summary>
+	/// 前回呼び出し以降に変更されたファイルの取り出し
+	/// </summary>
+	/// <returns>監視ディレクトリからの相対パス（区切りは'/'）</returns>
+	std::vector<std::string> PopChanges();
+
+  private:
+	/// <summary>
+	/// 監視スレッドの処理
+	/// </summary>
+	void ThreadMain();
+
+	/// <summary>
+	/// ディレクトリ以下の全ファイルの更新日時を集める
+	/// </summary>
+	/// <param name="relativePath">監視ディレクトリからの相対パス</param>
+	/// <param name="snapshot">格納先</param>
+	void Scan(const std::string& relativePath, std::unordered_map<std::string, uint64_t>& snapshot);
+
+	// 監視ディレクトリ
+	std::string directoryPath_;
+	// ポーリング間隔
+	uint32_t pollInterval_ = kDefaultPollInterval;
+	// 監視スレッド
+	std::thread thread_;
+	// 終了通知イベント
+	HANDLE stopEvent_ = nullptr;
+	// 変更されたファイル
+	std::vector<std::string> changes_;
+	// 変更リスト保護用
+	std::mutex mutex_;
+};
@@ -0,0 +1,121 @@
+﻿#include "FramePageAllocator.h"
+#include <cassert>
+
+void FramePageAllocator::Initialize(uint32_t frameCount, uint64_t pageSize) {
+	assert(0 < frameCount);
+	assert(0 < pageSize);
+
+	pageSize_ = pageSize;
+	pages_.clear();
+	freePages_.clear();
+	frames_.clear();
+	frames_.resize(frameCount);
+	frameIndex_ = 0;
+}
+
+void FramePageAllocator::BeginFrame(
+  uint64_t completedFenceValue, std::vector<uint32_t>& releasedPages) {
+	releasedPages.clear();
+	frameIndex_ = (frameIndex_ + 1) % static_cast<uint32_t>(frames_.size());
+	Frame& frame = frames_[frameIndex_];
+
+	// 前回このフレームの領域を使ったコマンドが完了していれば丸ごと再利用できる
+	assert(frame.fenceValue <= completedFenceValue);
+	(void)completedFenceValue;
+
+	for (uint32_t page : frame.pages) {
+		pages_[page].allocator.Reset();
+	}
+	frame.currentPage = 0;
+
+	for (uint32_t page : frame.largePages) {
+		pages_[page].isFree = true;
+		pages_[page].allocator.Initialize(0);
+		freePages_.push_back(page);
+		releasedPages.push_back(page);
+	}
+	frame.largePages.clear();
+}
+
+void FramePageAllocator::EndFrame(uint64_t fenceValue) {
+	frames_[frameIndex_].fenceValue = fenceValue;
+}
+
+uint64_t FramePageAllocator::GetRequiredFenceValue() const {
+	return frames_[(frameIndex_ + 1) % frames_.size()].fenceValue;
+}
+
+FramePageAllocator::Allocation FramePageAllocator::Allocate(uint64_t size, uint64_t alignment) {
+	assert(!frames_.empty());
+	Frame& frame = frames_[frameIndex_];
+
+	Allocation allocation;
+
+	// ページに収まらない大きさは専用のページを作る
+	if (pageSize_ < size) {
+		allocation.page = NewPage(size);
+		allocation.offset = pages_[allocation.page].allocator.Allocate(size, alignment);
+		allocation.isNewPage = true;
+		frame.largePages.push_back(allocation.page);
+		return allocation;
+	}
+
+	// 今のページに入らなければ次のページへ（足りなければ増やす）
+	if (frame.pages.empty()) {
+		frame.pages.push_back(NewPage(pageSize_));
+		allocation.isNewPage = true;
+	}
+	uint64_t offset = pages_[frame.pages[frame.currentPage]].allocator.Allocate(size, alignment);
+	while (offset == LinearAllocator::kInvalidOffset) {
+		frame.currentPage++;
+		if (frame.currentPage == frame.pages.size()) {
+			frame.pages.push_back(NewPage(pageSize_));
+			allocation.isNewPage = true;
+		}
+		offset = pages_[frame.pages[frame.currentPage]].allocator.Allocate(size, alignment);
+	}
+
+	allocation.page = frame.pages[frame.currentPage];
+	allocation.offset = offset;
+	return allocation;
+}
+
+uint64_t FramePageAllocator::GetUsedBytes() const {
+	const Frame& frame = frames_[frameIndex_];
+	uint64_t used = 0;
+	for (uint32_t page : frame.pages) {
+		used += pages_[page].allocator.GetUsed();
+	}
+	for (uint32_t page : frame.largePages) {
+		used += pages_[page].allocator.GetUsed();
+	}
+	return used;
+}
+
+uint64_t FramePageAllocator::GetReservedBytes() const {
+	uint64_t reserved = 0;
+	for (const Page& page : pages_) {
+		if (!page.isFree) {
+			reserved += page.allocator.GetCapacity();
+		}
+	}
+	return reserved;
+}
+
+uint32_t FramePageAllocator::GetPageCount() const {
+	return static_cast<uint32_t>(pages_.size() - freePages_.size());
+}
+
+uint32_t FramePageAllocator::NewPage(uint64_t capacity) {
+	uint32_t page = 0;
+	if (!freePages_.empty()) {
+		page = freePages_.back();
+		freePages_.pop_back();
+	} else {
+		page = static_cast<uint32_t>(pages_.size());
+		pages_.emplace_back();
+	}
+	pages_[page].isFree = false;
+	pages_[page].allocator.Initialize(capacity);
+	return page;
+}
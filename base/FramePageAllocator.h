@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include "LinearAllocator.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// フレームごとのページ割り当て
+/// （FrameUploadAllocatorのページ管理部分。バッファは持たずページ番号とオフセットだけを扱うので、
+/// 　フェンスによる再利用をGPU無しで検証できる）
+/// </summary>
+class FramePageAllocator {
+  public:
+	/// <summary>
+	/// 確保結果
+	/// </summary>
+	struct Allocation {
+		// ページ番号
+		uint32_t page = 0;
+		// ページ内の位置
+		uint64_t offset = 0;
+		// 新しく作った（または解放済みの番号を使い直した）ページか。呼び出し側でバッファを作る
+		bool isNewPage = false;
+	};
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="frameCount">同時処理フレーム数</param>
+	/// <param name="pageSize">通常ページのサイズ</param>
+	void Initialize(uint32_t frameCount, uint64_t pageSize);
+
+	/// <summary>
+	/// フレーム開始（次のフレームのページを使い回す。GetRequiredFenceValueまで完了していること）
+	/// </summary>
+	/// <param name="completedFenceValue">GPUが完了したフェンス値</param>
+	/// <param name="releasedPages">解放した大きなページの番号（バッファを捨てる）</param>
+	void BeginFrame(uint64_t completedFenceValue, std::vector<uint32_t>& releasedPages);
+
+	/// <summary>
+	/// フレーム終了（このフレームのページを使うコマンドの完了を示すフェンス値を記録する）
+	/// </summary>
+	/// <param name="fenceValue">コマンド実行後にシグナルしたフェンス値</param>
+	void EndFrame(uint64_t fenceValue);
+
+	/// <summary>
+	/// 次のBeginFrameで使い回すフレームが完了しているべきフェンス値
+	/// </summary>
+	uint64_t GetRequiredFenceValue() const;
+
+	/// <summary>
+	/// 確保（通常ページに入らない大きさは専用の大きなページを作る）
+	/// </summary>
+	/// <param name="size">サイズ（バイト）</param>
+	/// <param name="alignment">アライメント（2の累乗）</param>
+	/// <returns>確保結果</returns>
+	Allocation Allocate(uint64_t size, uint64_t alignment);
+
+	/// <summary>
+	/// ページの容量
+	/// </summary>
+	uint64_t GetPageCapacity(uint32_t page) const {
+		return pages_.at(page).allocator.GetCapacity();
+	}
+
+	/// <summary>
+	/// このフレームの使用量
+	/// </summary>
+	uint64_t GetUsedBytes() const;
+
+	/// <summary>
+	/// 全フレームで確保済みのページ容量
+	/// </summary>
+	uint64_t GetReservedBytes() const;
+
+	/// <summary>
+	/// 確保済みのページ数
+	/// </summary>
+	uint32_t GetPageCount() const;
+
+  private:
+	// ページ
+	struct Page {
+		LinearAllocator allocator;
+		// 解放済みで番号が空いているか
+		bool isFree = false;
+	};
+
+	// フレームごとの領域
+	struct Frame {
+		// 通常ページ（使い回す）
+		std::vector<uint32_t> pages;
+		// 使用中のページ番号
+		size_t currentPage = 0;
+		// ページに収まらない大きな確保（フレームの再利用時に解放）
+		std::vector<uint32_t> largePages;
+		// このフレームのコマンド完了を示すフェンス値
+		uint64_t fenceValue = 0;
+	};
+
+	/// <summary>
+	/// ページ番号の確保（解放済みの番号があれば使い直す）
+	/// </summary>
+	uint32_t NewPage(uint64_t capacity);
+
+	// 通常ページのサイズ
+	uint64_t pageSize_ = 0;
+	// 全ページ（ページ番号で添え字アクセス）
+	std::vector<Page> pages_;
+	// 解放済みのページ番号
+	std::vector<uint32_t> freePages_;
+	// フレームごとの領域
+	std::vector<Frame> frames_;
+	// 使用中のフレーム番号
+	uint32_t frameIndex_ = 0;
+};
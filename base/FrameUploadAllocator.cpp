@@ -0,0 +1,84 @@
+﻿#include "FrameUploadAllocator.h"
+#include <cassert>
+#include <cstring>
+#include <d3dx12.h>
+
+FrameUploadAllocator* FrameUploadAllocator::GetInstance() {
+	static FrameUploadAllocator instance;
+	return &instance;
+}
+
+void FrameUploadAllocator::Initialize(ID3D12Device* device, uint32_t frameCount, uint64_t pageSize) {
+	assert(device);
+	assert(0 < frameCount);
+
+	device_ = device;
+	pageAllocator_.Initialize(frameCount, pageSize);
+	pages_.clear();
+}
+
+void FrameUploadAllocator::BeginFrame(uint64_t completedFenceValue) {
+	// 前回このフレームの領域を使ったコマンドが完了していれば丸ごと再利用できる
+	pageAllocator_.BeginFrame(completedFenceValue, releasedPages_);
+	for (uint32_t page : releasedPages_) {
+		pages_[page].reset();
+	}
+}
+
+void FrameUploadAllocator::EndFrame(uint64_t fenceValue) { pageAllocator_.EndFrame(fenceValue); }
+
+FrameUploadAllocator::Allocation FrameUploadAllocator::Allocate(uint64_t size, uint64_t alignment) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	// 新しいページ番号ならバッファを作る（ページに収まらない大きさは専用のバッファになる）
+	FramePageAllocator::Allocation pageAllocation = pageAllocator_.Allocate(size, alignment);
+	if (pageAllocation.isNewPage) {
+		if (pages_.size() <= pageAllocation.page) {
+			pages_.resize(pageAllocation.page + 1);
+		}
+		pages_[pageAllocation.page] =
+		  CreatePage(pageAllocator_.GetPageCapacity(pageAllocation.page));
+	}
+
+	Page& page = *pages_[pageAllocation.page];
+	Allocation allocation;
+	allocation.size = size;
+	allocation.cpuAddress = page.cpuAddress + pageAllocation.offset;
+	allocation.gpuAddress = page.gpuAddress + pageAllocation.offset;
+	allocation.resource = page.resource.Get();
+	allocation.offset = pageAllocation.offset;
+	return allocation;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS FrameUploadAllocator::PushConstants(const void* data, uint64_t size) {
+	Allocation allocation = Allocate(size, kConstantBufferAlignment);
+	memcpy(allocation.cpuAddress, data, static_cast<size_t>(size));
+	return allocation.gpuAddress;
+}
+
+uint64_t FrameUploadAllocator::GetUsedBytes() const { return pageAllocator_.GetUsedBytes(); }
+
+uint64_t FrameUploadAllocator::GetReservedBytes() const {
+	return pageAllocator_.GetReservedBytes();
+}
+
+std::unique_ptr<FrameUploadAllocator::Page> FrameUploadAllocator::CreatePage(uint64_t size) {
+	// 定数バッファの境界に揃える
+	size = (size + kConstantBufferAlignment - 1) & ~(kConstantBufferAlignment - 1);
+
+	auto page = std::make_unique<Page>();
+
+	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+	HRESULT result = device_->CreateCommittedResource(
+	  &heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+	  IID_PPV_ARGS(&page->resource));
+	assert(SUCCEEDED(result));
+
+	// アップロードヒープは持続的にマップしたままにする
+	result = page->resource->Map(0, nullptr, (void**)&page->cpuAddress);
+	assert(SUCCEEDED(result));
+
+	page->gpuAddress = page->resource->GetGPUVirtualAddress();
+	return page;
+}
@@ -0,0 +1,125 @@
+﻿#pragma once
+
+#include "FramePageAllocator.h"
+#include <d3d12.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <wrl.h>
+
+/// <summary>
+/// フレーム単位の一時アップロードアロケータ
+/// （毎フレーム書き換える定数・頂点データを、フレームごとの大きなアップロードバッファから切り出す）
+/// </summary>
+class FrameUploadAllocator {
+  public:
+	// 定数バッファのアライメント
+	static const uint64_t kConstantBufferAlignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+	// 既定のページサイズ
+	static const uint64_t kDefaultPageSize = 2 * 1024 * 1024;
+	// 既定の同時処理フレーム数（DirectXCommonと同じ）
+	static const uint32_t kDefaultFrameCount = 1;
+
+	/// <summary>
+	/// 確保した領域
+	/// </summary>
+	struct Allocation {
+		// 書き込み先
+		void* cpuAddress = nullptr;
+		// GPUアドレス
+		D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+		// サイズ
+		uint64_t size = 0;
+		// 確保元のバッファとその中の位置（アドレスでなくリソースを受け取るAPI用）
+		ID3D12Resource* resource = nullptr;
+		uint64_t offset = 0;
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static FrameUploadAllocator* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="device">デバイス</param>
+	/// <param name="frameCount">同時処理フレーム数</param>
+	/// <param name="pageSize">ページサイズ</param>
+	void Initialize(
+	  ID3D12Device* device, uint32_t frameCount = kDefaultFrameCount,
+	  uint64_t pageSize = kDefaultPageSize);
+
+	/// <summary>
+	/// フレーム開始（次のフレームの領域を使い始める）
+	/// </summary>
+	/// <param name="completedFenceValue">GPUが完了したフェンス値</param>
+	void BeginFrame(uint64_t completedFenceValue);
+
+	/// <summary>
+	/// フレーム終了（このフレームのコマンドの完了を示すフェンス値を記録する）
+	/// </summary>
+	/// <param name="fenceValue">コマンド実行後にシグナルしたフェンス値</param>
+	void EndFrame(uint64_t fenceValue);
+
+	/// <summary>
+	/// 確保（内容はこのフレームのGPU処理が終わるまで有効。記録中のワーカースレッドからも呼べる）
+	/// </summary>
+	/// <param name="size">サイズ（バイト）</param>
+	/// <param name="alignment">アライメント（2の累乗）</param>
+	/// <returns>確保した領域</returns>
+	Allocation Allocate(uint64_t size, uint64_t alignment = kConstantBufferAlignment);
+
+	/// <summary>
+	/// 定数データの確保と書き込み
+	/// </summary>
+	/// <param name="data">データ</param>
+	/// <param name="size">サイズ（バイト）</param>
+	/// <returns>定数バッファビューに渡すGPUアドレス</returns>
+	D3D12_GPU_VIRTUAL_ADDRESS PushConstants(const void* data, uint64_t size);
+
+	/// <summary>
+	/// このフレームの使用量
+	/// </summary>
+	uint64_t GetUsedBytes() const;
+
+	/// <summary>
+	/// 全フレームで確保済みのバッファ容量
+	/// </summary>
+	uint64_t GetReservedBytes() const;
+
+	/// <summary>
+	/// 次のBeginFrameまでに完了しているべきフェンス値
+	/// </summary>
+	uint64_t GetRequiredFenceValue() const { return pageAllocator_.GetRequiredFenceValue(); }
+
+  private:
+	// ページ（持続的にマップしたアップロードバッファ）
+	struct Page {
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+		uint8_t* cpuAddress = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+	};
+
+	FrameUploadAllocator() = default;
+	~FrameUploadAllocator() = default;
+	FrameUploadAllocator(const FrameUploadAllocator&) = delete;
+	FrameUploadAllocator& operator=(const FrameUploadAllocator&) = delete;
+
+	/// <summary>
+	/// ページ生成
+	/// </summary>
+	std::unique_ptr<Page> CreatePage(uint64_t size);
+
+	// デバイス
+	ID3D12Device* device_ = nullptr;
+	// ページの割り当てとフレームごとの再利用
+	FramePageAllocator pageAllocator_;
+	// ページのバッファ（ページ番号で添え字アクセス。解放済みの番号はnull）
+	std::vector<std::unique_ptr<Page>> pages_;
+	// BeginFrameで解放したページ番号（作業用）
+	std::vector<uint32_t> releasedPages_;
+	// 確保の排他
+	std::mutex mutex_;
+};
@@ -0,0 +1,20 @@
+﻿#include "LinearAllocator.h"
+#include <cassert>
+
+const uint64_t LinearAllocator::kInvalidOffset;
+
+void LinearAllocator::Initialize(uint64_t capacity) {
+	capacity_ = capacity;
+	offset_ = 0;
+}
+
+uint64_t LinearAllocator::Allocate(uint64_t size, uint64_t alignment) {
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+	uint64_t offset = (offset_ + alignment - 1) & ~(alignment - 1);
+	if (offset < offset_ || capacity_ < offset || capacity_ - offset < size) {
+		return kInvalidOffset;
+	}
+	offset_ = offset + size;
+	return offset;
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include <cstdint>
+
+/// <summary>
+/// 線形アロケータ（先頭から詰めて確保し、まとめて解放する。メモリ自体は持たずオフセットだけを管理する）
+/// </summary>
+class LinearAllocator {
+  public:
+	// 確保失敗
+	static const uint64_t kInvalidOffset = UINT64_MAX;
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="capacity">容量（バイト）</param>
+	void Initialize(uint64_t capacity);
+
+	/// <summary>
+	/// 確保
+	/// </summary>
+	/// <param name="size">サイズ（バイト）</param>
+	/// <param name="alignment">アライメント（2の累乗）</param>
+	/// <returns>先頭からのオフセット（入りきらなければkInvalidOffset）</returns>
+	uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+	/// <summary>
+	/// 全解放
+	/// </summary>
+	void Reset() { offset_ = 0; }
+
+	uint64_t GetCapacity() const { return capacity_; }
+	uint64_t GetUsed() const { return offset_; }
+
+  private:
+	// 容量
+	uint64_t capacity_ = 0;
+	// 次に確保する位置
+	uint64_t offset_ = 0;
+};
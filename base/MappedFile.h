@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include <Windows.h>
+#include <cstddef>
+#include <string>
+
+/// <summary>
+/// 読み取り専用でメモリに割り当てたファイル
+/// （読み込みとコピーをせず、触れたページだけOSが読む）
+/// </summary>
+class MappedFile {
+  public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/// <summary>
+	/// 開く
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>成否（空のファイルも失敗とする）</returns>
+	bool Open(const std::wstring& filePath);
+
+	/// <summary>
+	/// 閉じる（以降は取得したデータを参照できない）
+	/// </summary>
+	void Close();
+
+	/// <summary>
+	/// 先頭アドレスの取得
+	/// </summary>
+	const void* GetData() const { return data_; }
+
+	/// <summary>
+	/// サイズの取得（バイト）
+	/// </summary>
+	size_t GetSize() const { return size_; }
+
+  private:
+	// ファイル
+	HANDLE file_ = INVALID_HANDLE_VALUE;
+	// ファイルマッピング
+	HANDLE mapping_ = nullptr;
+	// 割り当てた先頭アドレス
+	const void* data_ = nullptr;
+	// サイズ
+	size_t size_ = 0;
+};
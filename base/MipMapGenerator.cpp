@@ -0,0 +1,327 @@
+﻿#include "MipMapGenerator.h"
+#include "ThreadPool.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace DirectX;
+
+namespace {
+// 1タスクあたりの最小ピクセル数
+const uint32_t kGrainPixels = 16 * 1024;
+// カイザーフィルタのタップ数
+const int kKaiserTaps = 6;
+// カイザー窓の形状パラメータ
+const double kKaiserBeta = 4.0;
+// 線形→sRGB変換テーブルの分解能
+const int kLinearToSRGBTableSize = 4096;
+
+// 0次の第1種変形ベッセル関数
+double BesselI0(double x) {
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1e-12) {
+			break;
+		}
+	}
+	return sum;
+}
+
+// 色変換テーブルとフィルタ係数
+struct FilterTables {
+	// sRGB8 → 線形
+	float srgbToLinear[256];
+	// UNORM8 → 0..1
+	float unormToFloat[256];
+	// 線形（12bit量子化） → sRGB8
+	uint8_t linearToSRGB[kLinearToSRGBTableSize];
+	// カイザーフィルタ係数
+	float kaiser[kKaiserTaps];
+
+	FilterTables() {
+		for (int i = 0; i < 256; i++) {
+			double c = i / 255.0;
+			srgbToLinear[i] =
+			  static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+			unormToFloat[i] = static_cast<float>(c);
+		}
+		for (int i = 0; i < kLinearToSRGBTableSize; i++) {
+			double l = static_cast<double>(i) / (kLinearToSRGBTableSize - 1);
+			double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+			linearToSRGB[i] = static_cast<uint8_t>((std::min)(255.0, c * 255.0 + 0.5));
+		}
+
+		// 出力ピクセル中心からの距離 -2.5 .. 2.5 に置いたカイザー窓付きsinc
+		const double pi = 3.14159265358979323846;
+		const double radius = kKaiserTaps * 0.5;
+		double total = 0.0;
+		double weights[kKaiserTaps];
+		for (int k = 0; k < kKaiserTaps; k++) {
+			double d = k - (kKaiserTaps - 1) * 0.5;
+			double t = d * 0.5;
+			double sinc = std::sin(pi * t) / (pi * t);
+			double r = d / radius;
+			double window = BesselI0(kKaiserBeta * std::sqrt(1.0 - r * r)) / BesselI0(kKaiserBeta);
+			weights[k] = sinc * window;
+			total += weights[k];
+		}
+		for (int k = 0; k < kKaiserTaps; k++) {
+			kaiser[k] = static_cast<float>(weights[k] / total);
+		}
+	}
+};
+
+const FilterTables& GetTables() {
+	static const FilterTables tables;
+	return tables;
+}
+
+// 線形浮動小数点のミップレベル
+struct FloatLevel {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	std::vector<XMFLOAT4A> pixels;
+
+	void Resize(uint32_t w, uint32_t h) {
+		width = w;
+		height = h;
+		pixels.resize(static_cast<size_t>(w) * h);
+	}
+	const XMFLOAT4A* Row(uint32_t y) const { return &pixels[static_cast<size_t>(y) * width]; }
+	XMFLOAT4A* Row(uint32_t y) { return &pixels[static_cast<size_t>(y) * width]; }
+};
+
+// 行数単位の粒度を求める
+uint32_t RowGrain(uint32_t width) { return (std::max)(1u, kGrainPixels / (std::max)(width, 1u)); }
+
+// アルファを持たないフォーマットか
+bool IsAlphaIgnored(DXGI_FORMAT format) {
+	return format == DXGI_FORMAT_B8G8R8X8_UNORM || format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+}
+
+// 8bit画像を線形浮動小数点に展開
+void Decode(const Image& image, bool isSRGB, FloatLevel& dst) {
+	const FilterTables& tables = GetTables();
+	const float* rgbTable = isSRGB ? tables.srgbToLinear : tables.unormToFloat;
+	bool alphaIgnored = IsAlphaIgnored(image.format);
+
+	dst.Resize(static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height));
+	ThreadPool::GetInstance()->ParallelFor(
+	  dst.height, RowGrain(dst.width), [&](uint32_t begin, uint32_t end) {
+		  for (uint32_t y = begin; y < end; y++) {
+			  const uint8_t* src = image.pixels + image.rowPitch * y;
+			  XMFLOAT4A* out = dst.Row(y);
+			  for (uint32_t x = 0; x < dst.width; x++, src += 4) {
+				  out[x].x = rgbTable[src[0]];
+				  out[x].y = rgbTable[src[1]];
+				  out[x].z = rgbTable[src[2]];
+				  out[x].w = alphaIgnored ? 1.0f : tables.unormToFloat[src[3]];
+			  }
+		  }
+	  });
+}
+
+// 線形浮動小数点を8bit画像に書き戻す
+void Encode(const FloatLevel& src, bool isSRGB, const Image& image) {
+	const FilterTables& tables = GetTables();
+	const XMVECTOR tableScale = XMVectorReplicate(static_cast<float>(kLinearToSRGBTableSize - 1));
+	const XMVECTOR unormScale = XMVectorReplicate(255.0f);
+	const XMVECTOR half = XMVectorReplicate(0.5f);
+
+	ThreadPool::GetInstance()->ParallelFor(
+	  src.height, RowGrain(src.width), [&](uint32_t begin, uint32_t end) {
+		  for (uint32_t y = begin; y < end; y++) {
+			  const XMFLOAT4A* in = src.Row(y);
+			  uint8_t* dst = image.pixels + image.rowPitch * y;
+			  for (uint32_t x = 0; x < src.width; x++, dst += 4) {
+				  XMVECTOR v = XMVectorSaturate(XMLoadFloat4A(&in[x]));
+				  XMFLOAT4A q;
+				  XMStoreFloat4A(&q, XMVectorMultiplyAdd(v, unormScale, half));
+				  dst[3] = static_cast<uint8_t>(q.w);
+				  if (isSRGB) {
+					  XMStoreFloat4A(&q, XMVectorMultiplyAdd(v, tableScale, half));
+					  dst[0] = tables.linearToSRGB[static_cast<int>(q.x)];
+					  dst[1] = tables.linearToSRGB[static_cast<int>(q.y)];
+					  dst[2] = tables.linearToSRGB[static_cast<int>(q.z)];
+				  } else {
+					  dst[0] = static_cast<uint8_t>(q.x);
+					  dst[1] = static_cast<uint8_t>(q.y);
+					  dst[2] = static_cast<uint8_t>(q.z);
+				  }
+			  }
+		  }
+	  });
+}
+
+// 箱型フィルタの出力1ピクセル分のタップ（1軸分）
+struct BoxTaps {
+	uint32_t index[3];
+	float weight[3];
+	uint32_t count;
+};
+
+// 1軸分のタップを作る
+// （奇数の大きさ2n+1をnに縮めると出力1ピクセルが元の(2n+1)/nピクセルを覆うので、
+//   端の列を捨てずに3タップで覆う割合の重みを付ける）
+std::vector<BoxTaps> MakeBoxTaps(uint32_t srcSize, uint32_t dstSize) {
+	std::vector<BoxTaps> taps(dstSize);
+	for (uint32_t i = 0; i < dstSize; i++) {
+		BoxTaps& tap = taps[i];
+		if (srcSize == 1) {
+			tap = {{0, 0, 0}, {1.0f, 0.0f, 0.0f}, 1};
+		} else if (srcSize % 2 == 0) {
+			tap = {{i * 2, i * 2 + 1, 0}, {0.5f, 0.5f, 0.0f}, 2};
+		} else {
+			float scale = 1.0f / srcSize;
+			tap = {
+			  {i * 2, i * 2 + 1, i * 2 + 2},
+			  {(dstSize - i) * scale, dstSize * scale, (i + 1) * scale},
+			  3};
+		}
+	}
+	return taps;
+}
+
+// 箱型フィルタで縮小（偶数の大きさでは2x2平均）
+void DownsampleBox(const FloatLevel& src, FloatLevel& dst) {
+	const std::vector<BoxTaps> columns = MakeBoxTaps(src.width, dst.width);
+	const std::vector<BoxTaps> rows = MakeBoxTaps(src.height, dst.height);
+
+	ThreadPool::GetInstance()->ParallelFor(
+	  dst.height, RowGrain(dst.width * 4), [&](uint32_t begin, uint32_t end) {
+		  for (uint32_t y = begin; y < end; y++) {
+			  const BoxTaps& row = rows[y];
+			  XMFLOAT4A* out = dst.Row(y);
+			  for (uint32_t x = 0; x < dst.width; x++) {
+				  const BoxTaps& column = columns[x];
+				  XMVECTOR sum = XMVectorZero();
+				  for (uint32_t j = 0; j < row.count; j++) {
+					  const XMFLOAT4A* in = src.Row(row.index[j]);
+					  XMVECTOR rowSum = XMVectorZero();
+					  for (uint32_t i = 0; i < column.count; i++) {
+						  rowSum = XMVectorMultiplyAdd(
+						    XMLoadFloat4A(&in[column.index[i]]), XMVectorReplicate(column.weight[i]),
+						    rowSum);
+					  }
+					  sum = XMVectorMultiplyAdd(rowSum, XMVectorReplicate(row.weight[j]), sum);
+				  }
+				  XMStoreFloat4A(&out[x], sum);
+			  }
+		  }
+	  });
+}
+
+// カイザーフィルタで縮小（縦→横の分離フィルタ）
+void DownsampleKaiser(const FloatLevel& src, FloatLevel& dst) {
+	const float* weights = GetTables().kaiser;
+	const int offset = kKaiserTaps / 2 - 1;
+
+	ThreadPool::GetInstance()->ParallelFor(
+	  dst.height, RowGrain(dst.width * kKaiserTaps), [&](uint32_t begin, uint32_t end) {
+		  // 縦方向フィルタ結果の一時行
+		  std::vector<XMFLOAT4A> column(src.width);
+		  const int maxY = static_cast<int>(src.height) - 1;
+		  const int maxX = static_cast<int>(src.width) - 1;
+
+		  for (uint32_t y = begin; y < end; y++) {
+			  const XMFLOAT4A* rows[kKaiserTaps];
+			  for (int k = 0; k < kKaiserTaps; k++) {
+				  int sy = (std::max)(0, (std::min)(static_cast<int>(y * 2) - offset + k, maxY));
+				  rows[k] = src.Row(sy);
+			  }
+			  for (uint32_t x = 0; x < src.width; x++) {
+				  XMVECTOR sum = XMVectorZero();
+				  for (int k = 0; k < kKaiserTaps; k++) {
+					  sum = XMVectorMultiplyAdd(
+					    XMLoadFloat4A(&rows[k][x]), XMVectorReplicate(weights[k]), sum);
+				  }
+				  XMStoreFloat4A(&column[x], sum);
+			  }
+
+			  XMFLOAT4A* out = dst.Row(y);
+			  for (uint32_t x = 0; x < dst.width; x++) {
+				  XMVECTOR sum = XMVectorZero();
+				  for (int k = 0; k < kKaiserTaps; k++) {
+					  int sx = (std::max)(0, (std::min)(static_cast<int>(x * 2) - offset + k, maxX));
+					  sum = XMVectorMultiplyAdd(
+					    XMLoadFloat4A(&column[sx]), XMVectorReplicate(weights[k]), sum);
+				  }
+				  XMStoreFloat4A(&out[x], sum);
+			  }
+		  }
+	  });
+}
+} // namespace
+
+bool MipMapGenerator::IsSupported(const TexMetadata& metadata) {
+	if (metadata.dimension != TEX_DIMENSION_TEXTURE2D || metadata.arraySize != 1 ||
+	    metadata.depth != 1 || metadata.IsCubemap()) {
+		return false;
+	}
+
+	switch (metadata.format) {
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		return true;
+	default:
+		return false;
+	}
+}
+
+HRESULT MipMapGenerator::Generate(
+  const ScratchImage& source, ScratchImage& mipChain, Filter filter, bool isSRGB) {
+	const TexMetadata& metadata = source.GetMetadata();
+	if (!IsSupported(metadata)) {
+		return E_INVALIDARG;
+	}
+
+	// フルミップチェーンのレベル数
+	size_t mipLevels = 1;
+	for (size_t size = (std::max)(metadata.width, metadata.height); 1 < size; size /= 2) {
+		mipLevels++;
+	}
+
+	HRESULT result =
+	  mipChain.Initialize2D(metadata.format, metadata.width, metadata.height, 1, mipLevels);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	// レベル0は元画像をそのままコピー
+	const Image* srcImage = source.GetImage(0, 0, 0);
+	const Image* topImage = mipChain.GetImage(0, 0, 0);
+	for (size_t y = 0; y < srcImage->height; y++) {
+		std::memcpy(
+		  topImage->pixels + topImage->rowPitch * y, srcImage->pixels + srcImage->rowPitch * y,
+		  (std::min)(srcImage->rowPitch, topImage->rowPitch));
+	}
+
+	// 前のレベルを線形浮動小数点のまま次の縮小に使う
+	FloatLevel levels[2];
+	Decode(*srcImage, isSRGB, levels[0]);
+
+	for (size_t mip = 1; mip < mipLevels; mip++) {
+		const FloatLevel& src = levels[(mip - 1) % 2];
+		FloatLevel& dst = levels[mip % 2];
+		dst.Resize((std::max)(1u, src.width / 2), (std::max)(1u, src.height / 2));
+
+		if (filter == Filter::kKaiser) {
+			DownsampleKaiser(src, dst);
+		} else {
+			DownsampleBox(src, dst);
+		}
+
+		Encode(dst, isSRGB, *mipChain.GetImage(mip, 0, 0));
+	}
+
+	return S_OK;
+}
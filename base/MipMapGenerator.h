@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include <DirectXTex.h>
+
+/// <summary>
+/// ミップマップ生成（行単位で分割してスレッドプールで並列処理）
+/// </summary>
+class MipMapGenerator {
+  public:
+	// 縮小フィルタ
+	enum class Filter {
+		kBox,    //!< 2x2平均（奇数の大きさは端まで覆う3タップ）
+		kKaiser, //!< カイザー窓付きsinc（6タップ分離フィルタ）
+	};
+
+	/// <summary>
+	/// 対応フォーマットか
+	/// </summary>
+	/// <param name="metadata">テクスチャ情報</param>
+	/// <returns>対応していればtrue</returns>
+	static bool IsSupported(const DirectX::TexMetadata& metadata);
+
+	/// <summary>
+	/// ミップマップ生成
+	/// </summary>
+	/// <param name="source">元画像（ミップレベル0のみ使用）</param>
+	/// <param name="mipChain">生成したミップチェーンの格納先</param>
+	/// <param name="filter">縮小フィルタ</param>
+	/// <param name="isSRGB">sRGBとして線形空間で平均するか（MakeSRGBで扱うテクスチャはtrue）</param>
+	/// <returns>結果</returns>
+	static HRESULT Generate(
+	  const DirectX::ScratchImage& source, DirectX::ScratchImage& mipChain,
+	  Filter filter = Filter::kBox, bool isSRGB = true);
+};
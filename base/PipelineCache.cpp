@@ -0,0 +1,263 @@
+﻿#include "PipelineCache.h"
+#include "PipelineCacheFile.h"
+#include "PipelineHasher.h"
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <dxgi1_6.h>
+
+using namespace Microsoft::WRL;
+
+namespace {
+// シェーダのバイトコード
+void AddShader(PipelineHasher& hasher, const D3D12_SHADER_BYTECODE& shader) {
+	hasher.AddBlock(shader.pShaderBytecode, shader.BytecodeLength);
+}
+
+// ブレンドステート
+void AddBlendState(PipelineHasher& hasher, const D3D12_BLEND_DESC& blend) {
+	hasher.AddUint32(blend.AlphaToCoverageEnable);
+	hasher.AddUint32(blend.IndependentBlendEnable);
+	for (const D3D12_RENDER_TARGET_BLEND_DESC& target : blend.RenderTarget) {
+		hasher.AddUint32(target.BlendEnable);
+		hasher.AddUint32(target.LogicOpEnable);
+		hasher.AddUint32(target.SrcBlend);
+		hasher.AddUint32(target.DestBlend);
+		hasher.AddUint32(target.BlendOp);
+		hasher.AddUint32(target.SrcBlendAlpha);
+		hasher.AddUint32(target.DestBlendAlpha);
+		hasher.AddUint32(target.BlendOpAlpha);
+		hasher.AddUint32(target.LogicOp);
+		hasher.AddUint32(target.RenderTargetWriteMask);
+	}
+}
+
+// ラスタライザステート
+void AddRasterizerState(PipelineHasher& hasher, const D3D12_RASTERIZER_DESC& rasterizer) {
+	hasher.AddUint32(rasterizer.FillMode);
+	hasher.AddUint32(rasterizer.CullMode);
+	hasher.AddUint32(rasterizer.FrontCounterClockwise);
+	hasher.AddUint32(static_cast<uint32_t>(rasterizer.DepthBias));
+	hasher.AddFloat(rasterizer.DepthBiasClamp);
+	hasher.AddFloat(rasterizer.SlopeScaledDepthBias);
+	hasher.AddUint32(rasterizer.DepthClipEnable);
+	hasher.AddUint32(rasterizer.MultisampleEnable);
+	hasher.AddUint32(rasterizer.AntialiasedLineEnable);
+	hasher.AddUint32(rasterizer.ForcedSampleCount);
+	hasher.AddUint32(rasterizer.ConservativeRaster);
+}
+
+// ステンシルの面ごとの設定
+void AddStencilOp(PipelineHasher& hasher, const D3D12_DEPTH_STENCILOP_DESC& op) {
+	hasher.AddUint32(op.StencilFailOp);
+	hasher.AddUint32(op.StencilDepthFailOp);
+	hasher.AddUint32(op.StencilPassOp);
+	hasher.AddUint32(op.StencilFunc);
+}
+
+// デプスステンシルステート
+void AddDepthStencilState(PipelineHasher& hasher, const D3D12_DEPTH_STENCIL_DESC& depthStencil) {
+	hasher.AddUint32(depthStencil.DepthEnable);
+	hasher.AddUint32(depthStencil.DepthWriteMask);
+	hasher.AddUint32(depthStencil.DepthFunc);
+	hasher.AddUint32(depthStencil.StencilEnable);
+	hasher.AddUint32(depthStencil.StencilReadMask);
+	hasher.AddUint32(depthStencil.StencilWriteMask);
+	AddStencilOp(hasher, depthStencil.FrontFace);
+	AddStencilOp(hasher, depthStencil.BackFace);
+}
+
+// 頂点レイアウト
+void AddInputLayout(PipelineHasher& hasher, const D3D12_INPUT_LAYOUT_DESC& inputLayout) {
+	hasher.AddUint32(inputLayout.NumElements);
+	for (UINT i = 0; i < inputLayout.NumElements; i++) {
+		const D3D12_INPUT_ELEMENT_DESC& element = inputLayout.pInputElementDescs[i];
+		hasher.AddString(element.SemanticName);
+		hasher.AddUint32(element.SemanticIndex);
+		hasher.AddUint32(element.Format);
+		hasher.AddUint32(element.InputSlot);
+		hasher.AddUint32(element.AlignedByteOffset);
+		hasher.AddUint32(element.InputSlotClass);
+		hasher.AddUint32(element.InstanceDataStepRate);
+	}
+}
+
+// 経過時間（ミリ秒）
+double ElapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+	  .count();
+}
+} // namespace
+
+PipelineCache* PipelineCache::GetInstance() {
+	static PipelineCache instance;
+	return &instance;
+}
+
+void PipelineCache::Initialize(ID3D12Device* device, const std::string& filePath) {
+	assert(device);
+
+	device_ = device;
+	filePath_ = filePath;
+	deviceKey_ = MakeDeviceKey();
+	dirty_ = false;
+	library_.Reset();
+	stats_ = Stats();
+
+	// ライブラリに対応していなければメモリ上だけで使い回す
+	ComPtr<ID3D12Device1> device1;
+	if (FAILED(device_->QueryInterface(IID_PPV_ARGS(&device1)))) {
+		return;
+	}
+
+	// 前回保存したライブラリを読み込む（ドライバが変わっていれば作り直す）
+	if (PipelineCacheFile::Load(filePath_, deviceKey_, libraryData_)) {
+		HRESULT result = device1->CreatePipelineLibrary(
+		  libraryData_.data(), libraryData_.size(), IID_PPV_ARGS(&library_));
+		if (SUCCEEDED(result)) {
+			return;
+		}
+	}
+	CreateEmptyLibrary();
+}
+
+ComPtr<ID3D12RootSignature> PipelineCache::CreateRootSignature(ID3DBlob* blob) {
+	assert(device_);
+	assert(blob);
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	uint64_t key = PipelineHasher::Hash(blob->GetBufferPointer(), blob->GetBufferSize());
+	auto it = rootSignatures_.find(key);
+	if (it != rootSignatures_.end()) {
+		stats_.rootSignatureHits++;
+		return it->second;
+	}
+
+	ComPtr<ID3D12RootSignature> rootSignature;
+	HRESULT result = device_->CreateRootSignature(
+	  0, blob->GetBufferPointer(), blob->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
+	assert(SUCCEEDED(result));
+	(void)result;
+
+	rootSignatures_[key] = rootSignature;
+	rootSignatureKeys_[rootSignature.Get()] = key;
+	return rootSignature;
+}
+
+ComPtr<ID3D12PipelineState>
+  PipelineCache::CreateGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) {
+	assert(device_);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	// ルートシグネチャは内容のハッシュで表す（ポインタは起動ごとに変わる）
+	auto rootSignatureKey = rootSignatureKeys_.find(desc.pRootSignature);
+	assert(rootSignatureKey != rootSignatureKeys_.end());
+	uint64_t key = HashGraphicsPipeline(desc, rootSignatureKey->second);
+
+	ComPtr<ID3D12PipelineState>& pipelineState = pipelines_[key];
+	if (pipelineState) {
+		stats_.memoryHits++;
+		stats_.createTime += ElapsedMilliseconds(start);
+		return pipelineState;
+	}
+
+	// ライブラリにはキーを名前にして登録する
+	wchar_t name[24];
+	swprintf_s(name, L"G%016llx", static_cast<unsigned long long>(key));
+	if (library_ &&
+	    SUCCEEDED(library_->LoadGraphicsPipeline(name, &desc, IID_PPV_ARGS(&pipelineState)))) {
+		stats_.libraryHits++;
+	} else {
+		HRESULT result = device_->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState));
+		assert(SUCCEEDED(result));
+		(void)result;
+		stats_.misses++;
+		if (library_ && SUCCEEDED(library_->StorePipeline(name, pipelineState.Get()))) {
+			dirty_ = true;
+		}
+	}
+
+	stats_.createTime += ElapsedMilliseconds(start);
+	return pipelineState;
+}
+
+bool PipelineCache::Save() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!library_ || !dirty_) {
+		return false;
+	}
+
+	std::vector<uint8_t> data(library_->GetSerializedSize());
+	HRESULT result = library_->Serialize(data.data(), data.size());
+	if (FAILED(result) || !PipelineCacheFile::Save(filePath_, deviceKey_, data.data(), data.size())) {
+		return false;
+	}
+	dirty_ = false;
+	return true;
+}
+
+uint64_t PipelineCache::HashGraphicsPipeline(
+  const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureKey) {
+	// ストリーム出力は使わない
+	assert(desc.StreamOutput.NumEntries == 0);
+
+	PipelineHasher hasher;
+	hasher.AddUint64(rootSignatureKey);
+	AddShader(hasher, desc.VS);
+	AddShader(hasher, desc.PS);
+	AddShader(hasher, desc.DS);
+	AddShader(hasher, desc.HS);
+	AddShader(hasher, desc.GS);
+	AddBlendState(hasher, desc.BlendState);
+	hasher.AddUint32(desc.SampleMask);
+	AddRasterizerState(hasher, desc.RasterizerState);
+	AddDepthStencilState(hasher, desc.DepthStencilState);
+	AddInputLayout(hasher, desc.InputLayout);
+	hasher.AddUint32(desc.IBStripCutValue);
+	hasher.AddUint32(desc.PrimitiveTopologyType);
+	hasher.AddUint32(desc.NumRenderTargets);
+	for (DXGI_FORMAT format : desc.RTVFormats) {
+		hasher.AddUint32(format);
+	}
+	hasher.AddUint32(desc.DSVFormat);
+	hasher.AddUint32(desc.SampleDesc.Count);
+	hasher.AddUint32(desc.SampleDesc.Quality);
+	hasher.AddUint32(desc.NodeMask);
+	hasher.AddUint32(desc.Flags);
+	return hasher.Get();
+}
+
+uint64_t PipelineCache::MakeDeviceKey() const {
+	PipelineHasher hasher;
+
+	ComPtr<IDXGIFactory4> factory;
+	ComPtr<IDXGIAdapter1> adapter;
+	if (SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&factory))) &&
+	    SUCCEEDED(factory->EnumAdapterByLuid(device_->GetAdapterLuid(), IID_PPV_ARGS(&adapter)))) {
+		DXGI_ADAPTER_DESC1 adapterDesc;
+		adapter->GetDesc1(&adapterDesc);
+		hasher.AddUint32(adapterDesc.VendorId);
+		hasher.AddUint32(adapterDesc.DeviceId);
+		hasher.AddUint32(adapterDesc.SubSysId);
+		hasher.AddUint32(adapterDesc.Revision);
+
+		// ユーザーモードドライバの版
+		LARGE_INTEGER driverVersion{};
+		adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+		hasher.AddUint64(static_cast<uint64_t>(driverVersion.QuadPart));
+	}
+	return hasher.Get();
+}
+
+void PipelineCache::CreateEmptyLibrary() {
+	libraryData_.clear();
+	ComPtr<ID3D12Device1> device1;
+	HRESULT result = device_->QueryInterface(IID_PPV_ARGS(&device1));
+	if (SUCCEEDED(result)) {
+		result = device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&library_));
+	}
+	if (FAILED(result)) {
+		library_.Reset();
+	}
+}
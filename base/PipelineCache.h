@@ -0,0 +1,113 @@
+﻿#pragma once
+
+#include <d3d12.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <wrl.h>
+
+/// <summary>
+/// パイプラインステートのキャッシュ
+/// （設定とシェーダのハッシュをキーに作成済みのものを使い回し、ID3D12PipelineLibraryで
+///   ディスクに保存して次回の起動ではドライバのコンパイルを省く）
+/// </summary>
+class PipelineCache {
+  public:
+	/// <summary>
+	/// 統計
+	/// </summary>
+	struct Stats {
+		uint32_t memoryHits = 0;        // 作成済みのものを返した数
+		uint32_t libraryHits = 0;       // 保存したライブラリから読み込んだ数
+		uint32_t misses = 0;            // 新しく作成した数
+		uint32_t rootSignatureHits = 0; // 作成済みのルートシグネチャを返した数
+		double createTime = 0.0;        // パイプラインの取得にかかった時間の合計（ミリ秒）
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static PipelineCache* GetInstance();
+
+	/// <summary>
+	/// 初期化（保存したライブラリがあれば読み込む）
+	/// </summary>
+	/// <param name="device">デバイス</param>
+	/// <param name="filePath">ライブラリのファイルパス</param>
+	void Initialize(ID3D12Device* device, const std::string& filePath = "pipeline_cache.bin");
+
+	/// <summary>
+	/// ルートシグネチャの取得（同じ内容なら同じものを返す）
+	/// </summary>
+	/// <param name="blob">シリアライズしたルートシグネチャ</param>
+	/// <returns>ルートシグネチャ</returns>
+	Microsoft::WRL::ComPtr<ID3D12RootSignature> CreateRootSignature(ID3DBlob* blob);
+
+	/// <summary>
+	/// グラフィックスパイプラインの取得（どのスレッドからも呼べる）
+	/// （ルートシグネチャはCreateRootSignatureで作ったものに限る）
+	/// </summary>
+	/// <param name="desc">設定</param>
+	/// <returns>パイプラインステート</returns>
+	Microsoft::WRL::ComPtr<ID3D12PipelineState>
+	  CreateGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+
+	/// <summary>
+	/// 新しく作成したものがあればライブラリを保存する
+	/// </summary>
+	/// <returns>保存したか</returns>
+	bool Save();
+
+	/// <summary>
+	/// 統計の取得
+	/// </summary>
+	const Stats& GetStats() const { return stats_; }
+
+	/// <summary>
+	/// 設定のハッシュ値（ポインタの先の内容まで含め、ルートシグネチャはキーで表す）
+	/// </summary>
+	/// <param name="desc">設定</param>
+	/// <param name="rootSignatureKey">ルートシグネチャのキー</param>
+	/// <returns>ハッシュ値</returns>
+	static uint64_t
+	  HashGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureKey);
+
+  private:
+	PipelineCache() = default;
+	~PipelineCache() = default;
+	PipelineCache(const PipelineCache&) = delete;
+	PipelineCache& operator=(const PipelineCache&) = delete;
+
+	/// <summary>
+	/// 実行環境のキー（アダプタとドライバの版が変わったら保存したものは使えない）
+	/// </summary>
+	uint64_t MakeDeviceKey() const;
+
+	/// <summary>
+	/// 空のライブラリを作る
+	/// </summary>
+	void CreateEmptyLibrary();
+
+	// デバイス
+	ID3D12Device* device_ = nullptr;
+	// ライブラリ（対応していなければnullptrで、メモリ上だけで使い回す）
+	Microsoft::WRL::ComPtr<ID3D12PipelineLibrary> library_;
+	// ライブラリの元データ（ライブラリを使う間は残しておく）
+	std::vector<uint8_t> libraryData_;
+	// ファイルパス
+	std::string filePath_;
+	// 実行環境のキー
+	uint64_t deviceKey_ = 0;
+	// 保存していない追加があるか
+	bool dirty_ = false;
+	// 作成済みのもの
+	std::unordered_map<uint64_t, Microsoft::WRL::ComPtr<ID3D12RootSignature>> rootSignatures_;
+	std::unordered_map<ID3D12RootSignature*, uint64_t> rootSignatureKeys_;
+	std::unordered_map<uint64_t, Microsoft::WRL::ComPtr<ID3D12PipelineState>> pipelines_;
+	// 排他
+	std::mutex mutex_;
+	// 統計
+	Stats stats_;
+};
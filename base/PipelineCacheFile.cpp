@@ -0,0 +1,61 @@
+﻿#include "PipelineCacheFile.h"
+#include "PipelineHasher.h"
+#include <cstring>
+#include <fstream>
+
+namespace {
+// ファイルの識別子
+const char kMagic[4] = {'P', 'S', 'O', 'C'};
+} // namespace
+
+const uint32_t PipelineCacheFile::kVersion;
+
+bool PipelineCacheFile::Load(
+  const std::string& filePath, uint64_t deviceKey, std::vector<uint8_t>& data) {
+	data.clear();
+
+	std::ifstream file(filePath, std::ios::binary);
+	if (file.fail()) {
+		return false;
+	}
+
+	Header header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (file.fail() || memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+	    header.version != kVersion || header.deviceKey != deviceKey) {
+		return false;
+	}
+
+	// 書き込み途中で終わったファイルは長さかハッシュが合わない
+	file.seekg(0, std::ios::end);
+	uint64_t remaining = static_cast<uint64_t>(file.tellg()) - sizeof(header);
+	if (remaining != header.dataSize) {
+		return false;
+	}
+	file.seekg(sizeof(header), std::ios::beg);
+	data.resize(static_cast<size_t>(header.dataSize));
+	file.read(reinterpret_cast<char*>(data.data()), data.size());
+	if (file.fail() || PipelineHasher::Hash(data.data(), data.size()) != header.dataHash) {
+		data.clear();
+		return false;
+	}
+	return true;
+}
+
+bool PipelineCacheFile::Save(
+  const std::string& filePath, uint64_t deviceKey, const void* data, size_t size) {
+	std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+	if (file.fail()) {
+		return false;
+	}
+
+	Header header;
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.deviceKey = deviceKey;
+	header.dataSize = size;
+	header.dataHash = PipelineHasher::Hash(data, size);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(static_cast<const char*>(data), size);
+	return !file.fail();
+}
@@ -0,0 +1,45 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// パイプラインキャッシュのファイル
+/// （ドライバが直列化したデータに、版・実行環境のキー・内容のハッシュを付けて保存する）
+/// </summary>
+class PipelineCacheFile {
+  public:
+	// ファイルの版（形式を変えたら上げる）
+	static const uint32_t kVersion = 1;
+
+	/// <summary>
+	/// 読み込み（無い・壊れている・版や実行環境が違うときは失敗する）
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <param name="deviceKey">実行環境のキー（アダプタとドライバの版から作る）</param>
+	/// <param name="data">読み込んだデータ</param>
+	/// <returns>成否</returns>
+	static bool Load(const std::string& filePath, uint64_t deviceKey, std::vector<uint8_t>& data);
+
+	/// <summary>
+	/// 保存
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <param name="deviceKey">実行環境のキー</param>
+	/// <param name="data">データ</param>
+	/// <param name="size">サイズ（バイト）</param>
+	/// <returns>成否</returns>
+	static bool Save(const std::string& filePath, uint64_t deviceKey, const void* data, size_t size);
+
+  private:
+	// ファイルヘッダ
+	struct Header {
+		char magic[4];
+		uint32_t version;
+		uint64_t deviceKey;
+		uint64_t dataSize;
+		uint64_t dataHash;
+	};
+};
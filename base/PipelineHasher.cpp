@@ -0,0 +1,45 @@
+﻿#include "PipelineHasher.h"
+#include <cstring>
+
+namespace {
+// FNV-1aの素数
+const uint64_t kPrime = 1099511628211ull;
+} // namespace
+
+const uint64_t PipelineHasher::kOffsetBasis;
+
+void PipelineHasher::AddBytes(const void* data, size_t size) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash_ ^= bytes[i];
+		hash_ *= kPrime;
+	}
+}
+
+void PipelineHasher::AddBlock(const void* data, size_t size) {
+	AddUint64(size);
+	AddBytes(data, size);
+}
+
+void PipelineHasher::AddString(const char* text) {
+	if (!text) {
+		AddUint64(UINT64_MAX);
+		return;
+	}
+	AddBlock(text, strlen(text));
+}
+
+void PipelineHasher::AddFloat(float value) {
+	if (value == 0.0f) {
+		value = 0.0f;
+	}
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	AddUint32(bits);
+}
+
+uint64_t PipelineHasher::Hash(const void* data, size_t size) {
+	PipelineHasher hasher;
+	hasher.AddBytes(data, size);
+	return hasher.Get();
+}
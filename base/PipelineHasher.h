@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// パイプラインのキーを作る逐次ハッシュ（FNV-1a 64bit）
+/// （構造体は詰め物を含むことがあるので、値はメンバごとに加える）
+/// </summary>
+class PipelineHasher {
+  public:
+	// 初期値
+	static const uint64_t kOffsetBasis = 14695981039346656037ull;
+
+	/// <summary>
+	/// バイト列を加える
+	/// </summary>
+	/// <param name="data">データ</param>
+	/// <param name="size">サイズ（バイト）</param>
+	void AddBytes(const void* data, size_t size);
+
+	/// <summary>
+	/// 長さ付きでバイト列を加える（続けて加えたものと区切りが紛れないようにする）
+	/// </summary>
+	void AddBlock(const void* data, size_t size);
+
+	/// <summary>
+	/// 文字列を加える（nullptrは空文字列と区別する）
+	/// </summary>
+	void AddString(const char* text);
+
+	/// <summary>
+	/// 整数を加える
+	/// </summary>
+	void AddUint32(uint32_t value) { AddBytes(&value, sizeof(value)); }
+	void AddUint64(uint64_t value) { AddBytes(&value, sizeof(value)); }
+
+	/// <summary>
+	/// 浮動小数点数を加える（-0と0は同じ値として扱う）
+	/// </summary>
+	void AddFloat(float value);
+
+	/// <summary>
+	/// ハッシュ値の取得
+	/// </summary>
+	uint64_t Get() const { return hash_; }
+
+	/// <summary>
+	/// バイト列のハッシュ値
+	/// </summary>
+	static uint64_t Hash(const void* data, size_t size);
+
+  private:
+	uint64_t hash_ = kOffsetBasis;
+};
@@ -0,0 +1,145 @@
+﻿#pragma once
+
+#include <cstdint>
+
+// バックエンドのオブジェクト（D3D12ではID3D12PipelineStateなどをそのまま指す）
+struct RenderPipeline;
+struct RenderRootSignature;
+struct RenderDescriptorHeap;
+struct RenderCommandSignature;
+struct RenderBuffer;
+
+/// <summary>
+/// プリミティブトポロジ（値はD3D_PRIMITIVE_TOPOLOGYと同じ）
+/// </summary>
+enum class RenderTopology : uint32_t {
+	kPointList = 1,
+	kLineList = 2,
+	kLineStrip = 3,
+	kTriangleList = 4,
+	kTriangleStrip = 5,
+};
+
+/// <summary>
+/// インデックスの形式
+/// </summary>
+enum class RenderIndexFormat : uint32_t {
+	kUint16,
+	kUint32,
+};
+
+/// <summary>
+/// 頂点バッファビュー
+/// </summary>
+struct RenderVertexBufferView {
+	uint64_t address = 0; // GPUアドレス
+	uint32_t size = 0;    // サイズ（バイト）
+	uint32_t stride = 0;  // 1頂点のサイズ（バイト）
+};
+
+/// <summary>
+/// インデックスバッファビュー
+/// </summary>
+struct RenderIndexBufferView {
+	uint64_t address = 0; // GPUアドレス
+	uint32_t size = 0;    // サイズ（バイト）
+	RenderIndexFormat format = RenderIndexFormat::kUint16;
+};
+
+/// <summary>
+/// 描画コマンドの発行先
+/// （描画処理はこれを通してコマンドを積むので、D3D12以外に記録用のバックエンドへも流せる）
+/// </summary>
+class RenderCommandList {
+  public:
+	virtual ~RenderCommandList() = default;
+
+	/// <summary>
+	/// パイプラインステートの設定
+	/// </summary>
+	virtual void SetPipelineState(RenderPipeline* pipeline) = 0;
+
+	/// <summary>
+	/// ルートシグネチャの設定
+	/// </summary>
+	virtual void SetGraphicsRootSignature(RenderRootSignature* rootSignature) = 0;
+
+	/// <summary>
+	/// プリミティブトポロジの設定
+	/// </summary>
+	virtual void SetPrimitiveTopology(RenderTopology topology) = 0;
+
+	/// <summary>
+	/// 頂点バッファの設定
+	/// </summary>
+	/// <param name="startSlot">最初のスロット</param>
+	/// <param name="count">ビュー数</param>
+	/// <param name="views">ビューの配列</param>
+	virtual void SetVertexBuffers(
+	  uint32_t startSlot, uint32_t count, const RenderVertexBufferView* views) = 0;
+
+	/// <summary>
+	/// インデックスバッファの設定
+	/// </summary>
+	virtual void SetIndexBuffer(const RenderIndexBufferView& view) = 0;
+
+	/// <summary>
+	/// シェーダから見えるデスクリプタヒープの設定
+	/// </summary>
+	virtual void SetDescriptorHeap(RenderDescriptorHeap* descriptorHeap) = 0;
+
+	/// <summary>
+	/// ルートパラメータに定数バッファビューを設定
+	/// </summary>
+	virtual void SetGraphicsRootConstantBufferView(uint32_t rootParamIndex, uint64_t address) = 0;
+
+	/// <summary>
+	/// ルートパラメータにシェーダリソースビューを設定
+	/// </summary>
+	virtual void SetGraphicsRootShaderResourceView(uint32_t rootParamIndex, uint64_t address) = 0;
+
+	/// <summary>
+	/// ルートパラメータにデスクリプタテーブルを設定
+	/// </summary>
+	/// <param name="rootParamIndex">ルートパラメータ番号</param>
+	/// <param name="gpuDescriptor">テーブル先頭のGPUデスクリプタハンドル</param>
+	virtual void
+	  SetGraphicsRootDescriptorTable(uint32_t rootParamIndex, uint64_t gpuDescriptor) = 0;
+
+	/// <summary>
+	/// ルート定数の設定
+	/// </summary>
+	/// <param name="rootParamIndex">ルートパラメータ番号</param>
+	/// <param name="count">32bit値の数</param>
+	/// <param name="data">データ</param>
+	/// <param name="offset">書き込み先の位置（32bit単位）</param>
+	virtual void SetGraphicsRoot32BitConstants(
+	  uint32_t rootParamIndex, uint32_t count, const void* data, uint32_t offset) = 0;
+
+	/// <summary>
+	/// 描画
+	/// </summary>
+	virtual void DrawInstanced(
+	  uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex,
+	  uint32_t startInstance) = 0;
+
+	/// <summary>
+	/// インデックス付き描画
+	/// </summary>
+	virtual void DrawIndexedInstanced(
+	  uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+	  uint32_t startInstance) = 0;
+
+	/// <summary>
+	/// 引数バッファに並べたコマンドをまとめて発行する
+	/// </summary>
+	/// <param name="signature">コマンドシグネチャ</param>
+	/// <param name="maxCommandCount">コマンド数（数のバッファがあればその上限）</param>
+	/// <param name="argumentBuffer">引数バッファ</param>
+	/// <param name="argumentOffset">引数バッファの先頭からの位置（バイト）</param>
+	/// <param name="countBuffer">コマンド数のバッファ（無ければnullptr）</param>
+	/// <param name="countOffset">コマンド数のバッファの先頭からの位置（バイト）</param>
+	virtual void ExecuteIndirect(
+	  RenderCommandSignature* signature, uint32_t maxCommandCount, RenderBuffer* argumentBuffer,
+	  uint64_t argumentOffset, RenderBuffer* countBuffer, uint64_t countOffset) = 0;
+};
@@ -0,0 +1,318 @@
+﻿#include "RenderCommandRecorder.h"
+#include <cassert>
+#include <cstring>
+
+namespace {
+// コマンドごとの引数
+struct RootArgumentArgs {
+	uint32_t rootParamIndex;
+	uint32_t reserved;
+	uint64_t value;
+};
+
+struct VertexBuffersArgs {
+	uint32_t startSlot;
+	uint32_t count;
+};
+
+struct RootConstantsArgs {
+	uint32_t rootParamIndex;
+	uint32_t count;
+	uint32_t offset;
+};
+
+struct DrawArgs {
+	uint32_t vertexCount;
+	uint32_t instanceCount;
+	uint32_t startVertex;
+	uint32_t startInstance;
+};
+
+struct DrawIndexedArgs {
+	uint32_t indexCount;
+	uint32_t instanceCount;
+	uint32_t startIndex;
+	int32_t baseVertex;
+	uint32_t startInstance;
+};
+
+struct ExecuteIndirectArgs {
+	uint64_t signature;
+	uint64_t argumentBuffer;
+	uint64_t argumentOffset;
+	uint64_t countBuffer;
+	uint64_t countOffset;
+	uint32_t maxCommandCount;
+	uint32_t reserved;
+};
+
+// ポインタを値として比べる・記録する
+uint64_t ToValue(const void* pointer) { return reinterpret_cast<uintptr_t>(pointer); }
+
+template<class T> T* FromValue(uint64_t value) {
+	return reinterpret_cast<T*>(static_cast<uintptr_t>(value));
+}
+
+// バイト列から読み出す
+template<class T> T Read(const uint8_t* data) {
+	T value;
+	memcpy(&value, data, sizeof(T));
+	return value;
+}
+} // namespace
+
+const uint32_t RenderCommandRecorder::kMaxRootParameters;
+
+void RenderCommandRecorder::Clear() {
+	stream_.clear();
+	stats_ = Stats();
+	pipelineValid_ = false;
+	rootSignatureValid_ = false;
+	topologyValid_ = false;
+	descriptorHeapValid_ = false;
+	for (bool& valid : rootArgumentValid_) {
+		valid = false;
+	}
+}
+
+void RenderCommandRecorder::Replay(RenderCommandList& target) const {
+	const uint8_t* data = stream_.data();
+	const uint8_t* end = data + stream_.size();
+	while (data < end) {
+		Header header = Read<Header>(data);
+		const uint8_t* args = data + sizeof(Header);
+		data = args + header.size;
+
+		switch (header.op) {
+		case Op::kSetPipelineState:
+			target.SetPipelineState(FromValue<RenderPipeline>(Read<uint64_t>(args)));
+			break;
+		case Op::kSetGraphicsRootSignature:
+			target.SetGraphicsRootSignature(FromValue<RenderRootSignature>(Read<uint64_t>(args)));
+			break;
+		case Op::kSetPrimitiveTopology:
+			target.SetPrimitiveTopology(Read<RenderTopology>(args));
+			break;
+		case Op::kSetVertexBuffers: {
+			VertexBuffersArgs vb = Read<VertexBuffersArgs>(args);
+			// 引数の後ろに詰めて書いたビューを読み出して渡す
+			const uint32_t kMaxViews = 32;
+			assert(vb.count <= kMaxViews);
+			RenderVertexBufferView views[kMaxViews];
+			memcpy(
+			  views, args + sizeof(VertexBuffersArgs), sizeof(RenderVertexBufferView) * vb.count);
+			target.SetVertexBuffers(vb.startSlot, vb.count, views);
+			break;
+		}
+		case Op::kSetIndexBuffer:
+			target.SetIndexBuffer(Read<RenderIndexBufferView>(args));
+			break;
+		case Op::kSetDescriptorHeap:
+			target.SetDescriptorHeap(FromValue<RenderDescriptorHeap>(Read<uint64_t>(args)));
+			break;
+		case Op::kSetGraphicsRootConstantBufferView: {
+			RootArgumentArgs root = Read<RootArgumentArgs>(args);
+			target.SetGraphicsRootConstantBufferView(root.rootParamIndex, root.value);
+			break;
+		}
+		case Op::kSetGraphicsRootShaderResourceView: {
+			RootArgumentArgs root = Read<RootArgumentArgs>(args);
+			target.SetGraphicsRootShaderResourceView(root.rootParamIndex, root.value);
+			break;
+		}
+		case Op::kSetGraphicsRootDescriptorTable: {
+			RootArgumentArgs root = Read<RootArgumentArgs>(args);
+			target.SetGraphicsRootDescriptorTable(root.rootParamIndex, root.value);
+			break;
+		}
+		case Op::kSetGraphicsRoot32BitConstants: {
+			RootConstantsArgs constants = Read<RootConstantsArgs>(args);
+			// ルート定数はルートシグネチャ全体で64個までなので、その分の領域に読み出して渡す
+			const uint32_t kMaxConstants = 64;
+			assert(constants.count <= kMaxConstants);
+			uint32_t values[kMaxConstants];
+			memcpy(values, args + sizeof(RootConstantsArgs), sizeof(uint32_t) * constants.count);
+			target.SetGraphicsRoot32BitConstants(
+			  constants.rootParamIndex, constants.count, values, constants.offset);
+			break;
+		}
+		case Op::kDrawInstanced: {
+			DrawArgs draw = Read<DrawArgs>(args);
+			target.DrawInstanced(
+			  draw.vertexCount, draw.instanceCount, draw.startVertex, draw.startInstance);
+			break;
+		}
+		case Op::kDrawIndexedInstanced: {
+			DrawIndexedArgs draw = Read<DrawIndexedArgs>(args);
+			target.DrawIndexedInstanced(
+			  draw.indexCount, draw.instanceCount, draw.startIndex, draw.baseVertex,
+			  draw.startInstance);
+			break;
+		}
+		case Op::kExecuteIndirect: {
+			ExecuteIndirectArgs indirect = Read<ExecuteIndirectArgs>(args);
+			target.ExecuteIndirect(
+			  FromValue<RenderCommandSignature>(indirect.signature), indirect.maxCommandCount,
+			  FromValue<RenderBuffer>(indirect.argumentBuffer), indirect.argumentOffset,
+			  FromValue<RenderBuffer>(indirect.countBuffer), indirect.countOffset);
+			break;
+		}
+		}
+	}
+}
+
+void RenderCommandRecorder::SetPipelineState(RenderPipeline* pipeline) {
+	uint64_t value = ToValue(pipeline);
+	Write(Op::kSetPipelineState, &value, sizeof(value));
+	if (Track(pipeline_, pipelineValid_, value)) {
+		stats_.pipelineChanges++;
+	}
+}
+
+void RenderCommandRecorder::SetGraphicsRootSignature(RenderRootSignature* rootSignature) {
+	uint64_t value = ToValue(rootSignature);
+	Write(Op::kSetGraphicsRootSignature, &value, sizeof(value));
+	if (Track(rootSignature_, rootSignatureValid_, value)) {
+		stats_.rootSignatureChanges++;
+		// ルートシグネチャを変えるとルートパラメータは全て未設定に戻る
+		for (bool& valid : rootArgumentValid_) {
+			valid = false;
+		}
+	}
+}
+
+void RenderCommandRecorder::SetPrimitiveTopology(RenderTopology topology) {
+	Write(Op::kSetPrimitiveTopology, &topology, sizeof(topology));
+	Track(topology_, topologyValid_, static_cast<uint64_t>(topology));
+	stats_.bufferBindings++;
+}
+
+void RenderCommandRecorder::SetVertexBuffers(
+  uint32_t startSlot, uint32_t count, const RenderVertexBufferView* views) {
+	assert(views || count == 0);
+	VertexBuffersArgs args = {startSlot, count};
+	Write(
+	  Op::kSetVertexBuffers, &args, sizeof(args), views, sizeof(RenderVertexBufferView) * count);
+	stats_.bufferBindings++;
+}
+
+void RenderCommandRecorder::SetIndexBuffer(const RenderIndexBufferView& view) {
+	Write(Op::kSetIndexBuffer, &view, sizeof(view));
+	stats_.bufferBindings++;
+}
+
+void RenderCommandRecorder::SetDescriptorHeap(RenderDescriptorHeap* descriptorHeap) {
+	uint64_t value = ToValue(descriptorHeap);
+	Write(Op::kSetDescriptorHeap, &value, sizeof(value));
+	if (Track(descriptorHeap_, descriptorHeapValid_, value)) {
+		stats_.descriptorHeapChanges++;
+	}
+}
+
+void RenderCommandRecorder::SetGraphicsRootConstantBufferView(
+  uint32_t rootParamIndex, uint64_t address) {
+	RootArgumentArgs args = {rootParamIndex, 0, address};
+	Write(Op::kSetGraphicsRootConstantBufferView, &args, sizeof(args));
+	TrackRootArgument(rootParamIndex, address);
+}
+
+void RenderCommandRecorder::SetGraphicsRootShaderResourceView(
+  uint32_t rootParamIndex, uint64_t address) {
+	RootArgumentArgs args = {rootParamIndex, 0, address};
+	Write(Op::kSetGraphicsRootShaderResourceView, &args, sizeof(args));
+	TrackRootArgument(rootParamIndex, address);
+}
+
+void RenderCommandRecorder::SetGraphicsRootDescriptorTable(
+  uint32_t rootParamIndex, uint64_t gpuDescriptor) {
+	RootArgumentArgs args = {rootParamIndex, 0, gpuDescriptor};
+	Write(Op::kSetGraphicsRootDescriptorTable, &args, sizeof(args));
+	TrackRootArgument(rootParamIndex, gpuDescriptor);
+}
+
+void RenderCommandRecorder::SetGraphicsRoot32BitConstants(
+  uint32_t rootParamIndex, uint32_t count, const void* data, uint32_t offset) {
+	assert(data || count == 0);
+	RootConstantsArgs args = {rootParamIndex, count, offset};
+	Write(Op::kSetGraphicsRoot32BitConstants, &args, sizeof(args), data, sizeof(uint32_t) * count);
+	// 定数は中身が変わることが多いので重複は調べない
+	stats_.rootArgumentChanges++;
+	if (rootParamIndex < kMaxRootParameters) {
+		rootArgumentValid_[rootParamIndex] = false;
+	}
+}
+
+void RenderCommandRecorder::DrawInstanced(
+  uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) {
+	DrawArgs args = {vertexCount, instanceCount, startVertex, startInstance};
+	Write(Op::kDrawInstanced, &args, sizeof(args));
+	stats_.drawCount++;
+	stats_.vertexCount += static_cast<uint64_t>(vertexCount) * instanceCount;
+	stats_.instanceCount += instanceCount;
+}
+
+void RenderCommandRecorder::DrawIndexedInstanced(
+  uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+  uint32_t startInstance) {
+	DrawIndexedArgs args = {indexCount, instanceCount, startIndex, baseVertex, startInstance};
+	Write(Op::kDrawIndexedInstanced, &args, sizeof(args));
+	stats_.drawCount++;
+	stats_.vertexCount += static_cast<uint64_t>(indexCount) * instanceCount;
+	stats_.instanceCount += instanceCount;
+}
+
+void RenderCommandRecorder::ExecuteIndirect(
+  RenderCommandSignature* signature, uint32_t maxCommandCount, RenderBuffer* argumentBuffer,
+  uint64_t argumentOffset, RenderBuffer* countBuffer, uint64_t countOffset) {
+	assert(signature);
+	assert(argumentBuffer);
+	ExecuteIndirectArgs args;
+	args.signature = ToValue(signature);
+	args.argumentBuffer = ToValue(argumentBuffer);
+	args.argumentOffset = argumentOffset;
+	args.countBuffer = ToValue(countBuffer);
+	args.countOffset = countOffset;
+	args.maxCommandCount = maxCommandCount;
+	args.reserved = 0;
+	Write(Op::kExecuteIndirect, &args, sizeof(args));
+	// 引数バッファの中身はGPUのメモリにあって読めないので、コマンド数は上限で数える
+	stats_.indirectCount++;
+	stats_.indirectCommandCount += maxCommandCount;
+	// コマンドシグネチャで書き換えたルートパラメータは実行後に不定になる
+	for (bool& valid : rootArgumentValid_) {
+		valid = false;
+	}
+}
+
+void RenderCommandRecorder::Write(
+  Op op, const void* args, size_t argsSize, const void* extra, size_t extraSize) {
+	assert(argsSize + extraSize <= UINT16_MAX);
+	Header header = {op, 0, static_cast<uint16_t>(argsSize + extraSize)};
+
+	size_t offset = stream_.size();
+	stream_.resize(offset + sizeof(Header) + header.size);
+	uint8_t* dest = stream_.data() + offset;
+	memcpy(dest, &header, sizeof(Header));
+	memcpy(dest + sizeof(Header), args, argsSize);
+	if (extraSize) {
+		memcpy(dest + sizeof(Header) + argsSize, extra, extraSize);
+	}
+	stats_.commandCount++;
+}
+
+bool RenderCommandRecorder::Track(uint64_t& current, bool& valid, uint64_t value) {
+	if (valid && current == value) {
+		stats_.redundantChanges++;
+		return false;
+	}
+	current = value;
+	valid = true;
+	return true;
+}
+
+void RenderCommandRecorder::TrackRootArgument(uint32_t rootParamIndex, uint64_t value) {
+	stats_.rootArgumentChanges++;
+	if (rootParamIndex < kMaxRootParameters) {
+		Track(rootArguments_[rootParamIndex], rootArgumentValid_[rootParamIndex], value);
+	}
+}
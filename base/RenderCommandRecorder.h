@@ -0,0 +1,141 @@
+﻿#pragma once
+
+#include "RenderCommandList.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 描画コマンドの記録用バックエンド（GPUを使わずにコマンドを詰めたバイト列に記録する）
+/// （描画回数や状態の切り替え回数を数えるので、GPUの無い環境でも描画処理を計測・検証できる）
+/// </summary>
+class RenderCommandRecorder : public RenderCommandList {
+  public:
+	// 状態の重複を調べるルートパラメータ数
+	static const uint32_t kMaxRootParameters = 16;
+
+	/// <summary>
+	/// 記録したコマンドの統計
+	/// </summary>
+	struct Stats {
+		uint32_t commandCount = 0;          // コマンド数
+		uint32_t drawCount = 0;             // 描画回数
+		uint64_t vertexCount = 0;           // 頂点（インデックス）数×インスタンス数の合計
+		uint64_t instanceCount = 0;         // インスタンス数の合計
+		uint32_t pipelineChanges = 0;       // パイプラインステートの切り替え
+		uint32_t rootSignatureChanges = 0;  // ルートシグネチャの切り替え
+		uint32_t descriptorHeapChanges = 0; // デスクリプタヒープの切り替え
+		uint32_t rootArgumentChanges = 0;   // ルートパラメータの設定
+		uint32_t bufferBindings = 0;        // 頂点・インデックスバッファとトポロジの設定
+		uint32_t redundantChanges = 0;      // 既に設定済みの値をもう一度設定した回数
+		uint32_t indirectCount = 0;         // ExecuteIndirectの回数
+		uint64_t indirectCommandCount = 0;  // ExecuteIndirectのコマンド数（上限）の合計
+	};
+
+	/// <summary>
+	/// 記録を捨てて統計を戻す
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// 記録したバイト列の取得
+	/// </summary>
+	const uint8_t* GetData() const { return stream_.data(); }
+
+	/// <summary>
+	/// 記録したバイト数
+	/// </summary>
+	size_t GetSize() const { return stream_.size(); }
+
+	/// <summary>
+	/// 統計の取得
+	/// </summary>
+	const Stats& GetStats() const { return stats_; }
+
+	/// <summary>
+	/// 記録したコマンドを順に別の発行先へ流す
+	/// </summary>
+	/// <param name="target">発行先</param>
+	void Replay(RenderCommandList& target) const;
+
+	void SetPipelineState(RenderPipeline* pipeline) override;
+	void SetGraphicsRootSignature(RenderRootSignature* rootSignature) override;
+	void SetPrimitiveTopology(RenderTopology topology) override;
+	void SetVertexBuffers(
+	  uint32_t startSlot, uint32_t count, const RenderVertexBufferView* views) override;
+	void SetIndexBuffer(const RenderIndexBufferView& view) override;
+	void SetDescriptorHeap(RenderDescriptorHeap* descriptorHeap) override;
+	void SetGraphicsRootConstantBufferView(uint32_t rootParamIndex, uint64_t address) override;
+	void SetGraphicsRootShaderResourceView(uint32_t rootParamIndex, uint64_t address) override;
+	void SetGraphicsRootDescriptorTable(uint32_t rootParamIndex, uint64_t gpuDescriptor) override;
+	void SetGraphicsRoot32BitConstants(
+	  uint32_t rootParamIndex, uint32_t count, const void* data, uint32_t offset) override;
+	void DrawInstanced(
+	  uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex,
+	  uint32_t startInstance) override;
+	void DrawIndexedInstanced(
+	  uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+	  uint32_t startInstance) override;
+	void ExecuteIndirect(
+	  RenderCommandSignature* signature, uint32_t maxCommandCount, RenderBuffer* argumentBuffer,
+	  uint64_t argumentOffset, RenderBuffer* countBuffer, uint64_t countOffset) override;
+
+  private:
+	// コマンドの種類
+	enum class Op : uint8_t {
+		kSetPipelineState,
+		kSetGraphicsRootSignature,
+		kSetPrimitiveTopology,
+		kSetVertexBuffers,
+		kSetIndexBuffer,
+		kSetDescriptorHeap,
+		kSetGraphicsRootConstantBufferView,
+		kSetGraphicsRootShaderResourceView,
+		kSetGraphicsRootDescriptorTable,
+		kSetGraphicsRoot32BitConstants,
+		kDrawInstanced,
+		kDrawIndexedInstanced,
+		kExecuteIndirect,
+	};
+
+	// コマンドの先頭（続く引数のバイト数を持つ）
+	struct Header {
+		Op op;
+		uint8_t reserved;
+		uint16_t size;
+	};
+
+	/// <summary>
+	/// コマンドを末尾に書き込む（引数は2つに分けて渡せる）
+	/// </summary>
+	void Write(
+	  Op op, const void* args, size_t argsSize, const void* extra = nullptr, size_t extraSize = 0);
+
+	/// <summary>
+	/// 設定済みの値と比べて、同じなら重複として数える
+	/// </summary>
+	/// <returns>値が変わったか</returns>
+	bool Track(uint64_t& current, bool& valid, uint64_t value);
+
+	/// <summary>
+	/// ルートパラメータの設定を記録する
+	/// </summary>
+	void TrackRootArgument(uint32_t rootParamIndex, uint64_t value);
+
+	// 記録したコマンド
+	std::vector<uint8_t> stream_;
+	// 統計
+	Stats stats_;
+
+	// 設定中の状態（重複の判定用）
+	uint64_t pipeline_ = 0;
+	uint64_t rootSignature_ = 0;
+	uint64_t topology_ = 0;
+	uint64_t descriptorHeap_ = 0;
+	uint64_t rootArguments_[kMaxRootParameters] = {};
+	bool pipelineValid_ = false;
+	bool rootSignatureValid_ = false;
+	bool topologyValid_ = false;
+	bool descriptorHeapValid_ = false;
+	bool rootArgumentValid_[kMaxRootParameters] = {};
+};
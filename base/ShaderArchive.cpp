@@ -0,0 +1,269 @@
+﻿#include "ShaderArchive.h"
+#include "PipelineHasher.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace {
+// ファイルの識別子
+const char kMagic[4] = {'S', 'H', 'D', 'A'};
+// バイトコードの配置境界
+const size_t kAlignment = 8;
+
+// 境界に切り上げ
+size_t AlignUp(size_t size) { return (size + kAlignment - 1) / kAlignment * kAlignment; }
+
+// リフレクション情報の書き込み
+class ReflectionWriter {
+  public:
+	void AddUint32(uint32_t value) {
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+		data_.insert(data_.end(), bytes, bytes + sizeof(value));
+	}
+	void AddString(const std::string& text) {
+		AddUint32(static_cast<uint32_t>(text.size()));
+		data_.insert(data_.end(), text.begin(), text.end());
+	}
+	std::vector<uint8_t>& GetData() { return data_; }
+
+  private:
+	std::vector<uint8_t> data_;
+};
+
+// リフレクション情報の読み込み（範囲外を読もうとしたら失敗を返す）
+class ReflectionReader {
+  public:
+	ReflectionReader(const void* data, size_t size)
+	    : data_(static_cast<const uint8_t*>(data)), size_(size) {}
+	bool ReadUint32(uint32_t& value) {
+		if (size_ - position_ < sizeof(value)) {
+			return false;
+		}
+		memcpy(&value, data_ + position_, sizeof(value));
+		position_ += sizeof(value);
+		return true;
+	}
+	bool ReadString(std::string& text) {
+		uint32_t length;
+		if (!ReadUint32(length) || size_ - position_ < length) {
+			return false;
+		}
+		text.assign(reinterpret_cast<const char*>(data_ + position_), length);
+		position_ += length;
+		return true;
+	}
+	// 要素数（残りの大きさで上限を抑えて、壊れたデータで巨大な確保をしない）
+	bool ReadCount(uint32_t& count) {
+		return ReadUint32(count) && count <= (size_ - position_) / sizeof(uint32_t);
+	}
+	bool IsEnd() const { return position_ == size_; }
+
+  private:
+	const uint8_t* data_;
+	size_t size_;
+	size_t position_ = 0;
+};
+
+// リフレクション情報のシリアライズ
+std::vector<uint8_t> SerializeReflection(const ShaderReflection& reflection) {
+	ReflectionWriter writer;
+	writer.AddUint32(static_cast<uint32_t>(reflection.constantBuffers.size()));
+	for (const ShaderReflection::ConstantBuffer& constantBuffer : reflection.constantBuffers) {
+		writer.AddString(constantBuffer.name);
+		writer.AddUint32(constantBuffer.size);
+		writer.AddUint32(constantBuffer.bindPoint);
+		writer.AddUint32(constantBuffer.space);
+		writer.AddUint32(static_cast<uint32_t>(constantBuffer.variables.size()));
+		for (const ShaderReflection::Variable& variable : constantBuffer.variables) {
+			writer.AddString(variable.name);
+			writer.AddUint32(variable.offset);
+			writer.AddUint32(variable.size);
+		}
+	}
+	writer.AddUint32(static_cast<uint32_t>(reflection.bindings.size()));
+	for (const ShaderReflection::Binding& binding : reflection.bindings) {
+		writer.AddString(binding.name);
+		writer.AddUint32(binding.type);
+		writer.AddUint32(binding.bindPoint);
+		writer.AddUint32(binding.bindCount);
+		writer.AddUint32(binding.space);
+	}
+	return std::move(writer.GetData());
+}
+} // namespace
+
+const uint32_t ShaderArchive::kVersion;
+
+const ShaderReflection::ConstantBuffer*
+  ShaderReflection::FindConstantBuffer(const std::string& name) const {
+	for (const ConstantBuffer& constantBuffer : constantBuffers) {
+		if (constantBuffer.name == name) {
+			return &constantBuffer;
+		}
+	}
+	return nullptr;
+}
+
+uint64_t ShaderArchive::MakeKey(
+  const std::wstring& fileName, const std::string& entryPoint, const std::string& target,
+  const std::vector<ShaderDefine>& defines, uint32_t flags) {
+	PipelineHasher hasher;
+	// wchar_tの大きさは環境で違うので1文字ずつ32ビットで足す
+	hasher.AddUint64(fileName.size());
+	for (wchar_t c : fileName) {
+		hasher.AddUint32(static_cast<uint32_t>(c));
+	}
+	hasher.AddString(entryPoint.c_str());
+	hasher.AddString(target.c_str());
+	hasher.AddUint64(defines.size());
+	for (const ShaderDefine& define : defines) {
+		hasher.AddString(define.name.c_str());
+		hasher.AddString(define.value.c_str());
+	}
+	hasher.AddUint32(flags);
+	return hasher.Get();
+}
+
+std::vector<uint8_t> ShaderArchive::Write(std::vector<Entry> entries) {
+	std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+		return lhs.key < rhs.key;
+	});
+
+	std::vector<std::vector<uint8_t>> reflections;
+	reflections.reserve(entries.size());
+	for (const Entry& entry : entries) {
+		reflections.push_back(SerializeReflection(entry.reflection));
+	}
+
+	// 配置を決める（ヘッダ、目次、各エントリのバイトコードとリフレクション情報の順）
+	std::vector<Record> records(entries.size());
+	size_t offset = AlignUp(sizeof(Header) + sizeof(Record) * records.size());
+	for (size_t i = 0; i < entries.size(); i++) {
+		assert(i == 0 || entries[i - 1].key != entries[i].key);
+		records[i].key = entries[i].key;
+		records[i].sourceHash = entries[i].sourceHash;
+		records[i].bytecodeOffset = offset;
+		records[i].bytecodeSize = entries[i].bytecode.size();
+		offset = AlignUp(offset + entries[i].bytecode.size());
+		records[i].reflectionOffset = offset;
+		records[i].reflectionSize = reflections[i].size();
+		offset = AlignUp(offset + reflections[i].size());
+	}
+
+	std::vector<uint8_t> data(offset, 0);
+	Header header;
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.entryCount = static_cast<uint32_t>(records.size());
+	header.reserved = 0;
+	memcpy(data.data(), &header, sizeof(header));
+	if (!records.empty()) {
+		memcpy(data.data() + sizeof(header), records.data(), sizeof(Record) * records.size());
+	}
+	for (size_t i = 0; i < entries.size(); i++) {
+		std::copy(
+		  entries[i].bytecode.begin(), entries[i].bytecode.end(),
+		  data.begin() + static_cast<ptrdiff_t>(records[i].bytecodeOffset));
+		std::copy(
+		  reflections[i].begin(), reflections[i].end(),
+		  data.begin() + static_cast<ptrdiff_t>(records[i].reflectionOffset));
+	}
+	return data;
+}
+
+bool ShaderArchive::ReadReflection(const void* data, size_t size, ShaderReflection& reflection) {
+	reflection = ShaderReflection();
+	ReflectionReader reader(data, size);
+
+	uint32_t constantBufferCount;
+	if (!reader.ReadCount(constantBufferCount)) {
+		return false;
+	}
+	reflection.constantBuffers.resize(constantBufferCount);
+	for (ShaderReflection::ConstantBuffer& constantBuffer : reflection.constantBuffers) {
+		uint32_t variableCount;
+		if (!reader.ReadString(constantBuffer.name) || !reader.ReadUint32(constantBuffer.size) ||
+		    !reader.ReadUint32(constantBuffer.bindPoint) ||
+		    !reader.ReadUint32(constantBuffer.space) || !reader.ReadCount(variableCount)) {
+			return false;
+		}
+		constantBuffer.variables.resize(variableCount);
+		for (ShaderReflection::Variable& variable : constantBuffer.variables) {
+			if (!reader.ReadString(variable.name) || !reader.ReadUint32(variable.offset) ||
+			    !reader.ReadUint32(variable.size)) {
+				return false;
+			}
+		}
+	}
+
+	uint32_t bindingCount;
+	if (!reader.ReadCount(bindingCount)) {
+		return false;
+	}
+	reflection.bindings.resize(bindingCount);
+	for (ShaderReflection::Binding& binding : reflection.bindings) {
+		if (!reader.ReadString(binding.name) || !reader.ReadUint32(binding.type) ||
+		    !reader.ReadUint32(binding.bindPoint) || !reader.ReadUint32(binding.bindCount) ||
+		    !reader.ReadUint32(binding.space)) {
+			return false;
+		}
+	}
+	return reader.IsEnd();
+}
+
+bool ShaderArchive::Open(const void* data, size_t size) {
+	Close();
+
+	Header header;
+	if (!data || size < sizeof(header)) {
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+		return false;
+	}
+
+	// 目次と各エントリがデータに収まっているか
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	if ((size - sizeof(header)) / sizeof(Record) < header.entryCount) {
+		return false;
+	}
+	const Record* records = reinterpret_cast<const Record*>(bytes + sizeof(header));
+	for (uint32_t i = 0; i < header.entryCount; i++) {
+		const Record& record = records[i];
+		if ((0 < i && record.key <= records[i - 1].key) || size < record.bytecodeOffset ||
+		    size - record.bytecodeOffset < record.bytecodeSize || size < record.reflectionOffset ||
+		    size - record.reflectionOffset < record.reflectionSize) {
+			return false;
+		}
+	}
+
+	data_ = bytes;
+	size_ = size;
+	records_ = records;
+	entryCount_ = header.entryCount;
+	return true;
+}
+
+void ShaderArchive::Close() {
+	data_ = nullptr;
+	size_ = 0;
+	records_ = nullptr;
+	entryCount_ = 0;
+}
+
+bool ShaderArchive::Find(uint64_t key, View& view) const {
+	const Record* end = records_ + entryCount_;
+	const Record* it = std::lower_bound(
+	  records_, end, key, [](const Record& record, uint64_t value) { return record.key < value; });
+	if (it == end || it->key != key) {
+		return false;
+	}
+
+	view.sourceHash = it->sourceHash;
+	view.bytecode = data_ + it->bytecodeOffset;
+	view.bytecodeSize = static_cast<size_t>(it->bytecodeSize);
+	view.reflection = data_ + it->reflectionOffset;
+	view.reflectionSize = static_cast<size_t>(it->reflectionSize);
+	return true;
+}
@@ -0,0 +1,163 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// シェーダのマクロ定義（バリエーションの指定）
+/// </summary>
+struct ShaderDefine {
+	std::string name;
+	std::string value;
+};
+
+/// <summary>
+/// シェーダのリフレクション情報
+/// </summary>
+struct ShaderReflection {
+	// 定数バッファのメンバ
+	struct Variable {
+		std::string name;
+		uint32_t offset = 0; // バイト
+		uint32_t size = 0;   // バイト
+	};
+	// 定数バッファ
+	struct ConstantBuffer {
+		std::string name;
+		uint32_t size = 0; // バイト
+		uint32_t bindPoint = 0;
+		uint32_t space = 0;
+		std::vector<Variable> variables;
+	};
+	// リソースの割り当て
+	struct Binding {
+		std::string name;
+		uint32_t type = 0; // D3D_SHADER_INPUT_TYPE
+		uint32_t bindPoint = 0;
+		uint32_t bindCount = 0;
+		uint32_t space = 0;
+	};
+
+	std::vector<ConstantBuffer> constantBuffers;
+	std::vector<Binding> bindings;
+
+	/// <summary>
+	/// 定数バッファの検索
+	/// </summary>
+	/// <param name="name">名前</param>
+	/// <returns>定数バッファ（無ければnullptr）</returns>
+	const ConstantBuffer* FindConstantBuffer(const std::string& name) const;
+};
+
+/// <summary>
+/// コンパイル済みシェーダのアーカイブ
+/// （オフラインでまとめたバイトコードとリフレクション情報を、メモリ上の1つのファイルから引く）
+/// </summary>
+class ShaderArchive {
+  public:
+	// ファイルの版（形式を変えたら上げる）
+	static const uint32_t kVersion = 1;
+
+	/// <summary>
+	/// 書き込むエントリ
+	/// </summary>
+	struct Entry {
+		uint64_t key = 0;        // MakeKeyで作るキー
+		uint64_t sourceHash = 0; // ソースとインクルードの内容のハッシュ
+		std::vector<uint8_t> bytecode;
+		ShaderReflection reflection;
+	};
+
+	/// <summary>
+	/// 読み込んだエントリ（アーカイブのデータを直接指す）
+	/// </summary>
+	struct View {
+		uint64_t sourceHash = 0;
+		const void* bytecode = nullptr;
+		size_t bytecodeSize = 0;
+		const void* reflection = nullptr;
+		size_t reflectionSize = 0;
+	};
+
+	/// <summary>
+	/// エントリのキー
+	/// </summary>
+	/// <param name="fileName">ファイル名（ディレクトリを除く）</param>
+	/// <param name="entryPoint">エントリポイント</param>
+	/// <param name="target">シェーダプロファイル</param>
+	/// <param name="defines">マクロ定義</param>
+	/// <param name="flags">コンパイルフラグ</param>
+	/// <returns>キー</returns>
+	static uint64_t MakeKey(
+	  const std::wstring& fileName, const std::string& entryPoint, const std::string& target,
+	  const std::vector<ShaderDefine>& defines, uint32_t flags);
+
+	/// <summary>
+	/// アーカイブのデータを作る
+	/// </summary>
+	/// <param name="entries">エントリ（キーの重複は不可）</param>
+	/// <returns>ファイルに書き込むデータ</returns>
+	static std::vector<uint8_t> Write(std::vector<Entry> entries);
+
+	/// <summary>
+	/// リフレクション情報の復元
+	/// </summary>
+	/// <param name="data">Viewのreflection</param>
+	/// <param name="size">Viewのreflection</param>
+	/// <param name="reflection">復元先</param>
+	/// <returns>成否</returns>
+	static bool ReadReflection(const void* data, size_t size, ShaderReflection& reflection);
+
+	/// <summary>
+	/// データを開く（コピーせずに指したまま使うので、閉じるまで解放しないこと）
+	/// </summary>
+	/// <param name="data">データ</param>
+	/// <param name="size">サイズ（バイト）</param>
+	/// <returns>形式が正しいか</returns>
+	bool Open(const void* data, size_t size);
+
+	/// <summary>
+	/// 閉じる
+	/// </summary>
+	void Close();
+
+	/// <summary>
+	/// エントリの検索
+	/// </summary>
+	/// <param name="key">キー</param>
+	/// <param name="view">見つかったエントリ</param>
+	/// <returns>見つかったか</returns>
+	bool Find(uint64_t key, View& view) const;
+
+	/// <summary>
+	/// エントリ数の取得
+	/// </summary>
+	uint32_t GetEntryCount() const { return entryCount_; }
+
+  private:
+	// ファイルヘッダ
+	struct Header {
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+	};
+	// エントリの目次（キー順に並べる）
+	struct Record {
+		uint64_t key;
+		uint64_t sourceHash;
+		uint64_t bytecodeOffset;
+		uint64_t bytecodeSize;
+		uint64_t reflectionOffset;
+		uint64_t reflectionSize;
+	};
+
+	// データ
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+	// 目次
+	const Record* records_ = nullptr;
+	uint32_t entryCount_ = 0;
+};
@@ -0,0 +1,179 @@
+﻿#include "ShaderCompiler.h"
+#include "PipelineHasher.h"
+#include <algorithm>
+#include <cwctype>
+#include <d3d12shader.h>
+#include <d3dcompiler.h>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#pragma comment(lib, "d3dcompiler.lib")
+#pragma comment(lib, "dxguid.lib")
+
+using namespace Microsoft::WRL;
+
+namespace {
+// ファイルの読み込み
+bool ReadFile(const std::wstring& filePath, std::string& text) {
+	std::ifstream file(filePath, std::ios::binary);
+	if (file.fail()) {
+		return false;
+	}
+	text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+// #include "..." の取り出し（<...>は標準のインクルードハンドラでも解決しないので見ない）
+std::vector<std::string> FindIncludes(const std::string& text) {
+	std::vector<std::string> includes;
+	std::istringstream stream(text);
+	std::string line;
+	while (std::getline(stream, line)) {
+		size_t pos = line.find_first_not_of(" \t");
+		if (pos == std::string::npos || line[pos] != '#') {
+			continue;
+		}
+		pos = line.find_first_not_of(" \t", pos + 1);
+		if (pos == std::string::npos || line.compare(pos, 7, "include") != 0) {
+			continue;
+		}
+		size_t begin = line.find('"', pos + 7);
+		size_t end = begin == std::string::npos ? begin : line.find('"', begin + 1);
+		if (end != std::string::npos) {
+			includes.push_back(line.substr(begin + 1, end - begin - 1));
+		}
+	}
+	return includes;
+}
+
+// ファイルとそのインクルードを辿り、hasherがあれば内容を足す（一度辿ったファイルは飛ばす）
+bool AddSource(
+  const std::wstring& filePath, PipelineHasher* hasher, std::vector<std::wstring>& visited) {
+	std::wstring normalized = ShaderCompiler::NormalizePath(filePath);
+	if (std::find(visited.begin(), visited.end(), normalized) != visited.end()) {
+		return true;
+	}
+	visited.push_back(normalized);
+
+	std::string text;
+	if (!ReadFile(filePath, text)) {
+		return false;
+	}
+	if (hasher) {
+		hasher->AddBlock(text.data(), text.size());
+	}
+
+	// インクルードはインクルード元のディレクトリから探す
+	std::wstring directory =
+	  filePath.substr(0, filePath.size() - ShaderCompiler::GetFileName(filePath).size());
+	for (const std::string& include : FindIncludes(text)) {
+		if (!AddSource(directory + std::wstring(include.begin(), include.end()), hasher, visited)) {
+			return false;
+		}
+	}
+	return true;
+}
+} // namespace
+
+const uint32_t ShaderCompiler::kFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+
+bool ShaderCompiler::Compile(
+  const std::wstring& filePath, const std::string& entryPoint, const std::string& target,
+  const std::vector<ShaderDefine>& defines, ComPtr<ID3DBlob>& blob, std::string* errors) {
+	std::vector<D3D_SHADER_MACRO> macros;
+	for (const ShaderDefine& define : defines) {
+		macros.push_back({define.name.c_str(), define.value.c_str()});
+	}
+	macros.push_back({nullptr, nullptr});
+
+	ComPtr<ID3DBlob> errorBlob;
+	HRESULT result = D3DCompileFromFile(
+	  filePath.c_str(), macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE, entryPoint.c_str(),
+	  target.c_str(), kFlags, 0, &blob, &errorBlob);
+	if (errors) {
+		errors->clear();
+		if (errorBlob) {
+			errors->assign(
+			  static_cast<const char*>(errorBlob->GetBufferPointer()), errorBlob->GetBufferSize());
+		}
+	}
+	return SUCCEEDED(result);
+}
+
+bool ShaderCompiler::Reflect(const void* bytecode, size_t size, ShaderReflection& reflection) {
+	reflection = ShaderReflection();
+
+	ComPtr<ID3D12ShaderReflection> reflector;
+	if (FAILED(D3DReflect(bytecode, size, IID_PPV_ARGS(&reflector)))) {
+		return false;
+	}
+	D3D12_SHADER_DESC shaderDesc;
+	reflector->GetDesc(&shaderDesc);
+
+	// 定数バッファのレイアウト
+	for (UINT i = 0; i < shaderDesc.ConstantBuffers; i++) {
+		ID3D12ShaderReflectionConstantBuffer* constantBuffer =
+		  reflector->GetConstantBufferByIndex(i);
+		D3D12_SHADER_BUFFER_DESC bufferDesc;
+		constantBuffer->GetDesc(&bufferDesc);
+		if (bufferDesc.Type != D3D_CT_CBUFFER) {
+			continue;
+		}
+
+		ShaderReflection::ConstantBuffer layout;
+		layout.name = bufferDesc.Name;
+		layout.size = bufferDesc.Size;
+		D3D12_SHADER_INPUT_BIND_DESC bindDesc;
+		if (SUCCEEDED(reflector->GetResourceBindingDescByName(bufferDesc.Name, &bindDesc))) {
+			layout.bindPoint = bindDesc.BindPoint;
+			layout.space = bindDesc.Space;
+		}
+		for (UINT j = 0; j < bufferDesc.Variables; j++) {
+			D3D12_SHADER_VARIABLE_DESC variableDesc;
+			constantBuffer->GetVariableByIndex(j)->GetDesc(&variableDesc);
+			layout.variables.push_back(
+			  {variableDesc.Name, variableDesc.StartOffset, variableDesc.Size});
+		}
+		reflection.constantBuffers.push_back(std::move(layout));
+	}
+
+	// リソースの割り当て
+	for (UINT i = 0; i < shaderDesc.BoundResources; i++) {
+		D3D12_SHADER_INPUT_BIND_DESC bindDesc;
+		reflector->GetResourceBindingDesc(i, &bindDesc);
+		reflection.bindings.push_back(
+		  {bindDesc.Name, static_cast<uint32_t>(bindDesc.Type), bindDesc.BindPoint,
+		   bindDesc.BindCount, bindDesc.Space});
+	}
+	return true;
+}
+
+uint64_t ShaderCompiler::HashSource(const std::wstring& filePath) {
+	PipelineHasher hasher;
+	std::vector<std::wstring> visited;
+	if (!AddSource(filePath, &hasher, visited)) {
+		return 0;
+	}
+	// 読めたときに0を返さない
+	uint64_t hash = hasher.Get();
+	return hash == 0 ? 1 : hash;
+}
+
+bool ShaderCompiler::CollectSources(
+  const std::wstring& filePath, std::vector<std::wstring>& sources) {
+	sources.clear();
+	return AddSource(filePath, nullptr, sources);
+}
+
+std::wstring ShaderCompiler::NormalizePath(const std::wstring& filePath) {
+	std::wstring normalized = filePath;
+	std::replace(normalized.begin(), normalized.end(), L'\\', L'/');
+	std::transform(normalized.begin(), normalized.end(), normalized.begin(), towlower);
+	return normalized;
+}
+
+std::wstring ShaderCompiler::GetFileName(const std::wstring& filePath) {
+	size_t pos = filePath.find_last_of(L"/\\");
+	return pos == std::wstring::npos ? filePath : filePath.substr(pos + 1);
+}
@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include "ShaderArchive.h"
+#include <d3dcommon.h>
+#include <string>
+#include <vector>
+#include <wrl.h>
+
+/// <summary>
+/// HLSLのコンパイル
+/// （実行時のフォールバックとオフラインのアーカイブ作成で同じ設定を使う）
+/// </summary>
+class ShaderCompiler {
+  public:
+	// コンパイルフラグ（アーカイブのキーにも含める）
+	static const uint32_t kFlags;
+
+	/// <summary>
+	/// コンパイル
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <param name="entryPoint">エントリポイント</param>
+	/// <param name="target">シェーダプロファイル</param>
+	/// <param name="defines">マクロ定義</param>
+	/// <param name="blob">バイトコード</param>
+	/// <param name="errors">エラー内容の格納先（不要ならnullptr）</param>
+	/// <returns>成否</returns>
+	static bool Compile(
+	  const std::wstring& filePath, const std::string& entryPoint, const std::string& target,
+	  const std::vector<ShaderDefine>& defines, Microsoft::WRL::ComPtr<ID3DBlob>& blob,
+	  std::string* errors = nullptr);
+
+	/// <summary>
+	/// リフレクション情報の取得
+	/// </summary>
+	/// <param name="bytecode">バイトコード</param>
+	/// <param name="size">サイズ（バイト）</param>
+	/// <param name="reflection">格納先</param>
+	/// <returns>成否</returns>
+	static bool Reflect(const void* bytecode, size_t size, ShaderReflection& reflection);
+
+	/// <summary>
+	/// ソースの内容のハッシュ（#include "..."で読むファイルも含める）
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>ハッシュ値（ソースが読めなければ0）</returns>
+	static uint64_t HashSource(const std::wstring& filePath);
+
+	/// <summary>
+	/// ソースと#include "..."で読むファイルの一覧（HashSourceと同じ順で、パスは正規化する）
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <param name="sources">格納先</param>
+	/// <returns>全て読めればtrue</returns>
+	static bool CollectSources(const std::wstring& filePath, std::vector<std::wstring>& sources);
+
+	/// <summary>
+	/// パスの正規化（区切りを/に、英字を小文字にそろえる）
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>正規化したパス</returns>
+	static std::wstring NormalizePath(const std::wstring& filePath);
+
+	/// <summary>
+	/// パスからファイル名だけを取り出す
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>ファイル名</returns>
+	static std::wstring GetFileName(const std::wstring& filePath);
+};
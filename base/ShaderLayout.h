@@ -0,0 +1,68 @@
+﻿#pragma once
+
+#include <cstddef>
+
+// シェーダと共有する定数バッファの並びからC++の構造体を作る仕組み
+//
+// 並びは .hlsli に FOO_LAYOUT(FIELD, ARRAY, S) の形のマクロで書き、HLSLとC++の両方から読み込む。
+// 中身はメンバの順に FIELD(S, 型, 名前) と ARRAY(S, 型, 名前, 要素数) を並べたもの。
+// 型名はHLSLのもの（float, float2, float3, float4, uint, matrix と、先に定義した構造体）で書き、
+// パディングも明示的に書く。C++側では SHADER_LAYOUT_STRUCT で構造体にすると同時に、
+// HLSLの詰め方の規則（16バイトのレジスタをまたがない、配列と構造体はレジスタの先頭から）に
+// 合っているかをコンパイル時に検査する。型名は使う側の名前空間で別名を用意すること。
+
+namespace ShaderLayout {
+
+// 定数バッファのレジスタの大きさ（バイト）
+const size_t kRegisterSize = 16;
+
+/// <summary>
+/// メンバの配置がHLSLと同じになるか（16バイト未満はレジスタをまたがない、以上は先頭から）
+/// </summary>
+constexpr bool IsPackedField(size_t offset, size_t size) {
+	return size < kRegisterSize ? offset / kRegisterSize == (offset + size - 1) / kRegisterSize
+	                            : offset % kRegisterSize == 0;
+}
+
+/// <summary>
+/// 配列の配置がHLSLと同じになるか（要素ごとにレジスタの先頭から並ぶ）
+/// </summary>
+constexpr bool IsPackedArray(size_t offset, size_t elementSize) {
+	return offset % kRegisterSize == 0 && elementSize % kRegisterSize == 0;
+}
+
+} // namespace ShaderLayout
+
+// 構造体のメンバの宣言
+#define SHADER_LAYOUT_DECLARE_FIELD(S, type, name) type name;
+#define SHADER_LAYOUT_DECLARE_ARRAY(S, type, name, count) type name[count];
+
+// 並びの検査
+#define SHADER_LAYOUT_CHECK_FIELD(S, type, name)                                                   \
+	static_assert(                                                                                 \
+	  ShaderLayout::IsPackedField(offsetof(S, name), sizeof(type)),                                \
+	  #S "::" #name " straddles a 16-byte register");
+#define SHADER_LAYOUT_CHECK_ARRAY(S, type, name, count)                                            \
+	static_assert(                                                                                 \
+	  ShaderLayout::IsPackedArray(offsetof(S, name), sizeof(type)),                                \
+	  #S "::" #name " elements are not aligned to 16-byte registers");
+
+// メンバの大きさの合計（C++の暗黙のパディングが無いことの確認用）
+#define SHADER_LAYOUT_SIZE_FIELD(S, type, name) +sizeof(type)
+#define SHADER_LAYOUT_SIZE_ARRAY(S, type, name, count) +sizeof(type) * (count)
+
+// 定数バッファの構造体
+#define SHADER_LAYOUT_STRUCT(S, LAYOUT)                                                            \
+	struct S {                                                                                     \
+		LAYOUT(SHADER_LAYOUT_DECLARE_FIELD, SHADER_LAYOUT_DECLARE_ARRAY, S)                        \
+	};                                                                                             \
+	LAYOUT(SHADER_LAYOUT_CHECK_FIELD, SHADER_LAYOUT_CHECK_ARRAY, S)                                \
+	static_assert(                                                                                 \
+	  sizeof(S) == 0 LAYOUT(SHADER_LAYOUT_SIZE_FIELD, SHADER_LAYOUT_SIZE_ARRAY, S),                \
+	  #S " has implicit padding");
+
+// 配列やメンバに使う構造体（HLSLでは大きさがレジスタ単位になるので、末尾のパディングも書く）
+#define SHADER_LAYOUT_ELEMENT_STRUCT(S, LAYOUT)                                                    \
+	SHADER_LAYOUT_STRUCT(S, LAYOUT)                                                                \
+	static_assert(                                                                                 \
+	  sizeof(S) % ShaderLayout::kRegisterSize == 0, #S " is not a multiple of 16 bytes");
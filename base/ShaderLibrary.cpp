@@ -0,0 +1,133 @@
+﻿#include "ShaderLibrary.h"
+#include "ShaderCompiler.h"
+#include <chrono>
+#include <cstdlib>
+
+using namespace Microsoft::WRL;
+
+namespace {
+// バイトコードの設定
+D3D12_SHADER_BYTECODE MakeBytecode(const void* data, size_t size) {
+	D3D12_SHADER_BYTECODE bytecode;
+	bytecode.pShaderBytecode = data;
+	bytecode.BytecodeLength = size;
+	return bytecode;
+}
+} // namespace
+
+ShaderLibrary* ShaderLibrary::GetInstance() {
+	static ShaderLibrary instance;
+	return &instance;
+}
+
+void ShaderLibrary::Initialize(const std::wstring& archivePath) {
+	Finalize();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (file_.Open(archivePath) && !archive_.Open(file_.GetData(), file_.GetSize())) {
+		OutputDebugStringA("ShaderLibrary: archive is broken or outdated, compiling at runtime\n");
+		file_.Close();
+	}
+}
+
+void ShaderLibrary::Finalize() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	archive_.Close();
+	file_.Close();
+	compiled_.clear();
+	retired_.clear();
+	stats_ = Stats();
+}
+
+D3D12_SHADER_BYTECODE ShaderLibrary::Load(
+  const std::wstring& filePath, const std::string& target, const std::string& entryPoint,
+  const std::vector<ShaderDefine>& defines) {
+	D3D12_SHADER_BYTECODE bytecode{};
+	std::string errors;
+	if (!TryLoad(filePath, target, entryPoint, defines, bytecode, &errors)) {
+		// エラー内容を出力ウィンドウに表示
+		errors += "\n";
+		OutputDebugStringA(errors.c_str());
+		exit(1);
+	}
+	return bytecode;
+}
+
+bool ShaderLibrary::TryLoad(
+  const std::wstring& filePath, const std::string& target, const std::string& entryPoint,
+  const std::vector<ShaderDefine>& defines, D3D12_SHADER_BYTECODE& bytecode,
+  std::string* errors) {
+	uint64_t key = ShaderArchive::MakeKey(
+	  ShaderCompiler::GetFileName(filePath), entryPoint, target, defines, ShaderCompiler::kFlags);
+	// ソースを置いていない環境ではアーカイブをそのまま信用する
+	uint64_t sourceHash = ShaderCompiler::HashSource(filePath);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = compiled_.find(key);
+		if (it != compiled_.end() && it->second.sourceHash == sourceHash) {
+			stats_.memoryHits++;
+			bytecode =
+			  MakeBytecode(it->second.blob->GetBufferPointer(), it->second.blob->GetBufferSize());
+			return true;
+		}
+		ShaderArchive::View view;
+		if (FindInArchive(key, sourceHash, view)) {
+			stats_.archiveHits++;
+			bytecode = MakeBytecode(view.bytecode, view.bytecodeSize);
+			return true;
+		}
+	}
+
+	// コンパイルは時間がかかるので排他の外で行う
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ComPtr<ID3DBlob> blob;
+	if (!ShaderCompiler::Compile(filePath, entryPoint, target, defines, blob, errors)) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	stats_.compiles++;
+	stats_.compileTime +=
+	  std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	CompiledShader& compiled = compiled_[key];
+	if (compiled.blob) {
+		retired_.push_back(compiled.blob);
+	}
+	compiled.sourceHash = sourceHash;
+	compiled.blob = blob;
+	bytecode = MakeBytecode(blob->GetBufferPointer(), blob->GetBufferSize());
+	return true;
+}
+
+bool ShaderLibrary::GetReflection(
+  const std::wstring& filePath, const std::string& target, const std::string& entryPoint,
+  const std::vector<ShaderDefine>& defines, ShaderReflection& reflection) {
+	D3D12_SHADER_BYTECODE bytecode;
+	if (!TryLoad(filePath, target, entryPoint, defines, bytecode)) {
+		return false;
+	}
+
+	// アーカイブから返したものは作成時に取っておいた情報を使う
+	uint64_t key = ShaderArchive::MakeKey(
+	  ShaderCompiler::GetFileName(filePath), entryPoint, target, defines, ShaderCompiler::kFlags);
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		ShaderArchive::View view;
+		if (archive_.Find(key, view) && view.bytecode == bytecode.pShaderBytecode) {
+			return ShaderArchive::ReadReflection(view.reflection, view.reflectionSize, reflection);
+		}
+	}
+	return ShaderCompiler::Reflect(bytecode.pShaderBytecode, bytecode.BytecodeLength, reflection);
+}
+
+bool ShaderLibrary::FindInArchive(uint64_t key, uint64_t sourceHash, ShaderArchive::View& view) {
+	if (!archive_.Find(key, view)) {
+		return false;
+	}
+	if (sourceHash != 0 && view.sourceHash != sourceHash) {
+		stats_.staleEntries++;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,130 @@
+﻿#pragma once
+
+#include "MappedFile.h"
+#include "ShaderArchive.h"
+#include <d3d12.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <wrl.h>
+
+/// <summary>
+/// シェーダの取得
+/// （オフラインで作ったアーカイブに最新のバイトコードがあればそれを返し、
+///   無いかソースが変わっていれば実行時にコンパイルする）
+/// </summary>
+class ShaderLibrary {
+  public:
+	/// <summary>
+	/// 統計
+	/// </summary>
+	struct Stats {
+		uint32_t archiveHits = 0;  // アーカイブから返した数
+		uint32_t memoryHits = 0;   // 実行時にコンパイル済みのものを返した数
+		uint32_t staleEntries = 0; // アーカイブにあったがソースが変わっていた数
+		uint32_t compiles = 0;     // 実行時にコンパイルした数
+		double compileTime = 0.0;  // 実行時のコンパイルにかかった時間の合計（ミリ秒）
+	};
+
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static ShaderLibrary* GetInstance();
+
+	/// <summary>
+	/// 初期化（アーカイブが無い・壊れているときは全て実行時にコンパイルする）
+	/// </summary>
+	/// <param name="archivePath">アーカイブのファイルパス</param>
+	void Initialize(const std::wstring& archivePath = L"Resources/shaders/ShaderArchive.bin");
+
+	/// <summary>
+	/// 終了処理（以降は取得したバイトコードを参照できない）
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// バイトコードの取得（コンパイルに失敗したらエラーを出力して終了する）
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <param name="target">シェーダプロファイル</param>
+	/// <param name="entryPoint">エントリポイント</param>
+	/// <param name="defines">マクロ定義</param>
+	/// <returns>バイトコード（Finalizeまで有効）</returns>
+	D3D12_SHADER_BYTECODE Load(
+	  const std::wstring& filePath, const std::string& target,
+	  const std::string& entryPoint = "main", const std::vector<ShaderDefine>& defines = {});
+
+	/// <summary>
+	/// バイトコードの取得（どのスレッドからも呼べる）
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <param name="target">シェーダプロファイル</param>
+	/// <param name="entryPoint">エントリポイント</param>
+	/// <param name="defines">マクロ定義</param>
+	/// <param name="bytecode">バイトコード（Finalizeまで有効）</param>
+	/// <param name="errors">コンパイルエラーの格納先（不要ならnullptr）</param>
+	/// <returns>成否</returns>
+	bool TryLoad(
+	  const std::wstring& filePath, const std::string& target, const std::string& entryPoint,
+	  const std::vector<ShaderDefine>& defines, D3D12_SHADER_BYTECODE& bytecode,
+	  std::string* errors = nullptr);
+
+	/// <summary>
+	/// リフレクション情報の取得（定数バッファのレイアウトとリソースの割り当て）
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <param name="target">シェーダプロファイル</param>
+	/// <param name="entryPoint">エントリポイント</param>
+	/// <param name="defines">マクロ定義</param>
+	/// <param name="reflection">格納先</param>
+	/// <returns>成否</returns>
+	bool GetReflection(
+	  const std::wstring& filePath, const std::string& target, const std::string& entryPoint,
+	  const std::vector<ShaderDefine>& defines, ShaderReflection& reflection);
+
+	/// <summary>
+	/// アーカイブを読み込めたか
+	/// </summary>
+	bool HasArchive() const { return archive_.GetEntryCount() != 0; }
+
+	/// <summary>
+	/// 統計の取得
+	/// </summary>
+	const Stats& GetStats() const { return stats_; }
+
+  private:
+	ShaderLibrary() = default;
+	~ShaderLibrary() = default;
+	ShaderLibrary(const ShaderLibrary&) = delete;
+	ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+	// 実行時にコンパイルしたシェーダ
+	struct CompiledShader {
+		uint64_t sourceHash = 0;
+		Microsoft::WRL::ComPtr<ID3DBlob> blob;
+	};
+
+	/// <summary>
+	/// アーカイブから最新のものを探す
+	/// </summary>
+	/// <param name="key">キー</param>
+	/// <param name="sourceHash">現在のソースのハッシュ（ソースが無ければ0で、あるものを使う）</param>
+	/// <param name="view">見つかったエントリ</param>
+	/// <returns>見つかったか</returns>
+	bool FindInArchive(uint64_t key, uint64_t sourceHash, ShaderArchive::View& view);
+
+	// アーカイブのファイル
+	MappedFile file_;
+	// アーカイブ
+	ShaderArchive archive_;
+	// 実行時にコンパイルしたもの
+	std::unordered_map<uint64_t, CompiledShader> compiled_;
+	// 差し替えたもの（パイプラインの設定から指されている可能性があるので、終了まで残す）
+	std::vector<Microsoft::WRL::ComPtr<ID3DBlob>> retired_;
+	// 排他
+	std::mutex mutex_;
+	// 統計
+	Stats stats_;
+};
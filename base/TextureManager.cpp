@@ -1,6 +1,12 @@
 ﻿#include "TextureManager.h"
+#include "D3D12RenderCommandList.h"
+#include "DirectXCommon.h"
+#include "MipMapGenerator.h"
+#include "ThreadPool.h"
 #include <DirectXTex.h>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 
 using namespace DirectX;
 
@@ -8,6 +14,10 @@ uint32_t TextureManager::Load(const std::string& fileName) {
 	return TextureManager::GetInstance()->LoadInternal(fileName);
 }
 
+uint32_t TextureManager::LoadFromImage(const std::string& name, const ScratchImage& image) {
+	return TextureManager::GetInstance()->LoadFromImageInternal(name, image);
+}
+
 TextureManager* TextureManager::GetInstance() {
 	static TextureManager instance;
 	return &instance;
@@ -34,18 +44,52 @@ void TextureManager::ResetAll() {
 	D3D12_DESCRIPTOR_HEAP_DESC descHeapDesc = {};
 	descHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
 	descHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE; // シェーダから見えるように
-	descHeapDesc.NumDescriptors = kNumDescriptors; // シェーダーリソースビュー1つ
+	descHeapDesc.NumDescriptors = kDescriptorHeapSize; // ハンドルの数と作り直し用の空き
 	result = device_->CreateDescriptorHeap(&descHeapDesc, IID_PPV_ARGS(&descriptorHeap_)); // 生成
 	assert(SUCCEEDED(result));
 
 	indexNextDescriptorHeap_ = 0;
 
+	// 読み直し中のものは差し替え先がなくなるので捨てる
+	CancelRestores();
+
 	// 全テクスチャを初期化
 	for (size_t i = 0; i < kNumDescriptors; i++) {
 		textures_[i].resource.Reset();
 		textures_[i].cpuDescHandleSRV.ptr = 0;
 		textures_[i].gpuDescHandleSRV.ptr = 0;
 		textures_[i].name.clear();
+		textures_[i].desc = {};
+		textures_[i].descriptorIndex = 0;
+		textures_[i].viewCreated = false;
+	}
+
+	// ハンドルの数より後ろの番号を、ビューを作り直すときの空きにする
+	freeDescriptors_.clear();
+	retiredDescriptors_.clear();
+	for (size_t i = kDescriptorHeapSize; kNumDescriptors < i; i--) {
+		freeDescriptors_.push_back(static_cast<uint32_t>(i - 1));
+	}
+
+	residency_.Clear();
+}
+
+void TextureManager::Update() {
+	std::lock_guard<std::mutex> lock(residencyMutex_);
+	frameCount_++;
+
+	// 読み直しが済んだものを全ミップ常駐に戻す
+	ApplyRestores();
+
+	// 予算超過分の縮退・追い出し
+	// （対象は同時処理フレーム数より長く使われていないので、GPUが参照中のリソースは含まれない）
+	std::vector<TextureResidency::Action> actions = residency_.Update(frameCount_);
+	for (const TextureResidency::Action& action : actions) {
+		if (action.state == TextureResidency::State::kEvicted) {
+			Evict(action.handle);
+		} else {
+			Reduce(action.handle, action.droppedMips);
+		}
 	}
 }
 
@@ -53,13 +97,17 @@ const D3D12_RESOURCE_DESC TextureManager::GetResoureDesc(uint32_t textureHandle)
 
 	assert(textureHandle < textures_.size());
 	Texture& texture = textures_.at(textureHandle);
-	return texture.resource->GetDesc();
+	// 縮退中でも全ミップ常駐時の設定を返す
+	return texture.desc;
 }
 
 void TextureManager::SetGraphicsRootDescriptorTable(
   ID3D12GraphicsCommandList* commandList, UINT rootParamIndex,
   uint32_t textureHandle) { // デスクリプタヒープの配列
 	assert(textureHandle < textures_.size());
+
+	MakeResident(textureHandle);
+
 	ID3D12DescriptorHeap* ppHeaps[] = {descriptorHeap_.Get()};
 	commandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
@@ -68,25 +116,175 @@ void TextureManager::SetGraphicsRootDescriptorTable(
 	  rootParamIndex, textures_[textureHandle].gpuDescHandleSRV);
 }
 
-uint32_t TextureManager::LoadInternal(const std::string& fileName) {
+void TextureManager::SetGraphicsRootDescriptorTable(
+  RenderCommandList* commandList, UINT rootParamIndex, uint32_t textureHandle) {
+	assert(textureHandle < textures_.size());
 
-	assert(indexNextDescriptorHeap_ < kNumDescriptors);
-	uint32_t handle = indexNextDescriptorHeap_;
+	MakeResident(textureHandle);
+
+	commandList->SetDescriptorHeap(D3D12RenderCommandList::Wrap(descriptorHeap_.Get()));
+
+	// シェーダリソースビューをセット
+	commandList->SetGraphicsRootDescriptorTable(
+	  rootParamIndex, textures_[textureHandle].gpuDescHandleSRV.ptr);
+}
 
+void TextureManager::MakeResident(uint32_t textureHandle) {
+	// 縮退・追い出し済みなら読み直しを始め、済むまでは今あるリソースで描画する
+	std::lock_guard<std::mutex> lock(residencyMutex_);
+	if (residency_.Touch(textureHandle, frameCount_)) {
+		RequestRestore(textureHandle);
+	}
+}
+
+uint32_t TextureManager::LoadInternal(const std::string& fileName) {
 	// 読み込み済みテクスチャを検索
+	uint32_t handle = 0;
+	if (Find(fileName, handle)) {
+		return handle;
+	}
+
+	ScratchImage scratchImg{};
+	bool loaded = LoadImageFile(fileName, scratchImg);
+	assert(loaded);
+	(void)loaded;
+
+	handle = Allocate(fileName);
+	Replace(handle, scratchImg);
+
+	return handle;
+}
+
+void TextureManager::Replace(uint32_t textureHandle, const ScratchImage& scratchImg) {
+	CreateTextureResource(textureHandle, scratchImg, 0);
+	textures_[textureHandle].desc = textures_[textureHandle].resource->GetDesc();
+
+	// 常駐管理にミップごとのサイズを登録
+	std::vector<uint64_t> mipSizes(scratchImg.GetMetadata().mipLevels);
+	for (size_t i = 0; i < mipSizes.size(); i++) {
+		mipSizes[i] = scratchImg.GetImage(i, 0, 0)->slicePitch;
+	}
+	residency_.Register(textureHandle, mipSizes, frameCount_);
+}
+
+uint32_t TextureManager::LoadFromImageInternal(const std::string& name, const ScratchImage& image) {
+	// 同名があればリソースだけ作り直す
+	uint32_t handle = 0;
+	if (!Find(name, handle)) {
+		handle = Allocate(name);
+	}
+
+	CreateTextureResource(handle, image, 0);
+	textures_[handle].desc = textures_[handle].resource->GetDesc();
+
+	return handle;
+}
+
+uint32_t TextureManager::RegisterResource(
+  const std::string& name, ID3D12Resource* resource,
+  const D3D12_SHADER_RESOURCE_VIEW_DESC& srvDesc) {
+	assert(resource);
+
+	uint32_t handle = 0;
+	if (!Find(name, handle)) {
+		handle = Allocate(name);
+	}
+
+	Texture& texture = textures_[handle];
+	DirectXCommon::GetInstance()->DeferRelease(texture.resource);
+	texture.resource = resource;
+	texture.desc = resource->GetDesc();
+	device_->CreateShaderResourceView(resource, &srvDesc, RenewDescriptor(handle));
+
+	return handle;
+}
+
+bool TextureManager::Find(const std::string& name, uint32_t& handle) const {
 	auto it = std::find_if(textures_.begin(), textures_.end(), [&](const auto& texture) {
-		return texture.name == fileName;
+		return texture.name == name;
 	});
-	if (it != textures_.end()) {
-		// 読み込み済みテクスチャの要素番号を取得
-		handle = static_cast<uint32_t>(std::distance(textures_.begin(), it));
-		return handle;
+	if (it == textures_.end()) {
+		return false;
 	}
+	// 読み込み済みテクスチャの要素番号を取得
+	handle = static_cast<uint32_t>(std::distance(textures_.begin(), it));
+	return true;
+}
+
+uint32_t TextureManager::Allocate(const std::string& name) {
+	assert(indexNextDescriptorHeap_ < kNumDescriptors);
+	uint32_t handle = indexNextDescriptorHeap_;
 
 	// 書き込むテクスチャの参照
 	Texture& texture = textures_.at(handle);
-	texture.name = fileName;
+	texture.name = name;
+
+	// シェーダリソースビューのハンドル（最初はテクスチャハンドルと同じ番号）
+	SetDescriptorIndex(texture, handle);
+	texture.viewCreated = false;
+
+	indexNextDescriptorHeap_++;
+
+	return handle;
+}
+
+uint32_t TextureManager::GetDescriptorIndex(uint32_t textureHandle) const {
+	assert(textureHandle < textures_.size());
+	return textures_[textureHandle].descriptorIndex;
+}
+
+void TextureManager::SetDescriptorIndex(Texture& texture, uint32_t descriptorIndex) {
+	texture.descriptorIndex = descriptorIndex;
+	texture.cpuDescHandleSRV = CD3DX12_CPU_DESCRIPTOR_HANDLE(
+	  descriptorHeap_->GetCPUDescriptorHandleForHeapStart(), descriptorIndex,
+	  sDescriptorHandleIncrementSize_);
+	texture.gpuDescHandleSRV = CD3DX12_GPU_DESCRIPTOR_HANDLE(
+	  descriptorHeap_->GetGPUDescriptorHandleForHeapStart(), descriptorIndex,
+	  sDescriptorHandleIncrementSize_);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE TextureManager::RenewDescriptor(uint32_t handle) {
+	Texture& texture = textures_.at(handle);
+	// まだビューが無ければどのフレームからも参照されていないので、そのまま書き込む
+	if (!texture.viewCreated) {
+		texture.viewCreated = true;
+		return texture.cpuDescHandleSRV;
+	}
+
+	// 空きが無ければGPUの完了を待って戻す
+	// （それでも無ければ、提出済みのフレームはもう読まないのでその場で書き換える）
+	DirectXCommon* dxCommon = DirectXCommon::GetInstance();
+	ReclaimDescriptors();
+	if (freeDescriptors_.empty()) {
+		dxCommon->WaitForGpu();
+		ReclaimDescriptors();
+		if (freeDescriptors_.empty()) {
+			return texture.cpuDescHandleSRV;
+		}
+	}
+
+	// 前のビューは記録中のフレームのGPU処理が終わるまで残す
+	retiredDescriptors_.push_back({texture.descriptorIndex, dxCommon->GetFrameNumber()});
+	SetDescriptorIndex(texture, freeDescriptors_.back());
+	freeDescriptors_.pop_back();
+	return texture.cpuDescHandleSRV;
+}
+
+void TextureManager::ReclaimDescriptors() {
+	uint64_t completedFrameNumber = DirectXCommon::GetInstance()->GetCompletedFrameNumber();
+	auto it = std::remove_if(
+	  retiredDescriptors_.begin(), retiredDescriptors_.end(),
+	  [&](const RetiredDescriptor& retired) {
+		  if (completedFrameNumber < retired.frameNumber) {
+			  return false;
+		  }
+		  freeDescriptors_.push_back(retired.index);
+		  return true;
+	  });
+	retiredDescriptors_.erase(it, retiredDescriptors_.end());
+}
 
+bool TextureManager::LoadImageFile(const std::string& fileName, ScratchImage& scratchImg) const {
 	// ディレクトリパスとファイル名を連結してフルパスを得る
 	bool currentRelative = false;
 	if (2 < fileName.size()) {
@@ -101,35 +299,52 @@ uint32_t TextureManager::LoadInternal(const std::string& fileName) {
 	HRESULT result;
 
 	TexMetadata metadata{};
-	ScratchImage scratchImg{};
 
 	// WICテクスチャのロード
 	result = LoadFromWICFile(wfilePath, WIC_FLAGS_NONE, &metadata, scratchImg);
-	assert(SUCCEEDED(result));
+	if (FAILED(result)) {
+		return false;
+	}
 
 	ScratchImage mipChain{};
-	// ミップマップ生成
-	result = GenerateMipMaps(
-	  scratchImg.GetImages(), scratchImg.GetImageCount(), scratchImg.GetMetadata(),
-	  TEX_FILTER_DEFAULT, 0, mipChain);
+	// ミップマップ生成（対応フォーマットは並列生成、それ以外はDirectXTexに任せる）
+	if (MipMapGenerator::IsSupported(scratchImg.GetMetadata())) {
+		result = MipMapGenerator::Generate(scratchImg, mipChain);
+	} else {
+		result = GenerateMipMaps(
+		  scratchImg.GetImages(), scratchImg.GetImageCount(), scratchImg.GetMetadata(),
+		  TEX_FILTER_DEFAULT, 0, mipChain);
+	}
 	if (SUCCEEDED(result)) {
 		scratchImg = std::move(mipChain);
-		metadata = scratchImg.GetMetadata();
 	}
+	return true;
+}
+
+void TextureManager::CreateTextureResource(
+  uint32_t handle, const ScratchImage& scratchImg, uint32_t skipMips) {
+	Texture& texture = textures_.at(handle);
+	TexMetadata metadata = scratchImg.GetMetadata();
+	assert(skipMips < metadata.mipLevels);
 
 	// 読み込んだディフューズテクスチャをSRGBとして扱う
 	metadata.format = MakeSRGB(metadata.format);
 
-	// リソース設定
+	// 落としたミップの分だけ縮小したリソース設定
+	const Image* topImg = scratchImg.GetImage(skipMips, 0, 0);
 	CD3DX12_RESOURCE_DESC texresDesc = CD3DX12_RESOURCE_DESC::Tex2D(
-	  metadata.format, metadata.width, (UINT)metadata.height, (UINT16)metadata.arraySize,
-	  (UINT16)metadata.mipLevels);
+	  metadata.format, topImg->width, (UINT)topImg->height, (UINT16)metadata.arraySize,
+	  (UINT16)(metadata.mipLevels - skipMips));
 
 	// ヒーププロパティ
 	CD3DX12_HEAP_PROPERTIES heapProps =
 	  CD3DX12_HEAP_PROPERTIES(D3D12_CPU_PAGE_PROPERTY_WRITE_BACK, D3D12_MEMORY_POOL_L0);
 
-	// テクスチャ用バッファの生成
+	HRESULT result;
+
+	// テクスチャ用バッファの生成（差し替え前のものは前のフレームが読み終えてから解放する）
+	DirectXCommon::GetInstance()->DeferRelease(texture.resource);
+	texture.resource.Reset();
 	result = device_->CreateCommittedResource(
 	  &heapProps, D3D12_HEAP_FLAG_NONE, &texresDesc,
 	  D3D12_RESOURCE_STATE_GENERIC_READ, // テクスチャ用指定
@@ -137,8 +352,8 @@ uint32_t TextureManager::LoadInternal(const std::string& fileName) {
 	assert(SUCCEEDED(result));
 
 	// テクスチャバッファにデータ転送
-	for (size_t i = 0; i < metadata.mipLevels; i++) {
-		const Image* img = scratchImg.GetImage(i, 0, 0); // 生データ抽出
+	for (size_t i = 0; i < texresDesc.MipLevels; i++) {
+		const Image* img = scratchImg.GetImage(i + skipMips, 0, 0); // 生データ抽出
 		result = texture.resource->WriteToSubresource(
 		  (UINT)i,
 		  nullptr,              // 全領域へコピー
@@ -150,25 +365,115 @@ uint32_t TextureManager::LoadInternal(const std::string& fileName) {
 	}
 
 	// シェーダリソースビュー作成
-	texture.cpuDescHandleSRV = CD3DX12_CPU_DESCRIPTOR_HANDLE(
-	  descriptorHeap_->GetCPUDescriptorHandleForHeapStart(), handle, sDescriptorHandleIncrementSize_);
-	texture.gpuDescHandleSRV = CD3DX12_GPU_DESCRIPTOR_HANDLE(
-	  descriptorHeap_->GetGPUDescriptorHandleForHeapStart(), handle, sDescriptorHandleIncrementSize_);
-
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{}; // 設定構造体
 	D3D12_RESOURCE_DESC resDesc = texture.resource->GetDesc();
 
 	srvDesc.Format = resDesc.Format;
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; // 2Dテクスチャ
-	srvDesc.Texture2D.MipLevels = (UINT)metadata.mipLevels;
+	srvDesc.Texture2D.MipLevels = (UINT)resDesc.MipLevels;
 
+	// （前のビューはGPUが参照中かもしれないので、書き換えずに空きの番号に作る）
 	device_->CreateShaderResourceView(
 	  texture.resource.Get(), //ビューと関連付けるバッファ
 	  &srvDesc,               //テクスチャ設定情報
-	  texture.cpuDescHandleSRV);
+	  RenewDescriptor(handle));
+}
 
-	indexNextDescriptorHeap_++;
+void TextureManager::Reduce(uint32_t handle, uint32_t skipMips) {
+	Texture& texture = textures_.at(handle);
+	if (!texture.resource) {
+		return;
+	}
 
-	return handle;
+	// 常駐中のリソースは上位ミップを落としていることもあるので、元の番号との差を求める
+	D3D12_RESOURCE_DESC resDesc = texture.resource->GetDesc();
+	uint32_t residentSkip = texture.desc.MipLevels - resDesc.MipLevels;
+	if (skipMips <= residentSkip) {
+		return;
+	}
+	uint32_t readSkip = skipMips - residentSkip;
+	readSkip = (std::min)(readSkip, (uint32_t)resDesc.MipLevels - 1);
+
+	// 残すミップだけをCPUから読めるヒープのリソースから読み出す
+	const D3D12_RESOURCE_DESC& fullDesc = texture.desc;
+	size_t width = (std::max)(size_t(fullDesc.Width >> (residentSkip + readSkip)), size_t(1));
+	size_t height = (std::max)(size_t(fullDesc.Height >> (residentSkip + readSkip)), size_t(1));
+	ScratchImage scratchImg{};
+	HRESULT result =
+	  scratchImg.Initialize2D(resDesc.Format, width, height, 1, resDesc.MipLevels - readSkip);
+	assert(SUCCEEDED(result));
+	if (FAILED(result)) {
+		return;
+	}
+	for (size_t i = 0; i < scratchImg.GetMetadata().mipLevels; i++) {
+		const Image* img = scratchImg.GetImage(i, 0, 0);
+		result = texture.resource->ReadFromSubresource(
+		  img->pixels, (UINT)img->rowPitch, (UINT)img->slicePitch, (UINT)(i + readSkip), nullptr);
+		assert(SUCCEEDED(result));
+	}
+
+	CreateTextureResource(handle, scratchImg, 0);
+}
+
+void TextureManager::Evict(uint32_t handle) {
+	Texture& texture = textures_.at(handle);
+
+	// 前のフレームが読み終えてから解放する
+	// （ハンドルは残し、読み直しが済むまでは空のビューとして黒で描画される）
+	DirectXCommon::GetInstance()->DeferRelease(texture.resource);
+	texture.resource.Reset();
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+	srvDesc.Format = texture.desc.Format;
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MipLevels = texture.desc.MipLevels;
+	device_->CreateShaderResourceView(nullptr, &srvDesc, RenewDescriptor(handle));
+}
+
+void TextureManager::RequestRestore(uint32_t handle) {
+	for (const PendingRestore& pending : pendingRestores_) {
+		if (pending.handle == handle) {
+			return;
+		}
+	}
+
+	// 描画コマンドの記録を止めないように、デコードとミップ生成はワーカースレッドで行う
+	auto image = std::make_shared<ScratchImage>();
+	auto succeeded = std::make_shared<bool>(false);
+	std::string fileName = textures_.at(handle).name;
+	std::future<void> future =
+	  ThreadPool::GetInstance()->Enqueue([this, fileName, image, succeeded]() {
+		  // WICを使うのでワーカースレッドでもCOMを初期化する
+		  HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+		  *succeeded = LoadImageFile(fileName, *image);
+		  if (SUCCEEDED(comResult)) {
+			  CoUninitialize();
+		  }
+	  });
+	pendingRestores_.push_back({handle, image, succeeded, std::move(future)});
+}
+
+void TextureManager::ApplyRestores() {
+	for (auto it = pendingRestores_.begin(); it != pendingRestores_.end();) {
+		if (it->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			++it;
+			continue;
+		}
+		// 読み直し中に差し替えられて全ミップ常駐に戻っていれば捨てる
+		const TextureResidency::Entry& entry = residency_.GetEntry(it->handle);
+		if (*it->succeeded && entry.state != TextureResidency::State::kResident) {
+			CreateTextureResource(it->handle, *it->image, 0);
+			residency_.MarkRestored(it->handle);
+		}
+		it = pendingRestores_.erase(it);
+	}
+}
+
+void TextureManager::CancelRestores() {
+	for (PendingRestore& pending : pendingRestores_) {
+		pending.future.wait();
+	}
+	pendingRestores_.clear();
 }
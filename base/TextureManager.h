@@ -1,18 +1,30 @@
 ﻿#pragma once
 
+#include "RenderCommandList.h"
+#include "TextureResidency.h"
 #include <array>
 #include <d3dx12.h>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <wrl.h>
 
+namespace DirectX {
+class ScratchImage;
+}
+
 /// <summary>
 /// テクスチャマネージャ
 /// </summary>
 class TextureManager {
   public:
-	// デスクリプターの数
+	// デスクリプターの数（テクスチャハンドルの上限）
 	static const size_t kNumDescriptors = 256;
+	// デスクリプタヒープの大きさ（ビューを作り直すときに移す空きの番号の分だけ多く持つ）
+	static const size_t kDescriptorHeapSize = kNumDescriptors * 2;
 
 	/// <summary>
 	/// テクスチャ
@@ -26,6 +38,12 @@ class TextureManager {
 		CD3DX12_GPU_DESCRIPTOR_HANDLE gpuDescHandleSRV;
 		// 名前
 		std::string name;
+		// 全ミップ常駐時のリソース設定
+		D3D12_RESOURCE_DESC desc;
+		// シェーダリソースビューのヒープ上の番号
+		uint32_t descriptorIndex;
+		// ビューを作ったか（作った後はGPUが参照しているかもしれない）
+		bool viewCreated;
 	};
 
 	/// <summary>
@@ -35,6 +53,15 @@ class TextureManager {
 	/// <returns>テクスチャハンドル</returns>
 	static uint32_t Load(const std::string& fileName);
 
+	/// <summary>
+	/// メモリ上の画像から生成
+	/// （ファイルから読み直せないので常駐管理による追い出しの対象外）
+	/// </summary>
+	/// <param name="name">登録名</param>
+	/// <param name="image">画像</param>
+	/// <returns>テクスチャハンドル</returns>
+	static uint32_t LoadFromImage(const std::string& name, const DirectX::ScratchImage& image);
+
 	/// <summary>
 	/// シングルトンインスタンスの取得
 	/// </summary>
@@ -47,11 +74,84 @@ class TextureManager {
 	/// <param name="device">デバイス</param>
 	void Initialize(ID3D12Device* device, std::string directoryPath = "Resources/");
 
+	/// <summary>
+	/// 読み込みディレクトリパスの取得
+	/// </summary>
+	/// <returns>ディレクトリパス</returns>
+	const std::string& GetDirectoryPath() const { return directoryPath_; }
+
 	/// <summary>
 	/// 全テクスチャリセット
 	/// </summary>
 	void ResetAll();
 
+	/// <summary>
+	/// 読み込み済みテクスチャの検索
+	/// </summary>
+	/// <param name="name">名前</param>
+	/// <param name="handle">見つかったテクスチャハンドル</param>
+	/// <returns>見つかればtrue</returns>
+	bool Find(const std::string& name, uint32_t& handle) const;
+
+	/// <summary>
+	/// 画像ファイルの読み込みとミップマップ生成（GPUに触れないので別スレッドから呼べる）
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	/// <param name="scratchImg">読み込み先</param>
+	/// <returns>成否</returns>
+	bool LoadImageFile(const std::string& fileName, DirectX::ScratchImage& scratchImg) const;
+
+	/// <summary>
+	/// 読み込み済みテクスチャの中身の差し替え（ハンドルはそのまま。ビューは別の番号に作る）
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	/// <param name="scratchImg">新しい画像</param>
+	void Replace(uint32_t textureHandle, const DirectX::ScratchImage& scratchImg);
+
+	/// <summary>
+	/// 毎フレーム処理（メモリ予算を超えていれば未使用テクスチャを縮退・追い出しする）
+	/// </summary>
+	void Update();
+
+	/// <summary>
+	/// テクスチャメモリ予算の設定
+	/// </summary>
+	/// <param name="budget">予算（バイト）</param>
+	void SetMemoryBudget(uint64_t budget) { residency_.SetBudget(budget); }
+
+	/// <summary>
+	/// 縮退・追い出し対象になるまでの未使用フレーム数の設定
+	/// </summary>
+	/// <param name="frames">フレーム数</param>
+	void SetEvictionFrameThreshold(uint32_t frames) { residency_.SetUnusedFrameThreshold(frames); }
+
+	/// <summary>
+	/// 常駐中のテクスチャメモリ使用量の取得
+	/// </summary>
+	/// <returns>使用量（バイト）</returns>
+	uint64_t GetUsedMemory() const { return residency_.GetUsedBytes(); }
+
+	/// <summary>
+	/// テクスチャの常駐サイズの取得
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	/// <returns>サイズ（バイト）</returns>
+	uint64_t GetTextureMemory(uint32_t textureHandle) const {
+		return residency_.GetResidentBytes(textureHandle);
+	}
+
+	/// <summary>
+	/// 外部で作ったリソースの登録（デスクリプタを共有ヒープに置くので、テクスチャと同じテーブル設定で参照できる）
+	/// （常駐管理の対象外。同名があればデスクリプタを作り直す）
+	/// </summary>
+	/// <param name="name">登録名</param>
+	/// <param name="resource">リソース</param>
+	/// <param name="srvDesc">シェーダリソースビューの設定</param>
+	/// <returns>テクスチャハンドル</returns>
+	uint32_t RegisterResource(
+	  const std::string& name, ID3D12Resource* resource,
+	  const D3D12_SHADER_RESOURCE_VIEW_DESC& srvDesc);
+
 	/// <summary>
 	/// リソース情報取得
 	/// </summary>
@@ -68,7 +168,51 @@ class TextureManager {
 	void SetGraphicsRootDescriptorTable(
 	  ID3D12GraphicsCommandList* commandList, UINT rootParamIndex, uint32_t textureHandle);
 
+	/// <summary>
+	/// デスクリプタテーブルをセット（描画コマンドの発行先版）
+	/// </summary>
+	/// <param name="commandList">描画コマンドの発行先</param>
+	/// <param name="rootParamIndex">ルートパラメータ番号</param>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	void SetGraphicsRootDescriptorTable(
+	  RenderCommandList* commandList, UINT rootParamIndex, uint32_t textureHandle);
+
+	/// <summary>
+	/// 描画に使う印を付け、縮退・追い出し済みなら全ミップの読み直しを別スレッドで始める
+	/// （読み直しが済むまでは残っている下位ミップで、追い出し済みなら空のビューで描画される）
+	/// （デスクリプタテーブルを通さずにヒープ上の番号で参照するときは描画ごとに呼ぶ）
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	void MakeResident(uint32_t textureHandle);
+
+	/// <summary>
+	/// シェーダから見えるデスクリプタヒープの取得
+	/// </summary>
+	ID3D12DescriptorHeap* GetDescriptorHeap() const { return descriptorHeap_.Get(); }
+
+	/// <summary>
+	/// シェーダリソースビューのヒープ上の番号の取得
+	/// （ビューを作り直すと変わるので、ヒープを直接引くときは記録するフレームごとに取り直す）
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	/// <returns>ヒープ上の番号</returns>
+	uint32_t GetDescriptorIndex(uint32_t textureHandle) const;
+
   private:
+	// 全ミップを読み直し中のテクスチャ
+	struct PendingRestore {
+		uint32_t handle;
+		std::shared_ptr<DirectX::ScratchImage> image;
+		std::shared_ptr<bool> succeeded;
+		std::future<void> future;
+	};
+
+	// 使わなくなったデスクリプタ（参照したフレームのGPU処理が終わるまで使い回さない）
+	struct RetiredDescriptor {
+		uint32_t index;
+		uint64_t frameNumber;
+	};
+
 	TextureManager() = default;
 	~TextureManager() = default;
 	TextureManager(const TextureManager&) = delete;
@@ -86,10 +230,93 @@ class TextureManager {
 	uint32_t indexNextDescriptorHeap_ = 0u;
 	// テクスチャコンテナ
 	std::array<Texture, kNumDescriptors> textures_;
+	// 常駐管理
+	TextureResidency residency_;
+	// 常駐管理の排他（描画コマンドは複数スレッドで記録される）
+	std::mutex residencyMutex_;
+	// 全ミップを読み直し中のテクスチャ
+	std::vector<PendingRestore> pendingRestores_;
+	// フレーム番号
+	uint32_t frameCount_ = 0u;
+	// ビューを作り直すときに使う空きのデスクリプタと、空きに戻すのを待っているもの
+	std::vector<uint32_t> freeDescriptors_;
+	std::vector<RetiredDescriptor> retiredDescriptors_;
 
 	/// <summary>
 	/// 読み込み
 	/// </summary>
 	/// <param name="fileName">ファイル名</param>
 	uint32_t LoadInternal(const std::string& fileName);
+
+	/// <summary>
+	/// メモリ上の画像から生成
+	/// </summary>
+	/// <param name="name">登録名</param>
+	/// <param name="image">画像</param>
+	uint32_t LoadFromImageInternal(const std::string& name, const DirectX::ScratchImage& image);
+
+	/// <summary>
+	/// 次のテクスチャハンドルを確保してデスクリプタを割り当てる
+	/// </summary>
+	/// <param name="name">名前</param>
+	/// <returns>テクスチャハンドル</returns>
+	uint32_t Allocate(const std::string& name);
+
+	/// <summary>
+	/// ヒープ上の番号からデスクリプタハンドルを求める
+	/// </summary>
+	/// <param name="texture">テクスチャ</param>
+	/// <param name="descriptorIndex">ヒープ上の番号</param>
+	void SetDescriptorIndex(Texture& texture, uint32_t descriptorIndex);
+
+	/// <summary>
+	/// シェーダリソースビューの書き込み先の取得
+	/// （既にビューがあれば、GPUが参照中かもしれないので書き換えずに空きの番号へ移す）
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	/// <returns>書き込み先</returns>
+	D3D12_CPU_DESCRIPTOR_HANDLE RenewDescriptor(uint32_t handle);
+
+	/// <summary>
+	/// GPU処理が終わったフレームで使わなくなったデスクリプタを空きに戻す
+	/// </summary>
+	void ReclaimDescriptors();
+
+	/// <summary>
+	/// テクスチャリソースとシェーダリソースビューの生成
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	/// <param name="scratchImg">画像</param>
+	/// <param name="skipMips">上位から落とすミップ数</param>
+	void CreateTextureResource(
+	  uint32_t handle, const DirectX::ScratchImage& scratchImg, uint32_t skipMips);
+
+	/// <summary>
+	/// 常駐中のミップを読み出し、上位ミップを落としたリソースに作り直す（ファイルは読み直さない）
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	/// <param name="skipMips">上位から落とすミップ数</param>
+	void Reduce(uint32_t handle, uint32_t skipMips);
+
+	/// <summary>
+	/// リソースを解放し、デスクリプタを空のビューにする（ハンドルはそのまま）
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	void Evict(uint32_t handle);
+
+	/// <summary>
+	/// 全ミップの読み直しを別スレッドで始める（読み直し中なら何もしない）
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	void RequestRestore(uint32_t handle);
+
+	/// <summary>
+	/// 読み直しが済んだテクスチャを全ミップ常駐に戻す
+	/// </summary>
+	void ApplyRestores();
+
+	/// <summary>
+	/// 読み直し中のものの完了を待って捨てる
+	/// </summary>
+	void CancelRestores();
 };
@@ -0,0 +1,125 @@
+﻿#include "TextureResidency.h"
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+void TextureResidency::Register(
+  uint32_t handle, const std::vector<uint64_t>& mipSizes, uint32_t frame) {
+	assert(!mipSizes.empty());
+
+	if (entries_.size() <= handle) {
+		entries_.resize(handle + 1);
+	}
+
+	// 上書き登録なら以前のサイズを差し引く
+	Entry& entry = entries_[handle];
+	usedBytes_ -= GetResidentBytes(handle);
+
+	entry.mipSizes = mipSizes;
+	entry.lastUsedFrame = frame;
+	entry.droppedMips = 0;
+	entry.state = State::kResident;
+	usedBytes_ += GetResidentBytes(handle);
+}
+
+void TextureResidency::Clear() {
+	entries_.clear();
+	usedBytes_ = 0;
+}
+
+bool TextureResidency::Touch(uint32_t handle, uint32_t frame) {
+	if (entries_.size() <= handle) {
+		return false;
+	}
+
+	Entry& entry = entries_[handle];
+	entry.lastUsedFrame = frame;
+	return !entry.mipSizes.empty() && entry.state != State::kResident;
+}
+
+void TextureResidency::MarkRestored(uint32_t handle) {
+	Entry& entry = entries_.at(handle);
+	usedBytes_ -= GetResidentBytes(handle);
+	entry.droppedMips = 0;
+	entry.state = State::kResident;
+	usedBytes_ += GetResidentBytes(handle);
+}
+
+std::vector<TextureResidency::Action> TextureResidency::Update(uint32_t frame) {
+	std::vector<Action> actions;
+	if (usedBytes_ <= budget_) {
+		return actions;
+	}
+
+	// 一定フレーム使われていない常駐テクスチャを古い順に並べる
+	std::vector<uint32_t> candidates;
+	for (uint32_t handle = 0; handle < entries_.size(); handle++) {
+		const Entry& entry = entries_[handle];
+		if (entry.state != State::kEvicted && !entry.mipSizes.empty() &&
+		    unusedFrameThreshold_ <= frame - entry.lastUsedFrame) {
+			candidates.push_back(handle);
+		}
+	}
+	std::stable_sort(candidates.begin(), candidates.end(), [this](uint32_t lhs, uint32_t rhs) {
+		return entries_[lhs].lastUsedFrame < entries_[rhs].lastUsedFrame;
+	});
+
+	// まずは上位ミップを落として縮退させる
+	for (uint32_t handle : candidates) {
+		if (usedBytes_ <= budget_) {
+			return actions;
+		}
+		Entry& entry = entries_[handle];
+		uint32_t maxDrop = static_cast<uint32_t>(entry.mipSizes.size()) - 1;
+		uint32_t droppedMips = (std::min)(dropMipCount_, maxDrop);
+		if (entry.state != State::kResident || droppedMips == 0) {
+			continue;
+		}
+		usedBytes_ -= GetResidentBytes(handle);
+		entry.droppedMips = droppedMips;
+		entry.state = State::kReduced;
+		usedBytes_ += GetResidentBytes(handle);
+		actions.push_back({handle, State::kReduced, droppedMips});
+	}
+
+	// それでも超過していれば追い出す
+	for (uint32_t handle : candidates) {
+		if (usedBytes_ <= budget_) {
+			break;
+		}
+		Entry& entry = entries_[handle];
+		usedBytes_ -= GetResidentBytes(handle);
+		entry.droppedMips = 0;
+		entry.state = State::kEvicted;
+
+		// 同じフレームで縮退させていたものは指示を追い出しに置き換える
+		auto it = std::find_if(actions.begin(), actions.end(), [handle](const Action& action) {
+			return action.handle == handle;
+		});
+		if (it != actions.end()) {
+			*it = {handle, State::kEvicted, 0};
+		} else {
+			actions.push_back({handle, State::kEvicted, 0});
+		}
+	}
+
+	return actions;
+}
+
+uint64_t TextureResidency::GetResidentBytes(uint32_t handle) const {
+	if (entries_.size() <= handle) {
+		return 0;
+	}
+	const Entry& entry = entries_[handle];
+	if (entry.state == State::kEvicted) {
+		return 0;
+	}
+	return SizeWithDroppedMips(entry, entry.droppedMips);
+}
+
+uint64_t TextureResidency::SizeWithDroppedMips(const Entry& entry, uint32_t droppedMips) {
+	if (entry.mipSizes.size() <= droppedMips) {
+		return 0;
+	}
+	return std::accumulate(entry.mipSizes.begin() + droppedMips, entry.mipSizes.end(), uint64_t(0));
+}
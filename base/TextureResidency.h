@@ -0,0 +1,137 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// テクスチャ常駐管理（メモリ予算とLRUによる縮退・追い出しの判断のみを行う）
+/// </summary>
+class TextureResidency {
+  public:
+	// 予算無制限
+	static const uint64_t kUnlimitedBudget = UINT64_MAX;
+
+	// 常駐状態
+	enum class State {
+		kResident, //!< 全ミップ常駐
+		kReduced,  //!< 上位ミップを落として常駐
+		kEvicted,  //!< 追い出し済み
+	};
+
+	/// <summary>
+	/// 管理情報
+	/// </summary>
+	struct Entry {
+		// ミップレベルごとのサイズ
+		std::vector<uint64_t> mipSizes;
+		// 最後に使用したフレーム
+		uint32_t lastUsedFrame = 0;
+		// 落としているミップ数
+		uint32_t droppedMips = 0;
+		// 常駐状態
+		State state = State::kEvicted;
+	};
+
+	/// <summary>
+	/// 常駐状態の変更指示
+	/// </summary>
+	struct Action {
+		// 対象のテクスチャハンドル
+		uint32_t handle;
+		// 変更後の状態
+		State state;
+		// 変更後に落とすミップ数
+		uint32_t droppedMips;
+	};
+
+	/// <summary>
+	/// テクスチャの登録（全ミップ常駐状態になる）
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	/// <param name="mipSizes">ミップレベルごとのサイズ</param>
+	/// <param name="frame">現在フレーム</param>
+	void Register(uint32_t handle, const std::vector<uint64_t>& mipSizes, uint32_t frame);
+
+	/// <summary>
+	/// 全登録の解除
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// 使用の記録
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	/// <param name="frame">現在フレーム</param>
+	/// <returns>全ミップへの復元が必要ならtrue</returns>
+	bool Touch(uint32_t handle, uint32_t frame);
+
+	/// <summary>
+	/// 全ミップへの復元完了の記録
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	void MarkRestored(uint32_t handle);
+
+	/// <summary>
+	/// 予算超過分の縮退・追い出しを決定し、状態に反映する
+	/// </summary>
+	/// <param name="frame">現在フレーム</param>
+	/// <returns>呼び出し側で実行すべき変更指示</returns>
+	std::vector<Action> Update(uint32_t frame);
+
+	/// <summary>
+	/// メモリ予算の設定
+	/// </summary>
+	/// <param name="budget">予算（バイト）</param>
+	void SetBudget(uint64_t budget) { budget_ = budget; }
+
+	uint64_t GetBudget() const { return budget_; }
+
+	/// <summary>
+	/// 縮退・追い出し対象になるまでの未使用フレーム数の設定
+	/// </summary>
+	/// <param name="frames">フレーム数</param>
+	void SetUnusedFrameThreshold(uint32_t frames) { unusedFrameThreshold_ = frames; }
+
+	/// <summary>
+	/// 縮退時に落とすミップ数の設定
+	/// </summary>
+	/// <param name="mips">ミップ数</param>
+	void SetDropMipCount(uint32_t mips) { dropMipCount_ = mips; }
+
+	/// <summary>
+	/// 常駐中の合計サイズの取得
+	/// </summary>
+	/// <returns>合計サイズ（バイト）</returns>
+	uint64_t GetUsedBytes() const { return usedBytes_; }
+
+	/// <summary>
+	/// テクスチャの現在サイズの取得
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	/// <returns>サイズ（バイト）</returns>
+	uint64_t GetResidentBytes(uint32_t handle) const;
+
+	/// <summary>
+	/// 管理情報の取得
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	/// <returns>管理情報</returns>
+	const Entry& GetEntry(uint32_t handle) const { return entries_.at(handle); }
+
+  private:
+	/// <summary>
+	/// 指定ミップ数を落とした時のサイズ
+	/// </summary>
+	static uint64_t SizeWithDroppedMips(const Entry& entry, uint32_t droppedMips);
+
+	// 管理情報（テクスチャハンドルで添え字アクセス）
+	std::vector<Entry> entries_;
+	// 常駐中の合計サイズ
+	uint64_t usedBytes_ = 0;
+	// メモリ予算
+	uint64_t budget_ = kUnlimitedBudget;
+	// 縮退・追い出し対象になるまでの未使用フレーム数
+	uint32_t unusedFrameThreshold_ = 60;
+	// 縮退時に落とすミップ数
+	uint32_t dropMipCount_ = 2;
+};
@@ -0,0 +1,148 @@
+﻿#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+
+namespace {
+// ParallelFor 1回分の共有状態
+struct ParallelForState {
+	std::atomic<uint32_t> nextChunk{0};
+	std::atomic<uint32_t> remainingChunks{0};
+	uint32_t chunkCount = 0;
+	uint32_t chunkSize = 0;
+	uint32_t count = 0;
+	const std::function<void(uint32_t, uint32_t)>* func = nullptr;
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	// 未処理のチャンクが無くなるまで処理する
+	void Drain() {
+		for (;;) {
+			uint32_t chunk = nextChunk.fetch_add(1);
+			if (chunk >= chunkCount) {
+				return;
+			}
+			uint32_t begin = chunk * chunkSize;
+			uint32_t end = (std::min)(begin + chunkSize, count);
+			(*func)(begin, end);
+			if (remainingChunks.fetch_sub(1) == 1) {
+				std::lock_guard<std::mutex> lock(mutex);
+				condition.notify_all();
+			}
+		}
+	}
+};
+} // namespace
+
+ThreadPool* ThreadPool::GetInstance() {
+	static ThreadPool instance;
+	return &instance;
+}
+
+ThreadPool::~ThreadPool() { Finalize(); }
+
+void ThreadPool::Initialize(uint32_t workerCount) {
+	assert(workers_.empty());
+
+	if (workerCount == 0) {
+		uint32_t hardwareCount = std::thread::hardware_concurrency();
+		workerCount = 1 < hardwareCount ? hardwareCount - 1 : 1;
+	}
+
+	isQuit_ = false;
+	workers_.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; i++) {
+		workers_.emplace_back([this]() { WorkerMain(); });
+	}
+}
+
+void ThreadPool::Finalize() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isQuit_ = true;
+	}
+	condition_.notify_all();
+
+	for (std::thread& worker : workers_) {
+		worker.join();
+	}
+	workers_.clear();
+}
+
+std::future<void> ThreadPool::Enqueue(std::function<void()> task) {
+	std::packaged_task<void()> packagedTask(std::move(task));
+	std::future<void> future = packagedTask.get_future();
+
+	// ワーカーがいなければその場で実行
+	if (workers_.empty()) {
+		packagedTask();
+		return future;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		tasks_.push_back(std::move(packagedTask));
+	}
+	condition_.notify_one();
+	return future;
+}
+
+void ThreadPool::ParallelFor(
+  uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& func) {
+	if (count == 0) {
+		return;
+	}
+	grainSize = (std::max)(grainSize, 1u);
+
+	// 分割数は並列数の4倍を上限に、粒度を下回らないようにする
+	uint32_t maxChunks = GetConcurrency() * 4;
+	uint32_t chunkSize = (std::max)(grainSize, (count + maxChunks - 1) / maxChunks);
+	uint32_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+	// 分割不要ならその場で実行
+	if (chunkCount == 1 || workers_.empty()) {
+		func(0, count);
+		return;
+	}
+
+	auto state = std::make_shared<ParallelForState>();
+	state->chunkCount = chunkCount;
+	state->chunkSize = chunkSize;
+	state->count = count;
+	state->remainingChunks = chunkCount;
+	state->func = &func;
+
+	// ワーカーにはチャンクの取り出し役だけを依頼する
+	// （ワーカーが埋まっていても呼び出しスレッドが全て処理するのでデッドロックしない）
+	uint32_t helperCount = (std::min)(chunkCount - 1, static_cast<uint32_t>(workers_.size()));
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (uint32_t i = 0; i < helperCount; i++) {
+			tasks_.emplace_back([state]() { state->Drain(); });
+		}
+	}
+	condition_.notify_all();
+
+	state->Drain();
+
+	// 他スレッドが処理中のチャンクの完了を待つ
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->condition.wait(lock, [&state]() { return state->remainingChunks == 0; });
+}
+
+void ThreadPool::WorkerMain() {
+	for (;;) {
+		std::packaged_task<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this]() { return isQuit_ || !tasks_.empty(); });
+			if (tasks_.empty()) {
+				return;
+			}
+			task = std::move(tasks_.front());
+			tasks_.pop_front();
+		}
+		task();
+	}
+}
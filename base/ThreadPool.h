@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// スレッドプール
+/// </summary>
+class ThreadPool {
+  public:
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static ThreadPool* GetInstance();
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="workerCount">ワーカースレッド数（0なら論理コア数-1）</param>
+	void Initialize(uint32_t workerCount = 0);
+
+	/// <summary>
+	/// 終了処理（全ワーカーの終了を待つ）
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// 呼び出しスレッドを含めた並列数の取得
+	/// </summary>
+	/// <returns>並列数</returns>
+	uint32_t GetConcurrency() const { return static_cast<uint32_t>(workers_.size()) + 1; }
+
+	/// <summary>
+	/// タスクの追加
+	/// </summary>
+	/// <param name="task">タスク</param>
+	/// <returns>完了待ち用のフューチャー</returns>
+	std::future<void> Enqueue(std::function<void()> task);
+
+	/// <summary>
+	/// 範囲を分割して並列実行する（呼び出しスレッドも処理に参加し、全て終わるまで戻らない）
+	/// </summary>
+	/// <param name="count">要素数</param>
+	/// <param name="grainSize">1タスクあたりの最小要素数</param>
+	/// <param name="func">処理関数 (begin, end)</param>
+	void ParallelFor(
+	  uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& func);
+
+  private:
+	ThreadPool() = default;
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/// <summary>
+	/// ワーカースレッドの処理
+	/// </summary>
+	void WorkerMain();
+
+	// ワーカースレッド
+	std::vector<std::thread> workers_;
+	// タスクキュー
+	std::deque<std::packaged_task<void()>> tasks_;
+	// キュー保護用
+	std::mutex mutex_;
+	// タスク到着通知
+	std::condition_variable condition_;
+	// 終了フラグ
+	bool isQuit_ = false;
+};
@@ -0,0 +1,438 @@
+﻿#include "VirtualTexture.h"
+#include "DirectXCommon.h"
+#include "ThreadPool.h"
+#include "VirtualTexturePageWriter.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <wincodec.h>
+
+#pragma comment(lib, "windowscodecs.lib")
+
+using namespace Microsoft::WRL;
+
+namespace {
+// ページファイルの形式バージョン
+const uint32_t kPageFileVersion = 1;
+// 1画素のバイト数（R8G8B8A8）
+const uint32_t kBytesPerPixel = VirtualTexturePageWriter::kBytesPerPixel;
+
+// 完了済みか
+bool IsReady(const std::future<void>& future) {
+	return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+} // namespace
+
+bool VirtualTexture::BuildPageFile(
+  const std::string& sourcePath, const std::string& pageFilePath, uint32_t pageSize,
+  uint32_t border) {
+	// ユニコード文字列に変換
+	wchar_t wfilePath[256];
+	MultiByteToWideChar(CP_ACP, 0, sourcePath.c_str(), -1, wfilePath, _countof(wfilePath));
+
+	// 巨大な画像でも全体を展開しないように、WICから直接ページの高さずつ取り出す
+	// （RGBA8への変換は値をそのまま並べ替えるだけなので、sRGBの画素はsRGBのまま残る）
+	ComPtr<IWICImagingFactory> factory;
+	HRESULT result = CoCreateInstance(
+	  CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+	if (FAILED(result)) {
+		return false;
+	}
+	ComPtr<IWICBitmapDecoder> decoder;
+	result = factory->CreateDecoderFromFilename(
+	  wfilePath, nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder);
+	if (FAILED(result)) {
+		return false;
+	}
+	ComPtr<IWICBitmapFrameDecode> frame;
+	result = decoder->GetFrame(0, &frame);
+	if (FAILED(result)) {
+		return false;
+	}
+	ComPtr<IWICFormatConverter> converter;
+	result = factory->CreateFormatConverter(&converter);
+	if (SUCCEEDED(result)) {
+		result = converter->Initialize(
+		  frame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0,
+		  WICBitmapPaletteTypeCustom);
+	}
+	if (FAILED(result)) {
+		return false;
+	}
+
+	UINT width = 0;
+	UINT height = 0;
+	converter->GetSize(&width, &height);
+	if (width % pageSize != 0 || height % pageSize != 0) {
+		return false;
+	}
+
+	PageFileHeader header{};
+	memcpy(header.magic, "VTPF", sizeof(header.magic));
+	header.version = kPageFileVersion;
+	header.width = width;
+	header.height = height;
+	header.pageSize = pageSize;
+	header.border = border;
+	header.pagesX = header.width / pageSize;
+	header.pagesY = header.height / pageSize;
+	// どちらの向きも1ページになるまで
+	header.mipCount = 1;
+	while ((std::max)(header.pagesX, header.pagesY) >> header.mipCount) {
+		header.mipCount++;
+	}
+	header.mipCount = (std::min)(header.mipCount, 1u << VirtualTexturePageTable::kMipBits);
+
+	// ミップごとの先頭ページ番号（Initializeで求める並びと同じ）
+	std::vector<uint64_t> mipPageOffsets(header.mipCount);
+	uint64_t pageCount = 0;
+	for (uint32_t mip = 0; mip < header.mipCount; mip++) {
+		mipPageOffsets[mip] = pageCount;
+		pageCount += static_cast<uint64_t>((std::max)(1u, header.pagesX >> mip)) *
+		             (std::max)(1u, header.pagesY >> mip);
+	}
+
+	std::ofstream file(pageFilePath, std::ios::binary);
+	if (file.fail()) {
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	// ミップごとのページ行は出来た順に届くので、ファイル上の位置に書き込む
+	VirtualTexturePageWriter writer;
+	writer.Initialize(
+	  width, height, pageSize, border, header.mipCount,
+	  [&](uint32_t mip, uint32_t pageY, const uint8_t* pages, size_t size) {
+		  uint64_t index = mipPageOffsets[mip] +
+		                   static_cast<uint64_t>(pageY) * (std::max)(1u, header.pagesX >> mip);
+		  file.seekp(static_cast<std::streamoff>(sizeof(header) + index * writer.GetPageBytes()));
+		  file.write(reinterpret_cast<const char*>(pages), size);
+	  });
+
+	const UINT stride = width * kBytesPerPixel;
+	std::vector<uint8_t> strip(static_cast<size_t>(stride) * pageSize);
+	for (UINT y = 0; y < height; y += pageSize) {
+		WICRect rect{0, static_cast<INT>(y), static_cast<INT>(width), static_cast<INT>(pageSize)};
+		result =
+		  converter->CopyPixels(&rect, stride, static_cast<UINT>(strip.size()), strip.data());
+		if (FAILED(result)) {
+			return false;
+		}
+		writer.AddRows(strip.data(), stride, pageSize);
+	}
+
+	return writer.IsComplete() && !file.fail();
+}
+
+void VirtualTexture::Initialize(
+  ID3D12Device* device, const std::string& pageFilePath, uint32_t slotsPerRow) {
+	assert(device);
+	// スロット座標はページテーブルに8bitずつ格納する
+	assert(0 < slotsPerRow && slotsPerRow <= 256);
+
+	device_ = device;
+	pageFilePath_ = pageFilePath;
+	slotsPerRow_ = slotsPerRow;
+
+	// ヘッダの読み込み
+	std::ifstream file(pageFilePath_, std::ios::binary);
+	assert(!file.fail());
+	file.read(reinterpret_cast<char*>(&header_), sizeof(header_));
+	assert(!file.fail());
+	assert(memcmp(header_.magic, "VTPF", sizeof(header_.magic)) == 0);
+	assert(header_.version == kPageFileVersion);
+	file.close();
+
+	const uint32_t slotSize = header_.pageSize + header_.border * 2;
+	pageBytes_ = static_cast<size_t>(slotSize) * slotSize * kBytesPerPixel;
+
+	pageTable_.Initialize(header_.pagesX, header_.pagesY, header_.mipCount);
+	pageCache_.Initialize(slotsPerRow_ * slotsPerRow_);
+	pageCache_.SetProtectedFrames(DirectXCommon::GetInstance()->GetFrameCount());
+
+	// ミップごとの先頭ページ番号
+	mipPageOffsets_.resize(header_.mipCount);
+	uint64_t pageCount = 0;
+	for (uint32_t mip = 0; mip < header_.mipCount; mip++) {
+		mipPageOffsets_[mip] = pageCount;
+		pageCount += static_cast<uint64_t>(pageTable_.GetPagesX(mip)) * pageTable_.GetPagesY(mip);
+	}
+
+	HRESULT result;
+
+	// ヒーププロパティ（TextureManagerと同じくCPUから直接書き込む）
+	CD3DX12_HEAP_PROPERTIES heapProps =
+	  CD3DX12_HEAP_PROPERTIES(D3D12_CPU_PAGE_PROPERTY_WRITE_BACK, D3D12_MEMORY_POOL_L0);
+
+	// 物理テクスチャ
+	CD3DX12_RESOURCE_DESC physicalDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+	  DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, slotsPerRow_ * slotSize, slotsPerRow_ * slotSize, 1, 1);
+	result = device_->CreateCommittedResource(
+	  &heapProps, D3D12_HEAP_FLAG_NONE, &physicalDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+	  IID_PPV_ARGS(&physicalTexture_));
+	assert(SUCCEEDED(result));
+
+	// ページテーブルテクスチャ（同時処理フレーム数だけ複製する）
+	const uint32_t frameCount = DirectXCommon::GetInstance()->GetFrameCount();
+	CD3DX12_RESOURCE_DESC pageTableDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+	  DXGI_FORMAT_R32_UINT, header_.pagesX, header_.pagesY, 1, (UINT16)header_.mipCount);
+	pageTableTextures_.resize(frameCount);
+	for (ComPtr<ID3D12Resource>& pageTableTexture : pageTableTextures_) {
+		result = device_->CreateCommittedResource(
+		  &heapProps, D3D12_HEAP_FLAG_NONE, &pageTableDesc, D3D12_RESOURCE_STATE_GENERIC_READ,
+		  nullptr, IID_PPV_ARGS(&pageTableTexture));
+		assert(SUCCEEDED(result));
+	}
+	// 全ての複製に書き込むまで古い版として扱う
+	pageTableVersion_ = 1;
+	uploadedVersions_.assign(frameCount, 0);
+
+	// デスクリプタヒープ（フレームごとに物理テクスチャとその複製のページテーブルを並べる）
+	D3D12_DESCRIPTOR_HEAP_DESC descHeapDesc = {};
+	descHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	descHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	descHeapDesc.NumDescriptors = 2 * frameCount;
+	result = device_->CreateDescriptorHeap(&descHeapDesc, IID_PPV_ARGS(&descriptorHeap_));
+	assert(SUCCEEDED(result));
+
+	descriptorIncrementSize_ =
+	  device_->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	for (uint32_t i = 0; i < frameCount; i++) {
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Format = physicalDesc.Format;
+		srvDesc.Texture2D.MipLevels = 1;
+		device_->CreateShaderResourceView(
+		  physicalTexture_.Get(), &srvDesc,
+		  CD3DX12_CPU_DESCRIPTOR_HANDLE(
+		    descriptorHeap_->GetCPUDescriptorHandleForHeapStart(), 2 * i,
+		    descriptorIncrementSize_));
+		srvDesc.Format = pageTableDesc.Format;
+		srvDesc.Texture2D.MipLevels = header_.mipCount;
+		device_->CreateShaderResourceView(
+		  pageTableTextures_[i].Get(), &srvDesc,
+		  CD3DX12_CPU_DESCRIPTOR_HANDLE(
+		    descriptorHeap_->GetCPUDescriptorHandleForHeapStart(), 2 * i + 1,
+		    descriptorIncrementSize_));
+	}
+
+	// 定数バッファ
+	CD3DX12_HEAP_PROPERTIES uploadHeapProps(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC constBufferDesc =
+	  CD3DX12_RESOURCE_DESC::Buffer((sizeof(ConstBufferData) + 0xff) & ~0xff);
+	result = device_->CreateCommittedResource(
+	  &uploadHeapProps, D3D12_HEAP_FLAG_NONE, &constBufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ,
+	  nullptr, IID_PPV_ARGS(&constBuffer_));
+	assert(SUCCEEDED(result));
+
+	ConstBufferData* constMap = nullptr;
+	result = constBuffer_->Map(0, nullptr, (void**)&constMap);
+	assert(SUCCEEDED(result));
+	constMap->virtualSize[0] = static_cast<float>(header_.pagesX * header_.pageSize);
+	constMap->virtualSize[1] = static_cast<float>(header_.pagesY * header_.pageSize);
+	constMap->pageSize = static_cast<float>(header_.pageSize);
+	constMap->border = static_cast<float>(header_.border);
+	constMap->physicalSize[0] = static_cast<float>(physicalDesc.Width);
+	constMap->physicalSize[1] = static_cast<float>(physicalDesc.Height);
+	constMap->mipCount = header_.mipCount;
+	constMap->pad = 0;
+	constBuffer_->Unmap(0, nullptr);
+
+	// 最も粗いミップは常に引けるように同期で読み込んで固定する
+	const uint32_t topMip = header_.mipCount - 1;
+	assert(
+	  pageTable_.GetPagesX(topMip) * pageTable_.GetPagesY(topMip) < pageCache_.GetSlotCount());
+	for (uint32_t y = 0; y < pageTable_.GetPagesY(topMip); y++) {
+		for (uint32_t x = 0; x < pageTable_.GetPagesX(topMip); x++) {
+			LoadedPage page{VirtualTexturePageTable::PackPageId(topMip, x, y), {}};
+			bool loaded = ReadPage(pageFilePath_, GetPageOffset(page.pageId), pageBytes_, page.pixels);
+			assert(loaded);
+			(void)loaded;
+			CommitPage(page);
+			pageCache_.Lock(page.pageId);
+		}
+	}
+
+	pageTable_.ClearDirty();
+	for (uint32_t i = 0; i < frameCount; i++) {
+		UploadPageTable(i);
+	}
+}
+
+void VirtualTexture::Finalize() {
+	for (PendingBatch& batch : pendingBatches_) {
+		batch.future.wait();
+	}
+	pendingBatches_.clear();
+	inFlight_.clear();
+	pendingCommits_.clear();
+}
+
+void VirtualTexture::ProcessFeedback(const uint32_t* samples, size_t count) {
+	frame_++;
+	feedback_.Process(samples, count, pageTable_, pageCache_, frame_);
+	feedback_.GetRequests(maxRequestsPerFrame_, requests_);
+}
+
+void VirtualTexture::Update() {
+	// 前のページをGPUが読み終えたスロットに転送する
+	FlushPendingCommits();
+
+	// 読み込みが済んだページを転送する
+	for (auto it = pendingBatches_.begin(); it != pendingBatches_.end();) {
+		if (!IsReady(it->future)) {
+			++it;
+			continue;
+		}
+		for (LoadedPage& page : *it->pages) {
+			inFlight_.erase(page.pageId);
+			if (!page.pixels.empty() && !pageCache_.IsResident(page.pageId)) {
+				CommitPage(page);
+			}
+		}
+		it = pendingBatches_.erase(it);
+	}
+
+	// 新しい要求をまとめて別スレッドで読み込む
+	std::vector<std::pair<uint32_t, uint64_t>> reads;
+	for (uint32_t pageId : requests_) {
+		if (inFlight_.insert(pageId).second) {
+			reads.emplace_back(pageId, GetPageOffset(pageId));
+		}
+	}
+	requests_.clear();
+	if (!reads.empty()) {
+		auto pages = std::make_shared<std::vector<LoadedPage>>(reads.size());
+		std::string pageFilePath = pageFilePath_;
+		size_t pageBytes = pageBytes_;
+		std::future<void> future = ThreadPool::GetInstance()->Enqueue(
+		  [pages, reads, pageFilePath, pageBytes]() {
+			  for (size_t i = 0; i < reads.size(); i++) {
+				  LoadedPage& page = (*pages)[i];
+				  page.pageId = reads[i].first;
+				  if (!ReadPage(pageFilePath, reads[i].second, pageBytes, page.pixels)) {
+					  page.pixels.clear();
+				  }
+			  }
+		  });
+		pendingBatches_.push_back({pages, std::move(future)});
+	}
+
+	// 記録中のフレームの複製だけを書き換える
+	// （他の複製はGPUが読んでいるかもしれないので、そのフレームの番が来てから追いつかせる）
+	if (pageTable_.IsDirty()) {
+		pageTableVersion_++;
+		pageTable_.ClearDirty();
+	}
+	uint32_t frameIndex = DirectXCommon::GetInstance()->GetFrameIndex();
+	if (uploadedVersions_[frameIndex] != pageTableVersion_) {
+		UploadPageTable(frameIndex);
+	}
+}
+
+void VirtualTexture::SetGraphicsRootDescriptorTable(
+  ID3D12GraphicsCommandList* commandList, UINT rootParamIndex) {
+	ID3D12DescriptorHeap* ppHeaps[] = {descriptorHeap_.Get()};
+	commandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+	uint32_t frameIndex = DirectXCommon::GetInstance()->GetFrameIndex();
+	commandList->SetGraphicsRootDescriptorTable(
+	  rootParamIndex,
+	  CD3DX12_GPU_DESCRIPTOR_HANDLE(
+	    descriptorHeap_->GetGPUDescriptorHandleForHeapStart(), 2 * frameIndex,
+	    descriptorIncrementSize_));
+}
+
+void VirtualTexture::SetGraphicsRootConstantBufferView(
+  ID3D12GraphicsCommandList* commandList, UINT rootParamIndex) {
+	commandList->SetGraphicsRootConstantBufferView(
+	  rootParamIndex, constBuffer_->GetGPUVirtualAddress());
+}
+
+uint64_t VirtualTexture::GetPageOffset(uint32_t pageId) const {
+	uint32_t mip, x, y;
+	VirtualTexturePageTable::UnpackPageId(pageId, mip, x, y);
+	uint64_t index = mipPageOffsets_[mip] + static_cast<uint64_t>(y) * pageTable_.GetPagesX(mip) + x;
+	return sizeof(PageFileHeader) + index * pageBytes_;
+}
+
+bool VirtualTexture::ReadPage(
+  const std::string& pageFilePath, uint64_t offset, size_t size, std::vector<uint8_t>& pixels) {
+	std::ifstream file(pageFilePath, std::ios::binary);
+	if (file.fail()) {
+		return false;
+	}
+	pixels.resize(size);
+	file.seekg(static_cast<std::streamoff>(offset));
+	file.read(reinterpret_cast<char*>(pixels.data()), size);
+	return !file.fail();
+}
+
+bool VirtualTexture::CommitPage(LoadedPage& page) {
+	// スロットの確保（このフレームで使用中のページしか無ければ次のフレームに回す）
+	uint32_t evictedPageId = VirtualTexturePageCache::kInvalid;
+	uint32_t slot = pageCache_.Allocate(page.pageId, frame_, evictedPageId);
+	if (slot == VirtualTexturePageCache::kInvalid) {
+		return false;
+	}
+
+	// 追い出したページは提出済みのフレームのページテーブルからまだ引かれるので、
+	// 記録中のフレームまでのGPU処理が終わってから転送して登録する（それまでは粗いミップで描かれる）
+	if (evictedPageId != VirtualTexturePageCache::kInvalid) {
+		pageTable_.Unmap(evictedPageId);
+		pendingCommits_.push_back(
+		  {slot, DirectXCommon::GetInstance()->GetFrameNumber(), std::move(page)});
+		return true;
+	}
+
+	// 使ったことのないスロットはどのフレームからも引かれていないので、そのまま書き込む
+	WritePage(page, slot);
+	return true;
+}
+
+void VirtualTexture::WritePage(const LoadedPage& page, uint32_t slot) {
+	// 物理テクスチャのスロットに転送
+	const UINT slotSize = header_.pageSize + header_.border * 2;
+	D3D12_BOX box{};
+	box.left = (slot % slotsPerRow_) * slotSize;
+	box.top = (slot / slotsPerRow_) * slotSize;
+	box.front = 0;
+	box.right = box.left + slotSize;
+	box.bottom = box.top + slotSize;
+	box.back = 1;
+	HRESULT result = physicalTexture_->WriteToSubresource(
+	  0, &box, page.pixels.data(), slotSize * kBytesPerPixel, (UINT)pageBytes_);
+	assert(SUCCEEDED(result));
+
+	pageTable_.Map(page.pageId, slot);
+}
+
+void VirtualTexture::FlushPendingCommits() {
+	uint64_t completedFrameNumber = DirectXCommon::GetInstance()->GetCompletedFrameNumber();
+	for (auto it = pendingCommits_.begin(); it != pendingCommits_.end();) {
+		if (completedFrameNumber < it->frameNumber) {
+			++it;
+			continue;
+		}
+		// 待っている間に追い出されていれば捨てる
+		if (pageCache_.GetSlot(it->page.pageId) == it->slot) {
+			WritePage(it->page, it->slot);
+		}
+		it = pendingCommits_.erase(it);
+	}
+}
+
+void VirtualTexture::UploadPageTable(uint32_t frameIndex) {
+	ID3D12Resource* pageTableTexture = pageTableTextures_[frameIndex].Get();
+	for (uint32_t mip = 0; mip < header_.mipCount; mip++) {
+		pageTable_.BuildIndirection(mip, slotsPerRow_, indirection_);
+		UINT rowPitch = pageTable_.GetPagesX(mip) * sizeof(uint32_t);
+		HRESULT result = pageTableTexture->WriteToSubresource(
+		  mip, nullptr, indirection_.data(), rowPitch, (UINT)(indirection_.size() * sizeof(uint32_t)));
+		assert(SUCCEEDED(result));
+	}
+	uploadedVersions_[frameIndex] = pageTableVersion_;
+}
@@ -0,0 +1,214 @@
+﻿#pragma once
+
+#include "VirtualTextureFeedback.h"
+#include "VirtualTexturePageCache.h"
+#include "VirtualTexturePageTable.h"
+#include <d3dx12.h>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <wrl.h>
+
+/// <summary>
+/// 仮想テクスチャ
+/// （ページファイルから必要なページだけを物理テクスチャに読み込み、ページテーブルで参照する）
+/// </summary>
+class VirtualTexture {
+  public:
+	// ページの一辺（ボーダーを除く）
+	static const uint32_t kDefaultPageSize = 128;
+	// ページ周囲のボーダー（バイリニア・異方性フィルタ用）
+	static const uint32_t kDefaultBorder = 4;
+	// 1フレームあたりの最大読み込み要求数
+	static const uint32_t kDefaultMaxRequestsPerFrame = 16;
+
+	/// <summary>
+	/// ページファイルのヘッダ
+	/// </summary>
+	struct PageFileHeader {
+		char magic[4];      // "VTPF"
+		uint32_t version;   // 形式バージョン
+		uint32_t width;     // ミップ0の幅
+		uint32_t height;    // ミップ0の高さ
+		uint32_t pageSize;  // ページの一辺（ボーダーを除く）
+		uint32_t border;    // ボーダー
+		uint32_t pagesX;    // ミップ0の横ページ数
+		uint32_t pagesY;    // ミップ0の縦ページ数
+		uint32_t mipCount;  // ミップレベル数
+	};
+
+	/// <summary>
+	/// シェーダに渡す定数（VirtualTexture.hlsliのVTParamsと同じ並び）
+	/// </summary>
+	struct ConstBufferData {
+		float virtualSize[2];  // ミップ0の大きさ（ページ数×ページの一辺）
+		float pageSize;        // ページの一辺
+		float border;          // ボーダー
+		float physicalSize[2]; // 物理テクスチャの大きさ
+		uint32_t mipCount;     // ミップレベル数
+		uint32_t pad;
+	};
+
+	/// <summary>
+	/// 画像をページに分割してページファイルを作る（オフライン処理）
+	/// （元画像はページの高さずつ読んで縮小していくので、全体やミップチェーンを展開しない）
+	/// </summary>
+	/// <param name="sourcePath">元画像のパス</param>
+	/// <param name="pageFilePath">出力するページファイルのパス</param>
+	/// <param name="pageSize">ページの一辺（元画像の幅と高さはこの倍数）</param>
+	/// <param name="border">ボーダー</param>
+	/// <returns>成否</returns>
+	static bool BuildPageFile(
+	  const std::string& sourcePath, const std::string& pageFilePath,
+	  uint32_t pageSize = kDefaultPageSize, uint32_t border = kDefaultBorder);
+
+	/// <summary>
+	/// 初期化（最も粗いミップのページは常駐させる）
+	/// </summary>
+	/// <param name="device">デバイス</param>
+	/// <param name="pageFilePath">ページファイルのパス</param>
+	/// <param name="slotsPerRow">物理テクスチャの一辺あたりのスロット数</param>
+	void Initialize(ID3D12Device* device, const std::string& pageFilePath, uint32_t slotsPerRow = 16);
+
+	/// <summary>
+	/// 終了処理（読み込み中のページを待つ）
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// フィードバックの反映（描画したフレームのページID列を渡す）
+	/// </summary>
+	/// <param name="samples">ページIDの配列</param>
+	/// <param name="count">要素数</param>
+	void ProcessFeedback(const uint32_t* samples, size_t count);
+
+	/// <summary>
+	/// 毎フレーム処理（フレーム境界で呼ぶ。読み込みが済んだページを物理テクスチャに転送する）
+	/// </summary>
+	void Update();
+
+	/// <summary>
+	/// 物理テクスチャとページテーブルのデスクリプタテーブルをセット（t0: 物理テクスチャ, t1: ページテーブル）
+	/// （ページテーブルは記録中のフレームの複製を使う）
+	/// </summary>
+	/// <param name="commandList">コマンドリスト</param>
+	/// <param name="rootParamIndex">ルートパラメータ番号</param>
+	void SetGraphicsRootDescriptorTable(ID3D12GraphicsCommandList* commandList, UINT rootParamIndex);
+
+	/// <summary>
+	/// 定数バッファビューをセット
+	/// </summary>
+	/// <param name="commandList">コマンドリスト</param>
+	/// <param name="rootParamIndex">ルートパラメータ番号</param>
+	void SetGraphicsRootConstantBufferView(ID3D12GraphicsCommandList* commandList, UINT rootParamIndex);
+
+	/// <summary>
+	/// 1フレームあたりの最大読み込み要求数の設定
+	/// </summary>
+	void SetMaxRequestsPerFrame(uint32_t maxRequests) { maxRequestsPerFrame_ = maxRequests; }
+
+	const PageFileHeader& GetHeader() const { return header_; }
+	const VirtualTexturePageTable& GetPageTable() const { return pageTable_; }
+	const VirtualTexturePageCache& GetPageCache() const { return pageCache_; }
+	uint32_t GetPendingPageCount() const { return static_cast<uint32_t>(inFlight_.size()); }
+
+  private:
+	// 読み込みが済んだページ
+	struct LoadedPage {
+		uint32_t pageId;
+		std::vector<uint8_t> pixels;
+	};
+
+	// 読み込み中の一括要求
+	struct PendingBatch {
+		std::shared_ptr<std::vector<LoadedPage>> pages;
+		std::future<void> future;
+	};
+
+	// 追い出したスロットへの転送待ち（追い出したフレームのGPU処理が終わるまで書き込まない）
+	struct PendingCommit {
+		uint32_t slot;
+		uint64_t frameNumber;
+		LoadedPage page;
+	};
+
+	/// <summary>
+	/// ページファイル内の位置
+	/// </summary>
+	uint64_t GetPageOffset(uint32_t pageId) const;
+
+	/// <summary>
+	/// ページの読み込み（別スレッドから呼ぶ）
+	/// </summary>
+	static bool ReadPage(
+	  const std::string& pageFilePath, uint64_t offset, size_t size, std::vector<uint8_t>& pixels);
+
+	/// <summary>
+	/// 読み込んだページにスロットを割り当て、物理テクスチャに転送してページテーブルに登録する
+	/// （追い出したスロットなら画素を預かり、転送と登録はGPUが前のページを読み終えてから行う）
+	/// </summary>
+	/// <returns>スロットを割り当てられればtrue</returns>
+	bool CommitPage(LoadedPage& page);
+
+	/// <summary>
+	/// 物理テクスチャのスロットへの転送とページテーブルへの登録
+	/// </summary>
+	void WritePage(const LoadedPage& page, uint32_t slot);
+
+	/// <summary>
+	/// GPU処理が終わったフレームで追い出したスロットへの転送
+	/// </summary>
+	void FlushPendingCommits();
+
+	/// <summary>
+	/// ページテーブルテクスチャの更新
+	/// </summary>
+	/// <param name="frameIndex">書き換えるフレームの複製</param>
+	void UploadPageTable(uint32_t frameIndex);
+
+	// デバイス
+	ID3D12Device* device_ = nullptr;
+	// ページファイル
+	std::string pageFilePath_;
+	PageFileHeader header_ = {};
+	// ミップごとの先頭ページ番号
+	std::vector<uint64_t> mipPageOffsets_;
+	// 1ページのバイト数（ボーダー込み）
+	size_t pageBytes_ = 0;
+	// 物理テクスチャの一辺あたりのスロット数
+	uint32_t slotsPerRow_ = 0;
+	// 物理テクスチャ
+	Microsoft::WRL::ComPtr<ID3D12Resource> physicalTexture_;
+	// ページテーブルテクスチャ（ミップごとにR32_UINT。GPUが読んでいる間は書き換えないので
+	// フレームごとに持つ）
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> pageTableTextures_;
+	// ページテーブルの版と、フレームごとの複製に書き込んだ版
+	uint64_t pageTableVersion_ = 0;
+	std::vector<uint64_t> uploadedVersions_;
+	// 定数バッファ
+	Microsoft::WRL::ComPtr<ID3D12Resource> constBuffer_;
+	// デスクリプタヒープ（フレームごとに物理テクスチャとページテーブルを並べる）
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> descriptorHeap_;
+	UINT descriptorIncrementSize_ = 0;
+	// ページテーブル
+	VirtualTexturePageTable pageTable_;
+	// 物理ページキャッシュ
+	VirtualTexturePageCache pageCache_;
+	// フィードバック処理
+	VirtualTextureFeedback feedback_;
+	// 読み込み中のページ
+	std::unordered_set<uint32_t> inFlight_;
+	std::vector<PendingBatch> pendingBatches_;
+	// 追い出したスロットへの転送待ち
+	std::vector<PendingCommit> pendingCommits_;
+	// 要求の作業用
+	std::vector<uint32_t> requests_;
+	// ページテーブルの作業用
+	std::vector<uint32_t> indirection_;
+	// フレーム番号
+	uint32_t frame_ = 0;
+	// 1フレームあたりの最大読み込み要求数
+	uint32_t maxRequestsPerFrame_ = kDefaultMaxRequestsPerFrame;
+};
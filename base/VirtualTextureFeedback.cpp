@@ -0,0 +1,60 @@
+﻿#include "VirtualTextureFeedback.h"
+#include "VirtualTexturePageCache.h"
+#include "VirtualTexturePageTable.h"
+#include <algorithm>
+
+void VirtualTextureFeedback::Process(
+  const uint32_t* samples, size_t count, const VirtualTexturePageTable& pageTable,
+  VirtualTexturePageCache& cache, uint32_t frame) {
+	// 同じページへの参照をまとめる（隣り合う画素は同じページのことが多い）
+	counts_.clear();
+	uint32_t previous = kEmptySample;
+	uint32_t* previousCount = nullptr;
+	for (size_t i = 0; i < count; i++) {
+		uint32_t pageId = samples[i];
+		if (pageId == kEmptySample || !pageTable.IsValidPage(pageId)) {
+			continue;
+		}
+		if (pageId != previous) {
+			previous = pageId;
+			previousCount = &counts_[pageId];
+		}
+		(*previousCount)++;
+	}
+	referencedPageCount_ = static_cast<uint32_t>(counts_.size());
+
+	// 要求ページとその祖先をたどり、常駐していれば使用済みに、無ければ読み込み要求にする
+	// （祖先を先に揃えておくと、細かいページが届くまで粗いページで代用できる）
+	std::unordered_map<uint32_t, uint32_t> missing;
+	for (const auto& entry : counts_) {
+		for (uint32_t id = entry.first; pageTable.IsValidPage(id);
+		     id = VirtualTexturePageTable::ParentPageId(id)) {
+			if (!cache.Touch(id, frame)) {
+				missing[id] += entry.second;
+			}
+		}
+	}
+
+	missing_.assign(missing.begin(), missing.end());
+	std::sort(
+	  missing_.begin(), missing_.end(),
+	  [](const std::pair<uint32_t, uint32_t>& lhs, const std::pair<uint32_t, uint32_t>& rhs) {
+		  uint32_t lhsMip = lhs.first >> (VirtualTexturePageTable::kPageCoordBits * 2);
+		  uint32_t rhsMip = rhs.first >> (VirtualTexturePageTable::kPageCoordBits * 2);
+		  if (lhsMip != rhsMip) {
+			  return lhsMip > rhsMip;
+		  }
+		  if (lhs.second != rhs.second) {
+			  return lhs.second > rhs.second;
+		  }
+		  return lhs.first < rhs.first;
+	  });
+}
+
+void VirtualTextureFeedback::GetRequests(uint32_t maxRequests, std::vector<uint32_t>& requests) const {
+	requests.clear();
+	size_t count = (std::min)(static_cast<size_t>(maxRequests), missing_.size());
+	for (size_t i = 0; i < count; i++) {
+		requests.push_back(missing_[i].first);
+	}
+}
@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class VirtualTexturePageTable;
+class VirtualTexturePageCache;
+
+/// <summary>
+/// 仮想テクスチャのフィードバック処理
+/// （描画時に書き出されたページIDを集計し、読み込むべきページを優先度順に決める）
+/// </summary>
+class VirtualTextureFeedback {
+  public:
+	// 何も描かれていない画素
+	static const uint32_t kEmptySample = UINT32_MAX;
+
+	/// <summary>
+	/// フィードバックの集計
+	/// </summary>
+	/// <param name="samples">ページIDの配列</param>
+	/// <param name="count">要素数</param>
+	/// <param name="pageTable">ページテーブル</param>
+	/// <param name="cache">物理ページキャッシュ（常駐ページを使用済みにする）</param>
+	/// <param name="frame">現在のフレーム番号</param>
+	void Process(
+	  const uint32_t* samples, size_t count, const VirtualTexturePageTable& pageTable,
+	  VirtualTexturePageCache& cache, uint32_t frame);
+
+	/// <summary>
+	/// 読み込み要求の取得（粗いミップ・参照数の多いページの順）
+	/// </summary>
+	/// <param name="maxRequests">最大要求数</param>
+	/// <param name="requests">格納先</param>
+	void GetRequests(uint32_t maxRequests, std::vector<uint32_t>& requests) const;
+
+	/// <summary>
+	/// 直前の集計で参照されたページ数
+	/// </summary>
+	uint32_t GetReferencedPageCount() const { return referencedPageCount_; }
+
+  private:
+	// ページIDごとの参照数（集計用）
+	std::unordered_map<uint32_t, uint32_t> counts_;
+	// 未常駐ページと参照数
+	std::vector<std::pair<uint32_t, uint32_t>> missing_;
+	// 参照されたページ数
+	uint32_t referencedPageCount_ = 0;
+};
@@ -0,0 +1,113 @@
+﻿#include "VirtualTexturePageCache.h"
+#include <cassert>
+
+void VirtualTexturePageCache::Initialize(uint32_t slotCount) {
+	assert(0 < slotCount);
+
+	slots_.assign(slotCount, Slot());
+	pageToSlot_.clear();
+	head_ = kInvalid;
+	tail_ = kInvalid;
+	hitCount_ = 0;
+	missCount_ = 0;
+	evictionCount_ = 0;
+
+	// 空きスロットはリストの末尾側から使われる
+	for (uint32_t slot = 0; slot < slotCount; slot++) {
+		PushFront(slot);
+	}
+}
+
+bool VirtualTexturePageCache::Touch(uint32_t pageId, uint32_t frame) {
+	auto it = pageToSlot_.find(pageId);
+	if (it == pageToSlot_.end()) {
+		missCount_++;
+		return false;
+	}
+
+	hitCount_++;
+	uint32_t slot = it->second;
+	slots_[slot].lastUsedFrame = frame;
+	if (!slots_[slot].locked) {
+		Unlink(slot);
+		PushFront(slot);
+	}
+	return true;
+}
+
+uint32_t VirtualTexturePageCache::Allocate(uint32_t pageId, uint32_t frame, uint32_t& evictedPageId) {
+	assert(!IsResident(pageId));
+	evictedPageId = kInvalid;
+
+	// 最も長く使われていないスロット（固定中のスロットはリストに居ない）
+	uint32_t slot = tail_;
+	if (slot == kInvalid) {
+		return kInvalid;
+	}
+	Slot& victim = slots_[slot];
+	if (victim.pageId != kInvalid) {
+		// GPUが処理中のフレームで参照しているページを追い出すと描画が崩れるので見送る
+		if (frame - victim.lastUsedFrame < protectedFrames_) {
+			return kInvalid;
+		}
+		evictedPageId = victim.pageId;
+		pageToSlot_.erase(victim.pageId);
+		evictionCount_++;
+	}
+
+	victim.pageId = pageId;
+	victim.lastUsedFrame = frame;
+	pageToSlot_[pageId] = slot;
+	Unlink(slot);
+	PushFront(slot);
+	return slot;
+}
+
+uint32_t VirtualTexturePageCache::GetSlot(uint32_t pageId) const {
+	auto it = pageToSlot_.find(pageId);
+	return it != pageToSlot_.end() ? it->second : kInvalid;
+}
+
+void VirtualTexturePageCache::SetProtectedFrames(uint32_t frames) {
+	assert(0 < frames);
+	protectedFrames_ = frames;
+}
+
+void VirtualTexturePageCache::Lock(uint32_t pageId) {
+	auto it = pageToSlot_.find(pageId);
+	assert(it != pageToSlot_.end());
+	Slot& slot = slots_[it->second];
+	if (!slot.locked) {
+		Unlink(it->second);
+		slot.locked = true;
+	}
+}
+
+void VirtualTexturePageCache::Unlink(uint32_t slot) {
+	Slot& s = slots_[slot];
+	if (s.prev != kInvalid) {
+		slots_[s.prev].next = s.next;
+	} else {
+		head_ = s.next;
+	}
+	if (s.next != kInvalid) {
+		slots_[s.next].prev = s.prev;
+	} else {
+		tail_ = s.prev;
+	}
+	s.prev = kInvalid;
+	s.next = kInvalid;
+}
+
+void VirtualTexturePageCache::PushFront(uint32_t slot) {
+	Slot& s = slots_[slot];
+	s.prev = kInvalid;
+	s.next = head_;
+	if (head_ != kInvalid) {
+		slots_[head_].prev = slot;
+	}
+	head_ = slot;
+	if (tail_ == kInvalid) {
+		tail_ = slot;
+	}
+}
@@ -0,0 +1,102 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// 仮想テクスチャの物理ページキャッシュ（LRUでスロットを再利用する）
+/// </summary>
+class VirtualTexturePageCache {
+  public:
+	// 空き・追い出し無し
+	static const uint32_t kInvalid = UINT32_MAX;
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="slotCount">物理スロット数</param>
+	void Initialize(uint32_t slotCount);
+
+	/// <summary>
+	/// 常駐中のページを使用済みにする
+	/// </summary>
+	/// <param name="pageId">ページID</param>
+	/// <param name="frame">現在のフレーム番号</param>
+	/// <returns>常駐していればtrue</returns>
+	bool Touch(uint32_t pageId, uint32_t frame);
+
+	/// <summary>
+	/// ページにスロットを割り当てる（空きがなければ最も長く使われていないページを追い出す）
+	/// </summary>
+	/// <param name="pageId">ページID</param>
+	/// <param name="frame">現在のフレーム番号</param>
+	/// <param name="evictedPageId">追い出したページID（無ければkInvalid）</param>
+	/// <returns>スロット番号（追い出さないフレーム数以内に使ったページしか無ければkInvalid）</returns>
+	uint32_t Allocate(uint32_t pageId, uint32_t frame, uint32_t& evictedPageId);
+
+	/// <summary>
+	/// 追い出さないフレーム数の設定（この数のフレーム以内に使われたページは、GPUが読んでいる可能性がある）
+	/// </summary>
+	/// <param name="frames">フレーム数（1以上）</param>
+	void SetProtectedFrames(uint32_t frames);
+
+	/// <summary>
+	/// ページを追い出し対象から外す（最も粗いミップなど常駐させ続けるページ用）
+	/// </summary>
+	/// <param name="pageId">常駐中のページID</param>
+	void Lock(uint32_t pageId);
+
+	/// <summary>
+	/// ページが常駐中か
+	/// </summary>
+	bool IsResident(uint32_t pageId) const { return pageToSlot_.count(pageId) != 0; }
+
+	/// <summary>
+	/// ページのスロット番号の取得
+	/// </summary>
+	/// <param name="pageId">ページID</param>
+	/// <returns>スロット番号（常駐していなければkInvalid）</returns>
+	uint32_t GetSlot(uint32_t pageId) const;
+
+	uint32_t GetSlotCount() const { return static_cast<uint32_t>(slots_.size()); }
+	uint32_t GetResidentCount() const { return static_cast<uint32_t>(pageToSlot_.size()); }
+	uint64_t GetHitCount() const { return hitCount_; }
+	uint64_t GetMissCount() const { return missCount_; }
+	uint64_t GetEvictionCount() const { return evictionCount_; }
+
+  private:
+	// 物理スロット
+	struct Slot {
+		uint32_t pageId = kInvalid;
+		uint32_t lastUsedFrame = 0;
+		bool locked = false;
+		// LRUリスト（先頭が最近使用）
+		uint32_t prev = kInvalid;
+		uint32_t next = kInvalid;
+	};
+
+	/// <summary>
+	/// LRUリストから外す
+	/// </summary>
+	void Unlink(uint32_t slot);
+
+	/// <summary>
+	/// LRUリストの先頭に入れる
+	/// </summary>
+	void PushFront(uint32_t slot);
+
+	// 物理スロット
+	std::vector<Slot> slots_;
+	// ページID → スロット
+	std::unordered_map<uint32_t, uint32_t> pageToSlot_;
+	// LRUリストの先頭と末尾
+	uint32_t head_ = kInvalid;
+	uint32_t tail_ = kInvalid;
+	// 追い出さないフレーム数
+	uint32_t protectedFrames_ = 1;
+	// 統計
+	uint64_t hitCount_ = 0;
+	uint64_t missCount_ = 0;
+	uint64_t evictionCount_ = 0;
+};
@@ -0,0 +1,86 @@
+﻿#include "VirtualTexturePageTable.h"
+#include <algorithm>
+#include <cassert>
+
+const uint32_t VirtualTexturePageTable::kInvalidSlot;
+
+void VirtualTexturePageTable::Initialize(uint32_t pagesX, uint32_t pagesY, uint32_t mipCount) {
+	assert(0 < mipCount && mipCount <= (1u << kMipBits));
+	assert(pagesX <= (1u << kPageCoordBits) && pagesY <= (1u << kPageCoordBits));
+
+	levels_.resize(mipCount);
+	for (uint32_t mip = 0; mip < mipCount; mip++) {
+		Level& level = levels_[mip];
+		level.pagesX = (std::max)(1u, pagesX >> mip);
+		level.pagesY = (std::max)(1u, pagesY >> mip);
+		level.slots.assign(static_cast<size_t>(level.pagesX) * level.pagesY, kInvalidSlot);
+	}
+	isDirty_ = true;
+}
+
+bool VirtualTexturePageTable::IsValidPage(uint32_t pageId) const {
+	uint32_t mip, x, y;
+	UnpackPageId(pageId, mip, x, y);
+	return mip < levels_.size() && x < levels_[mip].pagesX && y < levels_[mip].pagesY;
+}
+
+void VirtualTexturePageTable::Map(uint32_t pageId, uint32_t slot) {
+	At(pageId) = slot;
+	isDirty_ = true;
+}
+
+void VirtualTexturePageTable::Unmap(uint32_t pageId) {
+	At(pageId) = kInvalidSlot;
+	isDirty_ = true;
+}
+
+uint32_t VirtualTexturePageTable::GetSlot(uint32_t pageId) const { return At(pageId); }
+
+bool VirtualTexturePageTable::Resolve(
+  uint32_t pageId, uint32_t& residentPageId, uint32_t& slot) const {
+	for (uint32_t id = pageId; IsValidPage(id); id = ParentPageId(id)) {
+		if (At(id) != kInvalidSlot) {
+			residentPageId = id;
+			slot = At(id);
+			return true;
+		}
+	}
+	return false;
+}
+
+void VirtualTexturePageTable::BuildIndirection(
+  uint32_t mip, uint32_t slotsPerRow, std::vector<uint32_t>& texels) const {
+	const Level& level = levels_.at(mip);
+	texels.assign(level.slots.size(), 0);
+
+	for (uint32_t y = 0; y < level.pagesY; y++) {
+		for (uint32_t x = 0; x < level.pagesX; x++) {
+			uint32_t residentPageId = 0;
+			uint32_t slot = 0;
+			if (!Resolve(PackPageId(mip, x, y), residentPageId, slot)) {
+				continue;
+			}
+			uint32_t residentMip, residentX, residentY;
+			UnpackPageId(residentPageId, residentMip, residentX, residentY);
+			texels[static_cast<size_t>(y) * level.pagesX + x] = (slot % slotsPerRow) |
+			                                                    ((slot / slotsPerRow) << 8) |
+			                                                    (residentMip << 16) | (1u << 24);
+		}
+	}
+}
+
+uint32_t& VirtualTexturePageTable::At(uint32_t pageId) {
+	assert(IsValidPage(pageId));
+	uint32_t mip, x, y;
+	UnpackPageId(pageId, mip, x, y);
+	Level& level = levels_[mip];
+	return level.slots[static_cast<size_t>(y) * level.pagesX + x];
+}
+
+const uint32_t& VirtualTexturePageTable::At(uint32_t pageId) const {
+	assert(IsValidPage(pageId));
+	uint32_t mip, x, y;
+	UnpackPageId(pageId, mip, x, y);
+	const Level& level = levels_[mip];
+	return level.slots[static_cast<size_t>(y) * level.pagesX + x];
+}
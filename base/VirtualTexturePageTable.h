@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 仮想テクスチャのページテーブル（仮想ページ → 物理スロットの対応）
+/// </summary>
+class VirtualTexturePageTable {
+  public:
+	// 未割り当て
+	static const uint32_t kInvalidSlot = UINT32_MAX;
+	// ページ番号の各成分のビット数
+	static const uint32_t kPageCoordBits = 14;
+	static const uint32_t kMipBits = 4;
+
+	/// <summary>
+	/// ページIDの生成
+	/// </summary>
+	/// <param name="mip">ミップレベル</param>
+	/// <param name="x">ページ番号X</param>
+	/// <param name="y">ページ番号Y</param>
+	/// <returns>ページID</returns>
+	static uint32_t PackPageId(uint32_t mip, uint32_t x, uint32_t y) {
+		return (mip << (kPageCoordBits * 2)) | (y << kPageCoordBits) | x;
+	}
+
+	/// <summary>
+	/// ページIDの分解
+	/// </summary>
+	static void UnpackPageId(uint32_t pageId, uint32_t& mip, uint32_t& x, uint32_t& y) {
+		const uint32_t mask = (1u << kPageCoordBits) - 1;
+		x = pageId & mask;
+		y = (pageId >> kPageCoordBits) & mask;
+		mip = pageId >> (kPageCoordBits * 2);
+	}
+
+	/// <summary>
+	/// 一つ粗いミップの親ページIDを求める
+	/// </summary>
+	static uint32_t ParentPageId(uint32_t pageId) {
+		uint32_t mip, x, y;
+		UnpackPageId(pageId, mip, x, y);
+		return PackPageId(mip + 1, x / 2, y / 2);
+	}
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="pagesX">ミップ0の横ページ数</param>
+	/// <param name="pagesY">ミップ0の縦ページ数</param>
+	/// <param name="mipCount">ミップレベル数</param>
+	void Initialize(uint32_t pagesX, uint32_t pagesY, uint32_t mipCount);
+
+	uint32_t GetMipCount() const { return static_cast<uint32_t>(levels_.size()); }
+	uint32_t GetPagesX(uint32_t mip) const { return levels_.at(mip).pagesX; }
+	uint32_t GetPagesY(uint32_t mip) const { return levels_.at(mip).pagesY; }
+
+	/// <summary>
+	/// ページIDが範囲内か
+	/// </summary>
+	bool IsValidPage(uint32_t pageId) const;
+
+	/// <summary>
+	/// ページを物理スロットに割り当てる
+	/// </summary>
+	void Map(uint32_t pageId, uint32_t slot);
+
+	/// <summary>
+	/// ページの割り当てを解除する
+	/// </summary>
+	void Unmap(uint32_t pageId);
+
+	/// <summary>
+	/// ページに割り当てられた物理スロットの取得
+	/// </summary>
+	/// <returns>物理スロット（未割り当てならkInvalidSlot）</returns>
+	uint32_t GetSlot(uint32_t pageId) const;
+
+	/// <summary>
+	/// 常駐している最も細かい祖先ページ（自身を含む）を探す
+	/// </summary>
+	/// <param name="pageId">要求ページID</param>
+	/// <param name="residentPageId">見つかったページID</param>
+	/// <param name="slot">見つかったページの物理スロット</param>
+	/// <returns>見つかればtrue</returns>
+	bool Resolve(uint32_t pageId, uint32_t& residentPageId, uint32_t& slot) const;
+
+	/// <summary>
+	/// GPU用の間接参照テーブルを作る
+	/// （各テクセル: 物理スロットX | 物理スロットY &lt;&lt; 8 | 常駐ミップ &lt;&lt; 16 | 有効 &lt;&lt; 24）
+	/// </summary>
+	/// <param name="mip">ミップレベル</param>
+	/// <param name="slotsPerRow">物理テクスチャの横スロット数</param>
+	/// <param name="texels">格納先</param>
+	void BuildIndirection(uint32_t mip, uint32_t slotsPerRow, std::vector<uint32_t>& texels) const;
+
+	/// <summary>
+	/// 割り当てが変わったか
+	/// </summary>
+	bool IsDirty() const { return isDirty_; }
+
+	/// <summary>
+	/// 変更フラグを下ろす
+	/// </summary>
+	void ClearDirty() { isDirty_ = false; }
+
+  private:
+	// ミップレベルごとの割り当て
+	struct Level {
+		uint32_t pagesX = 0;
+		uint32_t pagesY = 0;
+		std::vector<uint32_t> slots;
+	};
+
+	/// <summary>
+	/// ページIDに対応する要素
+	/// </summary>
+	uint32_t& At(uint32_t pageId);
+	const uint32_t& At(uint32_t pageId) const;
+
+	// ミップレベルごとの割り当て
+	std::vector<Level> levels_;
+	// 変更フラグ
+	bool isDirty_ = false;
+};
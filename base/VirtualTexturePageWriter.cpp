@@ -0,0 +1,231 @@
+﻿#include "VirtualTexturePageWriter.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// 線形からsRGBへの変換表の分解能
+const uint32_t kEncodeTableSize = 16384;
+
+// sRGBの8bit値 → 線形
+const float* DecodeTable() {
+	static float table[256];
+	static bool initialized = false;
+	if (!initialized) {
+		for (uint32_t i = 0; i < 256; i++) {
+			float c = i / 255.0f;
+			table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+		initialized = true;
+	}
+	return table;
+}
+
+// 線形 → sRGBの8bit値
+const uint8_t* EncodeTable() {
+	static uint8_t table[kEncodeTableSize];
+	static bool initialized = false;
+	if (!initialized) {
+		for (uint32_t i = 0; i < kEncodeTableSize; i++) {
+			float l = static_cast<float>(i) / (kEncodeTableSize - 1);
+			float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+			table[i] = static_cast<uint8_t>(c * 255.0f + 0.5f);
+		}
+		initialized = true;
+	}
+	return table;
+}
+
+// 画像端でのクランプ
+uint32_t ClampIndex(int32_t index, uint32_t size) {
+	return static_cast<uint32_t>((std::min)((std::max)(index, 0), static_cast<int32_t>(size) - 1));
+}
+} // namespace
+
+void VirtualTexturePageWriter::Initialize(
+  uint32_t width, uint32_t height, uint32_t pageSize, uint32_t border, uint32_t mipCount,
+  PageRowFunc pageRowFunc) {
+	assert(0 < pageSize && width % pageSize == 0 && height % pageSize == 0);
+	assert(0 < mipCount);
+
+	// 変換表は複数スレッドから引くので先に作っておく
+	DecodeTable();
+	EncodeTable();
+
+	pageSize_ = pageSize;
+	border_ = border;
+	const uint32_t slotSize = pageSize + border * 2;
+	pageBytes_ = static_cast<size_t>(slotSize) * slotSize * kBytesPerPixel;
+	pageRowFunc_ = std::move(pageRowFunc);
+	rowBytes_ = 0;
+	peakRowBytes_ = 0;
+
+	levels_.assign(mipCount, Level());
+	for (uint32_t mip = 0; mip < mipCount; mip++) {
+		Level& level = levels_[mip];
+		level.width = (std::max)(1u, width >> mip);
+		level.height = (std::max)(1u, height >> mip);
+		level.pagesX = (std::max)(1u, (width / pageSize) >> mip);
+		level.pagesY = (std::max)(1u, (height / pageSize) >> mip);
+	}
+	for (uint32_t mip = 0; mip + 1 < mipCount; mip++) {
+		Level& level = levels_[mip];
+		level.columnTaps.resize(levels_[mip + 1].width);
+		for (uint32_t x = 0; x < levels_[mip + 1].width; x++) {
+			level.columnTaps[x] = MakeTaps(level.width, x);
+		}
+	}
+}
+
+void VirtualTexturePageWriter::AddRows(const uint8_t* pixels, size_t rowPitch, uint32_t rowCount) {
+	const size_t rowSize = static_cast<size_t>(levels_[0].width) * kBytesPerPixel;
+	for (uint32_t i = 0; i < rowCount; i++) {
+		const uint8_t* src = pixels + rowPitch * i;
+		AddRow(0, std::vector<uint8_t>(src, src + rowSize));
+	}
+}
+
+bool VirtualTexturePageWriter::IsComplete() const {
+	for (const Level& level : levels_) {
+		if (level.nextPageY < level.pagesY) {
+			return false;
+		}
+	}
+	return !levels_.empty();
+}
+
+VirtualTexturePageWriter::Taps
+  VirtualTexturePageWriter::MakeTaps(uint32_t srcSize, uint32_t dstIndex) {
+	Taps taps{};
+	if (srcSize == 1) {
+		taps.index[0] = 0;
+		taps.weight[0] = 1.0f;
+		taps.count = 1;
+	} else if (srcSize % 2 == 0) {
+		taps.index[0] = dstIndex * 2;
+		taps.index[1] = dstIndex * 2 + 1;
+		taps.weight[0] = 0.5f;
+		taps.weight[1] = 0.5f;
+		taps.count = 2;
+	} else {
+		// 2n+1画素をn画素にする時は、各画素が元の(2n+1)/n画素分を覆う
+		const float n = static_cast<float>(srcSize / 2);
+		const float size = static_cast<float>(srcSize);
+		for (uint32_t i = 0; i < 3; i++) {
+			taps.index[i] = dstIndex * 2 + i;
+		}
+		taps.weight[0] = (n - dstIndex) / size;
+		taps.weight[1] = n / size;
+		taps.weight[2] = (dstIndex + 1) / size;
+		taps.count = 3;
+	}
+	return taps;
+}
+
+void VirtualTexturePageWriter::AddRow(uint32_t mip, std::vector<uint8_t> row) {
+	Level& level = levels_[mip];
+	assert(level.rowCount < level.height);
+	rowBytes_ += row.size();
+	peakRowBytes_ = (std::max)(peakRowBytes_, rowBytes_);
+	level.rows.push_back(std::move(row));
+	level.rowCount++;
+
+	// ボーダーまで揃ったページ行を書き出す
+	while (level.nextPageY < level.pagesY) {
+		int32_t lastY = static_cast<int32_t>((level.nextPageY + 1) * pageSize_ + border_) - 1;
+		if (level.rowCount <= ClampIndex(lastY, level.height)) {
+			break;
+		}
+		WritePageRow(mip, level.nextPageY);
+		level.nextPageY++;
+	}
+
+	// タップが揃った縮小行を一つ下のミップに渡す
+	const bool hasLower = mip + 1 < levels_.size();
+	while (hasLower && level.nextDownRow < levels_[mip + 1].height) {
+		Taps taps = MakeTaps(level.height, level.nextDownRow);
+		if (level.rowCount <= taps.index[taps.count - 1]) {
+			break;
+		}
+		std::vector<uint8_t> lowerRow;
+		Downsample(mip, level.nextDownRow, lowerRow);
+		level.nextDownRow++;
+		AddRow(mip + 1, std::move(lowerRow));
+	}
+
+	// どちらにももう使わない行を捨てる
+	uint32_t keepFrom = level.rowCount;
+	if (level.nextPageY < level.pagesY) {
+		int32_t firstY = static_cast<int32_t>(level.nextPageY * pageSize_ - border_);
+		keepFrom = (std::min)(keepFrom, ClampIndex(firstY, level.height));
+	}
+	if (hasLower && level.nextDownRow < levels_[mip + 1].height) {
+		keepFrom = (std::min)(keepFrom, MakeTaps(level.height, level.nextDownRow).index[0]);
+	}
+	while (level.firstRow < keepFrom) {
+		rowBytes_ -= level.rows.front().size();
+		level.rows.pop_front();
+		level.firstRow++;
+	}
+}
+
+void VirtualTexturePageWriter::WritePageRow(uint32_t mip, uint32_t pageY) {
+	const Level& level = levels_[mip];
+	const uint32_t slotSize = pageSize_ + border_ * 2;
+	pageRow_.resize(pageBytes_ * level.pagesX);
+
+	ThreadPool::GetInstance()->ParallelFor(level.pagesX, 1, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t pageX = begin; pageX < end; pageX++) {
+			uint8_t* dst = &pageRow_[pageBytes_ * pageX];
+			for (uint32_t y = 0; y < slotSize; y++) {
+				int32_t srcY = static_cast<int32_t>(pageY * pageSize_ + y - border_);
+				const uint8_t* srcRow = GetRow(level, ClampIndex(srcY, level.height));
+				for (uint32_t x = 0; x < slotSize; x++) {
+					int32_t srcX = static_cast<int32_t>(pageX * pageSize_ + x - border_);
+					srcX = static_cast<int32_t>(ClampIndex(srcX, level.width));
+					memcpy(dst, srcRow + srcX * kBytesPerPixel, kBytesPerPixel);
+					dst += kBytesPerPixel;
+				}
+			}
+		}
+	});
+
+	pageRowFunc_(mip, pageY, pageRow_.data(), pageRow_.size());
+}
+
+void VirtualTexturePageWriter::Downsample(
+  uint32_t mip, uint32_t dstY, std::vector<uint8_t>& row) const {
+	const Level& level = levels_[mip];
+	const uint32_t dstWidth = levels_[mip + 1].width;
+	const Taps rowTaps = MakeTaps(level.height, dstY);
+	const float* decode = DecodeTable();
+	const uint8_t* encode = EncodeTable();
+	row.resize(static_cast<size_t>(dstWidth) * kBytesPerPixel);
+
+	// RGBは線形に戻して平均し、アルファはそのまま平均する
+	ThreadPool::GetInstance()->ParallelFor(dstWidth, 256, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t x = begin; x < end; x++) {
+			const Taps& columnTaps = level.columnTaps[x];
+			float sum[4] = {};
+			for (uint32_t ty = 0; ty < rowTaps.count; ty++) {
+				const uint8_t* srcRow = GetRow(level, rowTaps.index[ty]);
+				for (uint32_t tx = 0; tx < columnTaps.count; tx++) {
+					const uint8_t* src = srcRow + columnTaps.index[tx] * kBytesPerPixel;
+					float weight = rowTaps.weight[ty] * columnTaps.weight[tx];
+					sum[0] += decode[src[0]] * weight;
+					sum[1] += decode[src[1]] * weight;
+					sum[2] += decode[src[2]] * weight;
+					sum[3] += src[3] * weight;
+				}
+			}
+			uint8_t* dst = &row[x * kBytesPerPixel];
+			for (uint32_t c = 0; c < 3; c++) {
+				float l = (std::min)((std::max)(sum[c], 0.0f), 1.0f);
+				dst[c] = encode[static_cast<uint32_t>(l * (kEncodeTableSize - 1) + 0.5f)];
+			}
+			dst[3] = static_cast<uint8_t>((std::min)(sum[3] + 0.5f, 255.0f));
+		}
+	});
+}
@@ -0,0 +1,128 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/// <summary>
+/// 仮想テクスチャのページ切り出し
+/// （ミップ0を上から数行ずつ受け取り、各ミップを縮小しながらページ行単位で書き出す。
+/// 　保持するのはページ1行分とフィルタに要る行だけなので、元画像全体を読み込まずに済む）
+/// </summary>
+class VirtualTexturePageWriter {
+  public:
+	// 1画素のバイト数（R8G8B8A8。RGBはsRGBとして縮小する）
+	static const uint32_t kBytesPerPixel = 4;
+
+	// ページ1行分の書き出し先（ミップレベル, ページ番号Y, 横に並んだページ, バイト数）
+	using PageRowFunc =
+	  std::function<void(uint32_t mip, uint32_t pageY, const uint8_t* pages, size_t size)>;
+
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="width">ミップ0の幅（pageSizeの倍数）</param>
+	/// <param name="height">ミップ0の高さ（pageSizeの倍数）</param>
+	/// <param name="pageSize">ページの一辺（ボーダーを除く）</param>
+	/// <param name="border">ボーダー（画像端でクランプ）</param>
+	/// <param name="mipCount">ミップレベル数</param>
+	/// <param name="pageRowFunc">ページ1行分の書き出し先</param>
+	void Initialize(
+	  uint32_t width, uint32_t height, uint32_t pageSize, uint32_t border, uint32_t mipCount,
+	  PageRowFunc pageRowFunc);
+
+	/// <summary>
+	/// ミップ0の行を上から順に渡す
+	/// </summary>
+	/// <param name="pixels">先頭行</param>
+	/// <param name="rowPitch">1行のバイト数</param>
+	/// <param name="rowCount">行数</param>
+	void AddRows(const uint8_t* pixels, size_t rowPitch, uint32_t rowCount);
+
+	/// <summary>
+	/// 全ミップの全ページを書き出したか
+	/// </summary>
+	bool IsComplete() const;
+
+	/// <summary>
+	/// ページ1枚のバイト数
+	/// </summary>
+	size_t GetPageBytes() const { return pageBytes_; }
+
+	/// <summary>
+	/// 保持した行の合計バイト数の最大値
+	/// </summary>
+	size_t GetPeakRowBytes() const { return peakRowBytes_; }
+
+  private:
+	// 縮小に使う元の画素（最大3タップ）
+	struct Taps {
+		uint32_t index[3];
+		float weight[3];
+		uint32_t count;
+	};
+
+	// ミップレベルごとの状態
+	struct Level {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t pagesX = 0;
+		uint32_t pagesY = 0;
+		// 保持している行（先頭がfirstRow行目）
+		std::deque<std::vector<uint8_t>> rows;
+		uint32_t firstRow = 0;
+		// 受け取った行数
+		uint32_t rowCount = 0;
+		// 次に書き出すページ行
+		uint32_t nextPageY = 0;
+		// 次に作る一つ下のミップの行
+		uint32_t nextDownRow = 0;
+		// 一つ下のミップの列ごとのタップ
+		std::vector<Taps> columnTaps;
+	};
+
+	/// <summary>
+	/// 縮小のタップ（偶数は2画素の平均、奇数は3画素を面積で重み付け）
+	/// </summary>
+	static Taps MakeTaps(uint32_t srcSize, uint32_t dstIndex);
+
+	/// <summary>
+	/// 行を受け取り、書き出せるページ行と作れる縮小行を処理する
+	/// </summary>
+	void AddRow(uint32_t mip, std::vector<uint8_t> row);
+
+	/// <summary>
+	/// ページ1行分を切り出して書き出す
+	/// </summary>
+	void WritePageRow(uint32_t mip, uint32_t pageY);
+
+	/// <summary>
+	/// 一つ下のミップの1行を作る
+	/// </summary>
+	void Downsample(uint32_t mip, uint32_t dstY, std::vector<uint8_t>& row) const;
+
+	/// <summary>
+	/// 保持している行の取得
+	/// </summary>
+	const uint8_t* GetRow(const Level& level, uint32_t y) const {
+		return level.rows[y - level.firstRow].data();
+	}
+
+	// ページの一辺
+	uint32_t pageSize_ = 0;
+	// ボーダー
+	uint32_t border_ = 0;
+	// ページ1枚のバイト数
+	size_t pageBytes_ = 0;
+	// ミップレベルごとの状態
+	std::vector<Level> levels_;
+	// ページ1行分の作業領域
+	std::vector<uint8_t> pageRow_;
+	// 書き出し先
+	PageRowFunc pageRowFunc_;
+	// 保持している行の合計バイト数とその最大値
+	size_t rowBytes_ = 0;
+	size_t peakRowBytes_ = 0;
+};
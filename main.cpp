@@ -1,10 +1,19 @@
-﻿#include "Audio.h"
+﻿#include "AssetHotReloader.h"
+#include "Audio.h"
+#include "CommandContextPool.h"
 #include "DirectXCommon.h"
+#include "FrameUploadAllocator.h"
 #include "GameScene.h"
+#include "PipelineCache.h"
+#include "ShaderLibrary.h"
 #include "TextureManager.h"
+#include "ThreadPool.h"
 #include "WinApp.h"
 #include "AxisIndicator.h"
+#include "CascadedShadowMap.h"
+#include "ClusteredLighting.h"
 #include "PrimitiveDrawer.h"
+#include "SpriteBatch.h"
 
 // Windowsアプリでのエントリーポイント(main関数)
 int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
@@ -35,6 +44,23 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	audio = Audio::GetInstance();
 	audio->Initialize();
 
+	// スレッドプールの初期化
+	ThreadPool::GetInstance()->Initialize();
+
+	// 一時アップロードアロケータの初期化
+	FrameUploadAllocator::GetInstance()->Initialize(
+	  dxCommon->GetDevice(), dxCommon->GetFrameCount());
+
+	// 並列記録用のコマンドリストの初期化
+	CommandContextPool::GetInstance()->Initialize(
+	  dxCommon->GetDevice(), dxCommon->GetFrameCount());
+
+	// パイプラインキャッシュの初期化（前回保存したものを読み込む）
+	PipelineCache::GetInstance()->Initialize(dxCommon->GetDevice());
+
+	// シェーダライブラリの初期化（オフラインでコンパイルしたアーカイブを割り当てる）
+	ShaderLibrary::GetInstance()->Initialize();
+
 	// テクスチャマネージャの初期化
 	TextureManager::GetInstance()->Initialize(dxCommon->GetDevice());
 	TextureManager::Load("white1x1.png");
@@ -42,6 +68,10 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	// スプライト静的初期化
 	Sprite::StaticInitialize(dxCommon->GetDevice(), WinApp::kWindowWidth, WinApp::kWindowHeight);
 
+	// スプライト一括描画初期化
+	SpriteBatch::GetInstance()->Initialize(
+	  dxCommon->GetDevice(), WinApp::kWindowWidth, WinApp::kWindowHeight);
+
 	// デバッグテキスト初期化
 	debugText = DebugText::GetInstance();
 	debugText->Initialize();
@@ -49,12 +79,22 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	// 3Dモデル静的初期化
 	Model::StaticInitialize();
 
+	// クラスタードライティング初期化
+	ClusteredLighting::GetInstance()->Initialize(
+	  dxCommon->GetDevice(), WinApp::kWindowWidth, WinApp::kWindowHeight);
+
+	// カスケードシャドウマップ初期化
+	CascadedShadowMap::GetInstance()->Initialize(dxCommon->GetDevice());
+
 	// 軸方向表示初期化
 	axisIndicator = AxisIndicator::GetInstance();
 	axisIndicator->Initialize();
 
 	primitiveDrawer = PrimitiveDrawer::GetInstance();
 	primitiveDrawer->Initialize();
+
+	// アセットのホットリロード初期化
+	AssetHotReloader::GetInstance()->Initialize();
 #pragma endregion
 
 	// ゲームシーンの初期化
@@ -68,28 +108,49 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 			break;
 		}
 
+		// 一時アップロード領域の切り替え
+		FrameUploadAllocator::GetInstance()->BeginFrame(dxCommon->GetCompletedFenceValue());
 		// 入力関連の毎フレーム処理
 		input->Update();
+		// 変更されたアセットの差し替え
+		AssetHotReloader::GetInstance()->Update();
+		// テクスチャ常駐管理の毎フレーム処理
+		TextureManager::GetInstance()->Update();
 		// ゲームシーンの毎フレーム処理
 		gameScene->Update();
 		// 軸表示の更新
 		axisIndicator->Update();
 
+		// シャドウマップの描画（バックバッファを設定する前に行う）
+		CascadedShadowMap::GetInstance()->Draw(dxCommon->GetCommandList());
 		// 描画開始
 		dxCommon->PreDraw();
 		// ゲームシーンの描画
 		gameScene->Draw();
 		// 軸表示の描画
 		axisIndicator->Draw();
+		// 溜まったプリミティブの描画
+		primitiveDrawer->Flush(dxCommon->GetCommandList());
 		// プリミティブ描画のリセット
 		primitiveDrawer->Reset();
 		// 描画終了
 		dxCommon->PostDraw();
+		// 一時アップロード領域の使用終了
+		FrameUploadAllocator::GetInstance()->EndFrame(dxCommon->GetFenceValue());
 	}
 
+	// GPUが参照中のリソースを解放しないように全フレームの完了を待つ
+	dxCommon->WaitForGpu();
+
+	// 新しく作ったパイプラインを次回の起動のために保存
+	PipelineCache::GetInstance()->Save();
+
 	// 各種解放
+	AssetHotReloader::GetInstance()->Finalize();
 	SafeDelete(gameScene);
 	audio->Finalize();
+	ThreadPool::GetInstance()->Finalize();
+	ShaderLibrary::GetInstance()->Finalize();
 
 	// ゲームウィンドウの破棄
 	win->TerminateGameWindow();
@@ -3,6 +3,7 @@
 #include <cassert>
 #include "AxisIndicator.h"
 #include "PrimitiveDrawer.h"
+#include "SpriteBatch.h"
 
 GameScene::GameScene() {}
 
@@ -97,6 +98,16 @@ void GameScene::Draw() {
 	/// ここに前景スプライトの描画処理を追加できる
 	/// </summary>
 
+	// スプライト一括描画（Endの後はスプライトの描画設定が残らないので、
+	// Sprite::Drawはここより前に書く）
+	SpriteBatch::GetInstance()->Begin(commandList);
+
+	/// <summary>
+	/// ここにまとめて描画するスプライトを追加できる
+	/// </summary>
+
+	SpriteBatch::GetInstance()->End();
+
 	// デバッグテキストの描画
 	debugText_->DrawAll(commandList);
 	//
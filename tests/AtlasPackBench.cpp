@@ -0,0 +1,104 @@
+﻿#include "AtlasLayout.h"
+#include "Bench.h"
+#include "Check.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// TextureAtlas::Buildが使う配置（AtlasLayout）の計測と検証
+// 使い方: AtlasPackBench [--quick]
+
+namespace {
+// TextureAtlasと同じ余白
+const uint32_t kPadding = 2;
+
+using Size = AtlasLayout::Size;
+using Placement = AtlasLayout::Placement;
+
+// スプライトらしい大きさの矩形を作る（小さいアイコンが多く、大きい絵が少し混ざる）
+std::vector<Size> MakeSizes(uint32_t count, uint32_t seed) {
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<uint32_t> kind(0, 9);
+	std::uniform_int_distribution<uint32_t> small(8, 64);
+	std::uniform_int_distribution<uint32_t> large(64, 256);
+	std::vector<Size> sizes(count);
+	for (Size& size : sizes) {
+		bool isLarge = kind(random) == 0;
+		size.width = isLarge ? large(random) : small(random);
+		size.height = isLarge ? large(random) : small(random);
+	}
+	return sizes;
+}
+
+// 全矩形がページ内に収まり、互いに重ならないか
+bool Validate(const std::vector<Size>& sizes, uint32_t pageSize, const AtlasLayout& layout) {
+	const std::vector<Placement>& placements = layout.GetPlacements();
+	if (placements.size() != sizes.size()) {
+		return false;
+	}
+	std::vector<std::vector<uint8_t>> used(
+	  layout.GetPageCount(), std::vector<uint8_t>(pageSize * pageSize));
+	for (size_t i = 0; i < sizes.size(); i++) {
+		const Placement& placement = placements[i];
+		uint32_t width = sizes[i].width + kPadding * 2;
+		uint32_t height = sizes[i].height + kPadding * 2;
+		if (layout.GetPageCount() <= placement.page || pageSize < placement.x + width ||
+		    pageSize < placement.y + height) {
+			return false;
+		}
+		std::vector<uint8_t>& page = used[placement.page];
+		for (uint32_t y = placement.y; y < placement.y + height; y++) {
+			for (uint32_t x = placement.x; x < placement.x + width; x++) {
+				if (page[y * pageSize + x]) {
+					return false;
+				}
+				page[y * pageSize + x] = 1;
+			}
+		}
+	}
+	return true;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	bool quick = IsQuickBench(argc, argv);
+	const uint32_t counts[] = {256, 2048, 16384};
+	const uint32_t pageSize = quick ? 1024 : 2048;
+	const uint32_t countNum = quick ? 1 : 3;
+	const uint32_t repeat = quick ? 1 : 10;
+
+	printf("page %u, padding %u\n", pageSize, kPadding);
+	for (uint32_t c = 0; c < countNum; c++) {
+		std::vector<Size> sizes = MakeSizes(counts[c], 1234 + c);
+		AtlasLayout layout;
+		bool placed = false;
+		double milliseconds = MeasureMilliseconds(
+		  repeat, [&]() { placed = layout.Build(sizes, pageSize, kPadding); });
+		CHECK(placed);
+		CHECK(Validate(sizes, pageSize, layout));
+
+		float occupancy = 0.0f;
+		for (uint32_t i = 0; i < layout.GetPageCount(); i++) {
+			occupancy += layout.GetPageOccupancy(i);
+		}
+		occupancy /= static_cast<float>(layout.GetPageCount());
+		printf(
+		  "%6u rects: %8.3f ms (%8.1f rects/ms), %3u pages, occupancy %.3f\n", counts[c],
+		  milliseconds, counts[c] / milliseconds, layout.GetPageCount(), occupancy);
+
+		// 最後のページ以外は十分に埋まっていること
+		for (uint32_t i = 0; i + 1 < layout.GetPageCount(); i++) {
+			CHECK(0.75f < layout.GetPageOccupancy(i));
+		}
+	}
+
+	// ページより大きいものは配置せず、他は配置する
+	AtlasLayout layout;
+	std::vector<Size> sizes = {{16, 16}, {pageSize, 8}, {32, 8}};
+	CHECK(!layout.Build(sizes, pageSize, kPadding));
+	CHECK(layout.GetPlacements()[1].page == AtlasLayout::kInvalidPage);
+	CHECK(layout.GetPlacements()[0].page == 0 && layout.GetPlacements()[2].page == 0);
+	CHECK(layout.GetPageCount() == 1);
+
+	return CheckResult();
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+// GPUを使わないベンチマークの計測
+
+/// <summary>
+/// 短い設定で動かすか（ctestからは--quickで呼んで、壊れていないことだけを確かめる）
+/// </summary>
+inline bool IsQuickBench(int argc, char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--quick") == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/// <summary>
+/// 処理時間の計測（繰り返して最短の時間を返す）
+/// </summary>
+/// <param name="repeat">繰り返し回数</param>
+/// <param name="func">処理</param>
+/// <returns>1回あたりの時間（ミリ秒）</returns>
+template<class Func> double MeasureMilliseconds(uint32_t repeat, Func func) {
+	double best = 0.0;
+	for (uint32_t i = 0; i < repeat; i++) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		func();
+		double elapsed = std::chrono::duration<double, std::milli>(
+		                   std::chrono::steady_clock::now() - start)
+		                   .count();
+		if (i == 0 || elapsed < best) {
+			best = elapsed;
+		}
+	}
+	return best;
+}
@@ -0,0 +1,164 @@
+﻿#include "BindlessMaterialTable.h"
+#include "Check.h"
+#include <random>
+#include <vector>
+
+// BindlessMaterialTableの番号の割り当ての検証
+// （登録・書き換え・外すを乱数で繰り返し、キーと番号の対応が単純なモデルと一致すること、
+// 　範囲外のテクスチャ番号を持つマテリアルが表に入らないことを確かめる）
+
+namespace {
+// テクスチャ番号の上限
+const uint32_t kTextureCapacity = 16;
+
+// テクスチャ番号と係数から内容を作る
+BindlessMaterialTable::Material MakeMaterial(uint32_t textureIndex, float value) {
+	BindlessMaterialTable::Material material{};
+	material.ambient = Vector3(value, value, value);
+	material.textureIndex = textureIndex;
+	material.diffuse = Vector3(value, 0.0f, 0.0f);
+	material.specular = Vector3(0.0f, value, 0.0f);
+	material.alpha = value;
+	return material;
+}
+
+// 登録と検索
+void TestRegister() {
+	BindlessMaterialTable table;
+	table.Initialize(kTextureCapacity);
+	int keys[3];
+
+	CHECK(table.Register(&keys[0], MakeMaterial(0, 1.0f)) == 0);
+	CHECK(table.Register(&keys[1], MakeMaterial(15, 2.0f)) == 1);
+	CHECK(table.GetCount() == 2);
+	CHECK(table.GetKey(1) == &keys[1]);
+
+	// 登録済みのキーは同じ番号のまま内容を書き換える
+	CHECK(table.Register(&keys[0], MakeMaterial(3, 5.0f)) == 0);
+	CHECK(table.GetCount() == 2);
+	CHECK(table.GetMaterials()[0].textureIndex == 3);
+	CHECK(table.GetMaterials()[0].alpha == 5.0f);
+
+	// 範囲外のテクスチャ番号は登録も書き換えもしない
+	CHECK(table.Register(&keys[2], MakeMaterial(kTextureCapacity, 1.0f)) ==
+	      BindlessMaterialTable::kInvalidIndex);
+	CHECK(table.Register(&keys[1], MakeMaterial(BINDLESS_NO_TEXTURE, 1.0f)) ==
+	      BindlessMaterialTable::kInvalidIndex);
+	CHECK(!table.Update(1, MakeMaterial(kTextureCapacity, 1.0f)));
+	CHECK(table.GetCount() == 2);
+	CHECK(table.GetMaterials()[1].textureIndex == 15);
+	uint32_t index = 0;
+	CHECK(!table.Find(&keys[2], index));
+	CHECK(table.Find(&keys[1], index) && index == 1);
+
+	// 描画ごとの定数
+	ObjLayout::BindlessDraw constants = table.MakeDrawConstants(1);
+	CHECK(constants.materialIndex == 1);
+	CHECK(constants.textureOverride == BINDLESS_NO_TEXTURE);
+	CHECK(table.MakeDrawConstants(0, 7).textureOverride == 7);
+
+	// 初期化し直すと空になる
+	table.Initialize(kTextureCapacity);
+	CHECK(table.GetCount() == 0);
+	CHECK(!table.Find(&keys[0], index));
+}
+
+// 外した番号の使い回し
+void TestRemove() {
+	BindlessMaterialTable table;
+	table.Initialize(kTextureCapacity);
+	int keys[4];
+	for (uint32_t i = 0; i < 3; i++) {
+		table.Register(&keys[i], MakeMaterial(i, 1.0f));
+	}
+
+	// 外しても他の番号は変わらない
+	CHECK(table.Remove(&keys[1]) == 1);
+	CHECK(table.Remove(&keys[1]) == BindlessMaterialTable::kInvalidIndex);
+	CHECK(table.GetCount() == 3);
+	CHECK(table.GetKey(1) == nullptr);
+	uint32_t index = 0;
+	CHECK(!table.Find(&keys[1], index));
+	CHECK(table.Find(&keys[2], index) && index == 2);
+
+	// 次の登録は空きの番号を使う
+	CHECK(table.Register(&keys[3], MakeMaterial(9, 1.0f)) == 1);
+	CHECK(table.GetCount() == 3);
+	CHECK(table.GetKey(1) == &keys[3]);
+	CHECK(table.GetMaterials()[1].textureIndex == 9);
+
+	// 範囲外で登録できなかったときは空きを消費しない
+	table.Remove(&keys[0]);
+	CHECK(table.Register(&keys[1], MakeMaterial(kTextureCapacity, 1.0f)) ==
+	      BindlessMaterialTable::kInvalidIndex);
+	CHECK(table.Register(&keys[1], MakeMaterial(4, 1.0f)) == 0);
+
+	// Clearで空きも消える
+	table.Clear();
+	CHECK(table.Register(&keys[0], MakeMaterial(0, 1.0f)) == 0);
+	CHECK(table.GetCount() == 1);
+}
+
+// 乱数で操作してモデル（キーごとの番号と内容）と突き合わせる
+void TestRandom() {
+	const uint32_t kKeyCount = 32;
+	int keys[kKeyCount];
+	BindlessMaterialTable table;
+	table.Initialize(kTextureCapacity);
+
+	// キーごとの番号（未登録はkInvalidIndex）と内容のテクスチャ番号
+	std::vector<uint32_t> indices(kKeyCount, BindlessMaterialTable::kInvalidIndex);
+	std::vector<uint32_t> textures(kKeyCount, 0);
+	std::mt19937 random(1234);
+	for (int step = 0; step < 5000; step++) {
+		uint32_t key = random() % kKeyCount;
+		if (random() % 3 == 0) {
+			CHECK(table.Remove(&keys[key]) == indices[key]);
+			indices[key] = BindlessMaterialTable::kInvalidIndex;
+		} else {
+			// 範囲外のテクスチャ番号も混ぜる
+			uint32_t texture = random() % (kTextureCapacity + 2);
+			uint32_t index = table.Register(&keys[key], MakeMaterial(texture, 1.0f));
+			if (texture < kTextureCapacity) {
+				CHECK(index != BindlessMaterialTable::kInvalidIndex);
+				// 登録済みなら番号は変わらない
+				CHECK(
+				  indices[key] == BindlessMaterialTable::kInvalidIndex || indices[key] == index);
+				indices[key] = index;
+				textures[key] = texture;
+			} else {
+				CHECK(index == BindlessMaterialTable::kInvalidIndex);
+			}
+		}
+
+		// 番号は重ならず、キーと内容が合っている
+		std::vector<bool> used(table.GetCount(), false);
+		for (uint32_t i = 0; i < kKeyCount; i++) {
+			uint32_t index = BindlessMaterialTable::kInvalidIndex;
+			bool found = table.Find(&keys[i], index);
+			CHECK(found == (indices[i] != BindlessMaterialTable::kInvalidIndex));
+			if (!found) {
+				continue;
+			}
+			CHECK(index == indices[i]);
+			CHECK(index < table.GetCount());
+			CHECK(!used[index]);
+			used[index] = true;
+			CHECK(table.GetKey(index) == &keys[i]);
+			CHECK(table.GetMaterials()[index].textureIndex == textures[i]);
+		}
+		// 空きを使い回すので番号の数はキーの数を超えない
+		CHECK(table.GetCount() <= kKeyCount);
+		for (uint32_t i = 0; i < table.GetCount(); i++) {
+			CHECK(used[i] == (table.GetKey(i) != nullptr));
+		}
+	}
+}
+} // namespace
+
+int main() {
+	TestRegister();
+	TestRemove();
+	TestRandom();
+	return CheckResult();
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include <cstdio>
+
+// GPUを使わないテストの検査（assertと違いリリースビルドでも有効で、失敗しても続ける）
+
+/// <summary>
+/// 失敗した検査の数
+/// </summary>
+inline int& CheckFailureCount() {
+	static int count = 0;
+	return count;
+}
+
+/// <summary>
+/// 検査の失敗を記録する
+/// </summary>
+inline void CheckFailed(const char* file, int line, const char* expression) {
+	CheckFailureCount()++;
+	fprintf(stderr, "%s(%d): CHECK failed: %s\n", file, line, expression);
+}
+
+/// <summary>
+/// テストの結果（mainの戻り値にする）
+/// </summary>
+inline int CheckResult() {
+	if (CheckFailureCount() != 0) {
+		fprintf(stderr, "%d checks failed\n", CheckFailureCount());
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
+
+// 条件の検査
+#define CHECK(condition)                                                                           \
+	((condition) ? static_cast<void>(0) : CheckFailed(__FILE__, __LINE__, #condition))
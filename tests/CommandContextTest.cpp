@@ -0,0 +1,146 @@
+﻿#include "Check.h"
+#include "CommandContextSlots.h"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+// CommandContextPoolの貸し出し管理（CommandContextSlots）の検証
+// （DirectXCommonのフレームの進み方を通し番号で模し、アロケータが完了したフレームの分しか
+// 　使い回されないことと、並列記録の区間の分け方を確かめる）
+
+namespace {
+// DirectXCommonと同じ進み方のフレーム（フレーム番号を使い回す前に、前回そのフレーム番号で
+// 提出したフレームの完了を待つ）
+struct FrameClock {
+	uint32_t frameCount = 1;
+	uint64_t frameNumber = 1;
+	uint32_t frameIndex = 0;
+	uint64_t completedFrameNumber = 0;
+
+	void PostDraw() {
+		frameNumber++;
+		frameIndex = (frameIndex + 1) % frameCount;
+		// frameCountフレーム前に提出したものまでは完了している
+		if (frameCount < frameNumber) {
+			completedFrameNumber = frameNumber - frameCount;
+		}
+	}
+};
+
+// 1フレーム内の貸し出し
+void TestAcquireWithinFrame() {
+	CommandContextSlots slots;
+	slots.Initialize(2);
+
+	// 最初のフレームは借りるたびに新しいコンテキストを作る
+	for (uint32_t i = 0; i < 3; i++) {
+		CommandContextSlots::Lease lease = slots.Acquire(1, 0);
+		CHECK(lease.context == i);
+		CHECK(lease.allocator == 0);
+		CHECK(lease.isNewContext);
+	}
+	CHECK(slots.GetContextCount() == 3 && slots.GetUsedCount() == 3);
+
+	// 次のフレームでは先頭から使い直し、足りない分だけ作る
+	for (uint32_t i = 0; i < 4; i++) {
+		CommandContextSlots::Lease lease = slots.Acquire(2, 1);
+		CHECK(lease.context == i);
+		CHECK(lease.allocator == 1);
+		CHECK(lease.isNewContext == (i == 3));
+	}
+	CHECK(slots.GetContextCount() == 4 && slots.GetUsedCount() == 4);
+
+	// 借りなかったフレームを挟んでも、番号が変われば戻っている
+	CommandContextSlots::Lease lease = slots.Acquire(5, 0);
+	CHECK(lease.context == 0 && !lease.isNewContext);
+	CHECK(slots.GetUsedCount() == 1);
+
+	// 初期化し直すと作り直す
+	slots.Initialize(1);
+	CHECK(slots.GetContextCount() == 0);
+	CHECK(slots.Acquire(1, 0).isNewContext);
+}
+
+// フレームをまたいだ使い回し（アロケータは前回使ったフレームが完了してからしかリセットされない）
+void TestRecycling(uint32_t frameCount) {
+	std::mt19937 random(frameCount);
+	std::uniform_int_distribution<uint32_t> leaseCount(0, 6);
+
+	CommandContextSlots slots;
+	slots.Initialize(frameCount);
+	FrameClock clock;
+	clock.frameCount = frameCount;
+
+	// (コンテキスト, アロケータ) → 最後に使ったフレームの通し番号
+	std::map<std::pair<uint32_t, uint32_t>, uint64_t> lastUsed;
+	uint32_t maxLeases = 0;
+	for (uint32_t frame = 0; frame < 300; frame++) {
+		uint32_t count = leaseCount(random);
+		std::set<uint32_t> contexts;
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t contextCount = slots.GetContextCount();
+			CommandContextSlots::Lease lease = slots.Acquire(clock.frameNumber, clock.frameIndex);
+			// 同じフレームで同じコンテキストを二重に貸さない
+			CHECK(contexts.insert(lease.context).second);
+			CHECK(lease.allocator == clock.frameIndex);
+			CHECK(lease.isNewContext == (lease.context == contextCount));
+
+			// 前回このアロケータを使ったフレームはGPUで完了している
+			auto key = std::make_pair(lease.context, lease.allocator);
+			auto it = lastUsed.find(key);
+			if (it != lastUsed.end()) {
+				CHECK(it->second <= clock.completedFrameNumber);
+			}
+			lastUsed[key] = clock.frameNumber;
+		}
+		CHECK(slots.GetUsedCount() == count || count == 0);
+		maxLeases = (std::max)(maxLeases, count);
+		clock.PostDraw();
+	}
+
+	// コンテキストは1フレームで借りた最大数までしか作らない
+	CHECK(slots.GetContextCount() == maxLeases);
+}
+
+// 並列記録の区間の分け方
+void TestSplit() {
+	uint32_t chunkSize = 0;
+	CHECK(CommandContextSlots::Split(0, 8, 4, chunkSize) == 0);
+	CHECK(chunkSize == 0);
+	// 最小の要素数に満たなければ1区間
+	CHECK(CommandContextSlots::Split(5, 8, 4, chunkSize) == 1);
+	CHECK(chunkSize == 5);
+	// 並列数までに抑える
+	CHECK(CommandContextSlots::Split(1000, 8, 4, chunkSize) == 4);
+	CHECK(chunkSize == 250);
+	// 最小の要素数が0や並列数が0でも1として扱う
+	CHECK(CommandContextSlots::Split(3, 0, 0, chunkSize) == 1);
+	CHECK(chunkSize == 3);
+
+	// 区間は順に隙間なく全要素を覆い、空の区間を作らない
+	for (uint32_t count = 1; count <= 200; count++) {
+		for (uint32_t grainSize = 1; grainSize <= 20; grainSize += 3) {
+			for (uint32_t concurrency = 1; concurrency <= 16; concurrency++) {
+				uint32_t chunkCount =
+				  CommandContextSlots::Split(count, grainSize, concurrency, chunkSize);
+				CHECK(1 <= chunkCount && chunkCount <= concurrency);
+				CHECK(chunkSize >= (std::min)(grainSize, count));
+				CHECK((chunkCount - 1) * chunkSize < count);
+				CHECK(count <= chunkCount * chunkSize);
+			}
+		}
+	}
+}
+} // namespace
+
+int main() {
+	TestAcquireWithinFrame();
+	for (uint32_t frameCount = 1; frameCount <= 3; frameCount++) {
+		TestRecycling(frameCount);
+	}
+	TestSplit();
+	return CheckResult();
+}
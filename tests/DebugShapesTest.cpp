@@ -0,0 +1,219 @@
+﻿#include "Check.h"
+#include "DebugShapes.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// DebugShapesの線分生成の検証
+// （返す線分数が*LineCountと一致し書き出し先をはみ出さないこと、箱と視錐台の頂点、
+// 　球とカプセルの点が半径の位置にあること。円の分割数は範囲外でも丸めて描く）
+
+namespace {
+const float kPi = 3.14159265358979f;
+const float kEpsilon = 1e-4f;
+
+Vector3 Sub(const Vector3& a, const Vector3& b) { return Vector3(a.x - b.x, a.y - b.y, a.z - b.z); }
+float Dot(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+float Length(const Vector3& v) { return std::sqrt(Dot(v, v)); }
+bool Near(const Vector3& a, const Vector3& b) { return Length(Sub(a, b)) < kEpsilon; }
+
+// 線分abから点pまでの距離
+float SegmentDistance(const Vector3& a, const Vector3& b, const Vector3& p) {
+	Vector3 ab = Sub(b, a);
+	float t = Dot(Sub(p, a), ab) / Dot(ab, ab);
+	t = t < 0.0f ? 0.0f : (1.0f < t ? 1.0f : t);
+	return Length(Sub(p, Vector3(a.x + ab.x * t, a.y + ab.y * t, a.z + ab.z * t)));
+}
+
+// 書き出し先の後ろに番兵を置いて書き出し、線分数と番兵が残っていることを確かめる
+template<typename Func>
+std::vector<Vector3> Generate(uint32_t expectedLineCount, Func generate) {
+	const Vector3 sentinel(-12345.0f, -12345.0f, -12345.0f);
+	std::vector<Vector3> points(expectedLineCount * 2 + 4, sentinel);
+	CHECK(generate(points.data()) == expectedLineCount);
+	for (size_t i = expectedLineCount * 2; i < points.size(); i++) {
+		CHECK(Near(points[i], sentinel));
+	}
+	points.resize(expectedLineCount * 2);
+	return points;
+}
+
+// 端点がすべてcornersのどれかで、cornersがすべて使われていること
+void CheckCorners(const std::vector<Vector3>& points, const Vector3 corners[8]) {
+	bool used[8] = {};
+	for (const Vector3& point : points) {
+		bool found = false;
+		for (uint32_t i = 0; i < 8; i++) {
+			if (Near(point, corners[i])) {
+				used[i] = true;
+				found = true;
+			}
+		}
+		CHECK(found);
+	}
+	for (bool u : used) {
+		CHECK(u);
+	}
+}
+
+// 分割数の範囲外も含めた線分数
+void TestLineCounts() {
+	const Vector3 center(1.0f, 2.0f, 3.0f);
+	const uint32_t segmentCounts[] = {0, 1, 3, 4, 7, 32, 255, 256, 257, 1000};
+	for (uint32_t segments : segmentCounts) {
+		uint32_t clamped = DebugShapes::ClampSegments(segments);
+		CHECK(DebugShapes::kMinSegments <= clamped && clamped <= DebugShapes::kMaxSegments);
+		CHECK(
+		  segments < DebugShapes::kMinSegments || DebugShapes::kMaxSegments < segments ||
+		  clamped == segments);
+
+		Generate(DebugShapes::SphereLineCount(segments), [&](Vector3* out) {
+			return DebugShapes::Sphere(center, 2.0f, segments, out);
+		});
+		Generate(DebugShapes::CapsuleLineCount(segments), [&](Vector3* out) {
+			return DebugShapes::Capsule(center, Vector3(4.0f, 5.0f, 6.0f), 0.5f, segments, out);
+		});
+		Generate(DebugShapes::ConeLineCount(segments), [&](Vector3* out) {
+			return DebugShapes::Cone(
+			  center, Vector3(0.0f, -1.0f, 0.0f), 3.0f, 0.4f, segments, out);
+		});
+	}
+	CHECK(DebugShapes::SphereLineCount(DebugShapes::kMaxSegments + 1) ==
+	      DebugShapes::SphereLineCount(DebugShapes::kMaxSegments));
+
+	const uint32_t divisionCounts[] = {1, 2, 10};
+	for (uint32_t divisions : divisionCounts) {
+		Generate(DebugShapes::GridLineCount(divisions), [&](Vector3* out) {
+			return DebugShapes::Grid(center, 8.0f, divisions, out);
+		});
+	}
+	const Vector3 axes[3] = {
+	  Vector3(1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)};
+	Generate(DebugShapes::kAxisLineCount, [&](Vector3* out) {
+		return DebugShapes::Axis(center, axes, 1.0f, out);
+	});
+	Generate(DebugShapes::kArrowLineCount, [&](Vector3* out) {
+		return DebugShapes::Arrow(center, Vector3(1.0f, 2.0f, 8.0f), 0.5f, out);
+	});
+}
+
+// 箱の頂点と辺
+void TestBox() {
+	const Vector3 min(-1.0f, 2.0f, -3.0f);
+	const Vector3 max(4.0f, 5.0f, 6.0f);
+	std::vector<Vector3> points = Generate(DebugShapes::kBoxLineCount, [&](Vector3* out) {
+		return DebugShapes::Box(min, max, out);
+	});
+	Vector3 corners[8];
+	for (uint32_t i = 0; i < 8; i++) {
+		corners[i] = Vector3(
+		  (i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+	}
+	CheckCorners(points, corners);
+	// 辺はどれも1軸方向だけに伸びる
+	for (size_t i = 0; i < points.size(); i += 2) {
+		Vector3 d = Sub(points[i + 1], points[i]);
+		int axisCount = (d.x != 0.0f) + (d.y != 0.0f) + (d.z != 0.0f);
+		CHECK(axisCount == 1);
+	}
+
+	// Y軸回りに45度回した箱
+	const float s = std::sqrt(0.5f);
+	const Vector3 axes[3] = {Vector3(s, 0.0f, -s), Vector3(0.0f, 1.0f, 0.0f), Vector3(s, 0.0f, s)};
+	const Vector3 center(1.0f, 1.0f, 1.0f);
+	const Vector3 halfExtents(2.0f, 0.5f, 1.0f);
+	points = Generate(DebugShapes::kBoxLineCount, [&](Vector3* out) {
+		return DebugShapes::OrientedBox(center, axes, halfExtents, out);
+	});
+	// 箱の座標系では各成分が±halfExtents
+	const float extents[3] = {halfExtents.x, halfExtents.y, halfExtents.z};
+	for (const Vector3& point : points) {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			float local = Dot(Sub(point, center), axes[axis]);
+			CHECK(std::fabs(std::fabs(local) - extents[axis]) < kEpsilon);
+		}
+	}
+}
+
+// 視錐台の頂点
+void TestFrustum() {
+	// Z軸の正の向きを見るカメラ（左手系で右がX、上がY）
+	const Vector3 eye(0.0f, 1.0f, -2.0f);
+	const float aspectRatio = 2.0f;
+	const float distances[] = {1.0f, 10.0f};
+	std::vector<Vector3> points = Generate(DebugShapes::kFrustumLineCount, [&](Vector3* out) {
+		return DebugShapes::Frustum(
+		  eye, Vector3(0.0f, 1.0f, 5.0f), Vector3(0.0f, 1.0f, 0.0f), kPi * 0.5f, aspectRatio,
+		  distances[0], distances[1], out);
+	});
+	// 視野角90度なので、距離dでの高さの半分はd
+	Vector3 corners[8];
+	for (uint32_t i = 0; i < 8; i++) {
+		float distance = distances[(i >> 2) & 1];
+		float halfWidth = distance * aspectRatio;
+		corners[i] = Vector3(
+		  eye.x + ((i & 1) ? halfWidth : -halfWidth), eye.y + ((i & 2) ? distance : -distance),
+		  eye.z + distance);
+	}
+	CheckCorners(points, corners);
+}
+
+// 球・カプセル・円錐の点が半径の位置にあること
+void TestRadius() {
+	const uint32_t segmentCounts[] = {4, 7, 32, DebugShapes::kMaxSegments, 1000};
+	for (uint32_t segments : segmentCounts) {
+		const Vector3 center(1.0f, -2.0f, 3.0f);
+		const float radius = 2.5f;
+		std::vector<Vector3> points =
+		  Generate(DebugShapes::SphereLineCount(segments), [&](Vector3* out) {
+			  return DebugShapes::Sphere(center, radius, segments, out);
+		  });
+		float maxError = 0.0f;
+		for (const Vector3& point : points) {
+			maxError = std::fmax(maxError, std::fabs(Length(Sub(point, center)) - radius));
+		}
+		// 大円は3つとも閉じている
+		const uint32_t clamped = DebugShapes::ClampSegments(segments);
+		for (uint32_t circle = 0; circle < 3; circle++) {
+			const Vector3* arc = points.data() + circle * clamped * 2;
+			CHECK(Near(arc[0], arc[clamped * 2 - 1]));
+		}
+
+		const Vector3 p0(0.0f, 0.0f, 0.0f);
+		const Vector3 p1(3.0f, 4.0f, -1.0f);
+		points = Generate(DebugShapes::CapsuleLineCount(segments), [&](Vector3* out) {
+			return DebugShapes::Capsule(p0, p1, radius, segments, out);
+		});
+		for (const Vector3& point : points) {
+			maxError = std::fmax(maxError, std::fabs(SegmentDistance(p0, p1, point) - radius));
+		}
+
+		// 円錐の底面の円（側面の4本を除く）は軸からtan(angle) * heightの位置
+		const Vector3 apex(0.0f, 5.0f, 0.0f);
+		const float height = 4.0f;
+		const float angle = 0.3f;
+		points = Generate(DebugShapes::ConeLineCount(segments), [&](Vector3* out) {
+			return DebugShapes::Cone(
+			  apex, Vector3(0.0f, -1.0f, 0.0f), height, angle, segments, out);
+		});
+		const Vector3 baseCenter(apex.x, apex.y - height, apex.z);
+		for (uint32_t i = 0; i < clamped * 2; i++) {
+			CHECK(std::fabs(points[i].y - baseCenter.y) < kEpsilon);
+			maxError = std::fmax(
+			  maxError,
+			  std::fabs(Length(Sub(points[i], baseCenter)) - height * std::tan(angle)));
+		}
+		printf("segments %u (%u): max radius error %.2e\n", segments, clamped,
+		       static_cast<double>(maxError));
+		CHECK(maxError < kEpsilon);
+	}
+}
+} // namespace
+
+int main() {
+	TestLineCounts();
+	TestBox();
+	TestFrustum();
+	TestRadius();
+	return CheckResult();
+}
@@ -0,0 +1,206 @@
+﻿#include "Check.h"
+#include "DirtyRangeTracker.h"
+#include <cstdio>
+#include <initializer_list>
+#include <vector>
+
+// DirtyRangeTrackerの変更範囲の取り出しと転送バイト数の検証
+// （間の狭い範囲のまとめ、要素数の増減、全体の変更、ビットで記録した範囲）
+
+namespace {
+using Range = DirtyRangeTracker::Range;
+
+bool Equal(const std::vector<Range>& ranges, std::initializer_list<Range> expected) {
+	if (ranges.size() != expected.size()) {
+		return false;
+	}
+	size_t i = 0;
+	for (const Range& range : expected) {
+		if (ranges[i].begin != range.begin || ranges[i].end != range.end) {
+			return false;
+		}
+		i++;
+	}
+	return true;
+}
+
+// 番号順にまとめた範囲
+void TestTakeRanges() {
+	DirtyRangeTracker tracker;
+	std::vector<Range> ranges;
+	CHECK(!tracker.IsDirty());
+
+	// 増えた要素は変更済み
+	tracker.Resize(10);
+	CHECK(tracker.IsDirty());
+	tracker.TakeRanges(ranges);
+	CHECK(Equal(ranges, {{0, 10}}));
+	CHECK(!tracker.IsDirty());
+	tracker.TakeRanges(ranges);
+	CHECK(ranges.empty());
+
+	// 記録順に関係なく番号順、同じ要素は1回
+	const uint32_t marks[] = {9, 3, 5, 2, 3, 9};
+	for (uint32_t index : marks) {
+		tracker.Mark(index);
+	}
+	tracker.TakeRanges(ranges);
+	CHECK(Equal(ranges, {{2, 4}, {5, 6}, {9, 10}}));
+
+	// 間の未変更要素がmergeGap以下ならまとめる
+	for (uint32_t index : marks) {
+		tracker.Mark(index);
+	}
+	tracker.TakeRanges(ranges, 1);
+	CHECK(Equal(ranges, {{2, 6}, {9, 10}}));
+	for (uint32_t index : marks) {
+		tracker.Mark(index);
+	}
+	tracker.TakeRanges(ranges, 3);
+	CHECK(Equal(ranges, {{2, 10}}));
+	CHECK(!tracker.IsDirty());
+}
+
+// 要素数の増減
+void TestResize() {
+	DirtyRangeTracker tracker;
+	std::vector<Range> ranges;
+	tracker.Resize(10);
+	tracker.TakeRanges(ranges);
+
+	// 範囲外になった記録は捨てる
+	tracker.Mark(1);
+	tracker.Mark(8);
+	tracker.Resize(5);
+	CHECK(tracker.GetCount() == 5);
+	tracker.TakeRanges(ranges);
+	CHECK(Equal(ranges, {{1, 2}}));
+
+	// 縮める前に記録していた要素も、増やし直せば変更済みとして1回だけ出る
+	tracker.Mark(4);
+	tracker.Resize(3);
+	tracker.Resize(8);
+	tracker.Mark(7);
+	tracker.TakeRanges(ranges);
+	CHECK(Equal(ranges, {{3, 8}}));
+
+	tracker.Resize(0);
+	CHECK(!tracker.IsDirty());
+	tracker.TakeRanges(ranges);
+	CHECK(ranges.empty());
+}
+
+// 全体の変更と個別の記録
+void TestMarkAll() {
+	DirtyRangeTracker tracker;
+	std::vector<Range> ranges;
+
+	// 要素が無ければ範囲も無い
+	tracker.MarkAll();
+	CHECK(tracker.IsDirty());
+	tracker.TakeRanges(ranges);
+	CHECK(ranges.empty());
+
+	tracker.Resize(6);
+	tracker.TakeRanges(ranges);
+	tracker.Mark(3);
+	tracker.MarkAll();
+	tracker.Mark(4);
+	tracker.TakeRanges(ranges, 0);
+	CHECK(Equal(ranges, {{0, 6}}));
+	// 全体を出した後に個別の記録は残らない
+	tracker.TakeRanges(ranges);
+	CHECK(ranges.empty());
+
+	// 全体の変更中に増減しても全体を1つの範囲で出す
+	tracker.MarkAll();
+	tracker.Resize(9);
+	tracker.TakeRanges(ranges);
+	CHECK(Equal(ranges, {{0, 9}}));
+	tracker.MarkAll();
+	tracker.Resize(4);
+	tracker.TakeRanges(ranges);
+	CHECK(Equal(ranges, {{0, 4}}));
+
+	// 全体を出した後は個別の記録に戻る
+	tracker.Mark(2);
+	tracker.TakeRanges(ranges);
+	CHECK(Equal(ranges, {{2, 3}}));
+}
+
+// ビットで記録した範囲
+void TestBitRanges() {
+	std::vector<Range> ranges;
+	auto collect = [&ranges](uint32_t bits) {
+		ranges.clear();
+		DirtyRangeTracker::ForEachBitRange(
+		  bits, [&ranges](uint32_t begin, uint32_t end) { ranges.push_back({begin, end}); });
+	};
+	collect(0);
+	CHECK(ranges.empty());
+	collect(0xB6); // 1011 0110
+	CHECK(Equal(ranges, {{1, 3}, {4, 6}, {7, 8}}));
+	collect(0xFFFFFFFF);
+	CHECK(Equal(ranges, {{0, 32}}));
+	collect(0x80000001);
+	CHECK(Equal(ranges, {{0, 1}, {31, 32}}));
+}
+
+// 転送した要素とバイト数
+void TestCopyRanges() {
+	// ClusteredLightingの光源と同じく16バイトの倍数の要素
+	struct Element {
+		float values[12];
+	};
+	const uint32_t kCount = 20;
+	std::vector<Element> source(kCount);
+	for (uint32_t i = 0; i < kCount; i++) {
+		for (float& value : source[i].values) {
+			value = static_cast<float>(i + 1);
+		}
+	}
+
+	DirtyRangeTracker tracker;
+	std::vector<Range> ranges;
+	tracker.Resize(kCount);
+	tracker.TakeRanges(ranges);
+	std::vector<Element> dest(kCount, Element{});
+
+	// 2要素以下の隙間は埋めて転送する
+	const uint32_t marks[] = {1, 3, 4, 10, 15, 19};
+	for (uint32_t index : marks) {
+		tracker.Mark(index);
+	}
+	tracker.TakeRanges(ranges, 2);
+	CHECK(Equal(ranges, {{1, 5}, {10, 11}, {15, 16}, {19, 20}}));
+	size_t bytes =
+	  DirtyRangeTracker::CopyRanges(ranges, sizeof(Element), source.data(), dest.data());
+	printf("copied %zu bytes for %zu marks\n", bytes, sizeof(marks) / sizeof(marks[0]));
+	CHECK(bytes == sizeof(Element) * 7);
+	for (uint32_t i = 0; i < kCount; i++) {
+		bool copied = (1 <= i && i < 5) || i == 10 || i == 15 || i == 19;
+		CHECK(dest[i].values[0] == (copied ? source[i].values[0] : 0.0f));
+		CHECK(dest[i].values[11] == (copied ? source[i].values[11] : 0.0f));
+	}
+
+	// 変更が無ければ0バイト、全体なら全要素
+	tracker.TakeRanges(ranges);
+	CHECK(DirtyRangeTracker::CopyRanges(ranges, sizeof(Element), source.data(), dest.data()) == 0);
+	tracker.MarkAll();
+	tracker.TakeRanges(ranges);
+	bytes = DirtyRangeTracker::CopyRanges(ranges, sizeof(Element), source.data(), dest.data());
+	CHECK(bytes == sizeof(Element) * kCount);
+	for (uint32_t i = 0; i < kCount; i++) {
+		CHECK(dest[i].values[5] == source[i].values[5]);
+	}
+}
+} // namespace
+
+int main() {
+	TestTakeRanges();
+	TestResize();
+	TestMarkAll();
+	TestBitRanges();
+	TestCopyRanges();
+	return CheckResult();
+}
@@ -0,0 +1,194 @@
+﻿#include "Check.h"
+#include "FramePageAllocator.h"
+#include "LinearAllocator.h"
+#include <algorithm>
+#include <set>
+#include <vector>
+
+// LinearAllocatorと、FrameUploadAllocatorのページ管理（FramePageAllocator）の検証
+// （GPUのフェンスは数値で模し、フレームの領域がフェンスを越えて使い回されることを確かめる）
+
+namespace {
+// 線形アロケータ単体
+void TestLinearAllocator() {
+	LinearAllocator allocator;
+	allocator.Initialize(256);
+	CHECK(allocator.Allocate(10, 1) == 0);
+	// アライメントに揃えて詰める
+	CHECK(allocator.Allocate(16, 16) == 16);
+	CHECK(allocator.GetUsed() == 32);
+	// 容量ちょうどまでは入り、超えると失敗して位置は変わらない
+	CHECK(allocator.Allocate(224, 1) == 32);
+	CHECK(allocator.Allocate(1, 1) == LinearAllocator::kInvalidOffset);
+	CHECK(allocator.GetUsed() == 256);
+
+	// まとめて解放すると先頭から使い直す
+	allocator.Reset();
+	CHECK(allocator.GetUsed() == 0);
+	CHECK(allocator.Allocate(300, 1) == LinearAllocator::kInvalidOffset);
+	CHECK(allocator.Allocate(64, 256) == 0);
+
+	// アライメントの切り上げで容量を越える場合も失敗する
+	allocator.Initialize(100);
+	CHECK(allocator.Allocate(1, 1) == 0);
+	CHECK(allocator.Allocate(1, 128) == LinearAllocator::kInvalidOffset);
+}
+
+// 通常ページのフェンスを越えた使い回し
+void TestPageReuse() {
+	const uint64_t kPageSize = 1024;
+	FramePageAllocator allocator;
+	allocator.Initialize(2, kPageSize);
+
+	std::vector<uint32_t> released;
+	uint64_t fence = 0;
+
+	// フレームごとに使ったページ番号
+	std::vector<std::set<uint32_t>> framePages(2);
+
+	// 1周目：3ページ分あふれるまで確保すると、足りない分だけページが増える
+	for (uint32_t frame = 0; frame < 2; frame++) {
+		allocator.BeginFrame(allocator.GetRequiredFenceValue(), released);
+		CHECK(released.empty());
+		uint32_t newPages = 0;
+		for (uint32_t i = 0; i < 10; i++) {
+			FramePageAllocator::Allocation allocation = allocator.Allocate(256, 256);
+			CHECK(allocation.offset % 256 == 0);
+			CHECK(allocation.offset + 256 <= allocator.GetPageCapacity(allocation.page));
+			newPages += allocation.isNewPage ? 1 : 0;
+			framePages[frame].insert(allocation.page);
+		}
+		CHECK(newPages == 3);
+		CHECK(framePages[frame].size() == 3);
+		CHECK(allocator.GetUsedBytes() == 10 * 256);
+		allocator.EndFrame(++fence);
+		CHECK(allocator.GetRequiredFenceValue() == (frame == 0 ? 0 : fence - 1));
+	}
+	// フレーム同士はページを共有しない
+	for (uint32_t page : framePages[0]) {
+		CHECK(framePages[1].count(page) == 0);
+	}
+	CHECK(allocator.GetPageCount() == 6);
+	CHECK(allocator.GetReservedBytes() == 6 * kPageSize);
+
+	// 2周目以降：同じ量なら新しいページは作らず、同じフレームのページを先頭から使い直す
+	for (uint32_t frame = 0; frame < 20; frame++) {
+		// 2フレーム前のフェンスが完了していればよい
+		uint64_t required = allocator.GetRequiredFenceValue();
+		CHECK(required == fence - 1);
+		allocator.BeginFrame(required, released);
+		CHECK(released.empty());
+		CHECK(allocator.GetUsedBytes() == 0);
+
+		std::set<uint32_t> pages;
+		for (uint32_t i = 0; i < 10; i++) {
+			FramePageAllocator::Allocation allocation = allocator.Allocate(256, 256);
+			CHECK(!allocation.isNewPage);
+			if (i == 0) {
+				CHECK(allocation.offset == 0);
+			}
+			pages.insert(allocation.page);
+		}
+		CHECK(pages == framePages[frame % 2]);
+		allocator.EndFrame(++fence);
+	}
+	CHECK(allocator.GetPageCount() == 6);
+	CHECK(allocator.GetReservedBytes() == 6 * kPageSize);
+
+	// 片方のフレームだけ使用量が増えると、そのフレームのページだけが増える
+	allocator.BeginFrame(allocator.GetRequiredFenceValue(), released);
+	uint32_t newPages = 0;
+	for (uint32_t i = 0; i < 14; i++) {
+		newPages += allocator.Allocate(256, 256).isNewPage ? 1 : 0;
+	}
+	CHECK(newPages == 1);
+	allocator.EndFrame(++fence);
+	CHECK(allocator.GetPageCount() == 7);
+}
+
+// ページに収まらない大きな確保
+void TestLargePages() {
+	const uint64_t kPageSize = 1024;
+	FramePageAllocator allocator;
+	allocator.Initialize(2, kPageSize);
+
+	std::vector<uint32_t> released;
+	uint64_t fence = 0;
+
+	// フレーム0：通常ページ1枚と大きなページ2枚
+	allocator.BeginFrame(allocator.GetRequiredFenceValue(), released);
+	FramePageAllocator::Allocation small = allocator.Allocate(64, 16);
+	FramePageAllocator::Allocation large0 = allocator.Allocate(4000, 256);
+	FramePageAllocator::Allocation large1 = allocator.Allocate(kPageSize + 1, 256);
+	CHECK(small.isNewPage && large0.isNewPage && large1.isNewPage);
+	CHECK(large0.offset == 0 && large1.offset == 0);
+	CHECK(allocator.GetPageCapacity(large0.page) == 4000);
+	CHECK(allocator.GetPageCapacity(large1.page) == kPageSize + 1);
+	CHECK(allocator.GetUsedBytes() == 64 + 4000 + kPageSize + 1);
+	// 大きな確保の後も通常ページの続きから切り出す
+	FramePageAllocator::Allocation next = allocator.Allocate(64, 16);
+	CHECK(next.page == small.page && next.offset == 64);
+	allocator.EndFrame(++fence);
+
+	// フレーム1：大きなページはフレーム0のものとは別に作る
+	allocator.BeginFrame(allocator.GetRequiredFenceValue(), released);
+	CHECK(released.empty());
+	FramePageAllocator::Allocation other = allocator.Allocate(2000, 256);
+	CHECK(other.isNewPage);
+	CHECK(other.page != large0.page && other.page != large1.page);
+	allocator.EndFrame(++fence);
+	CHECK(allocator.GetPageCount() == 4);
+
+	// フレーム0を使い回すと大きなページが解放され、番号は次の大きな確保で使い直される
+	allocator.BeginFrame(allocator.GetRequiredFenceValue(), released);
+	std::sort(released.begin(), released.end());
+	std::vector<uint32_t> expected = {large0.page, large1.page};
+	std::sort(expected.begin(), expected.end());
+	CHECK(released == expected);
+	CHECK(allocator.GetPageCount() == 2);
+	CHECK(allocator.GetReservedBytes() == kPageSize + 2000);
+
+	FramePageAllocator::Allocation reused = allocator.Allocate(3000, 256);
+	CHECK(reused.isNewPage);
+	CHECK(reused.page == large0.page || reused.page == large1.page);
+	CHECK(allocator.GetPageCapacity(reused.page) == 3000);
+	// 通常ページは解放されずに使い直す
+	FramePageAllocator::Allocation again = allocator.Allocate(64, 16);
+	CHECK(!again.isNewPage && again.page == small.page && again.offset == 0);
+	allocator.EndFrame(++fence);
+	CHECK(allocator.GetPageCount() == 3);
+
+	// フレーム1を使い回すと、その大きなページだけが解放される
+	allocator.BeginFrame(allocator.GetRequiredFenceValue(), released);
+	CHECK(released.size() == 1 && released[0] == other.page);
+	allocator.EndFrame(++fence);
+}
+
+// 同時処理フレーム数1（毎フレーム前のフレームの完了を待つ）
+void TestSingleFrame() {
+	FramePageAllocator allocator;
+	allocator.Initialize(1, 512);
+
+	std::vector<uint32_t> released;
+	uint64_t fence = 0;
+	for (uint32_t frame = 0; frame < 4; frame++) {
+		allocator.BeginFrame(allocator.GetRequiredFenceValue(), released);
+		CHECK(allocator.GetRequiredFenceValue() == fence);
+		FramePageAllocator::Allocation allocation = allocator.Allocate(512, 256);
+		CHECK(allocation.offset == 0);
+		CHECK(allocation.isNewPage == (frame == 0));
+		allocator.EndFrame(++fence);
+		// 次のBeginFrameまでにこのフレームのコマンドが完了している必要がある
+		CHECK(allocator.GetRequiredFenceValue() == fence);
+	}
+	CHECK(allocator.GetPageCount() == 1);
+}
+} // namespace
+
+int main() {
+	TestLinearAllocator();
+	TestPageReuse();
+	TestLargePages();
+	TestSingleFrame();
+	return CheckResult();
+}
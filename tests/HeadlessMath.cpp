@@ -0,0 +1,228 @@
+﻿#include "MathUtility.h"
+#include "Vector2.h"
+#include "Vector4.h"
+#include <cmath>
+
+// 数学ライブラリはビルド済みのエンジンライブラリにあるので、GPUの無い環境用に同じものを実装する
+// （行ベクトルに右から行列を掛ける左手系で、エンジンと同じ規約）
+
+Vector2::Vector2() : x(0.0f), y(0.0f) {}
+Vector2::Vector2(float x, float y) : x(x), y(y) {}
+Vector2 Vector2::operator+() const { return *this; }
+Vector2 Vector2::operator-() const { return Vector2(-x, -y); }
+Vector2& Vector2::operator+=(const Vector2& v) {
+	x += v.x;
+	y += v.y;
+	return *this;
+}
+Vector2& Vector2::operator-=(const Vector2& v) {
+	x -= v.x;
+	y -= v.y;
+	return *this;
+}
+Vector2& Vector2::operator*=(float s) {
+	x *= s;
+	y *= s;
+	return *this;
+}
+Vector2& Vector2::operator/=(float s) { return *this *= 1.0f / s; }
+
+Vector3::Vector3() : x(0.0f), y(0.0f), z(0.0f) {}
+Vector3::Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
+Vector3 Vector3::operator+() const { return *this; }
+Vector3 Vector3::operator-() const { return Vector3(-x, -y, -z); }
+Vector3& Vector3::operator+=(const Vector3& v) {
+	x += v.x;
+	y += v.y;
+	z += v.z;
+	return *this;
+}
+Vector3& Vector3::operator-=(const Vector3& v) {
+	x -= v.x;
+	y -= v.y;
+	z -= v.z;
+	return *this;
+}
+Vector3& Vector3::operator*=(float s) {
+	x *= s;
+	y *= s;
+	z *= s;
+	return *this;
+}
+Vector3& Vector3::operator/=(float s) { return *this *= 1.0f / s; }
+
+Vector4::Vector4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+Vector4::Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+Matrix4::Matrix4() : m{} {}
+Matrix4::Matrix4(
+  float m00, float m01, float m02, float m03, float m10, float m11, float m12, float m13,
+  float m20, float m21, float m22, float m23, float m30, float m31, float m32, float m33)
+    : m{{m00, m01, m02, m03}, {m10, m11, m12, m13}, {m20, m21, m22, m23}, {m30, m31, m32, m33}} {}
+Matrix4& Matrix4::operator*=(const Matrix4& m2) {
+	Matrix4 result;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			for (int k = 0; k < 4; k++) {
+				result.m[i][j] += m[i][k] * m2.m[k][j];
+			}
+		}
+	}
+	*this = result;
+	return *this;
+}
+
+namespace MathUtility {
+
+const Vector3 Vector3Zero() { return Vector3(); }
+
+bool Vector3Equal(const Vector3& v1, const Vector3& v2) {
+	return v1.x == v2.x && v1.y == v2.y && v1.z == v2.z;
+}
+
+float Vector3Length(const Vector3& v) { return std::sqrt(Vector3Dot(v, v)); }
+
+Vector3& Vector3Normalize(Vector3& v) {
+	float length = Vector3Length(v);
+	if (length != 0.0f) {
+		v /= length;
+	}
+	return v;
+}
+
+float Vector3Dot(const Vector3& v1, const Vector3& v2) {
+	return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+}
+
+Vector3 Vector3Cross(const Vector3& v1, const Vector3& v2) {
+	return Vector3(v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x);
+}
+
+const Vector3 operator+(const Vector3& v1, const Vector3& v2) { return Vector3(v1) += v2; }
+const Vector3 operator-(const Vector3& v1, const Vector3& v2) { return Vector3(v1) -= v2; }
+const Vector3 operator*(const Vector3& v, float s) { return Vector3(v) *= s; }
+const Vector3 operator*(float s, const Vector3& v) { return Vector3(v) *= s; }
+const Vector3 operator/(const Vector3& v, float s) { return Vector3(v) /= s; }
+
+Matrix4 Matrix4Identity() {
+	return Matrix4(
+	  1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Matrix4 Matrix4Transpose(const Matrix4& m) {
+	Matrix4 result;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			result.m[i][j] = m.m[j][i];
+		}
+	}
+	return result;
+}
+
+Matrix4 Matrix4Scaling(float sx, float sy, float sz) {
+	Matrix4 result = Matrix4Identity();
+	result.m[0][0] = sx;
+	result.m[1][1] = sy;
+	result.m[2][2] = sz;
+	return result;
+}
+
+Matrix4 Matrix4RotationX(float angle) {
+	float s = std::sin(angle);
+	float c = std::cos(angle);
+	Matrix4 result = Matrix4Identity();
+	result.m[1][1] = c;
+	result.m[1][2] = s;
+	result.m[2][1] = -s;
+	result.m[2][2] = c;
+	return result;
+}
+
+Matrix4 Matrix4RotationY(float angle) {
+	float s = std::sin(angle);
+	float c = std::cos(angle);
+	Matrix4 result = Matrix4Identity();
+	result.m[0][0] = c;
+	result.m[0][2] = -s;
+	result.m[2][0] = s;
+	result.m[2][2] = c;
+	return result;
+}
+
+Matrix4 Matrix4RotationZ(float angle) {
+	float s = std::sin(angle);
+	float c = std::cos(angle);
+	Matrix4 result = Matrix4Identity();
+	result.m[0][0] = c;
+	result.m[0][1] = s;
+	result.m[1][0] = -s;
+	result.m[1][1] = c;
+	return result;
+}
+
+Matrix4 Matrix4Translation(float tx, float ty, float tz) {
+	Matrix4 result = Matrix4Identity();
+	result.m[3][0] = tx;
+	result.m[3][1] = ty;
+	result.m[3][2] = tz;
+	return result;
+}
+
+Matrix4 Matrix4LookAtLH(const Vector3& eye, const Vector3& target, const Vector3& up) {
+	Vector3 axisZ = target - eye;
+	Vector3Normalize(axisZ);
+	Vector3 axisX = Vector3Cross(up, axisZ);
+	Vector3Normalize(axisX);
+	Vector3 axisY = Vector3Cross(axisZ, axisX);
+	return Matrix4(
+	  axisX.x, axisY.x, axisZ.x, 0.0f, axisX.y, axisY.y, axisZ.y, 0.0f, axisX.z, axisY.z, axisZ.z,
+	  0.0f, -Vector3Dot(axisX, eye), -Vector3Dot(axisY, eye), -Vector3Dot(axisZ, eye), 1.0f);
+}
+
+Matrix4 Matrix4Orthographic(
+  float viewLeft, float viewRight, float viewBottom, float viewTop, float nearZ, float farZ) {
+	Matrix4 result = Matrix4Identity();
+	result.m[0][0] = 2.0f / (viewRight - viewLeft);
+	result.m[1][1] = 2.0f / (viewTop - viewBottom);
+	result.m[2][2] = 1.0f / (farZ - nearZ);
+	result.m[3][0] = (viewLeft + viewRight) / (viewLeft - viewRight);
+	result.m[3][1] = (viewTop + viewBottom) / (viewBottom - viewTop);
+	result.m[3][2] = nearZ / (nearZ - farZ);
+	return result;
+}
+
+Matrix4 Matrix4Perspective(float fovAngleY, float aspectRatio, float nearZ, float farZ) {
+	float scaleY = 1.0f / std::tan(fovAngleY * 0.5f);
+	Matrix4 result;
+	result.m[0][0] = scaleY / aspectRatio;
+	result.m[1][1] = scaleY;
+	result.m[2][2] = farZ / (farZ - nearZ);
+	result.m[2][3] = 1.0f;
+	result.m[3][2] = -nearZ * farZ / (farZ - nearZ);
+	return result;
+}
+
+Vector3 Vector3Transform(const Vector3& v, const Matrix4& m) {
+	return Vector3(
+	  v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + m.m[3][0],
+	  v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + m.m[3][1],
+	  v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + m.m[3][2]);
+}
+
+Vector3 Vector3TransformCoord(const Vector3& v, const Matrix4& m) {
+	float w = v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + m.m[3][3];
+	return Vector3Transform(v, m) / w;
+}
+
+Vector3 Vector3TransformNormal(const Vector3& v, const Matrix4& m) {
+	return Vector3(
+	  v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0],
+	  v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1],
+	  v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2]);
+}
+
+Matrix4 operator*(const Matrix4& m1, const Matrix4& m2) { return Matrix4(m1) *= m2; }
+
+Vector3 operator*(const Vector3& v, const Matrix4& m) { return Vector3Transform(v, m); }
+
+} // namespace MathUtility
@@ -0,0 +1,204 @@
+﻿#include "Check.h"
+#include "IndirectDrawList.h"
+#include "RenderCommandRecorder.h"
+#include <vector>
+
+// IndirectDrawListの引数の検証とコマンドの詰め方の検証
+// （正しい引数を1か所ずつ壊して、GPUに範囲外を読ませるものが全て外されることと、
+// 　見えないものや外したものを飛ばして登録順に隙間なく詰められることを確かめる）
+
+namespace {
+using Command = IndirectDrawList::Command;
+
+// マテリアル表とデスクリプタヒープの大きさ
+const uint32_t kMaterialCount = 4;
+const uint32_t kTextureCapacity = 16;
+
+// 頂点24個・インデックス36個（16ビット）のメッシュ
+RenderVertexBufferView MakeVertexBuffer() {
+	RenderVertexBufferView view;
+	view.address = 0x10000;
+	view.stride = 32;
+	view.size = view.stride * 24;
+	return view;
+}
+RenderIndexBufferView MakeIndexBuffer() {
+	RenderIndexBufferView view;
+	view.address = 0x20000;
+	view.size = sizeof(uint16_t) * 36;
+	view.format = RenderIndexFormat::kUint16;
+	return view;
+}
+
+// 描画ごとの定数
+ObjLayout::BindlessDraw MakeDrawConstants(uint32_t materialIndex, uint32_t textureOverride) {
+	ObjLayout::BindlessDraw constants{};
+	constants.materialIndex = materialIndex;
+	constants.textureOverride = textureOverride;
+	return constants;
+}
+
+// 正しい引数のコマンド
+Command MakeValidCommand() {
+	IndirectDrawList list;
+	list.Add(
+	  0x30000, MakeVertexBuffer(), MakeIndexBuffer(), 36,
+	  MakeDrawConstants(kMaterialCount - 1, BINDLESS_NO_TEXTURE));
+	return list.GetCandidate(0);
+}
+
+// 検証
+bool IsValid(const Command& command) {
+	return IndirectDrawList::Validate(command, kMaterialCount, kTextureCapacity);
+}
+
+// 登録した引数の並び
+void TestAdd() {
+	Command command = MakeValidCommand();
+	CHECK(command.worldTransform == 0x30000);
+	CHECK(command.vertexBuffer.address == 0x10000);
+	CHECK(command.vertexBuffer.stride == 32);
+	CHECK(command.indexBuffer.address == 0x20000);
+	CHECK(command.indexBuffer.format == IndirectDrawList::kIndexFormatUint16);
+	CHECK(command.draw.indexCount == 36);
+	CHECK(command.draw.instanceCount == 1);
+	CHECK(command.draw.startIndex == 0);
+	CHECK(command.draw.baseVertex == 0);
+	CHECK(command.draw.startInstance == 0);
+	CHECK(command.drawConstants.materialIndex == kMaterialCount - 1);
+
+	RenderIndexBufferView indexBuffer = MakeIndexBuffer();
+	indexBuffer.format = RenderIndexFormat::kUint32;
+	IndirectDrawList list;
+	list.Add(0x30000, MakeVertexBuffer(), indexBuffer, 18, MakeDrawConstants(0, 0));
+	CHECK(list.GetCandidate(0).indexBuffer.format == IndirectDrawList::kIndexFormatUint32);
+	CHECK(IsValid(list.GetCandidate(0)));
+}
+
+// 引数の検証
+void TestValidate() {
+	CHECK(IsValid(MakeValidCommand()));
+
+	// ワールド変換行列は0でなく定数バッファのアライメントにそろっている
+	Command command = MakeValidCommand();
+	command.worldTransform = 0;
+	CHECK(!IsValid(command));
+	command.worldTransform = 0x30000 + 16;
+	CHECK(!IsValid(command));
+
+	// 頂点バッファと基準頂点
+	command = MakeValidCommand();
+	command.vertexBuffer.address = 0;
+	CHECK(!IsValid(command));
+	command = MakeValidCommand();
+	command.vertexBuffer.stride = 0;
+	CHECK(!IsValid(command));
+	command = MakeValidCommand();
+	command.vertexBuffer.size = command.vertexBuffer.stride - 1;
+	CHECK(!IsValid(command));
+	command = MakeValidCommand();
+	command.draw.baseVertex = -1;
+	CHECK(!IsValid(command));
+	command.draw.baseVertex = 23;
+	CHECK(IsValid(command));
+	command.draw.baseVertex = 24;
+	CHECK(!IsValid(command));
+
+	// インデックスの範囲（境界ちょうどは正しい）
+	command = MakeValidCommand();
+	command.draw.startIndex = 1;
+	CHECK(!IsValid(command));
+	command.draw.indexCount = 35;
+	CHECK(IsValid(command));
+	command = MakeValidCommand();
+	command.draw.indexCount = 0;
+	CHECK(!IsValid(command));
+	command = MakeValidCommand();
+	command.draw.instanceCount = 0;
+	CHECK(!IsValid(command));
+	// 開始位置と数の和が32ビットで桁あふれしても通さない
+	command = MakeValidCommand();
+	command.draw.startIndex = 0xffffffff;
+	command.draw.indexCount = 2;
+	CHECK(!IsValid(command));
+
+	// インデックスバッファのアドレスと形式
+	command = MakeValidCommand();
+	command.indexBuffer.address = 0;
+	CHECK(!IsValid(command));
+	command.indexBuffer.address = 0x20001;
+	CHECK(!IsValid(command));
+	command = MakeValidCommand();
+	command.indexBuffer.format = 0;
+	CHECK(!IsValid(command));
+	// 32ビットにすると同じバイト数に半分しか入らない
+	command = MakeValidCommand();
+	command.indexBuffer.format = IndirectDrawList::kIndexFormatUint32;
+	CHECK(!IsValid(command));
+	command.draw.indexCount = 18;
+	CHECK(IsValid(command));
+	command.indexBuffer.address = 0x20002;
+	CHECK(!IsValid(command));
+
+	// マテリアルと差し替えるテクスチャの番号
+	command = MakeValidCommand();
+	command.drawConstants.materialIndex = kMaterialCount;
+	CHECK(!IsValid(command));
+	command = MakeValidCommand();
+	command.drawConstants.textureOverride = kTextureCapacity - 1;
+	CHECK(IsValid(command));
+	command.drawConstants.textureOverride = kTextureCapacity;
+	CHECK(!IsValid(command));
+}
+
+// 見えないものと不正なものを飛ばして詰める
+void TestBuild() {
+	IndirectDrawList list;
+	for (uint32_t i = 0; i < 8; i++) {
+		// 3の倍数は範囲外のマテリアル
+		uint32_t materialIndex = i % 3 == 0 ? kMaterialCount : i % kMaterialCount;
+		list.Add(
+		  0x30000 + IndirectDrawList::kConstantBufferAlignment * i, MakeVertexBuffer(),
+		  MakeIndexBuffer(), 36, MakeDrawConstants(materialIndex, BINDLESS_NO_TEXTURE));
+	}
+	list.SetVisible(4, 2, false);
+
+	// 0,3,6は不正、4,5は見えないので1,2,7が登録順に残る
+	CHECK(list.Build(kMaterialCount, kTextureCapacity) == 3);
+	const std::vector<Command>& commands = list.GetCommands();
+	CHECK(commands.size() == 3);
+	const uint32_t expected[] = {1, 2, 7};
+	for (size_t i = 0; i < commands.size() && i < 3; i++) {
+		CHECK(
+		  commands[i].worldTransform ==
+		  0x30000 + IndirectDrawList::kConstantBufferAlignment * expected[i]);
+	}
+	const IndirectDrawList::Stats& stats = list.GetStats();
+	CHECK(stats.candidateCount == 8);
+	CHECK(stats.culledCount == 2);
+	CHECK(stats.rejectedCount == 3);
+	CHECK(stats.commandCount == 3);
+
+	// マテリアル表が広がると前に外したものも通る
+	list.SetVisible(0, list.GetCount(), true);
+	CHECK(list.Build(kMaterialCount + 1, kTextureCapacity) == 8);
+
+	// 発行される描画はコマンドの数と同じ
+	RenderCommandRecorder recorder;
+	list.Replay(recorder, 0, 11);
+	CHECK(recorder.GetStats().drawCount == 8);
+	CHECK(recorder.GetStats().vertexCount == 8 * 36);
+
+	list.Clear();
+	CHECK(list.GetCount() == 0);
+	CHECK(list.Build(kMaterialCount, kTextureCapacity) == 0);
+	CHECK(list.GetStats().candidateCount == 0);
+}
+} // namespace
+
+int main() {
+	TestAdd();
+	TestValidate();
+	TestBuild();
+	return CheckResult();
+}
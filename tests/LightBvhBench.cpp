@@ -0,0 +1,219 @@
+﻿#include "Bench.h"
+#include "Check.h"
+#include "LightBvh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// LightBvhの上位K個の取り出しを全光源の総当たりと比べる（結果の一致と時間）
+// （光源を動かす・消す・入れ直すを挟んでも、木の結果が総当たりと同じであること）
+// 使い方: LightBvhBench [--quick]
+
+namespace {
+using Light = LightBvh::Light;
+using Contribution = LightBvh::Contribution;
+
+// 問い合わせる物体の境界球
+struct Query {
+	float center[3];
+	float radius;
+};
+
+// 光源を散らす（3割がスポットライト）
+std::vector<Light> MakeLights(uint32_t count, float world, std::mt19937& random) {
+	std::uniform_real_distribution<float> position(-world, world);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<Light> lights(count);
+	for (Light& light : lights) {
+		light = {};
+		for (int i = 0; i < 3; i++) {
+			light.position[i] = position(random);
+			light.color[i] = unit(random) * 2.0f;
+		}
+		light.range = 5.0f + unit(random) * 20.0f;
+		light.type =
+		  unit(random) < 0.3f ? LightClusterGrid::kTypeSpot : LightClusterGrid::kTypePoint;
+		float direction[3] = {unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f};
+		float length = std::sqrt(
+		  direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+		for (int i = 0; i < 3; i++) {
+			light.direction[i] = direction[i] / length;
+		}
+		light.cosOuter = 0.5f + unit(random) * 0.4f;
+		light.cosInner = (std::min)(1.0f, light.cosOuter + 0.05f);
+		light.atten[0] = 1.0f;
+		light.atten[1] = unit(random) * 0.2f;
+		light.atten[2] = unit(random) * 0.05f;
+	}
+	return lights;
+}
+
+// 総当たりの上位K個（明るい順）
+uint32_t BruteForceTopK(
+  const std::vector<Light>& lights, const std::vector<bool>& active, const Query& query,
+  uint32_t count, std::vector<Contribution>& all, Contribution* results) {
+	all.clear();
+	for (uint32_t i = 0; i < lights.size(); i++) {
+		if (!active[i]) {
+			continue;
+		}
+		float intensity = LightBvh::EstimateIntensity(lights[i], query.center, query.radius);
+		if (0.0f < intensity) {
+			all.push_back({i, intensity});
+		}
+	}
+	uint32_t found = (std::min)(count, static_cast<uint32_t>(all.size()));
+	std::partial_sort(
+	  all.begin(), all.begin() + found, all.end(),
+	  [](const Contribution& a, const Contribution& b) { return b.intensity < a.intensity; });
+	std::copy_n(all.begin(), found, results);
+	return found;
+}
+
+void Run(uint32_t lightCount, uint32_t queryCount, uint32_t topCount) {
+	std::mt19937 random(lightCount);
+	const float world = 20.0f * std::cbrt(static_cast<float>(lightCount));
+	std::vector<Light> lights = MakeLights(lightCount, world, random);
+	std::vector<bool> active(lightCount, true);
+
+	LightBvh bvh;
+	double buildMilliseconds = MeasureMilliseconds(1, [&]() {
+		for (uint32_t i = 0; i < lightCount; i++) {
+			bvh.Insert(i, lights[i]);
+		}
+	});
+	CHECK(bvh.GetLightCount() == lightCount);
+
+	// 1割ずつ少し動かす（余裕を持たせた箱に収まれば葉の書き換えだけ）
+	std::normal_distribution<float> jitter(0.0f, 0.3f);
+	double updateMilliseconds = MeasureMilliseconds(1, [&]() {
+		for (uint32_t frame = 0; frame < 10; frame++) {
+			for (uint32_t i = frame; i < lightCount; i += 10) {
+				for (int k = 0; k < 3; k++) {
+					lights[i].position[k] += jitter(random);
+				}
+				bvh.Update(i, lights[i]);
+			}
+		}
+	});
+	// 大きく動かす・範囲を変える
+	std::uniform_real_distribution<float> position(-world, world);
+	for (uint32_t i = 3; i < lightCount; i += 50) {
+		lights[i].position[0] = position(random);
+		lights[i].range *= 1.5f;
+		bvh.Update(i, lights[i]);
+	}
+	// 消す・一部を入れ直す
+	for (uint32_t i = 0; i < lightCount; i += 7) {
+		bvh.Remove(i);
+		active[i] = false;
+	}
+	for (uint32_t i = 0; i < lightCount; i += 14) {
+		bvh.Insert(i, lights[i]);
+		active[i] = true;
+	}
+	uint32_t activeCount = static_cast<uint32_t>(std::count(active.begin(), active.end(), true));
+	CHECK(bvh.GetLightCount() == activeCount);
+	for (uint32_t i = 0; i < lightCount; i++) {
+		CHECK(bvh.Contains(i) == active[i]);
+	}
+	// 釣り合いの取れた木の高さ
+	CHECK(bvh.GetHeight() <= 2 * static_cast<uint32_t>(std::log2(lightCount) + 1));
+
+	// 半分は光源の近く、残りは散らした位置
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+	std::vector<Query> queries(queryCount);
+	for (uint32_t q = 0; q < queryCount; q++) {
+		Query& query = queries[q];
+		const Light& nearLight = lights[random() % lightCount];
+		for (int i = 0; i < 3; i++) {
+			query.center[i] =
+			  q % 2 == 0 ? nearLight.position[i] + offset(random) : position(random);
+		}
+		query.radius = 0.5f + unit(random) * 3.0f;
+	}
+
+	// 木
+	std::vector<Contribution> results(queryCount * topCount);
+	std::vector<uint32_t> counts(queryCount);
+	double treeMilliseconds = MeasureMilliseconds(3, [&]() {
+		for (uint32_t q = 0; q < queryCount; q++) {
+			counts[q] = bvh.QueryTopK(
+			  queries[q].center, queries[q].radius, topCount, &results[q * topCount]);
+		}
+	});
+
+	// 総当たり
+	std::vector<Contribution> expected(queryCount * topCount);
+	std::vector<uint32_t> expectedCounts(queryCount);
+	std::vector<Contribution> all;
+	double bruteMilliseconds = MeasureMilliseconds(1, [&]() {
+		for (uint32_t q = 0; q < queryCount; q++) {
+			expectedCounts[q] =
+			  BruteForceTopK(lights, active, queries[q], topCount, all, &expected[q * topCount]);
+		}
+	});
+
+	// 明るさの列が一致すること（同じ明るさの光源は入れ替わってよい）
+	uint32_t mismatches = 0;
+	uint32_t found = 0;
+	std::vector<uint32_t> overlaps;
+	for (uint32_t q = 0; q < queryCount; q++) {
+		found += counts[q];
+		bool match = counts[q] == expectedCounts[q];
+		for (uint32_t k = 0; match && k < counts[q]; k++) {
+			const Contribution& result = results[q * topCount + k];
+			float intensity =
+			  LightBvh::EstimateIntensity(lights[result.id], queries[q].center, queries[q].radius);
+			match = result.intensity == expected[q * topCount + k].intensity &&
+			        active[result.id] && result.intensity == intensity;
+		}
+		mismatches += match ? 0 : 1;
+
+		// 明るさが0より大きい光源は重なりの列挙に必ず入る
+		bvh.QueryOverlaps(queries[q].center, queries[q].radius, overlaps);
+		std::sort(overlaps.begin(), overlaps.end());
+		CHECK(std::adjacent_find(overlaps.begin(), overlaps.end()) == overlaps.end());
+		for (uint32_t k = 0; k < expectedCounts[q]; k++) {
+			uint32_t id = expected[q * topCount + k].id;
+			CHECK(std::binary_search(overlaps.begin(), overlaps.end(), id));
+		}
+	}
+	printf(
+	  "%6u lights (height %u): insert %.2f ms, update %.2f ms | top %u x %u queries: "
+	  "tree %.3f ms (%.2f us/query), brute force %.2f ms (x%.0f), found %u, mismatches %u\n",
+	  lightCount, bvh.GetHeight(), buildMilliseconds, updateMilliseconds, topCount, queryCount,
+	  treeMilliseconds, treeMilliseconds * 1000.0 / queryCount, bruteMilliseconds,
+	  bruteMilliseconds / treeMilliseconds, found, mismatches);
+	CHECK(mismatches == 0);
+	CHECK(0 < found);
+
+	// 全部消せば空になる
+	for (uint32_t i = 0; i < lightCount; i++) {
+		if (active[i]) {
+			bvh.Remove(i);
+		}
+	}
+	CHECK(bvh.GetLightCount() == 0 && bvh.GetHeight() == 0);
+	Contribution none;
+	CHECK(bvh.QueryTopK(queries[0].center, queries[0].radius, 1, &none) == 0);
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	bool quick = IsQuickBench(argc, argv);
+	const uint32_t queryCount = quick ? 200 : 2000;
+	std::vector<uint32_t> lightCounts = {1000, 10000, 100000};
+	if (quick) {
+		lightCounts = {1000, 10000};
+	}
+	for (uint32_t lightCount : lightCounts) {
+		for (uint32_t topCount : {1u, 4u, 8u}) {
+			Run(lightCount, queryCount, topCount);
+		}
+	}
+	return CheckResult();
+}
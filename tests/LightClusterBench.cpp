@@ -0,0 +1,217 @@
+﻿#include "Bench.h"
+#include "Check.h"
+#include "LightClusterGrid.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// LightClusterGrid::Buildの振り分け時間の計測と、振り分けの検証
+// （光源の届く範囲から取った点が、その点を含むクラスタの光源番号リストに必ず入っていること）
+// 使い方: LightClusterBench [--quick]
+
+namespace {
+using Light = LightClusterGrid::Light;
+using Camera = LightClusterGrid::Camera;
+
+// Y軸回りに向きを変えて横に動かしたカメラ（行ベクトル形式のビュー行列）
+Camera MakeCamera() {
+	Camera camera = {};
+	const float angle = 0.6f;
+	const float c = std::cos(angle);
+	const float s = std::sin(angle);
+	const float eye[3] = {-40.0f, 10.0f, -30.0f};
+	// ワールド→ビューは、回転の転置と視点の逆移動
+	camera.view[0][0] = c;
+	camera.view[0][2] = s;
+	camera.view[1][1] = 1.0f;
+	camera.view[2][0] = -s;
+	camera.view[2][2] = c;
+	for (int column = 0; column < 3; column++) {
+		camera.view[3][column] = -(eye[0] * camera.view[0][column] +
+		                           eye[1] * camera.view[1][column] +
+		                           eye[2] * camera.view[2][column]);
+	}
+	camera.view[3][3] = 1.0f;
+	camera.fovAngleY = 0.785f;
+	camera.aspectRatio = 16.0f / 9.0f;
+	camera.nearZ = 0.1f;
+	camera.farZ = 1000.0f;
+	return camera;
+}
+
+// ワールド座標をビュー空間へ
+void ToView(const Camera& camera, const float position[3], float out[3]) {
+	for (int column = 0; column < 3; column++) {
+		out[column] = position[0] * camera.view[0][column] + position[1] * camera.view[1][column] +
+		              position[2] * camera.view[2][column] + camera.view[3][column];
+	}
+}
+
+// 点光源とスポットライトを半々に散らす
+std::vector<Light> MakeLights(uint32_t count, uint32_t seed) {
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<Light> lights(count);
+	for (Light& light : lights) {
+		light = {};
+		light.position[0] = unit(random) * 300.0f;
+		light.position[1] = unit(random) * 100.0f;
+		light.position[2] = (unit(random) + 1.0f) * 400.0f;
+		light.range = 2.0f + (unit(random) + 1.0f) * 8.0f;
+		light.color[0] = light.color[1] = light.color[2] = 1.0f;
+		light.type = random() % 2 ? LightClusterGrid::kTypeSpot : LightClusterGrid::kTypePoint;
+		float direction[3] = {unit(random), unit(random), unit(random)};
+		float length = std::sqrt(
+		  direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+		for (int i = 0; i < 3; i++) {
+			light.direction[i] = direction[i] / length;
+		}
+		light.cosOuter = std::cos(0.2f + (unit(random) + 1.0f) * 0.6f);
+		light.cosInner = 1.0f;
+	}
+	return lights;
+}
+
+// 光源の届く範囲の点が、その点のクラスタに振り分けられているか
+// （ObjClustered.hlsliのFindClusterと同じ求め方でクラスタを決める）
+uint32_t CountMissing(
+  const LightClusterGrid& grid, const Camera& camera, const std::vector<Light>& lights,
+  uint32_t samplesPerLight, uint32_t& checked) {
+	const LightClusterGrid::Settings& settings = grid.GetSettings();
+	const float tanY = std::tan(camera.fovAngleY * 0.5f);
+	const float tanX = tanY * camera.aspectRatio;
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	uint32_t missing = 0;
+	checked = 0;
+	for (uint32_t i = 0; i < lights.size(); i++) {
+		const Light& light = lights[i];
+		for (uint32_t sample = 0; sample < samplesPerLight; sample++) {
+			// 影響範囲の球の中の点
+			float offset[3] = {unit(random), unit(random), unit(random)};
+			float length = std::sqrt(
+			  offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+			if (1.0f < length || length < 1e-4f) {
+				continue;
+			}
+			float point[3];
+			for (int c = 0; c < 3; c++) {
+				point[c] = light.position[c] + offset[c] * light.range;
+			}
+			// スポットライトは円錐の中だけ
+			if (light.type == LightClusterGrid::kTypeSpot) {
+				float cosine = (offset[0] * light.direction[0] + offset[1] * light.direction[1] +
+				                offset[2] * light.direction[2]) /
+				               length;
+				if (cosine < light.cosOuter) {
+					continue;
+				}
+			}
+
+			// 画面内の点だけ
+			float view[3];
+			ToView(camera, point, view);
+			if (view[2] <= camera.nearZ || camera.farZ <= view[2]) {
+				continue;
+			}
+			float tx = view[0] / view[2] / tanX;
+			float ty = view[1] / view[2] / tanY;
+			if (1.0f <= std::fabs(tx) || 1.0f <= std::fabs(ty)) {
+				continue;
+			}
+			uint32_t x = static_cast<uint32_t>((tx * 0.5f + 0.5f) * settings.tilesX);
+			uint32_t y = static_cast<uint32_t>((0.5f - ty * 0.5f) * settings.tilesY);
+			float slice = std::log(view[2]) * grid.GetSliceScale() + grid.GetSliceBias();
+			uint32_t z = static_cast<uint32_t>(
+			  (std::min)((std::max)(slice, 0.0f), static_cast<float>(settings.slices - 1)));
+
+			const LightClusterGrid::Cluster& cluster =
+			  grid.GetClusters()[grid.GetClusterIndex(x, y, z)];
+			const uint32_t* begin = grid.GetIndices().data() + cluster.offset;
+			checked++;
+			if (!std::binary_search(begin, begin + cluster.count, i)) {
+				missing++;
+			}
+		}
+	}
+	return missing;
+}
+
+// 振り分け結果の形（各クラスタの範囲が重ならず並び、番号が昇順）
+void CheckLayout(const LightClusterGrid& grid, uint32_t lightCount) {
+	const std::vector<LightClusterGrid::Cluster>& clusters = grid.GetClusters();
+	const std::vector<uint32_t>& indices = grid.GetIndices();
+	CHECK(clusters.size() == grid.GetClusterCount());
+	uint32_t offset = 0;
+	for (const LightClusterGrid::Cluster& cluster : clusters) {
+		CHECK(cluster.offset == offset);
+		offset += cluster.count;
+		for (uint32_t i = 1; i < cluster.count; i++) {
+			CHECK(indices[cluster.offset + i - 1] < indices[cluster.offset + i]);
+		}
+		if (0 < cluster.count) {
+			CHECK(indices[cluster.offset + cluster.count - 1] < lightCount);
+		}
+	}
+	CHECK(offset == indices.size());
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	bool quick = IsQuickBench(argc, argv);
+	ThreadPool::GetInstance()->Initialize();
+
+	const Camera camera = MakeCamera();
+	LightClusterGrid grid;
+	LightClusterGrid::Settings settings;
+	grid.Initialize(settings);
+
+	std::vector<uint32_t> counts = {256, 1024, 4096, 16384};
+	if (quick) {
+		counts = {256, 2048};
+	}
+	for (uint32_t count : counts) {
+		std::vector<Light> lights = MakeLights(count, count);
+		double milliseconds = MeasureMilliseconds(
+		  quick ? 2 : 20, [&]() { grid.Build(camera, lights.data(), count); });
+
+		uint32_t maxCount = 0;
+		for (const LightClusterGrid::Cluster& cluster : grid.GetClusters()) {
+			maxCount = (std::max)(maxCount, cluster.count);
+		}
+		uint32_t checked = 0;
+		uint32_t missing = CountMissing(grid, camera, lights, quick ? 8 : 32, checked);
+		printf(
+		  "%5u lights: %.3f ms, %zu indices (avg %.2f, max %u per cluster), "
+		  "%u of %u samples missing\n",
+		  count, milliseconds, grid.GetIndices().size(),
+		  static_cast<double>(grid.GetIndices().size()) / grid.GetClusterCount(), maxCount, missing,
+		  checked);
+		CHECK(0 < checked);
+		CHECK(missing == 0);
+		CHECK(grid.GetDroppedCount() == 0);
+		CheckLayout(grid, count);
+	}
+
+	// 光源番号リストが足りなければ捨てた数を数え、範囲の形は保つ
+	settings.maxIndexCount = 500;
+	grid.Initialize(settings);
+	std::vector<Light> lights = MakeLights(1024, 3);
+	grid.Build(camera, lights.data(), 1024);
+	printf("limited: %zu indices, %u dropped\n", grid.GetIndices().size(), grid.GetDroppedCount());
+	CHECK(grid.GetIndices().size() <= settings.maxIndexCount);
+	CHECK(0 < grid.GetDroppedCount());
+	CheckLayout(grid, 1024);
+
+	// 光源が無ければ全クラスタが空
+	grid.Build(camera, nullptr, 0);
+	CHECK(grid.GetIndices().empty());
+	CheckLayout(grid, 0);
+
+	ThreadPool::GetInstance()->Finalize();
+	return CheckResult();
+}
@@ -0,0 +1,241 @@
+﻿#include "Bench.h"
+#include "Check.h"
+#include "DebugShapes.h"
+#include "FramePageAllocator.h"
+#include "LinePageList.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// PrimitiveDrawerの線分バッファ（LinePageList）への書き込み速度の計測と検証
+// （アップロードヒープの代わりにメモリ上のページを、FrameUploadAllocatorと同じ
+// 　FramePageAllocatorで割り当てる。描画は取り出した範囲を数えるだけ）
+// 使い方: LineBench [--quick]
+
+namespace {
+// PrimitiveDrawerと同じ設定
+const uint32_t kLinesPerPage = 16384;
+const uint32_t kVertexCountLine = 2;
+const uint64_t kUploadPageSize = 2 * 1024 * 1024;
+const uint32_t kFrameCount = 2;
+
+struct VertexPosColor {
+	Vector3 pos;
+	Vector4 color;
+};
+
+// PrimitiveDrawerのうちD3Dに依存する部分の代わり
+class LineBuffer {
+  public:
+	LineBuffer() {
+		pageAllocator_.Initialize(kFrameCount, kUploadPageSize);
+		linePages_.Initialize(
+		  kLinesPerPage, sizeof(VertexPosColor) * kVertexCountLine,
+		  [this](uint64_t size, uint64_t& gpuAddress) {
+			  gpuAddress = 0;
+			  return Allocate(size);
+		  });
+	}
+
+	// FrameUploadAllocator::BeginFrameと同じ（GPUは常に完了しているものとする）
+	void BeginFrame() {
+		pageAllocator_.BeginFrame(pageAllocator_.GetRequiredFenceValue(), releasedPages_);
+		for (uint32_t page : releasedPages_) {
+			uploadPages_[page].reset();
+		}
+	}
+
+	// FrameUploadAllocator::EndFrameとPrimitiveDrawer::Resetと同じ
+	void EndFrame() {
+		pageAllocator_.EndFrame(++fenceValue_);
+		lastLineCount_ = lineCount_;
+		lastDrawCallCount_ = drawCallCount_;
+		lineCount_ = 0;
+		drawCallCount_ = 0;
+		linePages_.Reset();
+	}
+
+	// PrimitiveDrawer::DrawLine3dと同じ
+	void DrawLine3d(const Vector3& p1, const Vector3& p2, const Vector4& color) {
+		size_t allocatedCount = 0;
+		VertexPosColor* vertices = AllocateLines(1, allocatedCount);
+		vertices[0] = {p1, color};
+		vertices[1] = {p2, color};
+	}
+
+	// PrimitiveDrawer::DrawLinesと同じ
+	void DrawLines(const Vector3* points, size_t lineCount, const Vector4& color) {
+		while (0 < lineCount) {
+			size_t allocatedCount = 0;
+			VertexPosColor* dest = AllocateLines(lineCount, allocatedCount);
+			for (size_t i = 0; i < allocatedCount * kVertexCountLine; i++) {
+				dest[i].pos = points[i];
+				dest[i].color = color;
+			}
+			points += allocatedCount * kVertexCountLine;
+			lineCount -= allocatedCount;
+		}
+	}
+
+	VertexPosColor* AllocateLines(size_t lineCount, size_t& allocatedCount) {
+		VertexPosColor* vertices =
+		  static_cast<VertexPosColor*>(linePages_.Allocate(lineCount, allocatedCount));
+		lineCount_ += static_cast<uint32_t>(allocatedCount);
+		return vertices;
+	}
+
+	// PrimitiveDrawer::Flushと同じく、ページごとにまだ描いていない範囲を1回で描く
+	void Flush() {
+		if (!linePages_.HasUndrawn()) {
+			return;
+		}
+		linePages_.TakeUndrawn(undrawnPages_);
+		for (const LinePageList::Page& page : undrawnPages_) {
+			CHECK(page.drawnCount < page.lineCount);
+			drawnLineCount_ += page.lineCount - page.drawnCount;
+			drawCallCount_++;
+		}
+	}
+
+	uint32_t GetLineCount() const { return lastLineCount_; }
+	uint32_t GetDrawCallCount() const { return lastDrawCallCount_; }
+	uint64_t GetDrawnLineCount() const { return drawnLineCount_; }
+	uint32_t GetUploadPageCount() const { return pageAllocator_.GetPageCount(); }
+
+	// 書き込んだ頂点（描く前のページだけ）
+	const VertexPosColor* GetPageVertices(size_t page) const {
+		return static_cast<const VertexPosColor*>(linePages_.GetPage(page).vertices);
+	}
+	size_t GetPageCount() const { return linePages_.GetPageCount(); }
+
+  private:
+	// FrameUploadAllocator::Allocateと同じ（バッファはメモリ上に作る）
+	void* Allocate(uint64_t size) {
+		FramePageAllocator::Allocation allocation = pageAllocator_.Allocate(size, 256);
+		if (allocation.isNewPage) {
+			if (uploadPages_.size() <= allocation.page) {
+				uploadPages_.resize(allocation.page + 1);
+			}
+			uploadPages_[allocation.page].reset(
+			  new uint8_t[static_cast<size_t>(pageAllocator_.GetPageCapacity(allocation.page))]);
+		}
+		return uploadPages_[allocation.page].get() + allocation.offset;
+	}
+
+	FramePageAllocator pageAllocator_;
+	std::vector<std::unique_ptr<uint8_t[]>> uploadPages_;
+	std::vector<uint32_t> releasedPages_;
+	uint64_t fenceValue_ = 0;
+	LinePageList linePages_;
+	std::vector<LinePageList::Page> undrawnPages_;
+	uint32_t lineCount_ = 0;
+	uint32_t drawCallCount_ = 0;
+	uint64_t drawnLineCount_ = 0;
+	uint32_t lastLineCount_ = 0;
+	uint32_t lastDrawCallCount_ = 0;
+};
+
+// 1フレーム分を計測する（ページの確保はウォームアップで済ませる）
+template<class Func> double MeasureFrame(LineBuffer& buffer, uint32_t repeat, Func func) {
+	return MeasureMilliseconds(repeat, [&]() {
+		buffer.BeginFrame();
+		func();
+		buffer.Flush();
+		buffer.EndFrame();
+	});
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	bool quick = IsQuickBench(argc, argv);
+	const uint32_t kLineCount = quick ? 40000 : 1000000;
+	const uint32_t kRepeat = quick ? 2 : 10;
+	const uint32_t kExpectedDraws = (kLineCount + kLinesPerPage - 1) / kLinesPerPage;
+
+	std::vector<Vector3> points(kLineCount * kVertexCountLine);
+	for (size_t i = 0; i < points.size(); i++) {
+		points[i] = Vector3(static_cast<float>(i), static_cast<float>(i % 7), 1.0f);
+	}
+	const Vector4 color(1.0f, 0.5f, 0.25f, 1.0f);
+
+	LineBuffer buffer;
+
+	// 1本ずつ
+	double single = MeasureFrame(buffer, kRepeat, [&]() {
+		for (uint32_t i = 0; i < kLineCount; i++) {
+			buffer.DrawLine3d(points[i * 2], points[i * 2 + 1], color);
+		}
+	});
+	CHECK(buffer.GetLineCount() == kLineCount);
+	CHECK(buffer.GetDrawCallCount() == kExpectedDraws);
+	printf(
+	  "DrawLine3d: %u lines %.3f ms (%.0f lines/ms), %u draws\n", kLineCount, single,
+	  kLineCount / single, buffer.GetDrawCallCount());
+
+	// まとめて
+	double bulk = MeasureFrame(
+	  buffer, kRepeat, [&]() { buffer.DrawLines(points.data(), kLineCount, color); });
+	CHECK(buffer.GetLineCount() == kLineCount);
+	CHECK(buffer.GetDrawCallCount() == kExpectedDraws);
+	printf(
+	  "DrawLines: %u lines %.3f ms (%.0f lines/ms), %u draws\n", kLineCount, bulk,
+	  kLineCount / bulk, buffer.GetDrawCallCount());
+
+	// 図形（DrawSphereと同じく作業用の配列に線分を作ってから流し込む）
+	const uint32_t kSegments = 16;
+	const uint32_t kSphereCount = kLineCount / DebugShapes::SphereLineCount(kSegments);
+	std::vector<Vector3> shapePoints(DebugShapes::SphereLineCount(kSegments) * kVertexCountLine);
+	double spheres = MeasureFrame(buffer, kRepeat, [&]() {
+		for (uint32_t i = 0; i < kSphereCount; i++) {
+			Vector3 center(static_cast<float>(i % 100), static_cast<float>(i / 100), 0.0f);
+			uint32_t lineCount = DebugShapes::Sphere(center, 0.5f, kSegments, shapePoints.data());
+			buffer.DrawLines(shapePoints.data(), lineCount, color);
+		}
+	});
+	uint32_t sphereLines = kSphereCount * DebugShapes::SphereLineCount(kSegments);
+	CHECK(buffer.GetLineCount() == sphereLines);
+	printf(
+	  "DrawSphere: %u spheres (%u lines) %.3f ms (%.0f lines/ms), %u draws\n", kSphereCount,
+	  sphereLines, spheres, sphereLines / spheres, buffer.GetDrawCallCount());
+
+	// 同じ量を描き続けても、フレームごとのページは使い回されて増えない
+	uint32_t uploadPages = buffer.GetUploadPageCount();
+	MeasureFrame(buffer, 8, [&]() { buffer.DrawLines(points.data(), kLineCount, color); });
+	CHECK(buffer.GetUploadPageCount() == uploadPages);
+
+	// ページの境目をまたいでも順番どおりに書き込まれる
+	buffer.BeginFrame();
+	const uint32_t kSplitLines = kLinesPerPage + 100;
+	for (uint32_t i = 0; i < 10; i++) {
+		buffer.DrawLine3d(points[i * 2], points[i * 2 + 1], color);
+	}
+	buffer.DrawLines(points.data() + 20, kSplitLines - 10, color);
+	CHECK(buffer.GetPageCount() == 2);
+	for (uint32_t line = 0; line < kSplitLines; line++) {
+		const VertexPosColor* vertices = buffer.GetPageVertices(line / kLinesPerPage);
+		const VertexPosColor& vertex = vertices[(line % kLinesPerPage) * kVertexCountLine + 1];
+		CHECK(vertex.pos.x == points[line * 2 + 1].x);
+		CHECK(vertex.color.y == color.y);
+	}
+	uint64_t drawnLines = buffer.GetDrawnLineCount();
+	buffer.Flush();
+	CHECK(buffer.GetDrawnLineCount() - drawnLines == kSplitLines);
+	// 描いた後は書き込み中のページだけが残る
+	CHECK(buffer.GetPageCount() == 1);
+	// 描いた後に足した線分は書き込み中のページの続きに入り、次のFlushで差分だけ描く
+	buffer.DrawLine3d(points[0], points[1], color);
+	CHECK(buffer.GetPageCount() == 1);
+	buffer.Flush();
+	CHECK(buffer.GetDrawnLineCount() - drawnLines == kSplitLines + 1);
+	// 描くものが無ければ何もしない
+	buffer.Flush();
+	buffer.EndFrame();
+	CHECK(buffer.GetLineCount() == kSplitLines + 1);
+	CHECK(buffer.GetDrawCallCount() == 3);
+	CHECK(buffer.GetPageCount() == 0);
+
+	return CheckResult();
+}
@@ -0,0 +1,110 @@
+﻿#include "Bench.h"
+#include "Check.h"
+#include "MipMapGenerator.h"
+#include "ThreadPool.h"
+#include <DirectXTex.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace DirectX;
+
+// MipMapGeneratorとDirectXTexのGenerateMipMaps（1スレッド）の比較
+// 使い方: MipMapBench [--quick]
+
+namespace {
+// 計測する画像の大きさ（奇数の大きさは3タップの箱型フィルタを通る）
+struct Size {
+	size_t width;
+	size_t height;
+};
+const Size kSizes[] = {{4096, 4096}, {8192, 8192}, {4095, 2047}};
+const Size kQuickSizes[] = {{256, 256}, {255, 127}};
+
+// 模様入りの元画像（なめらかな勾配と細かい縞を混ぜて、フィルタの差が出るようにする）
+void MakeSource(size_t width, size_t height, ScratchImage& image) {
+	HRESULT result = image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, width, height, 1, 1);
+	CHECK(SUCCEEDED(result));
+	const Image* dst = image.GetImage(0, 0, 0);
+	for (size_t y = 0; y < height; y++) {
+		uint8_t* row = dst->pixels + dst->rowPitch * y;
+		for (size_t x = 0; x < width; x++) {
+			row[x * 4 + 0] = static_cast<uint8_t>(x * 255 / width);
+			row[x * 4 + 1] = static_cast<uint8_t>(y * 255 / height);
+			row[x * 4 + 2] = ((x / 3 + y / 5) % 2) ? 230 : 20;
+			row[x * 4 + 3] = 255;
+		}
+	}
+}
+
+// 2つのミップチェーンの最大の差（8bit値）
+int MaxDifference(const ScratchImage& a, const ScratchImage& b) {
+	int result = 0;
+	size_t mipLevels = (std::min)(a.GetMetadata().mipLevels, b.GetMetadata().mipLevels);
+	for (size_t mip = 1; mip < mipLevels; mip++) {
+		const Image* imageA = a.GetImage(mip, 0, 0);
+		const Image* imageB = b.GetImage(mip, 0, 0);
+		if (imageA->width != imageB->width || imageA->height != imageB->height) {
+			return 255;
+		}
+		for (size_t y = 0; y < imageA->height; y++) {
+			const uint8_t* rowA = imageA->pixels + imageA->rowPitch * y;
+			const uint8_t* rowB = imageB->pixels + imageB->rowPitch * y;
+			for (size_t x = 0; x < imageA->width * 4; x++) {
+				result = (std::max)(result, std::abs(rowA[x] - rowB[x]));
+			}
+		}
+	}
+	return result;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	bool quick = IsQuickBench(argc, argv);
+	uint32_t repeat = quick ? 1 : 5;
+	ThreadPool::GetInstance()->Initialize();
+	printf("threads: %u\n", ThreadPool::GetInstance()->GetConcurrency());
+
+	const Size* sizes = quick ? kQuickSizes : kSizes;
+	size_t sizeCount = quick ? _countof(kQuickSizes) : _countof(kSizes);
+	for (size_t i = 0; i < sizeCount; i++) {
+		ScratchImage source;
+		MakeSource(sizes[i].width, sizes[i].height, source);
+
+		// 元の読み込みと同じ呼び出し（sRGB形式なので線形空間で平均される）
+		ScratchImage reference;
+		double referenceTime = MeasureMilliseconds(repeat, [&]() {
+			HRESULT result = GenerateMipMaps(
+			  source.GetImages(), source.GetImageCount(), source.GetMetadata(), TEX_FILTER_BOX, 0,
+			  reference);
+			CHECK(SUCCEEDED(result));
+		});
+
+		ScratchImage box;
+		double boxTime = MeasureMilliseconds(repeat, [&]() {
+			CHECK(SUCCEEDED(MipMapGenerator::Generate(source, box, MipMapGenerator::Filter::kBox)));
+		});
+
+		ScratchImage kaiser;
+		double kaiserTime = MeasureMilliseconds(repeat, [&]() {
+			CHECK(SUCCEEDED(
+			  MipMapGenerator::Generate(source, kaiser, MipMapGenerator::Filter::kKaiser)));
+		});
+
+		// 2の累乗の大きさでは箱型同士は丸め誤差の範囲で一致する
+		// （DirectXTexは前のレベルを8bitに丸めてから縮めるので、深いレベルほど少しずれる）
+		int difference = MaxDifference(reference, box);
+		CHECK(box.GetMetadata().mipLevels == reference.GetMetadata().mipLevels);
+		bool isPowerOfTwo = (sizes[i].width & (sizes[i].width - 1)) == 0 &&
+		                    (sizes[i].height & (sizes[i].height - 1)) == 0;
+		CHECK(!isPowerOfTwo || difference <= 8);
+
+		printf(
+		  "%zux%zu: DirectXTex box %.1f ms, box %.1f ms (x%.1f, max diff %d), kaiser %.1f ms\n",
+		  sizes[i].width, sizes[i].height, referenceTime, boxTime, referenceTime / boxTime,
+		  difference, kaiserTime);
+	}
+
+	ThreadPool::GetInstance()->Finalize();
+	return CheckResult();
+}
@@ -0,0 +1,169 @@
+﻿#include "Check.h"
+#include "PipelineCacheFile.h"
+#include "PipelineHasher.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// パイプラインのキーを作るハッシュ（PipelineHasher）と、キャッシュファイル（PipelineCacheFile）の
+// 検証（版・実行環境のキー・途中で切れたファイル・中身の破損を読み込みで弾くことを確かめる）
+
+namespace {
+// 作業用のファイル（ctestの作業ディレクトリに作って最後に消す）
+const char kCachePath[] = "PipelineCacheTest.bin";
+// ファイルヘッダの大きさと、版の位置（PipelineCacheFile::Headerと同じ並び）
+const size_t kHeaderSize = 32;
+const size_t kVersionOffset = 4;
+
+// ファイルの中身を読み書きする
+std::vector<uint8_t> ReadFile(const char* path) {
+	std::ifstream file(path, std::ios::binary);
+	return std::vector<uint8_t>(
+	  (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const char* path, const std::vector<uint8_t>& bytes) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+// 文字列のハッシュ
+uint64_t HashText(const char* text) { return PipelineHasher::Hash(text, strlen(text)); }
+
+// FNV-1aの値と、加え方による区別
+void TestHasher() {
+	// FNV-1a 64bitの既知の値
+	CHECK(PipelineHasher::Hash(nullptr, 0) == PipelineHasher::kOffsetBasis);
+	CHECK(HashText("a") == 0xaf63dc4c8601ec8cull);
+	CHECK(HashText("foobar") == 0x85944171f73967e8ull);
+
+	// 逐次に加えても一度に加えても同じ
+	PipelineHasher incremental;
+	incremental.AddBytes("foo", 3);
+	incremental.AddBytes("bar", 3);
+	CHECK(incremental.Get() == HashText("foobar"));
+
+	// 長さ付きなら区切りの位置が違えば別の値になる
+	PipelineHasher blockA;
+	blockA.AddBlock("ab", 2);
+	blockA.AddBlock("c", 1);
+	PipelineHasher blockB;
+	blockB.AddBlock("a", 1);
+	blockB.AddBlock("bc", 2);
+	CHECK(blockA.Get() != blockB.Get());
+
+	// nullptrと空文字列は区別する
+	PipelineHasher nullText;
+	nullText.AddString(nullptr);
+	PipelineHasher emptyText;
+	emptyText.AddString("");
+	CHECK(nullText.Get() != emptyText.Get());
+	PipelineHasher sameText;
+	sameText.AddString("POSITION");
+	PipelineHasher sameBlock;
+	sameBlock.AddBlock("POSITION", 8);
+	CHECK(sameText.Get() == sameBlock.Get());
+
+	// -0と0は同じ値、それ以外の値は区別する
+	PipelineHasher zero;
+	zero.AddFloat(0.0f);
+	PipelineHasher negativeZero;
+	negativeZero.AddFloat(-0.0f);
+	PipelineHasher one;
+	one.AddFloat(1.0f);
+	CHECK(zero.Get() == negativeZero.Get());
+	CHECK(zero.Get() != one.Get());
+
+	// 整数は幅も含めて区別する
+	PipelineHasher narrow;
+	narrow.AddUint32(1);
+	PipelineHasher wide;
+	wide.AddUint64(1);
+	CHECK(narrow.Get() != wide.Get());
+}
+
+// 保存したものはそのまま読め、条件が違うものは弾く
+void TestCacheFile() {
+	const uint64_t kDeviceKey = 0x123456789abcdefull;
+	std::vector<uint8_t> blob(1000);
+	for (size_t i = 0; i < blob.size(); i++) {
+		blob[i] = static_cast<uint8_t>(i * 7 + 3);
+	}
+
+	// 無いファイル
+	std::remove(kCachePath);
+	std::vector<uint8_t> data = {1, 2, 3};
+	CHECK(!PipelineCacheFile::Load(kCachePath, kDeviceKey, data));
+	CHECK(data.empty());
+
+	// 保存して読み直す
+	CHECK(PipelineCacheFile::Save(kCachePath, kDeviceKey, blob.data(), blob.size()));
+	CHECK(PipelineCacheFile::Load(kCachePath, kDeviceKey, data));
+	CHECK(data == blob);
+	const std::vector<uint8_t> saved = ReadFile(kCachePath);
+	CHECK(saved.size() == kHeaderSize + blob.size());
+
+	// 実行環境（アダプタやドライバ）が違う
+	CHECK(!PipelineCacheFile::Load(kCachePath, kDeviceKey + 1, data));
+	CHECK(data.empty());
+
+	// 版が違う
+	std::vector<uint8_t> bytes = saved;
+	uint32_t version = PipelineCacheFile::kVersion + 1;
+	memcpy(&bytes[kVersionOffset], &version, sizeof(version));
+	WriteFile(kCachePath, bytes);
+	CHECK(!PipelineCacheFile::Load(kCachePath, kDeviceKey, data));
+
+	// 識別子が違う
+	bytes = saved;
+	bytes[0] = 'X';
+	WriteFile(kCachePath, bytes);
+	CHECK(!PipelineCacheFile::Load(kCachePath, kDeviceKey, data));
+
+	// 書き込み途中で終わった（ヘッダの途中・データの途中・空）
+	const size_t kTruncatedSizes[] = {
+	  0, 1, kHeaderSize - 1, kHeaderSize, kHeaderSize + 1, saved.size() / 2, saved.size() - 1};
+	for (size_t size : kTruncatedSizes) {
+		bytes.assign(saved.begin(), saved.begin() + size);
+		WriteFile(kCachePath, bytes);
+		CHECK(!PipelineCacheFile::Load(kCachePath, kDeviceKey, data));
+		CHECK(data.empty());
+	}
+
+	// 後ろに余計なものが付いている
+	bytes = saved;
+	bytes.push_back(0);
+	WriteFile(kCachePath, bytes);
+	CHECK(!PipelineCacheFile::Load(kCachePath, kDeviceKey, data));
+
+	// 長さは合っているが中身が壊れている
+	for (size_t offset : {kHeaderSize, kHeaderSize + blob.size() / 2, saved.size() - 1}) {
+		bytes = saved;
+		bytes[offset] ^= 0x40;
+		WriteFile(kCachePath, bytes);
+		CHECK(!PipelineCacheFile::Load(kCachePath, kDeviceKey, data));
+		CHECK(data.empty());
+	}
+
+	// 空のデータも保存して読める
+	CHECK(PipelineCacheFile::Save(kCachePath, kDeviceKey, nullptr, 0));
+	CHECK(PipelineCacheFile::Load(kCachePath, kDeviceKey, data));
+	CHECK(data.empty());
+
+	// 上書き保存すると前の中身は残らない
+	CHECK(PipelineCacheFile::Save(kCachePath, kDeviceKey, blob.data(), 10));
+	CHECK(PipelineCacheFile::Load(kCachePath, kDeviceKey, data));
+	CHECK(data.size() == 10 && memcmp(data.data(), blob.data(), 10) == 0);
+
+	std::remove(kCachePath);
+}
+} // namespace
+
+int main() {
+	TestHasher();
+	TestCacheFile();
+	return CheckResult();
+}
@@ -0,0 +1,234 @@
+﻿#include "Bench.h"
+#include "Check.h"
+#include "RenderCommandRecorder.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// 描画コマンドの記録用バックエンド（RenderCommandRecorder）の検証と記録速度の計測
+// （統計の数え方と、記録したものを別の記録先へ流すとバイト列がそのまま再現されることを確かめ、
+// 　モデルの描画と同じ並びのコマンドを1描画あたり何ナノ秒で記録できるかを測る）
+// 使い方: RenderCommandBench [--quick]
+
+namespace {
+// バックエンドのオブジェクトの代わり（記録用のバックエンドは値として持つだけで参照しない）
+template<class T> T* FakeHandle(uintptr_t value) { return reinterpret_cast<T*>(value); }
+
+// 統計が同じか
+bool EqualStats(const RenderCommandRecorder::Stats& a, const RenderCommandRecorder::Stats& b) {
+	return a.commandCount == b.commandCount && a.drawCount == b.drawCount &&
+	       a.vertexCount == b.vertexCount && a.instanceCount == b.instanceCount &&
+	       a.pipelineChanges == b.pipelineChanges &&
+	       a.rootSignatureChanges == b.rootSignatureChanges &&
+	       a.descriptorHeapChanges == b.descriptorHeapChanges &&
+	       a.rootArgumentChanges == b.rootArgumentChanges &&
+	       a.bufferBindings == b.bufferBindings && a.redundantChanges == b.redundantChanges &&
+	       a.indirectCount == b.indirectCount && a.indirectCommandCount == b.indirectCommandCount;
+}
+
+// 記録したバイト列が同じか
+bool EqualStream(const RenderCommandRecorder& a, const RenderCommandRecorder& b) {
+	return a.GetSize() == b.GetSize() && memcmp(a.GetData(), b.GetData(), a.GetSize()) == 0;
+}
+
+// 状態の切り替えと重複の数え方
+void TestStats() {
+	RenderPipeline* pipelineA = FakeHandle<RenderPipeline>(0x100);
+	RenderPipeline* pipelineB = FakeHandle<RenderPipeline>(0x200);
+	RenderRootSignature* rootSignatureA = FakeHandle<RenderRootSignature>(0x300);
+	RenderRootSignature* rootSignatureB = FakeHandle<RenderRootSignature>(0x400);
+	RenderDescriptorHeap* heap = FakeHandle<RenderDescriptorHeap>(0x500);
+
+	RenderCommandRecorder recorder;
+	CHECK(recorder.GetSize() == 0);
+
+	// 同じ値をもう一度設定すると重複として数え、切り替えには数えない
+	recorder.SetPipelineState(pipelineA);
+	recorder.SetPipelineState(pipelineA);
+	recorder.SetPipelineState(pipelineB);
+	recorder.SetGraphicsRootSignature(rootSignatureA);
+	recorder.SetGraphicsRootSignature(rootSignatureA);
+	recorder.SetDescriptorHeap(heap);
+	recorder.SetDescriptorHeap(heap);
+	CHECK(recorder.GetStats().pipelineChanges == 2);
+	CHECK(recorder.GetStats().rootSignatureChanges == 1);
+	CHECK(recorder.GetStats().descriptorHeapChanges == 1);
+	CHECK(recorder.GetStats().redundantChanges == 3);
+
+	// ルートパラメータは番号ごとに調べ、ルートシグネチャを変えると未設定に戻る
+	recorder.SetGraphicsRootConstantBufferView(0, 0x10000);
+	recorder.SetGraphicsRootConstantBufferView(0, 0x10000);
+	recorder.SetGraphicsRootConstantBufferView(1, 0x10000);
+	CHECK(recorder.GetStats().redundantChanges == 4);
+	recorder.SetGraphicsRootSignature(rootSignatureB);
+	recorder.SetGraphicsRootConstantBufferView(0, 0x10000);
+	CHECK(recorder.GetStats().redundantChanges == 4);
+	CHECK(recorder.GetStats().rootArgumentChanges == 4);
+
+	// ルート定数は同じ中身でも重複に数えない
+	const uint32_t constants[4] = {1, 2, 3, 4};
+	recorder.SetGraphicsRoot32BitConstants(2, 4, constants, 0);
+	recorder.SetGraphicsRoot32BitConstants(2, 4, constants, 0);
+	CHECK(recorder.GetStats().redundantChanges == 4);
+	CHECK(recorder.GetStats().rootArgumentChanges == 6);
+
+	// 間接描画の後はルートパラメータが不定になる
+	recorder.SetGraphicsRootDescriptorTable(3, 0x20000);
+	recorder.ExecuteIndirect(
+	  FakeHandle<RenderCommandSignature>(0x600), 12, FakeHandle<RenderBuffer>(0x700), 256,
+	  nullptr, 0);
+	recorder.SetGraphicsRootDescriptorTable(3, 0x20000);
+	CHECK(recorder.GetStats().redundantChanges == 4);
+	CHECK(recorder.GetStats().indirectCount == 1);
+	CHECK(recorder.GetStats().indirectCommandCount == 12);
+
+	// トポロジとバッファの設定、描画の頂点数
+	RenderVertexBufferView vertexBuffer;
+	vertexBuffer.address = 0x30000;
+	vertexBuffer.size = 1024;
+	vertexBuffer.stride = 32;
+	RenderIndexBufferView indexBuffer;
+	indexBuffer.address = 0x40000;
+	indexBuffer.size = 72;
+	recorder.SetPrimitiveTopology(RenderTopology::kTriangleList);
+	recorder.SetPrimitiveTopology(RenderTopology::kTriangleList);
+	recorder.SetVertexBuffers(0, 1, &vertexBuffer);
+	recorder.SetIndexBuffer(indexBuffer);
+	recorder.DrawIndexedInstanced(36, 2, 0, 0, 0);
+	recorder.DrawInstanced(3, 1, 0, 0);
+	const RenderCommandRecorder::Stats& stats = recorder.GetStats();
+	CHECK(stats.redundantChanges == 5);
+	CHECK(stats.bufferBindings == 4);
+	CHECK(stats.drawCount == 2);
+	CHECK(stats.vertexCount == 36 * 2 + 3);
+	CHECK(stats.instanceCount == 3);
+	CHECK(stats.commandCount == 23);
+
+	// 捨てると統計も設定中の状態も戻る
+	recorder.Clear();
+	CHECK(recorder.GetSize() == 0);
+	CHECK(recorder.GetStats().commandCount == 0);
+	recorder.SetPipelineState(pipelineB);
+	CHECK(recorder.GetStats().pipelineChanges == 1);
+	CHECK(recorder.GetStats().redundantChanges == 0);
+}
+
+// 全種類のコマンドを流す
+void RecordAllCommands(RenderCommandList& list, uint32_t seed) {
+	list.SetPipelineState(FakeHandle<RenderPipeline>(0x1000 + seed));
+	list.SetGraphicsRootSignature(FakeHandle<RenderRootSignature>(0x2000 + seed));
+	list.SetDescriptorHeap(FakeHandle<RenderDescriptorHeap>(0x3000));
+	list.SetPrimitiveTopology(seed % 2 ? RenderTopology::kLineList : RenderTopology::kTriangleList);
+
+	RenderVertexBufferView vertexBuffers[3];
+	for (uint32_t i = 0; i < 3; i++) {
+		vertexBuffers[i].address = 0x100000 + seed * 0x1000 + i * 0x100;
+		vertexBuffers[i].size = 256 * (i + 1);
+		vertexBuffers[i].stride = 16 + i * 8;
+	}
+	list.SetVertexBuffers(seed % 3, 1 + seed % 3, vertexBuffers);
+
+	RenderIndexBufferView indexBuffer;
+	indexBuffer.address = 0x200000 + seed * 0x100;
+	indexBuffer.size = 6 * (seed + 1);
+	indexBuffer.format = seed % 2 ? RenderIndexFormat::kUint32 : RenderIndexFormat::kUint16;
+	list.SetIndexBuffer(indexBuffer);
+
+	list.SetGraphicsRootConstantBufferView(0, 0x300000 + seed * 256);
+	list.SetGraphicsRootShaderResourceView(1, 0x400000 + seed * 256);
+	list.SetGraphicsRootDescriptorTable(2, 0x500000 + seed * 32);
+	uint32_t constants[8];
+	for (uint32_t i = 0; i < 8; i++) {
+		constants[i] = seed * 8 + i;
+	}
+	list.SetGraphicsRoot32BitConstants(3, 1 + seed % 8, constants, seed % 4);
+	list.DrawInstanced(3 + seed, 1 + seed % 4, seed, seed % 5);
+	list.DrawIndexedInstanced(6 * (seed + 1), 1, seed, -static_cast<int32_t>(seed), 0);
+	list.ExecuteIndirect(
+	  FakeHandle<RenderCommandSignature>(0x4000), seed, FakeHandle<RenderBuffer>(0x5000),
+	  seed * 80, seed % 2 ? FakeHandle<RenderBuffer>(0x6000) : nullptr, seed * 4);
+}
+
+// 別の記録先へ流すとバイト列と統計がそのまま再現される
+void TestReplay() {
+	RenderCommandRecorder source;
+	for (uint32_t seed = 0; seed < 50; seed++) {
+		RecordAllCommands(source, seed);
+	}
+	CHECK(source.GetStats().commandCount == 50 * 13);
+
+	RenderCommandRecorder copy;
+	source.Replay(copy);
+	CHECK(EqualStream(source, copy));
+	CHECK(EqualStats(source.GetStats(), copy.GetStats()));
+
+	// 流し直しても変わらない
+	RenderCommandRecorder again;
+	copy.Replay(again);
+	CHECK(EqualStream(source, again));
+
+	// 空の記録は何も流さない
+	RenderCommandRecorder empty;
+	empty.Replay(again);
+	CHECK(EqualStream(source, again));
+}
+
+// モデルの描画と同じ並び（ワールド行列・テクスチャ・頂点・インデックスを設定して描く）
+void RecordDraws(RenderCommandList& list, uint32_t drawCount) {
+	RenderVertexBufferView vertexBuffer;
+	vertexBuffer.size = 24 * 32;
+	vertexBuffer.stride = 32;
+	RenderIndexBufferView indexBuffer;
+	indexBuffer.size = 36 * 2;
+	list.SetPipelineState(FakeHandle<RenderPipeline>(0x100));
+	list.SetGraphicsRootSignature(FakeHandle<RenderRootSignature>(0x200));
+	list.SetPrimitiveTopology(RenderTopology::kTriangleList);
+	list.SetGraphicsRootConstantBufferView(1, 0x8000);
+	for (uint32_t i = 0; i < drawCount; i++) {
+		// モデルは16種類を順に描く
+		uint32_t model = i % 16;
+		vertexBuffer.address = 0x100000 + model * 0x1000;
+		indexBuffer.address = 0x200000 + model * 0x100;
+		list.SetGraphicsRootConstantBufferView(0, 0x10000000 + uint64_t(i) * 256);
+		list.SetGraphicsRootDescriptorTable(3, 0x300000 + model * 32);
+		list.SetVertexBuffers(0, 1, &vertexBuffer);
+		list.SetIndexBuffer(indexBuffer);
+		list.DrawIndexedInstanced(36, 1, 0, 0, 0);
+	}
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	TestStats();
+	TestReplay();
+
+	bool quick = IsQuickBench(argc, argv);
+	const uint32_t kDrawCount = quick ? 1000 : 10000;
+	const uint32_t kRepeat = quick ? 2 : 50;
+
+	// 記録（バイト列の領域はClearで残るので、2回目以降は確保しない）
+	RenderCommandRecorder recorder;
+	double record = MeasureMilliseconds(kRepeat, [&]() {
+		recorder.Clear();
+		RecordDraws(recorder, kDrawCount);
+	});
+	CHECK(recorder.GetStats().drawCount == kDrawCount);
+	CHECK(recorder.GetStats().commandCount == 4 + kDrawCount * 5);
+	printf(
+	  "record: %u draws %.3f ms (%.1f ns/draw, %.1f bytes/draw)\n", kDrawCount, record,
+	  record * 1e6 / kDrawCount, static_cast<double>(recorder.GetSize()) / kDrawCount);
+
+	// 別の記録先へ流す
+	RenderCommandRecorder replayed;
+	double replay = MeasureMilliseconds(kRepeat, [&]() {
+		replayed.Clear();
+		recorder.Replay(replayed);
+	});
+	CHECK(EqualStream(recorder, replayed));
+	CHECK(EqualStats(recorder.GetStats(), replayed.GetStats()));
+	printf(
+	  "replay: %u draws %.3f ms (%.1f ns/draw)\n", kDrawCount, replay,
+	  replay * 1e6 / kDrawCount);
+
+	return CheckResult();
+}
@@ -0,0 +1,177 @@
+﻿#include "Bench.h"
+#include "Check.h"
+#include "SdfFontAtlas.h"
+#include "SdfGenerator.h"
+#include "ThreadPool.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// 距離場の生成時間と品質（元の形との不一致率）の計測と、距離場フォントアトラスの検証
+// （DebugTextと同じ9x18の等幅ビットマップフォントの升目を、合成した字形で作って使う）
+// 使い方: SdfFontBench [--quick]
+
+namespace {
+// DebugTextのフォントと同じ升目
+const uint32_t kCellWidth = 9;
+const uint32_t kCellHeight = 18;
+const uint32_t kCellsPerRow = 14;
+
+// 輪と角の混ざった被覆率画像
+std::vector<uint8_t> MakeShape(uint32_t size) {
+	std::vector<uint8_t> coverage(size * size);
+	const float center = size * 0.5f;
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			float dx = x + 0.5f - center;
+			float dy = y + 0.5f - center;
+			float r = sqrtf(dx * dx + dy * dy);
+			bool ring = size * 0.15f <= r && r < size * 0.3f;
+			bool box = size * 0.78f < x && y < size * 0.23f;
+			coverage[y * size + x] = (ring || box) ? 255 : 0;
+		}
+	}
+	return coverage;
+}
+
+// 合成したビットマップフォント（RGBA8、文字ごとに違う縞と斜めの画）
+std::vector<uint8_t> MakeBitmapFont(uint32_t& width, uint32_t& height) {
+	width = kCellWidth * kCellsPerRow;
+	height = kCellHeight * 7;
+	std::vector<uint8_t> rgba(width * height * 4, 0);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			uint32_t cellX = x % kCellWidth;
+			uint32_t cellY = y % kCellHeight;
+			uint32_t index = (y / kCellHeight) * kCellsPerRow + x / kCellWidth;
+			bool inside =
+			  0 < cellX && cellX < kCellWidth - 1 && 2 < cellY && cellY < kCellHeight - 2;
+			// 先頭（空白）は何も描かない
+			bool on = 0 < index && inside && (cellX + cellY + index) % 5 < 2;
+			uint8_t* pixel = &rgba[(y * width + x) * 4];
+			pixel[0] = pixel[1] = pixel[2] = 255;
+			pixel[3] = on ? 255 : 0;
+		}
+	}
+	return rgba;
+}
+
+// 縮小率ごとの生成時間と不一致率
+void BenchGenerator(bool quick) {
+	const uint32_t kSize = quick ? 128 : 512;
+	const uint32_t kSpread = 4;
+	std::vector<uint8_t> coverage = MakeShape(kSize);
+
+	for (uint32_t downscale : {1u, 2u, 4u, 8u}) {
+		SdfGenerator::Result result;
+		double milliseconds = MeasureMilliseconds(quick ? 1 : 5, [&]() {
+			SdfGenerator::Generate(coverage.data(), kSize, kSize, downscale, kSpread, result);
+		});
+		float error =
+		  SdfGenerator::MeasureError(coverage.data(), kSize, kSize, downscale, result);
+		printf(
+		  "generate %ux%u / %u: %ux%u %.3f ms, error %.4f\n", kSize, kSize, downscale,
+		  result.width, result.height, milliseconds, static_cast<double>(error));
+
+		// 出力は縮小した大きさに余白を足したもの
+		CHECK(result.padding == kSpread);
+		CHECK(result.width == (kSize + downscale - 1) / downscale + kSpread * 2);
+		CHECK(result.pixels.size() == result.width * result.height);
+		// 縮小しても輪郭はほとんど崩れない
+		CHECK(error < (downscale <= 4 ? 0.01f : 0.02f));
+
+		// 輪の内側（穴）と外は0.5未満、輪の上は0.5以上
+		auto sample = [&](float x, float y) {
+			uint32_t px = static_cast<uint32_t>(x / downscale) + result.padding;
+			uint32_t py = static_cast<uint32_t>(y / downscale) + result.padding;
+			return result.pixels[py * result.width + px];
+		};
+		const float center = kSize * 0.5f;
+		CHECK(sample(center, center) < 128);
+		CHECK(sample(center + kSize * 0.225f, center) >= 128);
+		CHECK(sample(1.0f, kSize - 1.0f) < 128);
+		// 輪郭から離れるほど値は端に寄る
+		CHECK(sample(1.0f, kSize - 1.0f) <= sample(center - kSize * 0.35f, center));
+	}
+}
+
+// フォントアトラスの生成時間と配置
+void BenchFontAtlas(bool quick) {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	std::vector<uint8_t> rgba = MakeBitmapFont(width, height);
+
+	const uint32_t kUpscale = 8;
+	SdfFontAtlas::Settings settings;
+	settings.downscale = 2;
+	settings.spread = 3;
+
+	SdfFontAtlas atlas;
+	double milliseconds = MeasureMilliseconds(quick ? 1 : 5, [&]() {
+		bool built = atlas.Build(
+		  SdfFontAtlas::CreateBitmapFontSource(
+		    rgba.data(), width, height, width * 4, kCellWidth, kCellHeight, kCellsPerRow,
+		    kUpscale),
+		  settings);
+		CHECK(built);
+	});
+
+	const SdfFontAtlas::Stats& stats = atlas.GetStats();
+	printf(
+	  "font atlas: %u glyphs, %ux%u, %.2f ms (rasterize %.2f, generate %.2f, pack %.2f), "
+	  "error avg %.4f max %.4f, occupancy %.2f\n",
+	  stats.glyphCount, atlas.GetWidth(), atlas.GetHeight(), milliseconds,
+	  stats.rasterizeMilliseconds, stats.generateMilliseconds, stats.packMilliseconds,
+	  static_cast<double>(stats.averageError), static_cast<double>(stats.maxError),
+	  static_cast<double>(stats.occupancy));
+
+	CHECK(stats.glyphCount == settings.lastCode - settings.firstCode + 1);
+	CHECK(stats.maxError < 0.05f);
+	CHECK(0.0f < stats.occupancy && stats.occupancy <= 1.0f);
+	CHECK(atlas.GetPixels().size() == atlas.GetWidth() * atlas.GetHeight());
+	CHECK(atlas.GetSpread() == settings.spread);
+	CHECK(atlas.GetLineHeight() == static_cast<float>(kCellHeight * kUpscale / 2));
+	CHECK(atlas.Find(settings.firstCode - 1) == nullptr);
+	CHECK(atlas.Find(settings.lastCode + 1) == nullptr);
+
+	// グリフはアトラス内に収まり、互いに重ならない
+	struct Rect {
+		float left, top, right, bottom;
+	};
+	std::vector<Rect> rects;
+	const float advance = static_cast<float>(kCellWidth * kUpscale / 2);
+	for (uint32_t code = settings.firstCode; code <= settings.lastCode; code++) {
+		const SdfFontAtlas::Glyph* glyph = atlas.Find(code);
+		CHECK(glyph != nullptr);
+		if (!glyph) {
+			continue;
+		}
+		CHECK(glyph->advance == advance);
+		CHECK(0.0f <= glyph->uvRect[0] && glyph->uvRect[2] <= 1.0f);
+		CHECK(0.0f <= glyph->uvRect[1] && glyph->uvRect[3] <= 1.0f);
+		Rect rect = {
+		  glyph->uvRect[0] * atlas.GetWidth(), glyph->uvRect[1] * atlas.GetHeight(),
+		  glyph->uvRect[2] * atlas.GetWidth(), glyph->uvRect[3] * atlas.GetHeight()};
+		// 矩形の大きさはuv範囲と一致する
+		CHECK(fabsf((rect.right - rect.left) - glyph->size[0]) < 0.01f);
+		CHECK(fabsf((rect.bottom - rect.top) - glyph->size[1]) < 0.01f);
+		for (const Rect& other : rects) {
+			bool overlap = rect.left < other.right - 0.01f && other.left < rect.right - 0.01f &&
+			               rect.top < other.bottom - 0.01f && other.top < rect.bottom - 0.01f;
+			CHECK(!overlap);
+		}
+		rects.push_back(rect);
+	}
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	bool quick = IsQuickBench(argc, argv);
+	ThreadPool::GetInstance()->Initialize();
+
+	BenchGenerator(quick);
+	BenchFontAtlas(quick);
+
+	ThreadPool::GetInstance()->Finalize();
+	return CheckResult();
+}
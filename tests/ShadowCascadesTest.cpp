@@ -0,0 +1,183 @@
+﻿#include "Check.h"
+#include "ShadowCascades.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// ShadowCascadesの分割位置・正射影の当てはめ・投影物の振り分けの検証
+// （カメラを動かし回しながら、分割の視錐台がシャドウマップに収まること、安定化した当てはめで
+// 　大きさが変わらずテクセル単位に揃うこと、範囲に入る投影物が漏れないことを確かめる）
+
+using namespace MathUtility;
+
+namespace {
+using Camera = ShadowCascades::Camera;
+using Cascade = ShadowCascades::Cascade;
+
+// 位置と注視点からカメラを作る
+Camera MakeCamera(const Vector3& eye, const Vector3& target) {
+	Camera camera;
+	camera.matView = Matrix4LookAtLH(eye, target, Vector3(0.0f, 1.0f, 0.0f));
+	camera.fovAngleY = 0.785f;
+	camera.aspectRatio = 16.0f / 9.0f;
+	camera.nearZ = 0.1f;
+	camera.farZ = 1000.0f;
+	return camera;
+}
+
+// 正射影後の座標がシャドウマップの範囲内か
+bool IsInside(const Vector3& p, float epsilon) {
+	return -1.0f - epsilon <= p.x && p.x <= 1.0f + epsilon && -1.0f - epsilon <= p.y &&
+	       p.y <= 1.0f + epsilon && -epsilon <= p.z && p.z <= 1.0f + epsilon;
+}
+
+// 分割ごとの視錐台の8隅がその分割のシャドウマップに収まっているか
+void CheckContains(const ShadowCascades& cascades, const Camera& camera) {
+	const float tanY = std::tan(camera.fovAngleY * 0.5f);
+	const float tanX = tanY * camera.aspectRatio;
+
+	// ビュー行列（回転と移動のみ）からカメラの軸と位置を取り出す
+	const float(*m)[4] = camera.matView.m;
+	const Vector3 axisX(m[0][0], m[1][0], m[2][0]);
+	const Vector3 axisY(m[0][1], m[1][1], m[2][1]);
+	const Vector3 axisZ(m[0][2], m[1][2], m[2][2]);
+	const Vector3 eye = Vector3Zero() - (axisX * m[3][0] + axisY * m[3][1] + axisZ * m[3][2]);
+
+	for (uint32_t c = 0; c < cascades.GetCascadeCount(); c++) {
+		const Cascade& cascade = cascades.GetCascade(c);
+		for (int corner = 0; corner < 8; corner++) {
+			float z = (corner & 4) ? cascade.splitFar : cascade.splitNear;
+			float x = ((corner & 1) ? tanX : -tanX) * z;
+			float y = ((corner & 2) ? tanY : -tanY) * z;
+			Vector3 world = eye + axisX * x + axisY * y + axisZ * z;
+			CHECK(IsInside(Vector3Transform(world, cascade.matViewProjection), 1e-4f));
+		}
+	}
+}
+
+// 分割位置
+void TestSplits() {
+	float splits[ShadowCascades::kMaxCascadeCount + 1];
+
+	// 等間隔
+	ShadowCascades::ComputeSplits(0.1f, 200.0f, 4, 0.0f, splits);
+	CHECK(splits[0] == 0.1f && splits[4] == 200.0f);
+	CHECK(std::fabs(splits[1] - 50.075f) < 1e-3f);
+
+	// 対数（中央は手前と奥の相乗平均）
+	ShadowCascades::ComputeSplits(0.1f, 200.0f, 4, 1.0f, splits);
+	CHECK(std::fabs(splits[2] - std::sqrt(0.1f * 200.0f)) < 1e-3f);
+
+	// 混合は両者の間で、単調に増える
+	float uniform[ShadowCascades::kMaxCascadeCount + 1];
+	float logarithmic[ShadowCascades::kMaxCascadeCount + 1];
+	ShadowCascades::ComputeSplits(0.1f, 200.0f, 4, 0.0f, uniform);
+	ShadowCascades::ComputeSplits(0.1f, 200.0f, 4, 1.0f, logarithmic);
+	ShadowCascades::ComputeSplits(0.1f, 200.0f, 4, 0.75f, splits);
+	for (int i = 0; i < 4; i++) {
+		CHECK(splits[i] < splits[i + 1]);
+		CHECK(logarithmic[i] <= splits[i] + 1e-4f && splits[i] <= uniform[i] + 1e-4f);
+	}
+	printf(
+	  "splits: %.2f %.2f %.2f %.2f %.2f\n", splits[0], splits[1], splits[2], splits[3], splits[4]);
+}
+
+// カメラを動かしたときの当てはめ
+void TestFit(bool stabilize) {
+	const Vector3 lightDir(0.3f, -1.0f, 0.2f);
+	const Vector3 sceneMin(-300.0f, -10.0f, -300.0f);
+	const Vector3 sceneMax(300.0f, 50.0f, 300.0f);
+
+	ShadowCascades cascades;
+	ShadowCascades::Settings settings;
+	settings.stabilize = stabilize;
+	cascades.Initialize(settings);
+
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	float previousWidth[ShadowCascades::kMaxCascadeCount] = {};
+	uint32_t sizeChanges = 0;
+	for (uint32_t frame = 0; frame < 200; frame++) {
+		float angle = frame * 0.013f;
+		Vector3 eye(unit(random) * 50.0f, 5.0f + unit(random) * 5.0f, unit(random) * 50.0f);
+		Camera camera = MakeCamera(eye, eye + Vector3(std::sin(angle), -0.2f, std::cos(angle)));
+		cascades.Update(camera, lightDir, sceneMin, sceneMax);
+		CheckContains(cascades, camera);
+
+		for (uint32_t c = 0; c < cascades.GetCascadeCount(); c++) {
+			const Cascade& cascade = cascades.GetCascade(c);
+			float width = cascade.right - cascade.left;
+			CHECK(cascade.nearZ <= cascade.farZ);
+			// 長い辺がシャドウマップの解像度分のテクセル（端を揃えた分の2テクセルまで広がる）
+			float extent = (std::max)(width, cascade.top - cascade.bottom) / cascade.texelSize;
+			CHECK(settings.resolution - 1e-2f <= extent && extent <= settings.resolution + 2.01f);
+			if (0 < c) {
+				CHECK(cascades.GetCascade(c - 1).splitFar == cascade.splitNear);
+			}
+			if (stabilize) {
+				// 境界球で当てはめるので正方形で、位置はテクセル単位に揃う
+				CHECK(std::fabs((cascade.top - cascade.bottom) - width) < 1e-3f * width);
+				float texels = (cascade.left + width * 0.5f) / cascade.texelSize;
+				CHECK(std::fabs(texels - std::round(texels)) < 1e-2f);
+			}
+			if (0 < frame && 1e-3f * width < std::fabs(width - previousWidth[c])) {
+				sizeChanges++;
+			}
+			previousWidth[c] = width;
+		}
+	}
+	printf(
+	  "stabilize %d: %u size changes in 200 frames, cascade 0 width %.2f (texel %.4f)\n",
+	  stabilize ? 1 : 0, sizeChanges,
+	  static_cast<double>(cascades.GetCascade(0).right - cascades.GetCascade(0).left),
+	  static_cast<double>(cascades.GetCascade(0).texelSize));
+	// 安定化すると回転しても大きさが変わらない
+	if (stabilize) {
+		CHECK(sizeChanges == 0);
+	}
+	CHECK(cascades.GetCascade(cascades.GetCascadeCount() - 1).splitFar <= settings.maxDistance);
+
+	// 投影物の振り分け（球の中の点がシャドウマップに入るなら、その分割に入っていること）
+	Camera camera = MakeCamera(Vector3(0.0f, 10.0f, 0.0f), Vector3(0.0f, 5.0f, 30.0f));
+	cascades.Update(camera, lightDir, sceneMin, sceneMax);
+	const uint32_t kCasterCount = 20000;
+	std::vector<ShadowCascades::Sphere> casters(kCasterCount);
+	for (ShadowCascades::Sphere& caster : casters) {
+		caster.center =
+		  Vector3(unit(random) * 290.0f, 20.0f + unit(random) * 20.0f, unit(random) * 290.0f);
+		caster.radius = 0.5f + (unit(random) + 1.0f) * 2.0f;
+	}
+	cascades.CullCasters(casters.data(), kCasterCount);
+
+	uint32_t missed = 0;
+	for (uint32_t c = 0; c < cascades.GetCascadeCount(); c++) {
+		const Cascade& cascade = cascades.GetCascade(c);
+		const std::vector<uint32_t>& listed = cascades.GetCasters(c);
+		CHECK(std::is_sorted(listed.begin(), listed.end()));
+		for (uint32_t i = 0; i < kCasterCount; i++) {
+			bool inside = false;
+			for (int sample = 0; sample < 16 && !inside; sample++) {
+				Vector3 offset(unit(random), unit(random), unit(random));
+				Vector3 point = casters[i].center + offset * (casters[i].radius * 0.57f);
+				inside = IsInside(Vector3Transform(point, cascade.matViewProjection), 0.0f);
+			}
+			if (inside && !std::binary_search(listed.begin(), listed.end(), i)) {
+				missed++;
+			}
+		}
+		printf("  cascade %u: %zu of %u casters\n", c, listed.size(), kCasterCount);
+		// 全部は入らない（振り分けで減っている）
+		CHECK(listed.size() < kCasterCount);
+	}
+	CHECK(missed == 0);
+}
+} // namespace
+
+int main() {
+	TestSplits();
+	TestFit(true);
+	TestFit(false);
+	return CheckResult();
+}
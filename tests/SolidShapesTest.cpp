@@ -0,0 +1,270 @@
+﻿#include "Check.h"
+#include "SolidShapes.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// SolidShapesのメッシュ生成・インスタンスデータの詰め込み・ShapeVS.hlslと同じ変換の検証
+// （軸ごとに拡大率の違う変換・せん断・鏡映でも、変換した法線が面に垂直で外を向くこと）
+
+namespace {
+using Shape = SolidShapes::Shape;
+using Instance = SolidShapes::Instance;
+
+void Sub(const float a[3], const float b[3], float out[3]) {
+	for (int i = 0; i < 3; i++) {
+		out[i] = a[i] - b[i];
+	}
+}
+
+void Cross(const float a[3], const float b[3], float out[3]) {
+	out[0] = a[1] * b[2] - a[2] * b[1];
+	out[1] = a[2] * b[0] - a[0] * b[2];
+	out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+float Dot(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+float Length(const float a[3]) { return std::sqrt(Dot(a, a)); }
+
+float Distance(const float a[3], const float b[3]) {
+	float d[3];
+	Sub(a, b, d);
+	return Length(d);
+}
+
+// 線形部分（上3x3）だけの変換
+void TransformDirection(const Instance& instance, const float direction[3], float out[3]) {
+	for (int i = 0; i < 3; i++) {
+		out[i] = Dot(instance.rows[i], direction);
+	}
+}
+
+// 法線に垂直な2方向
+void MakeTangents(const float normal[3], float tangent0[3], float tangent1[3]) {
+	const float reference[3] = {
+	  std::fabs(normal[0]) < 0.9f ? 1.0f : 0.0f, std::fabs(normal[0]) < 0.9f ? 0.0f : 1.0f, 0.0f};
+	Cross(normal, reference, tangent0);
+	Cross(normal, tangent0, tangent1);
+}
+
+// 上3x3の行列式
+float Determinant(const Instance& instance) {
+	float cofactor[3];
+	Cross(instance.rows[1], instance.rows[2], cofactor);
+	return Dot(instance.rows[0], cofactor);
+}
+
+// 以前のShapeVS.hlslの法線の変換（ワールド行列の上3x3をそのまま掛ける）
+void TransformNormalDirect(const Instance& instance, const float normal[3], float out[3]) {
+	for (int i = 0; i < 3; i++) {
+		out[i] = Dot(instance.rows[i], normal);
+	}
+	float length = Length(out);
+	for (int i = 0; i < 3; i++) {
+		out[i] /= length;
+	}
+}
+
+// メッシュと変換の検査結果
+struct MeshCheck {
+	// 頂点の並びから求めた面の向きが頂点の法線と逆の三角形の数
+	uint32_t flippedCount = 0;
+	// 変換後の法線と、頂点での接線を変換したものとの内積の最大（0なら面に垂直）
+	float maxTangentDot = 0.0f;
+	// 同じく以前の変換での最大
+	float maxDirectTangentDot = 0.0f;
+	// 平らな面での、変換後の法線と変換後の頂点の並びの向きの内積の最小（1なら外向きに一致）
+	float minFaceDot = 1.0f;
+};
+
+MeshCheck CheckMesh(
+  const std::vector<SolidShapes::Vertex>& vertices, const std::vector<uint16_t>& indices,
+  const Instance& instance) {
+	MeshCheck result;
+
+	// 頂点ごとに、接線を変換したものと変換後の法線が垂直か
+	for (const SolidShapes::Vertex& vertex : vertices) {
+		float tangents[2][3];
+		MakeTangents(vertex.normal, tangents[0], tangents[1]);
+		float normal[3];
+		float direct[3];
+		SolidShapes::TransformNormal(instance, vertex.normal, normal);
+		TransformNormalDirect(instance, vertex.normal, direct);
+		CHECK(std::fabs(Length(normal) - 1.0f) < 1e-4f);
+		for (const float* tangent : tangents) {
+			float transformed[3];
+			TransformDirection(instance, tangent, transformed);
+			float length = Length(transformed);
+			result.maxTangentDot =
+			  std::fmax(result.maxTangentDot, std::fabs(Dot(normal, transformed)) / length);
+			result.maxDirectTangentDot =
+			  std::fmax(result.maxDirectTangentDot, std::fabs(Dot(direct, transformed)) / length);
+		}
+	}
+
+	// 鏡映では頂点の並びの向きが反転する
+	const float winding = Determinant(instance) < 0.0f ? -1.0f : 1.0f;
+	for (size_t t = 0; t < indices.size(); t += 3) {
+		const SolidShapes::Vertex* v[3] = {
+		  &vertices[indices[t]], &vertices[indices[t + 1]], &vertices[indices[t + 2]]};
+
+		// 変換前の面の向き（極の縮退した三角形は除く）
+		float e1[3], e2[3], face[3];
+		Sub(v[1]->pos, v[0]->pos, e1);
+		Sub(v[2]->pos, v[0]->pos, e2);
+		Cross(e1, e2, face);
+		if (Length(face) < 1e-6f) {
+			continue;
+		}
+		if (Dot(face, v[0]->normal) < 0.0f) {
+			result.flippedCount++;
+		}
+
+		// 頂点の法線が揃っている（平らな面の）三角形だけ、変換後の並びの向きと比べる
+		if (Dot(v[0]->normal, v[1]->normal) < 0.9999f ||
+		    Dot(v[0]->normal, v[2]->normal) < 0.9999f) {
+			continue;
+		}
+		float p[3][3];
+		for (int i = 0; i < 3; i++) {
+			SolidShapes::TransformPosition(instance, v[i]->pos, p[i]);
+		}
+		Sub(p[1], p[0], e1);
+		Sub(p[2], p[0], e2);
+		Cross(e1, e2, face);
+		float normal[3];
+		SolidShapes::TransformNormal(instance, v[0]->normal, normal);
+		result.minFaceDot =
+		  std::fmin(result.minFaceDot, winding * Dot(normal, face) / Length(face));
+	}
+	return result;
+}
+
+// 単位・拡大率の違う回転・せん断・鏡映
+void MakeMatrices(std::vector<Instance>& instances) {
+	const uint32_t white = SolidShapes::PackColor(1.0f, 1.0f, 1.0f, 1.0f);
+	Instance instance;
+
+	// 単位
+	const float identity[4][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+	SolidShapes::PackMatrix(identity, white, instance);
+	instances.push_back(instance);
+
+	// 軸ごとに違う拡大のあとZ軸回転（行ベクトル形式: v * S * R）
+	const float c = std::cos(0.7f);
+	const float s = std::sin(0.7f);
+	const float scale[3] = {4.0f, 0.25f, 1.5f};
+	const float scaledRotation[4][4] = {
+	  {scale[0] * c, scale[0] * s, 0, 0},
+	  {-scale[1] * s, scale[1] * c, 0, 0},
+	  {0, 0, scale[2], 0},
+	  {3, -2, 5, 1}};
+	SolidShapes::PackMatrix(scaledRotation, white, instance);
+	instances.push_back(instance);
+
+	// せん断
+	const float shear[4][4] = {{1, 0, 0, 0}, {1.5f, 1, 0, 0}, {0, 0.5f, 2, 0}, {0, 0, 0, 1}};
+	SolidShapes::PackMatrix(shear, white, instance);
+	instances.push_back(instance);
+
+	// X軸の鏡映と拡大
+	const float mirror[4][4] = {{-2, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 0.5f, 0}, {1, 1, 1, 1}};
+	SolidShapes::PackMatrix(mirror, white, instance);
+	instances.push_back(instance);
+}
+
+// メッシュの向きと変換した法線
+void TestNormals() {
+	std::vector<Instance> instances;
+	MakeMatrices(instances);
+
+	for (uint32_t shape = 0; shape < static_cast<uint32_t>(Shape::kCountOfShape); shape++) {
+		std::vector<SolidShapes::Vertex> vertices;
+		std::vector<uint16_t> indices;
+		SolidShapes::BuildMesh(static_cast<Shape>(shape), 16, vertices, indices);
+		CHECK(!vertices.empty() && indices.size() % 3 == 0);
+		for (uint16_t index : indices) {
+			CHECK(index < vertices.size());
+		}
+		for (const SolidShapes::Vertex& vertex : vertices) {
+			CHECK(std::fabs(Length(vertex.normal) - 1.0f) < 1e-4f);
+		}
+
+		for (size_t i = 0; i < instances.size(); i++) {
+			MeshCheck check = CheckMesh(vertices, indices, instances[i]);
+			printf(
+			  "shape %u matrix %zu: normal . tangent %.2e (direct %.2e), normal . face %.5f\n",
+			  shape, i, static_cast<double>(check.maxTangentDot),
+			  static_cast<double>(check.maxDirectTangentDot),
+			  static_cast<double>(check.minFaceDot));
+			CHECK(check.flippedCount == 0);
+			CHECK(check.maxTangentDot < 1e-4f);
+			CHECK(0.9999f < check.minFaceDot);
+		}
+	}
+}
+
+// 詰め込んだ変換で単位図形が狙いの位置に来るか
+void TestPack() {
+	const uint32_t color = SolidShapes::PackColor(1.0f, 0.5f, 0.0f, 0.25f);
+	CHECK(color == (255u | (128u << 8) | (0u << 16) | (64u << 24)));
+	CHECK(SolidShapes::PackColor(-1.0f, 2.0f, 0.0f, 1.0f) == (0xff00u | 0xff000000u));
+
+	Instance instance;
+	float out[3];
+
+	// 箱：立方体の角が箱の角に
+	const float center[3] = {1.0f, 2.0f, 3.0f};
+	const float halfExtents[3] = {0.5f, 2.0f, 4.0f};
+	SolidShapes::PackBox(center, halfExtents, color, instance);
+	CHECK(instance.color == color);
+	const float corner[3] = {1.0f, -1.0f, 1.0f};
+	SolidShapes::TransformPosition(instance, corner, out);
+	const float expectedCorner[3] = {1.5f, 0.0f, 7.0f};
+	CHECK(Distance(out, expectedCorner) < 1e-5f);
+	// 細長い箱の上面の法線は上を向いたまま
+	const float up[3] = {0.0f, 1.0f, 0.0f};
+	SolidShapes::TransformNormal(instance, up, out);
+	CHECK(Distance(out, up) < 1e-5f);
+
+	// 球：表面が半径の距離に
+	SolidShapes::PackSphere(center, 2.5f, color, instance);
+	const float surface[3] = {0.6f, 0.0f, 0.8f};
+	SolidShapes::TransformPosition(instance, surface, out);
+	CHECK(std::fabs(Distance(out, center) - 2.5f) < 1e-5f);
+
+	// 円柱：軸の両端が2点に、側面が軸から半径の距離に
+	const float p0[3] = {1.0f, 1.0f, 1.0f};
+	const float p1[3] = {4.0f, -3.0f, 1.0f};
+	SolidShapes::PackCylinder(p0, p1, 0.75f, color, instance);
+	const float bottom[3] = {0.0f, -1.0f, 0.0f};
+	const float top[3] = {0.0f, 1.0f, 0.0f};
+	SolidShapes::TransformPosition(instance, bottom, out);
+	CHECK(Distance(out, p0) < 1e-5f);
+	SolidShapes::TransformPosition(instance, top, out);
+	CHECK(Distance(out, p1) < 1e-5f);
+	float axis[3];
+	Sub(p1, p0, axis);
+	const float middle[3] = {
+	  (p0[0] + p1[0]) * 0.5f, (p0[1] + p1[1]) * 0.5f, (p0[2] + p1[2]) * 0.5f};
+	for (int i = 0; i < 8; i++) {
+		float angle = i * 0.785398f;
+		const float side[3] = {std::cos(angle), 0.0f, std::sin(angle)};
+		float radial[3];
+		SolidShapes::TransformPosition(instance, side, out);
+		Sub(out, middle, radial);
+		CHECK(std::fabs(Length(radial) - 0.75f) < 1e-5f);
+		CHECK(std::fabs(Dot(radial, axis)) < 1e-5f);
+		// 側面の法線は軸から外向き
+		SolidShapes::TransformNormal(instance, side, out);
+		CHECK(std::fabs(Dot(out, radial) / 0.75f - 1.0f) < 1e-5f);
+	}
+}
+} // namespace
+
+int main() {
+	TestNormals();
+	TestPack();
+	return CheckResult();
+}
@@ -0,0 +1,158 @@
+﻿#include "Bench.h"
+#include "Check.h"
+#include "SpriteQuad.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// SpriteQuad::Expand（SIMD版）とExpandScalarの一致とテクスチャ範囲の検証と、展開速度の比較
+// 使い方: SpriteQuadTest [--quick]
+
+namespace {
+// 回転・反転・アンカーポイントを散らした矩形
+std::vector<SpriteQuad::Desc> MakeQuads(size_t count, uint32_t seed) {
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<SpriteQuad::Desc> quads(count);
+	for (SpriteQuad::Desc& quad : quads) {
+		quad.position[0] = unit(random) * 1280.0f;
+		quad.position[1] = unit(random) * 720.0f;
+		quad.rotation = (unit(random) - 0.5f) * 12.0f;
+		quad.size[0] = 1.0f + unit(random) * 256.0f;
+		quad.size[1] = 1.0f + unit(random) * 256.0f;
+		quad.anchorPoint[0] = unit(random);
+		quad.anchorPoint[1] = unit(random);
+		quad.uvRect[0] = unit(random) * 0.5f;
+		quad.uvRect[1] = unit(random) * 0.5f;
+		quad.uvRect[2] = 0.5f + unit(random) * 0.5f;
+		quad.uvRect[3] = 0.5f + unit(random) * 0.5f;
+		quad.color = SpriteQuad::PackColor(unit(random), unit(random), unit(random), unit(random));
+		quad.isFlipX = unit(random) < 0.5f;
+		quad.isFlipY = unit(random) < 0.5f;
+	}
+	return quads;
+}
+
+// 2つの展開結果の最大の差（色は完全一致でなければ無限大）
+float MaxDifference(
+  const std::vector<SpriteQuad::Vertex>& a, const std::vector<SpriteQuad::Vertex>& b) {
+	float result = 0.0f;
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a[i].color != b[i].color) {
+			return INFINITY;
+		}
+		for (int k = 0; k < 2; k++) {
+			result = std::fmax(result, std::fabs(a[i].pos[k] - b[i].pos[k]));
+			result = std::fmax(result, std::fabs(a[i].uv[k] - b[i].uv[k]));
+		}
+	}
+	return result;
+}
+
+// 回転なしの1矩形の頂点位置（左下, 左上, 右下, 右上）
+void TestCorners() {
+	SpriteQuad::Desc quad{};
+	quad.position[0] = 100.0f;
+	quad.position[1] = 50.0f;
+	quad.size[0] = 20.0f;
+	quad.size[1] = 10.0f;
+	quad.anchorPoint[0] = 0.5f;
+	quad.anchorPoint[1] = 0.0f;
+	quad.uvRect[0] = 0.0f;
+	quad.uvRect[1] = 0.0f;
+	quad.uvRect[2] = 1.0f;
+	quad.uvRect[3] = 1.0f;
+	quad.color = SpriteQuad::PackColor(1.0f, 0.0f, 0.0f, 1.0f);
+
+	SpriteQuad::Vertex vertices[SpriteQuad::kVertexCount];
+	SpriteQuad::Expand(&quad, 1, vertices);
+	CHECK(vertices[0].pos[0] == 90.0f && vertices[0].pos[1] == 60.0f);
+	CHECK(vertices[1].pos[0] == 90.0f && vertices[1].pos[1] == 50.0f);
+	CHECK(vertices[2].pos[0] == 110.0f && vertices[2].pos[1] == 60.0f);
+	CHECK(vertices[3].pos[0] == 110.0f && vertices[3].pos[1] == 50.0f);
+	CHECK(vertices[0].uv[0] == 0.0f && vertices[0].uv[1] == 1.0f);
+	CHECK(vertices[3].uv[0] == 1.0f && vertices[3].uv[1] == 0.0f);
+	CHECK(vertices[0].color == 0xff0000ffu);
+
+	uint16_t indices[SpriteQuad::kIndexCount * 2];
+	SpriteQuad::BuildIndices(2, indices);
+	const uint16_t expected[] = {0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7};
+	for (size_t i = 0; i < SpriteQuad::kIndexCount * 2; i++) {
+		CHECK(indices[i] == expected[i]);
+	}
+}
+
+// アトラスのページの一部を指すスプライト（TextureAtlas::Applyで範囲を設定したもの）
+void TestTextureRect() {
+	SpriteQuad::Desc quad{};
+	quad.size[0] = 32.0f;
+	quad.size[1] = 64.0f;
+	quad.color = SpriteQuad::PackColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+	// 2048四方のページの(512, 256)から32x64
+	const float texBase[2] = {512.0f, 256.0f};
+	const float texSize[2] = {32.0f, 64.0f};
+	SpriteQuad::SetTextureRect(quad, texBase, texSize, 2048.0f, 2048.0f);
+	CHECK(quad.uvRect[0] == 0.25f && quad.uvRect[1] == 0.125f);
+	CHECK(quad.uvRect[2] == 544.0f / 2048.0f && quad.uvRect[3] == 320.0f / 2048.0f);
+
+	// 展開した頂点もページ全体ではなく範囲の角を指す（左下, 左上, 右下, 右上）
+	SpriteQuad::Vertex vertices[SpriteQuad::kVertexCount];
+	SpriteQuad::Expand(&quad, 1, vertices);
+	CHECK(vertices[0].uv[0] == 0.25f && vertices[0].uv[1] == 320.0f / 2048.0f);
+	CHECK(vertices[1].uv[0] == 0.25f && vertices[1].uv[1] == 0.125f);
+	CHECK(vertices[2].uv[0] == 544.0f / 2048.0f && vertices[2].uv[1] == 320.0f / 2048.0f);
+	CHECK(vertices[3].uv[0] == 544.0f / 2048.0f && vertices[3].uv[1] == 0.125f);
+
+	// 反転しても範囲の外は読まない
+	quad.isFlipX = true;
+	quad.isFlipY = true;
+	SpriteQuad::Expand(&quad, 1, vertices);
+	for (const SpriteQuad::Vertex& vertex : vertices) {
+		CHECK(0.25f <= vertex.uv[0] && vertex.uv[0] <= 544.0f / 2048.0f);
+		CHECK(0.125f <= vertex.uv[1] && vertex.uv[1] <= 320.0f / 2048.0f);
+	}
+
+	// 範囲の幅と高さが0ならテクスチャ全体
+	const float zero[2] = {0.0f, 0.0f};
+	SpriteQuad::SetTextureRect(quad, zero, zero, 300.0f, 200.0f);
+	CHECK(quad.uvRect[0] == 0.0f && quad.uvRect[1] == 0.0f);
+	CHECK(quad.uvRect[2] == 1.0f && quad.uvRect[3] == 1.0f);
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	bool quick = IsQuickBench(argc, argv);
+
+	TestCorners();
+	TestTextureRect();
+
+	// SIMD版は端数の矩形をスカラーで処理するので、端数の出る数も試す
+	const size_t counts[] = {1, 2, 3, 5, 7, 64, 1001};
+	for (size_t count : counts) {
+		std::vector<SpriteQuad::Desc> quads = MakeQuads(count, static_cast<uint32_t>(count));
+		std::vector<SpriteQuad::Vertex> simd(count * SpriteQuad::kVertexCount);
+		std::vector<SpriteQuad::Vertex> scalar(count * SpriteQuad::kVertexCount);
+		SpriteQuad::Expand(quads.data(), count, simd.data());
+		SpriteQuad::ExpandScalar(quads.data(), count, scalar.data());
+		CHECK(MaxDifference(simd, scalar) < 1e-3f);
+	}
+
+	// 展開速度
+	const size_t benchCount = quick ? 10000 : 200000;
+	const uint32_t repeat = quick ? 1 : 20;
+	std::vector<SpriteQuad::Desc> quads = MakeQuads(benchCount, 1234);
+	std::vector<SpriteQuad::Vertex> simd(benchCount * SpriteQuad::kVertexCount);
+	std::vector<SpriteQuad::Vertex> scalar(benchCount * SpriteQuad::kVertexCount);
+	double simdMilliseconds = MeasureMilliseconds(
+	  repeat, [&]() { SpriteQuad::Expand(quads.data(), benchCount, simd.data()); });
+	double scalarMilliseconds = MeasureMilliseconds(
+	  repeat, [&]() { SpriteQuad::ExpandScalar(quads.data(), benchCount, scalar.data()); });
+	CHECK(MaxDifference(simd, scalar) < 1e-3f);
+	printf(
+	  "%zu quads: Expand %.3f ms, ExpandScalar %.3f ms (x%.2f)\n", benchCount, simdMilliseconds,
+	  scalarMilliseconds, scalarMilliseconds / simdMilliseconds);
+
+	return CheckResult();
+}
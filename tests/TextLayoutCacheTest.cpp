@@ -0,0 +1,183 @@
+﻿#include "Check.h"
+#include "TextLayoutCache.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// TextLayoutCacheの検証（座標が変わっても同じ登録内容を使うこと、ずらした結果が並べ直した結果と
+// 一致すること、破棄した登録内容の領域を使い直すこと）
+
+namespace {
+// ヒープ確保の回数
+size_t allocationCount = 0;
+} // namespace
+
+void* operator new(size_t size) {
+	allocationCount++;
+	void* p = malloc(size == 0 ? 1 : size);
+	if (!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+namespace {
+// DebugText::NPrintと同じ並べ方（等幅）
+void Layout(
+  const std::string& text, float x, float y, float scale, std::vector<SpriteQuad::Desc>& glyphs) {
+	const float width = 9.0f * scale;
+	const float height = 18.0f * scale;
+	for (size_t i = 0; i < text.size(); i++) {
+		SpriteQuad::Desc glyph = {};
+		glyph.position[0] = x + width * i;
+		glyph.position[1] = y;
+		glyph.size[0] = width;
+		glyph.size[1] = height;
+		glyph.uvRect[0] = static_cast<float>(text[i]) / 128.0f;
+		glyph.uvRect[2] = static_cast<float>(text[i] + 1) / 128.0f;
+		glyph.uvRect[3] = 1.0f;
+		glyph.color = 0xffffffff;
+		glyphs.push_back(glyph);
+	}
+}
+
+// キャッシュを引いてから並べる（DebugText::CachedPrintと同じ手順）
+void CachedLayout(
+  TextLayoutCache& cache, const std::string& text, float x, float y, float scale,
+  std::vector<SpriteQuad::Desc>& glyphs) {
+	if (cache.Append(text.data(), text.size(), x, y, scale, glyphs)) {
+		return;
+	}
+	size_t first = glyphs.size();
+	Layout(text, x, y, scale, glyphs);
+	cache.Insert(text.data(), text.size(), x, y, scale, glyphs.data() + first, text.size());
+}
+
+// 2つの並べ方の最大の差
+float MaxDifference(
+  const std::vector<SpriteQuad::Desc>& a, const std::vector<SpriteQuad::Desc>& b) {
+	if (a.size() != b.size()) {
+		return INFINITY;
+	}
+	float result = 0.0f;
+	for (size_t i = 0; i < a.size(); i++) {
+		for (int j = 0; j < 2; j++) {
+			result = fmaxf(result, fabsf(a[i].position[j] - b[i].position[j]));
+			result = fmaxf(result, fabsf(a[i].size[j] - b[i].size[j]));
+		}
+		for (int j = 0; j < 4; j++) {
+			result = fmaxf(result, fabsf(a[i].uvRect[j] - b[i].uvRect[j]));
+		}
+	}
+	return result;
+}
+
+// 座標の違う表示は同じ登録内容をずらして使う
+void TestTranslate() {
+	TextLayoutCache cache;
+	std::vector<SpriteQuad::Desc> glyphs;
+
+	CachedLayout(cache, "score 1200", 10.0f, 20.0f, 2.0f, glyphs);
+	CHECK(cache.GetMissCount() == 1 && cache.GetEntryCount() == 1);
+
+	// 別の座標（同じ文字列・倍率）はヒットして、並べ直した結果と一致する
+	glyphs.clear();
+	CHECK(cache.Append("score 1200", 10, 640.5f, 300.25f, 2.0f, glyphs));
+	std::vector<SpriteQuad::Desc> expected;
+	Layout("score 1200", 640.5f, 300.25f, 2.0f, expected);
+	CHECK(MaxDifference(glyphs, expected) < 1e-3f);
+	CHECK(cache.GetEntryCount() == 1);
+
+	// 既にある矩形の後ろに追加する
+	CHECK(cache.Append("score 1200", 10, 0.0f, 0.0f, 2.0f, glyphs));
+	CHECK(glyphs.size() == 20);
+	CHECK(glyphs[10].position[0] == 0.0f && glyphs[10].position[1] == 0.0f);
+
+	// 倍率や文字列が違えば外れて何も追加しない
+	size_t count = glyphs.size();
+	CHECK(!cache.Append("score 1200", 10, 10.0f, 20.0f, 1.0f, glyphs));
+	CHECK(!cache.Append("score 1201", 10, 10.0f, 20.0f, 2.0f, glyphs));
+	CHECK(!cache.Append("score 120", 9, 10.0f, 20.0f, 2.0f, glyphs));
+	CHECK(glyphs.size() == count);
+	CHECK(cache.GetHitCount() == 2 && cache.GetMissCount() == 4);
+}
+
+// 毎フレーム動く文字列（スクロール・追従するラベル）は最初の1回だけ並べる
+void TestMovingText() {
+	TextLayoutCache cache;
+	std::vector<SpriteQuad::Desc> glyphs;
+	std::vector<SpriteQuad::Desc> expected;
+
+	const uint32_t kFrames = 300;
+	const char* labels[] = {"enemy", "player", "boss hp 100"};
+	float worst = 0.0f;
+	for (uint32_t frame = 0; frame < kFrames; frame++) {
+		glyphs.clear();
+		expected.clear();
+		for (int i = 0; i < 3; i++) {
+			float x = 100.0f + i * 200.0f + frame * 1.75f;
+			float y = 50.0f + i * 40.0f + sinf(frame * 0.1f) * 30.0f;
+			CachedLayout(cache, labels[i], x, y, 1.5f, glyphs);
+			Layout(labels[i], x, y, 1.5f, expected);
+		}
+		worst = fmaxf(worst, MaxDifference(glyphs, expected));
+		cache.NextFrame();
+	}
+	printf(
+	  "moving text: hit rate %.3f, max difference %g\n", cache.GetHitRate(),
+	  static_cast<double>(worst));
+	CHECK(cache.GetMissCount() == 3);
+	CHECK(cache.GetHitCount() == 3 * (kFrames - 1));
+	CHECK(worst < 1e-2f);
+}
+
+// 破棄した登録内容の領域を使い直す
+void TestStorageReuse() {
+	TextLayoutCache cache;
+	cache.SetMaxUnusedFrames(1);
+	std::vector<SpriteQuad::Desc> glyphs;
+	glyphs.reserve(64);
+
+	// 毎フレーム内容の変わる同じ長さの文字列（古いものは破棄される）
+	char text[32];
+	size_t warmupAllocations = 0;
+	for (uint32_t frame = 0; frame < 200; frame++) {
+		if (frame == 100) {
+			warmupAllocations = allocationCount;
+		}
+		glyphs.clear();
+		snprintf(text, sizeof(text), "frame %08u", frame);
+		CachedLayout(cache, text, 10.0f, 10.0f, 1.0f, glyphs);
+		cache.NextFrame();
+	}
+	CHECK(cache.GetEntryCount() <= 3);
+
+	// 落ち着いた後は、文字列と矩形の配列を確保し直さない（残るのはハッシュ表の節点だけ）
+	size_t allocations = allocationCount - warmupAllocations;
+	printf("storage reuse: %zu allocations in 100 frames\n", allocations);
+	CHECK(allocations <= 100);
+
+	// 全破棄の後も領域は使い直され、内容は新しく登録したものになる
+	cache.Clear();
+	CHECK(cache.GetEntryCount() == 0);
+	glyphs.clear();
+	CachedLayout(cache, "after clear", 0.0f, 0.0f, 1.0f, glyphs);
+	std::vector<SpriteQuad::Desc> copied;
+	CHECK(cache.Append("after clear", 11, 0.0f, 0.0f, 1.0f, copied));
+	CHECK(MaxDifference(glyphs, copied) == 0.0f);
+}
+} // namespace
+
+int main() {
+	TestTranslate();
+	TestMovingText();
+	TestStorageReuse();
+	return CheckResult();
+}
@@ -0,0 +1,207 @@
+﻿#include "Check.h"
+#include "TextureResidency.h"
+#include <vector>
+
+// TextureResidencyの予算管理の検証（GPUを使わずに常駐の判断だけを確かめる）
+// （ミップごとのバイト数の合計、未使用フレーム数で選んだ古い順の縮退と追い出し、
+// 　使用時に復元が要るかの報告と復元完了の記録を確かめる）
+
+namespace {
+using State = TextureResidency::State;
+using Action = TextureResidency::Action;
+
+// 1ミップごとに1/4になる大きさ（最上位が1024バイト）
+std::vector<uint64_t> MakeMipSizes(uint32_t mipCount) {
+	std::vector<uint64_t> mipSizes;
+	uint64_t size = 1024;
+	for (uint32_t i = 0; i < mipCount; i++) {
+		mipSizes.push_back(size);
+		size /= 4;
+	}
+	return mipSizes;
+}
+
+// 指示の検索
+const Action* FindAction(const std::vector<Action>& actions, uint32_t handle) {
+	for (const Action& action : actions) {
+		if (action.handle == handle) {
+			return &action;
+		}
+	}
+	return nullptr;
+}
+
+// ミップごとのバイト数の合計
+void TestAccounting() {
+	TextureResidency residency;
+	CHECK(residency.GetUsedBytes() == 0);
+
+	// 1024 + 256 + 64 + 16 = 1360
+	residency.Register(0, MakeMipSizes(4), 0);
+	CHECK(residency.GetResidentBytes(0) == 1360);
+	residency.Register(3, MakeMipSizes(1), 0);
+	CHECK(residency.GetResidentBytes(3) == 1024);
+	CHECK(residency.GetUsedBytes() == 2384);
+	// 間の未登録のハンドルと範囲外は0
+	CHECK(residency.GetResidentBytes(1) == 0);
+	CHECK(residency.GetResidentBytes(100) == 0);
+
+	// 上書き登録は以前の大きさを差し引く
+	residency.Register(0, MakeMipSizes(2), 5);
+	CHECK(residency.GetResidentBytes(0) == 1280);
+	CHECK(residency.GetUsedBytes() == 2304);
+	CHECK(residency.GetEntry(0).lastUsedFrame == 5);
+
+	// 予算内なら何もしない
+	residency.SetBudget(2304);
+	CHECK(residency.Update(1000).empty());
+
+	residency.Clear();
+	CHECK(residency.GetUsedBytes() == 0);
+	CHECK(residency.GetResidentBytes(0) == 0);
+}
+
+// 未使用フレーム数で選び、古い順に縮退させる
+void TestLruReduce() {
+	TextureResidency residency;
+	residency.SetUnusedFrameThreshold(10);
+	residency.SetDropMipCount(1);
+	for (uint32_t handle = 0; handle < 4; handle++) {
+		residency.Register(handle, MakeMipSizes(4), 0);
+	}
+	// 最後の使用: 0は15、1は2、2は5、3は30（3は使われたばかり）
+	residency.Touch(0, 15);
+	residency.Touch(1, 2);
+	residency.Touch(2, 5);
+	residency.Touch(3, 30);
+
+	// 1つ縮退すれば予算に収まる（1360 - 1024 = 336減る）
+	residency.SetBudget(1360 * 4 - 1000);
+	std::vector<Action> actions = residency.Update(30);
+	CHECK(actions.size() == 1);
+	CHECK(!actions.empty() && actions[0].handle == 1);
+	CHECK(!actions.empty() && actions[0].state == State::kReduced);
+	CHECK(!actions.empty() && actions[0].droppedMips == 1);
+	CHECK(residency.GetEntry(1).state == State::kReduced);
+	CHECK(residency.GetResidentBytes(1) == 336);
+	CHECK(residency.GetUsedBytes() == 1360 * 3 + 336);
+
+	// 予算を下げると次に古いものから縮退させ、使用から間もない3は選ばない
+	residency.SetBudget(1360 + 336 * 3);
+	actions = residency.Update(30);
+	CHECK(actions.size() == 2);
+	CHECK(actions.size() == 2 && actions[0].handle == 2 && actions[1].handle == 0);
+	CHECK(residency.GetEntry(3).state == State::kResident);
+	CHECK(residency.GetUsedBytes() == 1360 + 336 * 3);
+
+	// 落とすミップ数は最下位のミップを残す分までにする
+	TextureResidency single;
+	single.SetUnusedFrameThreshold(0);
+	single.SetDropMipCount(8);
+	single.Register(0, MakeMipSizes(3), 0);
+	single.SetBudget(100);
+	actions = single.Update(0);
+	const Action* action = FindAction(actions, 0);
+	CHECK(action && action->state == State::kReduced && action->droppedMips == 2);
+	CHECK(single.GetResidentBytes(0) == 64);
+}
+
+// 縮退で足りなければ追い出す
+void TestEvict() {
+	TextureResidency residency;
+	residency.SetUnusedFrameThreshold(10);
+	residency.SetDropMipCount(1);
+	for (uint32_t handle = 0; handle < 3; handle++) {
+		residency.Register(handle, MakeMipSizes(4), handle);
+	}
+	// ミップが1つしかないものは縮退できないので追い出すしかない
+	residency.Register(3, MakeMipSizes(1), 3);
+
+	// 全て縮退させても336 * 3 + 1024 = 2032なので、古いものから追い出す
+	// （0,1,2を追い出すと1024で予算に収まり、最後に使った3は残る）
+	residency.SetBudget(1100);
+	std::vector<Action> actions = residency.Update(100);
+	CHECK(residency.GetUsedBytes() == 1024);
+	// 縮退の指示は追い出しに置き換わり、同じハンドルの指示は1つだけ
+	CHECK(actions.size() == 3);
+	for (uint32_t handle = 0; handle < 3; handle++) {
+		const Action* action = FindAction(actions, handle);
+		CHECK(action && action->state == State::kEvicted && action->droppedMips == 0);
+		CHECK(residency.GetEntry(handle).state == State::kEvicted);
+		CHECK(residency.GetResidentBytes(handle) == 0);
+	}
+	CHECK(!FindAction(actions, 3));
+	CHECK(residency.GetEntry(3).state == State::kResident);
+
+	// 予算に収まる分だけ追い出し、残りは縮退のままにする
+	TextureResidency partial;
+	partial.SetUnusedFrameThreshold(10);
+	partial.SetDropMipCount(1);
+	partial.Register(0, MakeMipSizes(4), 0);
+	partial.Register(1, MakeMipSizes(4), 1);
+	partial.SetBudget(400);
+	actions = partial.Update(100);
+	const Action* action0 = FindAction(actions, 0);
+	const Action* action1 = FindAction(actions, 1);
+	CHECK(action0 && action0->state == State::kEvicted);
+	CHECK(action1 && action1->state == State::kReduced && action1->droppedMips == 1);
+	CHECK(partial.GetUsedBytes() == 336);
+
+	// 使われていないものが無ければ予算を超えたままにする
+	residency.SetBudget(0);
+	for (uint32_t handle = 0; handle < 4; handle++) {
+		residency.Touch(handle, 200);
+	}
+	CHECK(residency.Update(200).empty());
+	CHECK(residency.GetUsedBytes() == 1024);
+}
+
+// 使用時の復元の報告と復元完了
+void TestRestore() {
+	TextureResidency residency;
+	residency.SetUnusedFrameThreshold(1);
+	residency.SetDropMipCount(2);
+	residency.Register(0, MakeMipSizes(4), 0);
+	residency.Register(1, MakeMipSizes(4), 0);
+
+	// 常駐中と未登録は復元不要
+	CHECK(!residency.Touch(0, 1));
+	CHECK(!residency.Touch(5, 1));
+	CHECK(!residency.Touch(100, 1));
+
+	// 両方を縮退させても80 * 2で足りないので、古い1を追い出して0は縮退のまま
+	residency.SetBudget(100);
+	residency.Update(10);
+	CHECK(residency.GetEntry(1).state == State::kEvicted);
+	CHECK(residency.GetEntry(0).state == State::kReduced);
+	CHECK(residency.GetResidentBytes(0) == 80);
+
+	// 縮退も追い出しも復元が要ると報告し、使用フレームを更新する
+	CHECK(residency.Touch(0, 11));
+	CHECK(residency.Touch(1, 11));
+	CHECK(residency.GetEntry(0).lastUsedFrame == 11);
+	// 復元が済むまでは使うたびに報告する
+	CHECK(residency.Touch(0, 12));
+
+	// 復元完了で全ミップの大きさに戻る
+	residency.MarkRestored(0);
+	CHECK(residency.GetEntry(0).state == State::kResident);
+	CHECK(residency.GetEntry(0).droppedMips == 0);
+	CHECK(residency.GetResidentBytes(0) == 1360);
+	CHECK(!residency.Touch(0, 13));
+	residency.MarkRestored(1);
+	CHECK(residency.GetUsedBytes() == 1360 * 2);
+
+	// 使ったばかりなので次のUpdateでは選ばれない
+	residency.Touch(1, 13);
+	CHECK(residency.Update(13).empty());
+}
+} // namespace
+
+int main() {
+	TestAccounting();
+	TestLruReduce();
+	TestEvict();
+	TestRestore();
+	return CheckResult();
+}
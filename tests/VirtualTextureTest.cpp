@@ -0,0 +1,375 @@
+﻿#include "Check.h"
+#include "ThreadPool.h"
+#include "VirtualTextureFeedback.h"
+#include "VirtualTexturePageCache.h"
+#include "VirtualTexturePageTable.h"
+#include "VirtualTexturePageWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+// 仮想テクスチャのページテーブル・物理ページキャッシュ・フィードバック・ページ切り出しの検証
+// （VirtualTexture::ProcessFeedback/Update/CommitPageと同じ手順を、
+// 　カメラの移動を模したページIDの列で動かす）
+
+namespace {
+using PageTable = VirtualTexturePageTable;
+using PageCache = VirtualTexturePageCache;
+
+// ページテーブル単体
+void TestPageTable() {
+	PageTable table;
+	table.Initialize(8, 4, 4);
+	CHECK(table.GetPagesX(0) == 8 && table.GetPagesY(0) == 4);
+	CHECK(table.GetPagesX(3) == 1 && table.GetPagesY(3) == 1);
+
+	uint32_t mip, x, y;
+	PageTable::UnpackPageId(PageTable::PackPageId(2, 1, 0), mip, x, y);
+	CHECK(mip == 2 && x == 1 && y == 0);
+	uint32_t parent = PageTable::ParentPageId(PageTable::PackPageId(0, 5, 3));
+	CHECK(parent == PageTable::PackPageId(1, 2, 1));
+	CHECK(!table.IsValidPage(PageTable::PackPageId(0, 8, 0)));
+	CHECK(!table.IsValidPage(PageTable::PackPageId(4, 0, 0)));
+
+	// 常駐していなければ最も細かい常駐中の祖先で代用する
+	uint32_t residentPageId = 0;
+	uint32_t slot = 0;
+	CHECK(!table.Resolve(PageTable::PackPageId(0, 5, 3), residentPageId, slot));
+	table.Map(PageTable::PackPageId(3, 0, 0), 7);
+	table.Map(PageTable::PackPageId(1, 2, 1), 17);
+	CHECK(table.Resolve(PageTable::PackPageId(0, 5, 3), residentPageId, slot));
+	CHECK(residentPageId == PageTable::PackPageId(1, 2, 1) && slot == 17);
+	CHECK(table.Resolve(PageTable::PackPageId(0, 0, 0), residentPageId, slot));
+	CHECK(residentPageId == PageTable::PackPageId(3, 0, 0) && slot == 7);
+
+	// 間接参照テーブル（スロットX | スロットY << 8 | 常駐ミップ << 16 | 有効 << 24）
+	std::vector<uint32_t> texels;
+	table.BuildIndirection(0, 16, texels);
+	CHECK(texels.size() == 32);
+	CHECK(texels[3 * 8 + 5] == ((17 % 16) | ((17 / 16) << 8) | (1u << 16) | (1u << 24)));
+	CHECK(texels[0] == (7 | (3u << 16) | (1u << 24)));
+
+	table.ClearDirty();
+	table.Unmap(PageTable::PackPageId(1, 2, 1));
+	CHECK(table.IsDirty());
+	CHECK(table.GetSlot(PageTable::PackPageId(1, 2, 1)) == PageTable::kInvalidSlot);
+}
+
+// 物理ページキャッシュ単体
+void TestPageCache() {
+	PageCache cache;
+	cache.Initialize(3);
+	cache.SetProtectedFrames(2);
+
+	uint32_t evicted = 0;
+	uint32_t slotA = cache.Allocate(100, 1, evicted);
+	CHECK(evicted == PageCache::kInvalid);
+	uint32_t slotB = cache.Allocate(101, 2, evicted);
+	uint32_t slotC = cache.Allocate(102, 3, evicted);
+	CHECK(slotA != slotB && slotB != slotC && slotA != slotC);
+	CHECK(cache.GetResidentCount() == 3);
+
+	// 最も長く使われていないページ（101）が追い出される
+	CHECK(cache.Touch(100, 4));
+	CHECK(!cache.Touch(999, 4));
+	uint32_t slotD = cache.Allocate(103, 5, evicted);
+	CHECK(evicted == 101 && slotD == slotB);
+	CHECK(!cache.IsResident(101) && cache.IsResident(103));
+	CHECK(cache.GetSlot(103) == slotB && cache.GetSlot(101) == PageCache::kInvalid);
+
+	// 追い出さないフレーム数以内に使ったページしか残っていなければ見送る
+	cache.Touch(102, 5);
+	cache.Touch(100, 5);
+	CHECK(cache.Allocate(104, 6, evicted) == PageCache::kInvalid);
+	CHECK(cache.Allocate(104, 7, evicted) != PageCache::kInvalid);
+	CHECK(evicted == 103);
+
+	// 固定したページは追い出さない
+	cache.Lock(102);
+	CHECK(cache.Allocate(105, 20, evicted) != PageCache::kInvalid);
+	CHECK(evicted == 100);
+	CHECK(cache.Allocate(106, 21, evicted) != PageCache::kInvalid);
+	CHECK(evicted == 104);
+	CHECK(cache.IsResident(102));
+	CHECK(cache.GetHitCount() == 3 && cache.GetMissCount() == 1);
+	CHECK(cache.GetEvictionCount() == 4);
+}
+
+// フィードバックの要求順（粗いミップ → 参照数の多い順）
+void TestFeedbackOrder() {
+	PageTable table;
+	table.Initialize(4, 4, 3);
+	PageCache cache;
+	cache.Initialize(8);
+
+	const uint32_t a = PageTable::PackPageId(0, 0, 0);
+	const uint32_t b = PageTable::PackPageId(0, 3, 3);
+	std::vector<uint32_t> samples = {a, a, a, b, VirtualTextureFeedback::kEmptySample, b, a};
+	samples.push_back(PageTable::PackPageId(0, 9, 9)); // 範囲外は無視する
+
+	VirtualTextureFeedback feedback;
+	feedback.Process(samples.data(), samples.size(), table, cache, 1);
+	CHECK(feedback.GetReferencedPageCount() == 2);
+
+	std::vector<uint32_t> requests;
+	feedback.GetRequests(16, requests);
+	// 2ページとその祖先（ミップ1が2ページ、ミップ2が1ページ）
+	CHECK(requests.size() == 5);
+	CHECK(requests[0] == PageTable::PackPageId(2, 0, 0));
+	CHECK(requests[1] == PageTable::PackPageId(1, 0, 0));
+	CHECK(requests[2] == PageTable::PackPageId(1, 1, 1));
+	CHECK(requests[3] == a);
+	CHECK(requests[4] == b);
+
+	feedback.GetRequests(2, requests);
+	CHECK(requests.size() == 2);
+}
+
+// カメラの移動を模したトレースで、VirtualTextureと同じ流れを回す
+void TestSimulatedTrace() {
+	const uint32_t pagesX = 64;
+	const uint32_t pagesY = 64;
+	const uint32_t mipCount = 7;
+	const uint32_t slotCount = 16 * 16;
+	const uint32_t maxRequests = 16;
+	const uint32_t protectedFrames = 2;
+	// 画面はページ6×4枚分、1ページが16×16画素に写る
+	const uint32_t viewPagesX = 6;
+	const uint32_t viewPagesY = 4;
+	const uint32_t pixelsPerPage = 16;
+
+	PageTable table;
+	table.Initialize(pagesX, pagesY, mipCount);
+	PageCache cache;
+	cache.Initialize(slotCount);
+	cache.SetProtectedFrames(protectedFrames);
+	VirtualTextureFeedback feedback;
+
+	// 最も粗いミップは常駐させて固定する
+	uint32_t evicted = 0;
+	const uint32_t topPageId = PageTable::PackPageId(mipCount - 1, 0, 0);
+	table.Map(topPageId, cache.Allocate(topPageId, 0, evicted));
+	cache.Lock(topPageId);
+
+	// 最後に参照したフレーム（祖先を含む）
+	std::unordered_map<uint32_t, uint32_t> lastReferenced;
+	// 読み込み中のページ（1フレーム遅れて届く）
+	std::deque<std::vector<uint32_t>> inFlight;
+	std::vector<uint32_t> samples(viewPagesX * pixelsPerPage * viewPagesY * pixelsPerPage);
+	std::vector<uint32_t> requests;
+
+	uint32_t unresolved = 0;
+	uint32_t protectedViolations = 0;
+	uint32_t mismatches = 0;
+	uint32_t frame = 0;
+	auto runFrame = [&](uint32_t mip, uint32_t originX, uint32_t originY) {
+		frame++;
+
+		// 画面に写ったページIDを書き出す（VirtualTexture.hlsliのフィードバックに相当）
+		const uint32_t levelPagesX = table.GetPagesX(mip);
+		const uint32_t levelPagesY = table.GetPagesY(mip);
+		const uint32_t width = viewPagesX * pixelsPerPage;
+		for (uint32_t i = 0; i < samples.size(); i++) {
+			uint32_t x = (originX + (i % width) / pixelsPerPage) % levelPagesX;
+			uint32_t y = (originY + (i / width) / pixelsPerPage) % levelPagesY;
+			samples[i] = PageTable::PackPageId(mip, x, y);
+		}
+		for (uint32_t sample : samples) {
+			for (uint32_t id = sample; table.IsValidPage(id); id = PageTable::ParentPageId(id)) {
+				lastReferenced[id] = frame;
+			}
+			// 描画時には常に何かのページで代用できる
+			uint32_t residentPageId = 0;
+			uint32_t slot = 0;
+			if (!table.Resolve(sample, residentPageId, slot)) {
+				unresolved++;
+			}
+		}
+
+		feedback.Process(samples.data(), samples.size(), table, cache, frame);
+		feedback.GetRequests(maxRequests, requests);
+
+		// 前のフレームで読み始めたページを転送する
+		if (inFlight.size() == 2) {
+			for (uint32_t pageId : inFlight.front()) {
+				if (cache.IsResident(pageId)) {
+					continue;
+				}
+				uint32_t slot = cache.Allocate(pageId, frame, evicted);
+				if (slot == PageCache::kInvalid) {
+					continue;
+				}
+				if (evicted != PageCache::kInvalid) {
+					// GPUが処理中のフレームで使ったページを追い出していないこと
+					if (frame - lastReferenced[evicted] < protectedFrames) {
+						protectedViolations++;
+					}
+					table.Unmap(evicted);
+				}
+				table.Map(pageId, slot);
+			}
+			inFlight.pop_front();
+		}
+		inFlight.push_back(requests);
+	};
+
+	// 全体を見渡してから寄っていき、横に流す
+	for (uint32_t mip = mipCount - 1; 0 < mip; mip--) {
+		for (uint32_t i = 0; i < 8; i++) {
+			runFrame(mip, 0, 0);
+		}
+	}
+	for (uint32_t i = 0; i < 200; i++) {
+		runFrame(0, i / 2, i / 5);
+	}
+
+	// 止まれば画面内のページは全て要求したミップで常駐する
+	for (uint32_t i = 0; i < 30; i++) {
+		runFrame(0, 40, 20);
+	}
+	uint32_t exact = 0;
+	for (uint32_t sample : samples) {
+		uint32_t residentPageId = 0;
+		uint32_t slot = 0;
+		if (table.Resolve(sample, residentPageId, slot) && residentPageId == sample) {
+			exact++;
+		}
+	}
+
+	// ページテーブルとキャッシュの常駐状態が一致していること
+	for (uint32_t mip = 0; mip < mipCount; mip++) {
+		for (uint32_t y = 0; y < table.GetPagesY(mip); y++) {
+			for (uint32_t x = 0; x < table.GetPagesX(mip); x++) {
+				uint32_t pageId = PageTable::PackPageId(mip, x, y);
+				bool mapped = table.GetSlot(pageId) != PageTable::kInvalidSlot;
+				if (mapped != cache.IsResident(pageId)) {
+					mismatches++;
+				}
+			}
+		}
+	}
+
+	printf(
+	  "trace: %u frames, hits %llu, misses %llu, evictions %llu, resident %u/%u\n", frame,
+	  static_cast<unsigned long long>(cache.GetHitCount()),
+	  static_cast<unsigned long long>(cache.GetMissCount()),
+	  static_cast<unsigned long long>(cache.GetEvictionCount()), cache.GetResidentCount(),
+	  cache.GetSlotCount());
+	CHECK(unresolved == 0);
+	CHECK(protectedViolations == 0);
+	CHECK(mismatches == 0);
+	CHECK(exact == samples.size());
+	CHECK(0 < cache.GetEvictionCount());
+	CHECK(cache.IsResident(topPageId));
+}
+
+// ページ切り出し（ボーダーのクランプ、縮小の色、保持する行の量）
+void TestPageWriter() {
+	const uint32_t width = 512;
+	const uint32_t height = 1024;
+	const uint32_t pageSize = 64;
+	const uint32_t border = 4;
+	const uint32_t mipCount = 4;
+	const uint32_t slotSize = pageSize + border * 2;
+	const uint32_t bpp = VirtualTexturePageWriter::kBytesPerPixel;
+
+	// 左右で色が違い、行ごとに値の変わる画像
+	std::vector<uint8_t> source(static_cast<size_t>(width) * height * bpp);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			uint8_t* p = &source[(static_cast<size_t>(y) * width + x) * bpp];
+			p[0] = x < width / 2 ? 200 : 40;
+			p[1] = static_cast<uint8_t>(y * 7);
+			p[2] = static_cast<uint8_t>(x);
+			p[3] = 255;
+		}
+	}
+
+	// ミップとページ行ごとに受け取ったページ
+	std::vector<std::vector<std::vector<uint8_t>>> received(mipCount);
+	VirtualTexturePageWriter writer;
+	writer.Initialize(
+	  width, height, pageSize, border, mipCount,
+	  [&](uint32_t mip, uint32_t pageY, const uint8_t* pages, size_t size) {
+		  CHECK(pageY == received[mip].size());
+		  received[mip].emplace_back(pages, pages + size);
+	  });
+	CHECK(writer.GetPageBytes() == static_cast<size_t>(slotSize) * slotSize * bpp);
+
+	// 読み込みと同じくページの高さずつ渡す
+	for (uint32_t y = 0; y < height; y += pageSize) {
+		writer.AddRows(&source[static_cast<size_t>(y) * width * bpp], width * bpp, pageSize);
+	}
+	CHECK(writer.IsComplete());
+	CHECK(received[0].size() == 16 && received[1].size() == 8);
+	CHECK(received[2].size() == 4 && received[3].size() == 2);
+
+	// ミップ0はボーダーを画像端でクランプして元の画素をそのまま写す
+	bool copied = true;
+	for (uint32_t pageY = 0; pageY < received[0].size(); pageY++) {
+		for (uint32_t pageX = 0; pageX < width / pageSize; pageX++) {
+			const uint8_t* page = &received[0][pageY][writer.GetPageBytes() * pageX];
+			for (uint32_t y = 0; y < slotSize; y++) {
+				int32_t srcY = static_cast<int32_t>(pageY * pageSize + y) - int32_t(border);
+				srcY = (std::min)((std::max)(srcY, 0), int32_t(height) - 1);
+				for (uint32_t x = 0; x < slotSize; x++) {
+					int32_t srcX = static_cast<int32_t>(pageX * pageSize + x) - int32_t(border);
+					srcX = (std::min)((std::max)(srcX, 0), int32_t(width) - 1);
+					const uint8_t* expected =
+					  &source[(static_cast<size_t>(srcY) * width + srcX) * bpp];
+					if (memcmp(&page[(y * slotSize + x) * bpp], expected, bpp) != 0) {
+						copied = false;
+					}
+				}
+			}
+		}
+	}
+	CHECK(copied);
+
+	// 一様な部分は縮小しても同じ色のまま（sRGBのまま平均しても線形で平均しても変わらない）
+	const uint8_t* mip1 = received[1][0].data();
+	const uint8_t* leftCenter = &mip1[((border + 10) * slotSize + border + 10) * bpp];
+	CHECK(leftCenter[0] == 200 && leftCenter[3] == 255);
+
+	// 白黒の縞は線形で平均するので、sRGBの値の平均（128）より明るくなる
+	std::vector<uint8_t> twoColors(static_cast<size_t>(pageSize) * pageSize * bpp);
+	for (uint32_t i = 0; i < pageSize * pageSize; i++) {
+		uint8_t value = (i % 2) ? 255 : 0;
+		memset(&twoColors[i * bpp], value, bpp - 1);
+		twoColors[i * bpp + 3] = 255;
+	}
+	std::vector<uint8_t> checker;
+	VirtualTexturePageWriter checkerWriter;
+	checkerWriter.Initialize(
+	  pageSize, pageSize, pageSize, 0, 2,
+	  [&](uint32_t mip, uint32_t, const uint8_t* pages, size_t size) {
+		  if (mip == 1) {
+			  checker.assign(pages, pages + size);
+		  }
+	  });
+	checkerWriter.AddRows(twoColors.data(), pageSize * bpp, pageSize);
+	CHECK(checkerWriter.IsComplete());
+	CHECK(!checker.empty() && 186 <= checker[0] && checker[0] <= 189);
+
+	// ページ1行分とボーダー、縮小に要る行だけを保持する
+	printf(
+	  "page writer: peak rows %zu bytes (image %zu bytes)\n", writer.GetPeakRowBytes(),
+	  source.size());
+	CHECK(writer.GetPeakRowBytes() < source.size() / 4);
+}
+} // namespace
+
+int main() {
+	ThreadPool::GetInstance()->Initialize();
+
+	TestPageTable();
+	TestPageCache();
+	TestFeedbackOrder();
+	TestSimulatedTrace();
+	TestPageWriter();
+
+	ThreadPool::GetInstance()->Finalize();
+	return CheckResult();
+}
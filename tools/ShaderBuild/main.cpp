@@ -0,0 +1,187 @@
+﻿#include "ShaderArchive.h"
+#include "ShaderCompiler.h"
+#include <Windows.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+// シェーダのアーカイブ作成ツール
+// 使い方: ShaderBuild.exe <一覧ファイル> <出力ファイル>
+// 一覧ファイルと同じディレクトリのシェーダをコンパイルし、ソースが変わっていないものは
+// 前回のアーカイブから引き継ぐ。
+
+namespace {
+// 一覧ファイルの1行
+struct ManifestEntry {
+	std::wstring fileName;
+	std::string target;
+	std::string entryPoint;
+	std::vector<ShaderDefine> defines;
+};
+
+// SJIS -> WideChar
+std::wstring ConvertString(const std::string& str) {
+	if (str.empty()) {
+		return std::wstring();
+	}
+
+	int sizeNeeded =
+	  MultiByteToWideChar(CP_ACP, 0, str.c_str(), static_cast<int>(str.size()), NULL, 0);
+	std::wstring result(sizeNeeded, 0);
+	MultiByteToWideChar(
+	  CP_ACP, 0, str.c_str(), static_cast<int>(str.size()), &result[0], sizeNeeded);
+	return result;
+}
+
+// 一覧ファイルの読み込み（#から始まる行と空行は飛ばす）
+bool ReadManifest(const std::string& filePath, std::vector<ManifestEntry>& entries) {
+	std::ifstream file(filePath);
+	if (file.fail()) {
+		fprintf(stderr, "%s: error: cannot open manifest\n", filePath.c_str());
+		return false;
+	}
+
+	std::string line;
+	for (int lineNumber = 1; std::getline(file, line); lineNumber++) {
+		std::istringstream stream(line);
+		std::string fileName;
+		if (!(stream >> fileName) || fileName[0] == '#') {
+			continue;
+		}
+
+		ManifestEntry entry;
+		entry.fileName = ConvertString(fileName);
+		if (!(stream >> entry.target >> entry.entryPoint)) {
+			fprintf(
+			  stderr, "%s(%d): error: expected 'file target entry'\n", filePath.c_str(),
+			  lineNumber);
+			return false;
+		}
+		std::string define;
+		while (stream >> define) {
+			size_t equal = define.find('=');
+			if (equal == std::string::npos) {
+				entry.defines.push_back({define, "1"});
+			} else {
+				entry.defines.push_back({define.substr(0, equal), define.substr(equal + 1)});
+			}
+		}
+		entries.push_back(std::move(entry));
+	}
+	return true;
+}
+
+// ファイル全体の読み込み
+bool ReadBinary(const std::string& filePath, std::vector<uint8_t>& data) {
+	std::ifstream file(filePath, std::ios::binary);
+	if (file.fail()) {
+		return false;
+	}
+	data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+// 書き出し（書き込み途中のファイルを実行時に読まないように、別名で書いてから置き換える）
+bool WriteBinary(const std::string& filePath, const std::vector<uint8_t>& data) {
+	std::string tempPath = filePath + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+		if (file.fail()) {
+			return false;
+		}
+	}
+	return MoveFileExA(tempPath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+	if (argc != 3) {
+		fprintf(stderr, "usage: ShaderBuild <manifest> <output>\n");
+		return 1;
+	}
+	std::string manifestPath = argv[1];
+	std::string outputPath = argv[2];
+
+	std::vector<ManifestEntry> manifest;
+	if (!ReadManifest(manifestPath, manifest)) {
+		return 1;
+	}
+	std::wstring directory = ConvertString(manifestPath);
+	directory.resize(directory.size() - ShaderCompiler::GetFileName(directory).size());
+
+	// 前回のアーカイブ（無い・壊れているときは全てコンパイルする）
+	std::vector<uint8_t> previousData;
+	ShaderArchive previous;
+	if (ReadBinary(outputPath, previousData)) {
+		previous.Open(previousData.data(), previousData.size());
+	}
+
+	std::vector<ShaderArchive::Entry> entries;
+	uint32_t compiledCount = 0;
+	bool failed = false;
+	for (const ManifestEntry& item : manifest) {
+		std::wstring filePath = directory + item.fileName;
+		ShaderArchive::Entry entry;
+		entry.key = ShaderArchive::MakeKey(
+		  item.fileName, item.entryPoint, item.target, item.defines, ShaderCompiler::kFlags);
+		entry.sourceHash = ShaderCompiler::HashSource(filePath);
+		if (entry.sourceHash == 0) {
+			fprintf(stderr, "%ls: error: cannot read source\n", filePath.c_str());
+			failed = true;
+			continue;
+		}
+		for (const ShaderArchive::Entry& added : entries) {
+			if (added.key == entry.key) {
+				fprintf(stderr, "%ls: error: duplicated in manifest\n", filePath.c_str());
+				return 1;
+			}
+		}
+
+		// ソースとインクルードが前回と同じなら引き継ぐ
+		ShaderArchive::View view;
+		if (previous.Find(entry.key, view) && view.sourceHash == entry.sourceHash &&
+		    ShaderArchive::ReadReflection(view.reflection, view.reflectionSize, entry.reflection)) {
+			const uint8_t* bytecode = static_cast<const uint8_t*>(view.bytecode);
+			entry.bytecode.assign(bytecode, bytecode + view.bytecodeSize);
+			entries.push_back(std::move(entry));
+			continue;
+		}
+
+		Microsoft::WRL::ComPtr<ID3DBlob> blob;
+		std::string errors;
+		if (!ShaderCompiler::Compile(
+		      filePath, item.entryPoint, item.target, item.defines, blob, &errors)) {
+			fprintf(stderr, "%s\n", errors.c_str());
+			failed = true;
+			continue;
+		}
+		const uint8_t* bytecode = static_cast<const uint8_t*>(blob->GetBufferPointer());
+		entry.bytecode.assign(bytecode, bytecode + blob->GetBufferSize());
+		if (!ShaderCompiler::Reflect(
+		      blob->GetBufferPointer(), blob->GetBufferSize(), entry.reflection)) {
+			fprintf(stderr, "%ls: error: reflection failed\n", filePath.c_str());
+			failed = true;
+			continue;
+		}
+		entries.push_back(std::move(entry));
+		compiledCount++;
+	}
+	if (failed) {
+		return 1;
+	}
+
+	// 変更も削除も無ければ書き直さない（更新日時を変えない）
+	if (compiledCount == 0 && entries.size() == previous.GetEntryCount()) {
+		printf("ShaderBuild: %zu shaders up to date\n", entries.size());
+		return 0;
+	}
+	size_t entryCount = entries.size();
+	if (!WriteBinary(outputPath, ShaderArchive::Write(std::move(entries)))) {
+		fprintf(stderr, "%s: error: cannot write archive\n", outputPath.c_str());
+		return 1;
+	}
+	printf("ShaderBuild: %u compiled, %zu shaders in archive\n", compiledCount, entryCount);
+	return 0;
+}